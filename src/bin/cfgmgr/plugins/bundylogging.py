@@ -37,6 +37,8 @@ ALLOWED_DESTINATIONS = [ 'console',
                          'syslog' ]
 ALLOWED_STREAMS = [ 'stdout',
                     'stderr' ]
+ALLOWED_OVERFLOW_POLICIES = [ 'drop',
+                              'block' ]
 
 def check(config):
     # Check the data layout first
@@ -100,6 +102,15 @@ def check(config):
                                                   "output not set to any facility"
                                                   " for logger " + name)
 
+    if 'async_queue_size' in config and config['async_queue_size'] <= 0:
+        errors.append("bad async_queue_size: " +
+                      str(config['async_queue_size']) +
+                      ", must be greater than zero")
+    if 'async_overflow' in config and\
+       config['async_overflow'] not in ALLOWED_OVERFLOW_POLICIES:
+        errors.append("bad async_overflow value: " +
+                      config['async_overflow'] + ", must be drop or block")
+
     if errors:
         return ', '.join(errors)
     return None
@@ -74,6 +74,24 @@
                   }
                   ]
                 }
+            },
+            {
+                "item_name": "async_output",
+                "item_type": "boolean",
+                "item_optional": false,
+                "item_default": false
+            },
+            {
+                "item_name": "async_queue_size",
+                "item_type": "integer",
+                "item_optional": false,
+                "item_default": 4096
+            },
+            {
+                "item_name": "async_overflow",
+                "item_type": "string",
+                "item_optional": false,
+                "item_default": "drop"
             }
         ],
         "commands": []
@@ -131,5 +131,15 @@ class LoggingConfCheckTest(unittest.TestCase):
                                           [{'name': 'bundy',
                                             'severity': 123}]}))
 
+    def test_async_output(self):
+        self.assertEqual(None, bundylogging.check({'async_output': True,
+                                                   'async_queue_size': 1024,
+                                                   'async_overflow': 'block'}))
+        self.assertEqual('bad async_queue_size: 0, must be greater than zero',
+                         bundylogging.check({'async_queue_size': 0}))
+        self.assertEqual('bad async_overflow value: wait, must be drop or '
+                         'block',
+                         bundylogging.check({'async_overflow': 'wait'}))
+
 if __name__ == '__main__':
         unittest.main()
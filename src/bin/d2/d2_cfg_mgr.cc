@@ -64,6 +64,9 @@ D2CfgMgr::D2CfgMgr() : DCfgMgrBase(DCfgContextBasePtr(new D2CfgContext())) {
     addToParseOrder("interface");
     addToParseOrder("ip_address");
     addToParseOrder("port");
+    addToParseOrder("max_transactions");
+    addToParseOrder("max_server_transactions");
+    addToParseOrder("max_batch_updates");
     addToParseOrder("tsig_keys");
     addToParseOrder("forward_ddns");
     addToParseOrder("reverse_ddns");
@@ -199,7 +202,10 @@ D2CfgMgr::createConfigParser(const std::string& config_id) {
         (config_id == "ip_address")) {
         parser = new bundy::dhcp::StringParser(config_id,
                                              context->getStringStorage());
-    } else if (config_id == "port") {
+    } else if ((config_id == "port") ||
+               (config_id == "max_transactions") ||
+               (config_id == "max_server_transactions") ||
+               (config_id == "max_batch_updates")) {
         parser = new bundy::dhcp::Uint32Parser(config_id,
                                              context->getUint32Storage());
     } else if (config_id ==  "forward_ddns") {
@@ -226,6 +226,10 @@ D2Process::configure(bundy::data::ConstElementPtr config_set) {
     // did some analysis to decide what if anything we need to do.)
     reconf_queue_flag_ = true;
 
+    // Unlike the queue manager, the update manager's limits take effect
+    // immediately.
+    reconfigureUpdateMgr();
+
     // If we are here, configuration was valid, at least it parsed correctly
     // and therefore contained no invalid values.
     // Return the success answer from above.
@@ -354,6 +358,34 @@ D2Process::reconfigureQueueMgr() {
     }
 }
 
+void
+D2Process::reconfigureUpdateMgr() {
+    try {
+        uint32_t max_transactions = D2UpdateMgr::MAX_TRANSACTIONS_DEFAULT;
+        uint32_t max_server_transactions =
+            D2UpdateMgr::MAX_SERVER_TRANSACTIONS_DEFAULT;
+        uint32_t max_batch_updates = D2UpdateMgr::MAX_BATCH_UPDATES_DEFAULT;
+        getCfgMgr()->getContext()->getParam("max_transactions",
+                                            max_transactions,
+                                            DCfgContextBase::OPTIONAL);
+        getCfgMgr()->getContext()->getParam("max_server_transactions",
+                                            max_server_transactions,
+                                            DCfgContextBase::OPTIONAL);
+        getCfgMgr()->getContext()->getParam("max_batch_updates",
+                                            max_batch_updates,
+                                            DCfgContextBase::OPTIONAL);
+
+        update_mgr_->setMaxServerTransactions(max_server_transactions);
+        update_mgr_->setMaxBatchUpdates(max_batch_updates);
+        update_mgr_->setMaxTransactions(max_transactions);
+    } catch (const bundy::Exception& ex) {
+        // The maximum may not be set below the number of transactions in
+        // progress. The previous value remains in effect.
+        LOG_ERROR(dctl_logger, DHCP_DDNS_UPDATE_MGR_RECONFIGURE_ERROR)
+                  .arg(ex.what());
+    }
+}
+
 bundy::data::ConstElementPtr
 D2Process::command(const std::string& command, 
                    bundy::data::ConstElementPtr args) {
@@ -225,6 +225,16 @@ protected:
     /// This method is exception safe.
     virtual void reconfigureQueueMgr();
 
+    /// @brief Applies the transaction limits to the update manager.
+    ///
+    /// This method sets the maximum number of concurrent transactions and
+    /// the maximum number of concurrent transactions per DNS server from
+    /// the current configuration. Parameters which are not configured are
+    /// set to their defaults.
+    ///
+    /// This method is exception safe.
+    virtual void reconfigureUpdateMgr();
+
     /// @brief Allows IO processing to run until at least callback is invoked.
     ///
     /// This method is called from within the D2Process main event loop and is
@@ -16,6 +16,10 @@
 #include <d2/d2_queue_mgr.h>
 #include <dhcp_ddns/ncr_udp.h>
 
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <algorithm>
+
 namespace bundy {
 namespace d2 {
 
@@ -24,7 +28,8 @@ const size_t D2QueueMgr::MAX_QUEUE_DEFAULT;
 
 D2QueueMgr::D2QueueMgr(IOServicePtr& io_service, const size_t max_queue_size)
     : io_service_(io_service), max_queue_size_(max_queue_size),
-      mgr_state_(NOT_INITTED), target_stop_state_(NOT_INITTED) {
+      next_seq_(0), mgr_state_(NOT_INITTED), target_stop_state_(NOT_INITTED),
+      coalescing_(true), superseded_count_(0) {
     if (!io_service_) {
         bundy_throw(D2QueueMgrError, "IOServicePtr cannot be null");
     }
@@ -49,7 +54,14 @@ D2QueueMgr::operator()(const dhcp_ddns::NameChangeListener::Result result,
         // state as well as our queue size.
         switch (result) {
         case dhcp_ddns::NameChangeListener::SUCCESS:
-            // Receive was successful, attempt to queue the request.
+            // Receive was successful. If the request supersedes one
+            // already queued, it takes the queued request's place and
+            // needs no room in the queue.
+            if (coalescing_ && coalesce(ncr)) {
+                return;
+            }
+
+            // Attempt to queue the request.
             if (getQueueSize() < getMaxQueueSize()) {
                 // There's room on the queue, add to the end
                 enqueue(ncr);
@@ -219,8 +231,9 @@ D2QueueMgr::dequeueAt(const size_t index) {
                   << " index: " << index << " queue size: " << getQueueSize());
     }
 
-    RequestQueue::iterator pos = ncr_queue_.begin() + index;
-    ncr_queue_.erase(pos);
+    unindex(index);
+    ncr_queue_.erase(ncr_queue_.begin() + index);
+    seq_queue_.erase(seq_queue_.begin() + index);
 }
 
 
@@ -231,17 +244,96 @@ D2QueueMgr::dequeue() {
                   "D2QueueMgr dequeue attempted on an empty queue");
     }
 
+    unindex(0);
     ncr_queue_.pop_front();
+    seq_queue_.pop_front();
 }
 
 void
 D2QueueMgr::enqueue(dhcp_ddns::NameChangeRequestPtr& ncr) {
     ncr_queue_.push_back(ncr);
+    seq_queue_.push_back(next_seq_++);
+    indexBack();
 }
 
 void
 D2QueueMgr::clearQueue() {
     ncr_queue_.clear();
+    seq_queue_.clear();
+    dhcid_index_.clear();
+}
+
+void
+D2QueueMgr::indexBack() {
+    DhcidIndex::iterator it = dhcid_index_.find(ncr_queue_.back()->getDhcid());
+    if (it == dhcid_index_.end()) {
+        const DhcidEntry entry = { seq_queue_.back(), 1 };
+        dhcid_index_.insert(DhcidIndex::value_type(
+                                ncr_queue_.back()->getDhcid(), entry));
+    } else {
+        it->second.last_seq_ = seq_queue_.back();
+        ++it->second.count_;
+    }
+}
+
+void
+D2QueueMgr::unindex(const size_t index) {
+    const dhcp_ddns::D2Dhcid& dhcid = ncr_queue_[index]->getDhcid();
+    DhcidIndex::iterator it = dhcid_index_.find(dhcid);
+    if (it == dhcid_index_.end()) {
+        return;
+    }
+    if (--it->second.count_ == 0) {
+        dhcid_index_.erase(it);
+        return;
+    }
+
+    // If the last request for the client is removed while older ones are
+    // still queued (i.e. requests are taken out of order), the index has
+    // to point to the one before it. It's rare, so just search for it.
+    if (it->second.last_seq_ == seq_queue_[index]) {
+        for (size_t i = index; i > 0; --i) {
+            if (ncr_queue_[i - 1]->getDhcid() == dhcid) {
+                it->second.last_seq_ = seq_queue_[i - 1];
+                break;
+            }
+        }
+    }
+}
+
+bool
+D2QueueMgr::coalesce(dhcp_ddns::NameChangeRequestPtr& ncr) {
+    // Look for the most recent request for the same client. Only this one
+    // may be replaced, so that the order of the requests for the client is
+    // preserved.
+    DhcidIndex::const_iterator it = dhcid_index_.find(ncr->getDhcid());
+    if (it == dhcid_index_.end()) {
+        return (false);
+    }
+    const size_t index = std::lower_bound(seq_queue_.begin(), seq_queue_.end(),
+                                          it->second.last_seq_) -
+                         seq_queue_.begin();
+    RequestQueue::iterator pos = ncr_queue_.begin() + index;
+
+    // The new request must leave DNS in the state intended by the queued
+    // one for every direction the queued request asks to change. Both the
+    // forward (A or AAAA) and the reverse (PTR) records are bound to the
+    // address, so it must be the same: a removal of another address would
+    // leave the records added for the queued address in DNS.
+    const dhcp_ddns::NameChangeRequestPtr& queued = *pos;
+    if (!boost::iequals(queued->getFqdn(), ncr->getFqdn()) ||
+        (queued->getIpAddress() != ncr->getIpAddress()) ||
+        (queued->isForwardChange() && !ncr->isForwardChange()) ||
+        (queued->isReverseChange() && !ncr->isReverseChange())) {
+        return (false);
+    }
+
+    LOG_DEBUG(dctl_logger, DBGLVL_TRACE_DETAIL_DATA,
+              DHCP_DDNS_QUEUE_MGR_REQUEST_SUPERSEDED)
+              .arg(queued->toText()).arg(ncr->toText());
+    *pos = ncr;
+    ++superseded_count_;
+    return (true);
 }
 
 void
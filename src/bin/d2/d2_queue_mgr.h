@@ -24,6 +24,7 @@
 
 #include <boost/noncopyable.hpp>
 #include <deque>
+#include <map>
 
 namespace bundy {
 namespace d2 {
@@ -129,6 +130,18 @@ public:
 /// D2QueueMgr does not attempt to recover from stopped conditions, this is left
 /// to upper layers.
 ///
+/// When clients' leases change rapidly, DHCP servers may send a number of
+/// requests for the same client (e.g. add, remove, add) before the first of
+/// them is processed. Unless disabled with setCoalescing(), D2QueueMgr
+/// coalesces such requests as they are received: a newly received request
+/// replaces the last queued request for the same DHCID and FQDN, provided it
+/// supersedes it. A request supersedes the queued one if it refers to the
+/// same IP address and asks for changes in (at least) the same directions.
+/// Only the final intended state is then sent to DNS. The number of requests
+/// superseded this way is available via getSupersededCount(). The last
+/// queued request for each DHCID is kept in an index, so a received request
+/// is coalesced without searching the queue.
+///
 /// It is important to note that the queue contents are preserved between
 /// state transitions.  In other words entries in the queue remain there
 /// until they are removed explicitly via the deque() or implicitly by
@@ -202,7 +215,9 @@ public:
     /// completion callback and is how the inbound NameChangeRequests are
     /// passed up to the D2QueueMgr for queueing.
     /// If the given result indicates a successful receive completion and
-    /// there is room left in the queue, the given request is queued.
+    /// the given request supersedes a queued request, it replaces the queued
+    /// request. Otherwise, if there is room left in the queue, the given
+    /// request is queued.
     ///
     /// If the queue is at maximum capacity, stopListening() is invoked and
     /// the state is set to STOPPED_QUEUE_FULL.
@@ -319,6 +334,38 @@ public:
     /// @brief Removes all entries from the queue.
     void clearQueue();
 
+    /// @brief Replaces the queued request superseded by the given request.
+    ///
+    /// Looks up the last queued request with the same DHCID as the given
+    /// request. If it has the same FQDN and the given request supersedes it,
+    /// the queued request is replaced with the given one.
+    ///
+    /// @param ncr pointer to the NameChangeRequest which is to replace the
+    /// queued one.
+    ///
+    /// @return true if the queued request has been replaced, false if there
+    /// is no queued request superseded by the given request.
+    bool coalesce(dhcp_ddns::NameChangeRequestPtr& ncr);
+
+    /// @brief Checks if received requests are coalesced.
+    bool getCoalescing() const {
+        return (coalescing_);
+    }
+
+    /// @brief Enables or disables coalescing of received requests.
+    ///
+    /// @param coalescing if true, the received requests replace the queued
+    /// requests they supersede.
+    void setCoalescing(const bool coalescing) {
+        coalescing_ = coalescing;
+    }
+
+    /// @brief Returns the number of queued requests which have been replaced
+    /// by the requests superseding them.
+    uint64_t getSupersededCount() const {
+        return (superseded_count_);
+    }
+
   private:
     /// @brief Sets the manager state to the target stop state.
     ///
@@ -326,6 +373,27 @@ public:
     /// state and logs that the manager is stopped.
     void updateStopState();
 
+    /// @brief Adds the request at the back of the queue to the DHCID index.
+    void indexBack();
+
+    /// @brief Removes the request at a given position from the DHCID index.
+    ///
+    /// It must be called before the request is removed from the queue.
+    ///
+    /// @param index the position of the request in the queue.
+    void unindex(const size_t index);
+
+    /// @brief The last queued request for a DHCID.
+    struct DhcidEntry {
+        /// @brief Sequence number of the last request.
+        uint64_t last_seq_;
+        /// @brief Number of queued requests for the DHCID.
+        size_t count_;
+    };
+
+    /// @brief Defines the index of the queued requests by DHCID.
+    typedef std::map<dhcp_ddns::D2Dhcid, DhcidEntry> DhcidIndex;
+
     /// @brief IOService that our listener should use for IO management.
     IOServicePtr io_service_;
 
@@ -335,6 +403,18 @@ public:
     /// @brief Queue of received NameChangeRequests.
     RequestQueue ncr_queue_;
 
+    /// @brief Sequence numbers of the queued requests, in the queue order.
+    ///
+    /// They only grow, so the position of a request is found by a binary
+    /// search for its sequence number.
+    std::deque<uint64_t> seq_queue_;
+
+    /// @brief Sequence number of the next queued request.
+    uint64_t next_seq_;
+
+    /// @brief Last queued request and number of queued requests by DHCID.
+    DhcidIndex dhcid_index_;
+
     /// @brief Listener instance from which requests are received.
     boost::shared_ptr<dhcp_ddns::NameChangeListener> listener_;
 
@@ -343,6 +423,12 @@ public:
 
     /// @brief Tracks the state the manager should be in once stopped.
     State target_stop_state_;
+
+    /// @brief Indicates if the received requests are coalesced.
+    bool coalescing_;
+
+    /// @brief Number of queued requests superseded by received requests.
+    uint64_t superseded_count_;
 };
 
 /// @brief Defines a pointer for manager instances.
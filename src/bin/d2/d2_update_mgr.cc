@@ -24,11 +24,15 @@ namespace bundy {
 namespace d2 {
 
 const size_t D2UpdateMgr::MAX_TRANSACTIONS_DEFAULT;
+const size_t D2UpdateMgr::MAX_SERVER_TRANSACTIONS_DEFAULT;
+const size_t D2UpdateMgr::MAX_BATCH_UPDATES_DEFAULT;
 
 D2UpdateMgr::D2UpdateMgr(D2QueueMgrPtr& queue_mgr, D2CfgMgrPtr& cfg_mgr,
                          IOServicePtr& io_service,
                          const size_t max_transactions)
-    :queue_mgr_(queue_mgr), cfg_mgr_(cfg_mgr), io_service_(io_service) {
+    :queue_mgr_(queue_mgr), cfg_mgr_(cfg_mgr), io_service_(io_service),
+     max_server_transactions_(MAX_SERVER_TRANSACTIONS_DEFAULT),
+     max_batch_updates_(MAX_BATCH_UPDATES_DEFAULT), batcher_() {
     if (!queue_mgr_) {
         bundy_throw(D2UpdateMgrError, "D2UpdateMgr queue manager cannot be null");
     }
@@ -44,6 +48,8 @@ D2UpdateMgr::D2UpdateMgr(D2QueueMgrPtr& queue_mgr, D2CfgMgrPtr& cfg_mgr,
 
     // Use setter to do validation.
     setMaxTransactions(max_transactions);
+
+    batcher_.reset(new DNSUpdateBatcher(io_service_));
 }
 
 D2UpdateMgr::~D2UpdateMgr() {
@@ -54,24 +60,34 @@ void D2UpdateMgr::sweep() {
     // cleanup finished transactions;
     checkFinishedTransactions();
 
-    // if the queue isn't empty, find the next suitable job and
-    // start a transaction for it.
-    // @todo - Do we want to queue max transactions? The logic here will only
-    // start one new transaction per invocation.  On the other hand a busy
-    // system will generate many IO events and this method will be called
-    // frequently.  It will likely achieve max transactions quickly on its own.
-    if (getQueueCount() > 0)  {
+    // While the queue isn't empty, find the next suitable job and start
+    // a transaction for it. Starting as many transactions as permitted in
+    // one invocation lets a backlog of requests be worked on concurrently,
+    // rather than ramping up by one transaction per IO event.
+    //
+    // Starting a transaction never makes a request which was skipped
+    // eligible: its DHCID still has a transaction and its server's count
+    // doesn't decrease. So each search continues where the previous one
+    // stopped, and the queue is scanned only once per sweep.
+    size_t index = 0;
+    while (getQueueCount() > 0)  {
         if (getTransactionCount() >= max_transactions_) {
             LOG_DEBUG(dctl_logger, DBGLVL_TRACE_DETAIL_DATA,
                       DHCP_DDNS_AT_MAX_TRANSACTIONS).arg(getQueueCount())
                       .arg(getMaxTransactions());
 
-            return;
+            break;
         }
 
         // We are not at maximum transactions, so pick and start the next job.
-        pickNextJob();
+        if (!pickNextJob(index)) {
+            break;
+        }
     }
+
+    // Send the updates submitted by the transactions started above as well
+    // as by those which have processed IO events since the last sweep.
+    batcher_->flush();
 }
 
 void
@@ -90,6 +106,7 @@ D2UpdateMgr::checkFinishedTransactions() {
         if (trans->isModelDone()) {
             // @todo  Addtional actions based on NCR status could be
             // performed here.
+            releaseServer((*it).first);
             transaction_list_.erase(it++);
         } else {
             ++it;
@@ -97,27 +114,108 @@ D2UpdateMgr::checkFinishedTransactions() {
     }
 }
 
-void D2UpdateMgr::pickNextJob() {
-    // Start at the front of the queue, looking for the first entry for
-    // which no transaction is in progress.  If we find an eligible entry
+bool D2UpdateMgr::pickNextJob() {
+    size_t index = 0;
+    return (pickNextJob(index));
+}
+
+bool D2UpdateMgr::pickNextJob(size_t& index) {
+    // Start at the given position of the queue, looking for the first entry
+    // for which no transaction is in progress.  If we find an eligible entry
     // remove it from the queue and  make a transaction for it.
     // Requests and transactions are associated by DHCID.  If a request has
     // the same DHCID as a transaction, they are presumed to be for the same
     // "end user".
-    size_t queue_count = getQueueCount();
-    for (size_t index = 0; index < queue_count; ++index) {
+    for (; index < getQueueCount(); ++index) {
         dhcp_ddns::NameChangeRequestPtr found_ncr = queue_mgr_->peekAt(index);
-        if (!hasTransaction(found_ncr->getDhcid())) {
-            queue_mgr_->dequeueAt(index);
-            makeTransaction(found_ncr);
-            return;
+        if (hasTransaction(found_ncr->getDhcid())) {
+            continue;
+        }
+
+        // If the per server limit is in effect, skip the requests for
+        // servers which are busy with the maximum number of transactions.
+        std::string server_key;
+        if (max_server_transactions_ > 0) {
+            server_key = getServerKey(found_ncr);
+            if (!server_key.empty() &&
+                (getServerTransactionCount(server_key) >=
+                 max_server_transactions_)) {
+                continue;
+            }
+        }
+
+        // The next request moves to this position, so the index is left
+        // as it is for the next search.
+        queue_mgr_->dequeueAt(index);
+        makeTransaction(found_ncr);
+
+        // Charge the server with the transaction, if one was made.
+        if (!server_key.empty() && hasTransaction(found_ncr->getDhcid())) {
+            transaction_servers_[found_ncr->getDhcid()] = server_key;
+            ++server_transactions_[server_key];
         }
+
+        return (true);
     }
 
     // There were no eligible jobs. All of the current DHCIDs already have
-    // transactions pending.
+    // transactions pending or their servers are at the transaction limit.
     LOG_DEBUG(dctl_logger, DBGLVL_TRACE_DETAIL_DATA, DHCP_DDNS_NO_ELIGIBLE_JOBS)
               .arg(getQueueCount()).arg(getTransactionCount());
+    return (false);
+}
+
+std::string
+D2UpdateMgr::getServerKey(const dhcp_ddns::NameChangeRequestPtr& ncr) {
+    // Match the domain the same way makeTransaction does. The transaction
+    // starts with the forward update if there is one to be made.
+    DdnsDomainPtr domain;
+    if (ncr->isForwardChange() && cfg_mgr_->forwardUpdatesEnabled()) {
+        if (!cfg_mgr_->matchForward(ncr->getFqdn(), domain)) {
+            return ("");
+        }
+    } else if (ncr->isReverseChange() && cfg_mgr_->reverseUpdatesEnabled()) {
+        if (!cfg_mgr_->matchReverse(ncr->getIpAddress(), domain)) {
+            return ("");
+        }
+    } else {
+        return ("");
+    }
+
+    const DnsServerInfoStoragePtr& servers = domain->getServers();
+    if (!servers || servers->empty()) {
+        return ("");
+    }
+
+    return ((*servers)[0]->toText());
+}
+
+size_t
+D2UpdateMgr::getServerTransactionCount(const std::string& server_key) const {
+    std::map<std::string, size_t>::const_iterator pos =
+        server_transactions_.find(server_key);
+    return (pos != server_transactions_.end() ? pos->second : 0);
+}
+
+void
+D2UpdateMgr::releaseServer(const TransactionKey& key) {
+    std::map<TransactionKey, std::string>::iterator pos =
+        transaction_servers_.find(key);
+    if (pos == transaction_servers_.end()) {
+        return;
+    }
+
+    std::map<std::string, size_t>::iterator count =
+        server_transactions_.find(pos->second);
+    if (count != server_transactions_.end()) {
+        if (count->second > 1) {
+            --count->second;
+        } else {
+            server_transactions_.erase(count);
+        }
+    }
+
+    transaction_servers_.erase(pos);
 }
 
 void
@@ -201,6 +299,11 @@ D2UpdateMgr::makeTransaction(dhcp_ddns::NameChangeRequestPtr& next_ncr) {
                                               forward_domain, reverse_domain));
     }
 
+    // Let the transaction combine its updates with those of others.
+    if (max_batch_updates_ > 1) {
+        trans->setUpdateBatcher(batcher_);
+    }
+
     // Add the new transaction to the list.
     transaction_list_[key] = trans;
 
@@ -222,6 +325,7 @@ void
 D2UpdateMgr::removeTransaction(const TransactionKey& key) {
     TransactionList::iterator pos = findTransaction(key);
     if (pos != transactionListEnd()) {
+        releaseServer(key);
         transaction_list_.erase(pos);
     }
 }
@@ -240,7 +344,18 @@ void
 D2UpdateMgr::clearTransactionList() {
     // @todo for now this just wipes them out. We might need something
     // more elegant, that allows a cancel first.
+    batcher_->clear();
     transaction_list_.clear();
+    transaction_servers_.clear();
+    server_transactions_.clear();
+}
+
+void
+D2UpdateMgr::setMaxBatchUpdates(const size_t max_batch_updates) {
+    max_batch_updates_ = max_batch_updates;
+    if (max_batch_updates_ > 1) {
+        batcher_->setMaxUpdates(max_batch_updates_);
+    }
 }
 
 void
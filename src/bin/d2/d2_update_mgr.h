@@ -22,6 +22,7 @@
 #include <d2/d2_log.h>
 #include <d2/d2_queue_mgr.h>
 #include <d2/d2_cfg_mgr.h>
+#include <d2/dns_update_batcher.h>
 #include <d2/nc_trans.h>
 
 #include <boost/noncopyable.hpp>
@@ -70,6 +71,22 @@ typedef std::map<TransactionKey, NameChangeTransactionPtr> TransactionList;
 /// The upper layer(s) are responsible for calling sweep in a timely and cyclic
 /// manner.
 ///
+/// Transactions run concurrently as their DNS exchanges are asynchronous IO
+/// events on the common IOService. In order to avoid flooding a single DNS
+/// server with updates when a large number of requests is queued, the number
+/// of transactions started against a given server may be limited with
+/// setMaxServerTransactions(). A transaction is charged to the first server
+/// of the domain it will update first, i.e. the forward domain or the reverse
+/// domain if no forward change is to be made.
+///
+/// The updates sent by the transactions to the same zone on the same server
+/// may be combined in a single DNS UPDATE message, see DNSUpdateBatcher.
+/// Combining is enabled with setMaxBatchUpdates(). The transactions then
+/// submit their updates to the batcher owned by the manager, which sends
+/// them at the end of each sweep() call. As sweep() is called after every IO
+/// event, the updates submitted while processing the same IO events end up in
+/// the same message.
+///
 class D2UpdateMgr : public boost::noncopyable {
 public:
     /// @brief Maximum number of concurrent transactions
@@ -77,6 +94,14 @@ public:
     /// implementation.
     static const size_t MAX_TRANSACTIONS_DEFAULT = 32;
 
+    /// @brief Default maximum number of concurrent transactions per DNS
+    /// server. The value of zero means that there is no per server limit.
+    static const size_t MAX_SERVER_TRANSACTIONS_DEFAULT = 0;
+
+    /// @brief Default maximum number of updates combined in one DNS UPDATE
+    /// message. The value of one means that the updates are not combined.
+    static const size_t MAX_BATCH_UPDATES_DEFAULT = 1;
+
     // @todo This structure is not yet used. It is here in anticipation of
     // enabled statistics capture.
     struct Stats {
@@ -114,12 +139,16 @@ public:
     ///
     /// - Removes all completed transactions from the transaction list.
     ///
-    /// - If the request queue is not empty and the number of transactions
-    /// in the transaction list has not reached maximum allowed, then select
-    /// a request from the queue.
+    /// - While the request queue is not empty and the number of transactions
+    /// in the transaction list has not reached maximum allowed, select
+    /// a request from the queue, start a new transaction for it and add the
+    /// transaction to the list of transactions.
+    ///
+    /// - Stop selecting requests when none of the queued requests is eligible,
+    /// i.e. each of them either refers to a DHCID with a transaction in
+    /// progress or would be sent to a server at its transaction limit.
     ///
-    /// - If a request was selected, start a new transaction for it and
-    /// add the transaction to the list of transactions.
+    /// - Sends the updates submitted to the update batcher.
     void sweep();
 
 protected:
@@ -135,7 +164,8 @@ protected:
     /// This method will scan the request queue for the next request to
     /// dequeue.  The current implementation starts at the front of the queue
     /// and looks for the first request for whose DHCID there is no current
-    /// transaction in progress.
+    /// transaction in progress and, if the per server limit is in effect,
+    /// whose DNS server has not reached the limit.
     ///
     /// If a request is selected, it is removed from the queue and transaction
     /// is constructed for it.
@@ -143,7 +173,28 @@ protected:
     /// It is possible that no such request exists, though this is likely to be
     /// rather rare unless a system is frequently seeing requests for the same
     /// clients in quick succession.
-    void pickNextJob();
+    ///
+    /// @return true if a request has been removed from the queue, false if
+    /// there was no eligible request.
+    bool pickNextJob();
+
+    /// @brief Starts a transaction for the next eligible request in the
+    /// queue, starting the search at the given position.
+    ///
+    /// This is the same as pickNextJob(), except that the requests in front
+    /// of the given position are not considered. It lets the caller, which
+    /// starts several transactions in a row, scan the queue only once: the
+    /// requests skipped by one search can't become eligible by starting a
+    /// transaction, so the next search may continue where this one stopped.
+    ///
+    /// @param[in,out] index Position of the queue to start the search at.
+    /// On return, it is the position at which the next search should start,
+    /// i.e. the position of the request which followed the selected one, or
+    /// the queue size if no request was selected.
+    ///
+    /// @return true if a request has been removed from the queue, false if
+    /// there was no eligible request at or after the given position.
+    bool pickNextJob(size_t& index);
 
     /// @brief Create a new transaction for the given request.
     ///
@@ -169,6 +220,19 @@ protected:
     /// exists. Note this would be programmatic error.
     void makeTransaction(bundy::dhcp_ddns::NameChangeRequestPtr& ncr);
 
+    /// @brief Returns the key of the DNS server a request will be sent to.
+    ///
+    /// The server is the first server of the domain the request's transaction
+    /// will update first: the forward domain if the request asks for enabled
+    /// forward updates, the reverse domain otherwise.
+    ///
+    /// @param ncr the NameChangeRequest for which to find the server.
+    ///
+    /// @return Text representation of the server address and port, or an
+    /// empty string if the request doesn't match any server.
+    std::string getServerKey(const bundy::dhcp_ddns::NameChangeRequestPtr&
+                             ncr);
+
 public:
     /// @brief Gets the D2UpdateMgr's IOService.
     ///
@@ -191,6 +255,50 @@ public:
     /// queue.
     void setMaxTransactions(const size_t max_transactions);
 
+    /// @brief Returns the maximum number of concurrent transactions per
+    /// DNS server.
+    size_t getMaxServerTransactions() const {
+        return (max_server_transactions_);
+    }
+
+    /// @brief Sets the maximum number of concurrent transactions per DNS
+    /// server.
+    ///
+    /// Lowering the limit doesn't affect the transactions in progress; new
+    /// transactions for a server are not started until the number of its
+    /// transactions drops below the new limit.
+    ///
+    /// @param max_server_transactions is the new limit. The value of zero
+    /// disables the per server limit.
+    void setMaxServerTransactions(const size_t max_server_transactions) {
+        max_server_transactions_ = max_server_transactions;
+    }
+
+    /// @brief Returns the maximum number of updates combined in one DNS
+    /// UPDATE message.
+    size_t getMaxBatchUpdates() const {
+        return (max_batch_updates_);
+    }
+
+    /// @brief Sets the maximum number of updates combined in one DNS UPDATE
+    /// message.
+    ///
+    /// The new value applies to the transactions started afterwards.
+    ///
+    /// @param max_batch_updates is the new limit. The values of zero and one
+    /// disable combining of the updates.
+    void setMaxBatchUpdates(const size_t max_batch_updates);
+
+    /// @brief Returns the batcher used to combine the updates.
+    const DNSUpdateBatcherPtr& getUpdateBatcher() const {
+        return (batcher_);
+    }
+
+    /// @brief Returns the number of transactions charged to the given server.
+    ///
+    /// @param server_key key of the server as returned by getServerKey().
+    size_t getServerTransactionCount(const std::string& server_key) const;
+
     /// @brief Search the transaction list for the given key.
     ///
     /// @param key the transaction key value for which to search.
@@ -234,6 +342,10 @@ public:
     size_t getTransactionCount() const;
 
 private:
+    /// @brief Releases the server charged with the given transaction.
+    ///
+    /// @param key of the transaction being removed from the list.
+    void releaseServer(const TransactionKey& key);
     /// @brief Pointer to the queue manager.
     D2QueueMgrPtr queue_mgr_;
 
@@ -251,8 +363,23 @@ private:
     /// @brief Maximum number of concurrent transactions.
     size_t max_transactions_;
 
+    /// @brief Maximum number of concurrent transactions per DNS server.
+    size_t max_server_transactions_;
+
+    /// @brief Maximum number of updates combined in one DNS UPDATE message.
+    size_t max_batch_updates_;
+
+    /// @brief Batcher combining the updates of the transactions.
+    DNSUpdateBatcherPtr batcher_;
+
     /// @brief List of transactions.
     TransactionList transaction_list_;
+
+    /// @brief Keys of the servers charged with the transactions.
+    std::map<TransactionKey, std::string> transaction_servers_;
+
+    /// @brief Number of transactions charged to each server.
+    std::map<std::string, size_t> server_transactions_;
 };
 
 /// @brief Defines a pointer to a D2UpdateMgr instance.
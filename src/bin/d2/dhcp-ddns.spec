@@ -24,6 +24,24 @@
         "item_optional": true,
         "item_default": 53001 
     },
+    {
+        "item_name": "max_transactions",
+        "item_type": "integer",
+        "item_optional": true,
+        "item_default": 32
+    },
+    {
+        "item_name": "max_server_transactions",
+        "item_type": "integer",
+        "item_optional": true,
+        "item_default": 0
+    },
+    {
+        "item_name": "max_batch_updates",
+        "item_type": "integer",
+        "item_optional": true,
+        "item_default": 1
+    },
     {
         "item_name": "tsig_keys",
         "item_type": "list",
@@ -27,6 +27,12 @@ namespace {
 // DNSClient class.
 const size_t DEFAULT_BUFFER_SIZE = 128;
 
+// Offset of the DNS header octet holding the TC (truncated) flag.
+const size_t TC_FLAG_OFFSET = 2;
+
+// Mask of the TC flag within the header octet.
+const uint8_t TC_FLAG_MASK = 0x02;
+
 }
 
 using namespace bundy::util;
@@ -60,6 +66,16 @@ public:
     DNSClient::Callback* callback_;
     // A Transport Layer protocol used to communicate with a DNS.
     DNSClient::Protocol proto_;
+    // The parameters of the exchange in progress. They are retained so as
+    // the update can be resent over TCP if the UDP response is truncated.
+    asiolink::IOService* io_service_;
+    asiolink::IOAddress ns_addr_;
+    uint16_t ns_port_;
+    util::OutputBufferPtr msg_buf_;
+    unsigned int wait_;
+    // Indicates that the exchange in progress is the TCP retry of an update
+    // whose UDP response was truncated.
+    bool tcp_fallback_;
 
     // Constructor and Destructor
     DNSClientImpl(D2UpdateMessagePtr& response_placeholder,
@@ -82,13 +98,22 @@ public:
 
     // This function maps the IO error to the DNSClient error.
     DNSClient::Status getStatus(const asiodns::IOFetch::Result);
+
+    // Checks if the received response has the TC flag set.
+    bool isTruncated() const;
+
+    // Posts the fetch of the rendered update message over the specified
+    // protocol.
+    void postFetch(const asiodns::IOFetch::Protocol proto);
 };
 
 DNSClientImpl::DNSClientImpl(D2UpdateMessagePtr& response_placeholder,
                              DNSClient::Callback* callback,
                              const DNSClient::Protocol proto)
     : in_buf_(new OutputBuffer(DEFAULT_BUFFER_SIZE)),
-      response_(response_placeholder), callback_(callback), proto_(proto) {
+      response_(response_placeholder), callback_(callback), proto_(proto),
+      io_service_(NULL), ns_addr_("0.0.0.0"), ns_port_(0), msg_buf_(),
+      wait_(0), tcp_fallback_(false) {
 
     // Response should be an empty pointer. It gets populated by the
     // operator() method.
@@ -96,17 +121,6 @@ DNSClientImpl::DNSClientImpl(D2UpdateMessagePtr& response_placeholder,
         bundy_throw(bundy::BadValue, "Response buffer pointer should be null");
     }
 
-    // @todo Currently we only support UDP. The support for TCP is planned for
-    // the future release.
-    if (proto_ == DNSClient::TCP) {
-        bundy_throw(bundy::NotImplemented, "TCP is currently not supported as a"
-                  << " Transport protocol for DNS Updates; please use UDP");
-    }
-
-    // Given that we already eliminated the possibility that TCP is used, it
-    // would be sufficient  to check that (proto != DNSClient::UDP). But, once
-    // support TCP is added the check above will disappear and the extra check
-    // will be needed here anyway.
     // Note that cascaded check is used here instead of:
     //   if (proto_ != DNSClient::TCP && proto_ != DNSClient::UDP)..
     // because some versions of GCC compiler complain that check above would
@@ -129,6 +143,20 @@ DNSClientImpl::operator()(asiodns::IOFetch::Result result) {
     // Get the status from IO. If no success, we just call user's callback
     // and pass the status code.
     DNSClient::Status status = getStatus(result);
+
+    // The response sent over UDP may be truncated if it doesn't fit into
+    // the datagram. The server is then expected to send the complete
+    // response over TCP, so repeat the exchange using TCP.
+    if ((status == DNSClient::SUCCESS) && !tcp_fallback_ &&
+        (proto_ == DNSClient::UDP) && isTruncated()) {
+        LOG_DEBUG(dctl_logger, DBGLVL_TRACE_DETAIL,
+                  DHCP_DDNS_UPDATE_RESPONSE_TRUNCATED)
+                  .arg(ns_addr_.toText()).arg(ns_port_);
+        tcp_fallback_ = true;
+        postFetch(IOFetch::TCP);
+        return;
+    }
+
     if (status == DNSClient::SUCCESS) {
         InputBuffer response_buf(in_buf_->getData(), in_buf_->getLength());
         // Allocate a new response message. (Note that Message::fromWire
@@ -175,6 +203,30 @@ DNSClientImpl::getStatus(const asiodns::IOFetch::Result result) {
     return (DNSClient::OTHER);
 }
 
+bool
+DNSClientImpl::isTruncated() const {
+    return ((in_buf_->getLength() > TC_FLAG_OFFSET) &&
+            (((*in_buf_)[TC_FLAG_OFFSET] & TC_FLAG_MASK) != 0));
+}
+
+void
+DNSClientImpl::postFetch(const IOFetch::Protocol proto) {
+    // IOFetch has all the mechanisms that we need to perform asynchronous
+    // communication with the DNS server. The last but one argument points to
+    // this object as a completion callback for the message exchange. As a
+    // result operator()(Status) will be called.
+
+    // Timeout value is explicitly cast to the int type to avoid warnings about
+    // overflows when doing implicit cast. It should have been checked by the
+    // caller that the unsigned timeout value will fit into int.
+    IOFetch io_fetch(proto, *io_service_, msg_buf_, ns_addr_, ns_port_,
+                     in_buf_, this, static_cast<int>(wait_));
+
+    // Post the task to the task queue in the IO service. Caller will actually
+    // run these tasks by executing IOService::run.
+    io_service_->post(io_fetch);
+}
+
 void
 DNSClientImpl::doUpdate(asiolink::IOService& io_service,
                         const IOAddress& ns_addr,
@@ -195,20 +247,16 @@ DNSClientImpl::doUpdate(asiolink::IOService& io_service,
     // invalid message object is given.
     update.toWire(renderer);
 
-    // IOFetch has all the mechanisms that we need to perform asynchronous
-    // communication with the DNS server. The last but one argument points to
-    // this object as a completion callback for the message exchange. As a
-    // result operator()(Status) will be called.
-
-    // Timeout value is explicitly cast to the int type to avoid warnings about
-    // overflows when doing implicit cast. It should have been checked by the
-    // caller that the unsigned timeout value will fit into int.
-    IOFetch io_fetch(IOFetch::UDP, io_service, msg_buf, ns_addr, ns_port,
-                     in_buf_, this, static_cast<int>(wait));
+    // Retain the exchange parameters in case the update has to be resent
+    // over TCP.
+    io_service_ = &io_service;
+    ns_addr_ = ns_addr;
+    ns_port_ = ns_port;
+    msg_buf_ = msg_buf;
+    wait_ = wait;
+    tcp_fallback_ = false;
 
-    // Post the task to the task queue in the IO service. Caller will actually
-    // run these tasks by executing IOService::run.
-    io_service.post(io_fetch);
+    postFetch(proto_ == DNSClient::TCP ? IOFetch::TCP : IOFetch::UDP);
 }
 
 
@@ -47,13 +47,12 @@ class DNSClientImpl;
 /// encapsulate DNS response, through class constructor. An exception will be
 /// thrown if the pointer is not initialized by the caller.
 ///
-/// @todo Ultimately, this class will support both TCP and UDP Transport.
-/// Currently only UDP is supported and can be specified as a preferred
-/// protocol. @c DNSClient constructor will throw an exception if TCP is
-/// specified. Once both protocols are supported, the @c DNSClient logic will
-/// try to obey caller's preference. However, it may use the other protocol if
-/// on its own discretion, when there is a legitimate reason to do so. For
-/// example, if communication with the server using preferred protocol fails.
+/// Both UDP and TCP Transport are supported and the caller specifies the
+/// preferred protocol in the constructor. The @c DNSClient obeys the caller's
+/// preference, except when the response to the update sent over UDP has the
+/// TC (truncated) flag set. In such case the update is sent again over TCP
+/// and the caller-supplied callback is invoked when the response to the TCP
+/// exchange is received.
 class DNSClient {
 public:
 
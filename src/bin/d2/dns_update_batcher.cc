@@ -0,0 +1,384 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <d2/dns_update_batcher.h>
+#include <d2/d2_log.h>
+#include <dns/rcode.h>
+
+#include <sstream>
+
+namespace bundy {
+namespace d2 {
+
+namespace {
+
+// Length of the DNS message header.
+const size_t HEADER_LENGTH = 12;
+
+// Returns the wire length of the zone section holding the given zone.
+size_t
+getZoneLength(const D2Zone& zone) {
+    // Name followed by the type and class.
+    return (zone.getName().getLength() + 4);
+}
+
+// Returns the estimated wire length of the prerequisite and update sections
+// of the update. Name compression is not accounted for, so the estimate
+// errs on the large side.
+size_t
+getRecordsLength(const D2UpdateMessage& update) {
+    size_t length = 0;
+    for (dns::RRsetIterator it =
+             update.beginSection(D2UpdateMessage::SECTION_PREREQUISITE);
+         it != update.endSection(D2UpdateMessage::SECTION_PREREQUISITE);
+         ++it) {
+        length += (*it)->getLength();
+    }
+    for (dns::RRsetIterator it =
+             update.beginSection(D2UpdateMessage::SECTION_UPDATE);
+         it != update.endSection(D2UpdateMessage::SECTION_UPDATE); ++it) {
+        length += (*it)->getLength();
+    }
+    return (length);
+}
+
+// Returns the key of the pending batch for the server and the zone.
+std::string
+getBatchKey(const asiolink::IOAddress& ns_addr, const uint16_t ns_port,
+            const D2Zone& zone) {
+    std::ostringstream stream;
+    stream << ns_addr.toText() << " port:" << ns_port << " "
+           << zone.getName().toText() << " " << zone.getClass().toText();
+    return (stream.str());
+}
+
+}
+
+const size_t DNSUpdateBatcher::MAX_BATCH_UPDATES_DEFAULT;
+const size_t DNSUpdateBatcher::MAX_BATCH_SIZE_DEFAULT;
+const size_t DNSUpdateBatcher::MAX_UDP_SIZE;
+
+DNSUpdateBatcher::DNSUpdateBatcher(const IOServicePtr& io_service,
+                                   const size_t max_updates,
+                                   const size_t max_size)
+    : io_service_(io_service), max_updates_(0), max_size_(0), pending_(),
+      sent_(), batch_count_(0), fallback_count_(0) {
+    if (!io_service_) {
+        bundy_throw(DNSUpdateBatcherError, "IOServicePtr cannot be null");
+    }
+
+    setMaxUpdates(max_updates);
+    setMaxSize(max_size);
+}
+
+DNSUpdateBatcher::~DNSUpdateBatcher() {
+    clear();
+}
+
+void
+DNSUpdateBatcher::setMaxUpdates(const size_t max_updates) {
+    if (max_updates == 0) {
+        bundy_throw(DNSUpdateBatcherError,
+                    "DNSUpdateBatcher maximum updates must be greater than 0");
+    }
+
+    max_updates_ = max_updates;
+}
+
+void
+DNSUpdateBatcher::setMaxSize(const size_t max_size) {
+    if (max_size == 0) {
+        bundy_throw(DNSUpdateBatcherError,
+                    "DNSUpdateBatcher maximum size must be greater than 0");
+    }
+
+    max_size_ = max_size;
+}
+
+void
+DNSUpdateBatcher::submit(const DNSClientPtr& client,
+                         DNSClient::Callback* callback,
+                         D2UpdateMessagePtr& response,
+                         const asiolink::IOAddress& ns_addr,
+                         const uint16_t ns_port,
+                         const D2UpdateMessagePtr& update,
+                         const unsigned int wait) {
+    if (!client || !callback || !update) {
+        bundy_throw(DNSUpdateBatcherError, "DNSUpdateBatcher: the client,"
+                    " callback and update must not be null");
+    }
+
+    D2ZonePtr zone = update->getZone();
+    if (!zone) {
+        bundy_throw(DNSUpdateBatcherError,
+                    "DNSUpdateBatcher: the update has no zone");
+    }
+
+    Member member;
+    member.client_ = client;
+    member.callback_ = callback;
+    member.response_ = &response;
+    member.update_ = update;
+    member.wait_ = wait;
+
+    const size_t length = getRecordsLength(*update);
+    const std::string key = getBatchKey(ns_addr, ns_port, *zone);
+    std::map<std::string, BatchPtr>::iterator it = pending_.find(key);
+    if ((it != pending_.end()) && !it->second->canAdd(*update, length)) {
+        BatchPtr batch = it->second;
+        pending_.erase(it);
+        sendBatch(batch);
+        it = pending_.end();
+    }
+
+    if (it == pending_.end()) {
+        BatchPtr batch(new Batch(*this, ns_addr, ns_port, zone));
+        it = pending_.insert(std::make_pair(key, batch)).first;
+    }
+
+    it->second->add(member, length);
+    if (it->second->getSize() >= max_updates_) {
+        BatchPtr batch = it->second;
+        pending_.erase(it);
+        sendBatch(batch);
+    }
+}
+
+size_t
+DNSUpdateBatcher::flush() {
+    // Forget the batches which are complete.
+    std::list<BatchPtr>::iterator it = sent_.begin();
+    while (it != sent_.end()) {
+        if ((*it)->isDone()) {
+            it = sent_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Swap the pending batches out first, as sending one of them may
+    // invoke a callback which submits another update.
+    std::map<std::string, BatchPtr> pending;
+    pending.swap(pending_);
+    for (std::map<std::string, BatchPtr>::iterator batch = pending.begin();
+         batch != pending.end(); ++batch) {
+        sendBatch(batch->second);
+    }
+
+    return (pending.size());
+}
+
+void
+DNSUpdateBatcher::clear() {
+    pending_.clear();
+    // The batches waiting for the response must outlive the exchange. They
+    // are only prevented from calling back their submitters.
+    for (std::list<BatchPtr>::iterator it = sent_.begin(); it != sent_.end();
+         ++it) {
+        (*it)->cancel();
+    }
+}
+
+size_t
+DNSUpdateBatcher::getPendingCount() const {
+    size_t count = 0;
+    for (std::map<std::string, BatchPtr>::const_iterator it = pending_.begin();
+         it != pending_.end(); ++it) {
+        count += it->second->getSize();
+    }
+    return (count);
+}
+
+void
+DNSUpdateBatcher::sendBatch(const BatchPtr& batch) {
+    if (batch->getSize() > 1) {
+        sent_.push_back(batch);
+        ++batch_count_;
+    }
+    batch->send();
+}
+
+DNSUpdateBatcher::Batch::Batch(DNSUpdateBatcher& batcher,
+                               const asiolink::IOAddress& ns_addr,
+                               const uint16_t ns_port, const D2ZonePtr& zone)
+    : batcher_(batcher), ns_addr_(ns_addr), ns_port_(ns_port), zone_(zone),
+      members_(), names_(), length_(HEADER_LENGTH + getZoneLength(*zone)),
+      client_(), update_(), response_(), done_(false), cancelled_(false) {
+}
+
+bool
+DNSUpdateBatcher::Batch::canAdd(const D2UpdateMessage& update,
+                                const size_t length) const {
+    if ((members_.size() >= batcher_.max_updates_) ||
+        (length_ + length > batcher_.max_size_)) {
+        return (false);
+    }
+
+    // Updates of the same names may depend on each other's outcome, so
+    // they are never combined.
+    for (dns::RRsetIterator it =
+             update.beginSection(D2UpdateMessage::SECTION_PREREQUISITE);
+         it != update.endSection(D2UpdateMessage::SECTION_PREREQUISITE);
+         ++it) {
+        if (names_.count((*it)->getName()) > 0) {
+            return (false);
+        }
+    }
+    for (dns::RRsetIterator it =
+             update.beginSection(D2UpdateMessage::SECTION_UPDATE);
+         it != update.endSection(D2UpdateMessage::SECTION_UPDATE); ++it) {
+        if (names_.count((*it)->getName()) > 0) {
+            return (false);
+        }
+    }
+
+    return (true);
+}
+
+void
+DNSUpdateBatcher::Batch::add(const Member& member, const size_t length) {
+    const D2UpdateMessage& update = *member.update_;
+    for (dns::RRsetIterator it =
+             update.beginSection(D2UpdateMessage::SECTION_PREREQUISITE);
+         it != update.endSection(D2UpdateMessage::SECTION_PREREQUISITE);
+         ++it) {
+        names_.insert((*it)->getName());
+    }
+    for (dns::RRsetIterator it =
+             update.beginSection(D2UpdateMessage::SECTION_UPDATE);
+         it != update.endSection(D2UpdateMessage::SECTION_UPDATE); ++it) {
+        names_.insert((*it)->getName());
+    }
+
+    members_.push_back(member);
+    length_ += length;
+}
+
+void
+DNSUpdateBatcher::Batch::sendMember(const Member& member) {
+    try {
+        member.client_->doUpdate(*batcher_.io_service_, ns_addr_, ns_port_,
+                                 *member.update_, member.wait_);
+    } catch (const std::exception& ex) {
+        LOG_ERROR(dctl_logger, DHCP_DDNS_TRANS_SEND_ERROR).arg(ex.what());
+        (*member.callback_)(DNSClient::OTHER);
+    }
+}
+
+void
+DNSUpdateBatcher::Batch::send() {
+    if (members_.size() == 1) {
+        done_ = true;
+        sendMember(members_[0]);
+        return;
+    }
+
+    // Combine the prerequisites and the updates of all members. The RRsets
+    // are shared with the members' messages, which are left intact for
+    // the case the combined update is refused.
+    update_.reset(new D2UpdateMessage(D2UpdateMessage::OUTBOUND));
+    update_->setZone(zone_->getName(), zone_->getClass());
+    unsigned int wait = 0;
+    for (std::vector<Member>::const_iterator member = members_.begin();
+         member != members_.end(); ++member) {
+        const D2UpdateMessage& update = *member->update_;
+        for (dns::RRsetIterator it =
+                 update.beginSection(D2UpdateMessage::SECTION_PREREQUISITE);
+             it != update.endSection(D2UpdateMessage::SECTION_PREREQUISITE);
+             ++it) {
+            update_->addRRset(D2UpdateMessage::SECTION_PREREQUISITE, *it);
+        }
+        if (member->wait_ > wait) {
+            wait = member->wait_;
+        }
+    }
+    for (std::vector<Member>::const_iterator member = members_.begin();
+         member != members_.end(); ++member) {
+        const D2UpdateMessage& update = *member->update_;
+        for (dns::RRsetIterator it =
+                 update.beginSection(D2UpdateMessage::SECTION_UPDATE);
+             it != update.endSection(D2UpdateMessage::SECTION_UPDATE);
+             ++it) {
+            update_->addRRset(D2UpdateMessage::SECTION_UPDATE, *it);
+        }
+    }
+
+    client_.reset(new DNSClient(response_, this,
+                                (length_ > MAX_UDP_SIZE ? DNSClient::TCP :
+                                 DNSClient::UDP)));
+    try {
+        client_->doUpdate(*batcher_.io_service_, ns_addr_, ns_port_, *update_,
+                          wait);
+    } catch (const std::exception& ex) {
+        LOG_ERROR(dctl_logger, DHCP_DDNS_TRANS_SEND_ERROR).arg(ex.what());
+        (*this)(DNSClient::OTHER);
+        return;
+    }
+
+    LOG_DEBUG(dctl_logger, DBGLVL_TRACE_DETAIL, DHCP_DDNS_BATCH_UPDATE_SENT)
+              .arg(members_.size())
+              .arg(zone_->getName().toText())
+              .arg(ns_addr_.toText());
+}
+
+void
+DNSUpdateBatcher::Batch::operator()(DNSClient::Status status) {
+    done_ = true;
+    if (cancelled_) {
+        return;
+    }
+
+    if ((status == DNSClient::SUCCESS) && response_ &&
+        (response_->getRcode() == dns::Rcode::NOERROR())) {
+        for (std::vector<Member>::const_iterator member = members_.begin();
+             member != members_.end(); ++member) {
+            *(member->response_) = response_;
+            (*member->callback_)(DNSClient::SUCCESS);
+        }
+        return;
+    }
+
+    if ((status == DNSClient::SUCCESS) ||
+        (status == DNSClient::INVALID_RESPONSE)) {
+        // The server refused the combined update. Let each request
+        // find out its own outcome.
+        ++batcher_.fallback_count_;
+        std::ostringstream stream;
+        if (response_) {
+            stream << response_->getRcode().toText();
+        } else {
+            stream << "invalid response";
+        }
+        LOG_DEBUG(dctl_logger, DBGLVL_TRACE_DETAIL,
+                  DHCP_DDNS_BATCH_UPDATE_FALLBACK)
+                  .arg(members_.size())
+                  .arg(zone_->getName().toText())
+                  .arg(ns_addr_.toText())
+                  .arg(stream.str());
+        for (std::vector<Member>::const_iterator member = members_.begin();
+             member != members_.end(); ++member) {
+            sendMember(*member);
+        }
+        return;
+    }
+
+    // The exchange itself failed, so would have the individual ones.
+    for (std::vector<Member>::const_iterator member = members_.begin();
+         member != members_.end(); ++member) {
+        (*member->callback_)(status);
+    }
+}
+
+} // namespace bundy::d2
+} // namespace bundy
@@ -0,0 +1,299 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef DNS_UPDATE_BATCHER_H
+#define DNS_UPDATE_BATCHER_H
+
+/// @file dns_update_batcher.h This file defines the class DNSUpdateBatcher.
+
+#include <exceptions/exceptions.h>
+#include <asiolink/io_address.h>
+#include <d2/d2_asio.h>
+#include <d2/d2_update_message.h>
+#include <d2/dns_client.h>
+#include <dns/name.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace bundy {
+namespace d2 {
+
+/// @brief Thrown if the update batcher encounters a general error.
+class DNSUpdateBatcherError : public bundy::Exception {
+public:
+    DNSUpdateBatcherError(const char* file, size_t line, const char* what) :
+        bundy::Exception(file, line, what) { };
+};
+
+/// @brief Combines DNS updates for the same zone into single messages.
+///
+/// When a large number of requests is processed, many of the transactions
+/// send an update for the same zone to the same DNS server at nearly the
+/// same time. Rather than sending each of them in its own message, the
+/// transactions may submit their updates to the DNSUpdateBatcher, which
+/// holds them until flush() is called and then sends a single UPDATE message
+/// per server and zone. The message carries the prerequisites and the
+/// updates of all of the combined requests.
+///
+/// RFC 2136 evaluates all of the prerequisites of the message before any of
+/// its updates is applied, and the message succeeds or fails as a whole. In
+/// order to preserve the outcome each request would have on its own:
+///
+/// - Updates whose owner names overlap with those of an update already in
+/// the batch are never combined with it. Instead, the pending batch is sent
+/// and the update starts a new one.
+///
+/// - The combined update is only accepted when the server responds with
+/// NOERROR. Each submitter is then called back with the shared response.
+///
+/// - If the server refuses the combined update for any reason, e.g. because
+/// the prerequisites of one of the requests were not met, each update is sent
+/// again on its own using the submitter's DNSClient, and the submitter sees
+/// the response to its own update only.
+///
+/// A batch is also sent as soon as it holds the maximum number of updates or
+/// adding another update would make the message exceed the maximum size.
+/// A batch holding a single update is sent using the submitter's DNSClient
+/// as if the batcher was not used at all.
+class DNSUpdateBatcher : public boost::noncopyable {
+public:
+    /// @brief Default maximum number of updates combined in one message.
+    static const size_t MAX_BATCH_UPDATES_DEFAULT = 16;
+
+    /// @brief Default maximum size of the combined message in bytes.
+    static const size_t MAX_BATCH_SIZE_DEFAULT = 4096;
+
+    /// @brief Maximum size of the combined message sent over UDP.
+    ///
+    /// Larger combined messages are sent over TCP.
+    static const size_t MAX_UDP_SIZE = 512;
+
+    /// @brief Constructor
+    ///
+    /// @param io_service IO service used to carry out the DNS exchanges.
+    /// @param max_updates maximum number of updates in one message.
+    /// @param max_size maximum size of the combined message in bytes.
+    ///
+    /// @throw DNSUpdateBatcherError if the IO service is NULL or either of
+    /// the limits is zero.
+    DNSUpdateBatcher(const IOServicePtr& io_service,
+                     const size_t max_updates = MAX_BATCH_UPDATES_DEFAULT,
+                     const size_t max_size = MAX_BATCH_SIZE_DEFAULT);
+
+    /// @brief Destructor
+    ~DNSUpdateBatcher();
+
+    /// @brief Submits an update to be sent to the given server.
+    ///
+    /// The update is added to the pending batch for the server and the zone
+    /// of the update. If the batch can't take the update, it is sent first
+    /// and the update starts a new batch.
+    ///
+    /// @param client DNSClient of the submitter. It is used to send the
+    /// update on its own if it can't be combined with other updates.
+    /// @param callback callback invoked when the exchange completes. It is
+    /// normally the same callback the client was constructed with.
+    /// @param response response placeholder of the client. It is set to the
+    /// response of the combined update when that update succeeds.
+    /// @param ns_addr DNS server address.
+    /// @param ns_port DNS server port.
+    /// @param update update message to be sent.
+    /// @param wait timeout (in milliseconds) for the response.
+    ///
+    /// @throw DNSUpdateBatcherError if any of the pointers is NULL or the
+    /// update has no zone.
+    void submit(const DNSClientPtr& client, DNSClient::Callback* callback,
+                D2UpdateMessagePtr& response,
+                const asiolink::IOAddress& ns_addr, const uint16_t ns_port,
+                const D2UpdateMessagePtr& update, const unsigned int wait);
+
+    /// @brief Sends all pending batches.
+    ///
+    /// It also discards the batches which have been sent and are complete.
+    ///
+    /// @return number of messages sent.
+    size_t flush();
+
+    /// @brief Discards the pending updates and cancels the sent batches.
+    ///
+    /// Submitters of cancelled batches are not called back.
+    void clear();
+
+    /// @brief Returns the number of updates waiting to be sent.
+    size_t getPendingCount() const;
+
+    /// @brief Returns the number of combined messages sent so far.
+    size_t getBatchCount() const {
+        return (batch_count_);
+    }
+
+    /// @brief Returns the number of combined messages which were refused
+    /// and whose updates have been sent individually.
+    size_t getFallbackCount() const {
+        return (fallback_count_);
+    }
+
+    /// @brief Returns the maximum number of updates in one message.
+    size_t getMaxUpdates() const {
+        return (max_updates_);
+    }
+
+    /// @brief Sets the maximum number of updates in one message.
+    ///
+    /// @param max_updates the new limit.
+    ///
+    /// @throw DNSUpdateBatcherError if the limit is zero.
+    void setMaxUpdates(const size_t max_updates);
+
+    /// @brief Returns the maximum size of the combined message.
+    size_t getMaxSize() const {
+        return (max_size_);
+    }
+
+    /// @brief Sets the maximum size of the combined message.
+    ///
+    /// @param max_size the new limit in bytes.
+    ///
+    /// @throw DNSUpdateBatcherError if the limit is zero.
+    void setMaxSize(const size_t max_size);
+
+private:
+    /// @brief An update submitted to the batcher.
+    struct Member {
+        DNSClientPtr client_;
+        DNSClient::Callback* callback_;
+        D2UpdateMessagePtr* response_;
+        D2UpdateMessagePtr update_;
+        unsigned int wait_;
+    };
+
+    /// @brief Updates for the same server and zone combined in a message.
+    class Batch : public DNSClient::Callback {
+    public:
+        /// @brief Constructor
+        ///
+        /// @param batcher batcher the batch belongs to.
+        /// @param ns_addr DNS server address.
+        /// @param ns_port DNS server port.
+        /// @param zone zone of the updates.
+        Batch(DNSUpdateBatcher& batcher, const asiolink::IOAddress& ns_addr,
+              const uint16_t ns_port, const D2ZonePtr& zone);
+
+        /// @brief Checks if the update may be added to the batch.
+        ///
+        /// @param update update to check.
+        /// @param length estimated wire length of the update's records.
+        bool canAdd(const D2UpdateMessage& update, const size_t length) const;
+
+        /// @brief Adds the update to the batch.
+        ///
+        /// @param member the update.
+        /// @param length estimated wire length of the update's records.
+        void add(const Member& member, const size_t length);
+
+        /// @brief Sends the batch.
+        void send();
+
+        /// @brief Invoked when the exchange of the combined update completes.
+        virtual void operator()(DNSClient::Status status);
+
+        /// @brief Prevents the callbacks of the submitters.
+        void cancel() {
+            cancelled_ = true;
+        }
+
+        /// @brief Checks if the batch has been sent and is complete.
+        bool isDone() const {
+            return (done_);
+        }
+
+        /// @brief Returns the number of updates in the batch.
+        size_t getSize() const {
+            return (members_.size());
+        }
+
+    private:
+        /// @brief Sends the given update on its own.
+        void sendMember(const Member& member);
+
+        /// @brief Batcher the batch belongs to.
+        DNSUpdateBatcher& batcher_;
+        /// @brief DNS server address.
+        asiolink::IOAddress ns_addr_;
+        /// @brief DNS server port.
+        uint16_t ns_port_;
+        /// @brief Zone of the updates.
+        D2ZonePtr zone_;
+        /// @brief Combined updates.
+        std::vector<Member> members_;
+        /// @brief Owner names of the records in the combined updates.
+        std::set<dns::Name> names_;
+        /// @brief Estimated wire length of the combined message.
+        size_t length_;
+        /// @brief Client carrying out the exchange of the combined update.
+        DNSClientPtr client_;
+        /// @brief Combined update message.
+        D2UpdateMessagePtr update_;
+        /// @brief Response to the combined update.
+        D2UpdateMessagePtr response_;
+        /// @brief Indicates if the exchange is complete.
+        bool done_;
+        /// @brief Indicates if the submitters should not be called back.
+        bool cancelled_;
+    };
+
+    /// @brief Defines a pointer to a Batch.
+    typedef boost::shared_ptr<Batch> BatchPtr;
+
+    /// @brief Sends the batch.
+    ///
+    /// Batches holding more than one update are moved to the list of sent
+    /// batches so as they outlive the exchange.
+    void sendBatch(const BatchPtr& batch);
+
+    /// @brief IO service used to carry out the exchanges.
+    IOServicePtr io_service_;
+
+    /// @brief Maximum number of updates in one message.
+    size_t max_updates_;
+
+    /// @brief Maximum size of the combined message.
+    size_t max_size_;
+
+    /// @brief Pending batches, keyed by server and zone.
+    std::map<std::string, BatchPtr> pending_;
+
+    /// @brief Batches sent and possibly waiting for the response.
+    std::list<BatchPtr> sent_;
+
+    /// @brief Number of combined messages sent.
+    size_t batch_count_;
+
+    /// @brief Number of combined messages refused.
+    size_t fallback_count_;
+};
+
+/// @brief Defines a pointer to a DNSUpdateBatcher.
+typedef boost::shared_ptr<DNSUpdateBatcher> DNSUpdateBatcherPtr;
+
+} // namespace bundy::d2
+} // namespace bundy
+
+#endif // DNS_UPDATE_BATCHER_H
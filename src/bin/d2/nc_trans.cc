@@ -50,7 +50,8 @@ NameChangeTransaction(IOServicePtr& io_service,
                       DdnsDomainPtr& forward_domain,
                       DdnsDomainPtr& reverse_domain)
     : io_service_(io_service), ncr_(ncr), forward_domain_(forward_domain),
-     reverse_domain_(reverse_domain), dns_client_(), dns_update_request_(),
+     reverse_domain_(reverse_domain), dns_client_(), update_batcher_(),
+     dns_update_request_(),
      dns_update_status_(DNSClient::OTHER), dns_update_response_(),
      forward_change_completed_(false), reverse_change_completed_(false),
      current_server_list_(), current_server_(), next_server_pos_(0),
@@ -173,9 +174,19 @@ NameChangeTransaction::sendUpdate(const std::string& comment,
 
         // @todo time out should ultimately be configurable, down to
         // server level?
-        dns_client_->doUpdate(*io_service_, current_server_->getIpAddress(),
-                              current_server_->getPort(), *dns_update_request_,
-                              DNS_UPDATE_DEFAULT_TIMEOUT);
+        if (update_batcher_) {
+            update_batcher_->submit(dns_client_, this, dns_update_response_,
+                                    current_server_->getIpAddress(),
+                                    current_server_->getPort(),
+                                    dns_update_request_,
+                                    DNS_UPDATE_DEFAULT_TIMEOUT);
+        } else {
+            dns_client_->doUpdate(*io_service_,
+                                  current_server_->getIpAddress(),
+                                  current_server_->getPort(),
+                                  *dns_update_request_,
+                                  DNS_UPDATE_DEFAULT_TIMEOUT);
+        }
 
         // Message is on its way, so the next event should be NOP_EVT.
         postNextEvent(NOP_EVT);
@@ -451,6 +462,16 @@ NameChangeTransaction::getDNSClient() const {
     return (dns_client_);
 }
 
+void
+NameChangeTransaction::setUpdateBatcher(const DNSUpdateBatcherPtr& batcher) {
+    update_batcher_ = batcher;
+}
+
+const DNSUpdateBatcherPtr&
+NameChangeTransaction::getUpdateBatcher() const {
+    return (update_batcher_);
+}
+
 const DnsServerInfoPtr&
 NameChangeTransaction::getCurrentServer() const {
     return (current_server_);
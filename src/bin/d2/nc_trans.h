@@ -21,6 +21,7 @@
 #include <d2/d2_asio.h>
 #include <d2/d2_config.h>
 #include <d2/dns_client.h>
+#include <d2/dns_update_batcher.h>
 #include <d2/state_model.h>
 #include <dhcp_ddns/ncr_msg.h>
 
@@ -205,7 +206,9 @@ protected:
     /// This method increments the update attempt count and then passes the
     /// current update request to the DNSClient instance to be sent to the
     /// currently selected server.  Since the send is asynchronous, the method
-    /// posts NOP_EVT as the next event and then returns.
+    /// posts NOP_EVT as the next event and then returns. If an update batcher
+    /// has been set, the request is submitted to the batcher instead, which
+    /// sends it along with other requests for the same zone.
     ///
     /// @param comment text to include in log detail
     /// @param use_tsig True if the update should be include a TSIG key. This
@@ -469,6 +472,22 @@ public:
     /// @return A const pointer reference to the DNSClient
     const DNSClientPtr& getDNSClient() const;
 
+    /// @brief Sets the batcher used to send the update requests.
+    ///
+    /// When a batcher is set, the update requests are submitted to it
+    /// rather than sent directly, so as they may be combined with the
+    /// requests of other transactions for the same zone.
+    ///
+    /// @param batcher the batcher to use. An empty pointer means that the
+    /// requests are sent directly.
+    void setUpdateBatcher(const DNSUpdateBatcherPtr& batcher);
+
+    /// @brief Fetches the batcher used to send the update requests.
+    ///
+    /// @return A const pointer reference to the DNSUpdateBatcher, which is
+    /// empty if the requests are sent directly.
+    const DNSUpdateBatcherPtr& getUpdateBatcher() const;
+
     /// @brief Fetches the current DNS update request packet.
     ///
     /// @return A const pointer reference to the current D2UpdateMessage
@@ -541,6 +560,9 @@ private:
     /// @brief The DNSClient instance that will carry out DNS packet exchanges.
     DNSClientPtr dns_client_;
 
+    /// @brief The batcher the update requests are submitted to, if any.
+    DNSUpdateBatcherPtr update_batcher_;
+
     /// @brief The DNS current update request packet.
     D2UpdateMessagePtr dns_update_request_;
 
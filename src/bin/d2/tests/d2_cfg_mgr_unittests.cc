@@ -893,6 +893,9 @@ TEST_F(D2CfgMgrTest, fullConfig) {
                         "\"interface\" : \"eth1\" , "
                         "\"ip_address\" : \"192.168.1.33\" , "
                         "\"port\" : 88 , "
+                        "\"max_transactions\" : 64 , "
+                        "\"max_server_transactions\" : 8 , "
+                        "\"max_batch_updates\" : 16 , "
                         "\"tsig_keys\": ["
                         "{"
                         "  \"name\": \"d2_key.tmark.org\" , "
@@ -964,6 +967,20 @@ TEST_F(D2CfgMgrTest, fullConfig) {
     EXPECT_NO_THROW (context->getParam("port", port));
     EXPECT_EQ(88, port);
 
+    uint32_t max_transactions = 0;
+    EXPECT_NO_THROW (context->getParam("max_transactions", max_transactions));
+    EXPECT_EQ(64, max_transactions);
+
+    uint32_t max_server_transactions = 0;
+    EXPECT_NO_THROW (context->getParam("max_server_transactions",
+                                       max_server_transactions));
+    EXPECT_EQ(8, max_server_transactions);
+
+    uint32_t max_batch_updates = 0;
+    EXPECT_NO_THROW (context->getParam("max_batch_updates",
+                                       max_batch_updates));
+    EXPECT_EQ(16, max_batch_updates);
+
     // Verify that the forward manager can be retrieved.
     DdnsDomainListMgrPtr mgr = context->getForwardMgr();
     ASSERT_TRUE(mgr);
@@ -22,6 +22,8 @@
 #include <gtest/gtest.h>
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <iomanip>
+#include <sstream>
 #include <vector>
 
 using namespace std;
@@ -197,6 +199,190 @@ TEST(D2QueueMgrBasicTest, basicQueue) {
                  D2QueueMgrInvalidIndex);
 }
 
+/// @brief Tests QueueMgr's coalescing of requests
+/// This test verifies that:
+/// 1. Coalescing is enabled by default.
+/// 2. A request replaces the queued request for the same DHCID and FQDN.
+/// 3. Requests for other DHCIDs or FQDNs do not replace queued requests.
+/// 4. A request which doesn't ask for the changes requested by the queued
+/// request or refers to a different address does not replace the queued
+/// request.
+/// 5. Only the last queued request for a DHCID may be replaced.
+TEST(D2QueueMgrBasicTest, coalesce) {
+    IOServicePtr io_service(new bundy::asiolink::IOService());
+    D2QueueMgrPtr queue_mgr;
+    ASSERT_NO_THROW(queue_mgr.reset(new D2QueueMgr(io_service)));
+    EXPECT_TRUE(queue_mgr->getCoalescing());
+    EXPECT_EQ(0, queue_mgr->getSupersededCount());
+
+    // Nothing to replace in the empty queue.
+    NameChangeRequestPtr add_ncr;
+    ASSERT_NO_THROW(add_ncr = NameChangeRequest::fromJSON(valid_msgs[0]));
+    EXPECT_FALSE(queue_mgr->coalesce(add_ncr));
+    ASSERT_NO_THROW(queue_mgr->enqueue(add_ncr));
+
+    // Remove for the same client replaces the add.
+    NameChangeRequestPtr remove_ncr;
+    ASSERT_NO_THROW(remove_ncr = NameChangeRequest::fromJSON(valid_msgs[1]));
+    EXPECT_TRUE(queue_mgr->coalesce(remove_ncr));
+    EXPECT_EQ(1, queue_mgr->getQueueSize());
+    EXPECT_TRUE(*remove_ncr == *(queue_mgr->peek()));
+    EXPECT_EQ(1, queue_mgr->getSupersededCount());
+
+    // And the add replaces the remove.
+    EXPECT_TRUE(queue_mgr->coalesce(add_ncr));
+    EXPECT_EQ(1, queue_mgr->getQueueSize());
+    EXPECT_TRUE(*add_ncr == *(queue_mgr->peek()));
+    EXPECT_EQ(2, queue_mgr->getSupersededCount());
+
+    // Request for another client doesn't replace the queued request.
+    NameChangeRequestPtr ncr(new NameChangeRequest(*add_ncr));
+    ncr->setDhcid("AABBCCDDEEFF");
+    EXPECT_FALSE(queue_mgr->coalesce(ncr));
+
+    // Nor does the request for another FQDN.
+    ncr.reset(new NameChangeRequest(*add_ncr));
+    ncr->setFqdn("other.walah.com");
+    EXPECT_FALSE(queue_mgr->coalesce(ncr));
+
+    // Nor does the forward only remove of another address: the records
+    // added for the queued address would be left in DNS.
+    ncr.reset(new NameChangeRequest(*remove_ncr));
+    ncr->setIpAddress("192.168.2.2");
+    EXPECT_FALSE(queue_mgr->coalesce(ncr));
+    EXPECT_TRUE(*add_ncr == *(queue_mgr->peek()));
+    EXPECT_EQ(2, queue_mgr->getSupersededCount());
+
+    // Queue a request for both directions.
+    queue_mgr->clearQueue();
+    NameChangeRequestPtr both_ncr(new NameChangeRequest(*add_ncr));
+    both_ncr->setReverseChange(true);
+    ASSERT_NO_THROW(queue_mgr->enqueue(both_ncr));
+
+    // Request for the forward change only doesn't replace it.
+    EXPECT_FALSE(queue_mgr->coalesce(remove_ncr));
+
+    // Nor does the request for the reverse change of another address.
+    ncr.reset(new NameChangeRequest(*both_ncr));
+    ncr->setIpAddress("192.168.2.2");
+    EXPECT_FALSE(queue_mgr->coalesce(ncr));
+
+    // Request for both directions and the same address does.
+    ncr.reset(new NameChangeRequest(*both_ncr));
+    ncr->setChangeType(dhcp_ddns::CHG_REMOVE);
+    EXPECT_TRUE(queue_mgr->coalesce(ncr));
+    EXPECT_TRUE(*ncr == *(queue_mgr->peek()));
+    EXPECT_EQ(3, queue_mgr->getSupersededCount());
+
+    // Queue a request for the same client but another FQDN. The first
+    // request can't be replaced anymore.
+    NameChangeRequestPtr other_ncr(new NameChangeRequest(*both_ncr));
+    other_ncr->setFqdn("other.walah.com");
+    ASSERT_NO_THROW(queue_mgr->enqueue(other_ncr));
+    EXPECT_FALSE(queue_mgr->coalesce(both_ncr));
+    EXPECT_EQ(2, queue_mgr->getQueueSize());
+    EXPECT_EQ(3, queue_mgr->getSupersededCount());
+}
+
+/// @brief Tests that coalescing follows requests removed from the queue
+/// This test verifies that when the last queued request for a DHCID is
+/// removed out of order, the previous one for the DHCID can be replaced,
+/// and that no request can be replaced once all of them are removed.
+TEST(D2QueueMgrBasicTest, coalesceAfterDequeue) {
+    IOServicePtr io_service(new bundy::asiolink::IOService());
+    D2QueueMgrPtr queue_mgr;
+    ASSERT_NO_THROW(queue_mgr.reset(new D2QueueMgr(io_service)));
+
+    // Queue two requests for the same client with another client's request
+    // in between.
+    NameChangeRequestPtr add_ncr;
+    ASSERT_NO_THROW(add_ncr = NameChangeRequest::fromJSON(valid_msgs[0]));
+    ASSERT_NO_THROW(queue_mgr->enqueue(add_ncr));
+    NameChangeRequestPtr other_ncr(new NameChangeRequest(*add_ncr));
+    other_ncr->setDhcid("AABBCCDDEEFF");
+    ASSERT_NO_THROW(queue_mgr->enqueue(other_ncr));
+    NameChangeRequestPtr last_ncr(new NameChangeRequest(*add_ncr));
+    last_ncr->setFqdn("other.walah.com");
+    ASSERT_NO_THROW(queue_mgr->enqueue(last_ncr));
+
+    // The first request can't be replaced while the last one is queued.
+    NameChangeRequestPtr remove_ncr;
+    ASSERT_NO_THROW(remove_ncr = NameChangeRequest::fromJSON(valid_msgs[1]));
+    EXPECT_FALSE(queue_mgr->coalesce(remove_ncr));
+
+    // Once the last one is removed, it can.
+    ASSERT_NO_THROW(queue_mgr->dequeueAt(2));
+    EXPECT_TRUE(queue_mgr->coalesce(remove_ncr));
+    EXPECT_TRUE(*remove_ncr == *(queue_mgr->peekAt(0)));
+    EXPECT_TRUE(*other_ncr == *(queue_mgr->peekAt(1)));
+
+    // Removing the other client's request doesn't affect it.
+    ASSERT_NO_THROW(queue_mgr->dequeueAt(1));
+    EXPECT_TRUE(queue_mgr->coalesce(add_ncr));
+    EXPECT_TRUE(*add_ncr == *(queue_mgr->peek()));
+
+    // Nothing is replaced after the request is dequeued.
+    ASSERT_NO_THROW(queue_mgr->dequeue());
+    EXPECT_FALSE(queue_mgr->coalesce(remove_ncr));
+    EXPECT_EQ(0, queue_mgr->getQueueSize());
+    EXPECT_EQ(2, queue_mgr->getSupersededCount());
+}
+
+/// @brief Tests coalescing in a deep queue
+/// This test fills a large queue with requests for distinct clients, then
+/// verifies that a request for each of them replaces its queued request, in
+/// place, and that dequeuing keeps the index in step with the queue.
+TEST(D2QueueMgrBasicTest, coalesceDeepQueue) {
+    const size_t count = 20000;
+    IOServicePtr io_service(new bundy::asiolink::IOService());
+    D2QueueMgrPtr queue_mgr;
+    ASSERT_NO_THROW(queue_mgr.reset(new D2QueueMgr(io_service, count)));
+
+    NameChangeRequestPtr add_ncr;
+    ASSERT_NO_THROW(add_ncr = NameChangeRequest::fromJSON(valid_msgs[0]));
+    std::vector<std::string> dhcids;
+    for (size_t i = 0; i < count; ++i) {
+        std::ostringstream stream;
+        stream << std::hex << std::uppercase << std::setw(8)
+               << std::setfill('0') << i;
+        dhcids.push_back(stream.str());
+        NameChangeRequestPtr ncr(new NameChangeRequest(*add_ncr));
+        ncr->setDhcid(dhcids.back());
+        ASSERT_FALSE(queue_mgr->coalesce(ncr));
+        ASSERT_NO_THROW(queue_mgr->enqueue(ncr));
+    }
+
+    // Supersede the requests in reverse order.
+    for (size_t i = count; i > 0; --i) {
+        NameChangeRequestPtr ncr(new NameChangeRequest(*add_ncr));
+        ncr->setDhcid(dhcids[i - 1]);
+        ncr->setChangeType(dhcp_ddns::CHG_REMOVE);
+        ASSERT_TRUE(queue_mgr->coalesce(ncr));
+    }
+    EXPECT_EQ(count, queue_mgr->getQueueSize());
+    EXPECT_EQ(count, queue_mgr->getSupersededCount());
+
+    // Each of them replaced its own request.
+    for (size_t i = 0; i < count; ++i) {
+        const NameChangeRequestPtr& ncr = queue_mgr->peekAt(i);
+        ASSERT_EQ(dhcp_ddns::CHG_REMOVE, ncr->getChangeType());
+        ASSERT_EQ(dhcids[i], ncr->getDhcid().toStr());
+    }
+
+    // Take the first half off the queue: those clients can't be coalesced
+    // any more, but the rest still can.
+    for (size_t i = 0; i < count / 2; ++i) {
+        queue_mgr->dequeue();
+    }
+    for (size_t i = 0; i < count; ++i) {
+        NameChangeRequestPtr ncr(new NameChangeRequest(*add_ncr));
+        ncr->setDhcid(dhcids[i]);
+        ncr->setChangeType(dhcp_ddns::CHG_REMOVE);
+        ASSERT_EQ(i >= count / 2, queue_mgr->coalesce(ncr));
+    }
+    EXPECT_EQ(count / 2, queue_mgr->getQueueSize());
+}
+
 /// @brief Compares two NameChangeRequests for equality.
 bool checkSendVsReceived(NameChangeRequestPtr sent_ncr,
                          NameChangeRequestPtr received_ncr) {
@@ -347,6 +533,10 @@ TEST_F (QueueMgrUDPTest, liveFeed) {
                                                     VALID_MSG_CNT)));
     ASSERT_EQ(D2QueueMgr::NOT_INITTED, queue_mgr_->getMgrState());
 
+    // Some of the requests are for the same client. Disable coalescing
+    // so as they are all queued.
+    queue_mgr_->setCoalescing(false);
+
     // Verify that setting max queue size to 0 is not allowed.
     EXPECT_THROW(queue_mgr_->setMaxQueueSize(0), D2QueueMgrError);
     EXPECT_EQ(VALID_MSG_CNT, queue_mgr_->getMaxQueueSize());
@@ -442,4 +632,39 @@ TEST_F (QueueMgrUDPTest, liveFeed) {
     EXPECT_EQ(1, queue_mgr_->getQueueSize());
 }
 
+/// @brief Tests D2QueueMgr's coalescing of received requests
+/// This test verifies that the received requests replace the queued
+/// requests for the same client, even if the queue is full.
+TEST_F (QueueMgrUDPTest, liveFeedCoalescing) {
+    NameChangeRequestPtr send_ncr;
+    NameChangeRequestPtr received_ncr;
+
+    // Create the queue manager with room for one request only.
+    ASSERT_NO_THROW(queue_mgr_.reset(new D2QueueMgr(io_service_, 1)));
+    bundy::asiolink::IOAddress addr(TEST_ADDRESS);
+    ASSERT_NO_THROW(queue_mgr_->initUDPListener(addr, LISTENER_PORT,
+                                                FMT_JSON, true));
+    ASSERT_NO_THROW(queue_mgr_->startListening());
+    ASSERT_NO_THROW(sender_->startSending(*io_service_));
+
+    // Send add, remove and add for the same client.
+    const int msg_idx[] = { 0, 1, 0 };
+    for (int i = 0; i < sizeof(msg_idx) / sizeof(msg_idx[0]); i++) {
+        ASSERT_NO_THROW(send_ncr =
+                        NameChangeRequest::fromJSON(valid_msgs[msg_idx[i]]));
+        ASSERT_NO_THROW(sender_->sendRequest(send_ncr));
+
+        // running two should do the send then the receive
+        EXPECT_NO_THROW(io_service_->run_one());
+        EXPECT_NO_THROW(io_service_->run_one());
+
+        // Only the most recent request is queued.
+        EXPECT_EQ(D2QueueMgr::RUNNING, queue_mgr_->getMgrState());
+        EXPECT_EQ(1, queue_mgr_->getQueueSize());
+        EXPECT_NO_THROW(received_ncr = queue_mgr_->peek());
+        EXPECT_TRUE(checkSendVsReceived(send_ncr, received_ncr));
+        EXPECT_EQ(i, queue_mgr_->getSupersededCount());
+    }
+}
+
 } // end of anonymous namespace
@@ -24,6 +24,7 @@
 #include <gtest/gtest.h>
 #include <algorithm>
 #include <vector>
+#include <sstream>
 
 using namespace std;
 using namespace bundy;
@@ -54,6 +55,7 @@ public:
     // Expose the protected methods to be tested.
     using D2UpdateMgr::checkFinishedTransactions;
     using D2UpdateMgr::pickNextJob;
+    using D2UpdateMgr::getServerKey;
     using D2UpdateMgr::makeTransaction;
 };
 
@@ -585,6 +587,49 @@ TEST_F(D2UpdateMgrTest, pickNextJob) {
     EXPECT_EQ(0, update_mgr_->getQueueCount());
 }
 
+/// @brief Tests D2UpdateManager's pickNextJob method which starts the
+/// search at a given position of the queue.
+/// This test verifies that:
+/// 1. The requests in front of the position are not considered.
+/// 2. The position is left at the request following the selected one,
+/// so as the queue can be scanned once by consecutive searches.
+TEST_F(D2UpdateMgrTest, pickNextJobFromIndex) {
+    ASSERT_TRUE(canned_count_ >= 2);
+
+    // Queue a request, a request for the same DHCID and another request.
+    dhcp_ddns::NameChangeRequestPtr
+        subsequent_ncr(new dhcp_ddns::NameChangeRequest(*(canned_ncrs_[0])));
+    ASSERT_NO_THROW(queue_mgr_->enqueue(canned_ncrs_[0]));
+    ASSERT_NO_THROW(queue_mgr_->enqueue(subsequent_ncr));
+    ASSERT_NO_THROW(queue_mgr_->enqueue(canned_ncrs_[1]));
+
+    // The first request is selected and the position stays at the front.
+    size_t index = 0;
+    EXPECT_TRUE(update_mgr_->pickNextJob(index));
+    EXPECT_EQ(0, index);
+    EXPECT_TRUE(update_mgr_->hasTransaction(canned_ncrs_[0]->getDhcid()));
+
+    // The subsequent request is skipped, as its DHCID has a transaction.
+    EXPECT_TRUE(update_mgr_->pickNextJob(index));
+    EXPECT_EQ(1, index);
+    EXPECT_TRUE(update_mgr_->hasTransaction(canned_ncrs_[1]->getDhcid()));
+    EXPECT_EQ(2, update_mgr_->getTransactionCount());
+
+    // Nothing is left at or after the position.
+    EXPECT_FALSE(update_mgr_->pickNextJob(index));
+    EXPECT_EQ(1, index);
+    ASSERT_EQ(1, update_mgr_->getQueueCount());
+    EXPECT_TRUE(*subsequent_ncr == *queue_mgr_->peekAt(0));
+
+    // A request in front of the position is not considered.
+    update_mgr_->clearTransactionList();
+    EXPECT_FALSE(update_mgr_->pickNextJob(index));
+    EXPECT_EQ(1, update_mgr_->getQueueCount());
+    index = 0;
+    EXPECT_TRUE(update_mgr_->pickNextJob(index));
+    EXPECT_EQ(0, update_mgr_->getQueueCount());
+}
+
 /// @brief Tests D2UpdateManager's sweep method.
 /// Since sweep is primarily a wrapper around checkFinishedTransactions and
 /// pickNextJob, along with checks on maximum transaction limits, it mostly
@@ -603,11 +648,11 @@ TEST_F(D2UpdateMgrTest, sweep) {
         EXPECT_NO_THROW(queue_mgr_->enqueue(canned_ncrs_[i]));
     }
 
-    // Invoke sweep canned_count_ times which should create a
-    // transaction for each canned ncr.
+    // Invoke sweep once which should create a transaction for each
+    // canned ncr.
+    EXPECT_NO_THROW(update_mgr_->sweep());
+    EXPECT_EQ(canned_count_, update_mgr_->getTransactionCount());
     for (int i = 0; i < canned_count_; i++) {
-        EXPECT_NO_THROW(update_mgr_->sweep());
-        EXPECT_EQ(i + 1, update_mgr_->getTransactionCount());
         EXPECT_TRUE(update_mgr_->hasTransaction(canned_ncrs_[i]->getDhcid()));
     }
 
@@ -665,6 +710,69 @@ TEST_F(D2UpdateMgrTest, sweep) {
     EXPECT_EQ(0, update_mgr_->getTransactionCount());
 }
 
+/// @brief Tests D2UpdateManager's per server transaction limit.
+/// This test verifies that:
+/// 1. The limit is disabled by default.
+/// 2. sweep does not start more transactions for a server than the limit.
+/// 3. Completed transactions release the server so that subsequent sweeps
+/// start transactions for the queued requests.
+/// 4. Requests for other servers are not held up by the busy server.
+TEST_F(D2UpdateMgrTest, maxServerTransactions) {
+    // Ensure we have at least 4 canned requests with which to work.
+    ASSERT_TRUE(canned_count_ >= 4);
+    EXPECT_EQ(D2UpdateMgr::MAX_SERVER_TRANSACTIONS_DEFAULT,
+              update_mgr_->getMaxServerTransactions());
+
+    // All the canned requests are for the forward domain example.com.
+    update_mgr_->setMaxServerTransactions(2);
+    EXPECT_EQ(2, update_mgr_->getMaxServerTransactions());
+    for (int i = 0; i < canned_count_; i++) {
+        EXPECT_NO_THROW(queue_mgr_->enqueue(canned_ncrs_[i]));
+    }
+
+    const std::string server_key = update_mgr_->getServerKey(canned_ncrs_[0]);
+    EXPECT_EQ("127.0.0.1 port:5301", server_key);
+
+    // Verify that sweep starts only two transactions.
+    EXPECT_NO_THROW(update_mgr_->sweep());
+    EXPECT_EQ(2, update_mgr_->getTransactionCount());
+    EXPECT_EQ(2, update_mgr_->getServerTransactionCount(server_key));
+    EXPECT_EQ(canned_count_ - 2, update_mgr_->getQueueCount());
+
+    // Queue up a request for the other forward domain. It should be
+    // started despite the example.com server being at its limit.
+    dhcp_ddns::NameChangeRequestPtr
+        other_ncr(new dhcp_ddns::NameChangeRequest(*(canned_ncrs_[0])));
+    other_ncr->setDhcid("AABBCCDDEEFF");
+    other_ncr->setFqdn("my.example.org.");
+    EXPECT_NO_THROW(queue_mgr_->enqueue(other_ncr));
+    EXPECT_NO_THROW(update_mgr_->sweep());
+    EXPECT_EQ(3, update_mgr_->getTransactionCount());
+    EXPECT_EQ(canned_count_ - 2, update_mgr_->getQueueCount());
+    EXPECT_EQ(1, update_mgr_->getServerTransactionCount(
+                 update_mgr_->getServerKey(other_ncr)));
+
+    // Complete one of the transactions. The next sweep should replace it.
+    completeTransaction(0, dhcp_ddns::ST_COMPLETED);
+    EXPECT_NO_THROW(update_mgr_->sweep());
+    EXPECT_EQ(3, update_mgr_->getTransactionCount());
+    EXPECT_EQ(2, update_mgr_->getServerTransactionCount(server_key));
+    EXPECT_EQ(canned_count_ - 3, update_mgr_->getQueueCount());
+
+    // Removing the transaction releases the server too.
+    update_mgr_->removeTransaction(canned_ncrs_[1]->getDhcid());
+    EXPECT_EQ(1, update_mgr_->getServerTransactionCount(server_key));
+
+    // Disabling the limit lets the remaining requests through.
+    update_mgr_->setMaxServerTransactions(0);
+    EXPECT_NO_THROW(update_mgr_->sweep());
+    EXPECT_EQ(0, update_mgr_->getQueueCount());
+
+    // Clearing the transaction list releases all servers.
+    EXPECT_NO_THROW(update_mgr_->clearTransactionList());
+    EXPECT_EQ(0, update_mgr_->getServerTransactionCount(server_key));
+}
+
 /// @brief Tests integration of NameAddTransaction
 /// This test verifies that update manager can create and manage a
 /// NameAddTransaction from start to finish.  It utilizes a fake server
@@ -849,6 +957,41 @@ TEST_F(D2UpdateMgrTest, multiTransaction) {
     }
 }
 
+/// @brief Tests processing of multiple transactions with combined updates.
+/// This test verifies that when combining of the updates is enabled, the
+/// transactions for different names in the same zone send their updates
+/// in combined messages and still complete successfully.
+TEST_F(D2UpdateMgrTest, multiTransactionBatched) {
+    EXPECT_EQ(D2UpdateMgr::MAX_BATCH_UPDATES_DEFAULT,
+              update_mgr_->getMaxBatchUpdates());
+    update_mgr_->setMaxBatchUpdates(8);
+    EXPECT_EQ(8, update_mgr_->getMaxBatchUpdates());
+    EXPECT_EQ(8, update_mgr_->getUpdateBatcher()->getMaxUpdates());
+
+    // Queue up the requests, each for a different name.
+    int test_count = canned_count_;
+    for (int i = 0; i < test_count; i++) {
+        std::ostringstream fqdn;
+        fqdn << "host" << i << ".example.com.";
+        canned_ncrs_[i]->setFqdn(fqdn.str());
+        ASSERT_NO_THROW(queue_mgr_->enqueue(canned_ncrs_[i]));
+    }
+
+    asiolink::IOAddress server_ip("127.0.0.1");
+    FauxServer server(*io_service_, server_ip, 5301);
+    server.receive(FauxServer::USE_RCODE, dns::Rcode::NOERROR());
+
+    // Run sweep and IO until everything is done.
+    processAll();
+
+    for (int i = 0; i < test_count; i++) {
+        EXPECT_EQ(dhcp_ddns::ST_COMPLETED, canned_ncrs_[i]->getStatus());
+    }
+
+    // The first updates of all transactions have been sent in one message.
+    EXPECT_LE(1, update_mgr_->getUpdateBatcher()->getBatchCount());
+}
+
 /// @brief Tests processing of multiple transactions.
 /// This test verifies that update manager can create and manage a multiple
 /// transactions, concurrently.  It uses a fake server that responds to all
@@ -20,7 +20,10 @@
 #include <dns/rcode.h>
 #include <dns/rrclass.h>
 #include <dns/tsig.h>
+#include <asio/ip/tcp.hpp>
 #include <asio/ip/udp.hpp>
+#include <asio/read.hpp>
+#include <asio/write.hpp>
 #include <asio/socket_base.hpp>
 #include <boost/bind.hpp>
 #include <boost/scoped_ptr.hpp>
@@ -69,6 +72,9 @@ public:
     DNSClientPtr dns_client_;
     bool corrupt_response_;
     bool expect_response_;
+    bool truncate_response_;
+    uint8_t tcp_length_[2];
+    int tcp_received_;
     asiolink::IntervalTimer test_timer_;
     int received_;
     int expected_;
@@ -86,6 +92,8 @@ public:
           status_(DNSClient::SUCCESS),
           corrupt_response_(false),
           expect_response_(true),
+          truncate_response_(false),
+          tcp_received_(0),
           test_timer_(service_),
           received_(0), expected_(0) {
         asiodns::logger.setSeverity(bundy::log::INFO);
@@ -182,6 +190,12 @@ public:
             // where a leading bit is a QR flag. The hexadecimal value is 0xA8.
             // Write it at message offset 2.
             response_buf.writeUint8At(0xA8, 2);
+            // If the response is to be truncated, set the TC bit too:
+            //             10101010,
+            // which gives the hexadecimal value of 0xAA.
+            if (truncate_response_) {
+                response_buf.writeUint8At(0xAA, 2);
+            }
         }
         // A response message is now ready to send. Send it!
         socket->send_to(asio::buffer(response_buf.getData(),
@@ -189,18 +203,64 @@ public:
                         *remote);
     }
 
+    // @brief Handler invoked when the TCP connection is accepted.
+    //
+    // It starts reading the two bytes long length of the request which
+    // precedes the DNS message sent over TCP.
+    //
+    // @param socket A pointer to a socket of the accepted connection.
+    // @param error An error code of the accept operation.
+    void tcpAcceptHandler(tcp::socket* socket, const asio::error_code& error) {
+        ASSERT_FALSE(error);
+        asio::async_read(*socket, asio::buffer(tcp_length_,
+                                               sizeof(tcp_length_)),
+                         boost::bind(&DNSClientTest::tcpLengthHandler,
+                                     this, socket, _1));
+    }
+
+    // @brief Handler invoked when the length of the TCP request is received.
+    //
+    // It starts reading the request of the received length.
+    //
+    // @param socket A pointer to a socket of the accepted connection.
+    // @param error An error code of the read operation.
+    void tcpLengthHandler(tcp::socket* socket, const asio::error_code& error) {
+        ASSERT_FALSE(error);
+        const size_t length = (tcp_length_[0] << 8) | tcp_length_[1];
+        ASSERT_LE(length, sizeof(receive_buffer_));
+        asio::async_read(*socket, asio::buffer(receive_buffer_, length),
+                         boost::bind(&DNSClientTest::tcpReceiveHandler,
+                                     this, socket, _1, _2));
+    }
+
+    // @brief Handler invoked when the TCP request is received.
+    //
+    // It sends the valid response, preceded by its length, over the
+    // connection.
+    //
+    // @param socket A pointer to a socket of the accepted connection.
+    // @param error An error code of the read operation.
+    // @param receive_length A length (in bytes) of the received data.
+    void tcpReceiveHandler(tcp::socket* socket, const asio::error_code& error,
+                           size_t receive_length) {
+        ASSERT_FALSE(error);
+        ++tcp_received_;
+        OutputBuffer response_buf(receive_length + 2);
+        response_buf.writeUint16(receive_length);
+        response_buf.writeData(receive_buffer_, receive_length);
+        // Set the QR bit as in udpReceiveHandler.
+        response_buf.writeUint8At(0xA8, 4);
+        asio::write(*socket, asio::buffer(response_buf.getData(),
+                                          response_buf.getLength()));
+    }
+
     // This test verifies that when invalid response placeholder object is
     // passed to a constructor, constructor throws the appropriate exception.
     // It also verifies that the constructor will not throw if the supplied
     // callback object is NULL.
     void runConstructorTest() {
         EXPECT_NO_THROW(DNSClient(response_, NULL, DNSClient::UDP));
-
-        // The TCP Transport is not supported right now. So, we return exception
-        // if caller specified TCP as a preferred protocol. This test will be
-        // removed once TCP is supported.
-        EXPECT_THROW(DNSClient(response_, NULL, DNSClient::TCP),
-                     bundy::NotImplemented);
+        EXPECT_NO_THROW(DNSClient(response_, NULL, DNSClient::TCP));
     }
 
     // This test verifies that it accepted timeout values belong to the range of
@@ -359,6 +419,58 @@ public:
         // run_one() to work.
         service_.get_io_service().reset();
     }
+
+    // This test verifies that DNSClient can exchange DNS Update over TCP.
+    // If the preferred protocol is UDP, the server returns the truncated
+    // response over UDP, so the client has to repeat the exchange over TCP.
+    void runTCPSendReceiveTest(const DNSClient::Protocol proto) {
+        dns_client_.reset(new DNSClient(response_, this, proto));
+
+        // Create a request DNS Update message.
+        D2UpdateMessage message(D2UpdateMessage::OUTBOUND);
+        ASSERT_NO_THROW(message.setRcode(Rcode(Rcode::NOERROR_CODE)));
+        ASSERT_NO_THROW(message.setZone(Name("example.com"), RRClass::IN()));
+
+        // Emulate the server listening over UDP, which truncates responses,
+        // and over TCP on the same address and port.
+        truncate_response_ = true;
+        udp::socket udp_socket(service_.get_io_service(), asio::ip::udp::v4());
+        udp_socket.set_option(socket_base::reuse_address(true));
+        udp_socket.bind(udp::endpoint(address::from_string(TEST_ADDRESS),
+                                      TEST_PORT));
+        udp::endpoint remote;
+        udp_socket.async_receive_from(asio::buffer(receive_buffer_,
+                                                   sizeof(receive_buffer_)),
+                                      remote,
+                                      boost::bind(&DNSClientTest::udpReceiveHandler,
+                                                  this, &udp_socket, &remote, _2,
+                                                  false));
+
+        tcp::acceptor acceptor(service_.get_io_service(),
+                               tcp::endpoint(address::from_string(TEST_ADDRESS),
+                                             TEST_PORT));
+        tcp::socket tcp_socket(service_.get_io_service());
+        acceptor.async_accept(tcp_socket,
+                              boost::bind(&DNSClientTest::tcpAcceptHandler,
+                                          this, &tcp_socket, _1));
+
+        // The callback should be invoked once, when the response is
+        // received over TCP.
+        const int timeout = 500;
+        expected_++;
+        dns_client_->doUpdate(service_, IOAddress(TEST_ADDRESS), TEST_PORT,
+                              message, timeout);
+
+        service_.run();
+
+        EXPECT_EQ(1, received_);
+        EXPECT_EQ(1, tcp_received_);
+
+        tcp_socket.close();
+        acceptor.close();
+        udp_socket.close();
+        service_.get_io_service().reset();
+    }
 };
 
 // Verify that the DNSClient object can be created if provided parameters are
@@ -404,6 +516,18 @@ TEST_F(DNSClientTest, sendReceiveCurrupted) {
     runSendReceiveTest(true, false);
 }
 
+// Verify that the DNSClient exchanges DNS Update over TCP if this is
+// the preferred protocol.
+TEST_F(DNSClientTest, sendReceiveTCP) {
+    runTCPSendReceiveTest(DNSClient::TCP);
+}
+
+// Verify that the DNSClient repeats the exchange over TCP if the response
+// received over UDP is truncated.
+TEST_F(DNSClientTest, sendReceiveTruncated) {
+    runTCPSendReceiveTest(DNSClient::UDP);
+}
+
 // Verify that it is possible to use the same DNSClient instance to
 // perform the following sequence of message exchanges:
 // 1. send
@@ -0,0 +1,361 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+#include <d2/dns_update_batcher.h>
+#include <asiodns/logger.h>
+#include <asiolink/interval_timer.h>
+#include <dns/rcode.h>
+#include <dns/rdata.h>
+#include <dns/rrclass.h>
+#include <dns/rrset.h>
+#include <dns/rrttl.h>
+#include <dns/rrtype.h>
+#include <asio/ip/udp.hpp>
+#include <asio/socket_base.hpp>
+#include <boost/bind.hpp>
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <vector>
+
+using namespace std;
+using namespace bundy;
+using namespace bundy::asiolink;
+using namespace bundy::d2;
+using namespace bundy::dns;
+using namespace asio;
+using namespace asio::ip;
+
+namespace {
+
+const char* TEST_ADDRESS = "127.0.0.1";
+const uint16_t TEST_PORT = 5301;
+const size_t MAX_SIZE = 4096;
+const long TEST_TIMEOUT = 5 * 1000;
+const unsigned int UPDATE_TIMEOUT = 500;
+
+class DNSUpdateBatcherTest;
+
+// @brief Emulates a transaction submitting an update to the batcher.
+class TestSubmitter : public DNSClient::Callback {
+public:
+    // @brief Constructor.
+    //
+    // @param test Test fixture to be notified of the completed exchanges.
+    // @param name Owner name of the records in the update.
+    TestSubmitter(DNSUpdateBatcherTest& test, const string& name);
+
+    // @brief Exchange completion callback.
+    virtual void operator()(DNSClient::Status status);
+
+    DNSUpdateBatcherTest& test_;
+    D2UpdateMessagePtr response_;
+    DNSClientPtr client_;
+    D2UpdateMessagePtr update_;
+    DNSClient::Status status_;
+    int calls_;
+};
+
+typedef boost::shared_ptr<TestSubmitter> TestSubmitterPtr;
+
+// @brief Test Fixture class.
+//
+// It emulates a DNS server listening over UDP which records the number of
+// prerequisites and updates in each of the received messages, and responds
+// with the configured sequence of RCODEs.
+class DNSUpdateBatcherTest : public ::testing::Test {
+public:
+    IOServicePtr io_service_;
+    DNSUpdateBatcherPtr batcher_;
+    udp::socket server_socket_;
+    udp::endpoint remote_;
+    uint8_t receive_buffer_[MAX_SIZE];
+    deque<Rcode> rcodes_;
+    vector<pair<int, int> > received_;
+    vector<TestSubmitterPtr> submitters_;
+    asiolink::IntervalTimer test_timer_;
+    int completed_;
+    int expected_;
+
+    // @brief Constructor.
+    //
+    // Opens the server socket and starts receiving.
+    DNSUpdateBatcherTest()
+        : io_service_(new IOService()),
+          server_socket_(io_service_->get_io_service(), udp::v4()),
+          test_timer_(*io_service_), completed_(0), expected_(0) {
+        asiodns::logger.setSeverity(bundy::log::INFO);
+        batcher_.reset(new DNSUpdateBatcher(io_service_));
+        server_socket_.set_option(socket_base::reuse_address(true));
+        server_socket_.bind(udp::endpoint(address::from_string(TEST_ADDRESS),
+                                          TEST_PORT));
+        receive();
+        test_timer_.setup(boost::bind(&DNSUpdateBatcherTest::testTimeoutHandler,
+                                      this), TEST_TIMEOUT);
+    }
+
+    // @brief Destructor.
+    virtual ~DNSUpdateBatcherTest() {
+        server_socket_.close();
+        asiodns::logger.setSeverity(bundy::log::DEBUG);
+    }
+
+    // @brief Handler invoked when test timeout is hit.
+    void testTimeoutHandler() {
+        io_service_->stop();
+        FAIL() << "Test timeout hit.";
+    }
+
+    // @brief Starts receiving the next request.
+    void receive() {
+        server_socket_.async_receive_from(
+            asio::buffer(receive_buffer_, sizeof(receive_buffer_)), remote_,
+            boost::bind(&DNSUpdateBatcherTest::receiveHandler, this, _1, _2));
+    }
+
+    // @brief Handler invoked when the request is received.
+    //
+    // It records the counts of prerequisites and updates, and sends back
+    // the response holding the header and the zone section of the request.
+    void receiveHandler(const asio::error_code& error, size_t length) {
+        if (error) {
+            return;
+        }
+        ASSERT_GT(length, 12);
+        received_.push_back(make_pair((receive_buffer_[6] << 8) |
+                                      receive_buffer_[7],
+                                      (receive_buffer_[8] << 8) |
+                                      receive_buffer_[9]));
+
+        // Skip the zone name, type and class.
+        size_t pos = 12;
+        while (receive_buffer_[pos] != 0) {
+            pos += receive_buffer_[pos] + 1;
+        }
+        pos += 5;
+        ASSERT_LE(pos, length);
+
+        Rcode rcode = Rcode::NOERROR();
+        if (!rcodes_.empty()) {
+            rcode = rcodes_.front();
+            rcodes_.pop_front();
+        }
+        // Set the QR bit along with the UPDATE opcode, the RCODE and
+        // clear all section counts but the zone section.
+        receive_buffer_[2] = 0xA8;
+        receive_buffer_[3] = rcode.getCode();
+        memset(&receive_buffer_[6], 0, 6);
+        server_socket_.send_to(asio::buffer(receive_buffer_, pos), remote_);
+        receive();
+    }
+
+    // @brief Creates the submitter of an update adding the A record.
+    //
+    // @param name Owner name of the record.
+    TestSubmitterPtr makeSubmitter(const string& name) {
+        TestSubmitterPtr submitter(new TestSubmitter(*this, name));
+        submitters_.push_back(submitter);
+        return (submitter);
+    }
+
+    // @brief Submits the update of the submitter to the batcher.
+    void submit(const TestSubmitterPtr& submitter) {
+        ++expected_;
+        batcher_->submit(submitter->client_, submitter.get(),
+                         submitter->response_, IOAddress(TEST_ADDRESS),
+                         TEST_PORT, submitter->update_, UPDATE_TIMEOUT);
+    }
+
+    // @brief Called by the submitters when their exchanges complete.
+    void completed() {
+        if (++completed_ == expected_) {
+            io_service_->stop();
+        }
+    }
+
+    // @brief Runs IO until all submitted exchanges complete.
+    void run() {
+        io_service_->run();
+        io_service_->get_io_service().reset();
+    }
+};
+
+TestSubmitter::TestSubmitter(DNSUpdateBatcherTest& test, const string& name)
+    : test_(test), response_(), client_(), update_(),
+      status_(DNSClient::OTHER), calls_(0) {
+    client_.reset(new DNSClient(response_, this));
+    update_.reset(new D2UpdateMessage(D2UpdateMessage::OUTBOUND));
+    update_->setZone(Name("example.com"), RRClass::IN());
+
+    // Require that the name is not in use.
+    RRsetPtr prereq(new RRset(Name(name), RRClass::NONE(), RRType::ANY(),
+                              RRTTL(0)));
+    update_->addRRset(D2UpdateMessage::SECTION_PREREQUISITE, prereq);
+
+    RRsetPtr update(new RRset(Name(name), RRClass::IN(), RRType::A(),
+                              RRTTL(3600)));
+    update->addRdata(rdata::createRdata(RRType::A(), RRClass::IN(),
+                                        "192.0.2.1"));
+    update_->addRRset(D2UpdateMessage::SECTION_UPDATE, update);
+}
+
+void
+TestSubmitter::operator()(DNSClient::Status status) {
+    status_ = status;
+    ++calls_;
+    test_.completed();
+}
+
+// This test verifies that the batcher validates its parameters.
+TEST_F(DNSUpdateBatcherTest, constructor) {
+    IOServicePtr null_service;
+    EXPECT_THROW(DNSUpdateBatcher batcher(null_service), DNSUpdateBatcherError);
+    EXPECT_THROW(DNSUpdateBatcher batcher(io_service_, 0),
+                 DNSUpdateBatcherError);
+    EXPECT_THROW(DNSUpdateBatcher batcher(io_service_, 1, 0),
+                 DNSUpdateBatcherError);
+
+    EXPECT_EQ(DNSUpdateBatcher::MAX_BATCH_UPDATES_DEFAULT,
+              batcher_->getMaxUpdates());
+    EXPECT_EQ(DNSUpdateBatcher::MAX_BATCH_SIZE_DEFAULT,
+              batcher_->getMaxSize());
+    EXPECT_THROW(batcher_->setMaxUpdates(0), DNSUpdateBatcherError);
+    EXPECT_THROW(batcher_->setMaxSize(0), DNSUpdateBatcherError);
+
+    // An update without the zone can't be batched.
+    TestSubmitterPtr submitter = makeSubmitter("one.example.com");
+    submitter->update_.reset(new D2UpdateMessage(D2UpdateMessage::OUTBOUND));
+    EXPECT_THROW(submit(submitter), DNSUpdateBatcherError);
+}
+
+// This test verifies that the updates for different names in the same zone
+// are sent in one message and each submitter gets the response.
+TEST_F(DNSUpdateBatcherTest, combine) {
+    submit(makeSubmitter("one.example.com"));
+    submit(makeSubmitter("two.example.com"));
+    submit(makeSubmitter("three.example.com"));
+    EXPECT_EQ(3, batcher_->getPendingCount());
+
+    EXPECT_EQ(1, batcher_->flush());
+    EXPECT_EQ(0, batcher_->getPendingCount());
+    run();
+
+    ASSERT_EQ(1, received_.size());
+    EXPECT_EQ(3, received_[0].first);
+    EXPECT_EQ(3, received_[0].second);
+    EXPECT_EQ(1, batcher_->getBatchCount());
+    EXPECT_EQ(0, batcher_->getFallbackCount());
+
+    for (int i = 0; i < submitters_.size(); ++i) {
+        EXPECT_EQ(1, submitters_[i]->calls_);
+        EXPECT_EQ(DNSClient::SUCCESS, submitters_[i]->status_);
+        ASSERT_TRUE(submitters_[i]->response_);
+        EXPECT_EQ(Rcode::NOERROR(), submitters_[i]->response_->getRcode());
+    }
+}
+
+// This test verifies that the updates of the same name are never combined.
+TEST_F(DNSUpdateBatcherTest, overlappingNames) {
+    submit(makeSubmitter("one.example.com"));
+    submit(makeSubmitter("one.example.com"));
+    // The first update has been sent on its own.
+    EXPECT_EQ(1, batcher_->getPendingCount());
+
+    EXPECT_EQ(1, batcher_->flush());
+    run();
+
+    ASSERT_EQ(2, received_.size());
+    EXPECT_EQ(1, received_[0].first);
+    EXPECT_EQ(1, received_[1].first);
+    EXPECT_EQ(0, batcher_->getBatchCount());
+    EXPECT_EQ(DNSClient::SUCCESS, submitters_[0]->status_);
+    EXPECT_EQ(DNSClient::SUCCESS, submitters_[1]->status_);
+}
+
+// This test verifies that the batch is sent when it reaches the maximum
+// number of updates or the maximum size.
+TEST_F(DNSUpdateBatcherTest, limits) {
+    batcher_->setMaxUpdates(2);
+    submit(makeSubmitter("one.example.com"));
+    submit(makeSubmitter("two.example.com"));
+    EXPECT_EQ(0, batcher_->getPendingCount());
+    submit(makeSubmitter("three.example.com"));
+    EXPECT_EQ(1, batcher_->getPendingCount());
+
+    // The size of the message holding two updates exceeds 128 bytes.
+    batcher_->setMaxUpdates(DNSUpdateBatcher::MAX_BATCH_UPDATES_DEFAULT);
+    batcher_->setMaxSize(128);
+    submit(makeSubmitter("four.example.com"));
+    EXPECT_EQ(1, batcher_->getPendingCount());
+
+    EXPECT_EQ(1, batcher_->flush());
+    run();
+
+    ASSERT_EQ(3, received_.size());
+    EXPECT_EQ(2, received_[0].first);
+    EXPECT_EQ(1, received_[1].first);
+    EXPECT_EQ(1, received_[2].first);
+    EXPECT_EQ(1, batcher_->getBatchCount());
+}
+
+// This test verifies that the updates are sent individually when the
+// combined update is refused, and each submitter gets its own response.
+TEST_F(DNSUpdateBatcherTest, fallback) {
+    rcodes_.push_back(Rcode::YXDOMAIN());
+    rcodes_.push_back(Rcode::NOERROR());
+    rcodes_.push_back(Rcode::YXDOMAIN());
+    rcodes_.push_back(Rcode::NOERROR());
+    submit(makeSubmitter("one.example.com"));
+    submit(makeSubmitter("two.example.com"));
+    submit(makeSubmitter("three.example.com"));
+
+    EXPECT_EQ(1, batcher_->flush());
+    run();
+
+    ASSERT_EQ(4, received_.size());
+    EXPECT_EQ(3, received_[0].first);
+    for (int i = 1; i < received_.size(); ++i) {
+        EXPECT_EQ(1, received_[i].first);
+        EXPECT_EQ(1, received_[i].second);
+    }
+    EXPECT_EQ(1, batcher_->getFallbackCount());
+
+    // Each submitter has been called back once, with the response to its
+    // own update.
+    int yxdomain_count = 0;
+    for (int i = 0; i < submitters_.size(); ++i) {
+        EXPECT_EQ(1, submitters_[i]->calls_);
+        EXPECT_EQ(DNSClient::SUCCESS, submitters_[i]->status_);
+        ASSERT_TRUE(submitters_[i]->response_);
+        if (submitters_[i]->response_->getRcode() == Rcode::YXDOMAIN()) {
+            ++yxdomain_count;
+        }
+    }
+    EXPECT_EQ(1, yxdomain_count);
+}
+
+// This test verifies that clearing the batcher discards pending updates.
+TEST_F(DNSUpdateBatcherTest, clear) {
+    submit(makeSubmitter("one.example.com"));
+    submit(makeSubmitter("two.example.com"));
+    EXPECT_EQ(2, batcher_->getPendingCount());
+
+    batcher_->clear();
+    EXPECT_EQ(0, batcher_->getPendingCount());
+    EXPECT_EQ(0, batcher_->flush());
+    EXPECT_TRUE(received_.empty());
+}
+
+}
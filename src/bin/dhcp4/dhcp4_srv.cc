@@ -59,6 +59,8 @@ struct Dhcp4Hooks {
     int hook_index_lease4_release_; ///< index for "lease4_release" hook point
     int hook_index_pkt4_send_;      ///< index for "pkt4_send" hook point
     int hook_index_buffer4_send_;   ///< index for "buffer4_send" hook point
+    int arg_index_query4_;          ///< slot for "query4" argument
+    int arg_index_response4_;       ///< slot for "response4" argument
 
     /// Constructor that registers hook points for DHCPv4 engine
     Dhcp4Hooks() {
@@ -68,6 +70,8 @@ struct Dhcp4Hooks {
         hook_index_pkt4_send_      = HooksManager::registerHook("pkt4_send");
         hook_index_lease4_release_ = HooksManager::registerHook("lease4_release");
         hook_index_buffer4_send_   = HooksManager::registerHook("buffer4_send");
+        arg_index_query4_          = HooksManager::registerArgument("query4");
+        arg_index_response4_       = HooksManager::registerArgument("response4");
     }
 };
 
@@ -190,6 +194,10 @@ Dhcpv4Srv::run() {
         query->setCallback(boost::bind(&Dhcpv4Srv::unpackOptions, this,
                                        _1, _2, _3));
 
+        // Most of the options carried in the query are never looked at by
+        // the server, so only create the option objects when needed.
+        query->setLazyUnpack(true);
+
         bool skip_unpack = false;
 
         // The packet has just been received so contains the uninterpreted wire
@@ -201,7 +209,7 @@ Dhcpv4Srv::run() {
             callout_handle->deleteAllArguments();
 
             // Pass incoming packet as argument
-            callout_handle->setArgument("query4", query);
+            callout_handle->setArgument(Hooks.arg_index_query4_, query);
 
             // Call callouts
             HooksManager::callCallouts(Hooks.hook_index_buffer4_receive_,
@@ -216,7 +224,7 @@ Dhcpv4Srv::run() {
                 skip_unpack = true;
             }
 
-            callout_handle->getArgument("query4", query);
+            callout_handle->getArgument(Hooks.arg_index_query4_, query);
         }
 
         // Unpack the packet information unless the buffer4_receive callouts
@@ -232,28 +240,39 @@ Dhcpv4Srv::run() {
             }
         }
 
-        // Assign this packet to one or more classes if needed. We need to do
-        // this before calling accept(), because getSubnet4() may need client
-        // class information.
-        classifyPacket(query);
+        try {
+            // Assign this packet to one or more classes if needed. We need
+            // to do this before calling accept(), because getSubnet4() may
+            // need client class information.
+            classifyPacket(query);
+
+            // Check whether the message should be further processed or
+            // discarded. There is no need to log anything here. This
+            // function logs by itself.
+            if (!accept(query)) {
+                continue;
+            }
 
-        // Check whether the message should be further processed or discarded.
-        // There is no need to log anything here. This function logs by itself.
-        if (!accept(query)) {
+            // We have sanity checked (in accept() that the Message Type
+            // option exists, so we can safely get it here.
+            int type = query->getType();
+            LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL, DHCP4_PACKET_RECEIVED)
+                .arg(serverReceivedPacketName(type))
+                .arg(type)
+                .arg(query->getIface());
+            // Logging the packet unpacks all its options, including those
+            // not used so far, so it must be done within this block.
+            LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL_DATA, DHCP4_QUERY_DATA)
+                .arg(type)
+                .arg(query->toText());
+        } catch (const std::exception& e) {
+            // The options are unpacked on first use, so a malformed option
+            // may only be detected here.
+            LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL,
+                      DHCP4_PACKET_PARSE_FAIL).arg(e.what());
             continue;
         }
 
-        // We have sanity checked (in accept() that the Message Type option
-        // exists, so we can safely get it here.
-        int type = query->getType();
-        LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL, DHCP4_PACKET_RECEIVED)
-            .arg(serverReceivedPacketName(type))
-            .arg(type)
-            .arg(query->getIface());
-        LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL_DATA, DHCP4_QUERY_DATA)
-            .arg(type)
-            .arg(query->toText());
-
         // Let's execute all callouts registered for pkt4_receive
         if (HooksManager::calloutsPresent(hook_index_pkt4_receive_)) {
             CalloutHandlePtr callout_handle = getCalloutHandle(query);
@@ -262,7 +281,7 @@ Dhcpv4Srv::run() {
             callout_handle->deleteAllArguments();
 
             // Pass incoming packet as argument
-            callout_handle->setArgument("query4", query);
+            callout_handle->setArgument(Hooks.arg_index_query4_, query);
 
             // Call callouts
             HooksManager::callCallouts(hook_index_pkt4_receive_,
@@ -276,7 +295,7 @@ Dhcpv4Srv::run() {
                 continue;
             }
 
-            callout_handle->getArgument("query4", query);
+            callout_handle->getArgument(Hooks.arg_index_query4_, query);
         }
 
         try {
@@ -361,7 +380,7 @@ Dhcpv4Srv::run() {
             callout_handle->setSkip(false);
 
             // Set our response
-            callout_handle->setArgument("response4", rsp);
+            callout_handle->setArgument(Hooks.arg_index_response4_, rsp);
 
             // Call all installed callouts
             HooksManager::callCallouts(hook_index_pkt4_send_,
@@ -397,7 +416,7 @@ Dhcpv4Srv::run() {
                 callout_handle->deleteAllArguments();
 
                 // Pass incoming packet as argument
-                callout_handle->setArgument("response4", rsp);
+                callout_handle->setArgument(Hooks.arg_index_response4_, rsp);
 
                 // Call callouts
                 HooksManager::callCallouts(Hooks.hook_index_buffer4_send_,
@@ -412,7 +431,7 @@ Dhcpv4Srv::run() {
                     continue;
                 }
 
-                callout_handle->getArgument("response4", rsp);
+                callout_handle->getArgument(Hooks.arg_index_response4_, rsp);
             }
 
             LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL_DATA,
@@ -1316,7 +1335,7 @@ Dhcpv4Srv::processRelease(Pkt4Ptr& release) {
             callout_handle->deleteAllArguments();
 
             // Pass the original packet
-            callout_handle->setArgument("query4", release);
+            callout_handle->setArgument(Hooks.arg_index_query4_, release);
 
             // Pass the lease to be updated
             callout_handle->setArgument("lease4", lease);
@@ -1455,7 +1474,7 @@ Dhcpv4Srv::selectSubnet(const Pkt4Ptr& question) const {
         callout_handle->deleteAllArguments();
 
         // Set new arguments
-        callout_handle->setArgument("query4", question);
+        callout_handle->setArgument(Hooks.arg_index_query4_, question);
         callout_handle->setArgument("subnet4", subnet);
         callout_handle->setArgument("subnet4collection",
                                     CfgMgr::instance().getSubnets4());
@@ -1709,20 +1728,21 @@ Dhcpv4Srv::unpackOptions(const OptionBuffer& buf,
                          bundy::dhcp::OptionCollection& options) {
     size_t offset = 0;
 
-    OptionDefContainer option_defs;
+    static const OptionDefContainer no_option_defs;
+    const OptionDefContainer* option_defs = &no_option_defs;
+    OptionDefContainerPtr option_defs_ptr;
     if (option_space == "dhcp4") {
         // Get the list of stdandard option definitions.
-        option_defs = LibDHCP::getOptionDefs(Option::V4);
+        option_defs = &LibDHCP::getOptionDefs(Option::V4);
     } else if (!option_space.empty()) {
-        OptionDefContainerPtr option_defs_ptr =
-            CfgMgr::instance().getOptionDefs(option_space);
+        option_defs_ptr = CfgMgr::instance().getOptionDefs(option_space);
         if (option_defs_ptr != NULL) {
-            option_defs = *option_defs_ptr;
+            option_defs = option_defs_ptr.get();
         }
     }
     // Get the search index #1. It allows to search for option definitions
     // using option code.
-    const OptionDefContainerTypeIndex& idx = option_defs.get<1>();
+    const OptionDefContainerTypeIndex& idx = option_defs->get<1>();
 
     // The buffer being read comprises a set of options, each starting with
     // a one-byte type code and a one-byte length field.
@@ -191,6 +191,30 @@
                 "item_type": "boolean",
                 "item_optional": true,
                 "item_default": true
+            },
+            {
+                "item_name": "cache",
+                "item_type": "boolean",
+                "item_optional": true,
+                "item_default": false
+            },
+            {
+                "item_name": "cache-size",
+                "item_type": "integer",
+                "item_optional": true,
+                "item_default": 65536
+            },
+            {
+                "item_name": "format",
+                "item_type": "string",
+                "item_optional": true,
+                "item_default": "csv"
+            },
+            {
+                "item_name": "compact-threshold",
+                "item_type": "integer",
+                "item_optional": true,
+                "item_default": 0
             }
         ]
       },
@@ -404,7 +428,7 @@
                 "item_type": "string",
                 "item_optional": true,
                 "item_default": "JSON",
-                "item_description" : "Format of the update request packet"
+                "item_description" : "Format of the update request packet (JSON or BINARY)"
             },
             {
 
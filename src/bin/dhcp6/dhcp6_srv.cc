@@ -77,6 +77,8 @@ struct Dhcp6Hooks {
     int hook_index_lease6_release_; ///< index for "lease6_release" hook point
     int hook_index_pkt6_send_;      ///< index for "pkt6_send" hook point
     int hook_index_buffer6_send_;   ///< index for "buffer6_send" hook point
+    int arg_index_query6_;          ///< slot for "query6" argument
+    int arg_index_response6_;       ///< slot for "response6" argument
 
     /// Constructor that registers hook points for DHCPv6 engine
     Dhcp6Hooks() {
@@ -88,6 +90,8 @@ struct Dhcp6Hooks {
         hook_index_lease6_release_ = HooksManager::registerHook("lease6_release");
         hook_index_pkt6_send_      = HooksManager::registerHook("pkt6_send");
         hook_index_buffer6_send_   = HooksManager::registerHook("buffer6_send");
+        arg_index_query6_          = HooksManager::registerArgument("query6");
+        arg_index_response6_       = HooksManager::registerArgument("response6");
     }
 };
 
@@ -281,7 +285,7 @@ bool Dhcpv6Srv::run() {
             callout_handle->deleteAllArguments();
 
             // Pass incoming packet as argument
-            callout_handle->setArgument("query6", query);
+            callout_handle->setArgument(Hooks.arg_index_query6_, query);
 
             // Call callouts
             HooksManager::callCallouts(Hooks.hook_index_buffer6_receive_, *callout_handle);
@@ -295,7 +299,7 @@ bool Dhcpv6Srv::run() {
                 skip_unpack = true;
             }
 
-            callout_handle->getArgument("query6", query);
+            callout_handle->getArgument(Hooks.arg_index_query6_, query);
         }
 
         // Unpack the packet information unless the buffer6_receive callouts
@@ -337,7 +341,7 @@ bool Dhcpv6Srv::run() {
             callout_handle->deleteAllArguments();
 
             // Pass incoming packet as argument
-            callout_handle->setArgument("query6", query);
+            callout_handle->setArgument(Hooks.arg_index_query6_, query);
 
             // Call callouts
             HooksManager::callCallouts(Hooks.hook_index_pkt6_receive_, *callout_handle);
@@ -350,7 +354,7 @@ bool Dhcpv6Srv::run() {
                 continue;
             }
 
-            callout_handle->getArgument("query6", query);
+            callout_handle->getArgument(Hooks.arg_index_query6_, query);
         }
 
         // Assign this packet to a class, if possible
@@ -453,7 +457,7 @@ bool Dhcpv6Srv::run() {
                 callout_handle->deleteAllArguments();
 
                 // Set our response
-                callout_handle->setArgument("response6", rsp);
+                callout_handle->setArgument(Hooks.arg_index_response6_, rsp);
 
                 // Call all installed callouts
                 HooksManager::callCallouts(Hooks.hook_index_pkt6_send_, *callout_handle);
@@ -497,7 +501,7 @@ bool Dhcpv6Srv::run() {
                     callout_handle->deleteAllArguments();
 
                     // Pass incoming packet as argument
-                    callout_handle->setArgument("response6", rsp);
+                    callout_handle->setArgument(Hooks.arg_index_response6_, rsp);
 
                     // Call callouts
                     HooksManager::callCallouts(Hooks.hook_index_buffer6_send_, *callout_handle);
@@ -510,7 +514,7 @@ bool Dhcpv6Srv::run() {
                         continue;
                     }
 
-                    callout_handle->getArgument("response6", rsp);
+                    callout_handle->getArgument(Hooks.arg_index_response6_, rsp);
                 }
 
                 LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL_DATA,
@@ -902,7 +906,7 @@ Dhcpv6Srv::selectSubnet(const Pkt6Ptr& question) {
         callout_handle->deleteAllArguments();
 
         // Set new arguments
-        callout_handle->setArgument("query6", question);
+        callout_handle->setArgument(Hooks.arg_index_query6_, question);
         callout_handle->setArgument("subnet6", subnet);
 
         // We pass pointer to const collection for performance reasons.
@@ -1582,7 +1586,7 @@ Dhcpv6Srv::extendIA_NA(const Subnet6Ptr& subnet, const DuidPtr& duid,
         callout_handle->deleteAllArguments();
 
         // Pass the original packet
-        callout_handle->setArgument("query6", query);
+        callout_handle->setArgument(Hooks.arg_index_query6_, query);
 
         // Pass the lease to be updated
         callout_handle->setArgument("lease6", lease);
@@ -1755,7 +1759,7 @@ Dhcpv6Srv::extendIA_PD(const Subnet6Ptr& subnet, const DuidPtr& duid,
         callout_handle->deleteAllArguments();
 
         // Pass the original packet
-        callout_handle->setArgument("query6", query);
+        callout_handle->setArgument(Hooks.arg_index_query6_, query);
 
         // Pass the lease to be updated
         callout_handle->setArgument("lease6", lease);
@@ -2032,7 +2036,7 @@ Dhcpv6Srv::releaseIA_NA(const DuidPtr& duid, const Pkt6Ptr& query,
         callout_handle->deleteAllArguments();
 
         // Pass the original packet
-        callout_handle->setArgument("query6", query);
+        callout_handle->setArgument(Hooks.arg_index_query6_, query);
 
         // Pass the lease to be updated
         callout_handle->setArgument("lease6", lease);
@@ -2182,7 +2186,7 @@ Dhcpv6Srv::releaseIA_PD(const DuidPtr& duid, const Pkt6Ptr& query,
         callout_handle->deleteAllArguments();
 
         // Pass the original packet
-        callout_handle->setArgument("query6", query);
+        callout_handle->setArgument(Hooks.arg_index_query6_, query);
 
         // Pass the lease to be updated
         callout_handle->setArgument("lease6", lease);
@@ -2410,21 +2414,22 @@ Dhcpv6Srv::unpackOptions(const OptionBuffer& buf,
     size_t offset = 0;
     size_t length = buf.size();
 
-    OptionDefContainer option_defs;
+    static const OptionDefContainer no_option_defs;
+    const OptionDefContainer* option_defs = &no_option_defs;
+    OptionDefContainerPtr option_defs_ptr;
     if (option_space == "dhcp6") {
         // Get the list of stdandard option definitions.
-        option_defs = LibDHCP::getOptionDefs(Option::V6);
+        option_defs = &LibDHCP::getOptionDefs(Option::V6);
     } else if (!option_space.empty()) {
-        OptionDefContainerPtr option_defs_ptr =
-            CfgMgr::instance().getOptionDefs(option_space);
+        option_defs_ptr = CfgMgr::instance().getOptionDefs(option_space);
         if (option_defs_ptr != NULL) {
-            option_defs = *option_defs_ptr;
+            option_defs = option_defs_ptr.get();
         }
     }
 
     // Get the search index #1. It allows to search for option definitions
     // using option code.
-    const OptionDefContainerTypeIndex& idx = option_defs.get<1>();
+    const OptionDefContainerTypeIndex& idx = option_defs->get<1>();
 
     // The buffer being read comprises a set of options, each starting with
     // a two-byte type code and a two-byte length field.
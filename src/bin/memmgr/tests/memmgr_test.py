@@ -252,6 +252,29 @@ class TestMemmgr(unittest.TestCase):
         self.assertEqual(1, answer[0])
         self.assertIsNotNone(re.search('not a directory', answer[1]))
 
+    def test_configure_reserved_size(self):
+        self.__mgr._setup_ccsession()
+        os.path.isdir = lambda x: True
+        os.access = lambda x, y: True
+
+        # The default is taken from the spec at the initial configuration.
+        self.assertEqual((0, None),
+                         parse_answer(self.__mgr._config_handler({})))
+        self.assertEqual(1073741824,
+                         self.__mgr._config_params['mapped_reserved_size'])
+
+        user_cfg = {'mapped_reserved_size': 0}
+        self.assertEqual((0, None),
+                         parse_answer(self.__mgr._config_handler(user_cfg)))
+        self.assertEqual(0, self.__mgr._config_params['mapped_reserved_size'])
+
+        # A negative size is rejected and the previous value is kept.
+        user_cfg = {'mapped_reserved_size': -1}
+        answer = parse_answer(self.__mgr._config_handler(user_cfg))
+        self.assertEqual(1, answer[0])
+        self.assertIsNotNone(re.search('must not be negative', answer[1]))
+        self.assertEqual(0, self.__mgr._config_params['mapped_reserved_size'])
+
     @unittest.skipIf(os.getuid() == 0, 'test cannot be run as root user')
     def test_configure_bad_permissions(self):
         self.__mgr._setup_ccsession()
@@ -16,6 +16,7 @@
 #define ACL_ACL_H
 
 #include "check.h"
+#include <exceptions/exceptions.h>
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
@@ -81,6 +82,37 @@ public:
      */
     typedef boost::shared_ptr<const Check<Context> > ConstCheckPtr;
 
+    /**
+     * \brief Compiled form of the first entries of the ACL.
+     *
+     * Testing the entries one by one is linear in the number of entries.
+     * When the checks of the leading entries have a structure that allows
+     * it (e.g. they all match the address against a prefix), they can be
+     * compiled into a form which finds the first matching entry faster.
+     * See setCompiled().
+     */
+    class Compiled {
+    public:
+        /// \brief Virtual destructor.
+        virtual ~Compiled() {}
+
+        /**
+         * \brief Decide on the compiled entries.
+         *
+         * \param context The thing that should be checked.
+         *
+         * \return The action of the first of the compiled entries that
+         *     matches the context, or NULL if none of them matches.
+         */
+        virtual const Action* execute(const Context& context) const = 0;
+
+        /// \brief The number of leading entries the compiled form covers.
+        virtual size_t getEntryCount() const = 0;
+    };
+
+    /// \brief Pointer to the compiled form.
+    typedef boost::shared_ptr<const Compiled> ConstCompiledPtr;
+
     /**
      * \brief The actual main function that decides.
      *
@@ -89,6 +121,9 @@ public:
      * action that belongs to the first matched entry or default action
      * if nothing matches.
      *
+     * If the ACL has a compiled form, it decides on the entries it covers
+     * and only the rest of the entries is tested one by one.
+     *
      * \param context The thing that should be checked. It is directly
      *     passed to the checks.
      *
@@ -96,8 +131,15 @@ public:
      */
     const Action& execute(const Context& context) const {
         const typename Entries::const_iterator end(entries_.end());
-        for (typename Entries::const_iterator i(entries_.begin()); i != end;
-             ++i) {
+        typename Entries::const_iterator i(entries_.begin());
+        if (compiled_) {
+            const Action* const action(compiled_->execute(context));
+            if (action != NULL) {
+                return (*action);
+            }
+            i += compiled_->getEntryCount();
+        }
+        for (; i != end; ++i) {
             if (i->first->matches(context)) {
                 return (i->second);
             }
@@ -118,6 +160,55 @@ public:
     void append(ConstCheckPtr check, const Action& action) {
         entries_.push_back(Entry(check, action));
     }
+
+    /**
+     * \brief Set the compiled form of the ACL.
+     *
+     * The compiled form is used by execute() instead of the checks of the
+     * entries it covers.  It stays valid when more entries are appended.
+     *
+     * \param compiled The compiled form of the first entries, or NULL to
+     *     test all the entries one by one.
+     *
+     * \exception InvalidParameter The compiled form covers more entries
+     *     than the ACL has.
+     */
+    void setCompiled(const ConstCompiledPtr& compiled) {
+        if (compiled && compiled->getEntryCount() > entries_.size()) {
+            bundy_throw(bundy::InvalidParameter, "Compiled ACL covers " <<
+                        compiled->getEntryCount() << " entries, only " <<
+                        entries_.size() << " exist");
+        }
+        compiled_ = compiled;
+    }
+
+    /// \brief Get the compiled form of the ACL, NULL if there's none.
+    const ConstCompiledPtr& getCompiled() const {
+        return (compiled_);
+    }
+
+    /// \brief Get the number of entries.
+    size_t getEntryCount() const {
+        return (entries_.size());
+    }
+
+    /**
+     * \brief Get the check of an entry.
+     *
+     * \param index The position of the entry. It is not checked.
+     */
+    const Check<Context>& getCheck(size_t index) const {
+        return (*entries_[index].first);
+    }
+
+    /**
+     * \brief Get the action of an entry.
+     *
+     * \param index The position of the entry. It is not checked.
+     */
+    const Action& getAction(size_t index) const {
+        return (entries_[index].second);
+    }
 private:
     // Just type abbreviations.
     typedef std::pair<ConstCheckPtr, Action> Entry;
@@ -126,6 +217,8 @@ private:
     const Action default_action_;
     /// \brief The entries we have.
     Entries entries_;
+    /// \brief The compiled form of the first entries, if any.
+    ConstCompiledPtr compiled_;
 protected:
     /**
      * \brief Get the default action.
@@ -21,10 +21,12 @@
 
 #include <acl/dns.h>
 #include <acl/ip_check.h>
+#include <acl/ip_trie.h>
 #include <acl/dnsname_check.h>
 #include <acl/loader.h>
 #include <acl/logic_check.h>
 
+#include <boost/bind.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
 
@@ -105,6 +107,11 @@ internal::RequestCheckCreator::create(const string& name,
     }
 }
 
+namespace {
+// Minimal number of leading address entries for an ACL to be compiled.
+const size_t MIN_COMPILED_ENTRIES = 4;
+}
+
 RequestLoader&
 getRequestLoader() {
     // To ensure that the singleton gets destroyed at the end of the
@@ -131,6 +138,12 @@ getRequestLoader() {
             boost::shared_ptr<LogicCreator<AllOfSpec, RequestContext> >(
                 new LogicCreator<AllOfSpec, RequestContext>("ALL")));
 
+        // Leading address entries of the loaded ACLs are looked up in a
+        // prefix trie, unless there are too few of them for it to pay off.
+        loader_ptr->setCompiler(
+            boost::bind(&compileIPACL<RequestContext, BasicAction>, _1,
+                        MIN_COMPILED_ENTRIES));
+
         // From this point there shouldn't be any exception thrown
         loader.reset(loader_ptr.release());
     }
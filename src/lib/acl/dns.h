@@ -23,6 +23,7 @@
 #include <cc/data.h>
 
 #include <acl/ip_check.h>
+#include <acl/ip_trie.h>
 #include <acl/dnsname_check.h>
 #include <acl/loader.h>
 
@@ -140,6 +141,16 @@ public:
 } // end of namespace "internal"
 
 } // end of namespace "dns"
+
+/// The specialization of \c getIPAddress for \c RequestContext.
+///
+/// It returns the remote (source) IP address of the request, which is what
+/// the \c IPCheck of requests checks.
+template <>
+inline const IPAddress&
+getIPAddress(const dns::RequestContext& request) {
+    return (request.remote_address);
+}
 } // end of namespace "acl"
 } // end of namespace "bundy"
 
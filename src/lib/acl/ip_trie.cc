@@ -0,0 +1,126 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include <exceptions/exceptions.h>
+
+#include <acl/ip_trie.h>
+
+using namespace std;
+
+namespace {
+
+// Positions of the roots of the two families.
+const uint32_t IPV4_ROOT = 0;
+const uint32_t IPV6_ROOT = 1;
+
+// Return the n-th bit of the address, counting from the most significant
+// bit of the first byte.
+inline size_t
+getBit(const uint8_t* address, size_t n) {
+    return ((address[n / 8] >> (7 - (n % 8))) & 1);
+}
+
+} // unnamed namespace
+
+namespace bundy {
+namespace acl {
+
+const size_t IPPrefixTrie::NOT_FOUND;
+
+IPPrefixTrie::IPPrefixTrie() {
+    addNode();
+    addNode();
+}
+
+uint32_t
+IPPrefixTrie::addNode() {
+    Node node;
+    node.children_[0] = 0;
+    node.children_[1] = 0;
+    node.index_ = NOT_FOUND;
+    nodes_.push_back(node);
+    return (nodes_.size() - 1);
+}
+
+void
+IPPrefixTrie::insert(int family, const uint8_t* address, size_t prefixlen,
+                     size_t index)
+{
+    uint32_t current;
+    size_t maxlen;
+    if (family == AF_INET) {
+        current = IPV4_ROOT;
+        maxlen = 32;
+    } else if (family == AF_INET6) {
+        current = IPV6_ROOT;
+        maxlen = 128;
+    } else {
+        bundy_throw(bundy::BadValue, "Unknown address family " << family);
+    }
+    if (prefixlen > maxlen) {
+        bundy_throw(bundy::BadValue, "Prefix length " << prefixlen <<
+                    " is too long for the address family");
+    }
+
+    for (size_t bit = 0; bit < prefixlen; ++bit) {
+        // The prefix is shadowed by a shorter one with lower index.
+        if (nodes_[current].index_ <= index) {
+            return;
+        }
+        const size_t direction = getBit(address, bit);
+        uint32_t next = nodes_[current].children_[direction];
+        if (next == 0) {
+            // Don't hold a reference to the node across the reallocation.
+            next = addNode();
+            nodes_[current].children_[direction] = next;
+        }
+        current = next;
+    }
+    if (index < nodes_[current].index_) {
+        nodes_[current].index_ = index;
+    }
+}
+
+size_t
+IPPrefixTrie::find(int family, const uint8_t* address) const {
+    uint32_t current;
+    size_t maxlen;
+    if (family == AF_INET) {
+        current = IPV4_ROOT;
+        maxlen = 32;
+    } else if (family == AF_INET6) {
+        current = IPV6_ROOT;
+        maxlen = 128;
+    } else {
+        return (NOT_FOUND);
+    }
+
+    size_t result = nodes_[current].index_;
+    for (size_t bit = 0; bit < maxlen; ++bit) {
+        current = nodes_[current].children_[getBit(address, bit)];
+        if (current == 0) {
+            break;
+        }
+        if (nodes_[current].index_ < result) {
+            result = nodes_[current].index_;
+        }
+    }
+    return (result);
+}
+
+} // namespace acl
+} // namespace bundy
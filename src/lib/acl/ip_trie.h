@@ -0,0 +1,221 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef IP_TRIE_H
+#define IP_TRIE_H
+
+#include <typeinfo>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <stdint.h>
+
+#include <acl/acl.h>
+#include <acl/ip_check.h>
+#include <acl/logic_check.h>
+
+namespace bundy {
+namespace acl {
+
+/// \brief Binary trie of IP address prefixes
+///
+/// Each prefix inserted into the trie is labelled with an index, and looking
+/// an address up returns the lowest index of all the prefixes containing the
+/// address.  When the index is the position of an ACL entry, this is the
+/// first entry that matches the address, found in time proportional to the
+/// number of bits of the address rather than to the number of entries.
+///
+/// IPv4 and IPv6 prefixes are kept apart; an address only matches the
+/// prefixes of its own family, as with \c IPCheck.
+class IPPrefixTrie {
+public:
+    /// \brief Returned by find() when no prefix contains the address
+    static const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    /// \brief Constructor
+    ///
+    /// Creates an empty trie.
+    IPPrefixTrie();
+
+    /// \brief Insert a prefix
+    ///
+    /// If a shorter prefix containing this one has already been inserted
+    /// with a lower index, the new prefix can never be returned and the trie
+    /// is left unchanged.
+    ///
+    /// \param family Address family, AF_INET or AF_INET6.
+    /// \param address The prefix in network byte order.  It must hold at
+    ///        least the bytes covered by the prefix length.
+    /// \param prefixlen Number of significant bits of the address.
+    /// \param index Label of the prefix.
+    ///
+    /// \exception bundy::BadValue The family is unknown or the prefix length
+    ///            is too long for it.
+    void insert(int family, const uint8_t* address, size_t prefixlen,
+                size_t index);
+
+    /// \brief Find the lowest index of the prefixes containing an address
+    ///
+    /// \param family Address family.
+    /// \param address The address in network byte order, 4 bytes long for
+    ///        AF_INET and 16 bytes long for AF_INET6.
+    ///
+    /// \return The index, or NOT_FOUND if no prefix contains the address or
+    ///         the family is neither AF_INET nor AF_INET6.
+    size_t find(int family, const uint8_t* address) const;
+
+    /// \brief Return the number of nodes of the trie, including the roots
+    size_t getNodeCount() const {
+        return (nodes_.size());
+    }
+
+private:
+    /// \brief Node of the trie
+    ///
+    /// A node stands for the prefix given by the path from the root.  The
+    /// roots are never children, so zero marks a missing child.
+    struct Node {
+        uint32_t children_[2];  ///< Nodes extending the prefix by 0 and 1
+        size_t index_;          ///< Lowest index of this prefix or NOT_FOUND
+    };
+
+    /// \brief Add a node to the trie and return its position
+    uint32_t addNode();
+
+    /// All the nodes, the roots of IPv4 and IPv6 first
+    std::vector<Node> nodes_;
+};
+
+/// \brief Return the IP address of the context
+///
+/// This must be specialised for each context type the IPTrieACL is used
+/// with, returning the same address the \c IPCheck::matches() of that
+/// context checks.
+template <typename Context>
+const IPAddress& getIPAddress(const Context& context);
+
+/// \brief Compiled form of the leading IP address entries of an ACL
+///
+/// It covers the longest run of entries at the beginning of the ACL whose
+/// checks are plain \c IPCheck objects, or \c AnyOf operators of such checks
+/// (which is what the abbreviated list of addresses in the ACL definition
+/// turns into).  Each of the prefixes is inserted into an \c IPPrefixTrie
+/// labelled with the position of its entry.  The remaining entries are left
+/// to the ACL to test one by one.
+///
+/// The context type must have a specialisation of \c getIPAddress().
+template <typename Context, typename Action = BasicAction>
+class IPTrieACL : public ACL<Context, Action>::Compiled {
+public:
+    /// \brief Constructor
+    ///
+    /// \param acl The ACL to compile.  The object keeps copies of the
+    ///        actions, the ACL can be destroyed afterwards.
+    explicit IPTrieACL(const ACL<Context, Action>& acl) {
+        std::vector<const IPCheck<Context>*> checks;
+        for (size_t i = 0; i < acl.getEntryCount(); ++i) {
+            checks.clear();
+            if (!collectChecks(acl.getCheck(i), checks)) {
+                break;
+            }
+            for (size_t j = 0; j < checks.size(); ++j) {
+                const std::vector<uint8_t> address(checks[j]->getAddress());
+                trie_.insert(checks[j]->getFamily(), &address[0],
+                             checks[j]->getPrefixlen(), i);
+            }
+            actions_.push_back(acl.getAction(i));
+        }
+    }
+
+    virtual const Action* execute(const Context& context) const {
+        const IPAddress& address(getIPAddress(context));
+        const size_t index = trie_.find(address.getFamily(),
+                                        address.getData());
+        if (index == IPPrefixTrie::NOT_FOUND) {
+            return (NULL);
+        }
+        return (&actions_[index]);
+    }
+
+    virtual size_t getEntryCount() const {
+        return (actions_.size());
+    }
+
+    /// \brief Return the trie of the prefixes
+    const IPPrefixTrie& getTrie() const {
+        return (trie_);
+    }
+
+private:
+    /// \brief Collect the IP checks an entry is the union of
+    ///
+    /// \return false if the check is anything else.  Subclasses of the
+    ///         checks are not accepted, as they may override matches().
+    static bool collectChecks(const Check<Context>& check,
+                              std::vector<const IPCheck<Context>*>& checks)
+    {
+        if (typeid(check) == typeid(IPCheck<Context>)) {
+            checks.push_back(static_cast<const IPCheck<Context>*>(&check));
+            return (true);
+        }
+        if (typeid(check) == typeid(LogicOperator<AnyOfSpec, Context>)) {
+            const typename CompoundCheck<Context>::Checks subexpressions(
+                static_cast<const LogicOperator<AnyOfSpec, Context>&>(check).
+                getSubexpressions());
+            for (size_t i = 0; i < subexpressions.size(); ++i) {
+                if (!collectChecks(*subexpressions[i], checks)) {
+                    return (false);
+                }
+            }
+            return (true);
+        }
+        return (false);
+    }
+
+    IPPrefixTrie trie_;
+    std::vector<Action> actions_;
+};
+
+/// \brief Compile the leading IP address entries of an ACL
+///
+/// This is meant to be set as the compiler of a \c Loader.  Looking an
+/// address up in the trie has a fixed cost, so short runs of address
+/// entries are left to be tested one by one.
+///
+/// \param acl The ACL to compile.
+/// \param min_entries Minimal number of entries worth compiling.
+///
+/// \return The compiled form, or NULL if it would cover fewer than
+///         \c min_entries entries.
+template <typename Context, typename Action>
+typename ACL<Context, Action>::ConstCompiledPtr
+compileIPACL(const ACL<Context, Action>& acl, size_t min_entries) {
+    boost::shared_ptr<IPTrieACL<Context, Action> >
+        compiled(new IPTrieACL<Context, Action>(acl));
+    if (compiled->getEntryCount() == 0 ||
+        compiled->getEntryCount() < min_entries) {
+        return (typename ACL<Context, Action>::ConstCompiledPtr());
+    }
+    return (compiled);
+}
+
+} // namespace acl
+} // namespace bundy
+
+#endif // IP_TRIE_H
+
+// Local Variables:
+// mode: c++
+// End:
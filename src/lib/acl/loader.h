@@ -294,6 +294,28 @@ public:
         return (loadCheck(description, map));
     }
 
+    /**
+     * \brief Function compiling a loaded ACL.
+     *
+     * It returns the compiled form of the ACL (see ACL::setCompiled()), or
+     * NULL if the ACL can't be compiled.
+     */
+    typedef boost::function1<typename ACL<Context, Action>::ConstCompiledPtr,
+                             const ACL<Context, Action>&> Compiler;
+
+    /**
+     * \brief Set the compiler of loaded ACLs.
+     *
+     * Each ACL loaded by load() is passed to the compiler and gets the
+     * compiled form it returns.
+     *
+     * \param compiler The compiler. If empty (the default), the ACLs are
+     *     not compiled.
+     */
+    void setCompiler(const Compiler& compiler) {
+        compiler_ = compiler;
+    }
+
     /**
      * \brief Load an ACL.
      *
@@ -354,6 +376,9 @@ public:
                                acValue);
             }
         }
+        if (compiler_) {
+            result->setCompiled(compiler_(*result));
+        }
         return (result);
     }
 
@@ -366,6 +391,7 @@ private:
     Creators creators_;
     const Action default_action_;
     const boost::function1<Action, data::ConstElementPtr> action_loader_;
+    Compiler compiler_;
 
     /**
      * \brief Internal version of loadCheck.
@@ -262,6 +262,43 @@ TEST_F(RequestCheckTest, checkTSIGKey) {
     EXPECT_FALSE(createKeyCheck("key.example.com")->matches(getRequest6()));
 }
 
+// Check the leading address entries of a loaded ACL are compiled and the
+// result is the same as if the entries were tested one by one.
+TEST(DNSACL, compiled) {
+    const boost::shared_ptr<dns::RequestACL> acl(getRequestLoader().load(
+        Element::fromJSON("[{\"action\": \"DROP\", \"from\": \"192.0.2.1\"},"
+                          " {\"action\": \"ACCEPT\","
+                          "  \"from\": [\"192.0.2.0/24\", \"2001:db8::/32\"]},"
+                          " {\"action\": \"DROP\", \"from\": \"10.0.0.0/8\"},"
+                          " {\"action\": \"ACCEPT\", \"from\": \"10.1.0.0/16\"},"
+                          " {\"action\": \"ACCEPT\", \"key\": \"key.example.\"},"
+                          " {\"action\": \"ACCEPT\", \"from\": \"198.51.100.0/24\"},"
+                          " {\"action\": \"DROP\", \"from\": \"any4\"}]")));
+    ASSERT_TRUE(acl->getCompiled());
+    EXPECT_EQ(4, acl->getCompiled()->getEntryCount());
+
+    const char* const addresses[] = {
+        "192.0.2.1", "192.0.2.2", "2001:db8::1", "2001:db9::1", "10.1.0.1",
+        "198.51.100.1", "203.0.113.1", NULL
+    };
+    const BasicAction expected[] = {
+        DROP, ACCEPT, ACCEPT, REJECT, DROP, ACCEPT, DROP
+    };
+    for (size_t i = 0; addresses[i] != NULL; ++i) {
+        SCOPED_TRACE(addresses[i]);
+        const IPAddress address(tests::getSockAddr(addresses[i]));
+        const dns::RequestContext request(address, NULL);
+        EXPECT_EQ(expected[i], acl->execute(request));
+    }
+}
+
+// ACLs with only a few address entries are not compiled.
+TEST(DNSACL, notCompiled) {
+    EXPECT_FALSE(getRequestLoader().load(
+        Element::fromJSON("[{\"action\": \"DROP\", \"from\": \"192.0.2.1\"},"
+                          " {\"action\": \"ACCEPT\"}]"))->getCompiled());
+}
+
 // The following tests test only the creators are registered, they are tested
 // elsewhere
 
@@ -0,0 +1,116 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#include <gtest/gtest.h>
+#include <acl/ip_trie.h>
+
+#include <string>
+
+using namespace bundy::acl;
+using std::string;
+
+namespace {
+
+class IPPrefixTrieTest : public ::testing::Test {
+protected:
+    // Insert the prefix given in textual form.
+    void insert(const string& address, size_t prefixlen, size_t index) {
+        const int family = toBinary(address);
+        trie_.insert(family, buffer_, prefixlen, index);
+    }
+
+    // Look up the address given in textual form.
+    size_t find(const string& address) {
+        const int family = toBinary(address);
+        return (trie_.find(family, buffer_));
+    }
+
+    IPPrefixTrie trie_;
+
+private:
+    int toBinary(const string& address) {
+        const int family = (address.find(':') == string::npos) ? AF_INET :
+            AF_INET6;
+        if (inet_pton(family, address.c_str(), buffer_) != 1) {
+            ADD_FAILURE() << "Invalid address " << address;
+        }
+        return (family);
+    }
+
+    uint8_t buffer_[16];
+};
+
+// An empty trie contains nothing.
+TEST_F(IPPrefixTrieTest, empty) {
+    EXPECT_EQ(2, trie_.getNodeCount());
+    EXPECT_EQ(IPPrefixTrie::NOT_FOUND, find("192.0.2.1"));
+    EXPECT_EQ(IPPrefixTrie::NOT_FOUND, find("2001:db8::1"));
+}
+
+// Check the lowest index of the containing prefixes is found, whatever their
+// lengths are.
+TEST_F(IPPrefixTrieTest, firstMatch) {
+    insert("192.0.2.1", 32, 0);
+    insert("192.0.2.0", 24, 1);
+    insert("10.0.0.0", 8, 2);
+    insert("10.1.0.0", 16, 3);
+    insert("0.0.0.0", 0, 4);
+
+    EXPECT_EQ(0, find("192.0.2.1"));
+    EXPECT_EQ(1, find("192.0.2.2"));
+    EXPECT_EQ(2, find("10.1.2.3"));
+    EXPECT_EQ(2, find("10.2.3.4"));
+    EXPECT_EQ(4, find("192.0.1.1"));
+}
+
+// Check prefixes shadowed by shorter ones inserted earlier are not stored.
+TEST_F(IPPrefixTrieTest, shadowed) {
+    insert("10.0.0.0", 8, 0);
+    const size_t count = trie_.getNodeCount();
+    insert("10.1.0.0", 16, 1);
+    EXPECT_EQ(count, trie_.getNodeCount());
+    EXPECT_EQ(0, find("10.1.0.1"));
+}
+
+// Check the families are kept apart.
+TEST_F(IPPrefixTrieTest, families) {
+    insert("192.0.2.0", 24, 0);
+    insert("2001:db8::", 32, 1);
+    insert("::", 0, 2);
+
+    EXPECT_EQ(0, find("192.0.2.1"));
+    EXPECT_EQ(IPPrefixTrie::NOT_FOUND, find("192.0.1.1"));
+    EXPECT_EQ(1, find("2001:db8::1"));
+    // The first bytes of the address are the same as the IPv4 prefix.
+    EXPECT_EQ(2, find("c000:0201::"));
+    EXPECT_EQ(2, find("::1"));
+}
+
+// Check invalid prefixes are rejected and unknown families found nowhere.
+TEST_F(IPPrefixTrieTest, invalid) {
+    const uint8_t address[16] = { 0 };
+    EXPECT_THROW(trie_.insert(AF_INET, address, 33, 0), bundy::BadValue);
+    EXPECT_THROW(trie_.insert(AF_INET6, address, 129, 0), bundy::BadValue);
+    EXPECT_THROW(trie_.insert(AF_UNIX, address, 0, 0), bundy::BadValue);
+    EXPECT_EQ(2, trie_.getNodeCount());
+
+    trie_.insert(AF_INET, address, 0, 0);
+    EXPECT_EQ(IPPrefixTrie::NOT_FOUND, trie_.find(AF_UNIX, address));
+}
+
+}
@@ -386,8 +386,27 @@ default_logconfig_handler(const std::string& module_name,
         }
     }
 
+    // Write the messages queued so far with the old settings, and don't let
+    // the background thread write while the loggers are being reconfigured.
+    bundy::log::LoggerManager::stopAsyncOutput();
+
     bundy::log::LoggerManager logger_manager;
     logger_manager.process(specs.begin(), specs.end());
+
+    if (new_config->contains("async_output") &&
+        new_config->get("async_output")->boolValue()) {
+        size_t queue_size = bundy::log::AsyncOutput::DEFAULT_QUEUE_SIZE;
+        if (new_config->contains("async_queue_size")) {
+            queue_size = new_config->get("async_queue_size")->intValue();
+        }
+        bundy::log::AsyncOutput::OverflowPolicy policy =
+            bundy::log::AsyncOutput::DROP;
+        if (new_config->contains("async_overflow") &&
+            new_config->get("async_overflow")->stringValue() == "block") {
+            policy = bundy::log::AsyncOutput::BLOCK;
+        }
+        bundy::log::LoggerManager::startAsyncOutput(queue_size, policy);
+    }
 }
 
 
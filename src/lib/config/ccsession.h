@@ -735,7 +735,8 @@ private:
 ///
 /// This function updates the (global) loggers by initializing a
 /// LoggerManager and passing the settings as specified in the given
-/// configuration update.
+/// configuration update.  If the configuration enables the asynchronous
+/// output, it is (re)started once the loggers have been updated.
 ///
 /// \param module_name The name of the module
 /// \param new_config The modified configuration values
@@ -65,7 +65,9 @@ namespace cryptolink {
 class HMACImpl {
 public:
     explicit HMACImpl(const void* secret, size_t secret_len,
-                      const HashAlgorithm hash_algorithm) {
+                      const HashAlgorithm hash_algorithm) :
+        updated_(false)
+    {
         Botan::HashFunction* hash;
         try {
             hash = Botan::get_hash(
@@ -131,6 +133,7 @@ public:
 
     void update(const void* data, const size_t len) {
         try {
+            updated_ = true;
             hmac_->update(static_cast<const Botan::byte*>(data), len);
         } catch (const Botan::Exception& exc) {
             bundy_throw(bundy::cryptolink::LibraryError, exc.what());
@@ -140,6 +143,7 @@ public:
     void sign(bundy::util::OutputBuffer& result, size_t len) {
         try {
             Botan::SecureVector<Botan::byte> b_result(hmac_->final());
+            updated_ = false;
 
             if (len == 0 || len > b_result.size()) {
                 len = b_result.size();
@@ -153,6 +157,7 @@ public:
     void sign(void* result, size_t len) {
         try {
             Botan::SecureVector<Botan::byte> b_result(hmac_->final());
+            updated_ = false;
             size_t output_size = getOutputLength();
             if (output_size > len) {
                 output_size = len;
@@ -166,6 +171,7 @@ public:
     std::vector<uint8_t> sign(size_t len) {
         try {
             Botan::SecureVector<Botan::byte> b_result(hmac_->final());
+            updated_ = false;
             if (len == 0 || len > b_result.size()) {
                 return (std::vector<uint8_t>(b_result.begin(), b_result.end()));
             } else {
@@ -184,6 +190,7 @@ public:
         // SEE BELOW FOR TEMPORARY CHANGE
         try {
             Botan::SecureVector<Botan::byte> our_mac = hmac_->final();
+            updated_ = false;
             if (len < getOutputLength()) {
                 // Currently we don't support truncated signature in TSIG (see
                 // #920).  To avoid validating too short signature accidently,
@@ -203,8 +210,24 @@ public:
         }
     }
 
+    void reset() {
+        if (!updated_) {
+            return;
+        }
+        // Botan's HMAC starts a new message with the same key when the
+        // final value is calculated, so we only discard it.
+        try {
+            hmac_->final();
+            updated_ = false;
+        } catch (const Botan::Exception& exc) {
+            bundy_throw(bundy::cryptolink::LibraryError, exc.what());
+        }
+    }
+
 private:
     boost::scoped_ptr<Botan::HMAC> hmac_;
+    // Whether data has been added since the last final().
+    bool updated_;
 };
 
 HMAC::HMAC(const void* secret, size_t secret_length,
@@ -247,6 +270,11 @@ HMAC::verify(const void* sig, const size_t len) {
     return (impl_->verify(sig, len));
 }
 
+void
+HMAC::reset() {
+    impl_->reset();
+}
+
 void
 signHMAC(const void* data, const size_t data_len, const void* secret,
          size_t secret_len, const HashAlgorithm hash_algorithm,
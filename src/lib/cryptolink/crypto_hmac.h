@@ -32,6 +32,9 @@ class HMACImpl;
 /// This class is used to create and verify HMAC signatures. Instances
 /// can be created with CryptoLink::createHMAC()
 ///
+/// After a signature is calculated or verified, the object is ready for
+/// another one with the same secret; the key setup isn't done again.
+///
 class HMAC : private boost::noncopyable {
 private:
     /// \brief Constructor from a secret and a hash algorithm
@@ -127,6 +130,17 @@ public:
     /// \return true if the signature is correct, false otherwise
     bool verify(const void* sig, size_t len);
 
+    /// \brief Discard the data added since the last signature
+    ///
+    /// This puts the object back to the state just after its
+    /// construction, so it can be used for a new signature with the same
+    /// secret.  It does nothing if no data has been added since the last
+    /// call to \c sign() or \c verify().
+    ///
+    /// \exception LibraryError if there was any unexpected exception
+    ///                         in the underlying library
+    void reset();
+
 private:
     HMACImpl* impl_;
 };
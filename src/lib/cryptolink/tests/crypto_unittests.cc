@@ -581,6 +581,37 @@ TEST(CryptoLinkTest, HMACSigLengthArgument) {
     EXPECT_EQ(32, sigBufferLength(SHA256, 3200));
 }
 
+TEST(CryptoLinkTest, HMACReuse) {
+    // RFC2202 test case 2 for HMAC-MD5
+    const std::string data("what do ya want for nothing?");
+    const uint8_t hmac_expected[] = { 0x75, 0x0c, 0x78, 0x3e, 0x6a,
+                                      0xb0, 0xb5, 0x03, 0xea, 0xa8,
+                                      0x6e, 0x31, 0x0a, 0x5d, 0xb7,
+                                      0x38 };
+    boost::shared_ptr<HMAC> hmac(
+        CryptoLink::getCryptoLink().createHMAC("Jefe", 4, MD5), deleteHMAC);
+
+    // The same object can be used for another signature after signing
+    // or verifying.
+    hmac->update(data.c_str(), data.size());
+    checkData(&hmac->sign()[0], hmac_expected, 16);
+    hmac->update(data.c_str(), data.size());
+    EXPECT_TRUE(hmac->verify(hmac_expected, 16));
+    hmac->update(data.c_str(), data.size());
+    checkData(&hmac->sign()[0], hmac_expected, 16);
+
+    // reset() discards the data added so far.
+    hmac->update("garbage", 7);
+    hmac->reset();
+    hmac->update(data.c_str(), data.size());
+    checkData(&hmac->sign()[0], hmac_expected, 16);
+
+    // And it's no-op if nothing has been added.
+    hmac->reset();
+    hmac->update(data.c_str(), data.size());
+    EXPECT_TRUE(hmac->verify(hmac_expected, 16));
+}
+
 TEST(CryptoLinkTest, BadKey) {
     OutputBuffer data_buf(0);
     OutputBuffer hmac_sig(0);
@@ -0,0 +1,142 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <datasrc/accessor_pool.h>
+#include <datasrc/database.h>
+
+#include <exceptions/exceptions.h>
+#include <util/threads/sync.h>
+
+#include <vector>
+
+using bundy::util::thread::Mutex;
+
+namespace bundy {
+namespace datasrc {
+
+typedef boost::shared_ptr<DatabaseAccessor> AccessorPtr;
+
+struct DatabaseAccessorPool::Impl {
+    Impl(const AccessorPtr& accessor, size_t size) :
+        accessor_(accessor), size_(size), closed_(false)
+    {}
+
+    // Put an accessor back to the pool.  If it isn't kept, it's destroyed
+    // when the caller's copy goes out of scope, outside of the lock.
+    void release(const AccessorPtr& accessor) {
+        Mutex::Locker locker(mutex_);
+        if (!closed_ && idle_.size() < size_) {
+            idle_.push_back(accessor);
+        }
+    }
+
+    const AccessorPtr accessor_;
+    const size_t size_;
+    bool closed_;
+    std::vector<AccessorPtr> idle_;
+    Mutex mutex_;
+};
+
+// The deleter of the pointers returned by get().  It holds the real pointer
+// to the accessor, which goes back to the pool, and keeps the internal
+// state alive in case the pool is destroyed first.
+struct DatabaseAccessorPool::Releaser {
+    Releaser(const boost::shared_ptr<Impl>& impl,
+             const AccessorPtr& accessor) :
+        impl_(impl), accessor_(accessor)
+    {}
+
+    void operator()(DatabaseAccessor*) {
+        try {
+            impl_->release(accessor_);
+        } catch (...) {
+            // Failing to lock the mutex leaves the accessor out of the pool,
+            // which is harmless.
+        }
+        accessor_.reset();
+        impl_.reset();
+    }
+
+    boost::shared_ptr<Impl> impl_;
+    AccessorPtr accessor_;
+};
+
+DatabaseAccessorPool::DatabaseAccessorPool(const AccessorPtr& accessor,
+                                           size_t size)
+{
+    if (!accessor) {
+        bundy_throw(bundy::InvalidParameter,
+                    "No database accessor provided to the accessor pool");
+    }
+    if (size == 0) {
+        bundy_throw(bundy::InvalidParameter,
+                    "Size of the accessor pool must be greater than zero");
+    }
+    impl_.reset(new Impl(accessor, size));
+}
+
+DatabaseAccessorPool::~DatabaseAccessorPool() {
+    std::vector<AccessorPtr> idle;
+    {
+        Mutex::Locker locker(impl_->mutex_);
+        impl_->closed_ = true;
+        idle.swap(impl_->idle_);
+    }
+}
+
+AccessorPtr
+DatabaseAccessorPool::get() {
+    AccessorPtr accessor;
+    {
+        Mutex::Locker locker(impl_->mutex_);
+        if (!impl_->idle_.empty()) {
+            accessor = impl_->idle_.back();
+            impl_->idle_.pop_back();
+        }
+    }
+    if (!accessor) {
+        // Opening a connection may take long, so don't hold the lock.
+        accessor = impl_->accessor_->clone();
+    }
+    return (AccessorPtr(accessor.get(), Releaser(impl_, accessor)));
+}
+
+void
+DatabaseAccessorPool::warmUp() {
+    for (;;) {
+        {
+            Mutex::Locker locker(impl_->mutex_);
+            if (impl_->idle_.size() >= impl_->size_) {
+                break;
+            }
+        }
+        const AccessorPtr accessor(impl_->accessor_->clone());
+        accessor->prepareStatements();
+        impl_->release(accessor);
+    }
+}
+
+size_t
+DatabaseAccessorPool::getSize() const {
+    return (impl_->size_);
+}
+
+size_t
+DatabaseAccessorPool::getIdleCount() const {
+    Mutex::Locker locker(impl_->mutex_);
+    return (impl_->idle_.size());
+}
+
+} // namespace datasrc
+} // namespace bundy
@@ -0,0 +1,105 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef DATASRC_ACCESSOR_POOL_H
+#define DATASRC_ACCESSOR_POOL_H
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <cstddef>
+
+namespace bundy {
+namespace datasrc {
+
+class DatabaseAccessor;
+
+/// \brief A pool of database accessors.
+///
+/// A single \c DatabaseAccessor can't be used by more than one thread at a
+/// time, and each update transaction needs an accessor of its own.  This
+/// class keeps clones of a given accessor ready for use, so that each user
+/// (a zone finder, iterator, updater, etc.) gets an accessor of its own
+/// without opening a new database connection every time.
+///
+/// An accessor is taken from the pool with \c get() and returned to it
+/// automatically when the last copy of the returned pointer is released.
+/// As long as the objects holding the accessors are not shared between
+/// threads, each thread therefore works with its own accessor.
+///
+/// The pool is bounded: at most the given number of idle accessors are
+/// kept.  \c get() never blocks; if no accessor is idle, a new clone is
+/// made, and an accessor returned to a full pool is destroyed.
+///
+/// The methods of this class are thread safe.  The pointers it returns
+/// remain valid after the pool is destroyed.
+class DatabaseAccessorPool : boost::noncopyable {
+public:
+    /// \brief Constructor
+    ///
+    /// No accessor is created at construction; see \c warmUp().
+    ///
+    /// \throw bundy::InvalidParameter accessor is NULL or size is 0.
+    ///
+    /// \param accessor The accessor the pooled ones are cloned from.  It is
+    ///     never returned by \c get().
+    /// \param size Maximum number of idle accessors kept in the pool.
+    DatabaseAccessorPool(const boost::shared_ptr<DatabaseAccessor>& accessor,
+                         size_t size);
+
+    /// \brief Destructor
+    ///
+    /// The idle accessors are destroyed.  The ones in use are destroyed
+    /// when released.
+    ~DatabaseAccessorPool();
+
+    /// \brief Get an accessor from the pool.
+    ///
+    /// The accessor is in no transaction.  It must be released (i.e., all
+    /// copies of the returned pointer destroyed) in the same state.
+    ///
+    /// \throw Whatever \c DatabaseAccessor::clone() throws if a new accessor
+    ///     is needed.
+    boost::shared_ptr<DatabaseAccessor> get();
+
+    /// \brief Fill the pool.
+    ///
+    /// Clones accessors until the pool holds as many idle ones as its size
+    /// and calls \c DatabaseAccessor::prepareStatements() on each of them,
+    /// so that the first users of the pool don't pay for it.
+    ///
+    /// \throw Whatever \c DatabaseAccessor::clone() or
+    ///     \c DatabaseAccessor::prepareStatements() throws.
+    void warmUp();
+
+    /// \brief Return the maximum number of idle accessors.
+    size_t getSize() const;
+
+    /// \brief Return the number of idle accessors in the pool.
+    size_t getIdleCount() const;
+
+private:
+    struct Impl;
+    struct Releaser;
+    boost::shared_ptr<Impl> impl_;
+};
+
+} // namespace datasrc
+} // namespace bundy
+
+#endif // DATASRC_ACCESSOR_POOL_H
+
+// Local Variables:
+// mode: c++
+// End:
@@ -22,6 +22,7 @@
 #include <datasrc/rrset_collection_base.h>
 
 #include <exceptions/exceptions.h>
+#include <util/buffer.h>
 #include <dns/name.h>
 #include <dns/labelsequence.h>
 #include <dns/rrclass.h>
@@ -83,36 +84,56 @@ private:
 
 
 DatabaseClient::DatabaseClient(const std::string& datasrc_name, RRClass rrclass,
-                               boost::shared_ptr<DatabaseAccessor>
-                               accessor) :
+                               boost::shared_ptr<DatabaseAccessor> accessor,
+                               size_t pool_size, size_t cache_size) :
     DataSourceClient(datasrc_name), rrclass_(rrclass), accessor_(accessor)
 {
     if (!accessor_) {
         bundy_throw(bundy::InvalidParameter,
                   "No database provided to DatabaseClient");
     }
+    if (pool_size > 0) {
+        pool_.reset(new DatabaseAccessorPool(accessor_, pool_size));
+        pool_->warmUp();
+    }
+    if (cache_size > 0) {
+        cache_.reset(new FindResultCache(cache_size));
+    }
+}
+
+boost::shared_ptr<DatabaseAccessor>
+DatabaseClient::getAccessor() const {
+    return (pool_ ? pool_->get() : accessor_);
+}
+
+boost::shared_ptr<DatabaseAccessor>
+DatabaseClient::cloneAccessor() const {
+    return (pool_ ? pool_->get() : accessor_->clone());
 }
 
 DataSourceClient::FindResult
 DatabaseClient::findZone(const Name& name) const {
-    std::pair<bool, int> zone(accessor_->getZone(name.toText()));
+    const boost::shared_ptr<DatabaseAccessor> accessor(getAccessor());
+    std::pair<bool, int> zone(accessor->getZone(name.toText()));
     // Try exact first
     if (zone.first) {
         return (FindResult(result::SUCCESS,
-                           ZoneFinderPtr(new Finder(accessor_,
-                                                    zone.second, name)),
+                           ZoneFinderPtr(new Finder(accessor,
+                                                    zone.second, name,
+                                                    cache_)),
                            name.getLabelCount()));
     }
     // Then super domains
     // Start from 1, as 0 is covered above
     for (size_t i = 1; i < name.getLabelCount(); ++i) {
         bundy::dns::Name superdomain(name.split(i));
-        zone = accessor_->getZone(superdomain.toText());
+        zone = accessor->getZone(superdomain.toText());
         if (zone.first) {
             return (FindResult(result::PARTIALMATCH,
-                               ZoneFinderPtr(new Finder(accessor_,
+                               ZoneFinderPtr(new Finder(accessor,
                                                         zone.second,
-                                                        superdomain)),
+                                                        superdomain,
+                                                        cache_)),
 
                                superdomain.getLabelCount()));
         }
@@ -146,24 +167,58 @@ DatabaseClient::deleteZone(const Name& zone_name) {
 }
 
 DatabaseClient::Finder::Finder(boost::shared_ptr<DatabaseAccessor> accessor,
-                               int zone_id, const bundy::dns::Name& origin) :
+                               int zone_id, const bundy::dns::Name& origin,
+                               boost::shared_ptr<FindResultCache> cache) :
     accessor_(accessor),
     zone_id_(zone_id),
-    origin_(origin)
+    origin_(origin),
+    cache_(cache),
+    serial_known_(false),
+    serial_(0)
 { }
 
 namespace {
+// Creates the Rdata of the record last returned by getNext() of the
+// context.  If the accessor provides the RDATA in the wire format, the
+// Rdata is built from it, which is much cheaper than parsing the text
+// in the RDATA column; the text is used otherwise.
+//
+// Raises a DataSourceError if the wire format data is broken, and
+// InvalidRdataText if the text doesn't parse.
+RdataPtr
+createRecordRdata(DatabaseAccessor::IteratorContext& context,
+                  const RRType& type, const RRClass& cls,
+                  const std::string& rdata_str)
+{
+    uint16_t type_code;
+    const uint8_t* data;
+    size_t length;
+    if (context.getWireRdata(type_code, data, length) &&
+        type_code == type.getCode()) {
+        try {
+            bundy::util::InputBuffer buffer(data, length);
+            return (rdata::createRdata(type, cls, buffer, length));
+        } catch (const bundy::Exception& ex) {
+            bundy_throw(DataSourceError, "bad wire format rdata in "
+                        "database for " << type << ": " << ex.what());
+        }
+    }
+    return (rdata::createRdata(type, cls, rdata_str));
+}
+
 // Adds the given Rdata to the given RRset
 // If the rrset is an empty pointer, a new one is
 // created with the given name, class, type and ttl
 // The type is checked if the rrset exists, but the
 // name is not.
 //
-// Then adds the given rdata to the set
+// Then adds the rdata of the current record of the
+// context to the set
 //
 // Raises a DataSourceError if the type does not
-// match, or if the given rdata string does not
-// parse correctly for the given type and class
+// match, or if the given rdata string (or its wire
+// format) does not parse correctly for the given type
+// and class
 //
 // The DatabaseAccessor is passed to print the
 // database name in the log message if the TTL is
@@ -173,6 +228,7 @@ void addOrCreate(bundy::dns::RRsetPtr& rrset,
                     const bundy::dns::RRClass& cls,
                     const bundy::dns::RRType& type,
                     const bundy::dns::RRTTL& ttl,
+                    DatabaseAccessor::IteratorContext& context,
                     const std::string& rdata_str,
                     const DatabaseAccessor& db
                 )
@@ -192,7 +248,7 @@ void addOrCreate(bundy::dns::RRsetPtr& rrset,
         }
     }
     try {
-        rrset->addRdata(bundy::dns::rdata::createRdata(type, cls, rdata_str));
+        rrset->addRdata(createRecordRdata(context, type, cls, rdata_str));
     } catch (const bundy::dns::rdata::InvalidRdataText& ivrt) {
         // at this point, rrset may have been initialised for no reason,
         // and won't be used. But the caller would drop the shared_ptr
@@ -291,8 +347,8 @@ DatabaseClient::Finder::getRRsets(const string& name, const WantedTypes& types,
                 // done.
                 // A possible optimization here is to not store them for
                 // types we are certain we don't need
-                sig_store.addSig(rdata::createRdata(cur_type, getClass(),
-                     columns[DatabaseAccessor::RDATA_COLUMN]));
+                sig_store.addSig(createRecordRdata(*context, cur_type,
+                     getClass(), columns[DatabaseAccessor::RDATA_COLUMN]));
             }
 
             if (types.find(cur_type) != types.end() || any) {
@@ -310,7 +366,7 @@ DatabaseClient::Finder::getRRsets(const string& name, const WantedTypes& types,
                 // of the 'type covered' field in the RRSIG Rdata).
                 //cur_sigtype(columns[SIGTYPE_COLUMN]);
                 addOrCreate(result[cur_type], construct_name_object,
-                            getClass(), cur_type, cur_ttl,
+                            getClass(), cur_type, cur_ttl, *context,
                             columns[DatabaseAccessor::RDATA_COLUMN],
                             *accessor_);
             }
@@ -418,6 +474,18 @@ NSEC_TYPES() {
     return (result);
 }
 
+const WantedTypes&
+SOA_TYPES() {
+    static bool initialized(false);
+    static WantedTypes result;
+
+    if (!initialized) {
+        result.insert(RRType::SOA());
+        initialized = true;
+    }
+    return (result);
+}
+
 const WantedTypes&
 DELEGATION_TYPES() {
     static bool initialized(false);
@@ -451,6 +519,9 @@ DatabaseClient::Finder::findAll(const bundy::dns::Name& name,
                                 std::vector<bundy::dns::ConstRRsetPtr>& target,
                                 const FindOptions options)
 {
+    if (useCache(name, RRType::ANY())) {
+        return (findCached(name, RRType::ANY(), &target, options));
+    }
     const DBResultContext result = findInternal(name, RRType::ANY(),
                                                 &target, options);
     return (ZoneFinderContextPtr(new GenericContext(
@@ -466,12 +537,99 @@ DatabaseClient::Finder::find(const bundy::dns::Name& name,
     if (type == RRType::ANY()) {
         bundy_throw(bundy::Unexpected, "Use findAll to answer ANY");
     }
+    if (useCache(name, type)) {
+        return (findCached(name, type, NULL, options));
+    }
     const DBResultContext result = findInternal(name, type, NULL, options);
+    if (cache_ && result.context_.code == SUCCESS &&
+        type == RRType::SOA() && name == origin_) {
+        // This is the cheap occasion to notice the zone has changed.
+        setSerial(result.context_.rrset);
+    }
     return (ZoneFinderContextPtr(new GenericContext(
                                      *this, options, result.context_,
                                      result.match_label_count_)));
 }
 
+ZoneFinderContextPtr
+DatabaseClient::Finder::findCached(const Name& name, const RRType& type,
+                                   std::vector<ConstRRsetPtr>* target,
+                                   const FindOptions options)
+{
+    FindResultCache::Result cached;
+    if (cache_->find(zone_id_, serial_, name, type, options, cached)) {
+        LOG_DEBUG(logger, DBG_TRACE_DETAILED, DATASRC_DATABASE_FIND_CACHED)
+            .arg(accessor_->getDBName()).arg(name).arg(type).arg(getClass());
+        const ResultContext context(cached.code, cached.rrset, cached.flags);
+        if (target == NULL) {
+            return (ZoneFinderContextPtr(new GenericContext(
+                                             *this, options, context,
+                                             cached.match_label_count)));
+        }
+        target->insert(target->end(), cached.all_set.begin(),
+                       cached.all_set.end());
+        return (ZoneFinderContextPtr(new GenericContext(
+                                         *this, options, context, *target,
+                                         cached.match_label_count)));
+    }
+
+    // findAll() appends to the target, so only the new part is stored.
+    const size_t target_size = (target == NULL) ? 0 : target->size();
+    const DBResultContext result = findInternal(name, type, target, options);
+    cached.code = result.context_.code;
+    cached.rrset = result.context_.rrset;
+    cached.flags = result.context_.flags;
+    cached.match_label_count = result.match_label_count_;
+    if (target != NULL) {
+        cached.all_set.assign(target->begin() + target_size, target->end());
+    }
+    cache_->add(zone_id_, serial_, name, type, options, cached);
+
+    if (target == NULL) {
+        return (ZoneFinderContextPtr(new GenericContext(
+                                         *this, options, result.context_,
+                                         result.match_label_count_)));
+    }
+    return (ZoneFinderContextPtr(new GenericContext(
+                                     *this, options, result.context_,
+                                     *target, result.match_label_count_)));
+}
+
+bool
+DatabaseClient::Finder::useCache(const Name& name, const RRType& type) {
+    if (!cache_ || (type == RRType::SOA() && name == origin_)) {
+        return (false);
+    }
+    if (!serial_known_) {
+        const FoundRRsets found = getRRsets(origin_.toText(), SOA_TYPES(),
+                                            false);
+        const std::map<RRType, RRsetPtr>::const_iterator soa =
+            found.second.find(RRType::SOA());
+        if (soa != found.second.end()) {
+            setSerial(soa->second);
+        }
+    }
+    // Without an SOA there is no way to tell the versions of the zone apart,
+    // so the cache is not used.
+    return (serial_known_);
+}
+
+void
+DatabaseClient::Finder::setSerial(const ConstRRsetPtr& soa) {
+    if (!soa || soa->getRdataCount() == 0) {
+        return;
+    }
+    const generic::SOA* const soa_rdata =
+        dynamic_cast<const generic::SOA*>(
+            &soa->getRdataIterator()->getCurrent());
+    if (soa_rdata == NULL) {
+        return;
+    }
+    serial_ = soa_rdata->getSerial().getValue();
+    serial_known_ = true;
+    cache_->setSerial(zone_id_, serial_);
+}
+
 DatabaseClient::Finder::DelegationSearchResult
 DatabaseClient::Finder::findDelegationPoint(const bundy::dns::Name& name,
                                             const FindOptions options)
@@ -1256,21 +1414,34 @@ public:
         // Start a separate transaction.
         accessor_->startTransaction();
 
-        // Find the SOA of the zone (may or may not succeed).  Note that
-        // this must be done before starting the iteration context.
-        soa_ = DatabaseClient::Finder(accessor_, zone.second, zone_name).
-            find(zone_name, RRType::SOA())->rrset;
-
-        // Request the context
-        context_ = accessor_->getAllRecords(zone.second);
-        // It must not return NULL, that's a bug of the implementation
-        if (!context_) {
-            bundy_throw(bundy::Unexpected, "Iterator context null at " +
-                      zone_name.toText());
-        }
+        try {
+            // Find the SOA of the zone (may or may not succeed).  Note that
+            // this must be done before starting the iteration context.
+            soa_ = DatabaseClient::Finder(accessor_, zone.second, zone_name).
+                find(zone_name, RRType::SOA())->rrset;
+
+            // Request the context
+            context_ = accessor_->getAllRecords(zone.second);
+            // It must not return NULL, that's a bug of the implementation
+            if (!context_) {
+                bundy_throw(bundy::Unexpected, "Iterator context null at " +
+                          zone_name.toText());
+            }
 
-        // Prepare data for the next time
-        getData();
+            // Prepare data for the next time
+            getData();
+        } catch (...) {
+            // The destructor won't be called, so end the transaction here;
+            // the accessor may be a pooled one used again later.
+            context_.reset();
+            try {
+                accessor_->rollback();
+            } catch (const DataSourceError&) {
+                // There's nothing more we can do; the original error is
+                // more interesting.
+            }
+            throw;
+        }
     }
 
     virtual ~DatabaseIterator() {
@@ -1361,8 +1532,8 @@ private:
             name_txt_ = data[DatabaseAccessor::NAME_COLUMN];
             rtype_txt_ = data[DatabaseAccessor::TYPE_COLUMN];
             ttl_txt_ = data[DatabaseAccessor::TTL_COLUMN];
-            rdata_ = rdata::createRdata(RRType(rtype_txt_), class_,
-                                        data[DatabaseAccessor::RDATA_COLUMN]);
+            rdata_ = createRecordRdata(*context_, RRType(rtype_txt_), class_,
+                                       data[DatabaseAccessor::RDATA_COLUMN]);
         }
     }
 
@@ -1392,7 +1563,7 @@ DatabaseClient::getIterator(const bundy::dns::Name& name,
                             bool separate_rrs) const
 {
     ZoneIteratorPtr iterator = ZoneIteratorPtr(new DatabaseIterator(
-                                                   accessor_->clone(), name,
+                                                   cloneAccessor(), name,
                                                    rrclass_, separate_rrs));
     LOG_DEBUG(logger, DBG_TRACE_DETAILED, DATASRC_DATABASE_ITERATE).
         arg(name);
@@ -1422,8 +1593,10 @@ class DatabaseUpdater : public ZoneUpdater {
 public:
     DatabaseUpdater(boost::shared_ptr<DatabaseAccessor> accessor, int zone_id,
             const Name& zone_name, const RRClass& zone_class,
-            bool journaling) :
-        committed_(false), accessor_(accessor), zone_id_(zone_id),
+            bool journaling,
+            boost::shared_ptr<FindResultCache> cache) :
+        committed_(false), accessor_(accessor), cache_(cache),
+        zone_id_(zone_id),
         db_name_(accessor->getDBName()), zone_name_(zone_name.toText()),
         zone_class_(zone_class), journaling_(journaling),
         diff_phase_(NOT_STARTED), serial_(0),
@@ -1473,6 +1646,8 @@ private:
 
     bool committed_;
     boost::shared_ptr<DatabaseAccessor> accessor_;
+    // The cache of the finders of the client, to be invalidated on commit
+    const boost::shared_ptr<FindResultCache> cache_;
     const int zone_id_;
     const string db_name_;
     const string zone_name_;
@@ -1752,6 +1927,11 @@ DatabaseUpdater::commit() {
     accessor_->commit();
     committed_ = true; // make sure the destructor won't trigger rollback
 
+    // The results cached by the finders of the client are now outdated.
+    if (cache_) {
+        cache_->invalidate(zone_id_);
+    }
+
     // Disable the RRsetCollection if it exists.
     if (rrset_collection_) {
         rrset_collection_->disableWrapper();
@@ -1782,7 +1962,8 @@ DatabaseClient::getUpdater(const bundy::dns::Name& name, bool replace,
     }
 
     return (ZoneUpdaterPtr(new DatabaseUpdater(update_accessor, zone.second,
-                                               name, rrclass_, journaling)));
+                                               name, rrclass_, journaling,
+                                               cache_)));
 }
 
 //
@@ -1857,7 +2038,7 @@ DatabaseClient::getJournalReader(const bundy::dns::Name& zone,
                                  uint32_t begin_serial,
                                  uint32_t end_serial) const
 {
-    boost::shared_ptr<DatabaseAccessor> jnl_accessor(accessor_->clone());
+    boost::shared_ptr<DatabaseAccessor> jnl_accessor(cloneAccessor());
     const pair<bool, int> zoneinfo(jnl_accessor->getZone(zone.toText()));
     if (!zoneinfo.first) {
         return (pair<ZoneJournalReader::Result, ZoneJournalReaderPtr>(
@@ -25,6 +25,8 @@
 #include <dns/rrtype.h>
 
 #include <datasrc/exceptions.h>
+#include <datasrc/accessor_pool.h>
+#include <datasrc/database_cache.h>
 #include <datasrc/client.h>
 #include <datasrc/zone.h>
 #include <datasrc/logger.h>
@@ -281,8 +283,6 @@ public:
         /// \param columns The data will be returned through here. The order
         ///     is specified by the RecordColumns enum, and the size must be
         ///     COLUMN_COUNT
-        /// \todo Do we consider databases where it is stored in binary blob
-        ///     format?
         /// \throw DataSourceError if there's database-related error. If the
         ///     exception (or any other in case of derived class) is thrown,
         ///     the iterator can't be safely used any more.
@@ -290,6 +290,34 @@ public:
         ///         updated. false if there was no more data, in which case
         ///         the columns array is untouched.
         virtual bool getNext(std::string (&columns)[COLUMN_COUNT]) = 0;
+
+        /// \brief Function to provide the wire format of the current RDATA
+        ///
+        /// Accessors storing the RDATA of the records in the wire format
+        /// can override this method, so the caller can build the RDATA of
+        /// the record returned by the last successful call to getNext()
+        /// without parsing the text in its RDATA_COLUMN.  The text column
+        /// must be filled by getNext() all the same.
+        ///
+        /// The returned data is only valid until the next call to getNext().
+        ///
+        /// The default implementation returns false, meaning only the text
+        /// form is available.
+        ///
+        /// \param rrtype Set to the numeric RRType of the record.
+        /// \param data Set to the beginning of the wire format RDATA, which
+        ///     doesn't include the RDLENGTH field, and in which the names
+        ///     are not compressed.
+        /// \param length Set to the length of the data in bytes.
+        /// \return true if the wire format of the RDATA of the current
+        ///     record is available; false otherwise, in which case the
+        ///     parameters are untouched.
+        virtual bool getWireRdata(uint16_t& /* rrtype */,
+                                  const uint8_t*& /* data */,
+                                  size_t& /* length */)
+        {
+            return (false);
+        }
     };
 
     typedef boost::shared_ptr<IteratorContext> IteratorContextPtr;
@@ -785,6 +813,18 @@ public:
     /// \return A shared pointer to the cloned accessor.
     virtual boost::shared_ptr<DatabaseAccessor> clone() = 0;
 
+    /// \brief Prepare the accessor for answering queries.
+    ///
+    /// This is called when the accessor is set up for serving data, so that
+    /// whatever the backend can do in advance (e.g., preparing the database
+    /// statements it will use) doesn't delay the first lookups.  It doesn't
+    /// change the result of any other method.
+    ///
+    /// The default implementation does nothing.
+    ///
+    /// \throw DataSourceError if there's a problem with the database.
+    virtual void prepareStatements() {}
+
     /// \brief Returns a string identifying this dabase backend
     ///
     /// The returned string is mainly intended to be used for
@@ -871,8 +911,24 @@ public:
     ///
     /// It initializes the client with a database via the given accessor.
     ///
+    /// If \c pool_size is non 0, the zone finders, iterators and journal
+    /// readers get accessors from a \c DatabaseAccessorPool of clones of
+    /// the given accessor.  Each of these objects then has an accessor of
+    /// its own, so the client can be used from more than one thread as long
+    /// as each object is used by one thread at a time.  The pool is filled
+    /// in the constructor.  If \c pool_size is 0, the given accessor is
+    /// shared by all the zone finders and cloned for the other objects.
+    /// The updaters always get a new clone, so that an accessor left in an
+    /// unknown state by a failed update is never reused.
+    ///
+    /// If \c cache_size is non 0, the results of the zone finders are kept
+    /// in a \c FindResultCache (see there for when they are dropped).  The
+    /// updates committed through the updaters of this client drop the
+    /// results for the zone at once.
+    ///
     /// \exception bundy::InvalidParameter if accessor is NULL. It might throw
-    /// standard allocation exception as well, but doesn't throw anything else.
+    /// standard allocation exception as well, and whatever the accessor
+    /// throws when filling the pool, but doesn't throw anything else.
     ///
     /// \param datasrc_name The name of the underlying data source.  See the
     /// base class constructor.
@@ -880,9 +936,15 @@ public:
     /// \param accessor The accessor to the database to use to get data.
     ///  As the parameter suggests, the client takes ownership of the accessor
     ///  and will delete it when itself deleted.
+    /// \param pool_size Maximum number of idle accessors kept in the pool,
+    ///  or 0 for no pool.
+    /// \param cache_size Maximum number of results kept in a
+    ///  \c FindResultCache shared by the zone finders of the client, or 0
+    ///  for no cache.
     DatabaseClient(const std::string& datasrc_name,
                    bundy::dns::RRClass rrclass,
-                   boost::shared_ptr<DatabaseAccessor> accessor);
+                   boost::shared_ptr<DatabaseAccessor> accessor,
+                   size_t pool_size = 0, size_t cache_size = 0);
 
 
     /// \brief Corresponding ZoneFinder implementation
@@ -910,8 +972,15 @@ public:
         /// \param origin The name of the origin of this zone. It could query
         ///     it from database, but as the DatabaseClient just searched for
         ///     the zone using the name, it should have it.
+        /// \param cache If not NULL, the results of \c find() and
+        ///     \c findAll() are looked up in and stored to this cache.  The
+        ///     finder checks the serial of the zone before its first use of
+        ///     the cache, and each time the SOA at the origin is looked up,
+        ///     which is never cached.
         Finder(boost::shared_ptr<DatabaseAccessor> database, int zone_id,
-               const bundy::dns::Name& origin);
+               const bundy::dns::Name& origin,
+               boost::shared_ptr<FindResultCache> cache =
+               boost::shared_ptr<FindResultCache>());
 
         // The following three methods are just implementations of inherited
         // ZoneFinder's pure virtual methods.
@@ -990,6 +1059,11 @@ public:
         boost::shared_ptr<DatabaseAccessor> accessor_;
         const int zone_id_;
         const bundy::dns::Name origin_;
+        const boost::shared_ptr<FindResultCache> cache_;
+        /// \brief Whether the serial of the zone has been checked
+        bool serial_known_;
+        /// \brief The serial of the zone, valid if serial_known_ is true
+        uint32_t serial_;
 
         /// \brief Shortcut name for the result of getRRsets
         typedef std::pair<bool, std::map<dns::RRType, dns::RRsetPtr> >
@@ -1029,6 +1103,29 @@ public:
                                      target,
                                      const FindOptions options = FIND_DEFAULT);
 
+        /// \brief Common part of find and findAll with the result cache.
+        ///
+        /// It returns the result from the cache if possible, and otherwise
+        /// calls findInternal() and stores its result in the cache.
+        ///
+        /// The returned context is the one for the caller to return.
+        ZoneFinderContextPtr findCached(const bundy::dns::Name& name,
+                                        const bundy::dns::RRType& type,
+                                        std::vector<bundy::dns::ConstRRsetPtr>*
+                                        target,
+                                        const FindOptions options);
+
+        /// \brief Whether the result cache can be used for a lookup.
+        ///
+        /// This checks the serial of the zone if not done yet.  The SOA
+        /// at the origin is always looked up in the database, so the
+        /// serial is checked at that time.
+        bool useCache(const bundy::dns::Name& name,
+                      const bundy::dns::RRType& type);
+
+        /// \brief Record the serial of the zone found in the given SOA.
+        void setSerial(const bundy::dns::ConstRRsetPtr& soa);
+
         /// \brief Searches database for RRsets of one domain.
         ///
         /// This method scans RRs of single domain specified by name and
@@ -1509,8 +1606,22 @@ private:
     /// \brief The RR class that this client handles.
     const bundy::dns::RRClass rrclass_;
 
+    /// \brief Return the accessor for a new zone finder.
+    boost::shared_ptr<DatabaseAccessor> getAccessor() const;
+
+    /// \brief Return an accessor for a separate set of operations.
+    ///
+    /// This is used by the iterators and journal readers.
+    boost::shared_ptr<DatabaseAccessor> cloneAccessor() const;
+
     /// \brief The accessor to our database.
     const boost::shared_ptr<DatabaseAccessor> accessor_;
+
+    /// \brief The pool of accessors, NULL if not used.
+    boost::scoped_ptr<DatabaseAccessorPool> pool_;
+
+    /// \brief The cache of the results of the finders, NULL if not used.
+    boost::shared_ptr<FindResultCache> cache_;
 };
 
 }
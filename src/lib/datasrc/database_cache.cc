@@ -0,0 +1,130 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <datasrc/database_cache.h>
+
+#include <exceptions/exceptions.h>
+
+using namespace bundy::dns;
+using bundy::util::thread::Mutex;
+
+namespace bundy {
+namespace datasrc {
+
+bool
+FindResultCache::Key::operator<(const Key& other) const {
+    if (zone_id != other.zone_id) {
+        return (zone_id < other.zone_id);
+    }
+    if (type != other.type) {
+        return (type < other.type);
+    }
+    if (options != other.options) {
+        return (options < other.options);
+    }
+    return (name < other.name);
+}
+
+FindResultCache::FindResultCache(size_t max_entries) :
+    max_entries_(max_entries)
+{
+    if (max_entries_ == 0) {
+        bundy_throw(bundy::InvalidParameter,
+                    "Size of the find result cache must be greater than zero");
+    }
+}
+
+bool
+FindResultCache::isCurrent(int zone_id, uint32_t serial) const {
+    const std::map<int, uint32_t>::const_iterator found =
+        serials_.find(zone_id);
+    return (found != serials_.end() && found->second == serial);
+}
+
+void
+FindResultCache::removeZone(int zone_id) {
+    EntryList::iterator it = entries_.begin();
+    while (it != entries_.end()) {
+        if (it->first.zone_id == zone_id) {
+            index_.erase(it->first);
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void
+FindResultCache::setSerial(int zone_id, uint32_t serial) {
+    Mutex::Locker locker(mutex_);
+    if (isCurrent(zone_id, serial)) {
+        return;
+    }
+    removeZone(zone_id);
+    serials_[zone_id] = serial;
+}
+
+void
+FindResultCache::invalidate(int zone_id) {
+    Mutex::Locker locker(mutex_);
+    removeZone(zone_id);
+    serials_.erase(zone_id);
+}
+
+bool
+FindResultCache::find(int zone_id, uint32_t serial, const Name& name,
+                      const RRType& type, ZoneFinder::FindOptions options,
+                      Result& result)
+{
+    Mutex::Locker locker(mutex_);
+    if (!isCurrent(zone_id, serial)) {
+        return (false);
+    }
+    const EntryMap::iterator found =
+        index_.find(Key(zone_id, name, type, options));
+    if (found == index_.end()) {
+        return (false);
+    }
+    // Move it to the front of the list, keeping the iterator valid.
+    entries_.splice(entries_.begin(), entries_, found->second);
+    result = found->second->second;
+    return (true);
+}
+
+void
+FindResultCache::add(int zone_id, uint32_t serial, const Name& name,
+                     const RRType& type, ZoneFinder::FindOptions options,
+                     const Result& result)
+{
+    const Key key(zone_id, name, type, options);
+    Mutex::Locker locker(mutex_);
+    if (!isCurrent(zone_id, serial) || index_.count(key) > 0) {
+        return;
+    }
+    if (entries_.size() >= max_entries_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    entries_.push_front(std::make_pair(key, result));
+    index_[key] = entries_.begin();
+}
+
+size_t
+FindResultCache::getSize() const {
+    Mutex::Locker locker(mutex_);
+    return (entries_.size());
+}
+
+} // namespace datasrc
+} // namespace bundy
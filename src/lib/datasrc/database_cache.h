@@ -0,0 +1,164 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef DATASRC_DATABASE_CACHE_H
+#define DATASRC_DATABASE_CACHE_H
+
+#include <datasrc/zone_finder.h>
+
+#include <dns/name.h>
+#include <dns/rrset.h>
+#include <dns/rrtype.h>
+
+#include <util/threads/sync.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include <stdint.h>
+
+namespace bundy {
+namespace datasrc {
+
+/// \brief Cache of the results of database zone finders.
+///
+/// Looking a name up in a database zone takes several database queries:
+/// the names between the origin and the query name are checked for zone
+/// cuts, and negative answers need the previous name for the NSEC proof.
+/// This class keeps the results of \c ZoneFinder::find() and
+/// \c ZoneFinder::findAll() calls of the \c DatabaseClient::Finder objects
+/// of a client, so that a repeated lookup is answered without querying
+/// the database.
+///
+/// The results are only valid for the version of the zone they were found
+/// in, which is identified by the serial of its SOA.  The cache remembers
+/// the last serial seen for each zone, and each finder tells it the serial
+/// it sees (see \c setSerial()) before using it.  When the serial changes,
+/// all the results for the zone are dropped.  Results are only returned to
+/// and accepted from the finders that saw the current serial, so a finder
+/// that started before the change doesn't mix versions.  Updates which
+/// don't change the serial are only noticed when made in the same process
+/// (see \c invalidate()).
+///
+/// The number of cached results is bounded; the least recently used ones
+/// are dropped first.
+///
+/// The methods of this class are thread safe.
+class FindResultCache : boost::noncopyable {
+public:
+    /// \brief A cached find result.
+    struct Result {
+        Result() :
+            code(ZoneFinder::SUCCESS), flags(ZoneFinder::RESULT_DEFAULT),
+            match_label_count(0)
+        {}
+        ZoneFinder::Result code;                ///< The result code
+        bundy::dns::ConstRRsetPtr rrset;        ///< The found RRset, if any
+        ZoneFinder::FindResultFlags flags;      ///< The result flags
+        uint8_t match_label_count;              ///< See ZoneFinder::Context
+        std::vector<bundy::dns::ConstRRsetPtr> all_set; ///< findAll() result
+    };
+
+    /// \brief Constructor
+    ///
+    /// \throw bundy::InvalidParameter max_entries is 0.
+    ///
+    /// \param max_entries Maximum number of results kept.
+    explicit FindResultCache(size_t max_entries);
+
+    /// \brief Record the serial of a zone seen by a finder.
+    ///
+    /// If it's not the last serial seen for the zone, the results for the
+    /// zone are dropped.
+    ///
+    /// \param zone_id The ID of the zone.
+    /// \param serial The serial of the SOA of the zone.
+    void setSerial(int zone_id, uint32_t serial);
+
+    /// \brief Drop all the results for a zone.
+    ///
+    /// This is called when the zone is known to have been updated.  The
+    /// cache is not used for the zone until a new serial is set.
+    ///
+    /// \param zone_id The ID of the zone.
+    void invalidate(int zone_id);
+
+    /// \brief Look a result up.
+    ///
+    /// \param zone_id The ID of the zone.
+    /// \param serial The serial of the zone seen by the caller.
+    /// \param name The name given to find().
+    /// \param type The type given to find(), or ANY for findAll().
+    /// \param options The options given to find().
+    /// \param result Set to the cached result if it is found.
+    ///
+    /// \return true if the result was found for the given serial.
+    bool find(int zone_id, uint32_t serial, const bundy::dns::Name& name,
+              const bundy::dns::RRType& type, ZoneFinder::FindOptions options,
+              Result& result);
+
+    /// \brief Store a result.
+    ///
+    /// The result is ignored if the serial is not the last one seen for the
+    /// zone.  Parameters are as for \c find().
+    void add(int zone_id, uint32_t serial, const bundy::dns::Name& name,
+             const bundy::dns::RRType& type, ZoneFinder::FindOptions options,
+             const Result& result);
+
+    /// \brief Return the number of results in the cache.
+    size_t getSize() const;
+
+private:
+    struct Key {
+        Key(int zone_id_param, const bundy::dns::Name& name_param,
+            const bundy::dns::RRType& type_param,
+            ZoneFinder::FindOptions options_param) :
+            zone_id(zone_id_param), name(name_param), type(type_param),
+            options(options_param)
+        {}
+        bool operator<(const Key& other) const;
+
+        int zone_id;
+        bundy::dns::Name name;
+        bundy::dns::RRType type;
+        ZoneFinder::FindOptions options;
+    };
+    typedef std::list<std::pair<Key, Result> > EntryList;
+    typedef std::map<Key, EntryList::iterator> EntryMap;
+
+    // Whether the given serial is the current one of the zone.  The mutex
+    // must be locked.
+    bool isCurrent(int zone_id, uint32_t serial) const;
+
+    // Drop the results for the zone.  The mutex must be locked.
+    void removeZone(int zone_id);
+
+    const size_t max_entries_;
+    EntryList entries_;         // Most recently used first
+    EntryMap index_;
+    std::map<int, uint32_t> serials_;
+    mutable bundy::util::thread::Mutex mutex_;
+};
+
+} // namespace datasrc
+} // namespace bundy
+
+#endif // DATASRC_DATABASE_CACHE_H
+
+// Local Variables:
+// mode: c++
+// End:
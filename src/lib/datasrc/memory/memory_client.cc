@@ -72,7 +72,8 @@ InMemoryClient::findZone(const bundy::dns::Name& zone_name) const {
 
     ZoneFinderPtr finder;
     if (result.code != result::NOTFOUND && result.zone_data) {
-        finder.reset(new InMemoryZoneFinder(*result.zone_data, getClass()));
+        finder.reset(new InMemoryZoneFinder(*result.zone_data, getClass(),
+                                            &nsec3_hash_cache_));
     }
 
     return (DataSourceClient::FindResult(result.code, finder,
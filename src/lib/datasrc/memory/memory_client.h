@@ -21,6 +21,7 @@
 #include <datasrc/client.h>
 #include <datasrc/memory/zone_table.h>
 #include <datasrc/memory/zone_data.h>
+#include <datasrc/memory/nsec3_hash_cache.h>
 
 #include <boost/shared_ptr.hpp>
 
@@ -118,6 +119,8 @@ public:
 private:
     boost::shared_ptr<ZoneTableSegment> ztable_segment_;
     const bundy::dns::RRClass rrclass_;
+    // Shared by the finders of all the zones; see InMemoryZoneFinder.
+    mutable NSEC3HashCache nsec3_hash_cache_;
 };
 
 } // namespace memory
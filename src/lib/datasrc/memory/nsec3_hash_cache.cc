@@ -0,0 +1,110 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <datasrc/memory/nsec3_hash_cache.h>
+#include <datasrc/memory/zone_data.h>
+
+#include <exceptions/exceptions.h>
+
+using namespace bundy::dns;
+using bundy::util::thread::Mutex;
+
+namespace bundy {
+namespace datasrc {
+namespace memory {
+
+namespace {
+
+// Build the key of a hash: the NSEC3 parameters followed by the wire
+// format of the name in lower case.
+std::string
+makeKey(const NSEC3Data& nsec3_data, const LabelSequence& name) {
+    size_t name_len;
+    const uint8_t* const name_data = name.getData(&name_len);
+    const size_t salt_len = nsec3_data.getSaltLen();
+
+    std::string key;
+    key.reserve(4 + salt_len + name_len);
+    key.push_back(nsec3_data.hashalg);
+    key.push_back(nsec3_data.iterations >> 8);
+    key.push_back(nsec3_data.iterations & 0xff);
+    key.push_back(salt_len);
+    key.append(reinterpret_cast<const char*>(nsec3_data.getSaltData()),
+               salt_len);
+    // The label length octets are at most 63, so they are never changed
+    // by lowering upper case letters.
+    for (size_t i = 0; i < name_len; ++i) {
+        const uint8_t c = name_data[i];
+        key.push_back((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+    }
+    return (key);
+}
+
+}
+
+// Definition of class static constant so it can be referenced by address
+// or reference.
+const size_t NSEC3HashCache::DEFAULT_MAX_ENTRIES;
+
+NSEC3HashCache::NSEC3HashCache(size_t max_entries) :
+    max_entries_(max_entries)
+{
+    if (max_entries_ == 0) {
+        bundy_throw(bundy::InvalidParameter,
+                    "Size of the NSEC3 hash cache must be greater than zero");
+    }
+}
+
+bool
+NSEC3HashCache::find(const NSEC3Data& nsec3_data, const LabelSequence& name,
+                     std::string& hash)
+{
+    const std::string key = makeKey(nsec3_data, name);
+    Mutex::Locker locker(mutex_);
+    const EntryMap::iterator found = index_.find(key);
+    if (found == index_.end()) {
+        return (false);
+    }
+    // Move it to the front of the list, keeping the iterator valid.
+    entries_.splice(entries_.begin(), entries_, found->second);
+    hash = found->second->second;
+    return (true);
+}
+
+void
+NSEC3HashCache::add(const NSEC3Data& nsec3_data, const LabelSequence& name,
+                    const std::string& hash)
+{
+    const std::string key = makeKey(nsec3_data, name);
+    Mutex::Locker locker(mutex_);
+    if (index_.count(key) > 0) {
+        return;
+    }
+    if (entries_.size() >= max_entries_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    entries_.push_front(std::make_pair(key, hash));
+    index_[key] = entries_.begin();
+}
+
+size_t
+NSEC3HashCache::getSize() const {
+    Mutex::Locker locker(mutex_);
+    return (entries_.size());
+}
+
+} // namespace memory
+} // namespace datasrc
+} // namespace bundy
@@ -0,0 +1,103 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef DATASRC_MEMORY_NSEC3_HASH_CACHE_H
+#define DATASRC_MEMORY_NSEC3_HASH_CACHE_H 1
+
+#include <dns/labelsequence.h>
+
+#include <util/threads/sync.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <list>
+#include <map>
+#include <string>
+
+namespace bundy {
+namespace datasrc {
+namespace memory {
+class NSEC3Data;
+
+/// \brief Cache of NSEC3 hashes of names.
+///
+/// Calculating the NSEC3 hash of a name takes (iterations + 1) rounds of
+/// SHA-1, and an NSEC3 proof needs the hashes of several names: the query
+/// name and its ancestors up to the closest encloser.  The names closer to
+/// the zone origin are the same for most queries, so \c InMemoryZoneFinder
+/// keeps the hashes it calculates in an object of this class and looks them
+/// up before calculating them again.
+///
+/// A hash only depends on the name and the NSEC3 parameters of the zone
+/// (algorithm, iterations and salt), which are part of the key.  So the
+/// cached hashes never become stale, even if the zone is reloaded or its
+/// parameters change, and a cache can be shared by the zones of a client.
+/// Names are compared case-insensitively, like in the hash calculation.
+///
+/// The number of cached hashes is bounded; the least recently used ones
+/// are dropped first.
+///
+/// The methods of this class are thread safe.
+class NSEC3HashCache : boost::noncopyable {
+public:
+    /// \brief The default maximum number of hashes kept.
+    static const size_t DEFAULT_MAX_ENTRIES = 10000;
+
+    /// \brief Constructor
+    ///
+    /// \throw bundy::InvalidParameter max_entries is 0.
+    ///
+    /// \param max_entries Maximum number of hashes kept.
+    explicit NSEC3HashCache(size_t max_entries = DEFAULT_MAX_ENTRIES);
+
+    /// \brief Look a hash up.
+    ///
+    /// \param nsec3_data The NSEC3 parameters of the zone.
+    /// \param name The (absolute) name to hash.
+    /// \param hash Set to the cached hash (in the base32hex textual form
+    /// returned by \c NSEC3Hash::calculate()) if it is found.
+    ///
+    /// \return true if the hash was found.
+    bool find(const NSEC3Data& nsec3_data,
+              const bundy::dns::LabelSequence& name, std::string& hash);
+
+    /// \brief Store a hash.
+    ///
+    /// Parameters are as for \c find().  If the cache is full, the least
+    /// recently used hash is dropped.
+    void add(const NSEC3Data& nsec3_data,
+             const bundy::dns::LabelSequence& name, const std::string& hash);
+
+    /// \brief Return the number of hashes in the cache.
+    size_t getSize() const;
+
+private:
+    typedef std::list<std::pair<std::string, std::string> > EntryList;
+    typedef std::map<std::string, EntryList::iterator> EntryMap;
+
+    const size_t max_entries_;
+    EntryList entries_;         // Most recently used first
+    EntryMap index_;
+    mutable bundy::util::thread::Mutex mutex_;
+};
+
+} // namespace memory
+} // namespace datasrc
+} // namespace bundy
+
+#endif // DATASRC_MEMORY_NSEC3_HASH_CACHE_H
+
+// Local Variables:
+// mode: c++
+// End:
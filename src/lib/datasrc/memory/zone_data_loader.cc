@@ -34,7 +34,10 @@
 #include <boost/optional.hpp>
 #include <boost/noncopyable.hpp>
 
+#include <algorithm>
 #include <map>
+#include <string>
+#include <vector>
 
 using namespace bundy::dns;
 using namespace bundy::dns::rdata;
@@ -276,7 +279,7 @@ public:
                        const dns::RRClass& rrclass,
                        const dns::Name& zone_name,
                        ZoneData* old_data, const dns::Serial* old_serial) :
-        mem_sgmt_(mem_sgmt), rrclass_(rrclass), zone_name_(zone_name),
+        mem_sgmt_(&mem_sgmt), rrclass_(rrclass), zone_name_(zone_name),
         old_data_(old_data),
         old_serial_(old_serial ? new dns::Serial(*old_serial) : NULL),
         loaded_data_(NULL)
@@ -303,6 +306,15 @@ public:
         return (loaded_data_);
     }
 
+    void setMemorySegment(util::MemorySegment& mem_sgmt) {
+        if (data_holder_) {
+            bundy_throw(bundy::InvalidOperation,
+                        "memory segment of zone data loader changed after "
+                        "the load started");
+        }
+        mem_sgmt_ = &mem_sgmt;
+    }
+
 protected:
     bool doLoadCommon(size_t count_limit);
 
@@ -314,11 +326,11 @@ protected:
             try {
                 boost::scoped_ptr<SegmentObjectHolder<ZoneData, RRClass> >
                     holder(new SegmentObjectHolder<ZoneData, RRClass>
-                           (mem_sgmt_, rrclass_));
+                           (*mem_sgmt_, rrclass_));
                 if (zone_data) {
                     holder->set(zone_data);
                 } else {
-                    holder->set(ZoneData::create(mem_sgmt_, zone_name_));
+                    holder->set(ZoneData::create(*mem_sgmt_, zone_name_));
                 }
                 data_holder_.swap(holder);
                 break;
@@ -332,7 +344,7 @@ protected:
                 }
             }
         }
-        update_helper_.reset(new ZoneDataUpdaterHelper(mem_sgmt_, rrclass_,
+        update_helper_.reset(new ZoneDataUpdaterHelper(*mem_sgmt_, rrclass_,
                                                        zone_name_,
                                                        *data_holder_->get()));
     }
@@ -342,7 +354,7 @@ protected:
     virtual bool updateRRsets(size_t count_limit) = 0;
 
 protected:
-    util::MemorySegment& mem_sgmt_;
+    util::MemorySegment* mem_sgmt_;
     const dns::RRClass rrclass_;
     const dns::Name zone_name_;
     ZoneData* const old_data_;
@@ -368,7 +380,7 @@ ZoneDataLoader::ZoneDataLoaderImpl::finishUpdate() {
             LOG_INFO(logger, DATASRC_MEMORY_MEM_NSEC3_UNSIGNED).arg(zone_name_).
                 arg(rrclass_);
             NSEC3Data* old_n3data = loaded_data->setNSEC3Data(NULL);
-            NSEC3Data::destroy(mem_sgmt_, old_n3data, rrclass_);
+            NSEC3Data::destroy(*mem_sgmt_, old_n3data, rrclass_);
         } else {
             LOG_WARN(logger, DATASRC_MEMORY_MEM_NO_NSEC3PARAM).arg(zone_name_).
                 arg(rrclass_);
@@ -549,6 +561,14 @@ protected:
 // modifies the existing zone data, rather than creating a new one and replace
 // it with the old on completion.  So any intermediate failure will invalidate
 // the zone data.
+//
+// The whole diff sequence is read from the journal in the load() phase,
+// honoring the count limit, so commitDiffs(), which is normally called in a
+// critical section, doesn't have to access the data source.  The sequence is
+// also reduced to its net change on the way: an RR deleted and then added
+// back (or added and then deleted) in the sequence, which is very common for
+// NS or DNSKEY RRs when the journal spans several versions, cancels out and
+// is never applied, so only the nodes that really change are touched.
 class JournalLoader : public ZoneDataLoader::ZoneDataLoaderImpl {
 public:
     JournalLoader(util::MemorySegment& mem_sgmt,
@@ -559,7 +579,7 @@ public:
                   const std::string& dsrc_name) :
         ZoneDataLoader::ZoneDataLoaderImpl(mem_sgmt, rrclass, zone_name,
                                            old_data, &old_serial),
-        jnl_reader_(jnl_reader)
+        jnl_reader_(jnl_reader), mode_(INIT)
     {
         LOG_DEBUG(logger, DBG_TRACE_BASIC, DATASRC_MEMORY_LOAD_USE_JOURNAL).
             arg(zone_name_).arg(rrclass_).arg(old_serial.getValue()).
@@ -567,10 +587,19 @@ public:
     }
     virtual ~JournalLoader() {}
     virtual bool isDataReused() const { return (true); }
-    virtual bool doLoad(size_t) {
-        saveDiffs();
-        loaded_data_ = old_data_;
-        return (true);
+    virtual bool doLoad(size_t count_limit) {
+        size_t count = 0;
+        while (count_limit == 0 || count < count_limit) {
+            const ConstRRsetPtr rrset = jnl_reader_->getNextDiff();
+            if (!rrset) {
+                finishDiffs();
+                loaded_data_ = old_data_;
+                return (true);
+            }
+            addDiff(rrset);
+            ++count;
+        }
+        return (false);
     }
     virtual ZoneData* commitDiffs(ZoneData* update_data) {
         // Constructing SegmentObjectHolder can result in MemorySegmentGrown.
@@ -592,83 +621,146 @@ public:
 
 protected:
     // The installer called for ZoneDataLoader using a zone journal reader.
-    // It performs some minimal sanity checks on the sequence of data, but
-    // the basic assumption is that any invalid data mean implementation defect
-    // (not bad user input) and shouldn't happen anyway.
+    // All deletions are applied before additions; as the changes don't
+    // overlap, the result is the same as applying the original sequence.
     virtual bool updateRRsets(size_t) {
-        enum DIFF_MODE {INIT, ADD, DELETE} mode = INIT;
-        ConstRRsetPtr rrset;
-        std::vector<ConstRRsetPtr>::const_iterator it = saved_diffs_.begin();
-        const std::vector<ConstRRsetPtr>::const_iterator it_end =
-            saved_diffs_.end();
-        while ((rrset = nextDiff(it, it_end))) {
-            if (rrset->getType() == RRType::SOA()) {
-                mode = (mode == INIT || mode == ADD) ? DELETE : ADD;
-            } else if (mode == INIT) {
-                // diff sequence doesn't begin with SOA. It means broken journal
-                // reader implementation.
-                bundy_throw(bundy::Unexpected,
-                            "broken journal reader: diff not begin with SOA");
+        applyChanges(ZoneDataUpdaterHelper::DELETE);
+        applyChanges(ZoneDataUpdaterHelper::ADD);
+        return (true);
+    }
+
+private:
+    // The number of times an RR is added by the diff sequence (negative if
+    // it's deleted).  Normally it's -1, 0 or 1; other values mean a broken
+    // sequence, and we apply it as is to let the updater detect it.
+    struct RRChange {
+        RRChange() : count(0) {}
+        ConstRRsetPtr rr;       // RRset containing the single RR
+        int count;
+    };
+    // Indexed by the textual representation of the RR.
+    typedef std::map<std::string, RRChange> RRChanges;
+
+    // Record one diff of the sequence.  It performs some minimal sanity
+    // checks on the sequence, but the basic assumption is that any invalid
+    // data mean implementation defect (not bad user input) and shouldn't
+    // happen anyway.
+    void addDiff(const ConstRRsetPtr& rrset) {
+        if (rrset->getType() == RRType::SOA()) {
+            mode_ = (mode_ == INIT || mode_ == ADD) ? DELETE : ADD;
+        } else if (mode_ == INIT) {
+            // diff sequence doesn't begin with SOA. It means broken journal
+            // reader implementation.
+            bundy_throw(bundy::Unexpected,
+                        "broken journal reader: diff not begin with SOA");
+        }
+        addChange(rrset, (mode_ == ADD) ? 1 : -1);
+    }
+
+    void addChange(const ConstRRsetPtr& rrset, int delta) {
+        RdataIteratorPtr rit = rrset->getRdataIterator();
+        if (rit->isLast()) {
+            bundy_throw(bundy::Unexpected,
+                        "broken journal reader: empty RRset for "
+                        << rrset->getName() << "/" << rrset->getType());
+        }
+        for (; !rit->isLast(); rit->next()) {
+            const RRsetPtr rr(new RRset(rrset->getName(), rrset->getClass(),
+                                        rrset->getType(), rrset->getTTL()));
+            rr->addRdata(rit->getCurrent());
+            RRChange& change = changes_[rr->toText()];
+            if (!change.rr) {
+                change.rr = rr;
             }
-            update_helper_->updateFromLoad(rrset,
-                                           (mode == ADD) ?
-                                           ZoneDataUpdaterHelper::ADD :
-                                           ZoneDataUpdaterHelper::DELETE);
+            change.count += delta;
         }
-        if (mode != ADD) {
+        if (rrset->getRRsig()) {
+            addChange(rrset->getRRsig(), delta);
+        }
+    }
+
+    void finishDiffs() {
+        jnl_reader_.reset();
+        if (mode_ == INIT) {
+            // In our expected form of diff sequence, it shouldn't be empty,
+            // since there should be at least begin and end SOAs.
+            // Eliminating this case at this point makes the later
+            // processing easier.
+            bundy_throw(ZoneValidationError,
+                        "empty diff sequence is provided for load");
+        }
+        if (mode_ != ADD) {
             // Diff must end in the add mode (there should at least be one
             // add for the final SOA)
             bundy_throw(bundy::Unexpected, "broken journal reader: incomplete");
         }
-
-        return (true);
     }
 
-private:
-    void saveDiffs() {
-        int count = 0;
-        ConstRRsetPtr rrset;
-        while (count++ < MAX_SAVED_DIFFS_ &&
-               (rrset = jnl_reader_->getNextDiff())) {
-            saved_diffs_.push_back(rrset);
+    // Pass the changes of the given kind to the updater.  They are sorted
+    // by owner name and the RRs of the same RRset are merged, so each node
+    // and RdataSet is updated once.
+    void applyChanges(ZoneDataUpdaterHelper::OP_MODE mode) {
+        std::vector<ConstRRsetPtr> rrs;
+        BOOST_FOREACH(const RRChanges::value_type& val, changes_) {
+            const int count = (mode == ZoneDataUpdaterHelper::ADD) ?
+                val.second.count : -val.second.count;
+            for (int i = 0; i < count; ++i) {
+                rrs.push_back(val.second.rr);
+            }
         }
-        if (!rrset) {
-            jnl_reader_.reset();
-            if (saved_diffs_.empty()) {
-                // In our expected form of diff sequence, it shouldn't be empty,
-                // since there should be at least begin and end SOAs.
-                // Eliminating this case at this point makes the later
-                // processing easier.
-                bundy_throw(ZoneValidationError,
-                            "empty diff sequence is provided for load");
+        std::stable_sort(rrs.begin(), rrs.end(), lessRRset);
+
+        RRsetPtr merged;
+        for (std::vector<ConstRRsetPtr>::const_iterator it = rrs.begin();
+             it != rrs.end(); ++it) {
+            if (merged && it != rrs.begin() && *it != *(it - 1) &&
+                canMerge(*merged, *it)) {
+                merged->addRdata((*it)->getRdataIterator()->getCurrent());
+                continue;
             }
+            if (merged) {
+                update_helper_->updateFromLoad(merged, mode);
+            }
+            merged.reset(new RRset((*it)->getName(), (*it)->getClass(),
+                                   (*it)->getType(), (*it)->getTTL()));
+            merged->addRdata((*it)->getRdataIterator()->getCurrent());
+        }
+        if (merged) {
+            update_helper_->updateFromLoad(merged, mode);
         }
     }
 
-    ConstRRsetPtr
-    nextDiff(std::vector<ConstRRsetPtr>::const_iterator& it,
-             const std::vector<ConstRRsetPtr>::const_iterator& it_end)
+    static bool lessRRset(const ConstRRsetPtr& rrset1,
+                          const ConstRRsetPtr& rrset2)
     {
-        ConstRRsetPtr next_diff;    // null by default
-        if (it != it_end) {
-            next_diff = *it;
-            ++it;
-        } else if (jnl_reader_) {
-            next_diff = jnl_reader_->getNextDiff();
+        const int order = rrset1->getName().compare(rrset2->getName()).
+            getOrder();
+        if (order != 0) {
+            return (order < 0);
         }
-        return (next_diff);
+        return (rrset1->getType() < rrset2->getType());
     }
 
-    ZoneJournalReaderPtr jnl_reader_;
+    static bool canMerge(const AbstractRRset& merged,
+                         const ConstRRsetPtr& rr)
+    {
+        if (merged.getName() != rr->getName() ||
+            merged.getType() != rr->getType() ||
+            merged.getTTL() != rr->getTTL()) {
+            return (false);
+        }
+        // RRSIGs are paired with the RRsets by their covered type.
+        if (rr->getType() == RRType::RRSIG()) {
+            RdataIteratorPtr rit = merged.getRdataIterator();
+            return (dynamic_cast<const generic::RRSIG&>(rit->getCurrent()).
+                    typeCovered() == getCoveredType(rr));
+        }
+        return (true);
+    }
 
-    // To minimize the risk of hitting an exception from the journal reader
-    // in commitDiffs(), we save up to MAX_SAVED_DIFFS_ diff RRs in the
-    // load() phase.  While it doesn't guarantee a success in commitDiffs()
-    // (if it fails we fall back to invalidate the zone and reload the entire
-    // zone), this should work for many cases with small updates (like in
-    // dynamic updates).
-    static const unsigned int MAX_SAVED_DIFFS_ = 100;
-    std::vector<ConstRRsetPtr> saved_diffs_;
+    ZoneJournalReaderPtr jnl_reader_;
+    enum DIFF_MODE {INIT, ADD, DELETE} mode_;
+    RRChanges changes_;
 };
 }
 
@@ -768,6 +860,11 @@ ZoneDataLoader::getLoadedData() const {
     return (impl_->getLoadedData());
 }
 
+void
+ZoneDataLoader::setMemorySegment(util::MemorySegment& mem_sgmt) {
+    impl_->setMemorySegment(mem_sgmt);
+}
+
 ZoneData*
 ZoneDataLoader::commit(ZoneData* update_data) {
     return (impl_->commitDiffs(update_data));
@@ -140,6 +140,18 @@ public:
     /// \return A pointer to the loaded ZoneData.
     virtual ZoneData* getLoadedData() const;
 
+    /// \brief Change the memory segment to store the zone data in.
+    ///
+    /// This replaces the segment passed on construction.  It's useful when
+    /// the segment can only be chosen after seeing \c isDataReused():
+    /// updates to the reused data must be stored in the segment of that
+    /// data.  It must be called before the load is started.
+    ///
+    /// \throw bundy::InvalidOperation The load has already been started.
+    ///
+    /// \param mem_sgmt The memory segment.
+    virtual void setMemorySegment(util::MemorySegment& mem_sgmt);
+
     /// \brief Complete any remaining loading task that deferred in load().
     ///
     /// Specifically, if load() found diffs of zone data to be applied later,
@@ -972,11 +972,8 @@ InMemoryZoneFinder::findNSEC3(const bundy::dns::Name& name, bool recursive) {
                   origin_ls << "/" << getClass());
     }
 
-    const boost::scoped_ptr<NSEC3Hash> hash
-        (NSEC3Hash::create(nsec3_data->hashalg,
-                           nsec3_data->iterations,
-                           nsec3_data->getSaltData(),
-                           nsec3_data->getSaltLen()));
+    // The hash calculator is only created when a hash isn't in the cache.
+    boost::scoped_ptr<NSEC3Hash> hash;
 
     // Examine all names from the query name to the origin name, stripping
     // the deepest label one by one, until we find a name that has a matching
@@ -984,7 +981,20 @@ InMemoryZoneFinder::findNSEC3(const bundy::dns::Name& name, bool recursive) {
     for (unsigned int labels = qlabels; labels >= olabels;
          --labels, name_ls.stripLeft(1))
     {
-        const std::string hlabel = hash->calculate(name_ls);
+        std::string hlabel;
+        if (nsec3_hash_cache_ == NULL ||
+            !nsec3_hash_cache_->find(*nsec3_data, name_ls, hlabel)) {
+            if (!hash) {
+                hash.reset(NSEC3Hash::create(nsec3_data->hashalg,
+                                             nsec3_data->iterations,
+                                             nsec3_data->getSaltData(),
+                                             nsec3_data->getSaltLen()));
+            }
+            hlabel = hash->calculate(name_ls);
+            if (nsec3_hash_cache_ != NULL) {
+                nsec3_hash_cache_->add(*nsec3_data, name_ls, hlabel);
+            }
+        }
 
         LOG_DEBUG(logger, DBG_TRACE_BASIC, DATASRC_MEMORY_FINDNSEC3_TRYHASH).
             arg(name).arg(labels).arg(hlabel);
@@ -17,6 +17,7 @@
 
 #include <datasrc/memory/zone_data.h>
 #include <datasrc/memory/treenode_rrset.h>
+#include <datasrc/memory/nsec3_hash_cache.h>
 
 #include <datasrc/zone_finder.h>
 #include <dns/name.h>
@@ -46,12 +47,21 @@ public:
     /// by some construction to pull TreeNodeRRsets from a pool, but
     /// currently, these are created dynamically with the given RRclass
     ///
+    /// If \c nsec3_hash_cache is non NULL, \c findNSEC3() looks the NSEC3
+    /// hashes up in it before calculating them, and stores the calculated
+    /// ones there.  It's normally owned by the data source client, so the
+    /// hashes are shared by all the finders of its zones.
+    ///
     /// \param zone_data The ZoneData containing the zone.
     /// \param rrclass The RR class of the zone
+    /// \param nsec3_hash_cache The cache of NSEC3 hashes, or NULL.  It must
+    /// be valid as long as the finder is used.
     InMemoryZoneFinder(const ZoneData& zone_data,
-                       const bundy::dns::RRClass& rrclass) :
+                       const bundy::dns::RRClass& rrclass,
+                       NSEC3HashCache* nsec3_hash_cache = NULL) :
         zone_data_(zone_data),
-        rrclass_(rrclass)
+        rrclass_(rrclass),
+        nsec3_hash_cache_(nsec3_hash_cache)
     {}
 
     /// \brief Find an RRset in the datasource
@@ -111,6 +121,7 @@ private:
 
     const ZoneData& zone_data_;
     const bundy::dns::RRClass rrclass_;
+    NSEC3HashCache* const nsec3_hash_cache_;
 };
 
 } // namespace memory
@@ -20,6 +20,7 @@
 #include <datasrc/memory/zone_table_segment_mapped.h>
 #endif
 #include <datasrc/memory/zone_writer.h>
+#include <datasrc/memory/zone_data.h>
 
 #include <string>
 
@@ -50,6 +51,32 @@ ZoneTableSegment::destroy(ZoneTableSegment *segment) {
     delete segment;
 }
 
+bundy::util::MemorySegment&
+ZoneTableSegment::createZoneSegment(const Name&) {
+    return (getMemorySegment());
+}
+
+bundy::util::MemorySegment&
+ZoneTableSegment::getZoneSegment(const Name&, const ZoneData*) {
+    return (getMemorySegment());
+}
+
+bool
+ZoneTableSegment::isZoneSegmentReusable(const Name&, const ZoneData*) {
+    return (true);
+}
+
+void
+ZoneTableSegment::destroyZoneSegment(const Name&,
+                                     bundy::util::MemorySegment& zone_sgmt,
+                                     ZoneData* zone_data,
+                                     const RRClass& rrclass)
+{
+    if (zone_data) {
+        ZoneData::destroy(zone_sgmt, zone_data, rrclass);
+    }
+}
+
 } // namespace memory
 } // namespace datasrc
 } // namespace bundy
@@ -162,6 +162,61 @@ public:
     /// \c reset() successfully first.
     virtual bundy::util::MemorySegment& getMemorySegment() = 0;
 
+    /// \brief Return a memory segment to load a new version of a zone into.
+    ///
+    /// By default, the data of all zones are stored in the segment
+    /// returned by \c getMemorySegment(), and this method returns it.
+    /// A derived class may store each version of the data of some zones
+    /// in a separate segment, in which case it returns a new one.  Either
+    /// way, the returned segment must be passed to
+    /// \c destroyZoneSegment() when it's not needed any more (unless the
+    /// zone data stored in it are added to the zone table).
+    ///
+    /// \param zone_name The name of the zone to be loaded.
+    virtual bundy::util::MemorySegment& createZoneSegment(
+        const bundy::dns::Name& zone_name);
+
+    /// \brief Return the memory segment the given zone data are stored in.
+    ///
+    /// By default, it returns the segment returned by
+    /// \c getMemorySegment().
+    ///
+    /// \param zone_name The name of the zone.
+    /// \param zone_data The zone data in the zone table segment.
+    virtual bundy::util::MemorySegment& getZoneSegment(
+        const bundy::dns::Name& zone_name, const ZoneData* zone_data);
+
+    /// \brief Return whether updates to the given zone data can be stored
+    /// in the segment the data are stored in.
+    ///
+    /// If it returns \c false, the zone should be fully reloaded into a
+    /// new segment rather than updated in place, e.g., because too much
+    /// memory in the segment is wasted.  By default, it always returns
+    /// \c true.
+    ///
+    /// \param zone_name The name of the zone.
+    /// \param zone_data The zone data in the zone table segment.
+    virtual bool isZoneSegmentReusable(const bundy::dns::Name& zone_name,
+                                       const ZoneData* zone_data);
+
+    /// \brief Destroy zone data with the segment storing them.
+    ///
+    /// \c zone_sgmt must be the segment that stores \c zone_data, returned
+    /// by \c createZoneSegment() or \c getZoneSegment().  If it's a
+    /// separate segment for the zone, the segment is destroyed as a whole
+    /// together with the data; otherwise, only the data are destroyed.
+    /// \c zone_data can be NULL, in which case only a segment created by
+    /// \c createZoneSegment() is destroyed (if it's a separate one).
+    ///
+    /// \param zone_name The name of the zone.
+    /// \param zone_sgmt The memory segment storing the zone data.
+    /// \param zone_data The zone data to destroy, or NULL.
+    /// \param rrclass The RR class of the zone.
+    virtual void destroyZoneSegment(const bundy::dns::Name& zone_name,
+                                    bundy::util::MemorySegment& zone_sgmt,
+                                    ZoneData* zone_data,
+                                    const bundy::dns::RRClass& rrclass);
+
     /// \brief Return true if the segment is writable.
     ///
     /// The user of the zone table segment will load or update zones
@@ -13,6 +13,7 @@
 // PERFORMANCE OF THIS SOFTWARE.
 
 #include <datasrc/memory/zone_table_segment_local.h>
+#include <datasrc/memory/zone_data.h>
 
 using namespace bundy::dns;
 using namespace bundy::util;
@@ -34,7 +35,22 @@ ZoneTableSegmentLocal::~ZoneTableSegmentLocal() {
     // it's probably better to find more leaks initially.  Once it's stabilized
     // we should probably revisit it.
 
-    ZoneTable::destroy(mem_sgmt_, header_.getTable());
+    // The zone data in arenas must not be destroyed with the table, so
+    // they are replaced with empty zones first, and freed with the arenas.
+    ZoneTable* const table = header_.getTable();
+    for (ZoneArenaMap::const_iterator it = zone_arenas_.begin();
+         it != zone_arenas_.end();
+         ++it) {
+        const ZoneTable::MutableFindResult result =
+            table->findZone(it->first);
+        if (result.code == result::SUCCESS &&
+            findArena(it->first, result.zone_data)) {
+            table->addEmptyZone(mem_sgmt_, it->first);
+        }
+    }
+    zone_arenas_.clear();
+
+    ZoneTable::destroy(mem_sgmt_, table);
     assert(mem_sgmt_.allMemoryDeallocated());
 }
 
@@ -60,6 +76,90 @@ ZoneTableSegmentLocal::clear()
               "should not be used.");
 }
 
+void
+ZoneTableSegmentLocal::useArena(const Name& zone_name, size_t chunk_size) {
+    if (chunk_size == 0) {
+        arena_chunk_sizes_.erase(zone_name);
+    } else {
+        arena_chunk_sizes_[zone_name] = chunk_size;
+    }
+}
+
+MemorySegment&
+ZoneTableSegmentLocal::createZoneSegment(const Name& zone_name) {
+    const std::map<Name, size_t>::const_iterator found =
+        arena_chunk_sizes_.find(zone_name);
+    if (found == arena_chunk_sizes_.end()) {
+        return (mem_sgmt_);
+    }
+    const boost::shared_ptr<MemorySegmentArena> arena(
+        new MemorySegmentArena(found->second));
+    zone_arenas_[zone_name].push_back(arena);
+    return (*arena);
+}
+
+MemorySegmentArena*
+ZoneTableSegmentLocal::findArena(const Name& zone_name,
+                                 const ZoneData* zone_data)
+{
+    const ZoneArenaMap::const_iterator found = zone_arenas_.find(zone_name);
+    if (found == zone_arenas_.end()) {
+        return (NULL);
+    }
+    for (ZoneArenas::const_iterator it = found->second.begin();
+         it != found->second.end();
+         ++it) {
+        if ((*it)->contains(zone_data)) {
+            return (it->get());
+        }
+    }
+    return (NULL);
+}
+
+MemorySegment&
+ZoneTableSegmentLocal::getZoneSegment(const Name& zone_name,
+                                      const ZoneData* zone_data)
+{
+    MemorySegmentArena* const arena = findArena(zone_name, zone_data);
+    if (arena) {
+        return (*arena);
+    }
+    return (mem_sgmt_);
+}
+
+bool
+ZoneTableSegmentLocal::isZoneSegmentReusable(const Name& zone_name,
+                                             const ZoneData* zone_data)
+{
+    const MemorySegmentArena* const arena = findArena(zone_name, zone_data);
+    return (!arena || arena->getWastedSize() <= arena->getAllocatedSize());
+}
+
+void
+ZoneTableSegmentLocal::destroyZoneSegment(const Name& zone_name,
+                                          MemorySegment& zone_sgmt,
+                                          ZoneData* zone_data,
+                                          const RRClass& rrclass)
+{
+    const ZoneArenaMap::iterator found = zone_arenas_.find(zone_name);
+    if (found != zone_arenas_.end()) {
+        ZoneArenas& arenas = found->second;
+        for (ZoneArenas::iterator it = arenas.begin(); it != arenas.end();
+             ++it) {
+            if (it->get() == &zone_sgmt) {
+                // The zone data go away with the whole arena.
+                arenas.erase(it);
+                if (arenas.empty()) {
+                    zone_arenas_.erase(found);
+                }
+                return;
+            }
+        }
+    }
+    ZoneTableSegment::destroyZoneSegment(zone_name, zone_sgmt, zone_data,
+                                         rrclass);
+}
+
 // After more methods' definitions are added here, it would be a good
 // idea to move getHeader() and getMemorySegment() definitions to the
 // header file.
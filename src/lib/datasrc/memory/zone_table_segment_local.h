@@ -17,8 +17,15 @@
 
 #include <datasrc/memory/zone_table_segment.h>
 #include <util/memory_segment_local.h>
+#include <util/memory_segment_arena.h>
 
+#include <dns/name.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <map>
 #include <string>
+#include <vector>
 
 namespace bundy {
 namespace datasrc {
@@ -29,6 +36,9 @@ namespace memory {
 /// This class specifies a concrete implementation for a
 /// \c MemorySegmentLocal -based \c ZoneTableSegment. Please see the
 /// \c ZoneTableSegment class documentation for usage.
+///
+/// The data of selected zones can be stored in arenas instead (see
+/// \c useArena()).
 class ZoneTableSegmentLocal : public ZoneTableSegment {
     // This is so that \c ZoneTableSegmentLocal can be instantiated from
     // \c ZoneTableSegment::create().
@@ -60,6 +70,47 @@ public:
     /// segment implementation (a \c MemorySegmentLocal instance).
     virtual bundy::util::MemorySegment& getMemorySegment();
 
+    /// \brief Store the data of the given zone in arenas.
+    ///
+    /// Each version of the zone data loaded after this call is stored in
+    /// its own \c MemorySegmentArena, which makes loading faster and
+    /// frees the version at once when it's replaced.  Updates applied to
+    /// the zone data in place are stored in the arena of the current
+    /// version.  The effect of \c deallocate() on arenas is limited, so
+    /// such updates waste memory; once more than half of the used part of
+    /// the arena is wasted, \c isZoneSegmentReusable() returns \c false
+    /// so that the zone is fully reloaded into a new arena.
+    ///
+    /// \param zone_name The name of the zone.
+    /// \param chunk_size The chunk size of the arenas (see
+    /// \c MemorySegmentArena); 0 means that the data of the zone will be
+    /// stored in the common local segment again.
+    void useArena(const bundy::dns::Name& zone_name,
+                  size_t chunk_size =
+                  bundy::util::MemorySegmentArena::DEFAULT_CHUNK_SIZE);
+
+    /// \brief Return a new arena for zones set by \c useArena();
+    /// otherwise the common local segment.
+    virtual bundy::util::MemorySegment& createZoneSegment(
+        const bundy::dns::Name& zone_name);
+
+    /// \brief Return the arena storing the zone data if there's one;
+    /// otherwise the common local segment.
+    virtual bundy::util::MemorySegment& getZoneSegment(
+        const bundy::dns::Name& zone_name, const ZoneData* zone_data);
+
+    /// \brief Return \c false if the zone data are stored in an arena
+    /// more than half of whose used memory is wasted; otherwise \c true.
+    virtual bool isZoneSegmentReusable(const bundy::dns::Name& zone_name,
+                                       const ZoneData* zone_data);
+
+    /// \brief Free the arena if \c zone_sgmt is one; otherwise destroy
+    /// the zone data in the common local segment.
+    virtual void destroyZoneSegment(const bundy::dns::Name& zone_name,
+                                    bundy::util::MemorySegment& zone_sgmt,
+                                    ZoneData* zone_data,
+                                    const bundy::dns::RRClass& rrclass);
+
     /// \brief Return true if the segment is writable.
     ///
     /// Local segments are always writable. This implementation always
@@ -94,9 +145,21 @@ public:
     }
 
 private:
+    typedef std::vector<boost::shared_ptr<bundy::util::MemorySegmentArena> >
+    ZoneArenas;
+    typedef std::map<bundy::dns::Name, ZoneArenas> ZoneArenaMap;
+
+    bundy::util::MemorySegmentArena* findArena(
+        const bundy::dns::Name& zone_name, const ZoneData* zone_data);
+
     std::string impl_type_;
     bundy::util::MemorySegmentLocal mem_sgmt_;
     ZoneTableHeader header_;
+    // Chunk sizes of the arenas for the zones set by useArena().
+    std::map<bundy::dns::Name, size_t> arena_chunk_sizes_;
+    // The existing arenas of each zone (usually one, or two while a new
+    // version is loaded).
+    ZoneArenaMap zone_arenas_;
 };
 
 } // namespace memory
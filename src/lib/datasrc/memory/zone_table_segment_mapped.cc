@@ -152,7 +152,7 @@ ZoneTableSegmentMapped::processHeader(MemorySegmentMapped& segment,
 
 MemorySegmentMapped*
 ZoneTableSegmentMapped::openReadWrite(const std::string& filename,
-                                      bool create)
+                                      bool create, size_t reserved_size)
 {
     const MemorySegmentMapped::OpenMode mode = create ?
          MemorySegmentMapped::CREATE_ONLY :
@@ -160,7 +160,9 @@ ZoneTableSegmentMapped::openReadWrite(const std::string& filename,
     // In case there is a problem, we throw. We want the segment to be
     // automatically destroyed then.
     std::unique_ptr<MemorySegmentMapped> segment
-        (new MemorySegmentMapped(filename, mode));
+        (new MemorySegmentMapped(filename, mode,
+                                 MemorySegmentMapped::INITIAL_SIZE,
+                                 reserved_size));
 
     // This flag is used inside processCheckSum() and processHeader(),
     // and must be initialized before we make any further allocations.
@@ -284,6 +286,18 @@ ZoneTableSegmentMapped::reset(MemorySegmentOpenMode mode,
 
     const std::string filename = mapped_file->stringValue();
 
+    size_t reserved_size = 0;
+    if (params->contains("reserved-size")) {
+        ConstElementPtr reserved = params->get("reserved-size");
+        if (!reserved || reserved->getType() != Element::integer ||
+            reserved->intValue() < 0) {
+            bundy_throw(bundy::InvalidParameter,
+                        "Invalid value of \"reserved-size\": must be "
+                        "a non-negative integer");
+        }
+        reserved_size = reserved->intValue();
+    }
+
     if (mem_sgmt_ && (filename == current_filename_)) {
         // This reset() is an attempt to re-open the currently open
         // mapped file. We cannot do this in many mode combinations
@@ -302,11 +316,11 @@ ZoneTableSegmentMapped::reset(MemorySegmentOpenMode mode,
 
     switch (mode) {
     case CREATE:
-        segment.reset(openReadWrite(filename, true));
+        segment.reset(openReadWrite(filename, true, reserved_size));
         break;
 
     case READ_WRITE:
-        segment.reset(openReadWrite(filename, false));
+        segment.reset(openReadWrite(filename, false, reserved_size));
         break;
 
     case READ_ONLY:
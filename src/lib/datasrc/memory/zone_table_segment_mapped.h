@@ -92,6 +92,12 @@ public:
     /// and the zone table segment will become unusable.  In this case,
     /// \c mode will be ignored.
     ///
+    /// \c params can also contain a "reserved-size" key with a non-negative
+    /// integer value.  If it's larger than the mapped file, an address
+    /// range of that many bytes is reserved for the segment when it's
+    /// opened in a writable mode, so loading zones into it doesn't have to
+    /// be restarted each time the segment grows (see \c MemorySegmentMapped).
+    ///
     /// Please see the \c ZoneTableSegment API documentation for the
     /// behavior in case of exceptions.
     ///
@@ -125,7 +131,8 @@ private:
                        bool has_allocations, std::string& error_msg);
 
     bundy::util::MemorySegmentMapped* openReadWrite(const std::string& filename,
-                                                  bool create);
+                                                  bool create,
+                                                  size_t reserved_size);
     bundy::util::MemorySegmentMapped* openReadOnly(const std::string& filename);
 
     template<typename T> T* getHeaderHelper(bool initial) const;
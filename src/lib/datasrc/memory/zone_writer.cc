@@ -56,17 +56,15 @@ struct ZoneWriter::Impl {
         rrclass_(rrclass),
         state_(ZW_UNUSED),
         catch_load_error_(throw_on_load_error),
-        destroy_old_data_(true)
+        destroy_old_data_(true),
+        zone_sgmt_(&segment.createZoneSegment(origin)),
+        zone_sgmt_owned_(true)
     {
-        while (true) {
-            try {
-                data_holder_.reset(
-                    new ZoneDataHolder(segment.getMemorySegment(), rrclass_));
-                break;
-            } catch (const bundy::util::MemorySegmentGrown&) {}
-        }
+        resetDataHolder();
     }
 
+    void resetDataHolder();
+    void reuseZoneSegment(ZoneData* old_data);
     void installToTable();
     void installFailed(const std::exception* ex);
 
@@ -87,8 +85,40 @@ struct ZoneWriter::Impl {
     boost::scoped_ptr<ZoneDataHolder> data_holder_;
     boost::scoped_ptr<ZoneDataLoader> loader_;
     bool destroy_old_data_;
+    // The segment to store the zone data in (see
+    // ZoneTableSegment::createZoneSegment()), and whether we are
+    // responsible for destroying it.
+    bundy::util::MemorySegment* zone_sgmt_;
+    bool zone_sgmt_owned_;
 };
 
+void
+ZoneWriter::Impl::resetDataHolder() {
+    while (true) {
+        try {
+            data_holder_.reset(new ZoneDataHolder(*zone_sgmt_, rrclass_));
+            break;
+        } catch (const bundy::util::MemorySegmentGrown&) {}
+    }
+}
+
+// If the loader updates the old zone data in place, the updates have to be
+// stored in the segment of the old data.  If it's not the one we created for
+// the new data, we switch the loader (which hasn't started loading yet) to
+// that segment, and destroy ours.
+void
+ZoneWriter::Impl::reuseZoneSegment(ZoneData* old_data) {
+    bundy::util::MemorySegment& old_sgmt = segment_.getZoneSegment(origin_, old_data);
+    if (&old_sgmt != zone_sgmt_) {
+        loader_->setMemorySegment(old_sgmt);
+        bundy::util::MemorySegment& new_sgmt = *zone_sgmt_;
+        zone_sgmt_ = &old_sgmt;
+        resetDataHolder();
+        segment_.destroyZoneSegment(origin_, new_sgmt, NULL, rrclass_);
+    }
+    zone_sgmt_owned_ = false;
+}
+
 ZoneWriter::ZoneWriter(ZoneTableSegment& segment,
                        const ZoneDataLoaderCreator& loader_creator,
                        const dns::Name& origin,
@@ -130,11 +160,24 @@ ZoneWriter::load(size_t count_limit, std::string* error_msg) {
             ZoneTable* const table = getZoneTable(impl_->segment_);
             const ZoneTable::MutableFindResult ztresult =
                 table->findZone(impl_->origin_);
-            ZoneData* const old_data =
+            ZoneData* old_data =
                 (ztresult.code == result::SUCCESS) ? ztresult.zone_data : NULL;
-            impl_->loader_.reset(impl_->loader_creator_(
-                                     impl_->segment_.getMemorySegment(),
-                                     old_data));
+            // Updates to the old data would be stored in its segment; if
+            // that's not worth it any more, make the loader build the
+            // zone from scratch in the new segment.
+            if (old_data &&
+                !impl_->segment_.isZoneSegmentReusable(impl_->origin_,
+                                                       old_data)) {
+                LOG_DEBUG(logger, DBG_TRACE_BASIC,
+                          DATASRC_MEMORY_MEM_FULL_RELOAD).
+                    arg(impl_->origin_).arg(impl_->rrclass_);
+                old_data = NULL;
+            }
+            impl_->loader_.reset(impl_->loader_creator_(*impl_->zone_sgmt_,
+                                                        old_data));
+            if (old_data && impl_->loader_->isDataReused()) {
+                impl_->reuseZoneSegment(old_data);
+            }
             impl_->state_ = Impl::ZW_LOADING;
         }
         impl_->destroy_old_data_ = !impl_->loader_->isDataReused();
@@ -202,6 +245,10 @@ ZoneWriter::Impl::installToTable() {
                 table->addZone(segment_.getMemorySegment(),
                                origin_, data_holder_->get()) :
                 table->addEmptyZone(segment_.getMemorySegment(), origin_));
+            if (data_holder_->get()) {
+                // The zone table owns the segment of the new data now.
+                zone_sgmt_owned_ = false;
+            }
             if (destroy_old_data_) {
                 data_holder_->set(result.zone_data);
             } else {
@@ -261,10 +308,22 @@ ZoneWriter::cleanup() {
 
     ZoneData* zone_data = impl_->data_holder_->release();
     if (zone_data) {
-        ZoneData::destroy(impl_->segment_.getMemorySegment(), zone_data,
-                          impl_->rrclass_);
+        bundy::util::MemorySegment& zone_sgmt =
+            impl_->segment_.getZoneSegment(impl_->origin_, zone_data);
+        if (&zone_sgmt == impl_->zone_sgmt_) {
+            impl_->zone_sgmt_owned_ = false;
+        }
+        impl_->segment_.destroyZoneSegment(impl_->origin_, zone_sgmt,
+                                           zone_data, impl_->rrclass_);
         impl_->state_ = Impl::ZW_CLEANED;
     }
+    // Destroy the segment we created if the new data weren't installed.
+    if (impl_->zone_sgmt_owned_) {
+        impl_->zone_sgmt_owned_ = false;
+        impl_->segment_.destroyZoneSegment(impl_->origin_,
+                                           *impl_->zone_sgmt_, NULL,
+                                           impl_->rrclass_);
+    }
 }
 
 }
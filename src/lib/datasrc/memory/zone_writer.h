@@ -36,6 +36,11 @@ class ZoneTableSegment;
 /// in a different thread. The install() operation is the only one that needs
 /// to be done in a critical section.
 ///
+/// If the zone is already in memory and the data source has the journal
+/// from its serial to the new one, load() only reads the diffs, and
+/// install() applies their net change to the current zone data in place,
+/// without rebuilding the zone.
+///
 /// This class provides strong exception guarantee for each public
 /// method. That is, when any of the methods throws, the entire state
 /// stays the same as before the call.
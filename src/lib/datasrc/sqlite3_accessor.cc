@@ -21,6 +21,9 @@
 #include <exceptions/exceptions.h>
 
 #include <dns/name.h>
+#include <dns/rdata.h>
+#include <dns/rrclass.h>
+#include <dns/rrtype.h>
 
 #include <datasrc/sqlite3_accessor.h>
 #include <datasrc/sqlite3_datasrc_messages.h>
@@ -28,6 +31,7 @@
 #include <datasrc/exceptions.h>
 #include <datasrc/factory.h>
 #include <datasrc/database.h>
+#include <util/buffer.h>
 #include <util/filename.h>
 
 using namespace std;
@@ -45,7 +49,18 @@ namespace {
 // program may not be taking advantage of features (possibly performance
 // improvements) added to the database.
 const int SQLITE_SCHEMA_MAJOR_VERSION = 2;
-const int SQLITE_SCHEMA_MINOR_VERSION = 2;
+const int SQLITE_SCHEMA_MINOR_VERSION = 3;
+
+// The minor version from which the records and nsec3 tables have the
+// rdtype_code and rdata_wire columns, holding the RRType code and the wire
+// format of the RDATA next to their text.  Older databases keep working,
+// the RDATA is just parsed from the text.
+const int SQLITE_SCHEMA_WIRE_RDATA_MINOR_VERSION = 3;
+
+// Positions of the wire format columns in the SELECT statements returning
+// records, after the ones matching the RecordColumns enum.
+const int WIRE_TYPE_COLUMN = 5;
+const int WIRE_RDATA_COLUMN = 6;
 }
 
 namespace bundy {
@@ -86,15 +101,18 @@ enum StatementID {
 
 const char* const text_statements[NUM_STATEMENTS] = {
     // note for ANY and ITERATE: the order of the SELECT values is
-    // specifically chosen to match the enum values in RecordColumns
+    // specifically chosen to match the enum values in RecordColumns,
+    // followed by the wire format columns (WIRE_TYPE_COLUMN and
+    // WIRE_RDATA_COLUMN).  The NULL stands for the name, which isn't
+    // returned by name lookups.
     "SELECT id FROM zones WHERE name=?1 AND rdclass = ?2", // ZONE
-    "SELECT rdtype, ttl, sigtype, rdata FROM records "     // ANY
-        "WHERE zone_id=?1 AND name=?2",
+    "SELECT rdtype, ttl, sigtype, rdata, NULL, rdtype_code, rdata_wire "
+        "FROM records WHERE zone_id=?1 AND name=?2", // ANY
 
     // ANY_SUB:
     // This query returns records in the specified zone for the domain
     // matching the passed name, and its sub-domains.
-    "SELECT rdtype, ttl, sigtype, rdata "
+    "SELECT rdtype, ttl, sigtype, rdata, NULL, rdtype_code, rdata_wire "
         "FROM records WHERE zone_id=?1 AND rname LIKE ?2",
 
     "BEGIN",                    // BEGIN
@@ -102,8 +120,8 @@ const char* const text_statements[NUM_STATEMENTS] = {
     "ROLLBACK",                 // ROLLBACK
     "DELETE FROM records WHERE zone_id=?1", // DEL_ZONE_RECORDS
     "INSERT INTO records "      // ADD_RECORD
-        "(zone_id, name, rname, ttl, rdtype, sigtype, rdata) "
-        "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7)",
+        "(zone_id, name, rname, ttl, rdtype, sigtype, rdata, rdtype_code, "
+        "rdata_wire) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9)",
     // DEL_RECORD:
     // Delete based on the reverse name, as that one has an index.
     "DELETE FROM records WHERE zone_id=?1 AND rname=?2 " // DEL_RECORD
@@ -111,14 +129,14 @@ const char* const text_statements[NUM_STATEMENTS] = {
 
     // ITERATE_RECORDS:
     // The following iterates the whole zone in the records table.
-    "SELECT rdtype, ttl, sigtype, rdata, name FROM records "
-        "WHERE zone_id = ?1 ORDER BY rname, rdtype",
+    "SELECT rdtype, ttl, sigtype, rdata, name, rdtype_code, rdata_wire "
+        "FROM records WHERE zone_id = ?1 ORDER BY rname, rdtype",
 
     // ITERATE_NSEC3:
     // The following iterates the whole zone in the nsec3 table. As the
     // RRSIGs are for NSEC3s, we can hardcode the sigtype.
-    "SELECT rdtype, ttl, \"NSEC3\", rdata, owner FROM nsec3 "
-        "WHERE zone_id = ?1 ORDER BY hash, rdtype",
+    "SELECT rdtype, ttl, \"NSEC3\", rdata, owner, rdtype_code, rdata_wire "
+        "FROM nsec3 WHERE zone_id = ?1 ORDER BY hash, rdtype",
     /*
      * This one looks for previous name with NSEC record. It is done by
      * using the reversed name. The NSEC is checked because we need to
@@ -151,8 +169,8 @@ const char* const text_statements[NUM_STATEMENTS] = {
     // The "1" in SELECT is for positioning the rdata column to the
     // expected position, so we can reuse the same code as for other
     // lookups.
-    "SELECT rdtype, ttl, 1, rdata FROM nsec3 WHERE zone_id=?1 AND "
-        "hash=?2",
+    "SELECT rdtype, ttl, 1, rdata, NULL, rdtype_code, rdata_wire "
+        "FROM nsec3 WHERE zone_id=?1 AND hash=?2",
     // NSEC3_PREVIOUS: For getting the previous NSEC3 hash
     "SELECT DISTINCT hash FROM nsec3 WHERE zone_id=?1 AND hash < ?2 "
         "ORDER BY hash DESC LIMIT 1",
@@ -160,8 +178,8 @@ const char* const text_statements[NUM_STATEMENTS] = {
     "SELECT DISTINCT hash FROM nsec3 WHERE zone_id=?1 "
         "ORDER BY hash DESC LIMIT 1",
     // ADD_NSEC3_RECORD: Add NSEC3-related (NSEC3 or NSEC3-covering RRSIG) RR
-    "INSERT INTO nsec3 (zone_id, hash, owner, ttl, rdtype, rdata) "
-    "VALUES (?1, ?2, ?3, ?4, ?5, ?6)",
+    "INSERT INTO nsec3 (zone_id, hash, owner, ttl, rdtype, rdata, "
+    "rdtype_code, rdata_wire) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8)",
     // DEL_ZONE_NSEC3_RECORDS: delete all NSEC3-related records from the zone
     "DELETE FROM nsec3 WHERE zone_id=?1",
     // DEL_NSEC3_RECORD: delete specified NSEC3-related records
@@ -174,6 +192,35 @@ const char* const text_statements[NUM_STATEMENTS] = {
     "DELETE FROM zones WHERE id=?1" // DELETE_ZONE
 };
 
+// Versions of the statements using the wire format columns for databases
+// which don't have them (see SQLITE_SCHEMA_WIRE_RDATA_MINOR_VERSION).
+// The SELECT statements return NULL in their place, and the INSERT
+// statements store the text only.
+struct LegacyStatement {
+    StatementID id;
+    const char* text;
+};
+
+const LegacyStatement legacy_statements[] = {
+    { ANY, "SELECT rdtype, ttl, sigtype, rdata, NULL, NULL, NULL "
+        "FROM records WHERE zone_id=?1 AND name=?2" },
+    { ANY_SUB, "SELECT rdtype, ttl, sigtype, rdata, NULL, NULL, NULL "
+        "FROM records WHERE zone_id=?1 AND rname LIKE ?2" },
+    { ADD_RECORD, "INSERT INTO records "
+        "(zone_id, name, rname, ttl, rdtype, sigtype, rdata) "
+        "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7)" },
+    { ITERATE_RECORDS, "SELECT rdtype, ttl, sigtype, rdata, name, NULL, NULL "
+        "FROM records WHERE zone_id = ?1 ORDER BY rname, rdtype" },
+    { ITERATE_NSEC3, "SELECT rdtype, ttl, \"NSEC3\", rdata, owner, NULL, NULL "
+        "FROM nsec3 WHERE zone_id = ?1 ORDER BY hash, rdtype" },
+    { NSEC3, "SELECT rdtype, ttl, 1, rdata, NULL, NULL, NULL "
+        "FROM nsec3 WHERE zone_id=?1 AND hash=?2" },
+    { ADD_NSEC3_RECORD, "INSERT INTO nsec3 "
+        "(zone_id, hash, owner, ttl, rdtype, rdata) "
+        "VALUES (?1, ?2, ?3, ?4, ?5, ?6)" },
+    { NUM_STATEMENTS, NULL }
+};
+
 struct SQLite3Parameters {
     SQLite3Parameters() :
         db_(NULL), major_version_(-1), minor_version_(-1),
@@ -184,6 +231,28 @@ struct SQLite3Parameters {
         }
     }
 
+    // Whether the database stores the wire format of the RDATA.
+    bool
+    hasWireRdata() const {
+        return (major_version_ == SQLITE_SCHEMA_MAJOR_VERSION &&
+                minor_version_ >= SQLITE_SCHEMA_WIRE_RDATA_MINOR_VERSION);
+    }
+
+    // This method returns the text of the specified ID of SQLITE3 statement
+    // that fits the schema version of the database.
+    const char*
+    getStatementText(int id) const {
+        assert(id < NUM_STATEMENTS);
+        if (!hasWireRdata()) {
+            for (int i = 0; legacy_statements[i].text != NULL; ++i) {
+                if (legacy_statements[i].id == id) {
+                    return (legacy_statements[i].text);
+                }
+            }
+        }
+        return (text_statements[id]);
+    }
+
     // This method returns the specified ID of SQLITE3 statement.  If it's
     // not yet prepared it internally creates a new one.  This way we can
     // avoid preparing unnecessary statements and minimize the overhead.
@@ -193,11 +262,11 @@ struct SQLite3Parameters {
         if (statements_[id] == NULL) {
             assert(db_ != NULL);
             sqlite3_stmt* prepared = NULL;
-            if (sqlite3_prepare_v2(db_, text_statements[id], -1, &prepared,
+            const char* const text = getStatementText(id);
+            if (sqlite3_prepare_v2(db_, text, -1, &prepared,
                                    NULL) != SQLITE_OK) {
                 bundy_throw(SQLite3Error, "Could not prepare SQLite statement: "
-                          << text_statements[id] <<
-                          ": " << sqlite3_errmsg(db_));
+                          << text << ": " << sqlite3_errmsg(db_));
             }
             statements_[id] = prepared;
         }
@@ -282,6 +351,15 @@ public:
         }
     }
 
+    // The data is copied (SQLITE_TRANSIENT), as it may be a temporary.
+    void bindBlob(int index, const void* data, size_t length) {
+        if (sqlite3_bind_blob(stmt_, index, data, length, SQLITE_TRANSIENT)
+            != SQLITE_OK) {
+            bundy_throw(DataSourceError, "failed to bind SQLite3 parameter: " <<
+                      sqlite3_errmsg(dbparameters_.db_));
+        }
+    }
+
     void exec() {
         if (sqlite3_step(stmt_) != SQLITE_DONE) {
             sqlite3_reset(stmt_);
@@ -297,10 +375,11 @@ private:
 };
 
 SQLite3Accessor::SQLite3Accessor(const std::string& filename,
-                                 const string& rrclass) :
+                                 const string& rrclass, bool use_wal) :
     dbparameters_(new SQLite3Parameters),
     filename_(filename),
     class_(rrclass),
+    use_wal_(use_wal),
     database_name_("sqlite3_" +
                    bundy::util::Filename(filename).nameAndExtension())
 {
@@ -312,7 +391,15 @@ SQLite3Accessor::SQLite3Accessor(const std::string& filename,
 boost::shared_ptr<DatabaseAccessor>
 SQLite3Accessor::clone() {
     return (boost::shared_ptr<DatabaseAccessor>(new SQLite3Accessor(filename_,
-                                                                    class_)));
+                                                                    class_,
+                                                                    use_wal_)));
+}
+
+void
+SQLite3Accessor::prepareStatements() {
+    for (int i = 0; i < NUM_STATEMENTS; ++i) {
+        dbparameters_->getStatement(i);
+    }
 }
 
 namespace {
@@ -341,7 +428,7 @@ public:
 const char* const SCHEMA_LIST[] = {
     "CREATE TABLE schema_version (version INTEGER NOT NULL, "
         "minor INTEGER NOT NULL DEFAULT 0)",
-    "INSERT INTO schema_version VALUES (2, 2)",
+    "INSERT INTO schema_version VALUES (2, 3)",
     "CREATE TABLE zones (id INTEGER PRIMARY KEY, "
     "name TEXT NOT NULL COLLATE NOCASE, "
     "rdclass TEXT NOT NULL COLLATE NOCASE DEFAULT 'IN', "
@@ -351,7 +438,7 @@ const char* const SCHEMA_LIST[] = {
         "zone_id INTEGER NOT NULL, name TEXT NOT NULL COLLATE NOCASE, "
         "rname TEXT NOT NULL COLLATE NOCASE, ttl INTEGER NOT NULL, "
         "rdtype TEXT NOT NULL COLLATE NOCASE, sigtype TEXT COLLATE NOCASE, "
-        "rdata TEXT NOT NULL)",
+        "rdata TEXT NOT NULL, rdtype_code INTEGER, rdata_wire BLOB)",
     "CREATE INDEX records_byname ON records (name)",
     "CREATE INDEX records_byrname ON records (rname)",
     // The next index is a tricky one.  It's necessary for
@@ -366,7 +453,7 @@ const char* const SCHEMA_LIST[] = {
         "hash TEXT NOT NULL COLLATE NOCASE, "
         "owner TEXT NOT NULL COLLATE NOCASE, "
         "ttl INTEGER NOT NULL, rdtype TEXT NOT NULL COLLATE NOCASE, "
-        "rdata TEXT NOT NULL)",
+        "rdata TEXT NOT NULL, rdtype_code INTEGER, rdata_wire BLOB)",
     "CREATE INDEX nsec3_byhash ON nsec3 (hash)",
     "CREATE INDEX nsec3_byhash_and_rdtype ON nsec3 (hash, rdtype)",
     "CREATE TABLE diffs (id INTEGER PRIMARY KEY, "
@@ -545,6 +632,41 @@ checkAndSetupSchema(Initializer* initializer, const std::string& name) {
     initializer->params_.minor_version_ = schema_version.second;
 }
 
+// Switch the database to the write-ahead logging journal mode.  SQLite
+// returns the resulting mode, which is something else if the database
+// doesn't support it.
+void
+setWALMode(sqlite3* db, const std::string& name) {
+    sqlite3_stmt* prepared = NULL;
+    string mode;
+    // Changing the mode needs an exclusive lock, so we may need to try a few
+    // times, as in checkSchemaVersionElement().
+    for (size_t i = 0; i < 50; ++i) {
+        if (sqlite3_prepare_v2(db, "PRAGMA journal_mode=WAL", -1, &prepared,
+                               NULL) != SQLITE_OK) {
+            bundy_throw(SQLite3Error, "Unable to prepare journal mode "
+                        "setting: " << sqlite3_errmsg(db));
+        }
+        const int rc = sqlite3_step(prepared);
+        if (rc == SQLITE_ROW) {
+            const char* const result = reinterpret_cast<const char*>(
+                sqlite3_column_text(prepared, 0));
+            mode = (result != NULL) ? result : "";
+        }
+        sqlite3_finalize(prepared);
+        if (rc == SQLITE_ROW) {
+            break;
+        } else if (rc != SQLITE_BUSY || i == 49) {
+            bundy_throw(SQLite3Error, "Unable to set journal mode: " <<
+                        sqlite3_errmsg(db));
+        }
+        doSleep();
+    }
+    if (mode != "wal") {
+        LOG_WARN(logger, DATASRC_SQLITE_WAL_UNAVAILABLE).arg(name).arg(mode);
+    }
+}
+
 }
 
 void
@@ -562,6 +684,9 @@ SQLite3Accessor::open(const std::string& name) {
     }
 
     checkAndSetupSchema(&initializer, name);
+    if (use_wal_) {
+        setWALMode(initializer.params_.db_, name);
+    }
     initializer.move(dbparameters_.get());
 }
 
@@ -704,13 +829,15 @@ public:
         // We create the statements now and then just keep getting data
         // from them.
         statement_ = prepare(accessor->dbparameters_->db_,
-                             text_statements[ITERATE_NSEC3]);
+                             accessor->dbparameters_->
+                             getStatementText(ITERATE_NSEC3));
         bindZoneId(id);
 
         std::swap(statement_, statement2_);
 
         statement_ = prepare(accessor->dbparameters_->db_,
-                             text_statements[ITERATE_RECORDS]);
+                             accessor->dbparameters_->
+                             getStatementText(ITERATE_RECORDS));
         bindZoneId(id);
     }
 
@@ -739,20 +866,23 @@ public:
         switch (qtype) {
             case QT_ANY:
                 statement_ = prepare(accessor->dbparameters_->db_,
-                                     text_statements[ANY]);
+                                     accessor->dbparameters_->
+                                     getStatementText(ANY));
                 bindZoneId(id);
                 bindName(name_);
                 break;
             case QT_SUBDOMAINS:
                 statement_ = prepare(accessor->dbparameters_->db_,
-                                     text_statements[ANY_SUB]);
+                                     accessor->dbparameters_->
+                                     getStatementText(ANY_SUB));
                 bindZoneId(id);
                 // Done once, this should not be very inefficient.
                 bindName(bundy::dns::Name(name_).reverse().toText() + "%");
                 break;
             case QT_NSEC3:
                 statement_ = prepare(accessor->dbparameters_->db_,
-                                     text_statements[NSEC3]);
+                                     accessor->dbparameters_->
+                                     getStatementText(NSEC3));
                 bindZoneId(id);
                 bindName(name_);
                 break;
@@ -804,6 +934,25 @@ public:
         return (false);
     }
 
+    virtual bool getWireRdata(uint16_t& rrtype, const uint8_t*& data,
+                              size_t& length)
+    {
+        // The columns are NULL for records stored without them, and in
+        // databases which don't have them.
+        if (statement_ == NULL || rc_ != SQLITE_ROW ||
+            sqlite3_column_type(statement_, WIRE_TYPE_COLUMN) !=
+            SQLITE_INTEGER ||
+            sqlite3_column_type(statement_, WIRE_RDATA_COLUMN) !=
+            SQLITE_BLOB) {
+            return (false);
+        }
+        rrtype = sqlite3_column_int(statement_, WIRE_TYPE_COLUMN);
+        data = static_cast<const uint8_t*>(
+            sqlite3_column_blob(statement_, WIRE_RDATA_COLUMN));
+        length = sqlite3_column_bytes(statement_, WIRE_RDATA_COLUMN);
+        return (true);
+    }
+
     virtual ~Context() {
         finalize();
     }
@@ -1237,11 +1386,37 @@ SQLite3Accessor::rollback() {
 }
 
 namespace {
+// Converts the text of an RDATA to the wire format, to be stored next to it
+// in the databases which support it.  The names in it are not compressed,
+// so it can be parsed on its own.  If the text doesn't parse, false is
+// returned and only the text is stored; the record is then built from the
+// text when it's read.
+bool
+convertToWire(const string& rrclass, const string& rrtype,
+              const string& rdata_txt, uint16_t& type_code,
+              bundy::util::OutputBuffer& buffer)
+{
+    try {
+        const bundy::dns::RRType type(rrtype);
+        bundy::dns::rdata::createRdata(type, bundy::dns::RRClass(rrclass),
+                                       rdata_txt)->toWire(buffer);
+        type_code = type.getCode();
+        return (true);
+    } catch (const bundy::Exception&) {
+        return (false);
+    }
+}
+
 // Commonly used code sequence for adding/deleting record
+//
+// If wire is not NULL, the RRType code and the wire format RDATA are bound
+// after the given parameters.
 template <typename COLUMNS_TYPE>
 void
 doUpdate(SQLite3Parameters& dbparams, StatementID stmt_id,
-         COLUMNS_TYPE update_params, const char* exec_desc)
+         COLUMNS_TYPE update_params, const char* exec_desc,
+         const bundy::util::OutputBuffer* wire = NULL,
+         uint16_t type_code = 0)
 {
     StatementProcessor proc(dbparams, stmt_id, exec_desc);
 
@@ -1255,6 +1430,10 @@ doUpdate(SQLite3Parameters& dbparams, StatementID stmt_id,
         proc.bindText(++param_id, update_params[i].empty() ? NULL :
                       update_params[i].c_str(), SQLITE_TRANSIENT);
     }
+    if (wire != NULL) {
+        proc.bindInt(++param_id, type_code);
+        proc.bindBlob(++param_id, wire->getData(), wire->getLength());
+    }
     proc.exec();
 }
 }
@@ -1265,8 +1444,14 @@ SQLite3Accessor::addRecordToZone(const string (&columns)[ADD_COLUMN_COUNT]) {
         bundy_throw(DataSourceError, "adding record to SQLite3 "
                   "data source without transaction");
     }
+    bundy::util::OutputBuffer wire(0);
+    uint16_t type_code = 0;
+    const bool converted = dbparameters_->hasWireRdata() &&
+        convertToWire(class_, columns[ADD_TYPE], columns[ADD_RDATA],
+                      type_code, wire);
     doUpdate<const string (&)[ADD_COLUMN_COUNT]>(
-        *dbparameters_, ADD_RECORD, columns, "add record to zone");
+        *dbparameters_, ADD_RECORD, columns, "add record to zone",
+        converted ? &wire : NULL, type_code);
 }
 
 void
@@ -1288,9 +1473,14 @@ SQLite3Accessor::addNSEC3RecordToZone(
           columns[ADD_NSEC3_HASH] + "." + dbparameters_->updated_zone_origin_,
           columns[ADD_NSEC3_TTL],
           columns[ADD_NSEC3_TYPE], columns[ADD_NSEC3_RDATA] };
+    bundy::util::OutputBuffer wire(0);
+    uint16_t type_code = 0;
+    const bool converted = dbparameters_->hasWireRdata() &&
+        convertToWire(class_, columns[ADD_NSEC3_TYPE],
+                      columns[ADD_NSEC3_RDATA], type_code, wire);
     doUpdate<const string (&)[ADD_NSEC3_COLUMN_COUNT + 1]>(
         *dbparameters_, ADD_NSEC3_RECORD, sqlite3_columns,
-        "add NSEC3 record to zone");
+        "add NSEC3 record to zone", converted ? &wire : NULL, type_code);
 }
 
 void
@@ -93,7 +93,15 @@ public:
     ///    specifying which class of data it should serve (while the database
     ///    file can contain multiple classes of data, a single accessor can
     ///    work with only one class).
-    SQLite3Accessor(const std::string& filename, const std::string& rrclass);
+    /// \param use_wal If true, the journal mode of the database is set to
+    ///    write-ahead logging (WAL).  In this mode the readers of the
+    ///    database are not blocked by a writer, nor a writer by the readers.
+    ///    The mode is recorded in the database file, so it stays in effect
+    ///    for all its users.  If the database doesn't support it (e.g., an
+    ///    in-memory database), a warning is logged and the default mode is
+    ///    kept.
+    SQLite3Accessor(const std::string& filename, const std::string& rrclass,
+                    bool use_wal = false);
 
     /// \brief Destructor
     ///
@@ -104,6 +112,12 @@ public:
     /// same file name specified in the constructor of the original accessor.
     virtual boost::shared_ptr<DatabaseAccessor> clone();
 
+    /// This implementation prepares all the SQL statements the accessor
+    /// uses, so they are ready in its statement cache.
+    ///
+    /// \exception SQLite3Error if a statement can't be prepared.
+    virtual void prepareStatements();
+
     /// \brief Look up a zone
     ///
     /// This implements the getZone from DatabaseAccessor and looks up a zone
@@ -262,6 +276,8 @@ private:
     const std::string filename_;
     /// \brief The class for which the queries are done
     const std::string class_;
+    /// \brief Whether to use the WAL journal mode (necessary for clone())
+    const bool use_wal_;
     /// \brief Database name
     const std::string database_name_;
 
@@ -281,7 +297,12 @@ private:
 /// \brief Creates an instance of the SQlite3 datasource client
 ///
 /// Currently the configuration passed here must be a MapElement, containing
-/// one item called "database_file", whose value is a string
+/// one item called "database_file", whose value is a string.  It may also
+/// contain a boolean "use_wal" item, enabling the WAL journal mode (see the
+/// \c SQLite3Accessor constructor), and the integer "accessor_pool_size"
+/// and "find_cache_size" items, the sizes of the pool of accessors and of
+/// the result cache of the client (see the \c DatabaseClient constructor).
+/// All are off by default.
 ///
 /// This configuration setup is currently under discussion and will change in
 /// the near future.
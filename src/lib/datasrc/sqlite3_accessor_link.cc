@@ -33,6 +33,9 @@ namespace datasrc {
 namespace {
 
 const char* const CONFIG_ITEM_DATABASE_FILE = "database_file";
+const char* const CONFIG_ITEM_USE_WAL = "use_wal";
+const char* const CONFIG_ITEM_ACCESSOR_POOL_SIZE = "accessor_pool_size";
+const char* const CONFIG_ITEM_FIND_CACHE_SIZE = "find_cache_size";
 
 void
 addError(ElementPtr errors, const std::string& error) {
@@ -70,6 +73,30 @@ checkConfig(ConstElementPtr config, ElementPtr errors) {
                      " in SQLite3 backend is empty");
             result = false;
         }
+        if (config->contains(CONFIG_ITEM_USE_WAL) &&
+            config->get(CONFIG_ITEM_USE_WAL)->getType() != Element::boolean) {
+            addError(errors, "value of " + string(CONFIG_ITEM_USE_WAL) +
+                     " in SQLite3 backend is not a boolean");
+            result = false;
+        }
+        if (config->contains(CONFIG_ITEM_ACCESSOR_POOL_SIZE) &&
+            (config->get(CONFIG_ITEM_ACCESSOR_POOL_SIZE)->getType() !=
+             Element::integer ||
+             config->get(CONFIG_ITEM_ACCESSOR_POOL_SIZE)->intValue() < 0)) {
+            addError(errors, "value of " +
+                     string(CONFIG_ITEM_ACCESSOR_POOL_SIZE) +
+                     " in SQLite3 backend is not a non-negative integer");
+            result = false;
+        }
+        if (config->contains(CONFIG_ITEM_FIND_CACHE_SIZE) &&
+            (config->get(CONFIG_ITEM_FIND_CACHE_SIZE)->getType() !=
+             Element::integer ||
+             config->get(CONFIG_ITEM_FIND_CACHE_SIZE)->intValue() < 0)) {
+            addError(errors, "value of " +
+                     string(CONFIG_ITEM_FIND_CACHE_SIZE) +
+                     " in SQLite3 backend is not a non-negative integer");
+            result = false;
+        }
     }
 
     return (result);
@@ -91,11 +118,19 @@ createInstance(const std::string& datasrc_name,
     }
     const std::string dbfile =
         config->get(CONFIG_ITEM_DATABASE_FILE)->stringValue();
+    const bool use_wal = config->contains(CONFIG_ITEM_USE_WAL) &&
+        config->get(CONFIG_ITEM_USE_WAL)->boolValue();
+    const size_t pool_size = config->contains(CONFIG_ITEM_ACCESSOR_POOL_SIZE) ?
+        config->get(CONFIG_ITEM_ACCESSOR_POOL_SIZE)->intValue() : 0;
+    const size_t cache_size = config->contains(CONFIG_ITEM_FIND_CACHE_SIZE) ?
+        config->get(CONFIG_ITEM_FIND_CACHE_SIZE)->intValue() : 0;
     try {
         boost::shared_ptr<DatabaseAccessor> sqlite3_accessor(
-            new SQLite3Accessor(dbfile, "IN")); // XXX: avoid hardcode RR class
+            // XXX: avoid hardcode RR class
+            new SQLite3Accessor(dbfile, "IN", use_wal));
         return (new DatabaseClient(datasrc_name, bundy::dns::RRClass::IN(),
-                                   sqlite3_accessor));
+                                   sqlite3_accessor, pool_size,
+                                   cache_size));
     } catch (const std::exception& exc) {
         error = std::string("Error creating SQLite3 datasource: ") +
             exc.what();
@@ -23,6 +23,7 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <cstdio>
 #include <cstdlib>
 #include <string>
 
@@ -55,14 +56,36 @@ createSQLite3Accessor() {
     return (accessor);
 }
 
+// The writable data source above has an older schema, where the RDATA is
+// stored as text only.  This one creates a new database instead, so the
+// records are also stored (and read back) in the wire format.
+boost::shared_ptr<DatabaseAccessor>
+createWireSQLite3Accessor() {
+    const char* const dbfile = TEST_DATA_BUILDDIR "/rwtest_wire.sqlite3";
+    std::remove(dbfile);
+
+    boost::shared_ptr<DatabaseAccessor> accessor(
+        new SQLite3Accessor(dbfile, "IN"));
+    accessor->startTransaction();
+    accessor->addZone("example.org.");
+    accessor->commit();
+    loadTestDataGeneric(*accessor);
+
+    return (accessor);
+}
+
 // The test parameter for the SQLite3 accessor.  We can use enableNSEC3Generic
 // as this accessor fully supports NSEC3 related APIs.
 const DatabaseClientTestParam sqlite3_param = { createSQLite3Accessor,
                                                 enableNSEC3Generic };
+const DatabaseClientTestParam sqlite3_wire_param = {
+    createWireSQLite3Accessor, enableNSEC3Generic };
 
 INSTANTIATE_TEST_CASE_P(SQLite3, DatabaseClientTest,
-                        ::testing::Values(&sqlite3_param));
+                        ::testing::Values(&sqlite3_param,
+                                          &sqlite3_wire_param));
 
 INSTANTIATE_TEST_CASE_P(SQLite3, RRsetCollectionTest,
-                        ::testing::Values(&sqlite3_param));
+                        ::testing::Values(&sqlite3_param,
+                                          &sqlite3_wire_param));
 }
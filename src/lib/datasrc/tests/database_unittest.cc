@@ -23,6 +23,7 @@
 #include <exceptions/exceptions.h>
 
 #include <datasrc/database.h>
+#include <datasrc/accessor_pool.h>
 #include <datasrc/zone.h>
 #include <datasrc/zone_finder.h>
 #include <datasrc/exceptions.h>
@@ -213,6 +214,31 @@ private:
     std::map<std::string, int> zones_;
 };
 
+/*
+ * An accessor counting how many times it's cloned and prepared, shared
+ * among all the clones, for testing the accessor pool.
+ */
+class PooledAccessor : public NopAccessor {
+public:
+    PooledAccessor(size_t& clone_count, size_t& prepare_count) :
+        clone_count_(clone_count), prepare_count_(prepare_count)
+    {}
+
+    virtual boost::shared_ptr<DatabaseAccessor> clone() {
+        ++clone_count_;
+        return (boost::shared_ptr<DatabaseAccessor>(
+                    new PooledAccessor(clone_count_, prepare_count_)));
+    }
+
+    virtual void prepareStatements() {
+        ++prepare_count_;
+    }
+
+private:
+    size_t& clone_count_;
+    size_t& prepare_count_;
+};
+
 /*
  * A virtual database accessor that pretends it contains single zone --
  * example.org.
@@ -1440,6 +1466,125 @@ TEST(GenericDatabaseClientTest, notImplementedIterator) {
                  bundy::NotImplemented);
 }
 
+TEST(DatabaseAccessorPoolTest, badParameters) {
+    size_t clone_count = 0, prepare_count = 0;
+    EXPECT_THROW(DatabaseAccessorPool(boost::shared_ptr<DatabaseAccessor>(),
+                                      1),
+                 bundy::InvalidParameter);
+    EXPECT_THROW(DatabaseAccessorPool(boost::shared_ptr<DatabaseAccessor>(
+                                          new PooledAccessor(clone_count,
+                                                             prepare_count)),
+                                      0),
+                 bundy::InvalidParameter);
+}
+
+// Check the accessors are reused once released, and the idle ones are
+// bounded by the size of the pool.
+TEST(DatabaseAccessorPoolTest, getAndRelease) {
+    size_t clone_count = 0, prepare_count = 0;
+    const boost::shared_ptr<DatabaseAccessor> accessor(
+        new PooledAccessor(clone_count, prepare_count));
+    DatabaseAccessorPool pool(accessor, 2);
+    EXPECT_EQ(2, pool.getSize());
+    EXPECT_EQ(0, pool.getIdleCount());
+
+    boost::shared_ptr<DatabaseAccessor> accessor1(pool.get());
+    EXPECT_EQ(1, clone_count);
+    EXPECT_NE(accessor, accessor1);
+    const DatabaseAccessor* const raw1 = accessor1.get();
+    accessor1.reset();
+    EXPECT_EQ(1, pool.getIdleCount());
+
+    // The same one is given again, without cloning.
+    accessor1 = pool.get();
+    EXPECT_EQ(raw1, accessor1.get());
+    EXPECT_EQ(1, clone_count);
+    EXPECT_EQ(0, pool.getIdleCount());
+
+    // Each user gets a different accessor.
+    boost::shared_ptr<DatabaseAccessor> accessor2(pool.get());
+    boost::shared_ptr<DatabaseAccessor> accessor3(pool.get());
+    EXPECT_EQ(3, clone_count);
+    EXPECT_NE(accessor1, accessor2);
+    EXPECT_NE(accessor2, accessor3);
+    EXPECT_NE(accessor1, accessor3);
+
+    // Only two of them are kept.
+    accessor1.reset();
+    accessor2.reset();
+    accessor3.reset();
+    EXPECT_EQ(2, pool.getIdleCount());
+    EXPECT_EQ(0, prepare_count);
+}
+
+TEST(DatabaseAccessorPoolTest, warmUp) {
+    size_t clone_count = 0, prepare_count = 0;
+    DatabaseAccessorPool pool(boost::shared_ptr<DatabaseAccessor>(
+                                  new PooledAccessor(clone_count,
+                                                     prepare_count)), 3);
+    pool.warmUp();
+    EXPECT_EQ(3, clone_count);
+    EXPECT_EQ(3, prepare_count);
+    EXPECT_EQ(3, pool.getIdleCount());
+
+    // Already full, nothing to do.
+    pool.warmUp();
+    EXPECT_EQ(3, clone_count);
+
+    const boost::shared_ptr<DatabaseAccessor> accessor(pool.get());
+    EXPECT_EQ(3, clone_count);
+    EXPECT_EQ(2, pool.getIdleCount());
+}
+
+// An accessor can be used and released after the pool is gone.
+TEST(DatabaseAccessorPoolTest, outlivePool) {
+    size_t clone_count = 0, prepare_count = 0;
+    boost::shared_ptr<DatabaseAccessor> accessor;
+    {
+        DatabaseAccessorPool pool(boost::shared_ptr<DatabaseAccessor>(
+                                      new PooledAccessor(clone_count,
+                                                         prepare_count)), 1);
+        accessor = pool.get();
+    }
+    EXPECT_TRUE(accessor->getZone("example.org.").first);
+    accessor.reset();
+}
+
+// With a pool, each zone finder gets an accessor of its own, and the
+// iterators reuse the pooled ones.
+TEST(GenericDatabaseClientTest, accessorPool) {
+    size_t clone_count = 0, prepare_count = 0;
+    const boost::shared_ptr<DatabaseAccessor> accessor(
+        new PooledAccessor(clone_count, prepare_count));
+    DatabaseClient client("test", RRClass::IN(), accessor, 2);
+    EXPECT_EQ(2, clone_count);
+    EXPECT_EQ(2, prepare_count);
+
+    const DataSourceClient::FindResult result1(
+        client.findZone(Name("www.example.org")));
+    const DataSourceClient::FindResult result2(
+        client.findZone(Name("example.org")));
+    ASSERT_EQ(result::PARTIALMATCH, result1.code);
+    ASSERT_EQ(result::SUCCESS, result2.code);
+    const DatabaseAccessor* const accessor1 =
+        &dynamic_pointer_cast<DatabaseClient::Finder>(
+            result1.zone_finder)->getAccessor();
+    const DatabaseAccessor* const accessor2 =
+        &dynamic_pointer_cast<DatabaseClient::Finder>(
+            result2.zone_finder)->getAccessor();
+    EXPECT_NE(accessor.get(), accessor1);
+    EXPECT_NE(accessor.get(), accessor2);
+    EXPECT_NE(accessor1, accessor2);
+    EXPECT_EQ(2, clone_count);
+
+    // Zone lookups failing release the accessor at once.
+    EXPECT_EQ(result::NOTFOUND, client.findZone(Name("example.com")).code);
+    EXPECT_THROW(client.getIterator(Name("example.com")), NoSuchZone);
+    EXPECT_THROW(client.getIterator(Name("example.org")),
+                 bundy::NotImplemented);
+    EXPECT_EQ(3, clone_count);
+}
+
 // Pretend a bug in the connection and pass NULL as the context
 // Should not crash, but gracefully throw.  Works for the mock accessor only.
 TEST_F(MockDatabaseClientTest, nullIteratorContext) {
@@ -3246,6 +3391,94 @@ TEST_P(DatabaseClientTest, duplicateCommit) {
     EXPECT_THROW(updater_->commit(), DataSourceError);
 }
 
+// Check the results of the finders are cached when the client has a cache,
+// and that updates through the client invalidate them.
+TEST_P(DatabaseClientTest, findResultCache) {
+    DatabaseClient cached_client("dbtest", qclass_, current_accessor_, 0,
+                                 100);
+    const ConstRRsetPtr rrset1 = cached_client.findZone(zname_).zone_finder->
+        find(qname_, qtype_)->rrset;
+    ASSERT_TRUE(rrset1);
+    EXPECT_EQ(1, rrset1->getRdataCount());
+
+    // Another finder gets the very same RRset from the cache.
+    ZoneFinderPtr finder(cached_client.findZone(zname_).zone_finder);
+    EXPECT_EQ(rrset1, finder->find(qname_, qtype_)->rrset);
+
+    // The options are part of the key.
+    const ConstRRsetPtr rrset_dnssec =
+        finder->find(qname_, qtype_, ZoneFinder::FIND_DNSSEC)->rrset;
+    EXPECT_NE(rrset1, rrset_dnssec);
+    EXPECT_EQ(rrset_dnssec,
+              finder->find(qname_, qtype_, ZoneFinder::FIND_DNSSEC)->rrset);
+
+    // So are the results of findAll().
+    vector<ConstRRsetPtr> target1, target2;
+    EXPECT_EQ(ZoneFinder::SUCCESS, finder->findAll(qname_, target1)->code);
+    EXPECT_EQ(ZoneFinder::SUCCESS, finder->findAll(qname_, target2)->code);
+    ASSERT_FALSE(target1.empty());
+    EXPECT_TRUE(target1 == target2);
+
+    // Negative results too.
+    const Name nxname("nx.example.org");
+    EXPECT_EQ(ZoneFinder::NXDOMAIN, finder->find(nxname, qtype_)->code);
+    EXPECT_EQ(ZoneFinder::NXDOMAIN, finder->find(nxname, qtype_)->code);
+
+    // Committing an update through the client drops the cached results.
+    // The mock accessor uses different zone IDs for reading and updating,
+    // so this is only meaningful with real databases.
+    if (is_mock_) {
+        return;
+    }
+    ZoneUpdaterPtr updater(cached_client.getUpdater(zname_, false));
+    updater->addRRset(*rrset_);
+    updater->commit();
+    const ConstRRsetPtr rrset2 = cached_client.findZone(zname_).zone_finder->
+        find(qname_, qtype_)->rrset;
+    ASSERT_TRUE(rrset2);
+    EXPECT_NE(rrset1, rrset2);
+    EXPECT_EQ(2, rrset2->getRdataCount());
+}
+
+// Updates made elsewhere are noticed through the serial of the zone.
+TEST_P(DatabaseClientTest, findResultCacheSerial) {
+    DatabaseClient cached_client("dbtest", qclass_, current_accessor_, 0,
+                                 100);
+    ZoneFinderPtr old_finder(cached_client.findZone(zname_).zone_finder);
+    const ConstRRsetPtr rrset1 = old_finder->find(qname_, qtype_)->rrset;
+    ASSERT_TRUE(rrset1);
+
+    // Replace the zone by another client, with a new serial.
+    RRsetPtr new_soa(new RRset(zname_, qclass_, RRType::SOA(), rrttl_));
+    new_soa->addRdata(rdata::createRdata(new_soa->getType(),
+                                         new_soa->getClass(),
+                                         "ns1.example.org. admin.example.org. "
+                                         "1235 3600 1800 2419200 7200"));
+    updater_ = client_->getUpdater(zname_, true);
+    updater_->addRRset(*new_soa);
+    updater_->addRRset(*rrset_);
+    updater_->commit();
+
+    // A new finder checks the serial and doesn't use the old results.
+    const ConstRRsetPtr rrset2 = cached_client.findZone(zname_).zone_finder->
+        find(qname_, qtype_)->rrset;
+    ASSERT_TRUE(rrset2);
+    EXPECT_NE(rrset1, rrset2);
+    EXPECT_EQ("192.0.2.2",
+              rrset2->getRdataIterator()->getCurrent().toText());
+
+    // The old finder, which saw the old serial, doesn't get the new results
+    // from the cache (and didn't get its own either).
+    const ConstRRsetPtr rrset3 = old_finder->find(qname_, qtype_)->rrset;
+    EXPECT_NE(rrset1, rrset3);
+    EXPECT_NE(rrset2, rrset3);
+
+    // Looking up the SOA is never cached, and checks the serial.
+    ZoneFinderContextPtr soa_result(old_finder->find(zname_, RRType::SOA()));
+    EXPECT_NE(soa_result->rrset, old_finder->find(zname_, RRType::SOA())->rrset);
+    EXPECT_EQ(rrset2, old_finder->find(qname_, qtype_)->rrset);
+}
+
 TEST_P(DatabaseClientTest, addRRsetToNewZone) {
     // Add a single RRset to a fresh empty zone
     updater_ = client_->getUpdater(zname_, true);
@@ -144,6 +144,25 @@ TEST(FactoryTest, sqlite3ClientBadConfig) {
                  DataSourceError);
 
     config->set("database_file", Element::create(SQLITE_DBFILE_EXAMPLE_ORG));
+    config->set("use_wal", Element::create("yes"));
+    ASSERT_THROW(DataSourceClientContainer("sqlite3", "sqlite3", config),
+                 DataSourceError);
+
+    config->set("use_wal", Element::create(false));
+    config->set("accessor_pool_size", Element::create("2"));
+    ASSERT_THROW(DataSourceClientContainer("sqlite3", "sqlite3", config),
+                 DataSourceError);
+
+    config->set("accessor_pool_size", Element::create(-1));
+    ASSERT_THROW(DataSourceClientContainer("sqlite3", "sqlite3", config),
+                 DataSourceError);
+
+    config->set("accessor_pool_size", Element::create(2));
+    config->set("find_cache_size", Element::create(true));
+    ASSERT_THROW(DataSourceClientContainer("sqlite3", "sqlite3", config),
+                 DataSourceError);
+
+    config->set("find_cache_size", Element::create(100));
     DataSourceClientContainer dsc("sqlite3", "sqlite3", config);
 
     DataSourceClient::FindResult result1(
@@ -0,0 +1,140 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <datasrc/memory/nsec3_hash_cache.h>
+#include <datasrc/memory/zone_data.h>
+
+#include <exceptions/exceptions.h>
+
+#include <dns/name.h>
+#include <dns/labelsequence.h>
+#include <dns/rdataclass.h>
+#include <dns/rrclass.h>
+
+#include <util/memory_segment_local.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace bundy::dns;
+using namespace bundy::dns::rdata;
+using namespace bundy::datasrc::memory;
+using std::string;
+
+namespace {
+
+class NSEC3HashCacheTest : public ::testing::Test {
+protected:
+    NSEC3HashCacheTest() :
+        zname_("example.org"),
+        nsec3_data_(NSEC3Data::create(mem_sgmt_, zname_,
+                                      generic::NSEC3PARAM("1 0 12 aabbccdd"))),
+        nsec3_data_nosalt_(NSEC3Data::create(mem_sgmt_, zname_,
+                                             generic::NSEC3PARAM("1 0 12 -"))),
+        nsec3_data_iter_(NSEC3Data::create(mem_sgmt_, zname_,
+                                           generic::NSEC3PARAM("1 0 10 "
+                                                               "aabbccdd"))),
+        cache_(3)
+    {}
+    ~NSEC3HashCacheTest() {
+        NSEC3Data::destroy(mem_sgmt_, nsec3_data_, RRClass::IN());
+        NSEC3Data::destroy(mem_sgmt_, nsec3_data_nosalt_, RRClass::IN());
+        NSEC3Data::destroy(mem_sgmt_, nsec3_data_iter_, RRClass::IN());
+    }
+
+    bundy::util::MemorySegmentLocal mem_sgmt_;
+    const Name zname_;
+    NSEC3Data* const nsec3_data_;
+    NSEC3Data* const nsec3_data_nosalt_;
+    NSEC3Data* const nsec3_data_iter_;
+    NSEC3HashCache cache_;
+};
+
+TEST_F(NSEC3HashCacheTest, badSize) {
+    EXPECT_THROW(NSEC3HashCache(0), bundy::InvalidParameter);
+}
+
+TEST_F(NSEC3HashCacheTest, findAndAdd) {
+    const Name name("www.example.org");
+    string hash;
+    EXPECT_FALSE(cache_.find(*nsec3_data_, LabelSequence(name), hash));
+    EXPECT_EQ(0, cache_.getSize());
+
+    cache_.add(*nsec3_data_, LabelSequence(name), "HASH1");
+    EXPECT_EQ(1, cache_.getSize());
+    EXPECT_TRUE(cache_.find(*nsec3_data_, LabelSequence(name), hash));
+    EXPECT_EQ("HASH1", hash);
+
+    // Names are case insensitive.
+    hash.clear();
+    EXPECT_TRUE(cache_.find(*nsec3_data_,
+                            LabelSequence(Name("WWW.Example.ORG")), hash));
+    EXPECT_EQ("HASH1", hash);
+
+    // Adding the same name again is a no-op.
+    cache_.add(*nsec3_data_, LabelSequence(name), "HASH2");
+    EXPECT_EQ(1, cache_.getSize());
+    EXPECT_TRUE(cache_.find(*nsec3_data_, LabelSequence(name), hash));
+    EXPECT_EQ("HASH1", hash);
+
+    // A different name is a different entry.
+    EXPECT_FALSE(cache_.find(*nsec3_data_, LabelSequence(zname_), hash));
+
+    // So is a stripped label sequence.
+    LabelSequence ls(name);
+    ls.stripLeft(1);
+    EXPECT_FALSE(cache_.find(*nsec3_data_, ls, hash));
+    cache_.add(*nsec3_data_, ls, "HASH3");
+    EXPECT_TRUE(cache_.find(*nsec3_data_, LabelSequence(zname_), hash));
+    EXPECT_EQ("HASH3", hash);
+}
+
+TEST_F(NSEC3HashCacheTest, parameters) {
+    // The hashes with different NSEC3 parameters are different entries.
+    const LabelSequence name(zname_);
+    cache_.add(*nsec3_data_, name, "HASH1");
+    cache_.add(*nsec3_data_nosalt_, name, "HASH2");
+    cache_.add(*nsec3_data_iter_, name, "HASH3");
+    EXPECT_EQ(3, cache_.getSize());
+
+    string hash;
+    EXPECT_TRUE(cache_.find(*nsec3_data_, name, hash));
+    EXPECT_EQ("HASH1", hash);
+    EXPECT_TRUE(cache_.find(*nsec3_data_nosalt_, name, hash));
+    EXPECT_EQ("HASH2", hash);
+    EXPECT_TRUE(cache_.find(*nsec3_data_iter_, name, hash));
+    EXPECT_EQ("HASH3", hash);
+}
+
+TEST_F(NSEC3HashCacheTest, leastRecentlyUsed) {
+    const Name name1("a.example.org"), name2("b.example.org"),
+        name3("c.example.org"), name4("d.example.org");
+    cache_.add(*nsec3_data_, LabelSequence(name1), "HASH1");
+    cache_.add(*nsec3_data_, LabelSequence(name2), "HASH2");
+    cache_.add(*nsec3_data_, LabelSequence(name3), "HASH3");
+
+    // Use the first one, so the second one is the least recently used.
+    string hash;
+    EXPECT_TRUE(cache_.find(*nsec3_data_, LabelSequence(name1), hash));
+
+    cache_.add(*nsec3_data_, LabelSequence(name4), "HASH4");
+    EXPECT_EQ(3, cache_.getSize());
+    EXPECT_TRUE(cache_.find(*nsec3_data_, LabelSequence(name1), hash));
+    EXPECT_FALSE(cache_.find(*nsec3_data_, LabelSequence(name2), hash));
+    EXPECT_TRUE(cache_.find(*nsec3_data_, LabelSequence(name3), hash));
+    EXPECT_TRUE(cache_.find(*nsec3_data_, LabelSequence(name4), hash));
+}
+
+}
@@ -132,9 +132,9 @@ public:
             }
             diffs_.push_back(soa); // add new SOA
             diffs_.push_back(ns); // add new NS
-            it_ = diffs_.begin();
         }
         diffs_.push_back(ConstRRsetPtr());
+        it_ = diffs_.begin();
     }
     virtual ConstRRsetPtr getNextDiff() {
         const ConstRRsetPtr result = *it_;
@@ -326,20 +326,20 @@ ZoneDataLoaderTest::loadFromDataSourceCommon(bool incremental) {
     EXPECT_NE(old_data, zone_data_);
     ZoneData::destroy(mem_sgmt_, old_data, zclass_);
 
-    // enable diff based loading
+    // enable diff based loading.  The diffs are read in the load phase,
+    // so it's subject to the count limit.
     dsc.serial_ = 12;
     dsc.use_journal_ = true;
     ZoneDataLoader loader6(mem_sgmt_, zclass_, origin, dsc, zone_data_);
-    ZoneData* zone_data6 = checkLoad(loader6, incremental, true);
+    ZoneData* zone_data6 = checkLoad(loader6, incremental);
     EXPECT_EQ(zone_data_, zone_data6);
     EXPECT_TRUE(loader6.isDataReused());
     EXPECT_EQ(zone_data_, loader6.commit(zone_data_));
 
-    // increase the end serial sufficiently large so the internal vector
-    // will be full and JournalReader still has some data.
+    // a longer sequence of diffs.
     dsc.serial_ = 120;
     ZoneDataLoader loader7(mem_sgmt_, zclass_, origin, dsc, zone_data_);
-    ZoneData* zone_data7 = checkLoad(loader7, incremental, true);
+    ZoneData* zone_data7 = checkLoad(loader7, incremental);
     EXPECT_EQ(zone_data_, zone_data7);
     EXPECT_TRUE(loader7.isDataReused());
     EXPECT_EQ(zone_data_, loader7.commit(zone_data_));
@@ -359,7 +359,7 @@ ZoneDataLoaderTest::loadFromDataSourceCommon(bool incremental) {
     dsc.use_null_journal_ = false;
     dsc.use_broken_journal_ = true;
     ZoneDataLoader loader9(mem_sgmt_, zclass_, origin, dsc, zone_data_);
-    ZoneData* zone_data9 = checkLoad(loader9, incremental, true);
+    ZoneData* zone_data9 = checkLoad(loader9, incremental);
     EXPECT_EQ(zone_data_, zone_data9);
     EXPECT_TRUE(loader9.isDataReused());
     EXPECT_THROW(loader9.commit(zone_data_), ZoneDataUpdater::RemoveError);
@@ -422,6 +422,34 @@ TEST_F(ZoneDataLoaderTest, loadToBeNSEC3Unsigned) {
     EXPECT_FALSE(zone_data_->isNSEC3Signed());
 }
 
+// Only the net change of the journal is applied to the zone data.
+TEST_F(ZoneDataLoaderTest, loadJournalNetChange) {
+    const Name origin("example.com");
+    MockDataSourceClient dsc;
+    zone_data_ = ZoneDataLoader(mem_sgmt_, zclass_, origin, dsc).load();
+    const RdataSet* const ns_rdataset =
+        RdataSet::find(zone_data_->getOriginNode()->getData(), RRType::NS());
+    ASSERT_NE(static_cast<const RdataSet*>(NULL), ns_rdataset);
+
+    // The mock journal deletes and adds back the NS in every version.  The
+    // diffs are all read in load(), and commit() only replaces the SOA.
+    dsc.serial_ = 5;
+    dsc.use_journal_ = true;
+    ZoneDataLoader loader(mem_sgmt_, zclass_, origin, dsc, zone_data_);
+    EXPECT_FALSE(loader.loadIncremental(1));
+    EXPECT_FALSE(loader.getLoadedData());
+    EXPECT_TRUE(loader.loadIncremental(0));
+    EXPECT_EQ(zone_data_, loader.getLoadedData());
+    EXPECT_EQ(zone_data_, loader.commit(zone_data_));
+    EXPECT_EQ(ns_rdataset,
+              RdataSet::find(zone_data_->getOriginNode()->getData(),
+                             RRType::NS()));
+
+    // The new SOA has been installed.
+    ZoneDataLoader loader2(mem_sgmt_, zclass_, origin, dsc, zone_data_);
+    EXPECT_TRUE(loader2.isDataReused()); // same serial, nothing to load
+}
+
 // Load bunch of small zones, hoping some of the relocation will happen
 // during the memory creation, not only Rdata creation.
 // Note: this doesn't even compile unless USE_SHARED_MEMORY is defined.
@@ -1664,6 +1664,29 @@ TEST_F(InMemoryZoneFinderNSEC3Test, findNSEC3) {
     performNSEC3Test(zone_finder_);
 }
 
+TEST_F(InMemoryZoneFinderNSEC3Test, findNSEC3WithHashCache) {
+    // The same tests should pass with the cache of hashes, both when the
+    // hashes are calculated and when they are taken from the cache.
+    NSEC3HashCache cache;
+    InMemoryZoneFinder finder(*zone_data_, class_, &cache);
+    performNSEC3Test(finder);
+    const size_t cache_size = cache.getSize();
+    EXPECT_LT(0, cache_size);
+    performNSEC3Test(finder);
+    EXPECT_EQ(cache_size, cache.getSize());
+
+    // The cached hash is used instead of calculating it (the faked
+    // calculator would throw for this name).
+    const Name name("unknown.example.org");
+    cache.add(*zone_data_->getNSEC3Data(), LabelSequence(name),
+              "0P9MHAVEQVM6T7VBL5LOP2U3T2RP3TOM");
+    const ZoneFinder::FindNSEC3Result result = finder.findNSEC3(name, false);
+    EXPECT_TRUE(result.matched);
+    ASSERT_TRUE(result.closest_proof);
+    EXPECT_EQ(Name("0P9MHAVEQVM6T7VBL5LOP2U3T2RP3TOM.example.org"),
+              result.closest_proof->getName());
+}
+
 struct TestData {
      // String for the name passed to findNSEC3() (concatenated with
      // "example.org.")
@@ -249,6 +249,38 @@ TEST_F(ZoneTableSegmentMappedTest, resetBadConfig) {
     }, bundy::InvalidParameter);
 
     EXPECT_TRUE(verifyData(ztable_segment_->getMemorySegment()));
+
+    // Value of "reserved-size" key is not a non-negative integer
+    EXPECT_THROW({
+        ztable_segment_->reset(ZoneTableSegment::CREATE,
+                               Element::fromJSON(
+                                   "{\"mapped-file\": \"" +
+                                   std::string(mapped_file) + "\", "
+                                   "\"reserved-size\": \"1M\"}"));
+    }, bundy::InvalidParameter);
+    EXPECT_THROW({
+        ztable_segment_->reset(ZoneTableSegment::CREATE,
+                               Element::fromJSON(
+                                   "{\"mapped-file\": \"" +
+                                   std::string(mapped_file) + "\", "
+                                   "\"reserved-size\": -1}"));
+    }, bundy::InvalidParameter);
+
+    EXPECT_TRUE(verifyData(ztable_segment_->getMemorySegment()));
+}
+
+TEST_F(ZoneTableSegmentMappedTest, resetWithReservedSize) {
+    // With a reserved address range the segment grows in place.
+    ztable_segment_->reset(ZoneTableSegment::CREATE,
+                           Element::fromJSON(
+                               "{\"mapped-file\": \"" +
+                               std::string(mapped_file) + "\", "
+                               "\"reserved-size\": 67108864}"));
+    EXPECT_TRUE(ztable_segment_->isWritable());
+    MemorySegment& segment = ztable_segment_->getMemorySegment();
+    void* ptr = NULL;
+    EXPECT_NO_THROW(ptr = segment.allocate(1024 * 1024));
+    segment.deallocate(ptr, 1024 * 1024);
 }
 
 TEST_F(ZoneTableSegmentMappedTest, nullReset) {
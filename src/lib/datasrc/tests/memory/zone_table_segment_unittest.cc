@@ -14,8 +14,12 @@
 
 #include <datasrc/memory/zone_writer.h>
 #include <datasrc/memory/zone_table_segment_local.h>
+#include <datasrc/memory/zone_data.h>
+#include <datasrc/memory/zone_data_loader.h>
+#include <util/memory_segment_arena.h>
 
 #include <gtest/gtest.h>
+#include <boost/bind.hpp>
 #include <boost/scoped_ptr.hpp>
 
 using namespace bundy::dns;
@@ -106,4 +110,208 @@ TEST_F(ZoneTableSegmentTest, isWritable) {
     EXPECT_TRUE(ztable_segment_->isWritable());
 }
 
+TEST_F(ZoneTableSegmentTest, zoneSegments) {
+    ZoneTableSegmentLocal& segment =
+        *static_cast<ZoneTableSegmentLocal*>(ztable_segment_);
+    const Name origin("example.org");
+
+    // By default, all zone data are in the common segment.
+    MemorySegment& common_sgmt = segment.getMemorySegment();
+    EXPECT_EQ(&common_sgmt, &segment.createZoneSegment(origin));
+    EXPECT_EQ(&common_sgmt, &segment.getZoneSegment(origin, NULL));
+    segment.destroyZoneSegment(origin, common_sgmt, NULL, RRClass::IN());
+
+    // For zones using arenas, a new one is created each time.
+    segment.useArena(origin, 4096);
+    MemorySegment& zone_sgmt1 = segment.createZoneSegment(origin);
+    MemorySegment& zone_sgmt2 = segment.createZoneSegment(origin);
+    EXPECT_NE(&common_sgmt, &zone_sgmt1);
+    EXPECT_NE(&zone_sgmt1, &zone_sgmt2);
+    EXPECT_NE(static_cast<void*>(NULL),
+              dynamic_cast<MemorySegmentArena*>(&zone_sgmt1));
+    EXPECT_EQ(&common_sgmt, &segment.createZoneSegment(Name("example.com")));
+
+    // Zone data are found in their arena.
+    ZoneData* zone_data = ZoneData::create(zone_sgmt2, origin);
+    EXPECT_EQ(&zone_sgmt2, &segment.getZoneSegment(origin, zone_data));
+    segment.destroyZoneSegment(origin, zone_sgmt1, NULL, RRClass::IN());
+    segment.destroyZoneSegment(origin, zone_sgmt2, zone_data, RRClass::IN());
+
+    // It can be disabled again.
+    segment.useArena(origin, 0);
+    EXPECT_EQ(&common_sgmt, &segment.createZoneSegment(origin));
+}
+
+ZoneDataLoader*
+createLoader(MemorySegment& mem_sgmt, const Name& origin,
+             const std::string& filename)
+{
+    return (new ZoneDataLoader(mem_sgmt, RRClass::IN(), origin, filename,
+                               NULL));
+}
+
+TEST_F(ZoneTableSegmentTest, loadIntoArena) {
+    ZoneTableSegmentLocal& segment =
+        *static_cast<ZoneTableSegmentLocal*>(ztable_segment_);
+    const Name origin("example.org");
+    segment.useArena(origin);
+
+    const ZoneDataLoaderCreator creator =
+        boost::bind(createLoader, _1, origin,
+                    TEST_DATA_DIR "/example.org-rrsigs.zone");
+    const ZoneTable* const table = segment.getHeader().getTable();
+    for (int i = 0; i < 2; ++i) {
+        ZoneWriter writer(segment, creator, origin, RRClass::IN(), false);
+        writer.load();
+        writer.install();
+        writer.cleanup();
+
+        // Each version of the zone data is stored in its own arena.
+        const ZoneTable::FindResult result = table->findZone(origin);
+        ASSERT_EQ(bundy::datasrc::result::SUCCESS, result.code);
+        MemorySegmentArena* arena = dynamic_cast<MemorySegmentArena*>(
+            &segment.getZoneSegment(origin, result.zone_data));
+        ASSERT_NE(static_cast<void*>(NULL), arena);
+        EXPECT_FALSE(arena->allMemoryDeallocated());
+    }
+
+    // The zone data in the arena are left to the destructor of the segment.
+}
+
+// A loader which updates the old zone data in place (without actually
+// changing anything), remembering the segment it's told to use.
+class ReusingLoader : public ZoneDataLoader {
+public:
+    ReusingLoader(MemorySegment& mem_sgmt, ZoneData* old_data) :
+        mem_sgmt_(&mem_sgmt), old_data_(old_data)
+    {}
+    virtual bool isDataReused() const {
+        return (old_data_ != NULL);
+    }
+    virtual bool loadIncremental(size_t) {
+        return (true);
+    }
+    virtual ZoneData* getLoadedData() const {
+        return (old_data_);
+    }
+    virtual ZoneData* commit(ZoneData* update_data) {
+        return (update_data);
+    }
+    virtual void setMemorySegment(MemorySegment& mem_sgmt) {
+        mem_sgmt_ = &mem_sgmt;
+    }
+
+    MemorySegment* mem_sgmt_;
+    ZoneData* const old_data_;
+};
+
+ZoneDataLoader*
+createReusingLoader(MemorySegment& mem_sgmt, ZoneData* old_data,
+                    int* count, ReusingLoader** loader)
+{
+    ++*count;
+    *loader = new ReusingLoader(mem_sgmt, old_data);
+    return (*loader);
+}
+
+TEST_F(ZoneTableSegmentTest, reuseArena) {
+    ZoneTableSegmentLocal& segment =
+        *static_cast<ZoneTableSegmentLocal*>(ztable_segment_);
+    const Name origin("example.org");
+    segment.useArena(origin);
+
+    // Load the first version into an arena.
+    ZoneWriter writer1(segment,
+                       boost::bind(createLoader, _1, origin,
+                                   TEST_DATA_DIR "/example.org-rrsigs.zone"),
+                       origin, RRClass::IN(), false);
+    writer1.load();
+    writer1.install();
+    writer1.cleanup();
+    const ZoneTable* const table = segment.getHeader().getTable();
+    const ZoneData* const old_data = table->findZone(origin).zone_data;
+    MemorySegment* const old_arena = &segment.getZoneSegment(origin, old_data);
+
+    // Updating it in place, the only loader is switched to the arena of the
+    // old data (rather than another one being created for it).
+    int count = 0;
+    ReusingLoader* loader = NULL;
+    ZoneWriter writer2(segment,
+                       boost::bind(createReusingLoader, _1, _2, &count,
+                                   &loader),
+                       origin, RRClass::IN(), false);
+    writer2.load();
+    EXPECT_EQ(1, count);
+    ASSERT_NE(static_cast<void*>(NULL), loader);
+    EXPECT_EQ(old_arena, loader->mem_sgmt_);
+    writer2.install();
+    writer2.cleanup();
+
+    // The data stay where they were.
+    EXPECT_EQ(old_data, table->findZone(origin).zone_data);
+    EXPECT_EQ(old_arena, &segment.getZoneSegment(origin, old_data));
+}
+
+ZoneDataLoader*
+createLoaderOrReusing(MemorySegment& mem_sgmt, ZoneData* old_data,
+                      const Name& origin, ZoneData** passed_data)
+{
+    *passed_data = old_data;
+    if (old_data) {
+        return (new ReusingLoader(mem_sgmt, old_data));
+    }
+    return (createLoader(mem_sgmt, origin,
+                         TEST_DATA_DIR "/example.org-rrsigs.zone"));
+}
+
+TEST_F(ZoneTableSegmentTest, reloadWastedArena) {
+    ZoneTableSegmentLocal& segment =
+        *static_cast<ZoneTableSegmentLocal*>(ztable_segment_);
+    const Name origin("example.org");
+    segment.useArena(origin);
+
+    ZoneData* passed_data = NULL;
+    const ZoneDataLoaderCreator creator =
+        boost::bind(createLoaderOrReusing, _1, _2, origin, &passed_data);
+    ZoneWriter writer1(segment, creator, origin, RRClass::IN(), false);
+    writer1.load();
+    writer1.install();
+    writer1.cleanup();
+    const ZoneTable* const table = segment.getHeader().getTable();
+    const ZoneData* const old_data = table->findZone(origin).zone_data;
+    MemorySegmentArena* const old_arena = dynamic_cast<MemorySegmentArena*>(
+        &segment.getZoneSegment(origin, old_data));
+    ASSERT_NE(static_cast<void*>(NULL), old_arena);
+    EXPECT_TRUE(segment.isZoneSegmentReusable(origin, old_data));
+
+    // Pretend earlier updates left more garbage in the arena than live
+    // data.
+    const size_t garbage_size = old_arena->getAllocatedSize() * 2;
+    void* const garbage = old_arena->allocate(garbage_size);
+    old_arena->allocate(8);     // so the garbage isn't the last allocation
+    old_arena->deallocate(garbage, garbage_size);
+    EXPECT_FALSE(segment.isZoneSegmentReusable(origin, old_data));
+
+    // The next update becomes a full reload into a new arena, and the old
+    // one is freed.
+    ZoneWriter writer2(segment, creator, origin, RRClass::IN(), false);
+    writer2.load();
+    EXPECT_EQ(static_cast<void*>(NULL), passed_data);
+    writer2.install();
+    writer2.cleanup();
+    const ZoneData* const new_data = table->findZone(origin).zone_data;
+    MemorySegmentArena* const new_arena = dynamic_cast<MemorySegmentArena*>(
+        &segment.getZoneSegment(origin, new_data));
+    ASSERT_NE(static_cast<void*>(NULL), new_arena);
+    EXPECT_TRUE(segment.isZoneSegmentReusable(origin, new_data));
+
+    // Updates of the new version are applied in place again.
+    ZoneWriter writer3(segment, creator, origin, RRClass::IN(), false);
+    writer3.load();
+    EXPECT_EQ(new_data, passed_data);
+    writer3.install();
+    writer3.cleanup();
+    EXPECT_EQ(new_data, table->findZone(origin).zone_data);
+}
+
 } // anonymous namespace
@@ -33,6 +33,8 @@
 #include <vector>
 #include <fstream>
 
+#include <cstring>
+
 using namespace std;
 using namespace bundy::datasrc;
 using namespace bundy::datasrc::test;
@@ -606,6 +608,31 @@ TEST_F(SQLite3AccessorTest, getRecords) {
     EXPECT_FALSE(context->getNext(columns));
 }
 
+// Databases of older schema versions don't have the wire format of the
+// RDATA, only the text.
+TEST_F(SQLite3AccessorTest, noWireRdata) {
+    const std::pair<bool, int> zone_info(accessor->getZone("example.com."));
+    ASSERT_TRUE(zone_info.first);
+    DatabaseAccessor::IteratorContextPtr context =
+        accessor->getRecords("www.example.com.", zone_info.second);
+    string data[DatabaseAccessor::COLUMN_COUNT];
+    uint16_t rrtype;
+    const uint8_t* wire;
+    size_t length;
+    ASSERT_TRUE(context->getNext(data));
+    EXPECT_FALSE(context->getWireRdata(rrtype, wire, length));
+}
+
+// All the statements can be prepared in advance, and it changes nothing
+// in the results.
+TEST_F(SQLite3AccessorTest, prepareStatements) {
+    EXPECT_NO_THROW(accessor->prepareStatements());
+    EXPECT_NO_THROW(accessor->prepareStatements());
+    EXPECT_TRUE(accessor->getZone("example.com.").first);
+    EXPECT_EQ("dns01.example.com.",
+              accessor->findPreviousName(1, "com.example.dns02."));
+}
+
 TEST_F(SQLite3AccessorTest, findPrevious) {
     EXPECT_EQ("dns01.example.com.",
               accessor->findPreviousName(1, "com.example.dns02."));
@@ -727,6 +754,102 @@ TEST_F(SQLite3Create, addZoneDifferentClass) {
     EXPECT_EQ(new_zone_id_CH, accessor->getZone(zone_name).second);
 }
 
+// Records added to a newly created database are stored in the wire format
+// as well, and can be read back that way.
+TEST_F(SQLite3Create, wireRdata) {
+    boost::shared_ptr<SQLite3Accessor> accessor(
+        new SQLite3Accessor(SQLITE_NEW_DBFILE, "IN"));
+    accessor->startTransaction();
+    const int zone_id = accessor->addZone("example.com.");
+    accessor->commit();
+
+    accessor->startUpdateZone("example.com.", false);
+    const char* const records[][2] = {
+        { "A", "192.0.2.1" },
+        { "NS", "ns.example.com." },
+        // This doesn't parse, so it's stored as text only.
+        { "A", "not an address" }
+    };
+    string columns[DatabaseAccessor::ADD_COLUMN_COUNT];
+    columns[DatabaseAccessor::ADD_NAME] = "www.example.com.";
+    columns[DatabaseAccessor::ADD_REV_NAME] = "com.example.www.";
+    columns[DatabaseAccessor::ADD_TTL] = "3600";
+    for (size_t i = 0; i < sizeof(records) / sizeof(records[0]); ++i) {
+        columns[DatabaseAccessor::ADD_TYPE] = records[i][0];
+        columns[DatabaseAccessor::ADD_RDATA] = records[i][1];
+        accessor->addRecordToZone(columns);
+    }
+    accessor->commit();
+
+    DatabaseAccessor::IteratorContextPtr context =
+        accessor->getRecords("www.example.com.", zone_id);
+    string data[DatabaseAccessor::COLUMN_COUNT];
+    uint16_t rrtype;
+    const uint8_t* wire;
+    size_t length;
+
+    // The wire format isn't available before the first record is read.
+    EXPECT_FALSE(context->getWireRdata(rrtype, wire, length));
+
+    ASSERT_TRUE(context->getNext(data));
+    EXPECT_EQ("192.0.2.1", data[DatabaseAccessor::RDATA_COLUMN]);
+    ASSERT_TRUE(context->getWireRdata(rrtype, wire, length));
+    EXPECT_EQ(1, rrtype);
+    const uint8_t expected_a[] = { 192, 0, 2, 1 };
+    ASSERT_EQ(sizeof(expected_a), length);
+    EXPECT_EQ(0, memcmp(expected_a, wire, length));
+
+    // The names in the data are not compressed.
+    ASSERT_TRUE(context->getNext(data));
+    ASSERT_TRUE(context->getWireRdata(rrtype, wire, length));
+    EXPECT_EQ(2, rrtype);
+    const uint8_t expected_ns[] = { 2, 'n', 's', 7, 'e', 'x', 'a', 'm', 'p',
+                                    'l', 'e', 3, 'c', 'o', 'm', 0 };
+    ASSERT_EQ(sizeof(expected_ns), length);
+    EXPECT_EQ(0, memcmp(expected_ns, wire, length));
+
+    ASSERT_TRUE(context->getNext(data));
+    EXPECT_EQ("not an address", data[DatabaseAccessor::RDATA_COLUMN]);
+    EXPECT_FALSE(context->getWireRdata(rrtype, wire, length));
+
+    EXPECT_FALSE(context->getNext(data));
+    EXPECT_FALSE(context->getWireRdata(rrtype, wire, length));
+}
+
+TEST_F(SQLite3Create, walMode) {
+    {
+        SQLite3Accessor accessor(SQLITE_NEW_DBFILE, "IN", true);
+        accessor.startTransaction();
+        accessor.addZone("example.com.");
+        accessor.commit();
+
+        // The clones use the same mode (which is anyway recorded in the
+        // database).
+        EXPECT_TRUE(accessor.clone()->getZone("example.com.").first);
+    }
+
+    sqlite3* db;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(SQLITE_NEW_DBFILE, &db));
+    sqlite3_stmt* stmt;
+    ASSERT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, "PRAGMA journal_mode", -1,
+                                            &stmt, NULL));
+    ASSERT_EQ(SQLITE_ROW, sqlite3_step(stmt));
+    EXPECT_EQ(string("wal"),
+              reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+}
+
+// In-memory databases don't support write-ahead logging, which is not an
+// error.
+TEST(SQLite3Open, memoryDBWAL) {
+    SQLite3Accessor accessor(SQLITE_DBFILE_MEMORY, "IN", true);
+    accessor.startTransaction();
+    accessor.addZone("example.com.");
+    accessor.commit();
+    EXPECT_TRUE(accessor.getZone("example.com.").first);
+}
+
 TEST_F(SQLite3Create, emptytest) {
     ASSERT_FALSE(isReadable(SQLITE_NEW_DBFILE));
 
@@ -1007,6 +1130,28 @@ TEST_F(SQLite3Update, commitConflict) {
     checkRecords(*accessor, zone_id, "foo.bar.example.com.", expected_stored);
 }
 
+// With write-ahead logging, the same commit succeeds while the other
+// accessor keeps reading the old data.
+TEST_F(SQLite3Update, commitWhileReadingWAL) {
+    accessor.reset(new SQLite3Accessor(TEST_DATA_BUILDDIR
+                                       "/test.sqlite3.copied", "IN", true));
+    another_accessor.reset(new SQLite3Accessor(TEST_DATA_BUILDDIR
+                                               "/test.sqlite3.copied", "IN"));
+
+    iterator = another_accessor->getRecords("foo.bar.example.com.", zone_id);
+    EXPECT_TRUE(iterator->getNext(get_columns));
+
+    zone_id = accessor->startUpdateZone("example.com.", true).second;
+    EXPECT_NO_THROW(accessor->commit());
+    checkRecords(*accessor, zone_id, "foo.bar.example.com.", empty_stored);
+
+    // The reader still has its snapshot until it's done.
+    EXPECT_FALSE(iterator->getNext(get_columns));
+    iterator.reset();
+    checkRecords(*another_accessor, zone_id, "foo.bar.example.com.",
+                 empty_stored);
+}
+
 TEST_F(SQLite3Update, updateConflict) {
     // Similar to the previous case, but this is a conflict with another
     // update attempt.  Note that these two accessors modify disjoint sets
@@ -0,0 +1,469 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <datasrc/zone_streamer.h>
+#include <datasrc/zone_iterator.h>
+#include <datasrc/exceptions.h>
+
+#include <dns/message.h>
+#include <dns/messagerenderer.h>
+#include <dns/name.h>
+#include <dns/opcode.h>
+#include <dns/question.h>
+#include <dns/rcode.h>
+#include <dns/rdataclass.h>
+#include <dns/rrclass.h>
+#include <dns/rrset.h>
+#include <dns/rrttl.h>
+#include <dns/tsig.h>
+#include <dns/tsigkey.h>
+
+#include <util/buffer.h>
+#include <exceptions/exceptions.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace bundy::dns;
+using namespace bundy::datasrc;
+using bundy::util::InputBuffer;
+using bundy::util::OutputBuffer;
+using boost::lexical_cast;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Iterate over a vector of RRsets, for AXFR.
+class VectorIterator : public ZoneIterator {
+public:
+    VectorIterator(const vector<ConstRRsetPtr>& rrsets, ConstRRsetPtr soa) :
+        rrsets_(rrsets), soa_(soa), it_(rrsets_.begin())
+    {}
+    virtual ConstRRsetPtr getNextRRset() {
+        if (it_ == rrsets_.end()) {
+            return (ConstRRsetPtr());
+        }
+        return (*it_++);
+    }
+    virtual ConstRRsetPtr getSOA() const {
+        return (soa_);
+    }
+private:
+    const vector<ConstRRsetPtr> rrsets_;
+    const ConstRRsetPtr soa_;
+    vector<ConstRRsetPtr>::const_iterator it_;
+};
+
+// Return a vector of RRsets as the diffs, for IXFR.
+class VectorJournalReader : public ZoneJournalReader {
+public:
+    VectorJournalReader(const vector<ConstRRsetPtr>& diffs) :
+        diffs_(diffs), it_(diffs_.begin())
+    {}
+    virtual ConstRRsetPtr getNextDiff() {
+        if (it_ == diffs_.end()) {
+            return (ConstRRsetPtr());
+        }
+        return (*it_++);
+    }
+private:
+    const vector<ConstRRsetPtr> diffs_;
+    vector<ConstRRsetPtr>::const_iterator it_;
+};
+
+class ZoneStreamerTest : public ::testing::Test {
+protected:
+    ZoneStreamerTest() :
+        zone_name_("example.org"),
+        request_(Message::RENDER),
+        soa_(createSOA(2))
+    {
+        request_.setQid(0x1035);
+        request_.setOpcode(Opcode::QUERY());
+        request_.setRcode(Rcode::NOERROR());
+        request_.setHeaderFlag(Message::HEADERFLAG_RD);
+        request_.addQuestion(Question(zone_name_, RRClass::IN(),
+                                      RRType::AXFR()));
+
+        const RRsetPtr ns(new RRset(zone_name_, RRClass::IN(), RRType::NS(),
+                                    RRTTL(3600)));
+        ns->addRdata(rdata::generic::NS(Name("ns.example.org")));
+        rrsets_.push_back(ns);
+        // The SOA of the zone is skipped (we add it ourselves).
+        rrsets_.push_back(soa_);
+        const RRsetPtr a(new RRset(Name("ns.example.org"), RRClass::IN(),
+                                   RRType::A(), RRTTL(3600)));
+        a->addRdata(rdata::in::A("192.0.2.1"));
+        rrsets_.push_back(a);
+    }
+
+    RRsetPtr createSOA(uint32_t serial) const {
+        const RRsetPtr soa(new RRset(zone_name_, RRClass::IN(), RRType::SOA(),
+                                     RRTTL(3600)));
+        soa->addRdata(rdata::generic::SOA(zone_name_, zone_name_, serial,
+                                          3600, 3600, 3600, 3600));
+        return (soa);
+    }
+
+    // Add many A RRsets of different names, so they don't fit in a
+    // single small message.
+    void addManyRRsets(size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            const RRsetPtr a(new RRset(Name("host" + lexical_cast<string>(i) +
+                                            ".example.org"),
+                                       RRClass::IN(), RRType::A(),
+                                       RRTTL(3600)));
+            a->addRdata(rdata::in::A("192.0.2.2"));
+            rrsets_.push_back(a);
+        }
+    }
+
+    ZoneIteratorPtr createIterator() const {
+        return (ZoneIteratorPtr(new VectorIterator(rrsets_, soa_)));
+    }
+
+    // Sign the request with client_ctx and parse it into request, letting
+    // server_ctx verify it, as in a real exchange.
+    void signRequest(TSIGContext& client_ctx, TSIGContext& server_ctx,
+                     Message& request)
+    {
+        MessageRenderer renderer;
+        request_.toWire(renderer, &client_ctx);
+        InputBuffer ibuffer(renderer.getData(), renderer.getLength());
+        request.fromWire(ibuffer);
+        EXPECT_EQ(TSIGError::NOERROR(),
+                  server_ctx.verify(request.getTSIGRecord(),
+                                    renderer.getData(),
+                                    renderer.getLength()));
+    }
+
+    // Split the buffer into the messages and parse them.  If tsig_ctx is
+    // given, the messages are verified with it, and whether each of them
+    // was signed is recorded.
+    void parseMessages(const OutputBuffer& buffer,
+                       TSIGContext* tsig_ctx = NULL)
+    {
+        InputBuffer ibuffer(buffer.getData(), buffer.getLength());
+        while (ibuffer.getPosition() < ibuffer.getLength()) {
+            const size_t length = ibuffer.readUint16();
+            ASSERT_LE(ibuffer.getPosition() + length, ibuffer.getLength());
+            const uint8_t* data = static_cast<const uint8_t*>(
+                buffer.getData()) + ibuffer.getPosition();
+            InputBuffer message_buffer(data, length);
+            const boost::shared_ptr<Message> message(
+                new Message(Message::PARSE));
+            message->fromWire(message_buffer, Message::PRESERVE_ORDER);
+            if (tsig_ctx != NULL) {
+                EXPECT_EQ(TSIGError::NOERROR(),
+                          tsig_ctx->verify(message->getTSIGRecord(), data,
+                                           length));
+                signed_.push_back(message->getTSIGRecord() != NULL);
+            }
+            ibuffer.setPosition(ibuffer.getPosition() + length);
+            messages_.push_back(message);
+            lengths_.push_back(length);
+        }
+    }
+
+    // Check the common part of the parsed messages, and collect the
+    // RRsets of all of them.
+    void checkMessages(vector<ConstRRsetPtr>& answers) const {
+        ASSERT_FALSE(messages_.empty());
+        for (size_t i = 0; i < messages_.size(); ++i) {
+            const Message& message = *messages_[i];
+            EXPECT_EQ(0x1035, message.getQid());
+            EXPECT_EQ(Opcode::QUERY(), message.getOpcode());
+            EXPECT_EQ(Rcode::NOERROR(), message.getRcode());
+            EXPECT_TRUE(message.getHeaderFlag(Message::HEADERFLAG_QR));
+            EXPECT_TRUE(message.getHeaderFlag(Message::HEADERFLAG_AA));
+            // Only the first message has the question and the preserved
+            // flags.
+            EXPECT_EQ(i == 0, message.getHeaderFlag(Message::HEADERFLAG_RD));
+            EXPECT_EQ(i == 0 ? 1 : 0,
+                      message.getRRCount(Message::SECTION_QUESTION));
+            for (RRsetIterator it =
+                     message.beginSection(Message::SECTION_ANSWER);
+                 it != message.endSection(Message::SECTION_ANSWER);
+                 ++it) {
+                answers.push_back(*it);
+            }
+        }
+        ASSERT_LE(2, answers.size());
+        EXPECT_EQ(RRType::SOA(), answers.front()->getType());
+        EXPECT_EQ(RRType::SOA(), answers.back()->getType());
+    }
+
+    const Name zone_name_;
+    Message request_;
+    const RRsetPtr soa_;
+    vector<ConstRRsetPtr> rrsets_;
+    vector<boost::shared_ptr<Message> > messages_;
+    vector<size_t> lengths_;
+    vector<bool> signed_;
+};
+
+TEST_F(ZoneStreamerTest, axfr) {
+    ZoneStreamer streamer(request_, soa_, createIterator());
+    OutputBuffer buffer(0);
+    EXPECT_FALSE(streamer.fill(buffer, 65535));
+    EXPECT_EQ(1, streamer.getMessageCount());
+    parseMessages(buffer);
+    ASSERT_EQ(1, messages_.size());
+
+    vector<ConstRRsetPtr> answers;
+    checkMessages(answers);
+    // The SOA in the zone is skipped.
+    ASSERT_EQ(4, answers.size());
+    EXPECT_EQ(RRType::NS(), answers[1]->getType());
+    EXPECT_EQ(RRType::A(), answers[2]->getType());
+
+    // Nothing more is appended.
+    const size_t length = buffer.getLength();
+    EXPECT_FALSE(streamer.fill(buffer, 65535));
+    EXPECT_EQ(length, buffer.getLength());
+}
+
+TEST_F(ZoneStreamerTest, multipleMessages) {
+    addManyRRsets(100);
+    ZoneStreamer streamer(request_, soa_, createIterator(), NULL, 512);
+    OutputBuffer buffer(0);
+    EXPECT_FALSE(streamer.fill(buffer, 65535));
+    EXPECT_LT(1, streamer.getMessageCount());
+    parseMessages(buffer);
+    EXPECT_EQ(streamer.getMessageCount(), messages_.size());
+
+    vector<ConstRRsetPtr> answers;
+    checkMessages(answers);
+    // All the RRsets and the two SOAs, and nothing else
+    EXPECT_EQ(rrsets_.size() - 1 + 2, answers.size());
+    for (size_t i = 0; i < lengths_.size(); ++i) {
+        EXPECT_GE(512, lengths_[i]);
+    }
+}
+
+TEST_F(ZoneStreamerTest, sizeLimit) {
+    addManyRRsets(100);
+    ZoneStreamer streamer(request_, soa_, createIterator(), NULL, 512);
+
+    // With a limit smaller than a message, a single message is appended
+    // in each call.
+    OutputBuffer buffer(0);
+    size_t count = 0;
+    bool more = true;
+    while (more) {
+        const size_t length = buffer.getLength();
+        more = streamer.fill(buffer, 1);
+        ++count;
+        ASSERT_LT(length + 2, buffer.getLength());
+        // The length of the single message appended
+        const size_t message_len = (buffer[length] << 8) | buffer[length + 1];
+        EXPECT_EQ(length + 2 + message_len, buffer.getLength());
+    }
+    parseMessages(buffer);
+    EXPECT_EQ(count, messages_.size());
+
+    // With a limit of two (largest) messages, we get at least two messages
+    // in each call except possibly for the last.
+    ZoneStreamer streamer2(request_, soa_, createIterator(), NULL, 512);
+    size_t calls = 0;
+    OutputBuffer buffer2(0);
+    while (true) {
+        const size_t length = buffer2.getLength();
+        const bool more = streamer2.fill(buffer2, length + 2 * (512 + 2));
+        EXPECT_GE(length + 2 * (512 + 2), buffer2.getLength());
+        ++calls;
+        if (!more) {
+            break;
+        }
+    }
+    EXPECT_LT(1, calls);
+    EXPECT_GE((count + 1) / 2, calls);
+    // The result is the same.
+    EXPECT_EQ(buffer.getLength(), buffer2.getLength());
+    EXPECT_EQ(0, memcmp(buffer.getData(), buffer2.getData(),
+                        buffer.getLength()));
+}
+
+TEST_F(ZoneStreamerTest, singleSOA) {
+    // No iterator means the single SOA response.
+    ZoneStreamer streamer(request_, soa_, ZoneIteratorPtr());
+    OutputBuffer buffer(0);
+    EXPECT_FALSE(streamer.fill(buffer, 65535));
+    parseMessages(buffer);
+    ASSERT_EQ(1, messages_.size());
+    EXPECT_EQ(1, messages_[0]->getRRCount(Message::SECTION_QUESTION));
+    EXPECT_EQ(1, messages_[0]->getRRCount(Message::SECTION_ANSWER));
+
+    // Same for the journal reader.
+    ZoneStreamer streamer2(request_, soa_, ZoneJournalReaderPtr());
+    OutputBuffer buffer2(0);
+    EXPECT_FALSE(streamer2.fill(buffer2, 65535));
+    EXPECT_EQ(buffer.getLength(), buffer2.getLength());
+}
+
+TEST_F(ZoneStreamerTest, ixfr) {
+    // The SOAs from the journal reader are kept.
+    vector<ConstRRsetPtr> diffs;
+    diffs.push_back(createSOA(1));
+    diffs.push_back(rrsets_[0]);
+    diffs.push_back(soa_);
+    diffs.push_back(rrsets_[2]);
+    ZoneStreamer streamer(request_, soa_, ZoneJournalReaderPtr(
+                              new VectorJournalReader(diffs)));
+    OutputBuffer buffer(0);
+    EXPECT_FALSE(streamer.fill(buffer, 65535));
+    parseMessages(buffer);
+
+    vector<ConstRRsetPtr> answers;
+    checkMessages(answers);
+    ASSERT_EQ(6, answers.size());
+    EXPECT_EQ(RRType::SOA(), answers[1]->getType());
+    EXPECT_EQ(RRType::NS(), answers[2]->getType());
+    EXPECT_EQ(RRType::SOA(), answers[3]->getType());
+    EXPECT_EQ(RRType::A(), answers[4]->getType());
+}
+
+TEST_F(ZoneStreamerTest, lastSOAInNewMessage) {
+    // Make the message size just enough for the first message without the
+    // trailing SOA, so it goes to a message of its own.
+    const size_t first_len = 12 + zone_name_.getLength() + 4 +
+        soa_->getLength() + rrsets_[0]->getLength() + rrsets_[2]->getLength();
+    ZoneStreamer streamer(request_, soa_, createIterator(), NULL, first_len);
+    OutputBuffer buffer(0);
+    EXPECT_FALSE(streamer.fill(buffer, 65535));
+    parseMessages(buffer);
+    ASSERT_EQ(2, messages_.size());
+    EXPECT_EQ(3, messages_[0]->getRRCount(Message::SECTION_ANSWER));
+    EXPECT_EQ(1, messages_[1]->getRRCount(Message::SECTION_ANSWER));
+
+    vector<ConstRRsetPtr> answers;
+    checkMessages(answers);
+}
+
+TEST_F(ZoneStreamerTest, tooLargeRRset) {
+    const RRsetPtr txt(new RRset(zone_name_, RRClass::IN(), RRType::TXT(),
+                                 RRTTL(3600)));
+    txt->addRdata(rdata::generic::TXT(string(200, 'a')));
+    txt->addRdata(rdata::generic::TXT(string(200, 'b')));
+    txt->addRdata(rdata::generic::TXT(string(200, 'c')));
+    rrsets_.push_back(txt);
+    ZoneStreamer streamer(request_, soa_, createIterator(), NULL, 512);
+    OutputBuffer buffer(0);
+    EXPECT_THROW(streamer.fill(buffer, 65535), RRsetTooLarge);
+    // The message before the large RRset is appended.
+    parseMessages(buffer);
+    EXPECT_EQ(1, messages_.size());
+}
+
+TEST_F(ZoneStreamerTest, tsig) {
+    addManyRRsets(100);
+    const TSIGKey key("example:MSG6Ng==:hmac-md5");
+    TSIGContext client_ctx(key);
+    TSIGContext server_ctx(key);
+    Message request(Message::PARSE);
+    signRequest(client_ctx, server_ctx, request);
+
+    ZoneStreamer streamer(request, soa_, createIterator(), &server_ctx, 512);
+    OutputBuffer buffer(0);
+    EXPECT_FALSE(streamer.fill(buffer, 65535));
+    parseMessages(buffer, &client_ctx);
+    EXPECT_LT(1, messages_.size());
+    EXPECT_TRUE(client_ctx.lastHadSignature());
+
+    // By default every message is signed.
+    ASSERT_EQ(messages_.size(), signed_.size());
+    for (size_t i = 0; i < signed_.size(); ++i) {
+        EXPECT_TRUE(signed_[i]) << i;
+    }
+
+    vector<ConstRRsetPtr> answers;
+    checkMessages(answers);
+    EXPECT_EQ(rrsets_.size() - 1 + 2, answers.size());
+}
+
+TEST_F(ZoneStreamerTest, tsigSparse) {
+    addManyRRsets(100);
+    const TSIGKey key("example:MSG6Ng==:hmac-md5");
+    TSIGContext client_ctx(key);
+    TSIGContext server_ctx(key);
+    Message request(Message::PARSE);
+    signRequest(client_ctx, server_ctx, request);
+
+    ZoneStreamer streamer(request, soa_, createIterator(), &server_ctx, 512);
+    streamer.setSparseSigning(true);
+    OutputBuffer buffer(0);
+    EXPECT_FALSE(streamer.fill(buffer, 65535));
+    parseMessages(buffer, &client_ctx);
+    EXPECT_LT(1, messages_.size());
+    EXPECT_TRUE(client_ctx.lastHadSignature());
+
+    // Only the first and the last message are signed.
+    ASSERT_EQ(messages_.size(), signed_.size());
+    for (size_t i = 0; i < signed_.size(); ++i) {
+        EXPECT_EQ(i == 0 || i == signed_.size() - 1, signed_[i]) << i;
+    }
+
+    vector<ConstRRsetPtr> answers;
+    checkMessages(answers);
+    EXPECT_EQ(rrsets_.size() - 1 + 2, answers.size());
+}
+
+// With more than 100 messages, every 100th of them is signed, so there are
+// never more unsigned messages in a row than RFC2845 allows.
+TEST_F(ZoneStreamerTest, tsigManyMessages) {
+    addManyRRsets(2000);
+    const TSIGKey key("example:MSG6Ng==:hmac-md5");
+    TSIGContext client_ctx(key);
+    TSIGContext server_ctx(key);
+    Message request(Message::PARSE);
+    signRequest(client_ctx, server_ctx, request);
+
+    ZoneStreamer streamer(request, soa_, createIterator(), &server_ctx, 512);
+    streamer.setSparseSigning(true);
+    OutputBuffer buffer(0);
+    while (streamer.fill(buffer, 65535)) {
+        parseMessages(buffer, &client_ctx);
+        buffer.clear();
+    }
+    parseMessages(buffer, &client_ctx);
+    EXPECT_TRUE(client_ctx.lastHadSignature());
+
+    ASSERT_LT(TSIGContext::MAX_UNSIGNED_MESSAGES + 2, signed_.size());
+    for (size_t i = 0; i < signed_.size(); ++i) {
+        EXPECT_EQ(i % (TSIGContext::MAX_UNSIGNED_MESSAGES + 1) == 0 ||
+                  i == signed_.size() - 1, signed_[i]) << i;
+    }
+
+    vector<ConstRRsetPtr> answers;
+    checkMessages(answers);
+    EXPECT_EQ(rrsets_.size() - 1 + 2, answers.size());
+}
+
+TEST_F(ZoneStreamerTest, badParameters) {
+    EXPECT_THROW(ZoneStreamer(request_, ConstRRsetPtr(), createIterator()),
+                 bundy::InvalidParameter);
+    EXPECT_THROW(ZoneStreamer(request_, soa_, createIterator(), NULL, 65536),
+                 bundy::InvalidParameter);
+    request_.clearSection(Message::SECTION_QUESTION);
+    EXPECT_THROW(ZoneStreamer(request_, soa_, createIterator()),
+                 bundy::InvalidParameter);
+}
+
+}
@@ -0,0 +1,296 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <datasrc/zone_streamer.h>
+#include <datasrc/zone_iterator.h>
+
+#include <dns/messagerenderer.h>
+#include <dns/opcode.h>
+#include <dns/rcode.h>
+#include <dns/rrtype.h>
+#include <dns/question.h>
+#include <dns/tsig.h>
+#include <dns/tsigerror.h>
+
+#include <util/buffer.h>
+#include <exceptions/exceptions.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+using namespace bundy::dns;
+using bundy::util::OutputBuffer;
+
+namespace bundy {
+namespace datasrc {
+
+namespace {
+// The size of the fixed length DNS header (protocol constant)
+const size_t HEADER_SIZE = 12;
+}
+
+// Definition of class static constant so it can be referenced by address
+// or reference.
+const size_t ZoneStreamer::DEFAULT_MAX_MESSAGE_SIZE;
+
+struct ZoneStreamer::Impl {
+    Impl(const Message& request, ConstRRsetPtr soa, ZoneIteratorPtr iterator,
+         ZoneJournalReaderPtr reader, TSIGContext* tsig_ctx,
+         size_t max_message_size);
+
+    // Get the next RRset to be sent (other than the SOAs we add ourselves)
+    ConstRRsetPtr getNextRRset();
+
+    // Render the next message into the renderer.
+    void renderMessage();
+
+    // Add an RRset to the answer section of msg_.
+    void addRRset(const ConstRRsetPtr& rrset) {
+        // The message doesn't modify the RRset, it just needs a non const
+        // pointer.
+        msg_.addRRset(Message::SECTION_ANSWER,
+                      boost::const_pointer_cast<AbstractRRset>(rrset));
+    }
+
+    // Prepare msg_ for the next message.
+    void clearMessage();
+
+    const qid_t qid_;
+    const Opcode opcode_;
+    const bool rd_;
+    const bool cd_;
+    std::vector<QuestionPtr> questions_;
+    const ConstRRsetPtr soa_;
+    const ZoneIteratorPtr iterator_;
+    const ZoneJournalReaderPtr reader_;
+    TSIGContext* const tsig_ctx_;
+    const size_t max_message_size_;
+    const size_t tsig_len_;
+    bool sparse_signing_;
+
+    Message msg_;
+    MessageRenderer renderer_;
+    bool rendered_;        // the renderer holds a message not yet appended
+    size_t message_count_;
+    int unsigned_count_;   // messages digested since the last signed one
+    bool first_sent_;      // the first message (with the question) is done
+    bool last_soa_needed_; // all RRsets are done, the trailing SOA isn't
+    bool complete_;        // the last message is rendered
+    ConstRRsetPtr pending_; // RRset carried over to the next message
+};
+
+ZoneStreamer::Impl::Impl(const Message& request, ConstRRsetPtr soa,
+                         ZoneIteratorPtr iterator, ZoneJournalReaderPtr reader,
+                         TSIGContext* tsig_ctx, size_t max_message_size) :
+    qid_(request.getQid()),
+    opcode_(request.getOpcode()),
+    rd_(request.getHeaderFlag(Message::HEADERFLAG_RD)),
+    cd_(request.getHeaderFlag(Message::HEADERFLAG_CD)),
+    soa_(soa),
+    iterator_(iterator),
+    reader_(reader),
+    tsig_ctx_(tsig_ctx),
+    max_message_size_(max_message_size),
+    tsig_len_(tsig_ctx != NULL ? tsig_ctx->getTSIGLength() : 0),
+    sparse_signing_(false),
+    msg_(Message::RENDER),
+    rendered_(false),
+    message_count_(0),
+    unsigned_count_(0),
+    first_sent_(false),
+    // Without the iterator or the reader, the response is the single SOA.
+    last_soa_needed_(!iterator && !reader),
+    complete_(false)
+{
+    if (!soa_) {
+        bundy_throw(InvalidParameter, "NULL SOA for zone transfer");
+    }
+    for (QuestionIterator it = request.beginQuestion();
+         it != request.endQuestion();
+         ++it) {
+        questions_.push_back(*it);
+    }
+    if (questions_.empty()) {
+        bundy_throw(InvalidParameter,
+                    "zone transfer request without a question");
+    }
+    if (max_message_size_ > DEFAULT_MAX_MESSAGE_SIZE) {
+        bundy_throw(InvalidParameter, "zone transfer message size too large: "
+                    << max_message_size_);
+    }
+}
+
+ConstRRsetPtr
+ZoneStreamer::Impl::getNextRRset() {
+    if (reader_) {
+        return (reader_->getNextDiff());
+    }
+    while (true) {
+        ConstRRsetPtr rrset = iterator_->getNextRRset();
+        // For AXFR we add the SOAs ourselves, so skip the ones in the zone.
+        if (!rrset || rrset->getType() != RRType::SOA()) {
+            return (rrset);
+        }
+    }
+}
+
+void
+ZoneStreamer::Impl::clearMessage() {
+    msg_.clear(Message::RENDER);
+    msg_.setQid(qid_);
+    msg_.setOpcode(opcode_);
+    msg_.setRcode(Rcode::NOERROR());
+    msg_.setHeaderFlag(Message::HEADERFLAG_QR);
+    msg_.setHeaderFlag(Message::HEADERFLAG_AA);
+}
+
+void
+ZoneStreamer::Impl::renderMessage() {
+    clearMessage();
+
+    // We keep track of the size of the message without compression (plus
+    // TSIG, if it's signed), so we know for sure it fits.
+    size_t message_len = HEADER_SIZE + tsig_len_;
+    if (!first_sent_) {
+        // The first message echoes the question, and starts with the SOA.
+        msg_.setHeaderFlag(Message::HEADERFLAG_RD, rd_);
+        msg_.setHeaderFlag(Message::HEADERFLAG_CD, cd_);
+        for (std::vector<QuestionPtr>::const_iterator it = questions_.begin();
+             it != questions_.end();
+             ++it) {
+            msg_.addQuestion(*it);
+            // The size of the qname and the type and class (2 bytes each)
+            message_len += (*it)->getName().getLength() + 4;
+        }
+        if (!last_soa_needed_) {
+            addRRset(soa_);
+            message_len += soa_->getLength();
+        }
+        first_sent_ = true;
+    }
+
+    while (!last_soa_needed_) {
+        ConstRRsetPtr rrset = pending_;
+        pending_.reset();
+        if (!rrset) {
+            rrset = getNextRRset();
+        }
+        if (!rrset) {
+            last_soa_needed_ = true;
+            break;
+        }
+
+        const size_t rrset_len = rrset->getLength();
+        if (message_len + rrset_len <= max_message_size_) {
+            addRRset(rrset);
+            message_len += rrset_len;
+            continue;
+        }
+
+        // The RRset doesn't fit.  If the message is empty, it won't fit in
+        // any message.  In theory some RRsets might fit when compressed,
+        // but surely we don't want to send such monstrosities.
+        if (msg_.getRRCount(Message::SECTION_ANSWER) == 0) {
+            bundy_throw(RRsetTooLarge, "RR too large for zone transfer ("
+                        << rrset_len << " bytes)");
+        }
+        // Otherwise send what we have, and leave it to the next message.
+        pending_ = rrset;
+        break;
+    }
+
+    // Add the trailing SOA if everything else is done, unless it makes the
+    // message too large (then it's sent in a message of its own).  We assume
+    // a message with just the SOA always fits.
+    if (last_soa_needed_ &&
+        (msg_.getRRCount(Message::SECTION_ANSWER) == 0 ||
+         message_len + soa_->getLength() <= max_message_size_)) {
+        addRRset(soa_);
+        complete_ = true;
+    }
+
+    renderer_.clear();
+    // As defined in RFC5936 section 3.4, perform case-preserving name
+    // compression for the response.
+    renderer_.setCompressMode(MessageRenderer::CASE_SENSITIVE);
+    renderer_.setLengthLimit(max_message_size_);
+    // With sparse signing, sign the first message (the context can't digest
+    // unsigned ones before that), the last one, and every
+    // (MAX_UNSIGNED_MESSAGES + 1)th one, as allowed by RFC2845 section 4.4.
+    // The others are rendered without TSIG and only digested.
+    if (tsig_ctx_ != NULL && sparse_signing_ && message_count_ > 0 &&
+        !complete_ &&
+        tsig_ctx_->getError() == TSIGError::NOERROR() &&
+        unsigned_count_ < TSIGContext::MAX_UNSIGNED_MESSAGES) {
+        msg_.toWire(renderer_);
+        tsig_ctx_->digestUnsigned(renderer_.getData(), renderer_.getLength());
+        ++unsigned_count_;
+    } else {
+        msg_.toWire(renderer_, tsig_ctx_);
+        unsigned_count_ = 0;
+    }
+    rendered_ = true;
+    ++message_count_;
+}
+
+ZoneStreamer::ZoneStreamer(const Message& request, ConstRRsetPtr soa,
+                           ZoneIteratorPtr iterator, TSIGContext* tsig_ctx,
+                           size_t max_message_size) :
+    impl_(new Impl(request, soa, iterator, ZoneJournalReaderPtr(), tsig_ctx,
+                   max_message_size))
+{}
+
+ZoneStreamer::ZoneStreamer(const Message& request, ConstRRsetPtr soa,
+                           ZoneJournalReaderPtr reader, TSIGContext* tsig_ctx,
+                           size_t max_message_size) :
+    impl_(new Impl(request, soa, ZoneIteratorPtr(), reader, tsig_ctx,
+                   max_message_size))
+{}
+
+ZoneStreamer::~ZoneStreamer() {
+    delete impl_;
+}
+
+bool
+ZoneStreamer::fill(OutputBuffer& buffer, size_t size_limit) {
+    bool appended = false;
+    while (impl_->rendered_ || !impl_->complete_) {
+        if (!impl_->rendered_) {
+            impl_->renderMessage();
+        }
+        const size_t length = impl_->renderer_.getLength();
+        if (appended && buffer.getLength() + 2 + length > size_limit) {
+            break;
+        }
+        buffer.writeUint16(length);
+        buffer.writeData(impl_->renderer_.getData(), length);
+        impl_->rendered_ = false;
+        appended = true;
+    }
+    return (impl_->rendered_ || !impl_->complete_);
+}
+
+void
+ZoneStreamer::setSparseSigning(bool sparse) {
+    impl_->sparse_signing_ = sparse;
+}
+
+size_t
+ZoneStreamer::getMessageCount() const {
+    return (impl_->message_count_);
+}
+
+} // namespace datasrc
+} // namespace bundy
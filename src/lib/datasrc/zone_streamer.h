@@ -0,0 +1,187 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef DATASRC_ZONE_STREAMER_H
+#define DATASRC_ZONE_STREAMER_H 1
+
+#include <datasrc/exceptions.h>
+#include <datasrc/zone.h>
+
+#include <dns/message.h>
+#include <dns/rrset.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <cstdlib> // For size_t
+
+namespace bundy {
+namespace util {
+class OutputBuffer;
+}
+namespace dns {
+class TSIGContext;
+}
+namespace datasrc {
+
+// Forward declarations
+class ZoneIterator;
+typedef boost::shared_ptr<ZoneIterator> ZoneIteratorPtr;
+
+/// \brief Exception thrown when an RRset can't be sent in a zone transfer.
+///
+/// This is thrown by the ZoneStreamer when an RRset doesn't fit in a
+/// single response message by itself.
+class RRsetTooLarge : public DataSourceError {
+public:
+    RRsetTooLarge(const char* file, size_t line, const char* what) :
+        DataSourceError(file, line, what)
+    {}
+};
+
+/// \brief Builds the wire-format response messages of a zone transfer.
+///
+/// This class renders the whole sequence of DNS messages that answer an
+/// AXFR or IXFR request: the leading SOA, the RRsets of the zone (for AXFR)
+/// or of the diffs (for IXFR), and the trailing SOA.  As many RRsets as
+/// possible are packed into each message (with case-sensitive name
+/// compression, as required by RFC5936).  If a TSIG context is given, each
+/// message is signed with it by default; see \c setSparseSigning() for
+/// signing only some of them.
+///
+/// The messages are appended to a caller supplied buffer in the TCP format,
+/// i.e., each preceded by its length as a 16-bit integer, a number of them
+/// at a time, so the caller can send each chunk in a single write without
+/// handling the individual RRsets or messages.
+///
+/// The data are read from a \c ZoneIterator or a \c ZoneJournalReader
+/// (for the in-memory data source the iterator renders the RRsets directly
+/// from the zone data).  The object holds the iterator or the reader until
+/// it's destroyed.
+class ZoneStreamer : boost::noncopyable {
+public:
+    /// \brief The default (and largest) size of a response message.
+    static const size_t DEFAULT_MAX_MESSAGE_SIZE = 65535;
+
+    /// \brief Constructor for an AXFR (or AXFR-style IXFR) response.
+    ///
+    /// The SOA RRsets returned by the iterator are skipped; \c soa is
+    /// placed at the beginning and the end of the response instead.
+    ///
+    /// If \c iterator is NULL, the response consists of a single \c soa
+    /// (which is the IXFR response when the requester is up to date).
+    ///
+    /// The query ID, opcode, question and the RD and CD flags of the
+    /// response are taken from \c request; the request doesn't have to
+    /// be kept after the construction.  If \c tsig_ctx is non NULL, it must
+    /// be valid during the lifetime of this object, and it's used to sign
+    /// the messages (and digest the ones sent without TSIG); it must have
+    /// verified the request.
+    ///
+    /// \throw bundy::InvalidParameter soa is NULL, the request doesn't have
+    /// a question or max_message_size is larger than
+    /// \c DEFAULT_MAX_MESSAGE_SIZE.
+    ///
+    /// \param request The transfer request.
+    /// \param soa The SOA RRset of the zone (version) to transfer.
+    /// \param iterator The iterator of the zone, or NULL.
+    /// \param tsig_ctx The TSIG context to sign the messages with, or NULL.
+    /// \param max_message_size The largest size of a message.
+    ZoneStreamer(const dns::Message& request, dns::ConstRRsetPtr soa,
+                 ZoneIteratorPtr iterator, dns::TSIGContext* tsig_ctx = NULL,
+                 size_t max_message_size = DEFAULT_MAX_MESSAGE_SIZE);
+
+    /// \brief Constructor for an IXFR response.
+    ///
+    /// All the RRsets returned by the reader are included in the response,
+    /// including the SOAs that delimit the diffs.  If \c reader is NULL,
+    /// the response consists of a single \c soa.
+    ///
+    /// The other parameters are the same as for the AXFR constructor.
+    ///
+    /// \throw bundy::InvalidParameter see the AXFR constructor.
+    ZoneStreamer(const dns::Message& request, dns::ConstRRsetPtr soa,
+                 ZoneJournalReaderPtr reader,
+                 dns::TSIGContext* tsig_ctx = NULL,
+                 size_t max_message_size = DEFAULT_MAX_MESSAGE_SIZE);
+
+    /// \brief Destructor.
+    ~ZoneStreamer();
+
+    /// \brief Append the next messages of the response to a buffer.
+    ///
+    /// This renders messages and appends them to \c buffer, each preceded
+    /// by its length, as long as the total length of the buffer doesn't
+    /// exceed \c size_limit (the message that would exceed it is kept for
+    /// the next call).  At least one message is appended in each call
+    /// unless the response is complete, so the size limit can be smaller
+    /// than a single message.
+    ///
+    /// Call this repeatedly until it returns \c false.  After that, it
+    /// doesn't append anything any more.
+    ///
+    /// If the iterator or the reader throws, or an RRset is too large for a
+    /// message, the exception is propagated; the response can't be
+    /// continued after that.  The messages already appended to the buffer
+    /// are valid though (but the response is incomplete).
+    ///
+    /// \throw RRsetTooLarge An RRset doesn't fit in a message by itself.
+    /// \throw DataSourceError and others, from the iterator or the reader.
+    ///
+    /// \param buffer The buffer to append the messages to.
+    /// \param size_limit The length of the buffer this shouldn't exceed.
+    /// \return true if there are more messages to append; false if the
+    /// response is complete.
+    bool fill(util::OutputBuffer& buffer, size_t size_limit);
+
+    /// \brief Sign only some of the messages with TSIG.
+    ///
+    /// If enabled, only the first and the last message are signed, and so
+    /// is every 100th message in between (see
+    /// \c dns::TSIGContext::MAX_UNSIGNED_MESSAGES), as RFC2845 section 4.4
+    /// allows.  The other messages are sent without TSIG and only digested,
+    /// which saves the calculation of their MACs.  The client must support
+    /// verifying such a sequence, so this is disabled by default and every
+    /// message is signed.  It has no effect without a TSIG context.
+    ///
+    /// This should be called before the first \c fill() call; a change
+    /// only affects the messages rendered after it.
+    ///
+    /// \throw None
+    ///
+    /// \param sparse Whether to sign only some of the messages.
+    void setSparseSigning(bool sparse);
+
+    /// \brief Return the number of messages rendered so far.
+    ///
+    /// This includes a message that was rendered but kept for the next
+    /// \c fill() call.
+    ///
+    /// \throw None
+    size_t getMessageCount() const;
+
+private:
+    // We hide details as the class uses the message rendering internals.
+    struct Impl;
+    Impl* impl_;
+};
+
+} // namespace datasrc
+} // namespace bundy
+
+#endif // DATASRC_ZONE_STREAMER_H
+
+// Local Variables:
+// mode: c++
+// End:
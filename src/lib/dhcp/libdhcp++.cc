@@ -216,10 +216,9 @@ size_t LibDHCP::unpackOptions6(const OptionBuffer& buf,
     size_t length = buf.size();
 
     // Get the list of standard option definitions.
-    OptionDefContainer option_defs;
-    if (option_space == "dhcp6") {
-        option_defs = LibDHCP::getOptionDefs(Option::V6);
-    }
+    static const OptionDefContainer no_option_defs;
+    const OptionDefContainer& option_defs = (option_space == "dhcp6" ?
+        LibDHCP::getOptionDefs(Option::V6) : no_option_defs);
     // @todo Once we implement other option spaces we should add else clause
     // here and gather option definitions for them. For now leaving option_defs
     // empty will imply creation of generic Option.
@@ -316,10 +315,9 @@ size_t LibDHCP::unpackOptions4(const OptionBuffer& buf,
     size_t offset = 0;
 
     // Get the list of stdandard option definitions.
-    OptionDefContainer option_defs;
-    if (option_space == "dhcp4") {
-        option_defs = LibDHCP::getOptionDefs(Option::V4);
-    }
+    static const OptionDefContainer no_option_defs;
+    const OptionDefContainer& option_defs = (option_space == "dhcp4" ?
+        LibDHCP::getOptionDefs(Option::V4) : no_option_defs);
     // @todo Once we implement other option spaces we should add else clause
     // here and gather option definitions for them. For now leaving option_defs
     // empty will imply creation of generic Option.
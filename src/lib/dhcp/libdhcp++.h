@@ -116,7 +116,10 @@ public:
     /// @brief Parses provided buffer as DHCPv4 options and creates Option objects.
     ///
     /// Parses provided buffer and stores created Option objects
-    /// in options container.
+    /// in options container. The option definitions are referenced
+    /// rather than copied, as this is called for every packet. The same
+    /// applies to @c unpackOptions6 and to the servers' own option
+    /// unpacking callbacks.
     ///
     /// @param buf Buffer to be parsed.
     /// @param option_space A name of the option space which holds definitions
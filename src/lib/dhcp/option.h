@@ -15,6 +15,7 @@
 #ifndef OPTION_H
 #define OPTION_H
 
+#include <dhcp/option_collection.h>
 #include <util/buffer.h>
 
 #include <boost/function.hpp>
@@ -41,13 +42,6 @@ typedef OptionBuffer::const_iterator OptionBufferConstIter;
 /// pointer to a DHCP buffer
 typedef boost::shared_ptr<OptionBuffer> OptionBufferPtr;
 
-/// shared pointer to Option object
-class Option;
-typedef boost::shared_ptr<Option> OptionPtr;
-
-/// A collection of DHCP (v4 or v6) options
-typedef std::multimap<unsigned int, OptionPtr> OptionCollection;
-
 /// @brief This type describes a callback function to parse options from buffer.
 ///
 /// @note The last two parameters should be specified in the callback function
@@ -0,0 +1,269 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcp/option_collection.h>
+
+#include <algorithm>
+#include <new>
+
+namespace bundy {
+namespace dhcp {
+
+namespace {
+
+/// Type of the element stored in the collection.
+typedef OptionCollection::value_type Element;
+
+/// @brief Orders the elements of the collection by the option code.
+struct CodeLess {
+    bool operator()(const Element& element,
+                    const OptionCollection::key_type code) const {
+        return (element.first < code);
+    }
+    bool operator()(const OptionCollection::key_type code,
+                    const Element& element) const {
+        return (code < element.first);
+    }
+};
+
+/// @brief Moves the element from @c src to uninitialized memory at @c dst.
+///
+/// The option pointer is swapped rather than copied, which avoids touching
+/// the reference counter. The source element is destroyed.
+void
+relocate(Element* dst, Element* src) {
+    new (dst) Element(src->first, OptionPtr());
+    dst->second.swap(src->second);
+    src->~Element();
+}
+
+/// @brief Moves the element from @c src to the constructed element @c dst.
+void
+moveAssign(Element* dst, Element* src) {
+    dst->first = src->first;
+    dst->second.swap(src->second);
+}
+
+}
+
+const OptionCollection::size_type OptionCollection::INLINE_CAPACITY;
+
+OptionCollection::OptionCollection() :
+    data_(inlineData()), size_(0), capacity_(INLINE_CAPACITY) {
+}
+
+OptionCollection::OptionCollection(const OptionCollection& other) :
+    data_(inlineData()), size_(0), capacity_(INLINE_CAPACITY) {
+    reserve(other.size_);
+    for (size_type i = 0; i < other.size_; ++i) {
+        new (data_ + i) value_type(other.data_[i]);
+        // Keep the size up to date, so as the destructor releases what
+        // was constructed if the copy throws.
+        ++size_;
+    }
+}
+
+OptionCollection::~OptionCollection() {
+    clear();
+    if (!isInline()) {
+        ::operator delete(data_);
+    }
+}
+
+OptionCollection&
+OptionCollection::operator=(const OptionCollection& other) {
+    if (this != &other) {
+        OptionCollection tmp(other);
+        swap(tmp);
+    }
+    return (*this);
+}
+
+void
+OptionCollection::reserve(size_type n) {
+    if (n <= capacity_) {
+        return;
+    }
+    value_type* storage =
+        static_cast<value_type*>(::operator new(n * sizeof(value_type)));
+    for (size_type i = 0; i < size_; ++i) {
+        relocate(storage + i, data_ + i);
+    }
+    if (!isInline()) {
+        ::operator delete(data_);
+    }
+    data_ = storage;
+    capacity_ = n;
+}
+
+void
+OptionCollection::clear() {
+    for (size_type i = 0; i < size_; ++i) {
+        data_[i].~value_type();
+    }
+    size_ = 0;
+}
+
+OptionCollection::iterator
+OptionCollection::insertOption(const key_type code, const OptionPtr& option) {
+    // Copy the pointer before anything is moved, in case it refers to an
+    // element of this collection.
+    const OptionPtr option_copy(option);
+    size_type index = upper_bound(code) - data_;
+    if (size_ == capacity_) {
+        reserve(2 * capacity_);
+    }
+    if (index == size_) {
+        new (data_ + size_) value_type(code, option_copy);
+    } else {
+        // Shift the tail of the collection right by one element.
+        relocate(data_ + size_, data_ + size_ - 1);
+        new (data_ + size_ - 1) value_type(0, OptionPtr());
+        for (size_type i = size_ - 1; i > index; --i) {
+            moveAssign(data_ + i, data_ + i - 1);
+        }
+        data_[index].first = code;
+        data_[index].second = option_copy;
+    }
+    ++size_;
+    return (data_ + index);
+}
+
+OptionCollection::iterator
+OptionCollection::erase(iterator position) {
+    return (erase(position, position + 1));
+}
+
+OptionCollection::iterator
+OptionCollection::erase(iterator first, iterator last) {
+    if (first == last) {
+        return (first);
+    }
+    iterator dst = first;
+    for (iterator src = last; src != end(); ++src, ++dst) {
+        moveAssign(dst, src);
+    }
+    for (iterator it = dst; it != end(); ++it) {
+        it->~value_type();
+    }
+    size_ = dst - data_;
+    return (first);
+}
+
+OptionCollection::size_type
+OptionCollection::erase(const key_type& code) {
+    std::pair<iterator, iterator> range = equal_range(code);
+    const size_type erased = range.second - range.first;
+    erase(range.first, range.second);
+    return (erased);
+}
+
+void
+OptionCollection::swap(OptionCollection& other) {
+    if (!isInline() && !other.isInline()) {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        return;
+    }
+    // At least one of the collections keeps its elements in the internal
+    // storage, which can't be exchanged by swapping the pointers. Move the
+    // elements through a temporary collection instead.
+    OptionCollection tmp;
+    tmp.reserve(size_);
+    for (size_type i = 0; i < size_; ++i) {
+        relocate(tmp.data_ + i, data_ + i);
+    }
+    tmp.size_ = size_;
+    size_ = 0;
+
+    reserve(other.size_);
+    for (size_type i = 0; i < other.size_; ++i) {
+        relocate(data_ + i, other.data_ + i);
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+
+    other.reserve(tmp.size_);
+    for (size_type i = 0; i < tmp.size_; ++i) {
+        relocate(other.data_ + i, tmp.data_ + i);
+    }
+    other.size_ = tmp.size_;
+    tmp.size_ = 0;
+}
+
+OptionCollection::iterator
+OptionCollection::find(const key_type& code) {
+    iterator it = lower_bound(code);
+    return ((it != end() && it->first == code) ? it : end());
+}
+
+OptionCollection::const_iterator
+OptionCollection::find(const key_type& code) const {
+    const_iterator it = lower_bound(code);
+    return ((it != end() && it->first == code) ? it : end());
+}
+
+OptionCollection::size_type
+OptionCollection::count(const key_type& code) const {
+    std::pair<const_iterator, const_iterator> range = equal_range(code);
+    return (range.second - range.first);
+}
+
+OptionCollection::iterator
+OptionCollection::lower_bound(const key_type& code) {
+    return (std::lower_bound(begin(), end(), code, CodeLess()));
+}
+
+OptionCollection::const_iterator
+OptionCollection::lower_bound(const key_type& code) const {
+    return (std::lower_bound(begin(), end(), code, CodeLess()));
+}
+
+OptionCollection::iterator
+OptionCollection::upper_bound(const key_type& code) {
+    return (std::upper_bound(begin(), end(), code, CodeLess()));
+}
+
+OptionCollection::const_iterator
+OptionCollection::upper_bound(const key_type& code) const {
+    return (std::upper_bound(begin(), end(), code, CodeLess()));
+}
+
+std::pair<OptionCollection::iterator, OptionCollection::iterator>
+OptionCollection::equal_range(const key_type& code) {
+    return (std::equal_range(begin(), end(), code, CodeLess()));
+}
+
+std::pair<OptionCollection::const_iterator, OptionCollection::const_iterator>
+OptionCollection::equal_range(const key_type& code) const {
+    return (std::equal_range(begin(), end(), code, CodeLess()));
+}
+
+bool
+operator==(const OptionCollection& a, const OptionCollection& b) {
+    if (a.size() != b.size()) {
+        return (false);
+    }
+    for (OptionCollection::const_iterator ita = a.begin(), itb = b.begin();
+         ita != a.end(); ++ita, ++itb) {
+        if ((ita->first != itb->first) || (ita->second != itb->second)) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+} // end of namespace bundy::dhcp
+} // end of namespace bundy
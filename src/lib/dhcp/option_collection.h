@@ -0,0 +1,264 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef OPTION_COLLECTION_H
+#define OPTION_COLLECTION_H
+
+#include <boost/shared_ptr.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+namespace bundy {
+namespace dhcp {
+
+/// shared pointer to Option object
+class Option;
+typedef boost::shared_ptr<Option> OptionPtr;
+
+/// @brief A collection of DHCP (v4 or v6) options.
+///
+/// This container used to be a @c std::multimap<unsigned int, OptionPtr>.
+/// A typical DHCP message or option carries only a handful of options, so
+/// allocating a tree node for each of them on every packet parsed or built
+/// was a significant part of the packet processing cost. This class stores
+/// the (code, option) pairs in a flat array, sorted by the option code, and
+/// keeps the first @c INLINE_CAPACITY of them inside the object itself, so
+/// that most collections never touch the heap.
+///
+/// The class mimics the subset of the @c std::multimap interface which is
+/// used by the DHCP code: the elements are ordered by the option code and
+/// the options having the same code are kept in the order of insertion.
+/// The iterators dereference to @c std::pair objects, so the existing code
+/// walking over the collection with @c it->first and @c it->second works
+/// unchanged.
+///
+/// @note Unlike @c std::multimap, inserting or erasing an element
+/// invalidates all iterators pointing to the elements which follow it.
+/// The DHCP code never modifies the collection while iterating over it.
+class OptionCollection {
+public:
+    /// Type of the key, i.e. the option code.
+    typedef unsigned int key_type;
+
+    /// Type of the mapped value.
+    typedef OptionPtr mapped_type;
+
+    /// Type of the stored element.
+    typedef std::pair<unsigned int, OptionPtr> value_type;
+
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef value_type& reference;
+    typedef const value_type& const_reference;
+    typedef value_type* pointer;
+    typedef const value_type* const_pointer;
+    typedef value_type* iterator;
+    typedef const value_type* const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    /// Number of elements held without a heap allocation.
+    static const size_type INLINE_CAPACITY = 4;
+
+    /// @brief Constructor.
+    ///
+    /// Creates an empty collection which uses its internal storage.
+    OptionCollection();
+
+    /// @brief Copy constructor.
+    OptionCollection(const OptionCollection& other);
+
+    /// @brief Constructor from a range of (code, option) pairs.
+    ///
+    /// @param first Iterator pointing to the first pair to be copied.
+    /// @param last Iterator pointing past the last pair to be copied.
+    template<typename InputIterator>
+    OptionCollection(InputIterator first, InputIterator last) :
+        data_(inlineData()), size_(0), capacity_(INLINE_CAPACITY) {
+        insert(first, last);
+    }
+
+    /// @brief Destructor.
+    ~OptionCollection();
+
+    /// @brief Assignment operator.
+    OptionCollection& operator=(const OptionCollection& other);
+
+    /// @name Iterators
+    //@{
+    iterator begin() { return (data_); }
+    const_iterator begin() const { return (data_); }
+    iterator end() { return (data_ + size_); }
+    const_iterator end() const { return (data_ + size_); }
+    reverse_iterator rbegin() { return (reverse_iterator(end())); }
+    const_reverse_iterator rbegin() const {
+        return (const_reverse_iterator(end()));
+    }
+    reverse_iterator rend() { return (reverse_iterator(begin())); }
+    const_reverse_iterator rend() const {
+        return (const_reverse_iterator(begin()));
+    }
+    //@}
+
+    /// @brief Returns the number of options in the collection.
+    size_type size() const {
+        return (size_);
+    }
+
+    /// @brief Checks if the collection is empty.
+    bool empty() const {
+        return (size_ == 0);
+    }
+
+    /// @brief Returns the number of elements which can be held without
+    /// reallocating the storage.
+    size_type capacity() const {
+        return (capacity_);
+    }
+
+    /// @brief Makes sure that at least @c n elements fit in the storage.
+    ///
+    /// @param n Requested capacity.
+    void reserve(size_type n);
+
+    /// @brief Removes all options from the collection.
+    ///
+    /// The storage is retained, so that the collection can be refilled
+    /// without allocating memory again.
+    void clear();
+
+    /// @brief Inserts an option.
+    ///
+    /// The option is placed after all options having the same code, which
+    /// is the behavior of @c std::multimap::insert.
+    ///
+    /// This is a template so as the pair created with @c std::make_pair
+    /// with a derived option pointer or with a narrower integer type as a
+    /// code can be passed directly.
+    ///
+    /// @param value A pair holding option code and the option.
+    ///
+    /// @return Iterator pointing to the inserted element.
+    template<typename Key, typename Value>
+    iterator insert(const std::pair<Key, Value>& value) {
+        return (insertOption(value.first, value.second));
+    }
+
+    /// @brief Inserts an option, ignoring the position hint.
+    ///
+    /// Provided for compatibility with @c std::multimap.
+    template<typename Key, typename Value>
+    iterator insert(iterator, const std::pair<Key, Value>& value) {
+        return (insertOption(value.first, value.second));
+    }
+
+    /// @brief Inserts options from a range of (code, option) pairs.
+    template<typename InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        for (; first != last; ++first) {
+            insertOption(first->first, first->second);
+        }
+    }
+
+    /// @brief Removes an option pointed to by the iterator.
+    ///
+    /// @return Iterator pointing to the element following the erased one.
+    iterator erase(iterator position);
+
+    /// @brief Removes a range of options.
+    ///
+    /// @return Iterator pointing to the element following the erased ones.
+    iterator erase(iterator first, iterator last);
+
+    /// @brief Removes all options having the specified code.
+    ///
+    /// @return Number of removed options.
+    size_type erase(const key_type& code);
+
+    /// @brief Swaps the contents of two collections.
+    void swap(OptionCollection& other);
+
+    /// @name Lookup
+    ///
+    /// The semantics of these functions are the same as of their
+    /// @c std::multimap counterparts.
+    //@{
+    iterator find(const key_type& code);
+    const_iterator find(const key_type& code) const;
+    size_type count(const key_type& code) const;
+    iterator lower_bound(const key_type& code);
+    const_iterator lower_bound(const key_type& code) const;
+    iterator upper_bound(const key_type& code);
+    const_iterator upper_bound(const key_type& code) const;
+    std::pair<iterator, iterator> equal_range(const key_type& code);
+    std::pair<const_iterator, const_iterator>
+    equal_range(const key_type& code) const;
+    //@}
+
+private:
+    /// @brief Inserts an option at its sorted position.
+    iterator insertOption(const key_type code, const OptionPtr& option);
+
+    /// @brief Returns the address of the internal storage.
+    value_type* inlineData() {
+        return (static_cast<value_type*>(
+                    static_cast<void*>(inline_storage_.address())));
+    }
+
+    /// @brief Checks if the elements are held in the internal storage.
+    bool isInline() const {
+        return (data_ == const_cast<OptionCollection*>(this)->inlineData());
+    }
+
+    /// Pointer to the first element (either internal or heap storage).
+    value_type* data_;
+
+    /// Number of elements in the collection.
+    size_type size_;
+
+    /// Number of elements which fit in the current storage.
+    size_type capacity_;
+
+    /// Storage for the first @c INLINE_CAPACITY elements.
+    boost::aligned_storage<sizeof(value_type) * INLINE_CAPACITY,
+                           boost::alignment_of<value_type>::value>::type
+    inline_storage_;
+};
+
+/// @brief Compares two collections.
+///
+/// The collections are equal when they hold the same option codes and
+/// the same option pointers in the same order.
+bool operator==(const OptionCollection& a, const OptionCollection& b);
+
+/// @brief Compares two collections for inequality.
+inline bool
+operator!=(const OptionCollection& a, const OptionCollection& b) {
+    return (!(a == b));
+}
+
+/// @brief Swaps the contents of two collections.
+inline void
+swap(OptionCollection& a, OptionCollection& b) {
+    a.swap(b);
+}
+
+} // namespace bundy::dhcp
+} // namespace bundy
+
+#endif // OPTION_COLLECTION_H
@@ -49,7 +49,8 @@ Pkt4::Pkt4(uint8_t msg_type, uint32_t transid)
       ciaddr_(DEFAULT_ADDRESS),
       yiaddr_(DEFAULT_ADDRESS),
       siaddr_(DEFAULT_ADDRESS),
-      giaddr_(DEFAULT_ADDRESS)
+      giaddr_(DEFAULT_ADDRESS),
+      lazy_unpack_(false)
 {
     memset(sname_, 0, MAX_SNAME_LEN);
     memset(file_, 0, MAX_FILE_LEN);
@@ -74,7 +75,8 @@ Pkt4::Pkt4(const uint8_t* data, size_t len)
       ciaddr_(DEFAULT_ADDRESS),
       yiaddr_(DEFAULT_ADDRESS),
       siaddr_(DEFAULT_ADDRESS),
-      giaddr_(DEFAULT_ADDRESS)
+      giaddr_(DEFAULT_ADDRESS),
+      lazy_unpack_(false)
 {
     if (len < DHCPV4_PKT_HDR_LEN) {
         bundy_throw(OutOfRange, "Truncated DHCPv4 packet (len=" << len
@@ -93,6 +95,10 @@ size_t
 Pkt4::len() {
     size_t length = DHCPV4_PKT_HDR_LEN; // DHCPv4 header
 
+    // Options which haven't been unpacked yet must be accounted for,
+    // using the length of the option objects.
+    unpackPendingOptions();
+
     // ... and sum of lengths of all options
     for (OptionCollection::const_iterator it = options_.begin();
          it != options_.end();
@@ -113,6 +119,9 @@ Pkt4::pack() {
     // will not result in concatenation of multiple packet copies.
     buffer_out_.clear();
 
+    // All options are packed, so make sure that they have been unpacked.
+    unpackPendingOptions();
+
     try {
         size_t hw_len = hwaddr_->hwaddr_.size();
 
@@ -213,25 +222,140 @@ Pkt4::unpack() {
       bundy_throw(Unexpected, "Invalid or missing DHCP magic cookie");
     }
 
-    size_t opts_len = buffer_in.getLength() - buffer_in.getPosition();
-    vector<uint8_t> opts_buffer;
+    if (lazy_unpack_) {
+        // Only remember where the options are. They will be unpacked
+        // when requested.
+        indexOptions(buffer_in.getPosition());
+
+    } else {
+        size_t opts_len = buffer_in.getLength() - buffer_in.getPosition();
+        vector<uint8_t> opts_buffer;
+
+        // Use readVector because a function which parses option requires
+        // a vector as an input.
+        buffer_in.readVector(opts_buffer, opts_len);
+        unpackOptions(opts_buffer);
+    }
+
+    // @todo check will need to be called separately, so hooks can be called
+    // after the packet is parsed, but before its content is verified
+    check();
+}
 
-    // Use readVector because a function which parses option requires
-    // a vector as an input.
-    buffer_in.readVector(opts_buffer, opts_len);
+void
+Pkt4::unpackOptions(const OptionBuffer& buf) const {
+    // The options are unpacked into a temporary collection, so as none of
+    // them is added to the packet if any of them is malformed. Otherwise,
+    // the options preceding the malformed one would be added again when
+    // the pending options are unpacked the next time.
+    OptionCollection options;
     if (callback_.empty()) {
-        LibDHCP::unpackOptions4(opts_buffer, "dhcp4", options_);
+        LibDHCP::unpackOptions4(buf, "dhcp4", options);
     } else {
         // The last two arguments are set to NULL because they are
         // specific to DHCPv6 options parsing. They are unused for
         // DHCPv4 case. In DHCPv6 case they hold are the relay message
         // offset and length.
-        callback_(opts_buffer, "dhcp4", options_, NULL, NULL);
+        callback_(buf, "dhcp4", options, NULL, NULL);
     }
+    options_.insert(options.begin(), options.end());
+}
 
-    // @todo check will need to be called separately, so hooks can be called
-    // after the packet is parsed, but before its content is verified
-    check();
+void
+Pkt4::indexOptions(size_t offset) {
+    pending_options_.clear();
+
+    // The checks below must be kept in sync with LibDHCP::unpackOptions4,
+    // so as the lazily unpacked packets are rejected in the same cases as
+    // the packets unpacked at once.
+    while (offset < data_.size()) {
+        const size_t opt_offset = offset;
+        uint8_t opt_type = data_[offset++];
+
+        // DHO_END is a special, one octet long option
+        if (opt_type == DHO_END) {
+            return;
+        }
+
+        // DHO_PAD is just a padding after DHO_END. Let's continue parsing
+        // in case we receive a message without DHO_END.
+        if (opt_type == DHO_PAD) {
+            continue;
+        }
+
+        if (offset + 1 >= data_.size()) {
+            bundy_throw(OutOfRange, "Attempt to parse truncated option "
+                      << static_cast<int>(opt_type));
+        }
+
+        uint8_t opt_len = data_[offset++];
+        if (offset + opt_len > data_.size()) {
+            bundy_throw(OutOfRange, "Option parse failed. Tried to parse "
+                      << offset + opt_len << " bytes from " << data_.size()
+                      << "-byte long buffer.");
+        }
+
+        PendingOption pending;
+        pending.type_ = opt_type;
+        pending.offset_ = opt_offset;
+        pending.len_ = offset + opt_len - opt_offset;
+        pending_options_.push_back(pending);
+
+        offset += opt_len;
+    }
+}
+
+void
+Pkt4::unpackPendingOptions(const uint8_t type) const {
+    if (pending_options_.empty()) {
+        return;
+    }
+
+    // Gather all instances of the option, so as they are inserted into
+    // the collection in the order in which they appear in the packet.
+    OptionBuffer buf;
+    for (PendingOptionCollection::const_iterator it = pending_options_.begin();
+         it != pending_options_.end(); ++it) {
+        if (it->type_ == type) {
+            buf.insert(buf.end(), data_.begin() + it->offset_,
+                       data_.begin() + it->offset_ + it->len_);
+        }
+    }
+    if (buf.empty()) {
+        return;
+    }
+
+    unpackOptions(buf);
+
+    // Forget the unpacked options only when unpacking succeeded, so as
+    // the error is reported again when the option is requested again.
+    PendingOptionCollection::iterator dst = pending_options_.begin();
+    for (PendingOptionCollection::const_iterator src = pending_options_.begin();
+         src != pending_options_.end(); ++src) {
+        if (src->type_ != type) {
+            *dst++ = *src;
+        }
+    }
+    pending_options_.erase(dst, pending_options_.end());
+}
+
+void
+Pkt4::unpackPendingOptions() const {
+    if (pending_options_.empty()) {
+        return;
+    }
+
+    OptionBuffer buf;
+    for (PendingOptionCollection::const_iterator it = pending_options_.begin();
+         it != pending_options_.end(); ++it) {
+        buf.insert(buf.end(), data_.begin() + it->offset_,
+                   data_.begin() + it->offset_ + it->len_);
+    }
+
+    // The pending options are kept if unpacking fails, so as the error
+    // is reported again on the next attempt.
+    unpackOptions(buf);
+    pending_options_.clear();
 }
 
 void Pkt4::check() {
@@ -284,6 +408,7 @@ Pkt4::toText() {
         << ":" << remote_port_ << ", msgtype=" << static_cast<int>(getType())
         << ", transid=0x" << hex << transid_ << dec << endl;
 
+    unpackPendingOptions();
     for (bundy::dhcp::OptionCollection::iterator opt=options_.begin();
          opt != options_.end();
          ++opt) {
@@ -444,6 +569,7 @@ Pkt4::addOption(boost::shared_ptr<Option> opt) {
 
 boost::shared_ptr<bundy::dhcp::Option>
 Pkt4::getOption(uint8_t type) const {
+    unpackPendingOptions(type);
     OptionCollection::const_iterator x = options_.find(type);
     if (x != options_.end()) {
         return (*x).second;
@@ -453,6 +579,7 @@ Pkt4::getOption(uint8_t type) const {
 
 bool
 Pkt4::delOption(uint8_t type) {
+    unpackPendingOptions(type);
     bundy::dhcp::OptionCollection::iterator x = options_.find(type);
     if (x != options_.end()) {
         options_.erase(x);
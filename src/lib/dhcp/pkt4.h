@@ -87,9 +87,37 @@ public:
     /// Will create a collection of option objects that will
     /// be stored in options_ container.
     ///
+    /// If the lazy unpacking is enabled (see @ref setLazyUnpack), this
+    /// method only records the location of each option in the received
+    /// buffer. An option is created when it is first requested with
+    /// @ref getOption, or when the whole collection of options is needed,
+    /// e.g. to pack or print the packet. The framing of the options (option
+    /// codes and lengths) is still fully validated here, but errors in the
+    /// option contents are then reported by the function which caused the
+    /// option to be created.
+    ///
     /// Method with throw exception if packet parsing fails.
     void unpack();
 
+    /// @brief Enables or disables lazy unpacking of options.
+    ///
+    /// Most of the packet processing paths only look at a few options, such
+    /// as message type, client identifier or requested address. Creating
+    /// the remaining option objects on reception is then a waste of time.
+    /// The lazy unpacking is disabled by default. The setting must be
+    /// made before @ref unpack is called.
+    ///
+    /// @param lazy A boolean value which indicates whether the lazy
+    /// unpacking should be enabled (true) or disabled (false).
+    void setLazyUnpack(const bool lazy) {
+        lazy_unpack_ = lazy;
+    }
+
+    /// @brief Checks if the lazy unpacking of options is enabled.
+    bool isLazyUnpack() const {
+        return (lazy_unpack_);
+    }
+
     /// @brief performs sanity check on a packet.
     ///
     /// This is usually performed after unpack(). It checks if packet is sane:
@@ -328,8 +356,13 @@ public:
 
     /// @brief Returns an option of specified type.
     ///
+    /// If the packet has been unpacked lazily and the option hasn't been
+    /// requested before, the option is created from the received data.
+    ///
     /// @return returns option of requested type (or NULL)
     ///         if no such option is present
+    /// @throw bundy::Exception if the option is being created and its
+    ///        contents is malformed.
     boost::shared_ptr<Option>
     getOption(uint8_t opt_type) const;
 
@@ -610,6 +643,46 @@ protected:
     uint8_t
     DHCPTypeToBootpType(uint8_t dhcpType);
 
+    /// @brief Location of an option which hasn't been unpacked yet.
+    struct PendingOption {
+        /// Option code.
+        uint8_t type_;
+        /// Offset of the option header within data_.
+        size_t offset_;
+        /// Length of the option including its header.
+        size_t len_;
+    };
+
+    /// A collection of options which haven't been unpacked yet.
+    typedef std::vector<PendingOption> PendingOptionCollection;
+
+    /// @brief Records locations of options held in the received buffer.
+    ///
+    /// This function validates the framing of the options in the same way
+    /// as @ref LibDHCP::unpackOptions4, but doesn't create option objects.
+    ///
+    /// @param offset Offset of the first option within data_.
+    ///
+    /// @throw bundy::OutOfRange if an option is truncated.
+    void indexOptions(size_t offset);
+
+    /// @brief Creates option objects for the pending options of the
+    /// specified type.
+    ///
+    /// @param type Option code.
+    void unpackPendingOptions(const uint8_t type) const;
+
+    /// @brief Creates option objects for all pending options.
+    void unpackPendingOptions() const;
+
+    /// @brief Unpacks the specified options of the received buffer.
+    ///
+    /// The options are added to the packet only if all of them are
+    /// unpacked successfully.
+    ///
+    /// @param buf A buffer holding options to be unpacked.
+    void unpackOptions(const OptionBuffer& buf) const;
+
     /// local HW address (dst if receiving packet, src if sending packet)
     HWAddrPtr local_hwaddr_;
 
@@ -693,7 +766,16 @@ protected:
     /// behavior must be taken into consideration before making
     /// changes to this member such as access scope restriction or
     /// data format change etc.
-    bundy::dhcp::OptionCollection options_;
+    ///
+    /// The member is mutable because the options of a lazily unpacked
+    /// packet are created on first use, also by the const accessors.
+    mutable bundy::dhcp::OptionCollection options_;
+
+    /// Options which haven't been unpacked yet.
+    mutable PendingOptionCollection pending_options_;
+
+    /// Indicates whether options should be unpacked lazily.
+    bool lazy_unpack_;
 
     /// packet timestamp
     boost::posix_time::ptime timestamp_;
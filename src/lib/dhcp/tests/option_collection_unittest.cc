@@ -0,0 +1,202 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <dhcp/option.h>
+#include <dhcp/option_collection.h>
+
+#include <gtest/gtest.h>
+
+#include <utility>
+
+using namespace bundy::dhcp;
+
+namespace {
+
+/// @brief Test fixture class for the OptionCollection.
+class OptionCollectionTest : public ::testing::Test {
+public:
+    /// @brief Constructor.
+    ///
+    /// Creates a set of options which are inserted to the collections
+    /// by the tests.
+    OptionCollectionTest() {
+        for (uint16_t i = 0; i < 16; ++i) {
+            options_.push_back(OptionPtr(new Option(Option::V6, 100 + i)));
+        }
+    }
+
+    /// @brief Checks that the options in the collection are ordered by
+    /// their codes.
+    ///
+    /// @param collection Collection to be checked.
+    void checkOrder(const OptionCollection& collection) {
+        for (OptionCollection::const_iterator it = collection.begin();
+             it != collection.end(); ++it) {
+            ASSERT_TRUE(it->second);
+            EXPECT_EQ(it->first, it->second->getType());
+            if (it != collection.begin()) {
+                EXPECT_LE((it - 1)->first, it->first);
+            }
+        }
+    }
+
+    /// Options used by the tests.
+    std::vector<OptionPtr> options_;
+};
+
+// Verifies that the options are kept sorted by code, regardless of the
+// order of insertion, and that the lookup functions find them.
+TEST_F(OptionCollectionTest, insertAndFind) {
+    OptionCollection collection;
+    EXPECT_TRUE(collection.empty());
+    EXPECT_EQ(OptionCollection::INLINE_CAPACITY, collection.capacity());
+    EXPECT_TRUE(collection.find(100) == collection.end());
+
+    // Insert options in the reverse order so as each insertion moves
+    // the existing elements. This also makes the collection outgrow
+    // its internal storage.
+    for (int i = options_.size() - 1; i >= 0; --i) {
+        OptionCollection::iterator it =
+            collection.insert(std::make_pair(options_[i]->getType(),
+                                             options_[i]));
+        EXPECT_EQ(options_[i], it->second);
+    }
+    ASSERT_EQ(options_.size(), collection.size());
+    EXPECT_GE(collection.capacity(), collection.size());
+    checkOrder(collection);
+
+    for (size_t i = 0; i < options_.size(); ++i) {
+        OptionCollection::const_iterator it =
+            collection.find(options_[i]->getType());
+        ASSERT_TRUE(it != collection.end());
+        EXPECT_EQ(options_[i], it->second);
+        EXPECT_EQ(1, collection.count(options_[i]->getType()));
+    }
+    EXPECT_TRUE(collection.find(1) == collection.end());
+    EXPECT_EQ(0, collection.count(1));
+}
+
+// Verifies that options having the same code are kept in the order
+// of insertion, as in the std::multimap.
+TEST_F(OptionCollectionTest, duplicates) {
+    OptionCollection collection;
+    OptionPtr first(new Option(Option::V6, 1));
+    OptionPtr second(new Option(Option::V6, 1));
+    OptionPtr third(new Option(Option::V6, 1));
+    collection.insert(std::make_pair(options_[1]->getType(), options_[1]));
+    collection.insert(std::make_pair(1, first));
+    collection.insert(std::make_pair(options_[0]->getType(), options_[0]));
+    collection.insert(std::make_pair(1, second));
+    collection.insert(std::make_pair(1, third));
+
+    ASSERT_EQ(5, collection.size());
+    checkOrder(collection);
+    EXPECT_EQ(3, collection.count(1));
+
+    std::pair<OptionCollection::iterator, OptionCollection::iterator> range =
+        collection.equal_range(1);
+    ASSERT_EQ(3, std::distance(range.first, range.second));
+    EXPECT_EQ(first, range.first->second);
+    EXPECT_EQ(second, (range.first + 1)->second);
+    EXPECT_EQ(third, (range.first + 2)->second);
+    EXPECT_TRUE(range.first == collection.lower_bound(1));
+    EXPECT_TRUE(range.second == collection.upper_bound(1));
+
+    // find() returns the first option inserted.
+    EXPECT_EQ(first, collection.find(1)->second);
+}
+
+// Verifies that options can be erased by iterator, range and code.
+TEST_F(OptionCollectionTest, erase) {
+    OptionCollection collection;
+    for (size_t i = 0; i < options_.size(); ++i) {
+        collection.insert(std::make_pair(options_[i]->getType(), options_[i]));
+    }
+    OptionPtr duplicate(new Option(Option::V6, 105));
+    collection.insert(std::make_pair(duplicate->getType(), duplicate));
+
+    // Erase the first option of code 105.
+    OptionCollection::iterator it = collection.find(105);
+    ASSERT_TRUE(it != collection.end());
+    it = collection.erase(it);
+    ASSERT_TRUE(it != collection.end());
+    EXPECT_EQ(duplicate, it->second);
+    EXPECT_EQ(options_.size(), collection.size());
+
+    // Erase by code.
+    EXPECT_EQ(1, collection.erase(105));
+    EXPECT_EQ(0, collection.erase(105));
+    EXPECT_TRUE(collection.find(105) == collection.end());
+
+    // Erase a range.
+    collection.erase(collection.lower_bound(110), collection.end());
+    EXPECT_EQ(9, collection.size());
+    checkOrder(collection);
+
+    // The options which have been removed from the collection should
+    // no longer be referenced by it.
+    EXPECT_EQ(1, options_[15].use_count());
+    EXPECT_EQ(2, options_[0].use_count());
+
+    collection.clear();
+    EXPECT_TRUE(collection.empty());
+    EXPECT_EQ(1, options_[0].use_count());
+}
+
+// Verifies that the collections can be copied, assigned and swapped, both
+// when using the internal storage and the heap.
+TEST_F(OptionCollectionTest, copyAndSwap) {
+    OptionCollection small;
+    small.insert(std::make_pair(options_[0]->getType(), options_[0]));
+
+    OptionCollection large;
+    for (size_t i = 0; i < options_.size(); ++i) {
+        large.insert(std::make_pair(options_[i]->getType(), options_[i]));
+    }
+
+    OptionCollection small_copy(small);
+    EXPECT_TRUE(small_copy == small);
+    OptionCollection large_copy(large);
+    EXPECT_TRUE(large_copy == large);
+    EXPECT_TRUE(small_copy != large_copy);
+
+    // Swap the collection using the internal storage with the one using
+    // the heap.
+    small_copy.swap(large_copy);
+    EXPECT_TRUE(small_copy == large);
+    EXPECT_TRUE(large_copy == small);
+
+    // Swap two heap allocated collections.
+    OptionCollection large_copy2(large);
+    large_copy2.erase(100);
+    large_copy2.swap(small_copy);
+    EXPECT_TRUE(large_copy2 == large);
+    EXPECT_EQ(options_.size() - 1, small_copy.size());
+
+    // Assignment.
+    small_copy = small;
+    EXPECT_TRUE(small_copy == small);
+    small_copy = large;
+    EXPECT_TRUE(small_copy == large);
+    small_copy = small_copy;
+    EXPECT_TRUE(small_copy == large);
+
+    // Range constructor.
+    OptionCollection range_copy(large.begin(), large.end());
+    EXPECT_TRUE(range_copy == large);
+}
+
+} // end of anonymous namespace
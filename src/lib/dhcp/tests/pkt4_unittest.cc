@@ -693,6 +693,117 @@ TEST_F(Pkt4Test, unpackOptionsWithCallback) {
 
 }
 
+// This test verifies that the options are unpacked on first use when the
+// lazy unpacking is enabled and that the packet can be packed again.
+TEST_F(Pkt4Test, unpackOptionsLazy) {
+    vector<uint8_t> expectedFormat = generateTestPacket2();
+
+    expectedFormat.push_back(0x63);
+    expectedFormat.push_back(0x82);
+    expectedFormat.push_back(0x53);
+    expectedFormat.push_back(0x63);
+
+    for (int i = 0; i < sizeof(v4_opts); i++) {
+        expectedFormat.push_back(v4_opts[i]);
+    }
+    expectedFormat.push_back(DHO_END);
+
+    Pkt4Ptr pkt(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+    ASSERT_FALSE(pkt->isLazyUnpack());
+    pkt->setLazyUnpack(true);
+    ASSERT_TRUE(pkt->isLazyUnpack());
+
+    CustomUnpackCallback cb;
+    pkt->setCallback(boost::bind(&CustomUnpackCallback::execute, &cb,
+                                 _1, _2, _3));
+
+    // The message type option is unpacked when the packet is checked.
+    ASSERT_NO_THROW(pkt->unpack());
+    EXPECT_TRUE(cb.executed_);
+    EXPECT_EQ(DHCPOFFER, pkt->getType());
+
+    // Other options are unpacked when requested.
+    cb.executed_ = false;
+    EXPECT_TRUE(pkt->getOption(12));
+    EXPECT_TRUE(cb.executed_);
+
+    // The option is unpacked once.
+    cb.executed_ = false;
+    EXPECT_TRUE(pkt->getOption(12));
+    EXPECT_FALSE(cb.executed_);
+
+    // Non-existing options are not unpacked.
+    EXPECT_FALSE(pkt->getOption(127));
+    EXPECT_FALSE(cb.executed_);
+
+    verifyParsedOptions(pkt);
+
+    // Options can be deleted before being unpacked.
+    ASSERT_TRUE(pkt->delOption(14));
+    EXPECT_FALSE(pkt->getOption(14));
+
+    // Packing should produce the same options as received, except
+    // for the deleted one.
+    pkt->addOption(OptionPtr(new Option(Option::V4, 14,
+                                        OptionBuffer(v4_opts + 7,
+                                                     v4_opts + 10))));
+    ASSERT_NO_THROW(pkt->pack());
+    const OutputBuffer& buf = pkt->getBuffer();
+    ASSERT_EQ(expectedFormat.size(), buf.getLength());
+    EXPECT_EQ(0, memcmp(&expectedFormat[0], buf.getData(),
+                        expectedFormat.size()));
+}
+
+// This test verifies that the lazy unpacking detects truncated options
+// in unpack() and malformed options on first use.
+TEST_F(Pkt4Test, unpackOptionsLazyMalformed) {
+    vector<uint8_t> expectedFormat = generateTestPacket2();
+
+    expectedFormat.push_back(0x63);
+    expectedFormat.push_back(0x82);
+    expectedFormat.push_back(0x53);
+    expectedFormat.push_back(0x63);
+
+    // Message type.
+    expectedFormat.push_back(DHO_DHCP_MESSAGE_TYPE);
+    expectedFormat.push_back(1);
+    expectedFormat.push_back(DHCPREQUEST);
+    // A well formed option preceding the malformed one.
+    expectedFormat.push_back(DHO_HOST_NAME);
+    expectedFormat.push_back(1);
+    expectedFormat.push_back('a');
+    // Lease time must be 4 bytes long.
+    expectedFormat.push_back(DHO_DHCP_LEASE_TIME);
+    expectedFormat.push_back(1);
+    expectedFormat.push_back(1);
+    expectedFormat.push_back(DHO_END);
+
+    Pkt4Ptr pkt(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+    pkt->setLazyUnpack(true);
+    ASSERT_NO_THROW(pkt->unpack());
+
+    // The malformed option is reported each time it is requested.
+    EXPECT_THROW(pkt->getOption(DHO_DHCP_LEASE_TIME), bundy::Exception);
+    EXPECT_THROW(pkt->getOption(DHO_DHCP_LEASE_TIME), bundy::Exception);
+    EXPECT_EQ(DHCPREQUEST, pkt->getType());
+
+    // Also when all options are unpacked at once, e.g. to log the packet.
+    EXPECT_THROW(pkt->toText(), bundy::Exception);
+    EXPECT_THROW(pkt->toText(), bundy::Exception);
+
+    // The failed attempts must not have added the well formed option,
+    // so as it is present exactly once.
+    ASSERT_TRUE(pkt->getOption(DHO_HOST_NAME));
+    EXPECT_TRUE(pkt->delOption(DHO_HOST_NAME));
+    EXPECT_FALSE(pkt->getOption(DHO_HOST_NAME));
+
+    // Truncate the packet, so as the last option doesn't fit.
+    expectedFormat.resize(expectedFormat.size() - 2);
+    pkt.reset(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+    pkt->setLazyUnpack(true);
+    EXPECT_THROW(pkt->unpack(), OutOfRange);
+}
+
 // This test verifies methods that are used for manipulating meta fields
 // i.e. fields that are not part of DHCPv4 (e.g. interface name).
 TEST_F(Pkt4Test, metaFields) {
@@ -110,18 +110,47 @@ NameChangeListener::stopListening() {
 void
 NameChangeListener::invokeRecvHandler(const Result result,
                                       NameChangeRequestPtr& ncr) {
+    io_pending_ = false;
+    callRecvHandler(result, ncr);
+    receiveNextAfterHandler();
+}
+
+void
+NameChangeListener::invokeRecvHandler(std::vector<NameChangeRequestPtr>&
+                                      ncrs) {
+    io_pending_ = false;
+    for (std::vector<NameChangeRequestPtr>::iterator it = ncrs.begin();
+         it != ncrs.end(); ++it) {
+        callRecvHandler(SUCCESS, *it);
+
+        // The handler may stop listening (e.g. when its queue is full), in
+        // which case the rest of the requests can't be delivered.
+        if (!amListening() && (it + 1 != ncrs.end())) {
+            LOG_ERROR(dhcp_ddns_logger, DHCP_DDNS_NCR_RECV_BATCH_DROPPED)
+                      .arg(ncrs.end() - (it + 1));
+            break;
+        }
+    }
+    receiveNextAfterHandler();
+}
+
+void
+NameChangeListener::callRecvHandler(const Result result,
+                                    NameChangeRequestPtr& ncr) {
     // Call the registered application layer handler.
     // Surround the invocation with a try-catch. The invoked handler is
     // not supposed to throw, but in the event it does we will at least
     // report it.
     try {
-        io_pending_ = false;
         recv_handler_(result, ncr);
     } catch (const std::exception& ex) {
         LOG_ERROR(dhcp_ddns_logger, DHCP_DDNS_UNCAUGHT_NCR_RECV_HANDLER_ERROR)
                   .arg(ex.what());
     }
+}
 
+void
+NameChangeListener::receiveNextAfterHandler() {
     // Start the next IO layer asynchronous receive.
     // In the event the handler above intervened and decided to stop listening
     // we need to check that first.
@@ -271,11 +300,17 @@ NameChangeSender::sendNext() {
 }
 
 void
-NameChangeSender::invokeSendHandler(const NameChangeSender::Result result) {
+NameChangeSender::invokeSendHandler(const NameChangeSender::Result result,
+                                    const size_t count) {
     // @todo reset defense timer
+    SendQueue shipped;
     if (result == SUCCESS) {
-        // It shipped so pull it off the queue.
-        send_queue_.pop_front();
+        // They shipped so pull them off the queue. The first one is the
+        // pending ncr itself.
+        for (size_t i = 0; (i < count) && !send_queue_.empty(); ++i) {
+            shipped.push_back(send_queue_.front());
+            send_queue_.pop_front();
+        }
     }
 
     // Invoke the completion handler passing in the result and a pointer
@@ -290,6 +325,18 @@ NameChangeSender::invokeSendHandler(const NameChangeSender::Result result) {
                   .arg(ex.what());
     }
 
+    // Let the handler know about the rest of the requests which shipped
+    // along with it.
+    for (size_t i = 1; i < shipped.size(); ++i) {
+        try {
+            send_handler_(result, shipped[i]);
+        } catch (const std::exception& ex) {
+            LOG_ERROR(dhcp_ddns_logger,
+                      DHCP_DDNS_UNCAUGHT_NCR_SEND_HANDLER_ERROR)
+                      .arg(ex.what());
+        }
+    }
+
     // Clear the pending ncr pointer.
     ncr_to_send_.reset();
 
@@ -62,6 +62,7 @@
 #include <exceptions/exceptions.h>
 
 #include <deque>
+#include <vector>
 
 namespace bundy {
 namespace dhcp_ddns {
@@ -273,6 +274,18 @@ protected:
     /// wise.
     void invokeRecvHandler(const Result result, NameChangeRequestPtr& ncr);
 
+    /// @brief Calls the NCR receive handler for each of several requests.
+    ///
+    /// This variant is used when a single receive yields more than one
+    /// request. The handler is invoked with a SUCCESS result for each of
+    /// the requests in turn, after which the next receive is initiated
+    /// just as in the single request variant. If the handler stops
+    /// listening, the requests not yet delivered are dropped and their
+    /// number is logged.
+    ///
+    /// @param ncrs is the list of the received requests.
+    void invokeRecvHandler(std::vector<NameChangeRequestPtr>& ncrs);
+
     /// @brief Abstract method which opens the IO source for reception.
     ///
     /// The derivation uses this method to perform the steps needed to
@@ -328,6 +341,15 @@ public:
     }
 
 private:
+    /// @brief Calls the registered handler, logging any exception it throws.
+    ///
+    /// @param result contains that receive outcome status.
+    /// @param ncr is a pointer to the received request.
+    void callRecvHandler(const Result result, NameChangeRequestPtr& ncr);
+
+    /// @brief Initiates the next receive if the listener is still listening.
+    void receiveNextAfterHandler();
+
     /// @brief Sets the listening indicator to the given value.
     ///
     /// Note, this method is private as it is used the base class is solely
@@ -615,8 +637,16 @@ protected:
     /// operation may or may not succeed as the application has violated
     /// the interface contract.
     ///
+    /// Derivations which send several queued requests at once pass their
+    /// number in count. On success, that many entries are removed from the
+    /// front of the queue and the handler is invoked for each of them. On
+    /// failure, all of them are left on the queue and the handler is invoked
+    /// once for the request at the front.
+    ///
     /// @param result contains that send outcome status.
-    void invokeSendHandler(const NameChangeSender::Result result);
+    /// @param count number of requests carried by the completed send.
+    void invokeSendHandler(const NameChangeSender::Result result,
+                           const size_t count = 1);
 
     /// @brief Abstract method which opens the IO sink for transmission.
     ///
@@ -34,6 +34,10 @@ NameChangeFormat stringToNcrFormat(const std::string& fmt_str) {
         return FMT_JSON;
     }
 
+    if (boost::iequals(fmt_str, "BINARY")) {
+        return FMT_BINARY;
+    }
+
     bundy_throw(BadValue, "Invalid NameChangeRequest format:" << fmt_str);
 }
 
@@ -43,6 +47,10 @@ std::string ncrFormatToString(NameChangeFormat format) {
         return ("JSON");
     }
 
+    if (format == FMT_BINARY) {
+        return ("BINARY");
+    }
+
     std::ostringstream stream;
     stream  << "UNKNOWN(" << format << ")";
     return (stream.str());
@@ -102,6 +110,11 @@ D2Dhcid::toStr() const {
     return (bundy::util::encode::encodeHex(bytes_));
 }
 
+void
+D2Dhcid::fromBytes(const std::vector<uint8_t>& data) {
+    bytes_ = data;
+}
+
 void
 D2Dhcid::fromClientId(const std::vector<uint8_t>& clientid_data,
                       const std::vector<uint8_t>& wire_fqdn) {
@@ -209,6 +222,25 @@ operator<<(std::ostream& os, const D2Dhcid& dhcid) {
 
 /**************************** NameChangeRequest ******************************/
 
+namespace {
+
+/// @name Flags of the binary format.
+//@{
+/// Forward change flag.
+const uint8_t BINARY_FLAG_FORWARD = 0x1;
+/// Reverse change flag.
+const uint8_t BINARY_FLAG_REVERSE = 0x2;
+//@}
+
+/// Length of an IPv4 address.
+const size_t V4ADDRESS_LEN = 4;
+/// Length of an IPv6 address.
+const size_t V6ADDRESS_LEN = 16;
+
+}
+
+const uint8_t NameChangeRequest::BINARY_FORMAT_VERSION;
+
 NameChangeRequest::NameChangeRequest()
     : change_type_(CHG_ADD), forward_change_(false),
     reverse_change_(false), fqdn_(""), ip_io_address_("0.0.0.0"),
@@ -263,6 +295,25 @@ NameChangeRequest::fromFormat(const NameChangeFormat format,
                       << ex.what());
         }
 
+        break;
+        }
+    case FMT_BINARY: {
+        try {
+            // Get the length of the binary request and make sure it is
+            // all there before parsing it.
+            size_t len = buffer.readUint16();
+            if (buffer.getLength() - buffer.getPosition() < len) {
+                bundy_throw(NcrMessageError, "fromFormat: binary request"
+                            " length " << len << " exceeds the buffer");
+            }
+
+            ncr = NameChangeRequest::fromBinary(buffer, len);
+        } catch (bundy::util::InvalidBufferPosition& ex) {
+            // Read error accessing data in InputBuffer.
+            bundy_throw(NcrMessageError, "fromFormat: buffer read error: "
+                      << ex.what());
+        }
+
         break;
         }
     default:
@@ -291,6 +342,22 @@ NameChangeRequest::toFormat(const NameChangeFormat format,
         buffer.writeData(json.c_str(), length);
         break;
         }
+    case FMT_BINARY: {
+        // Leave room for the length, write the request and then fill in
+        // the length of what was written.
+        size_t length_pos = buffer.getLength();
+        buffer.writeUint16(0);
+        try {
+            toBinary(buffer);
+        } catch (...) {
+            // toBinary writes nothing if it throws, so drop the length.
+            buffer.trim(sizeof(uint16_t));
+            throw;
+        }
+        buffer.writeUint16At(buffer.getLength() - length_pos -
+                             sizeof(uint16_t), length_pos);
+        break;
+        }
     default:
         // Programmatic error, shouldn't happen.
         bundy_throw(NcrMessageError, "toFormat - invalid format");
@@ -380,6 +447,137 @@ NameChangeRequest::toJSON() const  {
     return (stream.str());
 }
 
+NameChangeFormat
+NameChangeRequest::detectFormat(const bundy::util::InputBuffer& buffer) {
+    // Skip the length and look at the first octet of the request, using
+    // a copy so as the buffer position is preserved.
+    bundy::util::InputBuffer peek(buffer);
+    try {
+        peek.readUint16();
+        return (peek.readUint8() == BINARY_FORMAT_VERSION ? FMT_BINARY :
+                FMT_JSON);
+    } catch (bundy::util::InvalidBufferPosition& ex) {
+        bundy_throw(NcrMessageError, "detectFormat: buffer is too short");
+    }
+}
+
+NameChangeRequestPtr
+NameChangeRequest::fromBinary(bundy::util::InputBuffer& buffer,
+                              const size_t length) {
+    const size_t end = buffer.getPosition() + length;
+    if (end > buffer.getLength()) {
+        bundy_throw(NcrMessageError, "fromBinary: request length " << length
+                    << " exceeds the buffer");
+    }
+
+    NameChangeRequestPtr ncr(new NameChangeRequest());
+    try {
+        const uint8_t version = buffer.readUint8();
+        if (version != BINARY_FORMAT_VERSION) {
+            bundy_throw(NcrMessageError, "fromBinary: unsupported version: "
+                        << static_cast<int>(version));
+        }
+
+        const uint8_t change_type = buffer.readUint8();
+        if ((change_type != CHG_ADD) && (change_type != CHG_REMOVE)) {
+            bundy_throw(NcrMessageError,
+                        "Invalid data value for change_type: "
+                        << static_cast<int>(change_type));
+        }
+        ncr->setChangeType(static_cast<NameChangeType>(change_type));
+
+        const uint8_t flags = buffer.readUint8();
+        ncr->setForwardChange(flags & BINARY_FLAG_FORWARD);
+        ncr->setReverseChange(flags & BINARY_FLAG_REVERSE);
+
+        uint8_t address[V6ADDRESS_LEN];
+        const uint8_t family = buffer.readUint8();
+        if (family == 4) {
+            buffer.readData(address, V4ADDRESS_LEN);
+            ncr->ip_io_address_ = asiolink::IOAddress::fromBytes(AF_INET,
+                                                                 address);
+        } else if (family == 6) {
+            buffer.readData(address, V6ADDRESS_LEN);
+            ncr->ip_io_address_ = asiolink::IOAddress::fromBytes(AF_INET6,
+                                                                 address);
+        } else {
+            bundy_throw(NcrMessageError, "Invalid address family: "
+                        << static_cast<int>(family));
+        }
+
+        ncr->setLeaseLength(buffer.readUint32());
+        uint64_t expires_on = buffer.readUint32();
+        expires_on = (expires_on << 32) | buffer.readUint32();
+        ncr->lease_expires_on_ = expires_on;
+
+        std::vector<uint8_t> dhcid;
+        buffer.readVector(dhcid, buffer.readUint16());
+        ncr->dhcid_.fromBytes(dhcid);
+
+        const size_t fqdn_len = buffer.readUint16();
+        if (buffer.getPosition() + fqdn_len > end) {
+            bundy_throw(NcrMessageError,
+                        "fromBinary: FQDN exceeds the request length");
+        }
+        std::vector<uint8_t> fqdn;
+        buffer.readVector(fqdn, fqdn_len);
+        ncr->setFqdn(std::string(fqdn.begin(), fqdn.end()));
+    } catch (bundy::util::InvalidBufferPosition& ex) {
+        bundy_throw(NcrMessageError, "fromBinary: buffer read error: "
+                    << ex.what());
+    }
+
+    if (buffer.getPosition() > end) {
+        bundy_throw(NcrMessageError, "fromBinary: request is longer than "
+                    << length << " octets");
+    }
+
+    // Skip any trailing data a newer peer might have appended.
+    buffer.setPosition(end);
+
+    ncr->validateContent();
+    return (ncr);
+}
+
+void
+NameChangeRequest::toBinary(bundy::util::OutputBuffer& buffer) const {
+    const std::vector<uint8_t> address = ip_io_address_.toBytes();
+    const std::vector<uint8_t>& dhcid = dhcid_.getBytes();
+
+    // The request is preceded by its length and the DHCID and the FQDN by
+    // theirs, all as 16-bit integers.  Refuse anything that doesn't fit
+    // before writing, so the buffer isn't left with a partial request.
+    // The fixed part is the version, type, flags and family octets and the
+    // lease length and expiration.
+    const size_t length = 4 + address.size() + 12 +
+        sizeof(uint16_t) + dhcid.size() + sizeof(uint16_t) + fqdn_.size();
+    if (length > 0xffff) {
+        bundy_throw(NcrMessageError, "toBinary: request length " << length
+                    << " exceeds the maximum of 65535 (DHCID length "
+                    << dhcid.size() << ", FQDN length " << fqdn_.size()
+                    << ")");
+    }
+
+    buffer.writeUint8(BINARY_FORMAT_VERSION);
+    buffer.writeUint8(static_cast<uint8_t>(change_type_));
+    buffer.writeUint8((forward_change_ ? BINARY_FLAG_FORWARD : 0) |
+                      (reverse_change_ ? BINARY_FLAG_REVERSE : 0));
+
+    buffer.writeUint8(ip_io_address_.isV4() ? 4 : 6);
+    buffer.writeData(&address[0], address.size());
+
+    buffer.writeUint32(lease_length_);
+    buffer.writeUint32(static_cast<uint32_t>(lease_expires_on_ >> 32));
+    buffer.writeUint32(static_cast<uint32_t>(lease_expires_on_));
+
+    buffer.writeUint16(dhcid.size());
+    if (!dhcid.empty()) {
+        buffer.writeData(&dhcid[0], dhcid.size());
+    }
+
+    buffer.writeUint16(fqdn_.size());
+    buffer.writeData(fqdn_.c_str(), fqdn_.size());
+}
 
 void
 NameChangeRequest::validateContent() {
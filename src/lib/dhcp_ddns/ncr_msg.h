@@ -67,13 +67,14 @@ enum NameChangeStatus  {
 
 /// @brief Defines the list of data wire formats supported.
 enum NameChangeFormat {
-  FMT_JSON
+  FMT_JSON,
+  FMT_BINARY
 };
 
 /// @brief Function which converts labels to  NameChangeFormat enum values.
 ///
 /// @param fmt_str text to convert to an enum.
-/// Valid string values: "JSON"
+/// Valid string values: "JSON", "BINARY"
 ///
 /// @return NameChangeFormat value which maps to the given string.
 ///
@@ -147,6 +148,11 @@ public:
     /// or there is an odd number of digits.
     void fromStr(const std::string& data);
 
+    /// @brief Sets the DHCID value to the given bytes.
+    ///
+    /// @param data holds the raw bytes of the DHCID.
+    void fromBytes(const std::vector<uint8_t>& data);
+
     /// @brief Sets the DHCID value based on the Client Identifier.
     ///
     /// @param clientid_data Holds the raw bytes representing client identifier.
@@ -230,10 +236,20 @@ typedef std::map<std::string, bundy::data::ConstElementPtr> ElementMap;
 /// request DNS updates.  Each message contains a single DNS change (either an
 /// add/update or a remove) for a single FQDN.  It provides marshalling services
 /// for moving instances to and from the wire.  Currently, the only format
-/// supported is JSON, however the class provides an interface such that other
-/// formats can be readily supported.
+/// supported are JSON and a compact binary format, and the class provides
+/// an interface such that other formats can be readily supported.
+///
+/// Both formats begin with a two byte length of the marshalled request
+/// which is followed by the request itself. JSON text always begins with
+/// '{', while the binary format begins with a version octet which never
+/// has that value. This allows the receiving end to tell the formats apart
+/// (see detectFormat()) and several requests to be carried back to back in
+/// a single buffer.
 class NameChangeRequest {
 public:
+    /// @brief Version octet which begins a request in the binary format.
+    static const uint8_t BINARY_FORMAT_VERSION = 1;
+
     /// @brief Default Constructor.
     ///
     /// @todo Currently, fromWire makes use of the ability to create an empty
@@ -280,7 +296,9 @@ public:
     /// is than treated as JSON which is then parsed into the data needed
     /// to create a request instance.
     ///
-    /// (NOTE currently only JSON is supported.)
+    /// BINARY: The buffer is expected to contain a two byte unsigned integer
+    /// which specifies the length of the binary request, followed by the
+    /// request itself. (See fromBinary() for the layout.)
     ///
     /// @param format indicates the data format to use
     /// @param buffer is the input buffer containing the marshalled request
@@ -303,7 +321,9 @@ public:
     /// the request data needed to reassemble the request on the receiving
     /// end. The JSON text in the buffer is NOT null-terminated.
     ///
-    /// (NOTE currently only JSON is supported.)
+    /// BINARY: Upon completion, the buffer will contain a two byte unsigned
+    /// integer which specifies the length of the binary request, followed by
+    /// the request itself. (See toBinary() for the layout.)
     ///
     /// @param format indicates the data format to use
     /// @param buffer is the output buffer to which the request should be
@@ -327,6 +347,60 @@ public:
     /// @return a string containing the JSON rendition of the request
     std::string toJSON() const;
 
+    /// @brief Determines the format of the next request in the buffer.
+    ///
+    /// The buffer position is left unchanged.
+    ///
+    /// @param buffer is the input buffer containing marshalled requests
+    ///
+    /// @return FMT_BINARY if the request begins with the binary format
+    /// version octet, FMT_JSON otherwise.
+    ///
+    /// @throw NcrMessageError if the buffer is too short to hold the length
+    /// and the first octet of a request.
+    static NameChangeFormat detectFormat(const bundy::util::InputBuffer&
+                                         buffer);
+
+    /// @brief Static method for creating a NameChangeRequest from a
+    /// buffer containing a request in the binary format.
+    ///
+    /// The request consists of the following fields, integers being in
+    /// network byte order:
+    ///
+    /// - version (1 octet), BINARY_FORMAT_VERSION
+    /// - change type (1 octet)
+    /// - flags (1 octet), bit 0 is the forward change flag and bit 1 is
+    ///   the reverse change flag
+    /// - address family (1 octet), 4 or 6
+    /// - IP address (4 or 16 octets)
+    /// - lease length (4 octets)
+    /// - lease expiration (8 octets), seconds since the epoch
+    /// - DHCID length (2 octets), followed by the DHCID octets
+    /// - FQDN length (2 octets), followed by the FQDN text
+    ///
+    /// Unlike JSON, the fields are read in place with no intermediate
+    /// parsing.
+    ///
+    /// @param buffer is the input buffer positioned at the version octet
+    /// @param length is the length of the request
+    ///
+    /// @return a pointer to the new NameChangeRequest
+    ///
+    /// @throw NcrMessageError if an error occurs creating new request.
+    static NameChangeRequestPtr fromBinary(bundy::util::InputBuffer& buffer,
+                                           const size_t length);
+
+    /// @brief Instance method for marshalling the contents of the request
+    /// in the binary format.
+    ///
+    /// @param buffer is the output buffer to which the request, without the
+    /// leading length, is written.
+    ///
+    /// @throw NcrMessageError if the request is longer than 65535 octets,
+    /// the largest length the 16-bit length fields can express.  Nothing
+    /// is written to the buffer in that case.
+    void toBinary(bundy::util::OutputBuffer& buffer) const;
+
     /// @brief Validates the content of a populated request.  This method is
     /// used by both the full constructor and from-wire marshalling to ensure
     /// that the request is content valid.  Currently it enforces the
@@ -166,17 +166,33 @@ NameChangeUDPListener::receiveCompletionHandler(const bool successful,
         bundy::util::InputBuffer input_buffer(callback->getData(),
                                             callback->getBytesTransferred());
 
+        // The datagram may carry several requests, each preceded by its
+        // length, so keep going until the data runs out.
+        std::vector<NameChangeRequestPtr> ncrs;
         try {
-            ncr = NameChangeRequest::fromFormat(format_, input_buffer);
+            while (input_buffer.getPosition() < input_buffer.getLength()) {
+                ncrs.push_back(NameChangeRequest::fromFormat(
+                               NameChangeRequest::detectFormat(input_buffer),
+                               input_buffer));
+            }
         } catch (const NcrMessageError& ex) {
-            // log it and go back to listening
+            // log it, there's no telling where the next request would start.
             LOG_ERROR(dhcp_ddns_logger, DHCP_DDNS_INVALID_NCR).arg(ex.what());
 
-            // Queue up the next recieve.
-            // NOTE: We must call the base class, NEVER doReceive
-            receiveNext();
+            if (ncrs.empty()) {
+                // Queue up the next recieve.
+                // NOTE: We must call the base class, NEVER doReceive
+                receiveNext();
+                return;
+            }
+        }
+
+        if (ncrs.size() > 1) {
+            invokeRecvHandler(ncrs);
             return;
         }
+
+        ncr = ncrs.front();
     } else {
         asio::error_code error_code = callback->getErrorCode();
         if (error_code.value() == asio::error::operation_aborted) {
@@ -197,6 +213,8 @@ NameChangeUDPListener::receiveCompletionHandler(const bool successful,
 
 //*************************** NameChangeUDPSender ***********************
 
+const size_t NameChangeUDPSender::MAX_BATCH_SIZE_DEFAULT;
+
 NameChangeUDPSender::
 NameChangeUDPSender(const bundy::asiolink::IOAddress& ip_address,
                     const uint32_t port,
@@ -207,7 +225,8 @@ NameChangeUDPSender(const bundy::asiolink::IOAddress& ip_address,
     : NameChangeSender(ncr_send_handler, send_que_max),
       ip_address_(ip_address), port_(port), server_address_(server_address),
       server_port_(server_port), format_(format),
-      reuse_address_(reuse_address) {
+      reuse_address_(reuse_address), max_batch_size_(MAX_BATCH_SIZE_DEFAULT),
+      batch_count_(0) {
     // Instantiate the send callback.  This gets passed into each send.
     // Note that the callback constructor is passed the an instance method
     // pointer to our completion handler, sendCompletionHandler.
@@ -287,11 +306,36 @@ NameChangeUDPSender::close() {
     watch_socket_.reset();
 }
 
+void
+NameChangeUDPSender::setMaxBatchSize(const size_t max_batch_size) {
+    if (max_batch_size == 0) {
+        bundy_throw(NcrUDPError, "NameChangeUDPSender:"
+                    " maximum batch size must be greater than zero");
+    }
+
+    max_batch_size_ = max_batch_size;
+}
+
 void
 NameChangeUDPSender::doSend(NameChangeRequestPtr& ncr) {
-    // Now use the NCR to write JSON to an output buffer.
+    // Now use the NCR to write it in wire format to an output buffer.
     bundy::util::OutputBuffer ncr_buffer(SEND_BUF_MAX);
     ncr->toFormat(format_, ncr_buffer);
+    batch_count_ = 1;
+
+    // Append the requests queued behind it, as long as they fit. The
+    // request being sent is always at the front of the queue.
+    const SendQueue& queue = getSendQueue();
+    while ((batch_count_ < max_batch_size_) &&
+           (batch_count_ < queue.size())) {
+        const size_t length = ncr_buffer.getLength();
+        queue[batch_count_]->toFormat(format_, ncr_buffer);
+        if (ncr_buffer.getLength() > SEND_BUF_MAX) {
+            ncr_buffer.trim(ncr_buffer.getLength() - length);
+            break;
+        }
+        ++batch_count_;
+    }
 
     // Copy the wire-ized request to callback.  This way we know after
     // send completes what we sent (or attempted to send).
@@ -345,8 +389,9 @@ NameChangeUDPSender::sendCompletionHandler(const bool successful,
         }
     }
 
-    // Call the application's registered request send handler.
-    invokeSendHandler(result);
+    // Call the application's registered request send handler for each
+    // of the requests carried by the datagram.
+    invokeSendHandler(result, batch_count_);
 }
 
 int
@@ -333,8 +333,9 @@ public:
     ///
     /// @param ip_address is the network address on which to listen
     /// @param port is the UDP port on which to listen
-    /// @param format is the wire format of the inbound requests. Currently
-    /// only JSON is supported
+    /// @param format is the wire format of the inbound requests. Note that
+    /// the listener detects the format of each received request, so the
+    /// requests in both JSON and binary formats are accepted regardless.
     /// @param ncr_recv_handler the receive handler object to notify when
     /// a receive completes.
     /// @param reuse_address enables IP address sharing when true
@@ -385,13 +386,14 @@ public:
     /// passing in the boolean success indicator and pointer to itself.
     ///
     /// If the indicator denotes success, then the method will attempt to
-    /// to construct a NameChangeRequest from the received data.  If the
-    /// construction was successful, it will send the new NCR to the
-    /// application layer by calling invokeRecvHandler() with a success
-    /// status and a pointer to the new NCR.
+    /// to construct NameChangeRequests from the received data. A datagram
+    /// may carry several requests back to back, each in its own format.
+    /// The new NCRs are sent to the application layer by calling
+    /// invokeRecvHandler() with a success status.
     ///
     /// If the buffer contains invalid data such that construction fails,
-    /// the method will log the failure and then call doReceive() to start a
+    /// the method will log the failure and pass on the requests which
+    /// preceded the invalid data, if any. Otherwise it calls doReceive() to
     /// initiate the next receive.
     ///
     /// If the indicator denotes failure the method will log the failure and
@@ -451,6 +453,9 @@ public:
     /// @brief Defines the maximum size packet that can be sent.
     static const size_t SEND_BUF_MAX =  NameChangeUDPListener::RECV_BUF_MAX;
 
+    /// @brief Default maximum number of requests sent in one datagram.
+    static const size_t MAX_BATCH_SIZE_DEFAULT = 1;
+
     /// @brief Constructor
     ///
     /// @param ip_address the IP address from which to send
@@ -500,7 +505,9 @@ public:
     /// @brief Sends a given request asynchronously over the socket
     ///
     /// The given NameChangeRequest is converted to wire format and copied
-    /// into the send callback's transfer buffer.  Then the socket's
+    /// into the send callback's transfer buffer.  If batching is enabled,
+    /// the requests queued behind it are appended as long as the datagram
+    /// has room for them, up to the maximum batch size.  Then the socket's
     /// asyncSend() method is called, passing in send_callback_ member's
     /// transfer buffer as the send buffer and the send_callback_ itself
     /// as the callback object.
@@ -547,6 +554,23 @@ public:
     /// @return true if the sender has at IO ready, false otherwise.
     virtual bool ioReady();
 
+    /// @brief Returns the maximum number of requests sent in one datagram.
+    size_t getMaxBatchSize() const {
+        return (max_batch_size_);
+    }
+
+    /// @brief Sets the maximum number of requests sent in one datagram.
+    ///
+    /// Only listeners which are able to handle several requests in one
+    /// datagram should be sent batches, i.e. those supporting the binary
+    /// format.
+    ///
+    /// @param max_batch_size the new maximum. The value of one disables
+    /// batching.
+    ///
+    /// @throw NcrUDPError if the value is zero.
+    void setMaxBatchSize(const size_t max_batch_size);
+
 private:
     /// @brief IP address from which to send.
     bundy::asiolink::IOAddress ip_address_;
@@ -580,6 +604,12 @@ private:
 
     /// @brief Pointer to WatchSocket instance supplying the "select-fd".
     WatchSocketPtr watch_socket_;
+
+    /// @brief Maximum number of requests sent in one datagram.
+    size_t max_batch_size_;
+
+    /// @brief Number of requests carried by the send in progress.
+    size_t batch_count_;
 };
 
 } // namespace bundy::dhcp_ddns
@@ -621,9 +621,14 @@ public:
     std::vector<NameChangeRequestPtr> sent_ncrs_;
     std::vector<NameChangeRequestPtr> received_ncrs_;
 
+    /// @brief If non-zero, the receive handler stops the listener when this
+    /// many requests have been received.
+    size_t stop_listening_at_;
+
     NameChangeUDPTest()
         : io_service_(), recv_result_(NameChangeListener::SUCCESS),
-          send_result_(NameChangeSender::SUCCESS), test_timer_(io_service_) {
+          send_result_(NameChangeSender::SUCCESS), test_timer_(io_service_),
+          stop_listening_at_(0) {
         bundy::asiolink::IOAddress addr(TEST_ADDRESS);
         // Create our listener instance. Note that reuse_address is true.
         listener_.reset(
@@ -631,9 +636,7 @@ public:
                                       *this, true));
 
         // Create our sender instance. Note that reuse_address is true.
-         sender_.reset(
-             new NameChangeUDPSender(addr, SENDER_PORT, addr, LISTENER_PORT,
-                                     FMT_JSON, *this, 100, true));
+        sender_.reset(createSender(FMT_JSON));
 
         // Set the test timeout to break any running tasks if they hang.
         test_timer_.setup(boost::bind(&NameChangeUDPTest::testTimeoutHandler,
@@ -641,6 +644,15 @@ public:
                           TEST_TIMEOUT);
     }
 
+    /// @brief Creates a UDP sender sending to the listener.
+    ///
+    /// @param format wire format used by the sender.
+    NameChangeUDPSender* createSender(const NameChangeFormat format) {
+        bundy::asiolink::IOAddress addr(TEST_ADDRESS);
+        return (new NameChangeUDPSender(addr, SENDER_PORT, addr, LISTENER_PORT,
+                                        format, *this, 100, true));
+    }
+
     void reset_results() {
         sent_ncrs_.clear();
         received_ncrs_.clear();
@@ -652,6 +664,9 @@ public:
         // save the result and the NCR received.
         recv_result_ = result;
         received_ncrs_.push_back(ncr);
+        if (received_ncrs_.size() == stop_listening_at_) {
+            listener_->stopListening();
+        }
     }
 
     /// @brief Implements the send completion handler.
@@ -724,6 +739,105 @@ TEST_F (NameChangeUDPTest, roundTripTest) {
     EXPECT_FALSE(sender_->amSending());
 }
 
+/// @brief Uses a sender and listener to test delivery of NCRs batched in
+/// binary format.
+/// The sender packs the queued NCRs into the same datagram, and the listener,
+/// although configured for JSON, detects the binary format.  The test verifies
+/// that what was sent matches what was received both in quantity and in
+/// content, and that fewer datagrams than NCRs were needed.
+TEST_F (NameChangeUDPTest, batchedRoundTripTest) {
+    // Replace the sender with one using the binary format and batching.
+    NameChangeUDPSender* udp_sender = createSender(FMT_BINARY);
+    sender_.reset(udp_sender);
+
+    // Batch size of zero is not allowed.
+    EXPECT_THROW(udp_sender->setMaxBatchSize(0), NcrUDPError);
+    EXPECT_EQ(NameChangeUDPSender::MAX_BATCH_SIZE_DEFAULT,
+              udp_sender->getMaxBatchSize());
+    ASSERT_NO_THROW(udp_sender->setMaxBatchSize(4));
+    EXPECT_EQ(4, udp_sender->getMaxBatchSize());
+
+    // Place the listener into listening state.
+    ASSERT_NO_THROW(listener_->startListening(io_service_));
+    EXPECT_TRUE(listener_->amListening());
+
+    // Get the number of messages in the list of test messages.
+    int num_msgs = sizeof(valid_msgs)/sizeof(char*);
+
+    // Place the sender into sending state.
+    ASSERT_NO_THROW(sender_->startSending(io_service_));
+    EXPECT_TRUE(sender_->amSending());
+
+    // The first request is sent right away, the rest of them are queued
+    // behind it and are batched.
+    for (int i = 0; i < num_msgs; i++) {
+        NameChangeRequestPtr ncr;
+        ASSERT_NO_THROW(ncr = NameChangeRequest::fromJSON(valid_msgs[i]));
+        sender_->sendRequest(ncr);
+    }
+
+    // Execute callbacks until we have sent and received all of messages,
+    // counting the receive completions along the way.
+    int datagrams = 0;
+    while (sender_->getQueueSize() > 0 || (received_ncrs_.size() < num_msgs)) {
+        size_t received = received_ncrs_.size();
+        EXPECT_NO_THROW(io_service_.run_one());
+        if (received_ncrs_.size() > received) {
+            ++datagrams;
+        }
+    }
+
+    // We should have the same number of sends and receives as we do messages,
+    // carried by fewer datagrams.
+    ASSERT_EQ(num_msgs, sent_ncrs_.size());
+    ASSERT_EQ(num_msgs, received_ncrs_.size());
+    EXPECT_LT(datagrams, num_msgs);
+
+    // Verify that what we sent matches what we received.
+    for (int i = 0; i < num_msgs; i++) {
+        EXPECT_TRUE (checkSendVsReceived(sent_ncrs_[i], received_ncrs_[i]));
+    }
+
+    EXPECT_NO_THROW(listener_->stopListening());
+    EXPECT_NO_THROW(io_service_.run_one());
+    EXPECT_NO_THROW(sender_->stopSending());
+}
+
+/// @brief Verifies that the requests of a datagram are no longer delivered
+/// once the receive handler has stopped the listener.
+TEST_F (NameChangeUDPTest, batchStoppedListening) {
+    NameChangeUDPSender* udp_sender = createSender(FMT_BINARY);
+    sender_.reset(udp_sender);
+    ASSERT_NO_THROW(udp_sender->setMaxBatchSize(4));
+
+    ASSERT_NO_THROW(listener_->startListening(io_service_));
+    ASSERT_NO_THROW(sender_->startSending(io_service_));
+
+    // The first request is sent by itself, the rest of them in the second
+    // datagram.  Stop listening after the first request of the second one.
+    int num_msgs = sizeof(valid_msgs)/sizeof(char*);
+    ASSERT_LE(3, num_msgs);
+    stop_listening_at_ = 2;
+    for (int i = 0; i < num_msgs; i++) {
+        NameChangeRequestPtr ncr;
+        ASSERT_NO_THROW(ncr = NameChangeRequest::fromJSON(valid_msgs[i]));
+        sender_->sendRequest(ncr);
+    }
+
+    while (sender_->getQueueSize() > 0 || listener_->amListening()) {
+        EXPECT_NO_THROW(io_service_.run_one());
+    }
+
+    // All of the requests were sent, but the rest of the second datagram
+    // was dropped and no receive is pending.
+    EXPECT_EQ(num_msgs, sent_ncrs_.size());
+    ASSERT_EQ(2, received_ncrs_.size());
+    EXPECT_TRUE(checkSendVsReceived(sent_ncrs_[1], received_ncrs_[1]));
+    EXPECT_FALSE(listener_->isIoPending());
+
+    EXPECT_NO_THROW(sender_->stopSending());
+}
+
 // Tests error handling of a failure to mark the watch socket ready, when
 // sendRequestt() is called.
 TEST(NameChangeUDPSenderBasicTest, watchClosedBeforeSendRequest) {
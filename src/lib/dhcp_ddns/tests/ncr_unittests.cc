@@ -586,6 +586,135 @@ TEST(NameChangeRequestTest, toFromBufferTest) {
     ASSERT_EQ(final_str, msg_str);
 }
 
+/// @brief Tests converting to and from the binary format.
+/// This test verifies that:
+/// 1. A NameChangeRequest can be rendered in binary format to an OutputBuffer
+/// 2. The format of the rendition is detected as binary, while the format
+/// of a JSON rendition is detected as JSON.
+/// 3. A NameChangeRequest created from the binary rendition matches the
+/// original, for both IPv4 and IPv6 addresses.
+TEST(NameChangeRequestTest, toFromBinaryTest) {
+    const char* addresses[] = { "192.168.2.1", "2001:1::f3" };
+    for (int i = 0; i < sizeof(addresses) / sizeof(char*); ++i) {
+        std::string msg_str = "{"
+                                "\"change_type\":1,"
+                                "\"forward_change\":true,"
+                                "\"reverse_change\":false,"
+                                "\"fqdn\":\"walah.walah.com.\","
+                                "\"ip_address\":\"" +
+                                std::string(addresses[i]) + "\","
+                                "\"dhcid\":\"010203040A7F8E3D\","
+                                "\"lease_expires_on\":\"20130121132405\","
+                                "\"lease_length\":1300"
+                              "}";
+        NameChangeRequestPtr ncr;
+        ASSERT_NO_THROW(ncr = NameChangeRequest::fromJSON(msg_str));
+
+        bundy::util::OutputBuffer output_buffer(1024);
+        ASSERT_NO_THROW(ncr->toFormat(FMT_BINARY, output_buffer));
+        // The binary rendition should be more compact than the JSON one.
+        EXPECT_GT(msg_str.size(), output_buffer.getLength());
+
+        bundy::util::InputBuffer input_buffer(output_buffer.getData(),
+                                            output_buffer.getLength());
+        EXPECT_EQ(FMT_BINARY, NameChangeRequest::detectFormat(input_buffer));
+        // Detection should not consume any data.
+        EXPECT_EQ(0, input_buffer.getPosition());
+
+        NameChangeRequestPtr ncr2;
+        ASSERT_NO_THROW(ncr2 = NameChangeRequest::fromFormat(FMT_BINARY,
+                                                             input_buffer));
+        EXPECT_EQ(input_buffer.getLength(), input_buffer.getPosition());
+        EXPECT_TRUE(*ncr == *ncr2);
+        EXPECT_EQ(msg_str, ncr2->toJSON());
+
+        // Verify that a JSON rendition is detected as such.
+        output_buffer.clear();
+        ASSERT_NO_THROW(ncr->toFormat(FMT_JSON, output_buffer));
+        bundy::util::InputBuffer json_buffer(output_buffer.getData(),
+                                           output_buffer.getLength());
+        EXPECT_EQ(FMT_JSON, NameChangeRequest::detectFormat(json_buffer));
+    }
+}
+
+/// @brief Tests that several requests may be read from the same buffer
+/// regardless of their format, and that invalid binary renditions are
+/// rejected.
+TEST(NameChangeRequestTest, multipleBinaryRequests) {
+    int num_msgs = sizeof(valid_msgs)/sizeof(char*);
+    std::vector<NameChangeRequestPtr> ncrs;
+    bundy::util::OutputBuffer output_buffer(1024);
+    for (int i = 0; i < num_msgs; ++i) {
+        NameChangeRequestPtr ncr;
+        ASSERT_NO_THROW(ncr = NameChangeRequest::fromJSON(valid_msgs[i]));
+        ASSERT_NO_THROW(ncr->toFormat((i % 2 ? FMT_JSON : FMT_BINARY),
+                                      output_buffer));
+        ncrs.push_back(ncr);
+    }
+
+    bundy::util::InputBuffer input_buffer(output_buffer.getData(),
+                                        output_buffer.getLength());
+    for (int i = 0; i < num_msgs; ++i) {
+        NameChangeRequestPtr ncr;
+        ASSERT_NO_THROW(ncr = NameChangeRequest::fromFormat(
+                        NameChangeRequest::detectFormat(input_buffer),
+                        input_buffer));
+        EXPECT_TRUE(*ncrs[i] == *ncr);
+    }
+    EXPECT_EQ(input_buffer.getLength(), input_buffer.getPosition());
+
+    // An empty buffer is not a request.
+    EXPECT_THROW(NameChangeRequest::detectFormat(input_buffer),
+                 NcrMessageError);
+
+    // Verify that a truncated rendition is rejected.
+    output_buffer.clear();
+    ASSERT_NO_THROW(ncrs[0]->toFormat(FMT_BINARY, output_buffer));
+    bundy::util::InputBuffer short_buffer(output_buffer.getData(),
+                                        output_buffer.getLength() - 1);
+    EXPECT_THROW(NameChangeRequest::fromFormat(FMT_BINARY, short_buffer),
+                 NcrMessageError);
+
+    // Verify that an unsupported version is rejected.
+    output_buffer.writeUint8At(NameChangeRequest::BINARY_FORMAT_VERSION + 1,
+                               sizeof(uint16_t));
+    bundy::util::InputBuffer bad_buffer(output_buffer.getData(),
+                                      output_buffer.getLength());
+    EXPECT_THROW(NameChangeRequest::fromFormat(FMT_BINARY, bad_buffer),
+                 NcrMessageError);
+}
+
+/// @brief Tests that a request too long for the 16-bit length of the binary
+/// format is refused rather than rendered with a truncated length.
+TEST(NameChangeRequestTest, binaryRequestTooLong) {
+    NameChangeRequestPtr ncr;
+    ASSERT_NO_THROW(ncr = NameChangeRequest::fromJSON(valid_msgs[0]));
+
+    // Make the DHCID as long as the request can hold: the fixed fields are
+    // the 4 octets of version, type, flags and family, the address, 12
+    // octets of lease times and the 2 octet DHCID and FQDN lengths.
+    ASSERT_TRUE(ncr->isV4());
+    const size_t max_dhcid = 0xffff - (4 + 4 + 12 + 2 + 2 +
+                                       ncr->getFqdn().size());
+    ASSERT_NO_THROW(ncr->setDhcid(std::string(max_dhcid * 2, 'A')));
+
+    bundy::util::OutputBuffer output_buffer(1024);
+    ASSERT_NO_THROW(ncr->toFormat(FMT_BINARY, output_buffer));
+    EXPECT_EQ(sizeof(uint16_t) + 0xffff, output_buffer.getLength());
+    bundy::util::InputBuffer input_buffer(output_buffer.getData(),
+                                        output_buffer.getLength());
+    NameChangeRequestPtr ncr2;
+    ASSERT_NO_THROW(ncr2 = NameChangeRequest::fromFormat(FMT_BINARY,
+                                                         input_buffer));
+    EXPECT_TRUE(*ncr == *ncr2);
+
+    // One more octet doesn't fit, and nothing is written.
+    ASSERT_NO_THROW(ncr->setDhcid(std::string((max_dhcid + 1) * 2, 'A')));
+    output_buffer.clear();
+    EXPECT_THROW(ncr->toFormat(FMT_BINARY, output_buffer), NcrMessageError);
+    EXPECT_EQ(0, output_buffer.getLength());
+}
+
 /// @brief Tests ip address modification and validation
 TEST(NameChangeRequestTest, ipAddresses) {
     NameChangeRequest ncr;
@@ -614,7 +743,12 @@ TEST(NameChangeFormatTest, formatEnumConversion){
     ASSERT_EQ(stringToNcrFormat("jSoN"), dhcp_ddns::FMT_JSON);
     ASSERT_THROW(stringToNcrFormat("bogus"), bundy::BadValue);
 
+    ASSERT_EQ(stringToNcrFormat("BINARY"), dhcp_ddns::FMT_BINARY);
+    ASSERT_EQ(stringToNcrFormat("binary"), dhcp_ddns::FMT_BINARY);
+    ASSERT_THROW(stringToNcrFormat("bogus"), bundy::BadValue);
+
     ASSERT_EQ(ncrFormatToString(dhcp_ddns::FMT_JSON), "JSON");
+    ASSERT_EQ(ncrFormatToString(dhcp_ddns::FMT_BINARY), "BINARY");
 }
 
 /// @brief Tests conversion of NameChangeProtocol between enum and strings.
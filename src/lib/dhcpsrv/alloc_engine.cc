@@ -19,6 +19,7 @@
 #include <hooks/server_hooks.h>
 #include <hooks/hooks_manager.h>
 
+#include <algorithm>
 #include <cstring>
 #include <vector>
 #include <string.h>
@@ -48,11 +49,67 @@ struct AllocEngineHooks {
 // module is called.
 AllocEngineHooks Hooks;
 
+/// @brief Returns the lease for the address from the collection of leases.
+///
+/// @param leases Collection of leases returned by the lease manager.
+/// @param addr Leased address.
+///
+/// @return Pointer to the lease or NULL pointer if the collection holds no
+/// lease for the address.
+template<typename LeaseCollection>
+typename LeaseCollection::value_type
+findLease(const LeaseCollection& leases, const IOAddress& addr) {
+    for (typename LeaseCollection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        if ((*lease)->addr_ == addr) {
+            return (*lease);
+        }
+    }
+    return (typename LeaseCollection::value_type());
+}
+
+/// @brief Returns the number of candidates to be checked in the next batch.
+///
+/// @param batch_size Size of the batch which would be used if the number of
+/// attempts was unlimited.
+/// @param attempts Configured number of attempts (0 means unlimited).
+/// @param left Number of attempts left.
+size_t
+candidateCount(const size_t batch_size, const unsigned int attempts,
+               const unsigned int left) {
+    if ((attempts > 0) && (left < batch_size)) {
+        return (left);
+    }
+    return (batch_size);
+}
+
+/// @brief Rewinds the allocator to the candidate which is being allocated.
+///
+/// All candidates of a batch are picked before they are checked, so the
+/// iterative allocator has already advanced past the last of them. When
+/// one of the candidates is allocated, the last allocated address of the
+/// subnet is set back to it, so as the remaining candidates are picked
+/// again by the subsequent allocations rather than skipped until the
+/// allocator wraps around. The other allocators don't use the last
+/// allocated address.
+///
+/// @param subnet Subnet the candidate belongs to.
+/// @param type Lease type.
+/// @param candidate Allocated candidate.
+void
+rewindAllocator(const bundy::dhcp::SubnetPtr& subnet,
+                const bundy::dhcp::Lease::Type type,
+                const IOAddress& candidate) {
+    subnet->setLastAllocated(type, candidate);
+}
+
 }; // anonymous namespace
 
 namespace bundy {
 namespace dhcp {
 
+const size_t AllocEngine::MAX_CANDIDATE_BATCH;
+
 AllocEngine::IterativeAllocator::IterativeAllocator(Lease::Type lease_type)
     :Allocator(lease_type) {
 }
@@ -403,67 +460,90 @@ AllocEngine::allocateLeases6(const Subnet6Ptr& subnet, const DuidPtr& duid,
         // We may consider some form or reference counting (this pool has X addresses
         // left), but this has one major problem. We exactly control allocation
         // moment, but we currently do not control expiration time at all
+        //
+        // The candidates are checked in batches, so as the lease database is
+        // queried once per batch rather than once per candidate. The first
+        // batch holds a single candidate, because the first address picked
+        // from a pool which isn't crowded is usually free. Each subsequent
+        // batch is twice as large as the previous one, up to the
+        // MAX_CANDIDATE_BATCH, so as a crowded pool is searched with few
+        // queries.
 
         unsigned int i = attempts_;
+        size_t batch_size = 1;
         do {
-            IOAddress candidate = allocator->pickAddress(subnet, duid, hint);
-
-            /// @todo: check if the address is reserved once we have host support
-            /// implemented
-
-            // The first step is to find out prefix length. It is 128 for
-            // non-PD leases.
-            uint8_t prefix_len = 128;
-            if (type == Lease::TYPE_PD) {
-                Pool6Ptr pool = boost::dynamic_pointer_cast<Pool6>(
-                    subnet->getPool(type, candidate, false));
-                prefix_len = pool->getLength();
+            LeaseMgr::AddressCollection candidates;
+            const size_t count = candidateCount(batch_size, attempts_, i);
+            for (size_t c = 0; c < count; ++c) {
+                candidates.push_back(allocator->pickAddress(subnet, duid, hint));
             }
+            const Lease6Collection leases = LeaseMgrFactory::instance().
+                getLeases6(type, candidates);
 
-            Lease6Ptr existing = LeaseMgrFactory::instance().getLease6(type,
-                                 candidate);
-            if (!existing) {
-
-                // there's no existing lease for selected candidate, so it is
-                // free. Let's allocate it.
+            for (LeaseMgr::AddressCollection::const_iterator candidate =
+                     candidates.begin(); candidate != candidates.end();
+                 ++candidate) {
 
-                Lease6Ptr lease = createLease6(subnet, duid, iaid, candidate,
-                                               prefix_len, type, fwd_dns_update,
-                                               rev_dns_update, hostname,
-                                               callout_handle, fake_allocation);
-                if (lease) {
-                    // We are allocating a new lease (not renewing). So, the
-                    // old lease should be NULL.
-                    old_leases.push_back(Lease6Ptr());
+                /// @todo: check if the address is reserved once we have host support
+                /// implemented
 
-                    Lease6Collection collection;
-                    collection.push_back(lease);
-                    return (collection);
+                // The first step is to find out prefix length. It is 128 for
+                // non-PD leases.
+                uint8_t prefix_len = 128;
+                if (type == Lease::TYPE_PD) {
+                    Pool6Ptr pool = boost::dynamic_pointer_cast<Pool6>(
+                        subnet->getPool(type, *candidate, false));
+                    prefix_len = pool->getLength();
                 }
 
-                // Although the address was free just microseconds ago, it may have
-                // been taken just now. If the lease insertion fails, we continue
-                // allocation attempts.
-            } else {
-                if (existing->expired()) {
-                    // Copy an existing, expired lease so as it can be returned
-                    // to the caller.
-                    Lease6Ptr old_lease(new Lease6(*existing));
-                    old_leases.push_back(old_lease);
-
-                    existing = reuseExpiredLease(existing, subnet, duid, iaid,
-                                                 prefix_len, fwd_dns_update,
-                                                 rev_dns_update, hostname,
-                                                 callout_handle, fake_allocation);
-                    Lease6Collection collection;
-                    collection.push_back(existing);
-                    return (collection);
+                Lease6Ptr existing = findLease(leases, *candidate);
+                if (!existing) {
+
+                    // there's no existing lease for selected candidate, so it is
+                    // free. Let's allocate it.
+
+                    Lease6Ptr lease = createLease6(subnet, duid, iaid, *candidate,
+                                                   prefix_len, type, fwd_dns_update,
+                                                   rev_dns_update, hostname,
+                                                   callout_handle, fake_allocation);
+                    if (lease) {
+                        rewindAllocator(subnet, type, *candidate);
+
+                        // We are allocating a new lease (not renewing). So, the
+                        // old lease should be NULL.
+                        old_leases.push_back(Lease6Ptr());
+
+                        Lease6Collection collection;
+                        collection.push_back(lease);
+                        return (collection);
+                    }
+
+                    // Although the address was free just microseconds ago, it may have
+                    // been taken just now. If the lease insertion fails, we continue
+                    // allocation attempts.
+                } else {
+                    if (existing->expired()) {
+                        // Copy an existing, expired lease so as it can be returned
+                        // to the caller.
+                        Lease6Ptr old_lease(new Lease6(*existing));
+                        old_leases.push_back(old_lease);
+
+                        existing = reuseExpiredLease(existing, subnet, duid, iaid,
+                                                     prefix_len, fwd_dns_update,
+                                                     rev_dns_update, hostname,
+                                                     callout_handle, fake_allocation);
+                        rewindAllocator(subnet, type, *candidate);
+                        Lease6Collection collection;
+                        collection.push_back(existing);
+                        return (collection);
+                    }
                 }
             }
 
             // Continue trying allocation until we run out of attempts
             // (or attempts are set to 0, which means infinite)
-            --i;
+            i -= count;
+            batch_size = std::min(2 * batch_size, MAX_CANDIDATE_BATCH);
         } while ((i > 0) || !attempts_);
 
         // Unable to allocate an address, return an empty lease.
@@ -593,43 +673,62 @@ AllocEngine::allocateLease4(const SubnetPtr& subnet, const ClientIdPtr& clientid
         // We may consider some form or reference counting (this pool has X addresses
         // left), but this has one major problem. We exactly control allocation
         // moment, but we currently do not control expiration time at all
+        //
+        // The candidates are checked in batches, as described in
+        // allocateLeases6.
 
         unsigned int i = attempts_;
+        size_t batch_size = 1;
         do {
-            IOAddress candidate = allocator->pickAddress(subnet, clientid, hint);
+            LeaseMgr::AddressCollection candidates;
+            const size_t count = candidateCount(batch_size, attempts_, i);
+            for (size_t c = 0; c < count; ++c) {
+                candidates.push_back(allocator->pickAddress(subnet, clientid,
+                                                            hint));
+            }
+            const Lease4Collection leases = LeaseMgrFactory::instance().
+                getLeases4(candidates);
 
-            /// @todo: check if the address is reserved once we have host support
-            /// implemented
+            for (LeaseMgr::AddressCollection::const_iterator candidate =
+                     candidates.begin(); candidate != candidates.end();
+                 ++candidate) {
 
-            Lease4Ptr existing = LeaseMgrFactory::instance().getLease4(candidate);
-            if (!existing) {
-                // there's no existing lease for selected candidate, so it is
-                // free. Let's allocate it.
-                Lease4Ptr lease = createLease4(subnet, clientid, hwaddr,
-                                               candidate, fwd_dns_update,
-                                               rev_dns_update, hostname,
-                                               callout_handle, fake_allocation);
-                if (lease) {
-                    return (lease);
-                }
+                /// @todo: check if the address is reserved once we have host support
+                /// implemented
 
-                // Although the address was free just microseconds ago, it may have
-                // been taken just now. If the lease insertion fails, we continue
-                // allocation attempts.
-            } else {
-                if (existing->expired()) {
-                    // Save old lease before reusing it.
-                    old_lease.reset(new Lease4(*existing));
-                    return (reuseExpiredLease(existing, subnet, clientid, hwaddr,
-                                              fwd_dns_update, rev_dns_update,
-                                              hostname, callout_handle,
-                                              fake_allocation));
+                Lease4Ptr existing = findLease(leases, *candidate);
+                if (!existing) {
+                    // there's no existing lease for selected candidate, so it is
+                    // free. Let's allocate it.
+                    Lease4Ptr lease = createLease4(subnet, clientid, hwaddr,
+                                                   *candidate, fwd_dns_update,
+                                                   rev_dns_update, hostname,
+                                                   callout_handle, fake_allocation);
+                    if (lease) {
+                        rewindAllocator(subnet, Lease::TYPE_V4, *candidate);
+                        return (lease);
+                    }
+
+                    // Although the address was free just microseconds ago, it may have
+                    // been taken just now. If the lease insertion fails, we continue
+                    // allocation attempts.
+                } else {
+                    if (existing->expired()) {
+                        // Save old lease before reusing it.
+                        old_lease.reset(new Lease4(*existing));
+                        rewindAllocator(subnet, Lease::TYPE_V4, *candidate);
+                        return (reuseExpiredLease(existing, subnet, clientid, hwaddr,
+                                                  fwd_dns_update, rev_dns_update,
+                                                  hostname, callout_handle,
+                                                  fake_allocation));
+                    }
                 }
             }
 
             // Continue trying allocation until we run out of attempts
             // (or attempts are set to 0, which means infinite)
-            --i;
+            i -= count;
+            batch_size = std::min(2 * batch_size, MAX_CANDIDATE_BATCH);
         } while ((i > 0) || !attempts_);
 
         // Unable to allocate an address, return an empty lease.
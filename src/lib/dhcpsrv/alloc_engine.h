@@ -527,6 +527,10 @@ private:
     /// @brief number of attempts before we give up lease allocation (0=unlimited)
     unsigned int attempts_;
 
+    /// @brief maximum number of candidate addresses checked with a single
+    /// lease database query
+    static const size_t MAX_CANDIDATE_BATCH = 16;
+
     // hook name indexes (used in hooks callouts)
     int hook_index_lease4_select_; ///< index for lease4_select hook
     int hook_index_lease6_select_; ///< index for lease6_select hook
@@ -0,0 +1,536 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcpsrv/caching_lease_mgr.h>
+#include <dhcpsrv/dhcpsrv_log.h>
+#include <exceptions/exceptions.h>
+
+#include <iterator>
+
+using namespace bundy::asiolink;
+using namespace bundy::dhcp;
+
+namespace {
+
+/// @brief Checks if the cached lease may be returned to the caller.
+///
+/// @param lease Cached lease.
+/// @param count Number of cached leases matching the search criteria.
+///
+/// @return true if the lease is the only lease matching the search criteria
+/// and it hasn't expired.
+bool
+isUsable(const Lease& lease, const size_t count = 1) {
+    return ((count == 1) && !lease.expired());
+}
+
+/// @brief Position of the least recently used order among the indexes of
+/// the @c Lease4CacheStorage.
+const int LRU_INDEX4 = 4;
+
+/// @brief Position of the least recently used order among the indexes of
+/// the @c Lease6CacheStorage.
+const int LRU_INDEX6 = 2;
+
+/// @brief Marks the cached lease as the most recently used one.
+///
+/// @param storage Container holding the lease.
+/// @param lease Iterator pointing to the lease, in any index of the
+/// container.
+template<int LruIndex, typename Storage, typename Iterator>
+void
+touchLease(Storage& storage, Iterator lease) {
+    typename Storage::template nth_index<LruIndex>::type& lru =
+        storage.template get<LruIndex>();
+    lru.relocate(lru.end(), storage.template project<LruIndex>(lease));
+}
+
+/// @brief Removes the least recently used leases until the number of
+/// cached leases doesn't exceed the capacity.
+///
+/// @param storage Container holding the leases.
+/// @param capacity Maximum number of leases (0 means no limit).
+template<int LruIndex, typename Storage>
+void
+evictLeases(Storage& storage, const uint32_t capacity) {
+    if (capacity == 0) {
+        return;
+    }
+    typename Storage::template nth_index<LruIndex>::type& lru =
+        storage.template get<LruIndex>();
+    while (lru.size() > capacity) {
+        lru.pop_front();
+    }
+}
+
+}; // end of anonymous namespace
+
+const uint32_t CachingLeaseMgr::DEFAULT_CACHE_SIZE;
+
+CachingLeaseMgr::CachingLeaseMgr(const ParameterMap& parameters,
+                                 LeaseMgr* backend)
+    : LeaseMgr(parameters), backend_(backend),
+      capacity_(getUnsignedParameter("cache-size", DEFAULT_CACHE_SIZE)) {
+    if (!backend_) {
+        bundy_throw(BadValue, "the lease cache requires a backend");
+    }
+}
+
+CachingLeaseMgr::~CachingLeaseMgr() {
+}
+
+bool
+CachingLeaseMgr::addLease(const Lease4Ptr& lease) {
+    bool added = false;
+    try {
+        added = backend_->addLease(lease);
+    } catch (...) {
+        uncacheLease(lease->addr_);
+        throw;
+    }
+
+    // If the lease couldn't be added, the backend holds a lease for this
+    // address which the cached copy (if any) doesn't reflect.
+    if (added) {
+        cacheLease(lease);
+    } else {
+        uncacheLease(lease->addr_);
+    }
+    return (added);
+}
+
+bool
+CachingLeaseMgr::addLease(const Lease6Ptr& lease) {
+    bool added = false;
+    try {
+        added = backend_->addLease(lease);
+    } catch (...) {
+        uncacheLease(lease->addr_);
+        throw;
+    }
+
+    if (added) {
+        cacheLease(lease);
+    } else {
+        uncacheLease(lease->addr_);
+    }
+    return (added);
+}
+
+bool
+CachingLeaseMgr::addLeases(const Lease4Collection& leases) {
+    bool added = false;
+    try {
+        added = backend_->addLeases(leases);
+    } catch (...) {
+        for (Lease4Collection::const_iterator lease = leases.begin();
+             lease != leases.end(); ++lease) {
+            uncacheLease((*lease)->addr_);
+        }
+        throw;
+    }
+
+    for (Lease4Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        if (added) {
+            cacheLease(*lease);
+        } else {
+            uncacheLease((*lease)->addr_);
+        }
+    }
+    return (added);
+}
+
+bool
+CachingLeaseMgr::addLeases(const Lease6Collection& leases) {
+    bool added = false;
+    try {
+        added = backend_->addLeases(leases);
+    } catch (...) {
+        for (Lease6Collection::const_iterator lease = leases.begin();
+             lease != leases.end(); ++lease) {
+            uncacheLease((*lease)->addr_);
+        }
+        throw;
+    }
+
+    for (Lease6Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        if (added) {
+            cacheLease(*lease);
+        } else {
+            uncacheLease((*lease)->addr_);
+        }
+    }
+    return (added);
+}
+
+Lease4Ptr
+CachingLeaseMgr::getLease4(const IOAddress& addr) const {
+    Lease4CacheStorage::iterator cached = storage4_.find(addr);
+    if (cached != storage4_.end()) {
+        if (isUsable(**cached)) {
+            LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+                      DHCPSRV_LEASE_CACHE_HIT).arg(addr.toText());
+            touchLease<LRU_INDEX4>(storage4_, cached);
+            return (Lease4Ptr(new Lease4(**cached)));
+        }
+        storage4_.erase(cached);
+    }
+
+    Lease4Ptr lease = backend_->getLease4(addr);
+    if (lease) {
+        cacheLease(lease);
+    }
+    return (lease);
+}
+
+Lease4Collection
+CachingLeaseMgr::getLeases4(const AddressCollection& addrs) const {
+    Lease4Collection collection;
+    AddressCollection missing;
+    for (AddressCollection::const_iterator addr = addrs.begin();
+         addr != addrs.end(); ++addr) {
+        Lease4CacheStorage::iterator cached = storage4_.find(*addr);
+        if ((cached != storage4_.end()) && isUsable(**cached)) {
+            touchLease<LRU_INDEX4>(storage4_, cached);
+            collection.push_back(Lease4Ptr(new Lease4(**cached)));
+        } else {
+            uncacheLease(*addr);
+            missing.push_back(*addr);
+        }
+    }
+
+    // Get all leases which aren't in the cache with a single call.
+    if (!missing.empty()) {
+        Lease4Collection leases = backend_->getLeases4(missing);
+        for (Lease4Collection::const_iterator lease = leases.begin();
+             lease != leases.end(); ++lease) {
+            cacheLease(*lease);
+            collection.push_back(*lease);
+        }
+    }
+    return (collection);
+}
+
+Lease4Collection
+CachingLeaseMgr::getLease4(const HWAddr& hwaddr) const {
+    Lease4Collection collection = backend_->getLease4(hwaddr);
+    for (Lease4Collection::const_iterator lease = collection.begin();
+         lease != collection.end(); ++lease) {
+        cacheLease(*lease);
+    }
+    return (collection);
+}
+
+Lease4Ptr
+CachingLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
+    typedef Lease4CacheStorage::nth_index<1>::type SearchIndex;
+    SearchIndex& idx = storage4_.get<1>();
+    SearchIndex::iterator cached =
+        idx.find(boost::make_tuple(hwaddr.hwaddr_, subnet_id));
+    if (cached != idx.end()) {
+        if (isUsable(**cached)) {
+            LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+                      DHCPSRV_LEASE_CACHE_HIT).arg((*cached)->addr_.toText());
+            touchLease<LRU_INDEX4>(storage4_, cached);
+            return (Lease4Ptr(new Lease4(**cached)));
+        }
+        idx.erase(cached);
+    }
+
+    Lease4Ptr lease = backend_->getLease4(hwaddr, subnet_id);
+    if (lease) {
+        cacheLease(lease);
+    }
+    return (lease);
+}
+
+Lease4Collection
+CachingLeaseMgr::getLease4(const ClientId& client_id) const {
+    Lease4Collection collection = backend_->getLease4(client_id);
+    for (Lease4Collection::const_iterator lease = collection.begin();
+         lease != collection.end(); ++lease) {
+        cacheLease(*lease);
+    }
+    return (collection);
+}
+
+Lease4Ptr
+CachingLeaseMgr::getLease4(const ClientId& client_id, const HWAddr& hwaddr,
+                           SubnetID subnet_id) const {
+    typedef Lease4CacheStorage::nth_index<3>::type SearchIndex;
+    SearchIndex& idx = storage4_.get<3>();
+    std::pair<SearchIndex::iterator, SearchIndex::iterator> range =
+        idx.equal_range(boost::make_tuple(client_id.getClientId(),
+                                          hwaddr.hwaddr_, subnet_id));
+    if (range.first != range.second) {
+        if (isUsable(**range.first,
+                     std::distance(range.first, range.second))) {
+            LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+                      DHCPSRV_LEASE_CACHE_HIT)
+                .arg((*range.first)->addr_.toText());
+            touchLease<LRU_INDEX4>(storage4_, range.first);
+            return (Lease4Ptr(new Lease4(**range.first)));
+        }
+        idx.erase(range.first, range.second);
+    }
+
+    Lease4Ptr lease = backend_->getLease4(client_id, hwaddr, subnet_id);
+    if (lease) {
+        cacheLease(lease);
+    }
+    return (lease);
+}
+
+Lease4Ptr
+CachingLeaseMgr::getLease4(const ClientId& client_id,
+                           SubnetID subnet_id) const {
+    typedef Lease4CacheStorage::nth_index<2>::type SearchIndex;
+    SearchIndex& idx = storage4_.get<2>();
+    std::pair<SearchIndex::iterator, SearchIndex::iterator> range =
+        idx.equal_range(boost::make_tuple(client_id.getClientId(), subnet_id));
+    if (range.first != range.second) {
+        if (isUsable(**range.first,
+                     std::distance(range.first, range.second))) {
+            LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+                      DHCPSRV_LEASE_CACHE_HIT)
+                .arg((*range.first)->addr_.toText());
+            touchLease<LRU_INDEX4>(storage4_, range.first);
+            return (Lease4Ptr(new Lease4(**range.first)));
+        }
+        idx.erase(range.first, range.second);
+    }
+
+    Lease4Ptr lease = backend_->getLease4(client_id, subnet_id);
+    if (lease) {
+        cacheLease(lease);
+    }
+    return (lease);
+}
+
+Lease6Ptr
+CachingLeaseMgr::getLease6(Lease::Type type, const IOAddress& addr) const {
+    Lease6CacheStorage::iterator cached = storage6_.find(addr);
+    if (cached != storage6_.end()) {
+        if (((*cached)->type_ == type) && isUsable(**cached)) {
+            LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+                      DHCPSRV_LEASE_CACHE_HIT).arg(addr.toText());
+            touchLease<LRU_INDEX6>(storage6_, cached);
+            return (Lease6Ptr(new Lease6(**cached)));
+        }
+        storage6_.erase(cached);
+    }
+
+    Lease6Ptr lease = backend_->getLease6(type, addr);
+    if (lease) {
+        cacheLease(lease);
+    }
+    return (lease);
+}
+
+Lease6Collection
+CachingLeaseMgr::getLeases6(Lease::Type type,
+                            const AddressCollection& addrs) const {
+    Lease6Collection collection;
+    AddressCollection missing;
+    for (AddressCollection::const_iterator addr = addrs.begin();
+         addr != addrs.end(); ++addr) {
+        Lease6CacheStorage::iterator cached = storage6_.find(*addr);
+        if ((cached != storage6_.end()) && ((*cached)->type_ == type) &&
+            isUsable(**cached)) {
+            touchLease<LRU_INDEX6>(storage6_, cached);
+            collection.push_back(Lease6Ptr(new Lease6(**cached)));
+        } else {
+            uncacheLease(*addr);
+            missing.push_back(*addr);
+        }
+    }
+
+    if (!missing.empty()) {
+        Lease6Collection leases = backend_->getLeases6(type, missing);
+        for (Lease6Collection::const_iterator lease = leases.begin();
+             lease != leases.end(); ++lease) {
+            cacheLease(*lease);
+            collection.push_back(*lease);
+        }
+    }
+    return (collection);
+}
+
+Lease6Collection
+CachingLeaseMgr::getLeases6(Lease::Type type, const DUID& duid,
+                            uint32_t iaid) const {
+    Lease6Collection collection = backend_->getLeases6(type, duid, iaid);
+    for (Lease6Collection::const_iterator lease = collection.begin();
+         lease != collection.end(); ++lease) {
+        cacheLease(*lease);
+    }
+    return (collection);
+}
+
+Lease6Collection
+CachingLeaseMgr::getLeases6(Lease::Type type, const DUID& duid,
+                            uint32_t iaid, SubnetID subnet_id) const {
+    Lease6Collection collection = backend_->getLeases6(type, duid, iaid,
+                                                       subnet_id);
+    for (Lease6Collection::const_iterator lease = collection.begin();
+         lease != collection.end(); ++lease) {
+        cacheLease(*lease);
+    }
+    return (collection);
+}
+
+void
+CachingLeaseMgr::updateLease4(const Lease4Ptr& lease) {
+    try {
+        backend_->updateLease4(lease);
+    } catch (...) {
+        uncacheLease(lease->addr_);
+        throw;
+    }
+    cacheLease(lease);
+}
+
+void
+CachingLeaseMgr::updateLease6(const Lease6Ptr& lease) {
+    try {
+        backend_->updateLease6(lease);
+    } catch (...) {
+        uncacheLease(lease->addr_);
+        throw;
+    }
+    cacheLease(lease);
+}
+
+void
+CachingLeaseMgr::updateLeases4(const Lease4Collection& leases) {
+    try {
+        backend_->updateLeases4(leases);
+    } catch (...) {
+        for (Lease4Collection::const_iterator lease = leases.begin();
+             lease != leases.end(); ++lease) {
+            uncacheLease((*lease)->addr_);
+        }
+        throw;
+    }
+
+    for (Lease4Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        cacheLease(*lease);
+    }
+}
+
+void
+CachingLeaseMgr::updateLeases6(const Lease6Collection& leases) {
+    try {
+        backend_->updateLeases6(leases);
+    } catch (...) {
+        for (Lease6Collection::const_iterator lease = leases.begin();
+             lease != leases.end(); ++lease) {
+            uncacheLease((*lease)->addr_);
+        }
+        throw;
+    }
+
+    for (Lease6Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        cacheLease(*lease);
+    }
+}
+
+bool
+CachingLeaseMgr::deleteLease(const IOAddress& addr) {
+    // Remove the lease from the cache first, so as it is not returned
+    // even if the backend fails to delete it.
+    uncacheLease(addr);
+    return (backend_->deleteLease(addr));
+}
+
+std::string
+CachingLeaseMgr::getType() const {
+    return (backend_->getType());
+}
+
+std::string
+CachingLeaseMgr::getName() const {
+    return (backend_->getName());
+}
+
+std::string
+CachingLeaseMgr::getDescription() const {
+    return (std::string("Write-through lease cache in front of the "
+                        "following backend:\n") +
+            backend_->getDescription());
+}
+
+std::pair<uint32_t, uint32_t>
+CachingLeaseMgr::getVersion() const {
+    return (backend_->getVersion());
+}
+
+void
+CachingLeaseMgr::commit() {
+    backend_->commit();
+}
+
+void
+CachingLeaseMgr::rollback() {
+    clearCache();
+    backend_->rollback();
+}
+
+void
+CachingLeaseMgr::clearCache() {
+    storage4_.clear();
+    storage6_.clear();
+}
+
+void
+CachingLeaseMgr::cacheLease(const Lease4Ptr& lease) const {
+    storage4_.erase(lease->addr_);
+    typedef Lease4CacheStorage::nth_index<1>::type SearchIndex;
+    SearchIndex& idx = storage4_.get<1>();
+    SearchIndex::iterator conflict =
+        idx.find(boost::make_tuple(lease->hwaddr_, lease->subnet_id_));
+    if (conflict != idx.end()) {
+        idx.erase(conflict);
+    }
+    storage4_.insert(Lease4Ptr(new Lease4(*lease)));
+    evictLeases<LRU_INDEX4>(storage4_, capacity_);
+}
+
+void
+CachingLeaseMgr::cacheLease(const Lease6Ptr& lease) const {
+    storage6_.erase(lease->addr_);
+    typedef Lease6CacheStorage::nth_index<1>::type SearchIndex;
+    SearchIndex& idx = storage6_.get<1>();
+    SearchIndex::iterator conflict =
+        idx.find(boost::make_tuple(lease->getDuidVector(), lease->iaid_,
+                                   lease->subnet_id_));
+    if (conflict != idx.end()) {
+        idx.erase(conflict);
+    }
+    storage6_.insert(Lease6Ptr(new Lease6(*lease)));
+    evictLeases<LRU_INDEX6>(storage6_, capacity_);
+}
+
+void
+CachingLeaseMgr::uncacheLease(const IOAddress& addr) const {
+    if (addr.isV4()) {
+        storage4_.erase(addr);
+    } else {
+        storage6_.erase(addr);
+    }
+}
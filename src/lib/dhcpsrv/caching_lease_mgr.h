@@ -0,0 +1,327 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef CACHING_LEASE_MGR_H
+#define CACHING_LEASE_MGR_H
+
+#include <dhcp/hwaddr.h>
+#include <dhcpsrv/lease_mgr.h>
+#include <dhcpsrv/memfile_lease_storage.h>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bundy {
+namespace dhcp {
+
+/// @brief Write-through lease cache in front of another lease manager.
+///
+/// With the SQL backends, each lease lookup performed by the server is a
+/// query to the database, even when the server is renewing the lease it has
+/// written itself a moment ago. This class implements the @c LeaseMgr
+/// interface on top of another lease manager (the backend) and keeps
+/// copies of the leases it has read from or written to the backend in the
+/// same multi-index containers as the @c Memfile_LeaseMgr uses.
+///
+/// The writes are always passed to the backend. When the write succeeds,
+/// the cached copy of the lease is replaced with the written lease. When it
+/// fails, the cached copy is removed, as the state of the lease in the
+/// backend is unknown.
+///
+/// The lookups returning a single lease are served from the cache when it
+/// holds a lease matching the search criteria which has not expired.
+/// Otherwise, the lookup is passed to the backend and its result is cached.
+/// The lookups returning collections of leases are always passed to the
+/// backend, because the cache can't tell whether it holds all matching
+/// leases, but their results are cached as well.
+///
+/// The cache assumes that while the lease is valid, the client is served
+/// by this server only, i.e. that another server sharing the database
+/// doesn't modify the lease before it expires. An expired lease may be
+/// reused by another server, so the expired leases are never served from
+/// the cache.
+///
+/// The number of cached leases is limited, separately for IPv4 and IPv6
+/// leases, by the "cache-size=[count]" parameter (@c DEFAULT_CACHE_SIZE by
+/// default, 0 means no limit). When the limit is reached, the least
+/// recently used lease, i.e. the lease which was cached or returned from
+/// the cache before all other leases, is removed from the cache.
+///
+/// The cache is enabled by the "cache=true" parameter of the database access
+/// string. It is meant to be used with the SQL backends.
+class CachingLeaseMgr : public LeaseMgr {
+public:
+
+    /// @brief Default maximum number of cached leases of each universe.
+    static const uint32_t DEFAULT_CACHE_SIZE = 65536;
+
+    /// @brief Constructor.
+    ///
+    /// @param parameters A data structure relating keywords and values
+    ///        concerned with the database.
+    /// @param backend Lease manager to which the lease operations are
+    ///        passed. The cache takes ownership of this object.
+    ///
+    /// @throw bundy::BadValue if the backend is NULL or the value of the
+    ///        "cache-size" parameter is invalid.
+    CachingLeaseMgr(const ParameterMap& parameters, LeaseMgr* backend);
+
+    /// @brief Destructor.
+    virtual ~CachingLeaseMgr();
+
+    /// @brief Adds an IPv4 lease.
+    ///
+    /// @param lease lease to be added
+    virtual bool addLease(const Lease4Ptr& lease);
+
+    /// @brief Adds an IPv6 lease.
+    ///
+    /// @param lease lease to be added
+    virtual bool addLease(const Lease6Ptr& lease);
+
+    /// @brief Adds a group of IPv4 leases.
+    ///
+    /// @param leases leases to be added
+    virtual bool addLeases(const Lease4Collection& leases);
+
+    /// @brief Adds a group of IPv6 leases.
+    ///
+    /// @param leases leases to be added
+    virtual bool addLeases(const Lease6Collection& leases);
+
+    /// @brief Returns existing IPv4 lease for specified IPv4 address.
+    ///
+    /// @param addr An address of the searched lease.
+    ///
+    /// @return a collection of leases
+    virtual Lease4Ptr getLease4(const bundy::asiolink::IOAddress& addr) const;
+
+    /// @brief Returns existing IPv4 leases for the specified addresses.
+    ///
+    /// The addresses not found in the cache are looked up in the backend
+    /// with a single call to its @c getLeases4.
+    ///
+    /// @param addrs Addresses of the searched leases.
+    ///
+    /// @return collection of IPv4 leases
+    virtual Lease4Collection getLeases4(const AddressCollection& addrs) const;
+
+    /// @brief Returns existing IPv4 leases for specified hardware address.
+    ///
+    /// @param hwaddr hardware address of the client
+    ///
+    /// @return lease collection
+    virtual Lease4Collection getLease4(const bundy::dhcp::HWAddr& hwaddr) const;
+
+    /// @brief Returns existing IPv4 leases for specified hardware address
+    ///        and a subnet
+    ///
+    /// @param hwaddr hardware address of the client
+    /// @param subnet_id identifier of the subnet that lease must belong to
+    ///
+    /// @return a pointer to the lease (or NULL if a lease is not found)
+    virtual Lease4Ptr getLease4(const HWAddr& hwaddr,
+                                SubnetID subnet_id) const;
+
+    /// @brief Returns existing IPv4 lease for specified client-id
+    ///
+    /// @param client_id client identifier
+    ///
+    /// @return lease collection
+    virtual Lease4Collection getLease4(const ClientId& client_id) const;
+
+    /// @brief Returns IPv4 lease for specified client-id/hwaddr/subnet-id tuple
+    ///
+    /// @param clientid client identifier
+    /// @param hwaddr hardware address of the client
+    /// @param subnet_id identifier of the subnet that lease must belong to
+    ///
+    /// @return a pointer to the lease (or NULL if a lease is not found)
+    virtual Lease4Ptr getLease4(const ClientId& clientid,
+                                const HWAddr& hwaddr,
+                                SubnetID subnet_id) const;
+
+    /// @brief Returns existing IPv4 lease for specified client-id
+    ///
+    /// @param clientid client identifier
+    /// @param subnet_id identifier of the subnet that lease must belong to
+    ///
+    /// @return a pointer to the lease (or NULL if a lease is not found)
+    virtual Lease4Ptr getLease4(const ClientId& clientid,
+                                SubnetID subnet_id) const;
+
+    /// @brief Returns existing IPv6 lease for a given IPv6 address.
+    ///
+    /// @param type specifies lease type: (NA, TA or PD)
+    /// @param addr An address of the searched lease.
+    ///
+    /// @return smart pointer to the lease (or NULL if a lease is not found)
+    virtual Lease6Ptr getLease6(Lease::Type type,
+                                const bundy::asiolink::IOAddress& addr) const;
+
+    /// @brief Returns existing IPv6 leases for the specified addresses.
+    ///
+    /// @param type specifies lease type: (NA, TA or PD)
+    /// @param addrs Addresses of the searched leases.
+    ///
+    /// @return collection of IPv6 leases
+    virtual Lease6Collection getLeases6(Lease::Type type,
+                                        const AddressCollection& addrs) const;
+
+    /// @brief Returns existing IPv6 lease for a given DUID+IA combination
+    ///
+    /// @param type specifies lease type: (NA, TA or PD)
+    /// @param duid client DUID
+    /// @param iaid IA identifier
+    ///
+    /// @return collection of IPv6 leases
+    virtual Lease6Collection getLeases6(Lease::Type type,
+                                        const DUID& duid, uint32_t iaid) const;
+
+    /// @brief Returns existing IPv6 lease for a given DUID/IA/subnet-id tuple
+    ///
+    /// @param type specifies lease type: (NA, TA or PD)
+    /// @param duid client DUID
+    /// @param iaid IA identifier
+    /// @param subnet_id identifier of the subnet the lease must belong to
+    ///
+    /// @return lease collection (may be empty if no lease is found)
+    virtual Lease6Collection getLeases6(Lease::Type type, const DUID& duid,
+                                        uint32_t iaid, SubnetID subnet_id) const;
+
+    /// @brief Updates IPv4 lease.
+    ///
+    /// @param lease4 The lease to be updated.
+    ///
+    /// @throw bundy::dhcp::NoSuchLease if the backend has no such lease.
+    virtual void updateLease4(const Lease4Ptr& lease4);
+
+    /// @brief Updates IPv6 lease.
+    ///
+    /// @param lease6 The lease to be updated.
+    ///
+    /// @throw bundy::dhcp::NoSuchLease if the backend has no such lease.
+    virtual void updateLease6(const Lease6Ptr& lease6);
+
+    /// @brief Updates a group of IPv4 leases.
+    ///
+    /// @param leases The leases to be updated.
+    virtual void updateLeases4(const Lease4Collection& leases);
+
+    /// @brief Updates a group of IPv6 leases.
+    ///
+    /// @param leases The leases to be updated.
+    virtual void updateLeases6(const Lease6Collection& leases);
+
+    /// @brief Deletes a lease.
+    ///
+    /// @param addr Address of the lease to be deleted. (This can be IPv4 or
+    ///        IPv6.)
+    ///
+    /// @return true if deletion was successful, false if no such lease exists
+    virtual bool deleteLease(const bundy::asiolink::IOAddress& addr);
+
+    /// @brief Returns the type of the backend.
+    virtual std::string getType() const;
+
+    /// @brief Returns the name of the backend database.
+    virtual std::string getName() const;
+
+    /// @brief Returns description of the backend.
+    virtual std::string getDescription() const;
+
+    /// @brief Returns the version of the backend.
+    virtual std::pair<uint32_t, uint32_t> getVersion() const;
+
+    /// @brief Commits the transaction in the backend.
+    virtual void commit();
+
+    /// @brief Rolls back the transaction in the backend.
+    ///
+    /// The cache holds the leases which have been written within the
+    /// transaction, so it is cleared.
+    virtual void rollback();
+
+    /// @brief Returns the backend.
+    LeaseMgr& getBackend() const {
+        return (*backend_);
+    }
+
+    /// @brief Returns the number of cached IPv4 leases.
+    size_t getCacheSize4() const {
+        return (storage4_.size());
+    }
+
+    /// @brief Returns the number of cached IPv6 leases.
+    size_t getCacheSize6() const {
+        return (storage6_.size());
+    }
+
+    /// @brief Returns the maximum number of cached leases of each universe.
+    ///
+    /// @return The limit or 0 if the number of cached leases is not
+    /// limited.
+    uint32_t getCacheCapacity() const {
+        return (capacity_);
+    }
+
+    /// @brief Removes all leases from the cache.
+    void clearCache();
+
+private:
+
+    /// @brief Stores a copy of the IPv4 lease in the cache.
+    ///
+    /// The cached leases conflicting with the stored one, i.e. having the
+    /// same address or the same hardware address and subnet, are removed.
+    /// If the cache is full, the least recently used lease is removed.
+    ///
+    /// @param lease Lease to be cached.
+    void cacheLease(const Lease4Ptr& lease) const;
+
+    /// @brief Stores a copy of the IPv6 lease in the cache.
+    ///
+    /// The cached leases conflicting with the stored one, i.e. having the
+    /// same address or the same DUID, IAID and subnet, are removed.
+    /// If the cache is full, the least recently used lease is removed.
+    ///
+    /// @param lease Lease to be cached.
+    void cacheLease(const Lease6Ptr& lease) const;
+
+    /// @brief Removes the lease for the address from the cache.
+    ///
+    /// @param addr Address of the lease (IPv4 or IPv6).
+    void uncacheLease(const bundy::asiolink::IOAddress& addr) const;
+
+    /// @brief Lease manager to which the operations are passed.
+    boost::scoped_ptr<LeaseMgr> backend_;
+
+    /// @brief Maximum number of cached leases of each universe (0 means
+    /// no limit).
+    uint32_t capacity_;
+
+    /// @brief Cached IPv4 leases.
+    mutable Lease4CacheStorage storage4_;
+
+    /// @brief Cached IPv6 leases.
+    mutable Lease6CacheStorage storage6_;
+};
+
+}; // end of bundy::dhcp namespace
+}; // end of bundy namespace
+
+#endif // CACHING_LEASE_MGR_H
@@ -77,12 +77,21 @@ D2ClientMgr::setD2ClientConfig(D2ClientConfigPtr& new_config) {
                 uint32_t queue_max = 1024;
 
                 // Instantiate a new sender.
-                new_sender.reset(new dhcp_ddns::NameChangeUDPSender(
+                dhcp_ddns::NameChangeUDPSender* udp_sender =
+                    new dhcp_ddns::NameChangeUDPSender(
                                                 any_addr, any_port,
                                                 new_config->getServerIp(),
                                                 new_config->getServerPort(),
                                                 new_config->getNcrFormat(),
-                                                *this, queue_max));
+                                                *this, queue_max);
+                new_sender.reset(udp_sender);
+
+                // Listeners accepting the binary format also accept more
+                // than one request per datagram, so let the sender pack
+                // the queued requests together.
+                if (new_config->getNcrFormat() == dhcp_ddns::FMT_BINARY) {
+                    udp_sender->setMaxBatchSize(MAX_NCR_BATCH_SIZE);
+                }
                 break;
                 }
             default:
@@ -84,6 +84,11 @@ boost::function<void(const dhcp_ddns::NameChangeSender::Result result,
 class D2ClientMgr : public dhcp_ddns::NameChangeSender::RequestSendHandler,
                     boost::noncopyable {
 public:
+    /// @brief Maximum number of requests sent in one datagram.
+    ///
+    /// Batching is only used with the binary request format.
+    static const size_t MAX_NCR_BATCH_SIZE = 16;
+
     /// @brief Constructor
     ///
     /// Default constructor which constructs an instance which has DHCP-DDNS
@@ -0,0 +1,728 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcpsrv/dhcpsrv_log.h>
+#include <dhcpsrv/lease_log.h>
+
+#include <boost/bind.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace bundy::asiolink;
+using namespace bundy::util;
+using namespace bundy::util::thread;
+
+namespace {
+
+/// @brief Length of the MAGIC string.
+const size_t MAGIC_LEN = 8;
+
+/// @brief Length of the file header: magic string and version.
+const size_t HEADER_LEN = MAGIC_LEN + sizeof(uint32_t);
+
+/// @brief Length of the record length and checksum fields.
+const size_t FRAME_OVERHEAD = 2 * sizeof(uint32_t);
+
+/// @brief Record types.
+const uint8_t RECORD_LEASE4 = 4;
+const uint8_t RECORD_LEASE6 = 6;
+
+/// @brief Calculates Adler-32 checksum of the data.
+uint32_t
+checksum(const uint8_t* data, size_t len) {
+    const uint32_t MOD_ADLER = 65521;
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (size_t i = 0; i < len; ++i) {
+        a = (a + data[i]) % MOD_ADLER;
+        b = (b + a) % MOD_ADLER;
+    }
+    return ((b << 16) | a);
+}
+
+/// @brief Reads a 32-bit integer in network byte order.
+uint32_t
+readUint32At(const uint8_t* data) {
+    return ((static_cast<uint32_t>(data[0]) << 24) |
+            (static_cast<uint32_t>(data[1]) << 16) |
+            (static_cast<uint32_t>(data[2]) << 8) |
+            static_cast<uint32_t>(data[3]));
+}
+
+/// @brief Writes the data to the file and syncs it to the stable storage.
+///
+/// @return Empty string on success, description of the error otherwise.
+std::string
+writeAndSync(const int fd, const std::vector<uint8_t>& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t result = write(fd, &data[written],
+                                     data.size() - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (std::strerror(errno));
+        }
+        written += result;
+    }
+    if (fdatasync(fd) != 0) {
+        return (std::strerror(errno));
+    }
+    return ("");
+}
+
+/// @brief Writes a variable length field preceded by its length.
+void
+writeField(const uint8_t* data, const size_t len, OutputBuffer& buf) {
+    if (len > 0xFFFF) {
+        bundy_throw(bundy::dhcp::LeaseLogError, "lease field of length "
+                    << len << " is too long to be stored in the lease file");
+    }
+    buf.writeUint16(len);
+    if (len > 0) {
+        buf.writeData(data, len);
+    }
+}
+
+/// @brief Reads a variable length field preceded by its length.
+void
+readField(InputBuffer& buf, std::vector<uint8_t>& data) {
+    const uint16_t len = buf.readUint16();
+    data.clear();
+    if (len > 0) {
+        buf.readVector(data, len);
+    }
+}
+
+/// @brief Writes the client last transmission time.
+void
+writeCltt(const time_t cltt, OutputBuffer& buf) {
+    const uint64_t value = static_cast<uint64_t>(cltt);
+    buf.writeUint32(static_cast<uint32_t>(value >> 32));
+    buf.writeUint32(static_cast<uint32_t>(value));
+}
+
+/// @brief Reads the client last transmission time.
+time_t
+readCltt(InputBuffer& buf) {
+    uint64_t value = static_cast<uint64_t>(buf.readUint32()) << 32;
+    value |= buf.readUint32();
+    return (static_cast<time_t>(value));
+}
+
+/// @brief Returns the name of the directory holding the file.
+std::string
+getDirectory(const std::string& filename) {
+    const size_t pos = filename.rfind('/');
+    if (pos == std::string::npos) {
+        return (".");
+    }
+    return (pos == 0 ? "/" : filename.substr(0, pos));
+}
+
+}
+
+namespace bundy {
+namespace dhcp {
+
+const char* LeaseLog::MAGIC = "LEASELOG";
+
+LeaseLog::LeaseLog(const std::string& filename, const uint32_t commit_window)
+    : filename_(filename), commit_window_(commit_window), fd_(-1),
+      read_pos_(0), queued_seq_(0), durable_seq_(0), flushing_(false),
+      append_count_(0), sync_count_(0), compacting_(false) {
+}
+
+LeaseLog::~LeaseLog() {
+    close();
+}
+
+void
+LeaseLog::open() {
+    // Close the file if it is open already.
+    close();
+
+    const int fd = ::open(filename_.c_str(), O_RDWR | O_CREAT | O_APPEND,
+                          S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd < 0) {
+        bundy_throw(LeaseLogError, "unable to open '" << filename_
+                    << "': " << std::strerror(errno));
+    }
+
+    try {
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            bundy_throw(LeaseLogError, "unable to stat '" << filename_
+                        << "': " << std::strerror(errno));
+        }
+
+        read_buf_.clear();
+        if (st.st_size == 0) {
+            // This is a new file, write the header.
+            OutputBuffer header(HEADER_LEN);
+            header.writeData(MAGIC, MAGIC_LEN);
+            header.writeUint32(VERSION);
+            const uint8_t* data =
+                static_cast<const uint8_t*>(header.getData());
+            const std::string error =
+                writeAndSync(fd, std::vector<uint8_t>(data, data + HEADER_LEN));
+            if (!error.empty()) {
+                bundy_throw(LeaseLogError, "unable to write header to '"
+                            << filename_ << "': " << error);
+            }
+
+        } else {
+            // Read the whole file. The records will be parsed by next().
+            read_buf_.resize(st.st_size);
+            size_t offset = 0;
+            while (offset < read_buf_.size()) {
+                const ssize_t result = pread(fd, &read_buf_[offset],
+                                             read_buf_.size() - offset,
+                                             offset);
+                if (result < 0 && errno == EINTR) {
+                    continue;
+                } else if (result <= 0) {
+                    bundy_throw(LeaseLogError, "unable to read '"
+                                << filename_ << "'");
+                }
+                offset += result;
+            }
+            if ((read_buf_.size() < HEADER_LEN) ||
+                (std::memcmp(&read_buf_[0], MAGIC, MAGIC_LEN) != 0)) {
+                bundy_throw(LeaseLogError, "'" << filename_
+                            << "' is not a lease log file");
+            }
+            const uint32_t version = readUint32At(&read_buf_[MAGIC_LEN]);
+            if (version != VERSION) {
+                bundy_throw(LeaseLogError, "unsupported version " << version
+                            << " of the lease log file '" << filename_
+                            << "'");
+            }
+        }
+
+    } catch (...) {
+        read_buf_.clear();
+        ::close(fd);
+        throw;
+    }
+
+    read_pos_ = HEADER_LEN;
+    read_msg_.clear();
+
+    Mutex::Locker lock(mutex_);
+    fd_ = fd;
+    write_error_.clear();
+    append_count_ = 0;
+}
+
+void
+LeaseLog::close() {
+    waitForCompaction();
+
+    Mutex::Locker lock(mutex_);
+    // Let the thread committing the records finish its write.
+    while (flushing_) {
+        cond_.wait(mutex_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    read_buf_.clear();
+}
+
+void
+LeaseLog::append(const Lease4& lease) {
+    OutputBuffer data(64);
+    encode(lease, data);
+    std::vector<uint8_t> record;
+    frame(data, record);
+    commit(record);
+}
+
+void
+LeaseLog::append(const Lease6& lease) {
+    OutputBuffer data(96);
+    encode(lease, data);
+    std::vector<uint8_t> record;
+    frame(data, record);
+    commit(record);
+}
+
+void
+LeaseLog::encode(const Lease4& lease, OutputBuffer& buf) {
+    buf.writeUint8(RECORD_LEASE4);
+    const std::vector<uint8_t> addr = lease.addr_.toBytes();
+    buf.writeData(&addr[0], addr.size());
+    writeField(lease.hwaddr_.empty() ? NULL : &lease.hwaddr_[0],
+               lease.hwaddr_.size(), buf);
+    const std::vector<uint8_t>& client_id = lease.getClientIdVector();
+    writeField(client_id.empty() ? NULL : &client_id[0], client_id.size(),
+               buf);
+    buf.writeUint32(lease.valid_lft_);
+    writeCltt(lease.cltt_, buf);
+    buf.writeUint32(lease.subnet_id_);
+    buf.writeUint8(lease.fqdn_fwd_ ? 1 : 0);
+    buf.writeUint8(lease.fqdn_rev_ ? 1 : 0);
+    writeField(reinterpret_cast<const uint8_t*>(lease.hostname_.c_str()),
+               lease.hostname_.size(), buf);
+}
+
+void
+LeaseLog::encode(const Lease6& lease, OutputBuffer& buf) {
+    buf.writeUint8(RECORD_LEASE6);
+    buf.writeUint8(static_cast<uint8_t>(lease.type_));
+    const std::vector<uint8_t> addr = lease.addr_.toBytes();
+    buf.writeData(&addr[0], addr.size());
+    buf.writeUint8(lease.prefixlen_);
+    buf.writeUint32(lease.iaid_);
+    const std::vector<uint8_t>& duid = lease.getDuidVector();
+    writeField(duid.empty() ? NULL : &duid[0], duid.size(), buf);
+    buf.writeUint32(lease.preferred_lft_);
+    buf.writeUint32(lease.valid_lft_);
+    writeCltt(lease.cltt_, buf);
+    buf.writeUint32(lease.subnet_id_);
+    buf.writeUint8(lease.fqdn_fwd_ ? 1 : 0);
+    buf.writeUint8(lease.fqdn_rev_ ? 1 : 0);
+    writeField(reinterpret_cast<const uint8_t*>(lease.hostname_.c_str()),
+               lease.hostname_.size(), buf);
+}
+
+void
+LeaseLog::frame(const OutputBuffer& data, std::vector<uint8_t>& out) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data.getData());
+    OutputBuffer record(data.getLength() + FRAME_OVERHEAD);
+    record.writeUint32(data.getLength());
+    record.writeData(bytes, data.getLength());
+    record.writeUint32(checksum(bytes, data.getLength()));
+    const uint8_t* record_bytes =
+        static_cast<const uint8_t*>(record.getData());
+    out.insert(out.end(), record_bytes, record_bytes + record.getLength());
+}
+
+void
+LeaseLog::nextRecord(std::vector<uint8_t>& data) {
+    data.clear();
+    if (fd_ < 0) {
+        bundy_throw(LeaseLogError, "lease file '" << filename_
+                    << "' is not open");
+    }
+
+    const size_t file_len = read_buf_.size();
+    if (read_pos_ >= file_len) {
+        // We're done reading, release the contents of the file.
+        std::vector<uint8_t>().swap(read_buf_);
+        read_pos_ = 0;
+        return;
+    }
+
+    const size_t remaining = file_len - read_pos_;
+    bool torn = (remaining < FRAME_OVERHEAD);
+    size_t len = 0;
+    if (!torn) {
+        len = readUint32At(&read_buf_[read_pos_]);
+        torn = (len > remaining - FRAME_OVERHEAD);
+    }
+    if (!torn) {
+        const uint8_t* record = &read_buf_[read_pos_ + sizeof(uint32_t)];
+        if (checksum(record, len) != readUint32At(record + len)) {
+            // The corrupted record at the end of file is the result of an
+            // interrupted write. Anywhere else, the file is damaged.
+            if (len + FRAME_OVERHEAD < remaining) {
+                bundy_throw(LeaseLogError, "invalid checksum of the record"
+                            " at offset " << read_pos_);
+            }
+            torn = true;
+
+        } else {
+            data.assign(record, record + len);
+            read_pos_ += len + FRAME_OVERHEAD;
+            return;
+        }
+    }
+
+    // Discard the incomplete record, so as the subsequent records are
+    // appended right after the last valid one.
+    LOG_WARN(dhcpsrv_logger, DHCPSRV_LEASE_LOG_TRUNCATED)
+        .arg(filename_).arg(read_pos_);
+    if (ftruncate(fd_, read_pos_) != 0) {
+        bundy_throw(LeaseLogError, "unable to truncate '" << filename_
+                    << "': " << std::strerror(errno));
+    }
+    std::vector<uint8_t>().swap(read_buf_);
+    read_pos_ = 0;
+}
+
+bool
+LeaseLog::next(Lease4Ptr& lease) {
+    // Parsing the record may result in exception. We don't want this
+    // function to throw exceptions, so we catch them all and rather
+    // return the false value.
+    try {
+        std::vector<uint8_t> data;
+        nextRecord(data);
+        // The empty record signals EOF.
+        if (data.empty()) {
+            lease.reset();
+            return (true);
+        }
+
+        InputBuffer buf(&data[0], data.size());
+        if (buf.readUint8() != RECORD_LEASE4) {
+            bundy_throw(LeaseLogError, "the record is not a DHCPv4 lease");
+        }
+        uint8_t addr[4];
+        buf.readData(addr, sizeof(addr));
+        std::vector<uint8_t> hwaddr;
+        readField(buf, hwaddr);
+        std::vector<uint8_t> client_id;
+        readField(buf, client_id);
+        const uint32_t valid_lft = buf.readUint32();
+        const time_t cltt = readCltt(buf);
+        const uint32_t subnet_id = buf.readUint32();
+        const bool fqdn_fwd = (buf.readUint8() != 0);
+        const bool fqdn_rev = (buf.readUint8() != 0);
+        std::vector<uint8_t> hostname;
+        readField(buf, hostname);
+        if (buf.getPosition() != buf.getLength()) {
+            bundy_throw(LeaseLogError, "trailing data in the DHCPv4 lease"
+                        " record");
+        }
+
+        lease.reset(new Lease4(IOAddress::fromBytes(AF_INET, addr),
+                               hwaddr.empty() ? NULL : &hwaddr[0],
+                               hwaddr.size(),
+                               client_id.empty() ? NULL : &client_id[0],
+                               client_id.size(), valid_lft,
+                               0, 0, // t1, t2 = 0
+                               cltt, subnet_id, fqdn_fwd, fqdn_rev,
+                               std::string(hostname.begin(),
+                                           hostname.end())));
+
+    } catch (const std::exception& ex) {
+        lease.reset();
+        read_msg_ = ex.what();
+        return (false);
+    }
+    return (true);
+}
+
+bool
+LeaseLog::next(Lease6Ptr& lease) {
+    try {
+        std::vector<uint8_t> data;
+        nextRecord(data);
+        // The empty record signals EOF.
+        if (data.empty()) {
+            lease.reset();
+            return (true);
+        }
+
+        InputBuffer buf(&data[0], data.size());
+        if (buf.readUint8() != RECORD_LEASE6) {
+            bundy_throw(LeaseLogError, "the record is not a DHCPv6 lease");
+        }
+        const uint8_t type = buf.readUint8();
+        if (type > Lease::TYPE_PD) {
+            bundy_throw(LeaseLogError, "invalid lease type "
+                        << static_cast<int>(type));
+        }
+        uint8_t addr[16];
+        buf.readData(addr, sizeof(addr));
+        const uint8_t prefixlen = buf.readUint8();
+        const uint32_t iaid = buf.readUint32();
+        std::vector<uint8_t> duid;
+        readField(buf, duid);
+        const uint32_t preferred_lft = buf.readUint32();
+        const uint32_t valid_lft = buf.readUint32();
+        const time_t cltt = readCltt(buf);
+        const uint32_t subnet_id = buf.readUint32();
+        const bool fqdn_fwd = (buf.readUint8() != 0);
+        const bool fqdn_rev = (buf.readUint8() != 0);
+        std::vector<uint8_t> hostname;
+        readField(buf, hostname);
+        if (buf.getPosition() != buf.getLength()) {
+            bundy_throw(LeaseLogError, "trailing data in the DHCPv6 lease"
+                        " record");
+        }
+
+        lease.reset(new Lease6(static_cast<Lease::Type>(type),
+                               IOAddress::fromBytes(AF_INET6, addr),
+                               DuidPtr(new DUID(duid)), iaid,
+                               preferred_lft, valid_lft,
+                               0, 0, // t1, t2 = 0
+                               subnet_id, prefixlen));
+        lease->cltt_ = cltt;
+        lease->fqdn_fwd_ = fqdn_fwd;
+        lease->fqdn_rev_ = fqdn_rev;
+        lease->hostname_.assign(hostname.begin(), hostname.end());
+
+    } catch (const std::exception& ex) {
+        lease.reset();
+        read_msg_ = ex.what();
+        return (false);
+    }
+    return (true);
+}
+
+void
+LeaseLog::commit(const std::vector<uint8_t>& record) {
+    uint64_t seq = 0;
+    {
+        Mutex::Locker lock(mutex_);
+        if (fd_ < 0) {
+            bundy_throw(LeaseLogError, "lease file '" << filename_
+                        << "' is not open");
+        }
+        if (!write_error_.empty()) {
+            bundy_throw(LeaseLogError, "unable to write to '" << filename_
+                        << "': " << write_error_);
+        }
+        pending_.insert(pending_.end(), record.begin(), record.end());
+        seq = ++queued_seq_;
+        ++append_count_;
+
+        // Wait until some other thread commits our record, or become the
+        // thread which commits the pending records.
+        while (durable_seq_ < seq) {
+            if (!write_error_.empty()) {
+                bundy_throw(LeaseLogError, "unable to write to '"
+                            << filename_ << "': " << write_error_);
+            }
+            if (!flushing_) {
+                flushing_ = true;
+                break;
+            }
+            cond_.wait(mutex_);
+        }
+        if (durable_seq_ >= seq) {
+            return;
+        }
+    }
+
+    // Give other threads a chance to add their records to this group.
+    if (commit_window_ > 0) {
+        usleep(commit_window_);
+    }
+
+    std::vector<uint8_t> batch;
+    uint64_t last_seq = 0;
+    int fd = -1;
+    {
+        Mutex::Locker lock(mutex_);
+        batch.swap(pending_);
+        last_seq = queued_seq_;
+        // The descriptor can't be replaced by the compaction nor closed
+        // while we're flushing.
+        fd = fd_;
+    }
+
+    // Write the group without holding the lock, so as other threads can
+    // queue their records for the next group in the meantime.
+    const std::string error = writeAndSync(fd, batch);
+
+    Mutex::Locker lock(mutex_);
+    if (error.empty()) {
+        durable_seq_ = last_seq;
+        ++sync_count_;
+        if (compacting_) {
+            compaction_tail_.insert(compaction_tail_.end(), batch.begin(),
+                                    batch.end());
+        }
+    } else {
+        write_error_ = error;
+    }
+    flushing_ = false;
+    cond_.broadcast();
+
+    if (!error.empty()) {
+        bundy_throw(LeaseLogError, "unable to write to '" << filename_
+                    << "': " << error);
+    }
+}
+
+void
+LeaseLog::compact(const Lease4Collection& leases) {
+    std::vector<uint8_t> records;
+    for (Lease4Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        OutputBuffer data(64);
+        encode(**lease, data);
+        frame(data, records);
+    }
+    startCompaction(records);
+}
+
+void
+LeaseLog::compact(const Lease6Collection& leases) {
+    std::vector<uint8_t> records;
+    for (Lease6Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        OutputBuffer data(96);
+        encode(**lease, data);
+        frame(data, records);
+    }
+    startCompaction(records);
+}
+
+void
+LeaseLog::startCompaction(const std::vector<uint8_t>& records) {
+    if (isCompacting()) {
+        bundy_throw(LeaseLogError, "compaction of the lease file '"
+                    << filename_ << "' is already in progress");
+    }
+    // Collect the thread which performed the previous compaction.
+    waitForCompaction();
+
+    {
+        Mutex::Locker lock(mutex_);
+        if (fd_ < 0) {
+            bundy_throw(LeaseLogError, "lease file '" << filename_
+                        << "' is not open");
+        }
+        compacting_ = true;
+        compaction_tail_.clear();
+        compact_msg_.clear();
+        append_count_ = 0;
+    }
+
+    try {
+        compaction_thread_.reset(new Thread(boost::bind(
+            &LeaseLog::compactInternal, this, records)));
+    } catch (...) {
+        Mutex::Locker lock(mutex_);
+        compacting_ = false;
+        throw;
+    }
+}
+
+void
+LeaseLog::compactInternal(const std::vector<uint8_t>& records) {
+    const std::string tmp_filename = filename_ + ".compact";
+    int fd = -1;
+    try {
+        fd = ::open(tmp_filename.c_str(),
+                    O_WRONLY | O_CREAT | O_TRUNC | O_APPEND,
+                    S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+        if (fd < 0) {
+            bundy_throw(LeaseLogError, "unable to create '" << tmp_filename
+                        << "': " << std::strerror(errno));
+        }
+
+        OutputBuffer header(HEADER_LEN);
+        header.writeData(MAGIC, MAGIC_LEN);
+        header.writeUint32(VERSION);
+        const uint8_t* header_data =
+            static_cast<const uint8_t*>(header.getData());
+        std::vector<uint8_t> contents(header_data, header_data + HEADER_LEN);
+        contents.insert(contents.end(), records.begin(), records.end());
+
+        // Write the live leases without holding the lock: this is the
+        // expensive part of the compaction.
+        std::string error = writeAndSync(fd, contents);
+        if (!error.empty()) {
+            bundy_throw(LeaseLogError, "unable to write to '" << tmp_filename
+                        << "': " << error);
+        }
+
+        Mutex::Locker lock(mutex_);
+        while (flushing_) {
+            cond_.wait(mutex_);
+        }
+        // Copy the records committed in the meantime. The appends are
+        // blocked until the new file replaces the old one.
+        error = writeAndSync(fd, compaction_tail_);
+        if (!error.empty()) {
+            bundy_throw(LeaseLogError, "unable to write to '" << tmp_filename
+                        << "': " << error);
+        }
+        if (rename(tmp_filename.c_str(), filename_.c_str()) != 0) {
+            bundy_throw(LeaseLogError, "unable to rename '" << tmp_filename
+                        << "' to '" << filename_ << "': "
+                        << std::strerror(errno));
+        }
+        // Make the rename durable.
+        const int dir_fd = ::open(getDirectory(filename_).c_str(), O_RDONLY);
+        if (dir_fd >= 0) {
+            fsync(dir_fd);
+            ::close(dir_fd);
+        }
+
+        ::close(fd_);
+        fd_ = fd;
+        compaction_tail_.clear();
+        compacting_ = false;
+        cond_.broadcast();
+
+    } catch (const std::exception& ex) {
+        if (fd >= 0) {
+            ::close(fd);
+            unlink(tmp_filename.c_str());
+        }
+        Mutex::Locker lock(mutex_);
+        compact_msg_ = ex.what();
+        compaction_tail_.clear();
+        compacting_ = false;
+        cond_.broadcast();
+        LOG_ERROR(dhcpsrv_logger, DHCPSRV_LEASE_LOG_COMPACT_FAILED)
+            .arg(filename_).arg(compact_msg_);
+        return;
+    }
+
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_LEASE_LOG_COMPACT_COMPLETE)
+        .arg(filename_);
+}
+
+bool
+LeaseLog::waitForCompaction() {
+    if (compaction_thread_) {
+        compaction_thread_->wait();
+        compaction_thread_.reset();
+    }
+    Mutex::Locker lock(mutex_);
+    return (compact_msg_.empty());
+}
+
+bool
+LeaseLog::isCompacting() const {
+    Mutex::Locker lock(mutex_);
+    return (compacting_);
+}
+
+std::string
+LeaseLog::getCompactMsg() const {
+    Mutex::Locker lock(mutex_);
+    return (compact_msg_);
+}
+
+uint64_t
+LeaseLog::getAppendCount() const {
+    Mutex::Locker lock(mutex_);
+    return (append_count_);
+}
+
+uint64_t
+LeaseLog::getSyncCount() const {
+    Mutex::Locker lock(mutex_);
+    return (sync_count_);
+}
+
+} // namespace bundy::dhcp
+} // namespace bundy
@@ -0,0 +1,319 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef LEASE_LOG_H
+#define LEASE_LOG_H
+
+#include <dhcpsrv/lease.h>
+#include <exceptions/exceptions.h>
+#include <util/buffer.h>
+#include <util/threads/sync.h>
+#include <util/threads/thread.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace bundy {
+namespace dhcp {
+
+/// @brief Exception thrown when an operation on the lease log fails.
+class LeaseLogError : public Exception {
+public:
+    LeaseLogError(const char* file, size_t line, const char* what) :
+        bundy::Exception(file, line, what) { };
+};
+
+/// @brief Binary append-only lease file with group commit.
+///
+/// This class is an alternative to the @c CSVLeaseFile4 and
+/// @c CSVLeaseFile6 used by the @c Memfile_LeaseMgr. The lease file is an
+/// append-only log of lease records, which is replayed when the server
+/// starts, exactly like the CSV lease file. The records are stored in a
+/// compact binary form, each one protected by a checksum, so as they are
+/// cheap to produce and to parse.
+///
+/// The @c append functions return when the record is on the stable storage,
+/// i.e. after it has been written and the file has been synced with
+/// @c fdatasync. The records appended concurrently by several threads are
+/// committed as a group: the first thread which finds that no write is in
+/// progress becomes the leader, optionally waits for the commit window to
+/// collect more records, and then writes all pending records with a single
+/// @c write followed by a single @c fdatasync. The other threads wait until
+/// the leader reports that their records are durable.
+///
+/// The grouping only happens when the records are appended by several
+/// threads. A single threaded caller (such as the DHCP servers, which
+/// process one packet at a time) gets one @c fdatasync per record, and the
+/// commit window only delays each of its appends, so it should be left at 0.
+///
+/// Over time the log accumulates records of leases which have been updated
+/// or deleted later. The @c compact function rewrites the live leases to a
+/// new file in a background thread and atomically replaces the log with it.
+/// The records appended while the compaction is in progress are copied to
+/// the new file before it replaces the old one.
+///
+/// The file starts with a header holding the @c MAGIC string and the format
+/// version. Each record has the following layout (integers are in network
+/// byte order):
+/// - length of the record data (4 bytes),
+/// - record data: the record type (4 for DHCPv4 lease, 6 for DHCPv6 lease)
+///   followed by the lease fields,
+/// - checksum of the record data (4 bytes).
+///
+/// The record which is truncated or has an invalid checksum at the end of
+/// the file is the result of an interrupted write, e.g. a crash of the
+/// server. Such a record is discarded and the file is truncated to the
+/// last valid record when the file is read. A corrupted record followed
+/// by valid records is reported as an error.
+///
+/// Only the lease fields which are stored in the CSV lease files are
+/// stored in the log. In particular, T1 and T2 are not stored.
+class LeaseLog : public boost::noncopyable {
+public:
+
+    /// @brief String at the beginning of each lease log file.
+    static const char* MAGIC;
+
+    /// @brief Version of the lease log format.
+    static const uint32_t VERSION = 1;
+
+    /// @brief Constructor.
+    ///
+    /// The constructor doesn't open the file.
+    ///
+    /// @param filename Name of the lease file.
+    /// @param commit_window Time in microseconds that the thread committing
+    /// a group of records waits for other records before writing them. The
+    /// value of 0 means that the pending records are written immediately.
+    /// A non-zero value is only useful when several threads append records.
+    LeaseLog(const std::string& filename, const uint32_t commit_window = 0);
+
+    /// @brief Destructor.
+    ///
+    /// Waits for the compaction (if any) to complete and closes the file.
+    ~LeaseLog();
+
+    /// @brief Opens an existing lease file or creates a new one.
+    ///
+    /// If the file exists, its header is checked and the read position is
+    /// set to the first record. The records are read with @c next.
+    ///
+    /// @throw LeaseLogError if the file can't be opened or it is not a
+    /// lease log file.
+    void open();
+
+    /// @brief Closes the lease file.
+    ///
+    /// Waits for the compaction (if any) to complete.
+    void close();
+
+    /// @brief Appends the DHCPv4 lease record to the file.
+    ///
+    /// @param lease DHCPv4 lease to be stored.
+    ///
+    /// @throw LeaseLogError if the record can't be written.
+    void append(const Lease4& lease);
+
+    /// @brief Appends the DHCPv6 lease record to the file.
+    ///
+    /// @param lease DHCPv6 lease to be stored.
+    ///
+    /// @throw LeaseLogError if the record can't be written.
+    void append(const Lease6& lease);
+
+    /// @brief Reads the next DHCPv4 lease from the file.
+    ///
+    /// If this function hits an error during the read, it sets the error
+    /// message which can be retrieved with @c getReadMsg and returns false.
+    ///
+    /// @param [out] lease Pointer to the lease read from the file or NULL
+    /// pointer if the end of file has been reached.
+    ///
+    /// @return true if the lease has been read or the end of file has been
+    /// reached, false if an error occurred.
+    bool next(Lease4Ptr& lease);
+
+    /// @brief Reads the next DHCPv6 lease from the file.
+    ///
+    /// @param [out] lease Pointer to the lease read from the file or NULL
+    /// pointer if the end of file has been reached.
+    ///
+    /// @return true if the lease has been read or the end of file has been
+    /// reached, false if an error occurred.
+    bool next(Lease6Ptr& lease);
+
+    /// @brief Starts compaction of the DHCPv4 lease file.
+    ///
+    /// @param leases Live leases to be written to the new file.
+    ///
+    /// @throw LeaseLogError if the file is not open or the compaction is
+    /// already in progress.
+    void compact(const Lease4Collection& leases);
+
+    /// @brief Starts compaction of the DHCPv6 lease file.
+    ///
+    /// @param leases Live leases to be written to the new file.
+    ///
+    /// @throw LeaseLogError if the file is not open or the compaction is
+    /// already in progress.
+    void compact(const Lease6Collection& leases);
+
+    /// @brief Waits for the compaction to complete.
+    ///
+    /// @return true if the compaction has been completed successfully or
+    /// no compaction has been started, false if it has failed. In the
+    /// latter case, the reason is returned by @c getCompactMsg and the
+    /// original lease file is left in place.
+    bool waitForCompaction();
+
+    /// @brief Checks if the compaction is in progress.
+    bool isCompacting() const;
+
+    /// @brief Returns the path to the lease file.
+    std::string getFilename() const {
+        return (filename_);
+    }
+
+    /// @brief Returns the description of the last error returned by
+    /// @c next.
+    std::string getReadMsg() const {
+        return (read_msg_);
+    }
+
+    /// @brief Returns the description of the last compaction failure.
+    std::string getCompactMsg() const;
+
+    /// @brief Returns the number of records appended since the file was
+    /// opened or last compacted.
+    uint64_t getAppendCount() const;
+
+    /// @brief Returns the number of writes (each followed by @c fdatasync)
+    /// performed to commit the appended records.
+    uint64_t getSyncCount() const;
+
+private:
+
+    /// @brief Encodes the DHCPv4 lease as record data.
+    static void encode(const Lease4& lease, util::OutputBuffer& buf);
+
+    /// @brief Encodes the DHCPv6 lease as record data.
+    static void encode(const Lease6& lease, util::OutputBuffer& buf);
+
+    /// @brief Appends a complete record to the buffer.
+    ///
+    /// @param data Record data (record type and lease fields).
+    /// @param [out] out Buffer to which the record is appended.
+    static void frame(const util::OutputBuffer& data,
+                      std::vector<uint8_t>& out);
+
+    /// @brief Returns the data of the next record in the file.
+    ///
+    /// @param [out] data Record data or empty vector at the end of file.
+    ///
+    /// @throw LeaseLogError if the record is corrupted.
+    void nextRecord(std::vector<uint8_t>& data);
+
+    /// @brief Commits a record to the file.
+    ///
+    /// Queues the record and waits until it is durable, committing the
+    /// pending records if no other thread is doing it.
+    ///
+    /// @param record Complete record, as produced by @c frame.
+    void commit(const std::vector<uint8_t>& record);
+
+    /// @brief Starts the compaction thread.
+    ///
+    /// @param records Records of the live leases.
+    void startCompaction(const std::vector<uint8_t>& records);
+
+    /// @brief Body of the compaction thread.
+    ///
+    /// @param records Records of the live leases.
+    void compactInternal(const std::vector<uint8_t>& records);
+
+    /// @brief Name of the lease file.
+    std::string filename_;
+
+    /// @brief Commit window in microseconds.
+    uint32_t commit_window_;
+
+    /// @brief File descriptor of the lease file.
+    int fd_;
+
+    /// @brief Contents of the file read by @c open.
+    ///
+    /// The contents are released when the end of file is reached.
+    std::vector<uint8_t> read_buf_;
+
+    /// @brief Position of the next record in @c read_buf_.
+    size_t read_pos_;
+
+    /// @brief Description of the last read error.
+    std::string read_msg_;
+
+    /// @brief Mutex protecting the members below.
+    mutable util::thread::Mutex mutex_;
+
+    /// @brief Condition signaled when a group commit or compaction ends.
+    util::thread::CondVar cond_;
+
+    /// @brief Records waiting to be written.
+    std::vector<uint8_t> pending_;
+
+    /// @brief Sequence number of the last queued record.
+    uint64_t queued_seq_;
+
+    /// @brief Sequence number of the last durable record.
+    uint64_t durable_seq_;
+
+    /// @brief Indicates that a thread is committing pending records.
+    bool flushing_;
+
+    /// @brief Description of the write error, empty if none occurred.
+    ///
+    /// Once a write fails, the state of the end of the file is unknown,
+    /// so all subsequent appends fail too.
+    std::string write_error_;
+
+    /// @brief Number of records appended since open or last compaction.
+    uint64_t append_count_;
+
+    /// @brief Number of group commits performed.
+    uint64_t sync_count_;
+
+    /// @brief Indicates that the compaction is in progress.
+    bool compacting_;
+
+    /// @brief Records committed while the compaction is in progress.
+    std::vector<uint8_t> compaction_tail_;
+
+    /// @brief Description of the last compaction failure.
+    std::string compact_msg_;
+
+    /// @brief Thread performing the compaction.
+    boost::scoped_ptr<util::thread::Thread> compaction_thread_;
+};
+
+/// @brief Pointer to the @c LeaseLog.
+typedef boost::shared_ptr<LeaseLog> LeaseLogPtr;
+
+} // namespace bundy::dhcp
+} // namespace bundy
+
+#endif // LEASE_LOG_H
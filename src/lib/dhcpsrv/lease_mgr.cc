@@ -17,6 +17,7 @@
 
 #include <boost/foreach.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include <algorithm>
 #include <iostream>
@@ -40,6 +41,112 @@ std::string LeaseMgr::getParameter(const std::string& name) const {
     return (param->second);
 }
 
+uint32_t
+LeaseMgr::getUnsignedParameter(const std::string& name,
+                               const uint32_t default_value) const {
+    std::string value;
+    try {
+        value = getParameter(name);
+    } catch (const Exception& ex) {
+        return (default_value);
+    }
+    // The lexical_cast accepts negative values for unsigned types, so
+    // they have to be rejected explicitly.
+    if (value.empty() || (value[0] == '-')) {
+        bundy_throw(bundy::BadValue, "invalid value '" << name << "="
+                  << value << "'");
+    }
+    try {
+        return (boost::lexical_cast<uint32_t>(value));
+    } catch (const boost::bad_lexical_cast&) {
+        bundy_throw(bundy::BadValue, "invalid value '" << name << "="
+                  << value << "'");
+    }
+}
+
+Lease4Collection
+LeaseMgr::getLeases4(const AddressCollection& addrs) const {
+    Lease4Collection leases;
+    for (AddressCollection::const_iterator addr = addrs.begin();
+         addr != addrs.end(); ++addr) {
+        Lease4Ptr lease = getLease4(*addr);
+        if (lease) {
+            leases.push_back(lease);
+        }
+    }
+    return (leases);
+}
+
+Lease6Collection
+LeaseMgr::getLeases6(Lease::Type type, const AddressCollection& addrs) const {
+    Lease6Collection leases;
+    for (AddressCollection::const_iterator addr = addrs.begin();
+         addr != addrs.end(); ++addr) {
+        Lease6Ptr lease = getLease6(type, *addr);
+        if (lease) {
+            leases.push_back(lease);
+        }
+    }
+    return (leases);
+}
+
+namespace {
+
+/// @brief Adds leases one by one, removing them if any addition fails.
+///
+/// @param lease_mgr Lease manager to which the leases are added.
+/// @param leases Leases to be added.
+///
+/// @tparam LeaseCollection Type of the collection: @c Lease4Collection or
+/// @c Lease6Collection.
+///
+/// @return true if all leases were added, false otherwise.
+template<typename LeaseCollection>
+bool
+addLeasesOneByOne(LeaseMgr& lease_mgr, const LeaseCollection& leases) {
+    for (typename LeaseCollection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        if (!lease_mgr.addLease(*lease)) {
+            // Undo the additions so as the group is added as a whole
+            // or not at all.
+            for (typename LeaseCollection::const_iterator added =
+                     leases.begin(); added != lease; ++added) {
+                lease_mgr.deleteLease((*added)->addr_);
+            }
+            return (false);
+        }
+    }
+    return (true);
+}
+
+} // end of anonymous namespace
+
+bool
+LeaseMgr::addLeases(const Lease4Collection& leases) {
+    return (addLeasesOneByOne(*this, leases));
+}
+
+bool
+LeaseMgr::addLeases(const Lease6Collection& leases) {
+    return (addLeasesOneByOne(*this, leases));
+}
+
+void
+LeaseMgr::updateLeases4(const Lease4Collection& leases) {
+    for (Lease4Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        updateLease4(*lease);
+    }
+}
+
+void
+LeaseMgr::updateLeases6(const Lease6Collection& leases) {
+    for (Lease6Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        updateLease6(*lease);
+    }
+}
+
 Lease6Ptr
 LeaseMgr::getLease6(Lease::Type type, const DUID& duid,
                     uint32_t iaid, SubnetID subnet_id) const {
@@ -125,6 +125,9 @@ public:
     /// Database configuration parameter map
     typedef std::map<std::string, std::string> ParameterMap;
 
+    /// Collection of addresses used by the batched lease queries
+    typedef std::vector<bundy::asiolink::IOAddress> AddressCollection;
+
     /// @brief Constructor
     ///
     /// @param parameters A data structure relating keywords and values
@@ -152,6 +155,32 @@ public:
     ///         with the same address was already there).
     virtual bool addLease(const Lease6Ptr& lease) = 0;
 
+    /// @brief Adds a group of IPv4 leases.
+    ///
+    /// The leases are added as a whole: if any of them can't be added
+    /// (because a lease with the same address is already there), none of
+    /// them is added. Backends supporting transactions add all leases
+    /// within a single transaction, so the cost of committing it is paid
+    /// once for the whole group.
+    ///
+    /// The default implementation adds the leases one by one using
+    /// @c addLease and deletes the already added ones when an addition
+    /// fails.
+    ///
+    /// @param leases leases to be added
+    ///
+    /// @result true if all leases were added, false if none was added.
+    virtual bool addLeases(const Lease4Collection& leases);
+
+    /// @brief Adds a group of IPv6 leases.
+    ///
+    /// See the IPv4 variant for details.
+    ///
+    /// @param leases leases to be added
+    ///
+    /// @result true if all leases were added, false if none was added.
+    virtual bool addLeases(const Lease6Collection& leases);
+
     /// @brief Returns an IPv4 lease for specified IPv4 address
     ///
     /// This method return a lease that is associated with a given address.
@@ -166,6 +195,21 @@ public:
     /// @return smart pointer to the lease (or NULL if a lease is not found)
     virtual Lease4Ptr getLease4(const bundy::asiolink::IOAddress& addr) const = 0;
 
+    /// @brief Returns IPv4 leases for a group of addresses.
+    ///
+    /// This is the batched variant of the @c getLease4(addr). It allows
+    /// the caller (typically the allocation engine probing candidate
+    /// addresses) to check many addresses at the cost of a single query
+    /// to the database.
+    ///
+    /// The default implementation calls @c getLease4(addr) for each address.
+    ///
+    /// @param addrs addresses of the searched leases
+    ///
+    /// @return collection of the leases found, in no particular order.
+    /// Addresses for which there is no lease have no corresponding entry.
+    virtual Lease4Collection getLeases4(const AddressCollection& addrs) const;
+
     /// @brief Returns existing IPv4 leases for specified hardware address.
     ///
     /// Although in the usual case there will be only one lease, for mobile
@@ -242,6 +286,20 @@ public:
     virtual Lease6Ptr getLease6(Lease::Type type,
                                 const bundy::asiolink::IOAddress& addr) const = 0;
 
+    /// @brief Returns IPv6 leases of a given type for a group of addresses.
+    ///
+    /// This is the batched variant of the @c getLease6(type, addr). The
+    /// default implementation calls @c getLease6(type, addr) for each
+    /// address.
+    ///
+    /// @param type specifies lease type: (NA, TA or PD)
+    /// @param addrs addresses of the searched leases
+    ///
+    /// @return collection of the leases found, in no particular order.
+    /// Addresses for which there is no lease have no corresponding entry.
+    virtual Lease6Collection getLeases6(Lease::Type type,
+                                        const AddressCollection& addrs) const;
+
     /// @brief Returns existing IPv6 leases for a given DUID+IA combination
     ///
     /// Although in the usual case there will be only one lease, for mobile
@@ -310,6 +368,27 @@ public:
     /// @param lease6 The lease to be updated.
     virtual void updateLease6(const Lease6Ptr& lease6) = 0;
 
+    /// @brief Updates a group of IPv4 leases.
+    ///
+    /// Backends supporting transactions update all leases within a single
+    /// transaction, which is rolled back if any of the leases doesn't
+    /// exist. The default implementation calls @c updateLease4 for each
+    /// lease, so the leases preceding the missing one remain updated.
+    ///
+    /// @param leases The leases to be updated.
+    ///
+    /// @throw NoSuchLease if any of the leases is not present.
+    virtual void updateLeases4(const Lease4Collection& leases);
+
+    /// @brief Updates a group of IPv6 leases.
+    ///
+    /// See the IPv4 variant for details.
+    ///
+    /// @param leases The leases to be updated.
+    ///
+    /// @throw NoSuchLease if any of the leases is not present.
+    virtual void updateLeases6(const Lease6Collection& leases);
+
     /// @brief Deletes a lease.
     ///
     /// @param addr Address of the lease to be deleted. (This can be IPv4 or
@@ -375,6 +454,16 @@ public:
     /// @brief returns value of the parameter
     virtual std::string getParameter(const std::string& name) const;
 
+    /// @brief Returns the value of the unsigned integer parameter.
+    ///
+    /// @param name Name of the parameter.
+    /// @param default_value Value returned if the parameter is not
+    /// specified.
+    ///
+    /// @throw bundy::BadValue if the value is not an unsigned integer.
+    uint32_t getUnsignedParameter(const std::string& name,
+                                  const uint32_t default_value) const;
+
 private:
     /// @brief list of parameters passed in dbconfig
     ///
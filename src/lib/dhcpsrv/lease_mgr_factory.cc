@@ -14,6 +14,7 @@
 
 #include "config.h"
 
+#include <dhcpsrv/caching_lease_mgr.h>
 #include <dhcpsrv/dhcpsrv_log.h>
 #include <dhcpsrv/lease_mgr_factory.h>
 #include <dhcpsrv/memfile_lease_mgr.h>
@@ -37,6 +38,31 @@
 
 using namespace std;
 
+namespace {
+
+using namespace bundy::dhcp;
+
+/// @brief Puts the lease cache in front of the lease manager if the
+/// "cache" parameter is set to "true".
+///
+/// @param parameters Database access parameters.
+/// @param lease_mgr Lease manager created for these parameters.
+///
+/// @return The lease cache owning the lease manager or the lease manager
+/// itself if the cache is disabled.
+LeaseMgr*
+addLeaseCache(const LeaseMgr::ParameterMap& parameters, LeaseMgr* lease_mgr) {
+    LeaseMgr::ParameterMap::const_iterator cache = parameters.find("cache");
+    if ((cache == parameters.end()) || (cache->second != "true")) {
+        return (lease_mgr);
+    }
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_LEASE_CACHE_ENABLED)
+        .arg(lease_mgr->getType());
+    return (new CachingLeaseMgr(parameters, lease_mgr));
+}
+
+} // end of anonymous namespace
+
 namespace bundy {
 namespace dhcp {
 
@@ -124,20 +150,23 @@ LeaseMgrFactory::create(const std::string& dbaccess) {
 #ifdef HAVE_MYSQL
     if (parameters[type] == string("mysql")) {
         LOG_INFO(dhcpsrv_logger, DHCPSRV_MYSQL_DB).arg(redacted);
-        getLeaseMgrPtr().reset(new MySqlLeaseMgr(parameters));
+        getLeaseMgrPtr().reset(
+            addLeaseCache(parameters, new MySqlLeaseMgr(parameters)));
         return;
     }
 #endif
 #ifdef HAVE_PGSQL
     if (parameters[type] == string("postgresql")) {
         LOG_INFO(dhcpsrv_logger, DHCPSRV_PGSQL_DB).arg(redacted);
-        getLeaseMgrPtr().reset(new PgSqlLeaseMgr(parameters));
+        getLeaseMgrPtr().reset(
+            addLeaseCache(parameters, new PgSqlLeaseMgr(parameters)));
         return;
     }
 #endif
     if (parameters[type] == string("memfile")) {
         LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_DB).arg(redacted);
-        getLeaseMgrPtr().reset(new Memfile_LeaseMgr(parameters));
+        getLeaseMgrPtr().reset(
+            addLeaseCache(parameters, new Memfile_LeaseMgr(parameters)));
         return;
     }
 
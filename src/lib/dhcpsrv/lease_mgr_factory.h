@@ -71,6 +71,9 @@ public:
     /// a keyword/value pair of the form "type=dbtype" giving the database
     /// type, e.q. "mysql" or "sqlite3".
     ///
+    /// If the data includes the "cache=true" keyword/value pair, the
+    /// lease manager is wrapped in the @c CachingLeaseMgr.
+    ///
     /// @param dbaccess Database access parameters.  These are in the form of
     ///        "keyword=value" pairs, separated by spaces. They are backend-
     ///        -end specific, although must include the "type" keyword which
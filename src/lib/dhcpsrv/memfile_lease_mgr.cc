@@ -17,26 +17,53 @@
 #include <dhcpsrv/memfile_lease_mgr.h>
 #include <exceptions/exceptions.h>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace bundy::dhcp;
 
 Memfile_LeaseMgr::Memfile_LeaseMgr(const ParameterMap& parameters)
-    : LeaseMgr(parameters) {
+    : LeaseMgr(parameters), binary_format_(false), compact_threshold_(0) {
+    std::string format;
+    try {
+        format = getParameter("format");
+    } catch (const Exception& ex) {
+        // If the format hasn't been specified, use CSV files.
+        format = "csv";
+    }
+    if (format == "binary") {
+        binary_format_ = true;
+
+    } else if (format != "csv") {
+        bundy_throw(bundy::BadValue, "invalid value 'format="
+                  << format << "'");
+    }
+    compact_threshold_ = getUnsignedParameter("compact-threshold", 0);
+
     // Check the universe and use v4 file or v6 file.
     std::string universe = getParameter("universe");
     if (universe == "4") {
         std::string file4 = initLeaseFilePath(V4);
         if (!file4.empty()) {
-            lease_file4_.reset(new CSVLeaseFile4(file4));
-            lease_file4_->open();
+            if (binary_format_) {
+                lease_log4_.reset(new LeaseLog(file4));
+                lease_log4_->open();
+            } else {
+                lease_file4_.reset(new CSVLeaseFile4(file4));
+                lease_file4_->open();
+            }
             load4();
         }
     } else {
         std::string file6 = initLeaseFilePath(V6);
         if (!file6.empty()) {
-            lease_file6_.reset(new CSVLeaseFile6(file6));
-            lease_file6_->open();
+            if (binary_format_) {
+                lease_log6_.reset(new LeaseLog(file6));
+                lease_log6_->open();
+            } else {
+                lease_file6_.reset(new CSVLeaseFile6(file6));
+                lease_file6_->open();
+            }
             load6();
         }
     }
@@ -59,6 +86,15 @@ Memfile_LeaseMgr::~Memfile_LeaseMgr() {
         lease_file6_->close();
         lease_file6_.reset();
     }
+    // Closing the binary lease files waits for the compaction to complete.
+    if (lease_log4_) {
+        lease_log4_->close();
+        lease_log4_.reset();
+    }
+    if (lease_log6_) {
+        lease_log6_->close();
+        lease_log6_.reset();
+    }
 }
 
 bool
@@ -75,10 +111,11 @@ Memfile_LeaseMgr::addLease(const Lease4Ptr& lease) {
     // not be inserted to the memory and the disk and in-memory data will
     // remain consistent.
     if (persistLeases(V4)) {
-        lease_file4_->append(*lease);
+        appendLease4(*lease);
     }
 
     storage4_.insert(lease);
+    checkCompaction(V4);
     return (true);
 }
 
@@ -96,10 +133,11 @@ Memfile_LeaseMgr::addLease(const Lease6Ptr& lease) {
     // not be inserted to the memory and the disk and in-memory data will
     // remain consistent.
     if (persistLeases(V6)) {
-        lease_file6_->append(*lease);
+        appendLease6(*lease);
     }
 
     storage6_.insert(lease);
+    checkCompaction(V6);
     return (true);
 }
 
@@ -165,7 +203,7 @@ Lease4Collection
 Memfile_LeaseMgr::getLease4(const ClientId& client_id) const {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_CLIENTID).arg(client_id.toText());
-    typedef Memfile_LeaseMgr::Lease4Storage::nth_index<0>::type SearchIndex;
+    typedef Lease4Storage::nth_index<0>::type SearchIndex;
     Lease4Collection collection;
     const SearchIndex& idx = storage4_.get<0>();
     for(SearchIndex::const_iterator lease = idx.begin();
@@ -248,6 +286,20 @@ Memfile_LeaseMgr::getLease6(Lease::Type /* not used yet */,
     }
 }
 
+Lease6Collection
+Memfile_LeaseMgr::getLeases6(Lease::Type type,
+                             const AddressCollection& addrs) const {
+    Lease6Collection collection;
+    for (AddressCollection::const_iterator addr = addrs.begin();
+         addr != addrs.end(); ++addr) {
+        Lease6Ptr lease = getLease6(type, *addr);
+        if (lease) {
+            collection.push_back(lease);
+        }
+    }
+    return (collection);
+}
+
 Lease6Collection
 Memfile_LeaseMgr::getLeases6(Lease::Type /* not used yet */,
                             const DUID& duid, uint32_t iaid) const {
@@ -303,10 +355,11 @@ Memfile_LeaseMgr::updateLease4(const Lease4Ptr& lease) {
     // not be inserted to the memory and the disk and in-memory data will
     // remain consistent.
     if (persistLeases(V4)) {
-        lease_file4_->append(*lease);
+        appendLease4(*lease);
     }
 
     **lease_it = *lease;
+    checkCompaction(V4);
 }
 
 void
@@ -324,10 +377,35 @@ Memfile_LeaseMgr::updateLease6(const Lease6Ptr& lease) {
     // not be inserted to the memory and the disk and in-memory data will
     // remain consistent.
     if (persistLeases(V6)) {
-        lease_file6_->append(*lease);
+        appendLease6(*lease);
     }
 
     **lease_it = *lease;
+    checkCompaction(V6);
+}
+
+void
+Memfile_LeaseMgr::updateLeases4(const Lease4Collection& leases) {
+    for (Lease4Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        if (storage4_.find((*lease)->addr_) == storage4_.end()) {
+            bundy_throw(NoSuchLease, "failed to update the lease with address "
+                      << (*lease)->addr_ << " - no such lease");
+        }
+    }
+    LeaseMgr::updateLeases4(leases);
+}
+
+void
+Memfile_LeaseMgr::updateLeases6(const Lease6Collection& leases) {
+    for (Lease6Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        if (storage6_.find((*lease)->addr_) == storage6_.end()) {
+            bundy_throw(NoSuchLease, "failed to update the lease with address "
+                      << (*lease)->addr_ << " - no such lease");
+        }
+    }
+    LeaseMgr::updateLeases6(leases);
 }
 
 bool
@@ -348,9 +426,10 @@ Memfile_LeaseMgr::deleteLease(const bundy::asiolink::IOAddress& addr) {
                 // Setting valid lifetime to 0 means that lease is being
                 // removed.
                 lease_copy.valid_lft_ = 0;
-                lease_file4_->append(lease_copy);
+                appendLease4(lease_copy);
             }
             storage4_.erase(l);
+            checkCompaction(V4);
             return (true);
         }
 
@@ -368,10 +447,11 @@ Memfile_LeaseMgr::deleteLease(const bundy::asiolink::IOAddress& addr) {
                 // Setting lifetimes to 0 means that lease is being removed.
                 lease_copy.valid_lft_ = 0;
                 lease_copy.preferred_lft_ = 0;
-                lease_file6_->append(lease_copy);
+                appendLease6(lease_copy);
             }
 
             storage6_.erase(l);
+            checkCompaction(V6);
             return (true);
         }
     }
@@ -400,16 +480,22 @@ Memfile_LeaseMgr::getDefaultLeaseFilePath(Universe u) const {
     std::ostringstream s;
     s << CfgMgr::instance().getDataDir() << "/kea-leases";
     s << (u == V4 ? "4" : "6");
-    s << ".csv";
+    s << (binary_format_ ? ".log" : ".csv");
     return (s.str());
 }
 
 std::string
 Memfile_LeaseMgr::getLeaseFilePath(Universe u) const {
     if (u == V4) {
+        if (lease_log4_) {
+            return (lease_log4_->getFilename());
+        }
         return (lease_file4_ ? lease_file4_->getFilename() : "");
     }
 
+    if (lease_log6_) {
+        return (lease_log6_->getFilename());
+    }
     return (lease_file6_ ? lease_file6_->getFilename() : "");
 }
 
@@ -418,11 +504,79 @@ Memfile_LeaseMgr::persistLeases(Universe u) const {
     // Currently, if the lease file IO is not created, it means that writes to
     // disk have been explicitly disabled by the administrator. At some point,
     // there may be a dedicated ON/OFF flag implemented to control this.
-    if (u == V4 && lease_file4_) {
+    if (u == V4 && (lease_file4_ || lease_log4_)) {
         return (true);
     }
 
-    return (u == V6 && lease_file6_);
+    return (u == V6 && (lease_file6_ || lease_log6_));
+}
+
+void
+Memfile_LeaseMgr::compactLeaseFile(Universe u) {
+    if (u == V4) {
+        if (!lease_log4_) {
+            bundy_throw(bundy::InvalidOperation, "DHCPv4 leases are not stored"
+                      " in the binary lease file");
+        }
+        LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_COMPACT_START)
+            .arg(lease_log4_->getFilename()).arg(storage4_.size());
+        // The leases are serialized here, only the file is written in
+        // the background.
+        Lease4Collection leases(storage4_.begin(), storage4_.end());
+        lease_log4_->compact(leases);
+
+    } else {
+        if (!lease_log6_) {
+            bundy_throw(bundy::InvalidOperation, "DHCPv6 leases are not stored"
+                      " in the binary lease file");
+        }
+        LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_COMPACT_START)
+            .arg(lease_log6_->getFilename()).arg(storage6_.size());
+        Lease6Collection leases(storage6_.begin(), storage6_.end());
+        lease_log6_->compact(leases);
+    }
+}
+
+bool
+Memfile_LeaseMgr::waitForCompaction(Universe u) {
+    const LeaseLogPtr& lease_log = (u == V4 ? lease_log4_ : lease_log6_);
+    return (lease_log ? lease_log->waitForCompaction() : true);
+}
+
+void
+Memfile_LeaseMgr::appendLease4(const Lease4& lease) {
+    if (lease_log4_) {
+        lease_log4_->append(lease);
+    } else {
+        lease_file4_->append(lease);
+    }
+}
+
+void
+Memfile_LeaseMgr::appendLease6(const Lease6& lease) {
+    if (lease_log6_) {
+        lease_log6_->append(lease);
+    } else {
+        lease_file6_->append(lease);
+    }
+}
+
+void
+Memfile_LeaseMgr::checkCompaction(Universe u) {
+    if (compact_threshold_ == 0) {
+        return;
+    }
+    const LeaseLogPtr& lease_log = (u == V4 ? lease_log4_ : lease_log6_);
+    if (!lease_log || lease_log->isCompacting()) {
+        return;
+    }
+    // Don't compact the file which holds mostly live leases: it wouldn't
+    // shrink much.
+    const uint64_t live = (u == V4 ? storage4_.size() : storage6_.size());
+    if (lease_log->getAppendCount() > std::max<uint64_t>(compact_threshold_,
+                                                         live)) {
+        compactLeaseFile(u);
+    }
 }
 
 std::string
@@ -463,7 +617,7 @@ Memfile_LeaseMgr::load4() {
     }
 
     LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LEASES_RELOAD4)
-        .arg(lease_file4_->getFilename());
+        .arg(getLeaseFilePath(V4));
 
     // Remove existing leases (if any). We will recreate them based on the
     // data on disk.
@@ -475,9 +629,12 @@ Memfile_LeaseMgr::load4() {
         /// that only one (or a few) leases are bad, so in theory we could
         /// continue parsing but that would require some error counters to
         /// prevent endless loops. That is enhancement for later time.
-        if (!lease_file4_->next(lease)) {
-            bundy_throw(DbOperationError, "Failed to parse the DHCPv6 lease in"
-                      " the lease file: " << lease_file4_->getReadMsg());
+        if (lease_log4_ ? !lease_log4_->next(lease) :
+            !lease_file4_->next(lease)) {
+            bundy_throw(DbOperationError, "Failed to parse the DHCPv4 lease in"
+                      " the lease file: " << (lease_log4_ ?
+                                              lease_log4_->getReadMsg() :
+                                              lease_file4_->getReadMsg()));
         }
         // If we got the lease, we update the internal container holding
         // leases. Otherwise, we reached the end of file and we leave.
@@ -524,7 +681,7 @@ Memfile_LeaseMgr::load6() {
     }
 
     LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LEASES_RELOAD6)
-        .arg(lease_file6_->getFilename());
+        .arg(getLeaseFilePath(V6));
 
     // Remove existing leases (if any). We will recreate them based on the
     // data on disk.
@@ -536,9 +693,12 @@ Memfile_LeaseMgr::load6() {
         /// that only one (or a few) leases are bad, so in theory we could
         /// continue parsing but that would require some error counters to
         /// prevent endless loops. That is enhancement for later time.
-        if (!lease_file6_->next(lease)) {
+        if (lease_log6_ ? !lease_log6_->next(lease) :
+            !lease_file6_->next(lease)) {
             bundy_throw(DbOperationError, "Failed to parse the DHCPv6 lease in"
-                      " the lease file: " << lease_file6_->getReadMsg());
+                      " the lease file: " << (lease_log6_ ?
+                                              lease_log6_->getReadMsg() :
+                                              lease_file6_->getReadMsg()));
         }
         // If we got the lease, we update the internal container holding
         // leases. Otherwise, we reached the end of file and we leave.
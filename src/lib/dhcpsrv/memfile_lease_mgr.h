@@ -18,13 +18,9 @@
 #include <dhcp/hwaddr.h>
 #include <dhcpsrv/csv_lease_file4.h>
 #include <dhcpsrv/csv_lease_file6.h>
+#include <dhcpsrv/lease_log.h>
 #include <dhcpsrv/lease_mgr.h>
-
-#include <boost/multi_index/indexed_by.hpp>
-#include <boost/multi_index/member.hpp>
-#include <boost/multi_index/ordered_index.hpp>
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/composite_key.hpp>
+#include <dhcpsrv/memfile_lease_storage.h>
 
 namespace bundy {
 namespace dhcp {
@@ -68,6 +64,25 @@ namespace dhcp {
 /// is not specified, the default location in the installation
 /// directory is used: var/bundy/kea-leases4.csv and
 /// var/bundy/kea-leases6.csv.
+///
+/// The "format=csv|binary" parameter selects the format of the lease file.
+/// The default "csv" format is human readable, but each lease update is a
+/// formatted write which is not synced to the disk. The "binary" format
+/// uses the @c LeaseLog: each lease update is durable when the function
+/// updating the lease returns, at the cost of a write and an @c fdatasync
+/// per update. This class is not thread safe and the DHCP servers update
+/// the leases from a single thread, so the group commit of the
+/// @c LeaseLog never has more than one update to commit at a time. The
+/// default locations of the binary lease files are var/bundy/kea-leases4.log
+/// and var/bundy/kea-leases6.log.
+///
+/// The binary lease file is compacted in the background, i.e. the live
+/// leases are rewritten to a new file which replaces the old one, when the
+/// number of lease updates appended since the last compaction exceeds the
+/// value of the "compact-threshold=[count]" parameter and the number of
+/// live leases. The compaction is disabled when this parameter is 0 or
+/// not specified. The compaction can also be started explicitly with
+/// @c compactLeaseFile.
 class Memfile_LeaseMgr : public LeaseMgr {
 public:
 
@@ -190,6 +205,17 @@ public:
     virtual Lease6Ptr getLease6(Lease::Type type,
                                 const bundy::asiolink::IOAddress& addr) const;
 
+    /// @brief Returns IPv6 leases for a group of addresses.
+    ///
+    /// This function returns copies of the leases.
+    ///
+    /// @param type specifies lease type: (NA, TA or PD)
+    /// @param addrs addresses of the searched leases
+    ///
+    /// @return collection of the leases found
+    virtual Lease6Collection getLeases6(Lease::Type type,
+                                        const AddressCollection& addrs) const;
+
     /// @brief Returns existing IPv6 lease for a given DUID+IA combination
     ///
     /// @todo Not implemented yet
@@ -236,6 +262,26 @@ public:
     /// If no such lease is present, an exception will be thrown.
     virtual void updateLease6(const Lease6Ptr& lease6);
 
+    /// @brief Updates a group of IPv4 leases.
+    ///
+    /// The presence of all leases is checked before any of them is
+    /// updated, so the group is updated as a whole or not at all.
+    ///
+    /// @param leases The leases to be updated.
+    ///
+    /// @throw NoSuchLease if any of the leases is not present.
+    virtual void updateLeases4(const Lease4Collection& leases);
+
+    /// @brief Updates a group of IPv6 leases.
+    ///
+    /// The presence of all leases is checked before any of them is
+    /// updated, so the group is updated as a whole or not at all.
+    ///
+    /// @param leases The leases to be updated.
+    ///
+    /// @throw NoSuchLease if any of the leases is not present.
+    virtual void updateLeases6(const Lease6Collection& leases);
+
     /// @brief Deletes a lease.
     ///
     /// @param addr Address of the lease to be deleted. (This can be IPv4 or
@@ -315,8 +361,55 @@ public:
     /// server shut down.
     bool persistLeases(Universe u) const;
 
+    /// @brief Checks if leases are stored in the binary lease file.
+    ///
+    /// @return true if the "format=binary" parameter has been specified,
+    /// false if leases are stored in the CSV file.
+    bool isBinaryFormat() const {
+        return (binary_format_);
+    }
+
+    /// @brief Starts the background compaction of the binary lease file.
+    ///
+    /// The compaction rewrites the live leases held in memory to a new file
+    /// which replaces the current lease file when the compaction completes.
+    ///
+    /// @param u Universe (V4 or V6).
+    ///
+    /// @throw bundy::InvalidOperation if leases are not stored in the
+    /// binary lease file for the universe.
+    /// @throw LeaseLogError if the compaction is already in progress.
+    void compactLeaseFile(Universe u);
+
+    /// @brief Waits for the compaction of the binary lease file to complete.
+    ///
+    /// @param u Universe (V4 or V6).
+    ///
+    /// @return false if the compaction has failed, true otherwise.
+    bool waitForCompaction(Universe u);
+
 protected:
 
+    /// @brief Appends the DHCPv4 lease to the lease file.
+    ///
+    /// This function must be called only if leases are persisted.
+    ///
+    /// @param lease Lease to be written.
+    void appendLease4(const Lease4& lease);
+
+    /// @brief Appends the DHCPv6 lease to the lease file.
+    ///
+    /// This function must be called only if leases are persisted.
+    ///
+    /// @param lease Lease to be written.
+    void appendLease6(const Lease6& lease);
+
+    /// @brief Starts compaction of the binary lease file if it has grown
+    /// beyond the compaction threshold.
+    ///
+    /// @param u Universe (V4 or V6).
+    void checkCompaction(Universe u);
+
     /// @brief Load all DHCPv4 leases from the file.
     ///
     /// This method loads all DHCPv4 leases from a file to memory. It removes
@@ -380,108 +473,6 @@ protected:
     /// argument to this function.
     std::string initLeaseFilePath(Universe u);
 
-    // This is a multi-index container, which holds elements that can
-    // be accessed using different search indexes.
-    typedef boost::multi_index_container<
-        // It holds pointers to Lease6 objects.
-        Lease6Ptr,
-        boost::multi_index::indexed_by<
-            // Specification of the first index starts here.
-            // This index sorts leases by IPv6 addresses represented as
-            // IOAddress objects.
-            boost::multi_index::ordered_unique<
-                boost::multi_index::member<Lease, bundy::asiolink::IOAddress, &Lease::addr_>
-            >,
-
-            // Specification of the second index starts here.
-            boost::multi_index::ordered_unique<
-                // This is a composite index that will be used to search for
-                // the lease using three attributes: DUID, IAID, Subnet Id.
-                boost::multi_index::composite_key<
-                    Lease6,
-                    // The DUID can be retrieved from the Lease6 object using
-                    // a getDuidVector const function.
-                    boost::multi_index::const_mem_fun<Lease6, const std::vector<uint8_t>&,
-                                                      &Lease6::getDuidVector>,
-                    // The two other ingredients of this index are IAID and
-                    // subnet id.
-                    boost::multi_index::member<Lease6, uint32_t, &Lease6::iaid_>,
-                    boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
-                >
-            >
-        >
-     > Lease6Storage; // Specify the type name of this container.
-
-    // This is a multi-index container, which holds elements that can
-    // be accessed using different search indexes.
-    typedef boost::multi_index_container<
-        // It holds pointers to Lease4 objects.
-        Lease4Ptr,
-        // Specification of search indexes starts here.
-        boost::multi_index::indexed_by<
-            // Specification of the first index starts here.
-            // This index sorts leases by IPv4 addresses represented as
-            // IOAddress objects.
-            boost::multi_index::ordered_unique<
-                // The IPv4 address are held in addr_ members that belong to
-                // Lease class.
-                boost::multi_index::member<Lease, bundy::asiolink::IOAddress, &Lease::addr_>
-            >,
-
-            // Specification of the second index starts here.
-            boost::multi_index::ordered_unique<
-                // This is a composite index that combines two attributes of the
-                // Lease4 object: hardware address and subnet id.
-                boost::multi_index::composite_key<
-                    Lease4,
-                    // The hardware address is held in the hwaddr_ member of the
-                    // Lease4 object.
-                    boost::multi_index::member<Lease4, std::vector<uint8_t>,
-                                               &Lease4::hwaddr_>,
-                    // The subnet id is held in the subnet_id_ member of Lease4
-                    // class. Note that the subnet_id_ is defined in the base
-                    // class (Lease) so we have to point to this class rather
-                    // than derived class: Lease4.
-                    boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
-                >
-            >,
-
-            // Specification of the third index starts here.
-            boost::multi_index::ordered_non_unique<
-                // This is a composite index that uses two values to search for a
-                // lease: client id and subnet id.
-                boost::multi_index::composite_key<
-                    Lease4,
-                    // The client id can be retrieved from the Lease4 object by
-                    // calling getClientIdVector const function.
-                    boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
-                                                      &Lease4::getClientIdVector>,
-                    // The subnet id is accessed through the subnet_id_ member.
-                    boost::multi_index::member<Lease, uint32_t, &Lease::subnet_id_>
-                >
-            >,
-
-            // Specification of the fourth index starts here.
-            boost::multi_index::ordered_non_unique<
-                // This is a composite index that uses two values to search for a
-                // lease: client id and subnet id.
-                boost::multi_index::composite_key<
-                    Lease4,
-                    // The client id can be retrieved from the Lease4 object by
-                    // calling getClientIdVector const function.
-                    boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
-                                                      &Lease4::getClientIdVector>,
-                    // The hardware address is held in the hwaddr_ member of the
-                    // Lease4 object.
-                    boost::multi_index::member<Lease4, std::vector<uint8_t>,
-                                               &Lease4::hwaddr_>,
-                    // The subnet id is accessed through the subnet_id_ member.
-                    boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
-                >
-            >
-        >
-    > Lease4Storage; // Specify the type name for this container.
-
     /// @brief stores IPv4 leases
     Lease4Storage storage4_;
 
@@ -494,6 +485,18 @@ protected:
     /// @brief Holds the pointer to the DHCPv6 lease file IO.
     boost::shared_ptr<CSVLeaseFile6> lease_file6_;
 
+    /// @brief Holds the pointer to the binary DHCPv4 lease file.
+    LeaseLogPtr lease_log4_;
+
+    /// @brief Holds the pointer to the binary DHCPv6 lease file.
+    LeaseLogPtr lease_log6_;
+
+    /// @brief Indicates that leases are stored in the binary lease file.
+    bool binary_format_;
+
+    /// @brief Number of appended records which triggers the compaction.
+    uint32_t compact_threshold_;
+
 };
 
 }; // end of bundy::dhcp namespace
@@ -0,0 +1,183 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef MEMFILE_LEASE_STORAGE_H
+#define MEMFILE_LEASE_STORAGE_H
+
+/// @file memfile_lease_storage.h
+/// @brief Containers holding leases in memory.
+///
+/// These containers are used by the @c Memfile_LeaseMgr to hold all leases
+/// and by the @c CachingLeaseMgr to hold the cached leases.
+
+#include <dhcpsrv/lease.h>
+
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/indexed_by.hpp>
+#include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index_container.hpp>
+
+#include <vector>
+
+namespace bundy {
+namespace dhcp {
+
+/// @name Search indexes of the lease containers.
+///
+/// The indexes are defined once and used both by the containers of all
+/// leases and by the containers of the cached leases, which have an extra
+/// index ordering the leases by their use.
+//@{
+
+/// @brief Index sorting leases by addresses represented as IOAddress
+/// objects.
+typedef boost::multi_index::ordered_unique<
+    // The addresses are held in addr_ members that belong to Lease class.
+    boost::multi_index::member<Lease, bundy::asiolink::IOAddress, &Lease::addr_>
+> LeaseAddressIndex;
+
+/// @brief Index of the DHCPv6 leases by DUID, IAID and subnet id.
+typedef boost::multi_index::ordered_unique<
+    // This is a composite index that will be used to search for
+    // the lease using three attributes: DUID, IAID, Subnet Id.
+    boost::multi_index::composite_key<
+        Lease6,
+        // The DUID can be retrieved from the Lease6 object using
+        // a getDuidVector const function.
+        boost::multi_index::const_mem_fun<Lease6, const std::vector<uint8_t>&,
+                                          &Lease6::getDuidVector>,
+        // The two other ingredients of this index are IAID and
+        // subnet id.
+        boost::multi_index::member<Lease6, uint32_t, &Lease6::iaid_>,
+        boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
+    >
+> Lease6DuidIaidSubnetIndex;
+
+/// @brief Index of the DHCPv4 leases by hardware address and subnet id.
+typedef boost::multi_index::ordered_unique<
+    // This is a composite index that combines two attributes of the
+    // Lease4 object: hardware address and subnet id.
+    boost::multi_index::composite_key<
+        Lease4,
+        // The hardware address is held in the hwaddr_ member of the
+        // Lease4 object.
+        boost::multi_index::member<Lease4, std::vector<uint8_t>,
+                                   &Lease4::hwaddr_>,
+        // The subnet id is held in the subnet_id_ member of Lease4
+        // class. Note that the subnet_id_ is defined in the base
+        // class (Lease) so we have to point to this class rather
+        // than derived class: Lease4.
+        boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
+    >
+> Lease4HWAddrSubnetIndex;
+
+/// @brief Index of the DHCPv4 leases by client id and subnet id.
+typedef boost::multi_index::ordered_non_unique<
+    // This is a composite index that uses two values to search for a
+    // lease: client id and subnet id.
+    boost::multi_index::composite_key<
+        Lease4,
+        // The client id can be retrieved from the Lease4 object by
+        // calling getClientIdVector const function.
+        boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
+                                          &Lease4::getClientIdVector>,
+        // The subnet id is accessed through the subnet_id_ member.
+        boost::multi_index::member<Lease, uint32_t, &Lease::subnet_id_>
+    >
+> Lease4ClientIdSubnetIndex;
+
+/// @brief Index of the DHCPv4 leases by client id, hardware address and
+/// subnet id.
+typedef boost::multi_index::ordered_non_unique<
+    // This is a composite index that uses three values to search for a
+    // lease: client id, hardware address and subnet id.
+    boost::multi_index::composite_key<
+        Lease4,
+        // The client id can be retrieved from the Lease4 object by
+        // calling getClientIdVector const function.
+        boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
+                                          &Lease4::getClientIdVector>,
+        // The hardware address is held in the hwaddr_ member of the
+        // Lease4 object.
+        boost::multi_index::member<Lease4, std::vector<uint8_t>,
+                                   &Lease4::hwaddr_>,
+        // The subnet id is accessed through the subnet_id_ member.
+        boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
+    >
+> Lease4ClientIdHWAddrSubnetIndex;
+
+//@}
+
+// This is a multi-index container, which holds elements that can
+// be accessed using different search indexes.
+typedef boost::multi_index_container<
+    // It holds pointers to Lease6 objects.
+    Lease6Ptr,
+    boost::multi_index::indexed_by<
+        LeaseAddressIndex,
+        Lease6DuidIaidSubnetIndex
+    >
+ > Lease6Storage; // Specify the type name of this container.
+
+// This is a multi-index container, which holds elements that can
+// be accessed using different search indexes.
+typedef boost::multi_index_container<
+    // It holds pointers to Lease4 objects.
+    Lease4Ptr,
+    // Specification of search indexes starts here.
+    boost::multi_index::indexed_by<
+        LeaseAddressIndex,
+        Lease4HWAddrSubnetIndex,
+        Lease4ClientIdSubnetIndex,
+        Lease4ClientIdHWAddrSubnetIndex
+    >
+> Lease4Storage; // Specify the type name for this container.
+
+/// @brief A multi index container holding the cached DHCPv6 leases.
+///
+/// The container has the same indexes as the @c Lease6Storage, followed by
+/// the sequenced index which orders the leases from the least recently used
+/// one to the most recently used one.
+typedef boost::multi_index_container<
+    Lease6Ptr,
+    boost::multi_index::indexed_by<
+        LeaseAddressIndex,
+        Lease6DuidIaidSubnetIndex,
+        boost::multi_index::sequenced<>
+    >
+> Lease6CacheStorage;
+
+/// @brief A multi index container holding the cached DHCPv4 leases.
+///
+/// The container has the same indexes as the @c Lease4Storage, followed by
+/// the sequenced index which orders the leases from the least recently used
+/// one to the most recently used one.
+typedef boost::multi_index_container<
+    Lease4Ptr,
+    boost::multi_index::indexed_by<
+        LeaseAddressIndex,
+        Lease4HWAddrSubnetIndex,
+        Lease4ClientIdSubnetIndex,
+        Lease4ClientIdHWAddrSubnetIndex,
+        boost::multi_index::sequenced<>
+    >
+> Lease4CacheStorage;
+
+} // namespace bundy::dhcp
+} // namespace bundy
+
+#endif // MEMFILE_LEASE_STORAGE_H
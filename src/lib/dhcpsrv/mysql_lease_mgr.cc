@@ -23,6 +23,7 @@
 #include <boost/static_assert.hpp>
 #include <mysqld_error.h>
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -133,6 +134,15 @@ TaggedStatement tagged_statements[] = {
                         "fqdn_fwd, fqdn_rev, hostname "
                             "FROM lease4 "
                             "WHERE address = ?"},
+    // The number of placeholders in the IN clause must be equal to
+    // MySqlLeaseMgr::ADDRESS_BATCH_SIZE.
+    {MySqlLeaseMgr::GET_LEASE4_ADDR_BATCH,
+                    "SELECT address, hwaddr, client_id, "
+                        "valid_lifetime, expire, subnet_id, "
+                        "fqdn_fwd, fqdn_rev, hostname "
+                            "FROM lease4 "
+                            "WHERE address IN (?, ?, ?, ?, ?, ?, ?, ?, "
+                                "?, ?, ?, ?, ?, ?, ?, ?)"},
     {MySqlLeaseMgr::GET_LEASE4_CLIENTID,
                     "SELECT address, hwaddr, client_id, "
                         "valid_lifetime, expire, subnet_id, "
@@ -164,6 +174,17 @@ TaggedStatement tagged_statements[] = {
                         "fqdn_fwd, fqdn_rev, hostname "
                             "FROM lease6 "
                             "WHERE address = ? AND lease_type = ?"},
+    // The number of placeholders in the IN clause must be equal to
+    // MySqlLeaseMgr::ADDRESS_BATCH_SIZE.
+    {MySqlLeaseMgr::GET_LEASE6_ADDR_BATCH,
+                    "SELECT address, duid, valid_lifetime, "
+                        "expire, subnet_id, pref_lifetime, "
+                        "lease_type, iaid, prefix_len, "
+                        "fqdn_fwd, fqdn_rev, hostname "
+                            "FROM lease6 "
+                            "WHERE address IN (?, ?, ?, ?, ?, ?, ?, ?, "
+                                "?, ?, ?, ?, ?, ?, ?, ?) "
+                            "AND lease_type = ?"},
     {MySqlLeaseMgr::GET_LEASE6_DUID_IAID,
                     "SELECT address, duid, valid_lifetime, "
                         "expire, subnet_id, pref_lifetime, "
@@ -1385,6 +1406,97 @@ MySqlLeaseMgr::addLease(const Lease6Ptr& lease) {
     return (addLeaseCommon(INSERT_LEASE6, bind));
 }
 
+// Adding and updating groups of leases.  All leases of the group are
+// written within a single transaction, so that the group is written as a
+// whole or not at all, and the database commits the changes once for
+// the whole group rather than once for each lease.
+
+namespace {
+
+/// @brief Updates a single IPv4 lease.
+///
+/// Allows the common code handling a group of leases to pick the
+/// update method appropriate for the lease type.
+void
+updateSingleLease(MySqlLeaseMgr& lease_mgr, const Lease4Ptr& lease) {
+    lease_mgr.updateLease4(lease);
+}
+
+/// @brief Updates a single IPv6 lease.
+void
+updateSingleLease(MySqlLeaseMgr& lease_mgr, const Lease6Ptr& lease) {
+    lease_mgr.updateLease6(lease);
+}
+
+}; // Anonymous namespace
+
+void
+MySqlLeaseMgr::startTransaction() {
+    if (mysql_query(mysql_, "START TRANSACTION") != 0) {
+        bundy_throw(DbOperationError, "unable to start transaction: "
+                  << mysql_error(mysql_));
+    }
+}
+
+template <typename LeaseCollection>
+bool
+MySqlLeaseMgr::writeLeasesCommon(const LeaseCollection& leases, bool add) {
+    startTransaction();
+    try {
+        for (typename LeaseCollection::const_iterator lease = leases.begin();
+             lease != leases.end(); ++lease) {
+            if (add) {
+                if (!addLease(*lease)) {
+                    // The lease exists: none of the leases is added.
+                    rollback();
+                    return (false);
+                }
+            } else {
+                updateSingleLease(*this, *lease);
+            }
+        }
+    } catch (...) {
+        // Roll back the transaction, but report the original error rather
+        // than a failure of the rollback.
+        try {
+            rollback();
+        } catch (...) {
+        }
+        throw;
+    }
+
+    commit();
+    return (true);
+}
+
+bool
+MySqlLeaseMgr::addLeases(const Lease4Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MYSQL_ADD_LEASES).arg(leases.size());
+    return (writeLeasesCommon(leases, true));
+}
+
+bool
+MySqlLeaseMgr::addLeases(const Lease6Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MYSQL_ADD_LEASES).arg(leases.size());
+    return (writeLeasesCommon(leases, true));
+}
+
+void
+MySqlLeaseMgr::updateLeases4(const Lease4Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MYSQL_UPDATE_LEASES).arg(leases.size());
+    writeLeasesCommon(leases, false);
+}
+
+void
+MySqlLeaseMgr::updateLeases6(const Lease6Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MYSQL_UPDATE_LEASES).arg(leases.size());
+    writeLeasesCommon(leases, false);
+}
+
 // Extraction of leases from the database.
 //
 // All getLease() methods ultimately call getLeaseCollection().  This
@@ -1534,6 +1646,38 @@ MySqlLeaseMgr::getLease4(const bundy::asiolink::IOAddress& addr) const {
 }
 
 
+Lease4Collection
+MySqlLeaseMgr::getLeases4(const AddressCollection& addrs) const {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MYSQL_GET_ADDRS4).arg(addrs.size());
+
+    Lease4Collection result;
+    for (size_t first = 0; first < addrs.size();
+         first += ADDRESS_BATCH_SIZE) {
+        // Set up the WHERE clause values.  The statement has a fixed number
+        // of placeholders: if there are fewer addresses left, the remaining
+        // placeholders are filled with the last address, which doesn't
+        // change the result.
+        const size_t last = std::min(addrs.size(),
+                                     first + ADDRESS_BATCH_SIZE) - 1;
+        uint32_t addr4[ADDRESS_BATCH_SIZE];
+        MYSQL_BIND inbind[ADDRESS_BATCH_SIZE];
+        memset(inbind, 0, sizeof(inbind));
+        for (size_t i = 0; i < ADDRESS_BATCH_SIZE; ++i) {
+            addr4[i] = static_cast<uint32_t>(addrs[std::min(first + i, last)]);
+            inbind[i].buffer_type = MYSQL_TYPE_LONG;
+            inbind[i].buffer = reinterpret_cast<char*>(&addr4[i]);
+            inbind[i].is_unsigned = MLM_TRUE;
+        }
+
+        // Get the data, appending it to the leases already retrieved.
+        getLeaseCollection(GET_LEASE4_ADDR_BATCH, inbind, result);
+    }
+
+    return (result);
+}
+
+
 Lease4Collection
 MySqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
@@ -1694,6 +1838,49 @@ MySqlLeaseMgr::getLease6(Lease::Type lease_type,
 }
 
 
+Lease6Collection
+MySqlLeaseMgr::getLeases6(Lease::Type lease_type,
+                          const AddressCollection& addrs) const {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MYSQL_GET_ADDRS6).arg(addrs.size()).arg(lease_type);
+
+    Lease6Collection result;
+    for (size_t first = 0; first < addrs.size();
+         first += ADDRESS_BATCH_SIZE) {
+        // Set up the WHERE clause values.  As for IPv4, the unused
+        // placeholders are filled with the last address.
+        const size_t last = std::min(addrs.size(),
+                                     first + ADDRESS_BATCH_SIZE) - 1;
+        std::string addr6[ADDRESS_BATCH_SIZE];
+        unsigned long addr6_length[ADDRESS_BATCH_SIZE];
+        MYSQL_BIND inbind[ADDRESS_BATCH_SIZE + 1];
+        memset(inbind, 0, sizeof(inbind));
+        for (size_t i = 0; i < ADDRESS_BATCH_SIZE; ++i) {
+            addr6[i] = addrs[std::min(first + i, last)].toText();
+            addr6_length[i] = addr6[i].size();
+
+            // See the earlier description of the use of "const_cast" when
+            // accessing the address for an explanation of the reason.
+            inbind[i].buffer_type = MYSQL_TYPE_STRING;
+            inbind[i].buffer = const_cast<char*>(addr6[i].c_str());
+            inbind[i].buffer_length = addr6_length[i];
+            inbind[i].length = &addr6_length[i];
+        }
+
+        // LEASE_TYPE
+        inbind[ADDRESS_BATCH_SIZE].buffer_type = MYSQL_TYPE_TINY;
+        inbind[ADDRESS_BATCH_SIZE].buffer =
+            reinterpret_cast<char*>(&lease_type);
+        inbind[ADDRESS_BATCH_SIZE].is_unsigned = MLM_TRUE;
+
+        // Get the data, appending it to the leases already retrieved.
+        getLeaseCollection(GET_LEASE6_ADDR_BATCH, inbind, result);
+    }
+
+    return (result);
+}
+
+
 Lease6Collection
 MySqlLeaseMgr::getLeases6(Lease::Type lease_type,
                           const DUID& duid, uint32_t iaid) const {
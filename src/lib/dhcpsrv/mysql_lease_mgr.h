@@ -122,6 +122,13 @@ public:
     /// @brief Destructor (closes database)
     virtual ~MySqlLeaseMgr();
 
+    /// @brief Number of addresses checked by a single batched query
+    ///
+    /// The batched queries for leases by address select the leases using
+    /// the "address IN (...)" clause, having this number of placeholders.
+    /// Longer address lists are split into chunks of this size.
+    static const size_t ADDRESS_BATCH_SIZE = 16;
+
     /// @brief Adds an IPv4 lease
     ///
     /// @param lease lease to be added
@@ -144,6 +151,32 @@ public:
     ///        failed.
     virtual bool addLease(const Lease6Ptr& lease);
 
+    /// @brief Adds a group of IPv4 leases
+    ///
+    /// All leases are inserted within a single transaction, which is
+    /// rolled back if any of the leases is already in the database.
+    ///
+    /// @param leases leases to be added
+    ///
+    /// @result true if all leases were added, false if none was added.
+    ///
+    /// @throw bundy::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual bool addLeases(const Lease4Collection& leases);
+
+    /// @brief Adds a group of IPv6 leases
+    ///
+    /// All leases are inserted within a single transaction, which is
+    /// rolled back if any of the leases is already in the database.
+    ///
+    /// @param leases leases to be added
+    ///
+    /// @result true if all leases were added, false if none was added.
+    ///
+    /// @throw bundy::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual bool addLeases(const Lease6Collection& leases);
+
     /// @brief Returns an IPv4 lease for specified IPv4 address
     ///
     /// This method return a lease that is associated with a given address.
@@ -183,6 +216,22 @@ public:
     ///        failed.
     virtual Lease4Collection getLease4(const bundy::dhcp::HWAddr& hwaddr) const;
 
+    /// @brief Returns IPv4 leases for a group of addresses
+    ///
+    /// The leases are retrieved with one query per @c ADDRESS_BATCH_SIZE
+    /// addresses.
+    ///
+    /// @param addrs addresses of the searched leases
+    ///
+    /// @return collection of the leases found
+    ///
+    /// @throw bundy::dhcp::DataTruncation Data was truncated on retrieval to
+    ///        fit into the space allocated for the result.  This indicates a
+    ///        programming error.
+    /// @throw bundy::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual Lease4Collection getLeases4(const AddressCollection& addrs) const;
+
     /// @brief Returns existing IPv4 leases for specified hardware address
     ///        and a subnet
     ///
@@ -272,6 +321,26 @@ public:
     virtual Lease6Ptr getLease6(Lease::Type type,
                                 const bundy::asiolink::IOAddress& addr) const;
 
+    /// @brief Returns IPv6 leases for a group of addresses
+    ///
+    /// The leases are retrieved with one query per @c ADDRESS_BATCH_SIZE
+    /// addresses.
+    ///
+    /// @param type specifies lease type: (NA, TA or PD)
+    /// @param addrs addresses of the searched leases
+    ///
+    /// @return collection of the leases found
+    ///
+    /// @throw bundy::BadValue record retrieved from database had an invalid
+    ///        lease type field.
+    /// @throw bundy::dhcp::DataTruncation Data was truncated on retrieval to
+    ///        fit into the space allocated for the result.  This indicates a
+    ///        programming error.
+    /// @throw bundy::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual Lease6Collection getLeases6(Lease::Type type,
+                                        const AddressCollection& addrs) const;
+
     /// @brief Returns existing IPv6 leases for a given DUID+IA combination
     ///
     /// Although in the usual case there will be only one lease, for mobile
@@ -340,6 +409,32 @@ public:
     ///        failed.
     virtual void updateLease6(const Lease6Ptr& lease6);
 
+    /// @brief Updates a group of IPv4 leases
+    ///
+    /// All leases are updated within a single transaction, which is
+    /// rolled back if any of the updates fails.
+    ///
+    /// @param leases The leases to be updated.
+    ///
+    /// @throw bundy::dhcp::NoSuchLease Attempt to update a lease that did not
+    ///        exist.
+    /// @throw bundy::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void updateLeases4(const Lease4Collection& leases);
+
+    /// @brief Updates a group of IPv6 leases
+    ///
+    /// All leases are updated within a single transaction, which is
+    /// rolled back if any of the updates fails.
+    ///
+    /// @param leases The leases to be updated.
+    ///
+    /// @throw bundy::dhcp::NoSuchLease Attempt to update a lease that did not
+    ///        exist.
+    /// @throw bundy::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void updateLeases6(const Lease6Collection& leases);
+
     /// @brief Deletes a lease.
     ///
     /// @param addr Address of the lease to be deleted.  This can be an IPv4
@@ -456,11 +551,13 @@ public:
         DELETE_LEASE4,              // Delete from lease4 by address
         DELETE_LEASE6,              // Delete from lease6 by address
         GET_LEASE4_ADDR,            // Get lease4 by address
+        GET_LEASE4_ADDR_BATCH,      // Get lease4 by a group of addresses
         GET_LEASE4_CLIENTID,        // Get lease4 by client ID
         GET_LEASE4_CLIENTID_SUBID,  // Get lease4 by client ID & subnet ID
         GET_LEASE4_HWADDR,          // Get lease4 by HW address
         GET_LEASE4_HWADDR_SUBID,    // Get lease4 by HW address & subnet ID
         GET_LEASE6_ADDR,            // Get lease6 by address
+        GET_LEASE6_ADDR_BATCH,      // Get lease6 by a group of addresses
         GET_LEASE6_DUID_IAID,       // Get lease6 by DUID and IAID
         GET_LEASE6_DUID_IAID_SUBID, // Get lease6 by DUID, IAID and subnet ID
         GET_VERSION,                // Obtain version number
@@ -634,6 +731,34 @@ private:
     void updateLeaseCommon(StatementIndex stindex, MYSQL_BIND* bind,
                            const LeasePtr& lease);
 
+    /// @brief Start a transaction
+    ///
+    /// Suspends the autocommit mode until the transaction is ended with
+    /// a call to @c commit or @c rollback.
+    ///
+    /// @throw bundy::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    void startTransaction();
+
+    /// @brief Add or update a group of leases within a transaction
+    ///
+    /// Starts a transaction, adds or updates all leases and commits the
+    /// transaction. If any of the leases can't be added or updated, the
+    /// transaction is rolled back.
+    ///
+    /// @param leases Leases to be added or updated.
+    /// @param add true if the leases are to be added, false if updated.
+    ///
+    /// @return true if the transaction has been committed, false if it has
+    ///         been rolled back because a lease to be added already existed.
+    ///
+    /// @throw NoSuchLease Could not update a lease because no lease matches
+    ///        its address.
+    /// @throw bundy::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    template <typename LeaseCollection>
+    bool writeLeasesCommon(const LeaseCollection& leases, bool add);
+
     /// @brief Delete lease common code
     ///
     /// Holds the common code for deleting a lease.  It binds the parameters
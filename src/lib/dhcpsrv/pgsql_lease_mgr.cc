@@ -78,6 +78,13 @@ TaggedStatement tagged_statements[] = {
      "valid_lifetime, extract(epoch from expire), subnet_id, fqdn_fwd, fqdn_rev, hostname "
      "FROM lease4 "
      "WHERE address = $1"},
+    {PgSqlLeaseMgr::GET_LEASE4_ADDR_BATCH, 1,
+        { 1016 },
+        "get_lease4_addr_batch",
+     "SELECT address, hwaddr, client_id, "
+     "valid_lifetime, extract(epoch from expire), subnet_id, fqdn_fwd, fqdn_rev, hostname "
+     "FROM lease4 "
+     "WHERE address = ANY($1)"},
     {PgSqlLeaseMgr::GET_LEASE4_CLIENTID, 1,
         { 17 },
         "get_lease4_clientid",
@@ -114,6 +121,14 @@ TaggedStatement tagged_statements[] = {
      "lease_type, iaid, prefix_len, fqdn_fwd, fqdn_rev, hostname "
      "FROM lease6 "
      "WHERE address = $1 AND lease_type = $2"},
+    {PgSqlLeaseMgr::GET_LEASE6_ADDR_BATCH, 2,
+        { 1015, 21 },
+        "get_lease6_addr_batch",
+     "SELECT address, duid, valid_lifetime, "
+     "extract(epoch from expire)::bigint, subnet_id, pref_lifetime, "
+     "lease_type, iaid, prefix_len, fqdn_fwd, fqdn_rev, hostname "
+     "FROM lease6 "
+     "WHERE address = ANY($1) AND lease_type = $2"},
     {PgSqlLeaseMgr::GET_LEASE6_DUID_IAID, 3,
         { 17, 20, 21 },
         "get_lease6_duid_iaid",
@@ -723,6 +738,110 @@ PgSqlLeaseMgr::addLease(const Lease6Ptr& lease) {
     return (addLeaseCommon(INSERT_LEASE6, params));
 }
 
+namespace {
+
+/// @brief Updates a single IPv4 lease.
+///
+/// Allows the common code handling a group of leases to pick the
+/// update method appropriate for the lease type.
+void
+updateSingleLease(PgSqlLeaseMgr& lease_mgr, const Lease4Ptr& lease) {
+    lease_mgr.updateLease4(lease);
+}
+
+/// @brief Updates a single IPv6 lease.
+void
+updateSingleLease(PgSqlLeaseMgr& lease_mgr, const Lease6Ptr& lease) {
+    lease_mgr.updateLease6(lease);
+}
+
+/// @brief Converts a group of addresses to a PostgreSQL array literal.
+///
+/// @param addrs Addresses to be converted.
+/// @param v4 true if the addresses are to be represented as integers
+///        (as in the lease4 table), false if as text (as in lease6).
+///
+/// @return Text form of the array, e.g. "{167772161,167772162}".
+std::string
+toArrayLiteral(const LeaseMgr::AddressCollection& addrs, bool v4) {
+    ostringstream tmp;
+    tmp << "{";
+    for (LeaseMgr::AddressCollection::const_iterator addr = addrs.begin();
+         addr != addrs.end(); ++addr) {
+        if (addr != addrs.begin()) {
+            tmp << ",";
+        }
+        if (v4) {
+            tmp << static_cast<uint32_t>(*addr);
+        } else {
+            tmp << addr->toText();
+        }
+    }
+    tmp << "}";
+    return (tmp.str());
+}
+
+};
+
+void
+PgSqlLeaseMgr::startTransaction() {
+    PGresult* r = PQexec(conn_, "START TRANSACTION");
+    if (PQresultStatus(r) != PGRES_COMMAND_OK) {
+        const char* error_message = PQerrorMessage(conn_);
+        PQclear(r);
+        bundy_throw(DbOperationError, "unable to start transaction: "
+                  << error_message);
+    }
+
+    PQclear(r);
+}
+
+template <typename LeaseCollection>
+bool
+PgSqlLeaseMgr::writeLeasesCommon(const LeaseCollection& leases, bool add) {
+    startTransaction();
+    try {
+        for (typename LeaseCollection::const_iterator lease = leases.begin();
+             lease != leases.end(); ++lease) {
+            if (add) {
+                if (!addLease(*lease)) {
+                    // The lease exists and the transaction has been aborted
+                    // by the server: none of the leases is added.
+                    rollback();
+                    return (false);
+                }
+            } else {
+                updateSingleLease(*this, *lease);
+            }
+        }
+    } catch (...) {
+        // Roll back the transaction, but report the original error rather
+        // than a failure of the rollback.
+        try {
+            rollback();
+        } catch (...) {
+        }
+        throw;
+    }
+
+    commit();
+    return (true);
+}
+
+bool
+PgSqlLeaseMgr::addLeases(const Lease4Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_ADD_LEASES).arg(leases.size());
+    return (writeLeasesCommon(leases, true));
+}
+
+bool
+PgSqlLeaseMgr::addLeases(const Lease6Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_ADD_LEASES).arg(leases.size());
+    return (writeLeasesCommon(leases, true));
+}
+
 template <typename Exchange, typename LeaseCollection>
 void PgSqlLeaseMgr::getLeaseCollection(StatementIndex stindex,
                                        BindParams & params,
@@ -815,6 +934,26 @@ PgSqlLeaseMgr::getLease4(const bundy::asiolink::IOAddress& addr) const {
     return (result);
 }
 
+Lease4Collection
+PgSqlLeaseMgr::getLeases4(const AddressCollection& addrs) const {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_GET_ADDRS4).arg(addrs.size());
+
+    Lease4Collection result;
+    if (addrs.empty()) {
+        return (result);
+    }
+
+    // Set up the WHERE clause value: all addresses are passed as an array.
+    BindParams inparams;
+    inparams.push_back(PgSqlParam(toArrayLiteral(addrs, true)));
+
+    // Get the data
+    getLeaseCollection(GET_LEASE4_ADDR_BATCH, inparams, result);
+
+    return (result);
+}
+
 Lease4Collection
 PgSqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
@@ -937,6 +1076,34 @@ PgSqlLeaseMgr::getLease6(Lease::Type lease_type,
     return (result);
 }
 
+Lease6Collection
+PgSqlLeaseMgr::getLeases6(Lease::Type lease_type,
+                          const AddressCollection& addrs) const {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_GET_ADDRS6).arg(addrs.size()).arg(lease_type);
+
+    Lease6Collection result;
+    if (addrs.empty()) {
+        return (result);
+    }
+
+    // Set up the WHERE clause values: all addresses are passed as an array.
+    BindParams inparams;
+    ostringstream tmp;
+
+    // ADDRESS
+    inparams.push_back(PgSqlParam(toArrayLiteral(addrs, false)));
+
+    // LEASE_TYPE
+    tmp << static_cast<uint16_t>(lease_type);
+    inparams.push_back(PgSqlParam(tmp.str()));
+
+    // ... and get the data
+    getLeaseCollection(GET_LEASE6_ADDR_BATCH, inparams, result);
+
+    return (result);
+}
+
 Lease6Collection
 PgSqlLeaseMgr::getLeases6(Lease::Type type, const DUID& duid,
                           uint32_t iaid) const {
@@ -1080,6 +1247,20 @@ PgSqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
     updateLeaseCommon(stindex, params, lease);
 }
 
+void
+PgSqlLeaseMgr::updateLeases4(const Lease4Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_UPDATE_LEASES).arg(leases.size());
+    writeLeasesCommon(leases, false);
+}
+
+void
+PgSqlLeaseMgr::updateLeases6(const Lease6Collection& leases) {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_UPDATE_LEASES).arg(leases.size());
+    writeLeasesCommon(leases, false);
+}
+
 bool
 PgSqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex, BindParams & params) {
     vector<const char *> params_;
@@ -1392,6 +1392,118 @@ TEST_F(AllocEngine4Test, outOfAddresses4) {
     EXPECT_FALSE(old_lease_);
 }
 
+// This test checks that the allocation engine finds a free address in a
+// crowded pool, checking the candidates in batches, and that it honors the
+// configured number of attempts.
+TEST_F(AllocEngine4Test, crowdedPool4) {
+    CfgMgr& cfg_mgr = CfgMgr::instance();
+    cfg_mgr.deleteSubnets4(); // Get rid of the default test configuration
+
+    subnet_ = Subnet4Ptr(new Subnet4(IOAddress("192.0.2.0"), 24, 1, 2, 3));
+    pool_ = Pool4Ptr(new Pool4(IOAddress("192.0.2.100"),
+                               IOAddress("192.0.2.139")));
+    subnet_->addPool(pool_);
+    cfg_mgr.addSubnet4(subnet_);
+
+    // Allocate the first 30 addresses of the pool to other clients. The
+    // lease manager doesn't accept two leases for the same hardware address
+    // in a subnet, so each client has a different one.
+    uint8_t hwaddr2[] = { 0, 0xfe, 0xfe, 0xfe, 0xfe, 0xfe};
+    uint8_t clientid2[] = { 8, 7, 6, 5, 4, 3, 2, 1 };
+    time_t now = time(NULL);
+    for (int i = 0; i < 30; ++i) {
+        hwaddr2[5] = i;
+        std::ostringstream addr;
+        addr << "192.0.2." << 100 + i;
+        Lease4Ptr lease(new Lease4(IOAddress(addr.str()), hwaddr2,
+                                   sizeof(hwaddr2), clientid2,
+                                   sizeof(clientid2), 501, 502, 503, now,
+                                   subnet_->getID()));
+        ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+    }
+
+    // With 30 attempts the engine checks only the addresses which are in
+    // use, so the allocation should fail.
+    boost::scoped_ptr<AllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE,
+                                                 30, false)));
+    Lease4Ptr lease = engine->allocateLease4(subnet_, clientid_, hwaddr_,
+                                             IOAddress("0.0.0.0"),
+                                             false, false, "",
+                                             false, CalloutHandlePtr(),
+                                             old_lease_);
+    EXPECT_FALSE(lease);
+
+    // One more attempt is enough to get the first free address.
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE,
+                                                 31, false)));
+    lease = engine->allocateLease4(subnet_, clientid_, hwaddr_,
+                                   IOAddress("0.0.0.0"), false, false, "",
+                                   false, CalloutHandlePtr(), old_lease_);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("192.0.2.130", lease->addr_.toText());
+    EXPECT_FALSE(old_lease_);
+
+    // The lease should have been stored in the database.
+    Lease4Ptr from_mgr = LeaseMgrFactory::instance().getLease4(lease->addr_);
+    ASSERT_TRUE(from_mgr);
+    detailCompareLease(lease, from_mgr);
+}
+
+// This test checks that the candidates which were picked in a batch but
+// not allocated are picked again by the subsequent allocations.
+TEST_F(AllocEngine4Test, crowdedPoolUnusedCandidates4) {
+    CfgMgr& cfg_mgr = CfgMgr::instance();
+    cfg_mgr.deleteSubnets4(); // Get rid of the default test configuration
+
+    subnet_ = Subnet4Ptr(new Subnet4(IOAddress("192.0.2.0"), 24, 1, 2, 3));
+    pool_ = Pool4Ptr(new Pool4(IOAddress("192.0.2.100"),
+                               IOAddress("192.0.2.139")));
+    subnet_->addPool(pool_);
+    cfg_mgr.addSubnet4(subnet_);
+
+    // Allocate the first 3 addresses of the pool to other clients. The
+    // engine checks the candidates in batches of 1, 2 and 4, so the
+    // first free address is found in a batch of 4 addresses: 192.0.2.103
+    // to 192.0.2.106.
+    uint8_t hwaddr2[] = { 0, 0xfe, 0xfe, 0xfe, 0xfe, 0xfe};
+    uint8_t clientid2[] = { 8, 7, 6, 5, 4, 3, 2, 1 };
+    time_t now = time(NULL);
+    for (int i = 0; i < 3; ++i) {
+        hwaddr2[5] = i;
+        std::ostringstream addr;
+        addr << "192.0.2." << 100 + i;
+        Lease4Ptr lease(new Lease4(IOAddress(addr.str()), hwaddr2,
+                                   sizeof(hwaddr2), clientid2,
+                                   sizeof(clientid2), 501, 502, 503, now,
+                                   subnet_->getID()));
+        ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+    }
+
+    boost::scoped_ptr<AllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE,
+                                                 100, false)));
+    Lease4Ptr lease = engine->allocateLease4(subnet_, clientid_, hwaddr_,
+                                             IOAddress("0.0.0.0"),
+                                             false, false, "",
+                                             false, CalloutHandlePtr(),
+                                             old_lease_);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("192.0.2.103", lease->addr_.toText());
+
+    // The next client should get the address following the allocated one,
+    // rather than the address following the whole batch.
+    hwaddr2[5] = 0x10;
+    clientid2[7] = 0x10;
+    HWAddrPtr hwaddr(new HWAddr(hwaddr2, sizeof(hwaddr2), HTYPE_ETHER));
+    ClientIdPtr clientid(new ClientId(clientid2, sizeof(clientid2)));
+    lease = engine->allocateLease4(subnet_, clientid, hwaddr,
+                                   IOAddress("0.0.0.0"), false, false, "",
+                                   false, CalloutHandlePtr(), old_lease_);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("192.0.2.104", lease->addr_.toText());
+}
+
 // This test checks if an expired lease can be reused in DISCOVER (fake allocation)
 TEST_F(AllocEngine4Test, discoverReuseExpiredLease4) {
     boost::scoped_ptr<AllocEngine> engine;
@@ -0,0 +1,440 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <asiolink/io_address.h>
+#include <dhcpsrv/caching_lease_mgr.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <dhcpsrv/memfile_lease_mgr.h>
+#include <dhcpsrv/tests/generic_lease_mgr_unittest.h>
+#include <dhcpsrv/tests/lease_file_io.h>
+#include <dhcpsrv/tests/test_utils.h>
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace bundy;
+using namespace bundy::asiolink;
+using namespace bundy::dhcp;
+using namespace bundy::dhcp::test;
+
+namespace {
+
+/// @brief Test fixture class for the @c CachingLeaseMgr.
+///
+/// The tests use the Memfile backend behind the cache.
+class CachingLeaseMgrTest : public GenericLeaseMgrTest {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Removes the lease files left by the previous tests.
+    CachingLeaseMgrTest() :
+        io4_(getLeaseFilePath("leasefile4_cache.csv")),
+        io6_(getLeaseFilePath("leasefile6_cache.csv")),
+        cache_(NULL) {
+        io4_.removeFile();
+        io6_.removeFile();
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Destroys the lease manager and removes the lease files.
+    virtual ~CachingLeaseMgrTest() {
+        LeaseMgrFactory::destroy();
+        io4_.removeFile();
+        io6_.removeFile();
+    }
+
+    /// @brief Reopens the connection to the backend.
+    ///
+    /// @param u Universe (V4 or V6)
+    virtual void reopen(Universe u) {
+        LeaseMgrFactory::destroy();
+        startBackend(u);
+    }
+
+    /// @brief Return path to the lease file used by unit tests.
+    ///
+    /// @param filename Name of the lease file appended to the path to the
+    /// directory where test data is held.
+    ///
+    /// @return Full path to the lease file.
+    static std::string getLeaseFilePath(const std::string& filename) {
+        std::ostringstream s;
+        s << TEST_DATA_BUILDDIR << "/" << filename;
+        return (s.str());
+    }
+
+    /// @brief Creates the Memfile backend with the lease cache.
+    ///
+    /// @param u Universe (v4 or V6).
+    /// @param extra Additional database access parameters.
+    void startBackend(Universe u, const std::string& extra = "") {
+        std::ostringstream s;
+        s << "type=memfile cache=true "
+          << (u == V4 ? "universe=4 " : "universe=6 ") << "name="
+          << getLeaseFilePath(u == V4 ? "leasefile4_cache.csv" :
+                              "leasefile6_cache.csv");
+        if (!extra.empty()) {
+            s << " " << extra;
+        }
+        try {
+            LeaseMgrFactory::create(s.str());
+        } catch (...) {
+            std::cerr << "*** ERROR: unable to create instance of the Memfile\n"
+                " lease database backend with the lease cache.\n";
+            throw;
+        }
+        lmptr_ = &(LeaseMgrFactory::instance());
+        cache_ = dynamic_cast<CachingLeaseMgr*>(lmptr_);
+        ASSERT_TRUE(cache_);
+    }
+
+    /// @brief Object providing access to v4 lease IO.
+    LeaseFileIO io4_;
+
+    /// @brief Object providing access to v6 lease IO.
+    LeaseFileIO io6_;
+
+    /// @brief Lease cache created by the factory.
+    CachingLeaseMgr* cache_;
+};
+
+// Checks that the factory puts the cache in front of the backend only
+// when it is requested.
+TEST_F(CachingLeaseMgrTest, factory) {
+    startBackend(V4);
+    EXPECT_EQ("memfile", cache_->getType());
+    EXPECT_TRUE(dynamic_cast<Memfile_LeaseMgr*>(&cache_->getBackend()));
+
+    LeaseMgrFactory::create("type=memfile universe=4 persist=false "
+                            "cache=false");
+    EXPECT_FALSE(dynamic_cast<CachingLeaseMgr*>(&LeaseMgrFactory::instance()));
+
+    LeaseMgrFactory::create("type=memfile universe=4 persist=false");
+    EXPECT_FALSE(dynamic_cast<CachingLeaseMgr*>(&LeaseMgrFactory::instance()));
+}
+
+// Checks that the leases which have been written through the cache are
+// read from the cache.
+TEST_F(CachingLeaseMgrTest, readFromCache4) {
+    startBackend(V4);
+    Lease4Ptr lease = initializeLease4(straddress4_[1]);
+    // Make sure that the lease hasn't expired.
+    lease->cltt_ = time(NULL);
+    // The Memfile backend stores the pointer passed to addLease, so the
+    // cache is given a copy.
+    ASSERT_TRUE(lmptr_->addLease(Lease4Ptr(new Lease4(*lease))));
+    EXPECT_EQ(1, cache_->getCacheSize4());
+
+    // Remove the lease from the backend, bypassing the cache. The lookups
+    // should still return the cached lease.
+    ASSERT_TRUE(cache_->getBackend().deleteLease(lease->addr_));
+
+    Lease4Ptr cached = lmptr_->getLease4(lease->addr_);
+    ASSERT_TRUE(cached);
+    detailCompareLease(lease, cached);
+
+    cached = lmptr_->getLease4(HWAddr(lease->hwaddr_, HTYPE_ETHER),
+                               lease->subnet_id_);
+    ASSERT_TRUE(cached);
+    detailCompareLease(lease, cached);
+
+    cached = lmptr_->getLease4(*lease->client_id_, lease->subnet_id_);
+    ASSERT_TRUE(cached);
+    detailCompareLease(lease, cached);
+
+    cached = lmptr_->getLease4(*lease->client_id_,
+                               HWAddr(lease->hwaddr_, HTYPE_ETHER),
+                               lease->subnet_id_);
+    ASSERT_TRUE(cached);
+    detailCompareLease(lease, cached);
+
+    LeaseMgr::AddressCollection addrs;
+    addrs.push_back(lease->addr_);
+    EXPECT_EQ(1, lmptr_->getLeases4(addrs).size());
+
+    // The caller gets a copy of the cached lease, so modifying it doesn't
+    // affect the cache.
+    cached->valid_lft_ = 1234;
+    cached = lmptr_->getLease4(lease->addr_);
+    ASSERT_TRUE(cached);
+    EXPECT_EQ(lease->valid_lft_, cached->valid_lft_);
+
+    // Once the cache is cleared, the backend is queried and it no longer
+    // holds the lease.
+    cache_->clearCache();
+    EXPECT_FALSE(lmptr_->getLease4(lease->addr_));
+}
+
+// Checks that the leases which are read from the backend are cached.
+TEST_F(CachingLeaseMgrTest, populateCache4) {
+    startBackend(V4);
+    Lease4Ptr lease = initializeLease4(straddress4_[1]);
+    lease->cltt_ = time(NULL);
+    ASSERT_TRUE(cache_->getBackend().addLease(Lease4Ptr(new Lease4(*lease))));
+    EXPECT_EQ(0, cache_->getCacheSize4());
+
+    Lease4Ptr from_backend = lmptr_->getLease4(*lease->client_id_,
+                                               lease->subnet_id_);
+    ASSERT_TRUE(from_backend);
+    EXPECT_EQ(1, cache_->getCacheSize4());
+
+    ASSERT_TRUE(cache_->getBackend().deleteLease(lease->addr_));
+    Lease4Ptr cached = lmptr_->getLease4(lease->addr_);
+    ASSERT_TRUE(cached);
+    detailCompareLease(lease, cached);
+}
+
+// Checks that the expired leases are not returned from the cache.
+TEST_F(CachingLeaseMgrTest, expiredLease4) {
+    startBackend(V4);
+    Lease4Ptr lease = initializeLease4(straddress4_[1]);
+    lease->cltt_ = time(NULL) - lease->valid_lft_ - 10;
+    ASSERT_TRUE(lease->expired());
+    ASSERT_TRUE(lmptr_->addLease(Lease4Ptr(new Lease4(*lease))));
+
+    // Another server reuses the expired lease.
+    Lease4Ptr reused(new Lease4(*lease));
+    reused->cltt_ = time(NULL);
+    reused->hostname_ = "reused.example.com.";
+    cache_->getBackend().updateLease4(reused);
+
+    Lease4Ptr from_backend = lmptr_->getLease4(lease->addr_);
+    ASSERT_TRUE(from_backend);
+    EXPECT_EQ(reused->hostname_, from_backend->hostname_);
+    EXPECT_FALSE(from_backend->expired());
+}
+
+// Checks that the cache is updated or invalidated when the leases are
+// written.
+TEST_F(CachingLeaseMgrTest, writeThrough4) {
+    startBackend(V4);
+    Lease4Ptr lease = initializeLease4(straddress4_[1]);
+    lease->cltt_ = time(NULL);
+    ASSERT_TRUE(lmptr_->addLease(Lease4Ptr(new Lease4(*lease))));
+
+    // Update the lease through the cache: both the cache and the backend
+    // should hold the new lease.
+    lease->hostname_ = "updated.example.com.";
+    ASSERT_NO_THROW(lmptr_->updateLease4(Lease4Ptr(new Lease4(*lease))));
+    Lease4Ptr cached = lmptr_->getLease4(lease->addr_);
+    ASSERT_TRUE(cached);
+    detailCompareLease(lease, cached);
+    Lease4Ptr from_backend = cache_->getBackend().getLease4(lease->addr_);
+    ASSERT_TRUE(from_backend);
+    detailCompareLease(lease, from_backend);
+
+    // Deleting the lease removes it from the cache.
+    EXPECT_TRUE(lmptr_->deleteLease(lease->addr_));
+    EXPECT_EQ(0, cache_->getCacheSize4());
+    EXPECT_FALSE(lmptr_->getLease4(lease->addr_));
+
+    // Updating a lease which the backend doesn't hold fails and the lease
+    // is not cached.
+    EXPECT_THROW(lmptr_->updateLease4(Lease4Ptr(new Lease4(*lease))),
+                 bundy::dhcp::NoSuchLease);
+    EXPECT_EQ(0, cache_->getCacheSize4());
+
+    // Add the lease to the backend and make a stale copy of it in the
+    // cache, with a different hostname.
+    ASSERT_TRUE(cache_->getBackend().addLease(Lease4Ptr(new Lease4(*lease))));
+    ASSERT_TRUE(lmptr_->getLease4(lease->addr_));
+    Lease4Ptr other(new Lease4(*lease));
+    other->hostname_ = "other.example.com.";
+    cache_->getBackend().updateLease4(other);
+
+    // Adding the lease fails, as the backend holds it, and the stale copy
+    // is removed from the cache.
+    EXPECT_FALSE(lmptr_->addLease(Lease4Ptr(new Lease4(*lease))));
+    EXPECT_EQ(0, cache_->getCacheSize4());
+    cached = lmptr_->getLease4(lease->addr_);
+    ASSERT_TRUE(cached);
+    EXPECT_EQ(other->hostname_, cached->hostname_);
+}
+
+// Checks that the leases for a group of addresses are read from the cache
+// and the backend.
+TEST_F(CachingLeaseMgrTest, getLeases4) {
+    startBackend(V4);
+    vector<Lease4Ptr> leases = createLeases4();
+    // Write the first two leases through the cache, the next two directly
+    // to the backend.
+    LeaseMgr::AddressCollection addrs;
+    for (int i = 0; i < 4; ++i) {
+        leases[i]->cltt_ = time(NULL);
+        Lease4Ptr copy(new Lease4(*leases[i]));
+        if (i < 2) {
+            ASSERT_TRUE(lmptr_->addLease(copy));
+        } else {
+            ASSERT_TRUE(cache_->getBackend().addLease(copy));
+        }
+        addrs.push_back(leases[i]->addr_);
+    }
+    EXPECT_EQ(2, cache_->getCacheSize4());
+
+    Lease4Collection returned = lmptr_->getLeases4(addrs);
+    EXPECT_EQ(4, returned.size());
+    EXPECT_EQ(4, cache_->getCacheSize4());
+}
+
+// Checks that the DHCPv6 leases are read from the cache and written
+// through it.
+TEST_F(CachingLeaseMgrTest, readFromCache6) {
+    startBackend(V6);
+    Lease6Ptr lease = initializeLease6(straddress6_[1]);
+    lease->cltt_ = time(NULL);
+    ASSERT_TRUE(lmptr_->addLease(Lease6Ptr(new Lease6(*lease))));
+    EXPECT_EQ(1, cache_->getCacheSize6());
+
+    ASSERT_TRUE(cache_->getBackend().deleteLease(lease->addr_));
+    Lease6Ptr cached = lmptr_->getLease6(lease->type_, lease->addr_);
+    ASSERT_TRUE(cached);
+    detailCompareLease(lease, cached);
+
+    // The lease of a different type is not returned from the cache.
+    const Lease::Type other_type = (lease->type_ == Lease::TYPE_NA ?
+                                    Lease::TYPE_TA : Lease::TYPE_NA);
+    EXPECT_FALSE(lmptr_->getLease6(other_type, lease->addr_));
+    EXPECT_EQ(0, cache_->getCacheSize6());
+
+    // Write the lease again and update it.
+    ASSERT_TRUE(lmptr_->addLease(Lease6Ptr(new Lease6(*lease))));
+    lease->hostname_ = "updated.example.com.";
+    ASSERT_NO_THROW(lmptr_->updateLease6(Lease6Ptr(new Lease6(*lease))));
+    ASSERT_TRUE(cache_->getBackend().deleteLease(lease->addr_));
+    cached = lmptr_->getLease6(lease->type_, lease->addr_);
+    ASSERT_TRUE(cached);
+    detailCompareLease(lease, cached);
+
+    // The backend no longer holds the lease, but the cached copy is
+    // removed anyway.
+    EXPECT_FALSE(lmptr_->deleteLease(lease->addr_));
+    EXPECT_EQ(0, cache_->getCacheSize6());
+}
+
+// Checks that the capacity of the cache is configurable.
+TEST_F(CachingLeaseMgrTest, cacheSize) {
+    startBackend(V4);
+    EXPECT_EQ(CachingLeaseMgr::DEFAULT_CACHE_SIZE,
+              cache_->getCacheCapacity());
+
+    startBackend(V4, "cache-size=0");
+    EXPECT_EQ(0, cache_->getCacheCapacity());
+
+    startBackend(V4, "cache-size=100");
+    EXPECT_EQ(100, cache_->getCacheCapacity());
+
+    EXPECT_THROW(LeaseMgrFactory::create("type=memfile universe=4 "
+                                         "persist=false cache=true "
+                                         "cache-size=-1"), BadValue);
+    EXPECT_THROW(LeaseMgrFactory::create("type=memfile universe=4 "
+                                         "persist=false cache=true "
+                                         "cache-size=many"), BadValue);
+}
+
+// Checks that the least recently used leases are removed from the cache
+// when it is full.
+TEST_F(CachingLeaseMgrTest, evictLeastRecentlyUsed4) {
+    startBackend(V4, "cache-size=2");
+    Lease4Ptr leaseA = initializeLease4(straddress4_[4]);
+    Lease4Ptr leaseB = initializeLease4(straddress4_[5]);
+    Lease4Ptr leaseC = initializeLease4(straddress4_[6]);
+    leaseA->cltt_ = leaseB->cltt_ = leaseC->cltt_ = time(NULL);
+
+    ASSERT_TRUE(lmptr_->addLease(Lease4Ptr(new Lease4(*leaseA))));
+    ASSERT_TRUE(lmptr_->addLease(Lease4Ptr(new Lease4(*leaseB))));
+    EXPECT_EQ(2, cache_->getCacheSize4());
+
+    // Use the lease A, so as the lease B is the least recently used one.
+    ASSERT_TRUE(lmptr_->getLease4(leaseA->addr_));
+
+    // Adding the lease C should remove the lease B from the cache.
+    ASSERT_TRUE(lmptr_->addLease(Lease4Ptr(new Lease4(*leaseC))));
+    EXPECT_EQ(2, cache_->getCacheSize4());
+
+    // Remove the leases from the backend, bypassing the cache, to check
+    // which of them are still cached.
+    ASSERT_TRUE(cache_->getBackend().deleteLease(leaseA->addr_));
+    ASSERT_TRUE(cache_->getBackend().deleteLease(leaseB->addr_));
+    ASSERT_TRUE(cache_->getBackend().deleteLease(leaseC->addr_));
+    EXPECT_TRUE(lmptr_->getLease4(leaseA->addr_));
+    EXPECT_FALSE(lmptr_->getLease4(leaseB->addr_));
+    EXPECT_TRUE(lmptr_->getLease4(leaseC->addr_));
+}
+
+// Checks that the cache of IPv6 leases is limited as well.
+TEST_F(CachingLeaseMgrTest, evictLeastRecentlyUsed6) {
+    startBackend(V6, "cache-size=1");
+    Lease6Ptr leaseA = initializeLease6(straddress6_[1]);
+    Lease6Ptr leaseB = initializeLease6(straddress6_[2]);
+    leaseA->cltt_ = leaseB->cltt_ = time(NULL);
+
+    ASSERT_TRUE(lmptr_->addLease(Lease6Ptr(new Lease6(*leaseA))));
+    ASSERT_TRUE(lmptr_->addLease(Lease6Ptr(new Lease6(*leaseB))));
+    EXPECT_EQ(1, cache_->getCacheSize6());
+
+    ASSERT_TRUE(cache_->getBackend().deleteLease(leaseA->addr_));
+    ASSERT_TRUE(cache_->getBackend().deleteLease(leaseB->addr_));
+    EXPECT_FALSE(lmptr_->getLease6(leaseA->type_, leaseA->addr_));
+    EXPECT_TRUE(lmptr_->getLease6(leaseB->type_, leaseB->addr_));
+}
+
+// The following tests run the generic lease manager tests through the cache.
+
+TEST_F(CachingLeaseMgrTest, basicLease4) {
+    startBackend(V4);
+    testBasicLease4();
+}
+
+TEST_F(CachingLeaseMgrTest, getLease4ClientIdHWAddrSubnetId) {
+    startBackend(V4);
+    testGetLease4ClientIdHWAddrSubnetId();
+}
+
+TEST_F(CachingLeaseMgrTest, getLease4ClientIdSubnetId) {
+    startBackend(V4);
+    testGetLease4ClientIdSubnetId();
+}
+
+TEST_F(CachingLeaseMgrTest, basicLease6) {
+    startBackend(V6);
+    testBasicLease6();
+}
+
+TEST_F(CachingLeaseMgrTest, getLease6DuidIaidSubnetId) {
+    startBackend(V6);
+    testGetLease6DuidIaidSubnetId();
+}
+
+TEST_F(CachingLeaseMgrTest, getLeases4Addresses) {
+    startBackend(V4);
+    testGetLeases4Addresses();
+}
+
+TEST_F(CachingLeaseMgrTest, addUpdateLeases4) {
+    startBackend(V4);
+    testAddUpdateLeases4();
+}
+
+TEST_F(CachingLeaseMgrTest, addUpdateLeases6) {
+    startBackend(V6);
+    testAddUpdateLeases6();
+}
+
+}; // end of anonymous namespace
@@ -87,10 +87,13 @@ public:
             }
 
             // Add the keyword and value - make sure that they are quoted.
-            // The only parameter which is not quoted is persist as it
-            // is a boolean value.
+            // The parameters which are not quoted are persist and cache,
+            // as they are boolean values, and the integer parameters.
             result += quote + keyval[i] + quote + colon + space;
-            if (std::string(keyval[i]) != "persist") {
+            const std::string keyword(keyval[i]);
+            if ((keyword != "persist") && (keyword != "cache") &&
+                (keyword != "cache-size") &&
+                (keyword != "compact-threshold")) {
                 result += quote + keyval[i + 1] + quote;
             } else {
                 result += keyval[i + 1];
@@ -281,6 +284,26 @@ TEST_F(DbAccessParserTest, persistV6Memfile) {
                       config, Option::V6);
 }
 
+// Check that the parser accepts the binary lease file parameters, with
+// integer values.
+TEST_F(DbAccessParserTest, binaryMemfile) {
+    const char* config[] = {"type", "memfile",
+                            "format", "binary",
+                            "compact-threshold", "10000",
+                            "name", "/opt/bundy/var/kea-leases4.log",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser("lease-database", ParserContext(Option::V4));
+    EXPECT_NO_THROW(parser.build(json_elements));
+
+    checkAccessString("Binary memfile", parser.getDbAccessParameters(),
+                      config);
+}
+
 // Check that the parser works with a valid MySQL configuration
 TEST_F(DbAccessParserTest, validTypeMysql) {
     const char* config[] = {"type",     "mysql",
@@ -299,6 +322,27 @@ TEST_F(DbAccessParserTest, validTypeMysql) {
     checkAccessString("Valid mysql", parser.getDbAccessParameters(), config);
 }
 
+// Check that the parser accepts the lease cache parameters, with a boolean
+// and an integer value.
+TEST_F(DbAccessParserTest, cacheMysql) {
+    const char* config[] = {"type",     "mysql",
+                            "host",     "erewhon",
+                            "user",     "kea",
+                            "password", "keapassword",
+                            "name",     "keatest",
+                            "cache",    "true",
+                            "cache-size", "1000",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser("lease-database", ParserContext(Option::V4));
+    EXPECT_NO_THROW(parser.build(json_elements));
+    checkAccessString("Cached mysql", parser.getDbAccessParameters(), config);
+}
+
 // A missing 'type' keyword should cause an exception to be thrown.
 TEST_F(DbAccessParserTest, missingTypeKeyword) {
     const char* config[] = {"host",     "erewhon",
@@ -1506,6 +1506,208 @@ GenericLeaseMgrTest::testRecreateLease6() {
     detailCompareLease(lease, l_returned);
 }
 
+void
+GenericLeaseMgrTest::testGetLeases4Addresses() {
+    // Add every second lease to the database.
+    vector<Lease4Ptr> leases = createLeases4();
+    for (int i = 0; i < leases.size(); i += 2) {
+        ASSERT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // No addresses, no leases.
+    LeaseMgr::AddressCollection addrs;
+    EXPECT_TRUE(lmptr_->getLeases4(addrs).empty());
+
+    // Surround the addresses used by the test with addresses for which
+    // there are no leases, so as the test addresses span two batches and
+    // the last batch is incomplete.
+    const uint32_t unused = static_cast<uint32_t>(IOAddress("192.0.3.0"));
+    for (uint32_t i = 0; i < 12; ++i) {
+        addrs.push_back(IOAddress(unused + i));
+    }
+    addrs.insert(addrs.end(), ioaddress4_.begin(), ioaddress4_.end());
+    for (uint32_t i = 12; i < 33; ++i) {
+        addrs.push_back(IOAddress(unused + i));
+    }
+
+    Lease4Collection returned = lmptr_->getLeases4(addrs);
+    ASSERT_EQ(leases.size() / 2, returned.size());
+    for (int i = 0; i < leases.size(); i += 2) {
+        bool found = false;
+        for (Lease4Collection::const_iterator lease = returned.begin();
+             lease != returned.end(); ++lease) {
+            if ((*lease)->addr_ == leases[i]->addr_) {
+                detailCompareLease(leases[i], *lease);
+                found = true;
+            }
+        }
+        EXPECT_TRUE(found) << "lease " << leases[i]->addr_ << " not found";
+    }
+
+    // Addresses without leases only.
+    addrs.assign(1, ioaddress4_[1]);
+    EXPECT_TRUE(lmptr_->getLeases4(addrs).empty());
+}
+
+void
+GenericLeaseMgrTest::testGetLeases6Addresses() {
+    // Add the leases of the NA type to the database.
+    vector<Lease6Ptr> leases = createLeases6();
+    vector<Lease6Ptr> expected;
+    for (int i = 0; i < leases.size(); ++i) {
+        if (leasetype6_[i] == Lease::TYPE_NA) {
+            ASSERT_TRUE(lmptr_->addLease(leases[i]));
+            expected.push_back(leases[i]);
+        }
+    }
+    ASSERT_FALSE(expected.empty());
+
+    // No addresses, no leases.
+    LeaseMgr::AddressCollection addrs;
+    EXPECT_TRUE(lmptr_->getLeases6(Lease::TYPE_NA, addrs).empty());
+
+    // Surround the addresses used by the test with addresses for which
+    // there are no leases (see testGetLeases4Addresses).
+    for (int i = 0; i < 12; ++i) {
+        ostringstream addr;
+        addr << "2001:db8:1::" << std::hex << i;
+        addrs.push_back(IOAddress(addr.str()));
+    }
+    addrs.insert(addrs.end(), ioaddress6_.begin(), ioaddress6_.end());
+    for (int i = 12; i < 33; ++i) {
+        ostringstream addr;
+        addr << "2001:db8:1::" << std::hex << i;
+        addrs.push_back(IOAddress(addr.str()));
+    }
+
+    Lease6Collection returned = lmptr_->getLeases6(Lease::TYPE_NA, addrs);
+    ASSERT_EQ(expected.size(), returned.size());
+    for (int i = 0; i < expected.size(); ++i) {
+        bool found = false;
+        for (Lease6Collection::const_iterator lease = returned.begin();
+             lease != returned.end(); ++lease) {
+            if ((*lease)->addr_ == expected[i]->addr_) {
+                detailCompareLease(expected[i], *lease);
+                found = true;
+            }
+        }
+        EXPECT_TRUE(found) << "lease " << expected[i]->addr_ << " not found";
+    }
+}
+
+void
+GenericLeaseMgrTest::testAddUpdateLeases4() {
+    vector<Lease4Ptr> leases = createLeases4();
+    ASSERT_LE(7, leases.size());    // Expect to access leases 0 through 6
+
+    // An empty group is trivially added.
+    EXPECT_TRUE(lmptr_->addLeases(Lease4Collection()));
+
+    // Add the first four leases.
+    Lease4Collection group(leases.begin(), leases.begin() + 4);
+    EXPECT_TRUE(lmptr_->addLeases(group));
+    for (int i = 0; i < 4; ++i) {
+        Lease4Ptr l_returned = lmptr_->getLease4(ioaddress4_[i]);
+        ASSERT_TRUE(l_returned);
+        detailCompareLease(leases[i], l_returned);
+    }
+
+    // A group including an existing lease is not added at all.
+    group.clear();
+    group.push_back(leases[4]);
+    group.push_back(leases[5]);
+    group.push_back(leases[0]);
+    EXPECT_FALSE(lmptr_->addLeases(group));
+    EXPECT_FALSE(lmptr_->getLease4(ioaddress4_[4]));
+    EXPECT_FALSE(lmptr_->getLease4(ioaddress4_[5]));
+    ASSERT_TRUE(lmptr_->getLease4(ioaddress4_[0]));
+
+    // Update the added leases.  The copies are modified, so as the leases
+    // held by the backends which store pointers are not altered.
+    Lease4Collection updated;
+    for (int i = 0; i < 4; ++i) {
+        Lease4Ptr lease(new Lease4(*leases[i]));
+        ++lease->subnet_id_;
+        lease->cltt_ += 6;
+        lease->hostname_ = "modified.hostname.";
+        updated.push_back(lease);
+    }
+    lmptr_->updateLeases4(updated);
+    for (int i = 0; i < 4; ++i) {
+        Lease4Ptr l_returned = lmptr_->getLease4(ioaddress4_[i]);
+        ASSERT_TRUE(l_returned);
+        detailCompareLease(updated[i], l_returned);
+    }
+
+    // A group including a lease not in the database is not updated at all.
+    group.clear();
+    Lease4Ptr lease(new Lease4(*updated[1]));
+    lease->valid_lft_ *= 2;
+    group.push_back(lease);
+    group.push_back(leases[6]);
+    EXPECT_THROW(lmptr_->updateLeases4(group), bundy::dhcp::NoSuchLease);
+    Lease4Ptr l_returned = lmptr_->getLease4(ioaddress4_[1]);
+    ASSERT_TRUE(l_returned);
+    detailCompareLease(updated[1], l_returned);
+}
+
+void
+GenericLeaseMgrTest::testAddUpdateLeases6() {
+    vector<Lease6Ptr> leases = createLeases6();
+    ASSERT_LE(7, leases.size());    // Expect to access leases 0 through 6
+
+    // An empty group is trivially added.
+    EXPECT_TRUE(lmptr_->addLeases(Lease6Collection()));
+
+    // Add the first four leases.
+    Lease6Collection group(leases.begin(), leases.begin() + 4);
+    EXPECT_TRUE(lmptr_->addLeases(group));
+    for (int i = 0; i < 4; ++i) {
+        Lease6Ptr l_returned = lmptr_->getLease6(leasetype6_[i],
+                                                 ioaddress6_[i]);
+        ASSERT_TRUE(l_returned);
+        detailCompareLease(leases[i], l_returned);
+    }
+
+    // A group including an existing lease is not added at all.
+    group.clear();
+    group.push_back(leases[4]);
+    group.push_back(leases[5]);
+    group.push_back(leases[0]);
+    EXPECT_FALSE(lmptr_->addLeases(group));
+    EXPECT_FALSE(lmptr_->getLease6(leasetype6_[4], ioaddress6_[4]));
+    EXPECT_FALSE(lmptr_->getLease6(leasetype6_[5], ioaddress6_[5]));
+    ASSERT_TRUE(lmptr_->getLease6(leasetype6_[0], ioaddress6_[0]));
+
+    // Update the added leases.  The copies are modified, so as the leases
+    // held by the backends which store pointers are not altered.
+    Lease6Collection updated;
+    for (int i = 0; i < 4; ++i) {
+        Lease6Ptr lease(new Lease6(*leases[i]));
+        ++lease->iaid_;
+        lease->cltt_ += 6;
+        lease->hostname_ = "modified.hostname.v6.";
+        updated.push_back(lease);
+    }
+    lmptr_->updateLeases6(updated);
+    for (int i = 0; i < 4; ++i) {
+        Lease6Ptr l_returned = lmptr_->getLease6(leasetype6_[i],
+                                                 ioaddress6_[i]);
+        ASSERT_TRUE(l_returned);
+        detailCompareLease(updated[i], l_returned);
+    }
+
+    // A group including a lease not in the database is not updated at all.
+    group.clear();
+    Lease6Ptr lease(new Lease6(*updated[1]));
+    lease->valid_lft_ *= 2;
+    group.push_back(lease);
+    group.push_back(leases[6]);
+    EXPECT_THROW(lmptr_->updateLeases6(group), bundy::dhcp::NoSuchLease);
+    Lease6Ptr l_returned = lmptr_->getLease6(leasetype6_[1], ioaddress6_[1]);
+    ASSERT_TRUE(l_returned);
+    detailCompareLease(updated[1], l_returned);
+}
 
 }; // namespace test
 }; // namespace dhcp
@@ -245,6 +245,29 @@ public:
     /// persistent storage has been updated as expected.
     void testRecreateLease6();
 
+    /// @brief Check that IPv4 leases can be retrieved for a group of
+    /// addresses.
+    ///
+    /// The group holds enough addresses to exceed the size of a single
+    /// query in backends which split the group into several queries.
+    void testGetLeases4Addresses();
+
+    /// @brief Check that IPv6 leases can be retrieved for a group of
+    /// addresses.
+    void testGetLeases6Addresses();
+
+    /// @brief Check that groups of IPv4 leases are added and updated as
+    /// a whole.
+    ///
+    /// Verifies that none of the leases of a group is added if any of them
+    /// exists, and that none of them is updated if any of them doesn't
+    /// exist.
+    void testAddUpdateLeases4();
+
+    /// @brief Check that groups of IPv6 leases are added and updated as
+    /// a whole.
+    void testAddUpdateLeases6();
+
     /// @brief String forms of IPv4 addresses
     std::vector<std::string>  straddress4_;
 
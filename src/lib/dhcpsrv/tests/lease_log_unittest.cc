@@ -0,0 +1,372 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+#include <asiolink/io_address.h>
+#include <dhcp/duid.h>
+#include <dhcpsrv/lease.h>
+#include <dhcpsrv/lease_log.h>
+#include <dhcpsrv/tests/lease_file_io.h>
+#include <dhcpsrv/tests/test_utils.h>
+#include <util/threads/thread.h>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace bundy;
+using namespace bundy::asiolink;
+using namespace bundy::dhcp;
+using namespace bundy::dhcp::test;
+using namespace bundy::util::thread;
+
+namespace {
+
+// HWADDR values used by unit tests.
+const uint8_t HWADDR0[] = { 0, 1, 2, 3, 4, 5 };
+const uint8_t HWADDR1[] = { 0xd, 0xe, 0xa, 0xd, 0xb, 0xe, 0xe, 0xf };
+
+const uint8_t CLIENTID0[] = { 1, 2, 3, 4 };
+
+const uint8_t DUID0[] = { 0, 1, 2, 3, 4, 5, 6, 0xa, 0xb, 0xc, 0xd };
+
+/// @brief Test fixture class for @c LeaseLog.
+class LeaseLogTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Initializes IO for lease file used by unit tests and removes the
+    /// file left over by the previous test.
+    LeaseLogTest()
+        : filename_(absolutePath("leases.log")), io_(filename_),
+          tmp_io_(filename_ + ".compact") {
+        io_.removeFile();
+        tmp_io_.removeFile();
+    }
+
+    /// @brief Prepends the absolute path to the file specified
+    /// as an argument.
+    ///
+    /// @param filename Name of the file.
+    /// @return Absolute path to the test file.
+    static std::string absolutePath(const std::string& filename) {
+        std::ostringstream s;
+        s << DHCP_DATA_DIR << "/" << filename;
+        return (s.str());
+    }
+
+    /// @brief Creates a DHCPv4 lease.
+    ///
+    /// @param address Leased address.
+    /// @param valid_lft Valid lifetime.
+    Lease4Ptr createLease4(const std::string& address,
+                           const uint32_t valid_lft) const {
+        return (Lease4Ptr(new Lease4(IOAddress(address),
+                                     HWADDR0, sizeof(HWADDR0),
+                                     CLIENTID0, sizeof(CLIENTID0),
+                                     valid_lft, 0, 0, 1234567890, 8,
+                                     true, false, "host.example.com")));
+    }
+
+    /// @brief Creates a DHCPv6 lease.
+    ///
+    /// @param address Leased address.
+    /// @param valid_lft Valid lifetime.
+    Lease6Ptr createLease6(const std::string& address,
+                           const uint32_t valid_lft) const {
+        Lease6Ptr lease(new Lease6(Lease::TYPE_PD, IOAddress(address),
+                                   DuidPtr(new DUID(DUID0, sizeof(DUID0))),
+                                   7, valid_lft / 2, valid_lft, 0, 0, 8, 64));
+        lease->cltt_ = 1234567890;
+        lease->fqdn_fwd_ = false;
+        lease->fqdn_rev_ = true;
+        lease->hostname_ = "host.example.com";
+        return (lease);
+    }
+
+    /// @brief Reads all DHCPv4 leases from the lease file.
+    ///
+    /// @param [out] leases Leases read from the file.
+    ///
+    /// @return false if an error occurred during the read.
+    bool readAll(Lease4Collection& leases) {
+        LeaseLog log(filename_);
+        log.open();
+        Lease4Ptr lease;
+        do {
+            if (!log.next(lease)) {
+                return (false);
+            }
+            if (lease) {
+                leases.push_back(lease);
+            }
+        } while (lease);
+        return (true);
+    }
+
+    /// @brief Appends DHCPv4 leases to the log.
+    ///
+    /// This function is run by multiple threads concurrently.
+    ///
+    /// @param log Lease log.
+    /// @param first Index of the first lease.
+    /// @param count Number of leases to append.
+    void appendMany(LeaseLog* log, const int first, const int count) const {
+        for (int i = first; i < first + count; ++i) {
+            std::ostringstream s;
+            s << "10.0." << i / 256 << "." << i % 256;
+            log->append(*createLease4(s.str(), 100));
+        }
+    }
+
+    /// @brief Name of the test lease file.
+    std::string filename_;
+
+    /// @brief Object providing access to lease file IO.
+    LeaseFileIO io_;
+
+    /// @brief Object removing the temporary file created by compaction.
+    LeaseFileIO tmp_io_;
+};
+
+// This test checks that the DHCPv4 leases can be written to the lease file
+// and read back.
+TEST_F(LeaseLogTest, appendAndRead4) {
+    Lease4Ptr lease0 = createLease4("192.0.2.1", 200);
+    Lease4Ptr lease1 = createLease4("192.0.2.2", 100);
+    lease1->hwaddr_.assign(HWADDR1, HWADDR1 + sizeof(HWADDR1));
+    lease1->client_id_.reset();
+    lease1->hostname_.clear();
+    lease1->fqdn_fwd_ = false;
+    {
+        LeaseLog log(filename_);
+        ASSERT_NO_THROW(log.open());
+        ASSERT_NO_THROW(log.append(*lease0));
+        ASSERT_NO_THROW(log.append(*lease1));
+        EXPECT_EQ(2, log.getAppendCount());
+        // Without concurrent appends, each record is committed separately.
+        EXPECT_EQ(2, log.getSyncCount());
+    }
+
+    Lease4Collection leases;
+    ASSERT_TRUE(readAll(leases));
+    ASSERT_EQ(2, leases.size());
+    detailCompareLease(lease0, leases[0]);
+    detailCompareLease(lease1, leases[1]);
+    EXPECT_EQ(0, leases[0]->t1_);
+    EXPECT_EQ(0, leases[0]->t2_);
+
+    // Reopening the file should append to the existing records.
+    {
+        LeaseLog log(filename_);
+        ASSERT_NO_THROW(log.open());
+        ASSERT_NO_THROW(log.append(*lease0));
+    }
+    leases.clear();
+    ASSERT_TRUE(readAll(leases));
+    EXPECT_EQ(3, leases.size());
+}
+
+// This test checks that the DHCPv6 leases can be written to the lease file
+// and read back, and that DHCPv4 lease can't be read from the DHCPv6 record.
+TEST_F(LeaseLogTest, appendAndRead6) {
+    Lease6Ptr lease0 = createLease6("2001:db8:1::", 200);
+    Lease6Ptr lease1 = createLease6("2001:db8:2::1", 300);
+    lease1->type_ = Lease::TYPE_NA;
+    lease1->prefixlen_ = 128;
+    {
+        LeaseLog log(filename_);
+        ASSERT_NO_THROW(log.open());
+        ASSERT_NO_THROW(log.append(*lease0));
+        ASSERT_NO_THROW(log.append(*lease1));
+    }
+
+    LeaseLog log(filename_);
+    ASSERT_NO_THROW(log.open());
+    Lease6Ptr lease;
+    ASSERT_TRUE(log.next(lease));
+    ASSERT_TRUE(lease);
+    detailCompareLease(lease0, lease);
+    ASSERT_TRUE(log.next(lease));
+    ASSERT_TRUE(lease);
+    detailCompareLease(lease1, lease);
+    ASSERT_TRUE(log.next(lease));
+    EXPECT_FALSE(lease);
+
+    Lease4Collection leases;
+    EXPECT_FALSE(readAll(leases));
+}
+
+// This test checks that the incomplete record at the end of the file is
+// discarded and the subsequent records are appended after the last valid
+// record.
+TEST_F(LeaseLogTest, tornRecord) {
+    {
+        LeaseLog log(filename_);
+        ASSERT_NO_THROW(log.open());
+        ASSERT_NO_THROW(log.append(*createLease4("192.0.2.1", 100)));
+        ASSERT_NO_THROW(log.append(*createLease4("192.0.2.2", 100)));
+    }
+    // Simulate the interrupted write of the last record.
+    std::string contents = io_.readFile();
+    const size_t valid_len = contents.size();
+    io_.writeFile(contents.substr(0, valid_len - 5));
+
+    {
+        LeaseLog log(filename_);
+        ASSERT_NO_THROW(log.open());
+        Lease4Ptr lease;
+        ASSERT_TRUE(log.next(lease));
+        ASSERT_TRUE(lease);
+        EXPECT_EQ("192.0.2.1", lease->addr_.toText());
+        ASSERT_TRUE(log.next(lease));
+        EXPECT_FALSE(lease);
+        ASSERT_NO_THROW(log.append(*createLease4("192.0.2.3", 100)));
+    }
+
+    Lease4Collection leases;
+    ASSERT_TRUE(readAll(leases));
+    ASSERT_EQ(2, leases.size());
+    EXPECT_EQ("192.0.2.1", leases[0]->addr_.toText());
+    EXPECT_EQ("192.0.2.3", leases[1]->addr_.toText());
+    EXPECT_EQ(valid_len, io_.readFile().size());
+}
+
+// This test checks that the corrupted record followed by valid records is
+// reported as an error.
+TEST_F(LeaseLogTest, corruptedRecord) {
+    {
+        LeaseLog log(filename_);
+        ASSERT_NO_THROW(log.open());
+        ASSERT_NO_THROW(log.append(*createLease4("192.0.2.1", 100)));
+        ASSERT_NO_THROW(log.append(*createLease4("192.0.2.2", 100)));
+    }
+    // Damage the last byte of the address in the first record.
+    std::string contents = io_.readFile();
+    contents[12 + 4 + 4] ^= 0xff;
+    io_.writeFile(contents);
+
+    LeaseLog log(filename_);
+    ASSERT_NO_THROW(log.open());
+    Lease4Ptr lease;
+    EXPECT_FALSE(log.next(lease));
+    EXPECT_FALSE(lease);
+    EXPECT_FALSE(log.getReadMsg().empty());
+}
+
+// This test checks that the file which is not a lease log is rejected.
+TEST_F(LeaseLogTest, invalidFile) {
+    io_.writeFile("address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+                  "fqdn_fwd,fqdn_rev,hostname\n");
+    LeaseLog log(filename_);
+    EXPECT_THROW(log.open(), LeaseLogError);
+    EXPECT_THROW(log.append(*createLease4("192.0.2.1", 100)), LeaseLogError);
+}
+
+// This test checks that the records appended concurrently are committed in
+// groups.
+TEST_F(LeaseLogTest, groupCommit) {
+    // Use the commit window to make sure that the threads find the commit
+    // in progress.
+    LeaseLog log(filename_, 20000);
+    ASSERT_NO_THROW(log.open());
+
+    const int THREADS = 4;
+    const int LEASES_PER_THREAD = 10;
+    {
+        std::vector<boost::shared_ptr<Thread> > threads;
+        for (int i = 0; i < THREADS; ++i) {
+            threads.push_back(boost::shared_ptr<Thread>(new Thread(
+                boost::bind(&LeaseLogTest::appendMany, this, &log,
+                            i * LEASES_PER_THREAD, LEASES_PER_THREAD))));
+        }
+        for (int i = 0; i < THREADS; ++i) {
+            ASSERT_NO_THROW(threads[i]->wait());
+        }
+    }
+    EXPECT_EQ(THREADS * LEASES_PER_THREAD, log.getAppendCount());
+    EXPECT_LT(log.getSyncCount(), log.getAppendCount());
+    log.close();
+
+    Lease4Collection leases;
+    ASSERT_TRUE(readAll(leases));
+    EXPECT_EQ(THREADS * LEASES_PER_THREAD, leases.size());
+}
+
+// This test checks that the compaction replaces the lease file with the
+// file holding live leases and the records appended during compaction.
+TEST_F(LeaseLogTest, compact) {
+    LeaseLog log(filename_);
+    ASSERT_NO_THROW(log.open());
+    // Update the same two leases many times.
+    for (int i = 1; i <= 50; ++i) {
+        ASSERT_NO_THROW(log.append(*createLease4("192.0.2.1", i)));
+        ASSERT_NO_THROW(log.append(*createLease4("192.0.2.2", i)));
+    }
+    const size_t original_len = io_.readFile().size();
+
+    Lease4Collection live;
+    live.push_back(createLease4("192.0.2.1", 50));
+    live.push_back(createLease4("192.0.2.2", 50));
+    ASSERT_NO_THROW(log.compact(live));
+    // The record appended during or after the compaction must be kept.
+    ASSERT_NO_THROW(log.append(*createLease4("192.0.2.3", 10)));
+    EXPECT_TRUE(log.waitForCompaction());
+    EXPECT_FALSE(log.isCompacting());
+    EXPECT_TRUE(log.getCompactMsg().empty());
+
+    // The record appended after the compaction goes to the new file.
+    ASSERT_NO_THROW(log.append(*createLease4("192.0.2.4", 10)));
+    log.close();
+
+    EXPECT_LT(io_.readFile().size(), original_len);
+    EXPECT_FALSE(tmp_io_.exists());
+
+    Lease4Collection leases;
+    ASSERT_TRUE(readAll(leases));
+    ASSERT_EQ(4, leases.size());
+    detailCompareLease(live[0], leases[0]);
+    detailCompareLease(live[1], leases[1]);
+    EXPECT_EQ("192.0.2.3", leases[2]->addr_.toText());
+    EXPECT_EQ("192.0.2.4", leases[3]->addr_.toText());
+}
+
+// This test checks that the failed compaction leaves the lease file intact.
+TEST_F(LeaseLogTest, compactFailure) {
+    LeaseLog log(filename_);
+    ASSERT_NO_THROW(log.open());
+    ASSERT_NO_THROW(log.append(*createLease4("192.0.2.1", 100)));
+
+    // The compaction fails when the temporary file can't be created. A
+    // directory in place of the file does the trick.
+    ASSERT_EQ(0, mkdir(tmp_io_.testfile_.c_str(), S_IRWXU));
+    Lease4Collection live;
+    ASSERT_NO_THROW(log.compact(live));
+    EXPECT_FALSE(log.waitForCompaction());
+    EXPECT_FALSE(log.getCompactMsg().empty());
+    rmdir(tmp_io_.testfile_.c_str());
+
+    ASSERT_NO_THROW(log.append(*createLease4("192.0.2.2", 100)));
+    log.close();
+
+    Lease4Collection leases;
+    ASSERT_TRUE(readAll(leases));
+    EXPECT_EQ(2, leases.size());
+}
+
+}
@@ -150,6 +150,14 @@ public:
         return (Lease6Ptr());
     }
 
+    /// @brief Returns IPv6 leases for a group of addresses.
+    ///
+    /// Uses the default implementation provided by the @c LeaseMgr.
+    virtual Lease6Collection getLeases6(Lease::Type type,
+                                        const AddressCollection& addrs) const {
+        return (LeaseMgr::getLeases6(type, addrs));
+    }
+
     /// @brief Returns existing IPv6 lease for a given DUID+IA combination
     ///
     /// @param duid ignored
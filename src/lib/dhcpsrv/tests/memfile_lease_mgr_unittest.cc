@@ -142,6 +142,22 @@ TEST_F(MemfileLeaseMgrTest, constructor) {
     pmap["persist"] = "bogus";
     pmap["name"] = getLeaseFilePath("leasefile4_1.csv");
     EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), bundy::BadValue);
+
+    // The lease file format must be csv or binary.
+    pmap["persist"] = "false";
+    pmap["format"] = "binary";
+    EXPECT_NO_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)));
+    pmap["format"] = "bogus";
+    EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), bundy::BadValue);
+
+    // The compaction threshold is an unsigned integer.
+    pmap["format"] = "binary";
+    pmap["compact-threshold"] = "-1";
+    EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), bundy::BadValue);
+    pmap["compact-threshold"] = "many";
+    EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), bundy::BadValue);
+    pmap["compact-threshold"] = "10";
+    EXPECT_NO_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)));
 }
 
 // Checks if the getType() and getName() methods both return "memfile".
@@ -203,6 +219,82 @@ TEST_F(MemfileLeaseMgrTest, persistLeases) {
     EXPECT_FALSE(lease_mgr->persistLeases(Memfile_LeaseMgr::V6));
 }
 
+// Checks that the leases are stored in the binary lease file and loaded
+// from it when the backend is restarted.
+TEST_F(MemfileLeaseMgrTest, binaryLeaseFile) {
+    LeaseFileIO io4(getLeaseFilePath("leasefile4_0.log"));
+    io4.removeFile();
+
+    LeaseMgr::ParameterMap pmap;
+    pmap["universe"] = "4";
+    pmap["format"] = "binary";
+    pmap["name"] = getLeaseFilePath("leasefile4_0.log");
+    boost::scoped_ptr<Memfile_LeaseMgr> lease_mgr(new Memfile_LeaseMgr(pmap));
+    EXPECT_TRUE(lease_mgr->isBinaryFormat());
+    EXPECT_TRUE(lease_mgr->persistLeases(Memfile_LeaseMgr::V4));
+    EXPECT_EQ(pmap["name"],
+              lease_mgr->getLeaseFilePath(Memfile_LeaseMgr::V4));
+
+    std::vector<Lease4Ptr> leases = createLeases4();
+    ASSERT_TRUE(lease_mgr->addLease(leases[1]));
+    ASSERT_TRUE(lease_mgr->addLease(leases[2]));
+    ASSERT_TRUE(lease_mgr->addLease(leases[3]));
+    leases[2]->valid_lft_ += 100;
+    ASSERT_NO_THROW(lease_mgr->updateLease4(leases[2]));
+    ASSERT_TRUE(lease_mgr->deleteLease(leases[3]->addr_));
+
+    // Restart the backend, it should load the leases from the file.
+    lease_mgr.reset(new Memfile_LeaseMgr(pmap));
+    Lease4Ptr lease = lease_mgr->getLease4(leases[1]->addr_);
+    ASSERT_TRUE(lease);
+    detailCompareLease(leases[1], lease);
+    lease = lease_mgr->getLease4(leases[2]->addr_);
+    ASSERT_TRUE(lease);
+    detailCompareLease(leases[2], lease);
+    EXPECT_FALSE(lease_mgr->getLease4(leases[3]->addr_));
+}
+
+// Checks that the binary lease file is compacted in the background when
+// the number of appended records exceeds the threshold, and that no lease
+// update is lost.
+TEST_F(MemfileLeaseMgrTest, binaryLeaseFileCompaction) {
+    LeaseFileIO io6(getLeaseFilePath("leasefile6_0.log"));
+    io6.removeFile();
+    LeaseFileIO tmp_io6(getLeaseFilePath("leasefile6_0.log.compact"));
+
+    LeaseMgr::ParameterMap pmap;
+    pmap["universe"] = "6";
+    pmap["format"] = "binary";
+    pmap["compact-threshold"] = "10";
+    pmap["name"] = getLeaseFilePath("leasefile6_0.log");
+    boost::scoped_ptr<Memfile_LeaseMgr> lease_mgr(new Memfile_LeaseMgr(pmap));
+
+    std::vector<Lease6Ptr> leases = createLeases6();
+    ASSERT_TRUE(lease_mgr->addLease(leases[1]));
+    ASSERT_TRUE(lease_mgr->addLease(leases[2]));
+    // Update the leases many times, which should trigger compaction.
+    for (int i = 0; i < 30; ++i) {
+        leases[1]->valid_lft_ += 1;
+        ASSERT_NO_THROW(lease_mgr->updateLease6(leases[1]));
+        leases[2]->valid_lft_ += 1;
+        ASSERT_NO_THROW(lease_mgr->updateLease6(leases[2]));
+    }
+    EXPECT_TRUE(lease_mgr->waitForCompaction(Memfile_LeaseMgr::V6));
+    EXPECT_FALSE(tmp_io6.exists());
+
+    lease_mgr.reset(new Memfile_LeaseMgr(pmap));
+    Lease6Ptr lease = lease_mgr->getLease6(leases[1]->type_,
+                                           leases[1]->addr_);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(leases[1]->valid_lft_, lease->valid_lft_);
+    lease = lease_mgr->getLease6(leases[2]->type_, leases[2]->addr_);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(leases[2]->valid_lft_, lease->valid_lft_);
+
+    // Compaction can only be requested for the binary lease file.
+    EXPECT_THROW(lease_mgr->compactLeaseFile(Memfile_LeaseMgr::V4),
+                 bundy::InvalidOperation);
+}
 
 // Checks that adding/getting/deleting a Lease6 object works.
 TEST_F(MemfileLeaseMgrTest, addGetDelete6) {
@@ -404,6 +496,35 @@ TEST_F(MemfileLeaseMgrTest, testRecreateLease6) {
     testRecreateLease6();
 }
 
+/// @brief Lease retrieval for a group of IPv4 addresses
+///
+/// Checks that the leases for a group of addresses are retrieved, also
+/// when the group spans multiple queries.
+TEST_F(MemfileLeaseMgrTest, getLeases4Addresses) {
+    startBackend(V4);
+    testGetLeases4Addresses();
+}
+
+/// @brief Lease retrieval for a group of IPv6 addresses
+TEST_F(MemfileLeaseMgrTest, getLeases6Addresses) {
+    startBackend(V6);
+    testGetLeases6Addresses();
+}
+
+/// @brief Adding and updating groups of IPv4 leases
+///
+/// Checks that a group of leases is added or updated as a whole.
+TEST_F(MemfileLeaseMgrTest, addUpdateLeases4) {
+    startBackend(V4);
+    testAddUpdateLeases4();
+}
+
+/// @brief Adding and updating groups of IPv6 leases
+TEST_F(MemfileLeaseMgrTest, addUpdateLeases6) {
+    startBackend(V6);
+    testAddUpdateLeases6();
+}
+
 // The following tests are not applicable for memfile. When adding
 // new tests to the list here, make sure to provide brief explanation
 // why they are not applicable:
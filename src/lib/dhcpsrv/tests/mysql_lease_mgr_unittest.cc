@@ -506,4 +506,29 @@ TEST_F(MySqlLeaseMgrTest, testRecreateLease6) {
     testRecreateLease6();
 }
 
+/// @brief Lease retrieval for a group of IPv4 addresses
+///
+/// Checks that the leases for a group of addresses are retrieved, also
+/// when the group spans multiple queries.
+TEST_F(MySqlLeaseMgrTest, getLeases4Addresses) {
+    testGetLeases4Addresses();
+}
+
+/// @brief Lease retrieval for a group of IPv6 addresses
+TEST_F(MySqlLeaseMgrTest, getLeases6Addresses) {
+    testGetLeases6Addresses();
+}
+
+/// @brief Adding and updating groups of IPv4 leases
+///
+/// Checks that a group of leases is added or updated as a whole.
+TEST_F(MySqlLeaseMgrTest, addUpdateLeases4) {
+    testAddUpdateLeases4();
+}
+
+/// @brief Adding and updating groups of IPv6 leases
+TEST_F(MySqlLeaseMgrTest, addUpdateLeases6) {
+    testAddUpdateLeases6();
+}
+
 }; // Of anonymous namespace
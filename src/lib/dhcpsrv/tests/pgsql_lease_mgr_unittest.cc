@@ -456,4 +456,29 @@ TEST_F(PgSqlLeaseMgrTest, updateLease6) {
     testUpdateLease6();
 }
 
+/// @brief Lease retrieval for a group of IPv4 addresses
+///
+/// Checks that the leases for a group of addresses are retrieved, also
+/// when the group spans multiple queries.
+TEST_F(PgSqlLeaseMgrTest, getLeases4Addresses) {
+    testGetLeases4Addresses();
+}
+
+/// @brief Lease retrieval for a group of IPv6 addresses
+TEST_F(PgSqlLeaseMgrTest, getLeases6Addresses) {
+    testGetLeases6Addresses();
+}
+
+/// @brief Adding and updating groups of IPv4 leases
+///
+/// Checks that a group of leases is added or updated as a whole.
+TEST_F(PgSqlLeaseMgrTest, addUpdateLeases4) {
+    testAddUpdateLeases4();
+}
+
+/// @brief Adding and updating groups of IPv6 leases
+TEST_F(PgSqlLeaseMgrTest, addUpdateLeases6) {
+    testAddUpdateLeases6();
+}
+
 };
@@ -0,0 +1,183 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <bench/benchmark.h>
+
+#include <util/buffer.h>
+
+#include <dns/edns.h>
+#include <dns/message.h>
+#include <dns/messagerenderer.h>
+#include <dns/name.h>
+#include <dns/opcode.h>
+#include <dns/question.h>
+#include <dns/rcode.h>
+#include <dns/rdataclass.h>
+#include <dns/rrclass.h>
+#include <dns/rrset.h>
+#include <dns/rrttl.h>
+#include <dns/rrtype.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace std;
+using namespace bundy::util;
+using namespace bundy::bench;
+using namespace bundy::dns;
+
+namespace {
+// This benchmark parses the same wire-format message repeatedly.  If
+// "reuse" is true, the same Message object is used for all the iterations,
+// as a server handling queries one after another would do; otherwise a new
+// Message is created for each parse.
+class MessageParseBenchMark {
+public:
+    MessageParseBenchMark(const OutputBuffer& data, bool reuse) :
+        data_(data), reuse_(reuse), message_(NULL)
+    {}
+    ~MessageParseBenchMark() {
+        delete message_;
+    }
+    unsigned int run() {
+        InputBuffer buffer(data_.getData(), data_.getLength());
+        if (reuse_) {
+            if (message_ == NULL) {
+                message_ = new Message(Message::PARSE);
+            }
+            message_->fromWire(buffer);
+            assert(message_->getRRCount(Message::SECTION_QUESTION) == 1);
+        } else {
+            Message message(Message::PARSE);
+            message.fromWire(buffer);
+            assert(message.getRRCount(Message::SECTION_QUESTION) == 1);
+        }
+        return (1);
+    }
+private:
+    const OutputBuffer& data_;
+    const bool reuse_;
+    Message* message_; // It's pointer, so we won't need to copy it.
+};
+
+// Build a query for the given name and type, with an EDNS OPT RR if
+// edns_udpsize is non 0.
+void
+buildQuery(OutputBuffer& data, const char* qname, const RRType& qtype,
+           uint16_t edns_udpsize)
+{
+    Message message(Message::RENDER);
+    message.setQid(0x1035);
+    message.setOpcode(Opcode::QUERY());
+    message.setRcode(Rcode::NOERROR());
+    message.setHeaderFlag(Message::HEADERFLAG_RD);
+    message.addQuestion(Question(Name(qname), RRClass::IN(), qtype));
+    if (edns_udpsize != 0) {
+        EDNSPtr edns(new EDNS());
+        edns->setUDPSize(edns_udpsize);
+        edns->setDNSSECAwareness(true);
+        message.setEDNS(edns);
+    }
+    MessageRenderer renderer;
+    message.toWire(renderer);
+    data.writeData(renderer.getData(), renderer.getLength());
+}
+
+// Build a small positive response to the query for www.example.com/A.
+void
+buildResponse(OutputBuffer& data) {
+    Message message(Message::RENDER);
+    message.setQid(0x1035);
+    message.setOpcode(Opcode::QUERY());
+    message.setRcode(Rcode::NOERROR());
+    message.setHeaderFlag(Message::HEADERFLAG_QR);
+    message.setHeaderFlag(Message::HEADERFLAG_AA);
+    const Name qname("www.example.com");
+    message.addQuestion(Question(qname, RRClass::IN(), RRType::A()));
+    RRsetPtr answer(new RRset(qname, RRClass::IN(), RRType::A(),
+                              RRTTL(3600)));
+    answer->addRdata(rdata::in::A("192.0.2.1"));
+    answer->addRdata(rdata::in::A("192.0.2.2"));
+    message.addRRset(Message::SECTION_ANSWER, answer);
+    RRsetPtr authority(new RRset(Name("example.com"), RRClass::IN(),
+                                 RRType::NS(), RRTTL(3600)));
+    authority->addRdata(rdata::generic::NS(Name("ns1.example.com")));
+    authority->addRdata(rdata::generic::NS(Name("ns2.example.com")));
+    message.addRRset(Message::SECTION_AUTHORITY, authority);
+    MessageRenderer renderer;
+    message.toWire(renderer);
+    data.writeData(renderer.getData(), renderer.getLength());
+}
+
+void
+usage() {
+    cerr << "Usage: message_parse_bench [-n iterations]" << endl;
+    exit (1);
+}
+}
+
+int
+main(int argc, char* argv[]) {
+    int ch;
+    int iteration = 100000;
+    while ((ch = getopt(argc, argv, "n:")) != -1) {
+        switch (ch) {
+        case 'n':
+            iteration = atoi(optarg);
+            break;
+        case '?':
+        default:
+            usage();
+        }
+    }
+    argc -= optind;
+    if (argc != 0) {
+        usage();
+    }
+
+    cout << "Parameters:" << endl;
+    cout << "  Iterations: " << iteration << endl;
+
+    OutputBuffer plain_query(0);
+    buildQuery(plain_query, "www.example.com", RRType::A(), 0);
+    OutputBuffer edns_query(0);
+    buildQuery(edns_query, "www.example.com", RRType::A(), 4096);
+    OutputBuffer response(0);
+    buildResponse(response);
+
+    typedef pair<const OutputBuffer*, string> DataSpec;
+    vector<DataSpec> spec_list;
+    spec_list.push_back(DataSpec(&plain_query, "(query)"));
+    spec_list.push_back(DataSpec(&edns_query, "(query with EDNS)"));
+    spec_list.push_back(DataSpec(&response, "(positive response)"));
+    for (vector<DataSpec>::const_iterator it = spec_list.begin();
+         it != spec_list.end();
+         ++it) {
+        cout << "Benchmark for parsing into new Message " << it->second
+             << endl;
+        BenchMark<MessageParseBenchMark>(
+            iteration, MessageParseBenchMark(*it->first, false));
+
+        cout << "Benchmark for parsing into reused Message " << it->second
+             << endl;
+        BenchMark<MessageParseBenchMark>(
+            iteration, MessageParseBenchMark(*it->first, true));
+    }
+
+    return (0);
+}
@@ -89,6 +89,40 @@ const char* const sectiontext[] = {
     "AUTHORITY",
     "ADDITIONAL"
 };
+
+// Position of the upper 8 bits of the extended RCODE in the TTL of the
+// EDNS OPT RR (see edns.cc).
+const unsigned int EDNS_EXTRCODE_SHIFT = 24;
+
+// Maximum number of questions kept for reuse by the next parse.  Queries
+// have a single question, so there's no point keeping many of them.
+const size_t MAX_POOLED_QUESTIONS = 4;
+
+// The EDNS class doesn't keep the options of the OPT RR, so the RDATA is
+// only checked for validity when parsed and this empty one passed instead.
+const generic::OPT EMPTY_OPT_RDATA;
+
+// Check the RDATA of an OPT RR and skip it in the buffer.  This performs
+// the same checks as the OPT RDATA constructor from wire, without building
+// the object.
+void
+skipOPTRdata(InputBuffer& buffer, size_t rdata_len) {
+    while (rdata_len > 0) {
+        if (rdata_len < 4) {
+            bundy_throw(InvalidRdataLength,
+                        "Pseudo OPT RR record too short: "
+                        << rdata_len << " bytes");
+        }
+        buffer.readUint16();    // option code
+        const uint16_t option_length = buffer.readUint16();
+        rdata_len -= 4;
+        if (rdata_len < option_length) {
+            bundy_throw(InvalidRdataLength, "Corrupt pseudo OPT RR record");
+        }
+        buffer.setPosition(buffer.getPosition() + option_length);
+        rdata_len -= option_length;
+    }
+}
 }
 
 class MessageImpl {
@@ -118,6 +152,15 @@ public:
     ConstEDNSPtr edns_;
     ConstTSIGRecordPtr tsig_rr_;
 
+    // Objects kept from the previous parse for reuse, so that parsing a
+    // typical query (a single question and an EDNS OPT RR) doesn't involve
+    // memory allocation once the message has been used.  They are only
+    // reused when nothing outside the message refers to them any more.
+    vector<QuestionPtr> question_pool_;
+    EDNSPtr edns_pool_;
+    // Owner name of the RR being parsed, reused for the same reason.
+    Name rr_name_;
+
     // RRsetsSorter* sorter_; : TODO
 
     void init();
@@ -137,7 +180,7 @@ public:
                const RRTTL& ttl, Message::ParseOptions options);
     void addEDNS(Message::Section section, const Name& name,
                  const RRClass& rrclass, const RRType& rrtype,
-                 const RRTTL& ttl, const Rdata& rdata);
+                 const RRTTL& ttl);
     void addTSIG(Message::Section section, unsigned int count,
                  const InputBuffer& buffer, size_t start_position,
                  const Name& name, const RRClass& rrclass,
@@ -148,7 +191,8 @@ public:
 MessageImpl::MessageImpl(Message::Mode mode) :
     mode_(mode),
     rcode_placeholder_(Rcode(0)), // as a placeholder the value doesn't matter
-    opcode_placeholder_(Opcode(0)) // ditto
+    opcode_placeholder_(Opcode(0)), // ditto
+    rr_name_(Name::ROOT_NAME())
 {
     init();
 }
@@ -167,6 +211,14 @@ MessageImpl::init() {
     }
 
     header_parsed_ = false;
+    for (vector<QuestionPtr>::const_iterator it = questions_.begin();
+         it != questions_.end() &&
+             question_pool_.size() < MAX_POOLED_QUESTIONS;
+         ++it) {
+        if (it->unique()) {
+            question_pool_.push_back(*it);
+        }
+    }
     questions_.clear();
     rrsets_[Message::SECTION_ANSWER].clear();
     rrsets_[Message::SECTION_AUTHORITY].clear();
@@ -666,21 +718,31 @@ MessageImpl::parseQuestion(InputBuffer& buffer) {
     for (unsigned int count = 0;
          count < counts_[Message::SECTION_QUESTION];
          ++count) {
-        const Name name(buffer);
+        // Parse into a question of the previous message if there's one;
+        // the storage of its name is reused as well.
+        QuestionPtr question;
+        if (!question_pool_.empty()) {
+            question = question_pool_.back();
+            question_pool_.pop_back();
+        }
 
-        if ((buffer.getLength() - buffer.getPosition()) <
-            2 * sizeof(uint16_t)) {
-            bundy_throw(DNSMessageFORMERR, "Question section too short: " <<
-                      (buffer.getLength() - buffer.getPosition()) << " bytes");
+        try {
+            if (question) {
+                question->fromWire(buffer);
+            } else {
+                question.reset(new Question(buffer));
+            }
+        } catch (const IncompleteRRType&) {
+            bundy_throw(DNSMessageFORMERR, "Question section too short");
+        } catch (const IncompleteRRClass&) {
+            bundy_throw(DNSMessageFORMERR, "Question section too short");
         }
-        const RRType rrtype(buffer.readUint16());
-        const RRClass rrclass(buffer.readUint16());
 
         // XXX: need a duplicate check.  We might also want to have an
         // optimized algorithm that requires the question section contain
         // exactly one RR.
 
-        questions_.push_back(QuestionPtr(new Question(name, rrclass, rrtype)));
+        questions_.push_back(question);
         ++added;
     }
 
@@ -742,7 +804,8 @@ MessageImpl::parseSection(const Message::Section section,
         // We need to remember the start position for TSIG processing
         const size_t start_position = buffer.getPosition();
 
-        const Name name(buffer);
+        rr_name_.fromWire(buffer);
+        const Name& name = rr_name_;
 
         // buffer must store at least RR TYPE, RR CLASS, TTL, and RDLEN.
         if ((buffer.getLength() - buffer.getPosition()) <
@@ -767,11 +830,14 @@ MessageImpl::parseSection(const Message::Section section,
             ++added;
             continue;
         }
+        if (rrtype == RRType::OPT()) {
+            skipOPTRdata(buffer, rdlen);
+            addEDNS(section, name, rrclass, rrtype, ttl);
+            continue;
+        }
         ConstRdataPtr rdata = createRdata(rrtype, rrclass, buffer, rdlen);
 
-        if (rrtype == RRType::OPT()) {
-            addEDNS(section, name, rrclass, rrtype, ttl, *rdata);
-        } else if (rrtype == RRType::TSIG()) {
+        if (rrtype == RRType::TSIG()) {
             addTSIG(section, count, buffer, start_position, name, rrclass, ttl,
                     *rdata);
         } else {
@@ -825,7 +891,7 @@ MessageImpl::addRR(Message::Section section, const Name& name,
 void
 MessageImpl::addEDNS(Message::Section section,  const Name& name,
                      const RRClass& rrclass, const RRType& rrtype,
-                     const RRTTL& ttl, const Rdata& rdata)
+                     const RRTTL& ttl)
 {
     if (section != Message::SECTION_ADDITIONAL) {
         bundy_throw(DNSMessageFORMERR,
@@ -835,10 +901,19 @@ MessageImpl::addEDNS(Message::Section section,  const Name& name,
         bundy_throw(DNSMessageFORMERR, "multiple EDNS OPT RR found");
     }
 
-    uint8_t extended_rcode;
-    edns_ = ConstEDNSPtr(createEDNSFromRR(name, rrclass, rrtype, ttl, rdata,
-                                          extended_rcode));
-    setRcode(Rcode(rcode_->getCode(), extended_rcode));
+    // Construct the EDNS locally first, so that nothing is modified if the
+    // RR is invalid, then store it in the object of the previous message
+    // if possible.
+    const EDNS edns(name, rrclass, rrtype, ttl, EMPTY_OPT_RDATA);
+    if (edns_pool_ && edns_pool_.unique() &&
+        edns_pool_->getVersion() == edns.getVersion()) {
+        edns_pool_->setUDPSize(edns.getUDPSize());
+        edns_pool_->setDNSSECAwareness(edns.getDNSSECAwareness());
+    } else {
+        edns_pool_.reset(new EDNS(edns));
+    }
+    edns_ = edns_pool_;
+    setRcode(Rcode(rcode_->getCode(), ttl.getValue() >> EDNS_EXTRCODE_SHIFT));
 }
 
 void
@@ -392,9 +392,21 @@ typedef enum {
 } fw_state;
 }
 
-Name::Name(InputBuffer& buffer, bool downcase) {
-    NameOffsets offsets;
-    offsets.reserve(Name::MAX_LABELS);
+Name::Name(InputBuffer& buffer, bool downcase) :
+    length_(0), labelcount_(0)
+{
+    fromWire(buffer, downcase);
+}
+
+void
+Name::fromWire(InputBuffer& buffer, bool downcase) {
+    // The name is assembled in local arrays first, so the object is left
+    // unchanged if the data is broken, and the storage of the object is
+    // only touched once when it is copied in.
+    uint8_t ndata[Name::MAX_WIRE];
+    uint8_t offsets[Name::MAX_LABELS];
+    unsigned int nlabels = 0;
+    unsigned int ndata_len = 0;
 
     /*
      * Initialize things to make the compiler happy; they're not required.
@@ -433,13 +445,13 @@ Name::Name(InputBuffer& buffer, bool downcase) {
         switch (state) {
         case fw_start:
             if (c <= MAX_LABELLEN) {
-                offsets.push_back(nused);
                 if (nused + c + 1 > Name::MAX_WIRE) {
                     bundy_throw(DNSMessageFORMERR, "wire name is too long: "
                               << nused + c + 1 << " bytes");
                 }
+                offsets[nlabels++] = nused;
+                ndata[ndata_len++] = c;
                 nused += c + 1;
-                ndata_.push_back(c);
                 if (c == 0) {
                     done = true;
                 }
@@ -462,7 +474,7 @@ Name::Name(InputBuffer& buffer, bool downcase) {
             if (downcase) {
                 c = maptolower[c];
             }
-            ndata_.push_back(c);
+            ndata[ndata_len++] = c;
             if (--n == 0) {
                 state = fw_start;
             }
@@ -493,9 +505,10 @@ Name::Name(InputBuffer& buffer, bool downcase) {
         bundy_throw(DNSMessageFORMERR, "incomplete wire-format name");
     }
 
-    labelcount_ = offsets.size();
+    ndata_.assign(ndata, ndata_len);
+    offsets_.assign(offsets, offsets + nlabels);
+    labelcount_ = nlabels;
     length_ = nused;
-    offsets_.assign(offsets.begin(), offsets.end());
     buffer.setPosition(pos_begin + cused);
 }
 
@@ -317,6 +317,22 @@ public:
     /// We use the default copy assignment operator intentionally.
     ///
 
+    /// \brief Replace the name with one read from wire-format %data.
+    ///
+    /// This is equivalent to assigning <code>Name(buffer, downcase)</code>
+    /// to this object, but the storage already held by the object is reused.
+    /// Parsing into the same object repeatedly, e.g. the names of successive
+    /// DNS messages, therefore doesn't involve resource allocation once the
+    /// object has held a name at least as long.
+    ///
+    /// If the given %data does not represent a valid DNS name, an exception
+    /// of class \c DNSMessageFORMERR will be thrown and the object is left
+    /// unchanged.
+    ///
+    /// \param buffer A buffer storing the wire format %data.
+    /// \param downcase Whether to convert upper case alphabets to lower case.
+    void fromWire(bundy::util::InputBuffer& buffer, bool downcase = false);
+
     ///
     /// \name Getter Methods
     ///
@@ -844,6 +844,16 @@ PyTypeObject message_type = {
     BUNDY_UTIL_PYTHON_PyVarObject_TAIL_INIT
 };
 
+Message&
+PyMessage_ToMessage(PyObject* message_obj) {
+    if (message_obj == NULL) {
+        bundy_throw(PyCPPWrapperException,
+                  "obj argument NULL in Message PyObject conversion");
+    }
+    s_Message* message = static_cast<s_Message*>(message_obj);
+    return (*message->cppobj);
+}
+
 } // end python namespace
 } // end dns namespace
 } // end bundy namespace
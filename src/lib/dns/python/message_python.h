@@ -30,6 +30,18 @@ extern PyObject* po_InvalidMessageUDPSize;
 
 extern PyTypeObject message_type;
 
+/// \brief Returns a reference to the Message object contained within
+///        the given Python object.
+///
+/// \note The given object MUST be of type Message; this can be checked with
+///       the right call to ParseTuple("O!")
+///
+/// \note This is not a copy; if the Message is needed when the PyObject
+/// may be destroyed, the caller must copy it itself.
+///
+/// \param message_obj The message object to convert
+Message& PyMessage_ToMessage(PyObject* message_obj);
+
 } // namespace python
 } // namespace dns
 } // namespace bundy
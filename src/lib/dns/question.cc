@@ -40,6 +40,13 @@ Question::Question(InputBuffer& buffer) :
     rrclass_ = RRClass(buffer);
 }
 
+void
+Question::fromWire(InputBuffer& buffer) {
+    name_.fromWire(buffer);
+    rrtype_ = RRType(buffer);
+    rrclass_ = RRClass(buffer);
+}
+
 std::string
 Question::toText(bool newline) const {
     std::string r(name_.toText() + " " + rrclass_.toText() + " " +
@@ -138,6 +138,19 @@ public:
     {}
     //@}
 
+    /// \brief Replace the content with the question in wire-format data.
+    ///
+    /// This is equivalent to assigning <code>Question(buffer)</code> to this
+    /// object, but the storage of the owner name is reused (see
+    /// \c Name::fromWire()), so the object can be used for parsing many
+    /// questions without resource allocation.
+    ///
+    /// It may throw the same exceptions as the constructor from wire-format
+    /// data.  If it does, the content of the object is unspecified.
+    ///
+    /// \param buffer A buffer storing the wire format data.
+    void fromWire(bundy::util::InputBuffer& buffer);
+
     ///
     /// \name Getter Methods
     ///
@@ -638,6 +638,56 @@ TEST_F(MessageTest, fromWireMultiple) {
     checkMessageFromWire(message_parse, test_name);
 }
 
+TEST_F(MessageTest, fromWireReuse) {
+    // The question and EDNS of a message still referred to from outside are
+    // left intact by the next parse.
+    factoryFromFile(message_parse, "message_fromWire10.wire");
+    const ConstEDNSPtr edns = message_parse.getEDNS();
+    const QuestionPtr question = *message_parse.beginQuestion();
+    const Question question_copy(*question);
+
+    factoryFromFile(message_parse, "message_fromWire1");
+    checkMessageFromWire(message_parse, test_name);
+    EXPECT_FALSE(message_parse.getEDNS());
+    EXPECT_EQ(question_copy, *question);
+    EXPECT_TRUE(edns->getDNSSECAwareness());
+    EXPECT_EQ(4096, edns->getUDPSize());
+
+    // Otherwise they are reused, with the content of the new message.
+    factoryFromFile(message_parse, "message_fromWire10.wire");
+    const EDNS* const edns_ptr = message_parse.getEDNS().get();
+    const Question* const question_ptr =
+        message_parse.beginQuestion()->get();
+    factoryFromFile(message_parse, "message_toWire3.wire");
+    EXPECT_EQ(edns_ptr, message_parse.getEDNS().get());
+    EXPECT_FALSE(message_parse.getEDNS()->getDNSSECAwareness());
+    EXPECT_EQ(question_ptr, message_parse.beginQuestion()->get());
+    EXPECT_EQ(Name("www.example.com"),
+              (*message_parse.beginQuestion())->getName());
+    EXPECT_EQ(Rcode::NOERROR(), message_parse.getRcode());
+}
+
+TEST_F(MessageTest, fromWireBadOPT) {
+    // A query whose OPT RR has a truncated option.
+    UnitTestUtil::readWireData(string("0000 0000 0001 0000 0000 0001 "
+                                      "00 0001 0001 "
+                                      "00 0029 1000 00000000 0005 "
+                                      "0003 0002 00"),
+                               received_data);
+    InputBuffer buffer(&received_data[0], received_data.size());
+    EXPECT_THROW(message_parse.fromWire(buffer), InvalidRdataLength);
+
+    // And one whose OPT RR has an option running out of the message.
+    received_data.clear();
+    UnitTestUtil::readWireData(string("0000 0000 0001 0000 0000 0001 "
+                                      "00 0001 0001 "
+                                      "00 0029 1000 00000000 0006 "
+                                      "0003 0002 00"),
+                               received_data);
+    InputBuffer short_buffer(&received_data[0], received_data.size());
+    EXPECT_THROW(message_parse.fromWire(short_buffer), InvalidBufferPosition);
+}
+
 TEST_F(MessageTest, fromWireShortBuffer) {
     // We trim a valid message (ending with an SOA RR) for one byte.
     // fromWire() should throw an exception while parsing the trimmed RR.
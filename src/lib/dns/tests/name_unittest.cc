@@ -432,6 +432,31 @@ TEST_F(NameTest, fromWire) {
     EXPECT_EQ(3, nameFactoryFromWire("name_fromWire1", 25).getLabelCount());
 }
 
+TEST_F(NameTest, fromWireReplace) {
+    vector<unsigned char> data;
+    UnitTestUtil::readWireData("name_fromWire1", data);
+    InputBuffer buffer(&data[0], data.size());
+
+    // The name is replaced, whatever it was before.
+    Name name(example_name);
+    buffer.setPosition(25);
+    name.fromWire(buffer);
+    EXPECT_PRED_FORMAT2(UnitTestUtil::matchName, name, Name("vix.com"));
+    EXPECT_EQ(3, name.getLabelCount());
+
+    buffer.setPosition(25);
+    name.fromWire(buffer, true);
+    EXPECT_EQ("vix.com.", name.toText());
+
+    // The name is left unchanged if the data is broken.
+    UnitTestUtil::readWireData("name_fromWire2", data);
+    InputBuffer bad_buffer(&data[0], data.size());
+    bad_buffer.setPosition(25);
+    EXPECT_THROW(name.fromWire(bad_buffer), DNSMessageFORMERR);
+    EXPECT_EQ("vix.com.", name.toText());
+    EXPECT_EQ(3, name.getLabelCount());
+}
+
 TEST_F(NameTest, copyConstruct) {
     Name copy(example_name);
     EXPECT_EQ(copy, example_name);
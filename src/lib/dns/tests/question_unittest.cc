@@ -87,6 +87,20 @@ TEST_F(QuestionTest, fromWire) {
     EXPECT_THROW(questionFromWire("question_fromWire", 36), IncompleteRRClass);
 }
 
+TEST_F(QuestionTest, fromWireReplace) {
+    UnitTestUtil::readWireData("question_fromWire", wiredata);
+    InputBuffer buffer(&wiredata[0], wiredata.size());
+
+    Question q(test_question2);
+    q.fromWire(buffer);
+    EXPECT_EQ(test_question1, q);
+
+    q.fromWire(buffer);
+    EXPECT_EQ(test_question2, q);
+
+    EXPECT_THROW(q.fromWire(buffer), DNSMessageFORMERR);
+}
+
 TEST_F(QuestionTest, toText) {
     EXPECT_EQ("foo.example.com. IN NS", test_question1.toText());
     EXPECT_EQ("bar.example.com. CH A", test_question2.toText());
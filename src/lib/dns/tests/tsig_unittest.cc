@@ -1149,4 +1149,74 @@ TEST_F(TSIGTest, verifyMulti) {
     }
 }
 
+// Send a stream of multiple messages, some of them without signature,
+// and verify them with the other context.
+TEST_F(TSIGTest, signMulti) {
+    bundy::util::detail::gettimeFunction = testGetTime<0x4da8877a>;
+
+    // Unsigned messages can only follow a signed response.
+    EXPECT_THROW(tsig_ctx->digestUnsigned(&dummy_data[0], dummy_data.size()),
+                 TSIGContextError);
+
+    {
+        SCOPED_TRACE("Query");
+        ConstTSIGRecordPtr tsig = createMessageAndSign(1234, test_name,
+                                                       tsig_verify_ctx.get());
+        commonVerifyChecks(*tsig_ctx, tsig.get(),
+                           renderer.getData(), renderer.getLength(),
+                           TSIGError(Rcode::NOERROR()),
+                           TSIGContext::RECEIVED_REQUEST);
+    }
+    EXPECT_THROW(tsig_ctx->digestUnsigned(&dummy_data[0], dummy_data.size()),
+                 TSIGContextError);
+
+    {
+        SCOPED_TRACE("First message");
+        ConstTSIGRecordPtr tsig = createMessageAndSign(1234, test_name,
+                                                       tsig_ctx.get());
+        commonVerifyChecks(*tsig_verify_ctx, tsig.get(),
+                           renderer.getData(), renderer.getLength(),
+                           TSIGError(Rcode::NOERROR()),
+                           TSIGContext::VERIFIED_RESPONSE);
+    }
+    EXPECT_THROW(tsig_ctx->digestUnsigned(NULL, 0), InvalidParameter);
+
+    for (int round = 0; round < 2; ++round) {
+        SCOPED_TRACE(round);
+        for (int i = 0; i < TSIGContext::MAX_UNSIGNED_MESSAGES; ++i) {
+            SCOPED_TRACE(i);
+            message.clear(Message::RENDER);
+            message.setQid(1234);
+            message.setOpcode(Opcode::QUERY());
+            message.setRcode(Rcode::NOERROR());
+            RRsetPtr answer_rrset(new RRset(test_name, test_class, RRType::A(),
+                                            test_ttl));
+            answer_rrset->addRdata(createRdata(RRType::A(), test_class,
+                                               "192.0.2.1"));
+            message.addRRset(Message::SECTION_ANSWER, answer_rrset);
+            renderer.clear();
+            message.toWire(renderer);
+            tsig_ctx->digestUnsigned(renderer.getData(), renderer.getLength());
+
+            commonVerifyChecks(*tsig_verify_ctx, NULL,
+                               renderer.getData(), renderer.getLength(),
+                               TSIGError(Rcode::NOERROR()),
+                               TSIGContext::VERIFIED_RESPONSE);
+            EXPECT_FALSE(tsig_verify_ctx->lastHadSignature());
+        }
+
+        // The next one must be signed.
+        EXPECT_THROW(tsig_ctx->digestUnsigned(renderer.getData(),
+                                              renderer.getLength()),
+                     TSIGContextError);
+        ConstTSIGRecordPtr tsig = createMessageAndSign(1234, test_name,
+                                                       tsig_ctx.get());
+        commonVerifyChecks(*tsig_verify_ctx, tsig.get(),
+                           renderer.getData(), renderer.getLength(),
+                           TSIGError(Rcode::NOERROR()),
+                           TSIGContext::VERIFIED_RESPONSE);
+        EXPECT_TRUE(tsig_verify_ctx->lastHadSignature());
+    }
+}
+
 } // end namespace
@@ -19,6 +19,7 @@
 #include <exceptions/exceptions.h>
 
 #include <cryptolink/cryptolink.h>
+#include <cryptolink/crypto_hmac.h>
 
 #include <dns/tsigkey.h>
 
@@ -151,6 +152,42 @@ TEST_F(TSIGKeyTest, assignment) {
     compareTSIGKeys(original, copy);
 }
 
+TEST_F(TSIGKeyTest, createHMAC) {
+    const TSIGKey key(key_name, TSIGKey::HMACMD5_NAME(), "Jefe", 4);
+    // RFC2202 test case 2 for HMAC-MD5
+    const string data("what do ya want for nothing?");
+    const uint8_t expected[] = { 0x75, 0x0c, 0x78, 0x3e, 0x6a, 0xb0, 0xb5,
+                                 0x03, 0xea, 0xa8, 0x6e, 0x31, 0x0a, 0x5d,
+                                 0xb7, 0x38 };
+
+    bundy::cryptolink::HMAC* hmac_ptr;
+    {
+        boost::shared_ptr<bundy::cryptolink::HMAC> hmac = key.createHMAC();
+        hmac_ptr = hmac.get();
+        hmac->update(data.c_str(), data.size());
+        EXPECT_TRUE(hmac->verify(expected, sizeof(expected)));
+        // Some data that isn't signed; it should be discarded on release.
+        hmac->update("garbage", 7);
+    }
+
+    // A released object is reused, also through a copy of the key.
+    const TSIGKey copy(key);
+    boost::shared_ptr<bundy::cryptolink::HMAC> hmac = copy.createHMAC();
+    EXPECT_EQ(hmac_ptr, hmac.get());
+    hmac->update(data.c_str(), data.size());
+    EXPECT_TRUE(hmac->verify(expected, sizeof(expected)));
+
+    // While it's in use, another one is created.
+    boost::shared_ptr<bundy::cryptolink::HMAC> hmac2 = key.createHMAC();
+    EXPECT_NE(hmac.get(), hmac2.get());
+    hmac2->update(data.c_str(), data.size());
+    EXPECT_TRUE(hmac2->verify(expected, sizeof(expected)));
+
+    // Keys with an unsupported algorithm can't have one.
+    EXPECT_THROW(TSIGKey(key_name, Name("unknown.alg"), NULL, 0).createHMAC(),
+                 bundy::cryptolink::UnsupportedAlgorithm);
+}
+
 class TSIGKeyRingTest : public ::testing::Test {
 protected:
     TSIGKeyRingTest() :
@@ -62,7 +62,7 @@ struct TSIGContext::TSIGContextImpl {
                     TSIGError error = TSIGError::NOERROR()) :
         state_(INIT), key_(key), error_(error),
         previous_timesigned_(0), digest_len_(0),
-        last_sig_dist_(-1)
+        last_sig_dist_(-1), unsigned_sent_(0)
     {
         if (error == TSIGError::NOERROR()) {
             // In normal (NOERROR) case, the key should be valid, and we
@@ -75,10 +75,7 @@ struct TSIGContext::TSIGContextImpl {
             // it at this moment; a subsequent sign/verify operation will try
             // to create the HMAC, which would also fail.
             try {
-                hmac_.reset(CryptoLink::getCryptoLink().createHMAC(
-                                key_.getSecret(), key_.getSecretLength(),
-                                key_.getAlgorithm()),
-                            deleteHMAC);
+                hmac_ = key_.createHMAC();
             } catch (const bundy::Exception&) {
                 return;
             }
@@ -109,20 +106,17 @@ struct TSIGContext::TSIGContextImpl {
     }
 
     // A shortcut method to create an HMAC object for sign/verify.  If one
-    // has been successfully created in the constructor, return it; otherwise
-    // create a new one and return it.  In the former case, the ownership is
-    // transferred to the caller; the stored HMAC will be reset after the
-    // call.
+    // has been successfully created in the constructor (or holds the digest
+    // of unsigned messages), return it; otherwise get one from the key and
+    // return it.  In the former case, the ownership is transferred to the
+    // caller; the stored HMAC will be reset after the call.
     HMACPtr createHMAC() {
         if (hmac_) {
             HMACPtr ret = HMACPtr();
             ret.swap(hmac_);
             return (ret);
         }
-        return (HMACPtr(CryptoLink::getCryptoLink().createHMAC(
-                            key_.getSecret(), key_.getSecretLength(),
-                            key_.getAlgorithm()),
-                        deleteHMAC));
+        return (key_.createHMAC());
     }
 
     // The following three are helper methods to compute the digest for
@@ -157,6 +151,9 @@ struct TSIGContext::TSIGContextImpl {
     // means the last message was signed. Special value -1 means there was no
     // signed message yet.
     int last_sig_dist_;
+    // The number of unsigned messages digested since the last signed one
+    // we sent.
+    int unsigned_sent_;
 };
 
 void
@@ -414,9 +411,28 @@ TSIGContext::sign(const uint16_t qid, const void* const data,
     // Exception free from now on.
     impl_->previous_digest_.swap(digest);
     impl_->state_ = (impl_->state_ == INIT) ? SENT_REQUEST : SENT_RESPONSE;
+    impl_->unsigned_sent_ = 0;
     return (tsig);
 }
 
+void
+TSIGContext::digestUnsigned(const void* const data, const size_t data_len) {
+    if (impl_->state_ != SENT_RESPONSE ||
+        impl_->error_ != TSIGError::NOERROR()) {
+        bundy_throw(TSIGContextError,
+                    "TSIG unsigned message not following a signed response");
+    }
+    if (impl_->unsigned_sent_ >= MAX_UNSIGNED_MESSAGES) {
+        bundy_throw(TSIGContextError, "Too many unsigned TSIG messages");
+    }
+    if (data == NULL || data_len == 0) {
+        bundy_throw(InvalidParameter, "TSIG digest error: empty data is given");
+    }
+
+    update(data, data_len);
+    ++impl_->unsigned_sent_;
+}
+
 TSIGError
 TSIGContext::verify(const TSIGRecord* const record, const void* const data,
                     const size_t data_len)
@@ -427,7 +443,8 @@ TSIGContext::verify(const TSIGRecord* const record, const void* const data,
     }
 
     if (record == NULL) {
-        if (impl_->last_sig_dist_ >= 0 && impl_->last_sig_dist_ < 99) {
+        if (impl_->last_sig_dist_ >= 0 &&
+            impl_->last_sig_dist_ < MAX_UNSIGNED_MESSAGES) {
             // It is not signed, but in the middle of TCP stream. We just
             // update the HMAC state and consider this message OK.
             update(data, data_len);
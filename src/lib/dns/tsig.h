@@ -353,6 +353,34 @@ public:
     TSIGError verify(const TSIGRecord* const record, const void* const data,
                      const size_t data_len);
 
+    /// \brief Digest a response that is sent without TSIG.
+    ///
+    /// RFC2845 Section 4.4 allows a server sending multiple messages on a
+    /// TCP stream (such as zone transfer responses) to sign only some of
+    /// them, as long as the last one is signed and there are at most
+    /// \c MAX_UNSIGNED_MESSAGES unsigned messages in a row.  Each unsigned
+    /// message must be passed to this method, which adds it to the HMAC
+    /// state without calculating a signature; the next \c sign() covers it.
+    /// The data is the complete, wire-format message as sent, so it can be
+    /// rendered once with \c Message::toWire() without a \c TSIGContext.
+    ///
+    /// This saves the calculation of the final digest and the TSIG RR for
+    /// each unsigned message.
+    ///
+    /// If this method throws because of a failure in the underlying crypto
+    /// operation, the context shouldn't be used any more.
+    ///
+    /// \exception TSIGContextError The context hasn't signed a response
+    /// (without TSIG error), or \c MAX_UNSIGNED_MESSAGES messages have
+    /// been digested since the last signed one.
+    /// \exception InvalidParameter \c data is NULL or \c data_len is 0
+    /// \exception cryptolink::LibraryError Some unexpected error in the
+    /// underlying crypto operation
+    ///
+    /// \param data Points to the wire-format message sent without TSIG
+    /// \param data_len The length of \c data in bytes
+    void digestUnsigned(const void* const data, const size_t data_len);
+
     /// \brief Check whether the last verified message was signed.
     ///
     /// RFC2845 allows for some of the messages not to be signed. However,
@@ -412,6 +440,11 @@ public:
     /// Right now fudge is not tunable, and all TSIGs generated by this API
     /// will have this value of fudge.
     static const uint16_t DEFAULT_FUDGE = 300;
+
+    /// The maximum number of consecutive unsigned messages in a signed TCP
+    /// stream, following RFC2845 Section 4.4 (which requires a TSIG at
+    /// least every 100 messages).
+    static const int MAX_UNSIGNED_MESSAGES = 99;
     //@}
 
 protected:
@@ -422,9 +455,8 @@ protected:
     /// used in tests, so it's protected instead of private, to allow tests
     /// in.
     ///
-    /// It doesn't contain sanity checks, and it is not tested directly. But
-    /// we may want to add these one day to allow generating the skipped TSIG
-    /// messages too. Until then, do not use this method.
+    /// It doesn't contain sanity checks, and it is not tested directly.  To
+    /// generate messages without TSIG, use \c digestUnsigned() instead.
     void update(const void* const data, size_t len);
 
 private:
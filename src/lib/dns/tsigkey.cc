@@ -20,11 +20,15 @@
 #include <exceptions/exceptions.h>
 
 #include <cryptolink/cryptolink.h>
+#include <cryptolink/crypto_hmac.h>
 
 #include <dns/name.h>
 #include <util/encode/base64.h>
+#include <util/threads/sync.h>
 #include <dns/tsigkey.h>
 
+#include <boost/noncopyable.hpp>
+
 using namespace std;
 using namespace bundy::cryptolink;
 
@@ -57,6 +61,71 @@ namespace {
 
         return (bundy::cryptolink::UNKNOWN_HASH);
     }
+
+    // HMAC objects of a key that are ready for reuse.  It's shared by the
+    // copies of the key, and by the HMAC objects in use (see HMACReleaser),
+    // so it lives as long as any of them.
+    class HMACPool : boost::noncopyable {
+    public:
+        // The maximum number of idle objects kept.  It only needs to be
+        // as large as the number of messages signed or verified with the
+        // key at the same time.
+        static const size_t MAX_IDLE = 8;
+
+        ~HMACPool() {
+            for (vector<HMAC*>::iterator it = idle_.begin();
+                 it != idle_.end();
+                 ++it) {
+                deleteHMAC(*it);
+            }
+        }
+
+        // Return an idle object, or NULL if there's none.
+        HMAC* get() {
+            bundy::util::thread::Mutex::Locker locker(mutex_);
+            if (idle_.empty()) {
+                return (NULL);
+            }
+            HMAC* hmac = idle_.back();
+            idle_.pop_back();
+            return (hmac);
+        }
+
+        // Keep an object for reuse, or delete it if we have enough.  The
+        // object must be ready for a new signature.
+        void put(HMAC* hmac) {
+            {
+                bundy::util::thread::Mutex::Locker locker(mutex_);
+                if (idle_.size() < MAX_IDLE) {
+                    idle_.push_back(hmac);
+                    return;
+                }
+            }
+            deleteHMAC(hmac);
+        }
+
+    private:
+        vector<HMAC*> idle_;
+        bundy::util::thread::Mutex mutex_;
+    };
+
+    // The deleter of the HMAC objects returned by TSIGKey::createHMAC(),
+    // which puts them back to the pool.
+    class HMACReleaser {
+    public:
+        HMACReleaser(const boost::shared_ptr<HMACPool>& pool) : pool_(pool) {}
+        void operator()(HMAC* hmac) {
+            try {
+                hmac->reset();
+                pool_->put(hmac);
+            } catch (...) {
+                // We can't know what state it's in; don't reuse it.
+                deleteHMAC(hmac);
+            }
+        }
+    private:
+        boost::shared_ptr<HMACPool> pool_;
+    };
 }
 
 struct
@@ -67,7 +136,8 @@ TSIGKey::TSIGKeyImpl {
         key_name_(key_name), algorithm_name_(algorithm_name),
         algorithm_(algorithm),
         secret_(static_cast<const uint8_t*>(secret),
-                static_cast<const uint8_t*>(secret) + secret_len)
+                static_cast<const uint8_t*>(secret) + secret_len),
+        hmac_pool_(new HMACPool)
     {
         // Convert the key and algorithm names to the canonical form.
         key_name_.downcase();
@@ -80,6 +150,8 @@ TSIGKey::TSIGKeyImpl {
     Name algorithm_name_;
     const bundy::cryptolink::HashAlgorithm algorithm_;
     const vector<uint8_t> secret_;
+    // Shared with the copies (the implicit copy constructor is used).
+    const boost::shared_ptr<HMACPool> hmac_pool_;
 };
 
 TSIGKey::TSIGKey(const Name& key_name, const Name& algorithm_name,
@@ -194,6 +266,18 @@ TSIGKey::getSecretLength() const {
     return (impl_->secret_.size());
 }
 
+boost::shared_ptr<HMAC>
+TSIGKey::createHMAC() const {
+    HMAC* hmac = impl_->hmac_pool_->get();
+    if (hmac == NULL) {
+        hmac = CryptoLink::getCryptoLink().createHMAC(getSecret(),
+                                                      getSecretLength(),
+                                                      getAlgorithm());
+    }
+    // If this throws, the HMAC is passed to the releaser.
+    return (boost::shared_ptr<HMAC>(hmac, HMACReleaser(impl_->hmac_pool_)));
+}
+
 std::string
 TSIGKey::toText() const {
     const vector<uint8_t> secret_v(static_cast<const uint8_t*>(getSecret()),
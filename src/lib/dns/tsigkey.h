@@ -17,6 +17,8 @@
 
 #include <cryptolink/cryptolink.h>
 
+#include <boost/shared_ptr.hpp>
+
 namespace bundy {
 namespace dns {
 
@@ -195,6 +197,28 @@ public:
     /// \return The string representation of the given TSIGKey.
     std::string toText() const;
 
+    /// \brief Create an HMAC object for signing or verifying with the key.
+    ///
+    /// Setting an HMAC object up for a key is relatively expensive, so
+    /// the key keeps a few of the objects that are no longer used and
+    /// returns one of them if available.  The copies of a key share them,
+    /// so the \c TSIGContext objects for the same key in a \c TSIGKeyRing
+    /// reuse the objects of the key in the ring.
+    ///
+    /// The returned object is ready for a new signature.  When the last
+    /// copy of the returned pointer is destroyed, the object is put back
+    /// for reuse, discarding any data added to it but not signed.
+    ///
+    /// This method is thread safe.
+    ///
+    /// \exception cryptolink::UnsupportedAlgorithm The algorithm of the
+    /// key is not supported.
+    /// \exception cryptolink::BadKey The secret of the key is invalid.
+    /// \exception std::bad_alloc Resource allocation failure
+    ///
+    /// \return A pointer to the HMAC object.
+    boost::shared_ptr<bundy::cryptolink::HMAC> createHMAC() const;
+
     ///
     /// \name Well known algorithm names as defined in RFC2845 and RFC4635.
     ///
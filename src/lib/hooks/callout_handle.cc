@@ -17,6 +17,7 @@
 #include <hooks/library_handle.h>
 #include <hooks/server_hooks.h>
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -29,9 +30,12 @@ namespace hooks {
 // Constructor.
 CalloutHandle::CalloutHandle(const boost::shared_ptr<CalloutManager>& manager,
                     const boost::shared_ptr<LibraryManagerCollection>& lmcoll)
-    : lm_collection_(lmcoll), arguments_(), context_collection_(),
-      manager_(manager), server_hooks_(ServerHooks::getServerHooks()),
-      skip_(false) {
+    : lm_collection_(lmcoll), arguments_(), argument_slots_(),
+      context_collection_(), manager_(manager),
+      server_hooks_(ServerHooks::getServerHooks()), skip_(false) {
+
+    // Create the slots for all the arguments registered so far.
+    argument_slots_.resize(server_hooks_.getArgumentCount());
 
     // Call the "context_create" hook.  We should be OK doing this - although
     // the constructor has not finished running, all the member variables
@@ -50,6 +54,7 @@ CalloutHandle::~CalloutHandle() {
     // Explicitly clear the argument and context objects.  This should free up
     // all memory that could have been allocated by libraries that were loaded.
     arguments_.clear();
+    argument_slots_.clear();
     context_collection_.clear();
 
     // Normal destruction of the remaining variables will include the
@@ -77,9 +82,57 @@ CalloutHandle::getArgumentNames() const {
         names.push_back(i->first);
     }
 
+    // Add the names of the arguments held in slots.
+    for (int slot = 0; slot < argument_slots_.size(); ++slot) {
+        if (!argument_slots_[slot].empty()) {
+            names.push_back(server_hooks_.getArgumentName(slot));
+        }
+    }
+
+    // Return the names in order, as if they were all held in the map.
+    sort(names.begin(), names.end());
+
     return (names);
 }
 
+// Delete an argument, wherever it is held.
+
+void
+CalloutHandle::deleteArgument(const std::string& name) {
+    int slot = server_hooks_.findArgumentIndex(name);
+    if ((slot >= 0) && (slot < argument_slots_.size())) {
+        argument_slots_[slot] = boost::any();
+    } else {
+        static_cast<void>(arguments_.erase(name));
+    }
+}
+
+// Delete all arguments.  The slots are emptied rather than removed, so they
+// can be reused by the next hook without reallocating the array.
+
+void
+CalloutHandle::deleteAllArguments() {
+    arguments_.clear();
+    for (ArgumentSlots::iterator i = argument_slots_.begin();
+         i != argument_slots_.end(); ++i) {
+        *i = boost::any();
+    }
+}
+
+// Enlarge the array of argument slots to cover an argument registered after
+// the handle was created.
+
+boost::any&
+CalloutHandle::resizeArgumentSlots(int slot) {
+    if ((slot < 0) || (slot >= server_hooks_.getArgumentCount())) {
+        bundy_throw(NoSuchArgument, "argument slot " << slot <<
+                  " is not recognised");
+    }
+
+    argument_slots_.resize(server_hooks_.getArgumentCount());
+    return (argument_slots_[slot]);
+}
+
 // Return the library handle allowing the callout to access the CalloutManager
 // registration/deregistration functions.
 
@@ -17,6 +17,7 @@
 
 #include <exceptions/exceptions.h>
 #include <hooks/library_handle.h>
+#include <hooks/server_hooks.h>
 
 #include <boost/any.hpp>
 #include <boost/shared_ptr.hpp>
@@ -28,18 +29,6 @@
 namespace bundy {
 namespace hooks {
 
-class ServerHooks;
-
-/// @brief No such argument
-///
-/// Thrown if an attempt is made access an argument that does not exist.
-
-class NoSuchArgument : public Exception {
-public:
-    NoSuchArgument(const char* file, size_t line, const char* what) :
-        bundy::Exception(file, line, what) {}
-};
-
 /// @brief No such callout context item
 ///
 /// Thrown if an attempt is made to get an item of data from this callout's
@@ -70,6 +59,9 @@ class LibraryManagerCollection;
 ///   are passed information by the server (and can return information to it)
 ///   through name/value pairs.  Each of these pairs is an argument and the
 ///   information is accessed through the {get,set}Argument() methods.
+///   Arguments whose names have been registered with
+///   ServerHooks::registerArgument() are held in a fixed array of slots and
+///   can also be accessed by the slot number, avoiding the name lookup.
 ///
 /// - Per-packet context.  Each packet has a context associated with it, this
 ///   context being  on a per-library basis.  In other words, As a packet passes
@@ -96,6 +88,11 @@ public:
     /// corresponding value associated with it.
     typedef std::map<std::string, boost::any> ElementCollection;
 
+    /// Typedef for the arguments held in slots.  The index is the slot number
+    /// assigned to the argument by ServerHooks::registerArgument(); an empty
+    /// value means that the argument is not present.
+    typedef std::vector<boost::any> ArgumentSlots;
+
     /// Typedef to allow abbreviations in specifications when accessing
     /// context.  The ElementCollection is the name/value collection for
     /// a particular context.  The "int" corresponds to the index of an
@@ -145,7 +142,27 @@ public:
     /// @param value Value to set.  That can be of any data type.
     template <typename T>
     void setArgument(const std::string& name, T value) {
-        arguments_[name] = value;
+        int slot = server_hooks_.findArgumentIndex(name);
+        if (slot >= 0) {
+            getArgumentSlot(slot) = value;
+        } else {
+            arguments_[name] = value;
+        }
+    }
+
+    /// @brief Set argument by slot
+    ///
+    /// Sets the value of an argument whose name has been registered with
+    /// ServerHooks::registerArgument().  The argument can then be accessed
+    /// by either the slot number or the name.
+    ///
+    /// @param slot Slot number of the argument.
+    /// @param value Value to set.  That can be of any data type.
+    ///
+    /// @throw NoSuchArgument The slot number is not valid.
+    template <typename T>
+    void setArgument(int slot, T value) {
+        getArgumentSlot(slot) = value;
     }
 
     /// @brief Get argument
@@ -162,6 +179,17 @@ public:
     ///        the variable provided to receive the value.
     template <typename T>
     void getArgument(const std::string& name, T& value) const {
+        int slot = server_hooks_.findArgumentIndex(name);
+        if (slot >= 0) {
+            if ((slot >= argument_slots_.size()) ||
+                argument_slots_[slot].empty()) {
+                bundy_throw(NoSuchArgument, "unable to find argument with "
+                          "name " << name);
+            }
+            value = boost::any_cast<T>(argument_slots_[slot]);
+            return;
+        }
+
         ElementCollection::const_iterator element_ptr = arguments_.find(name);
         if (element_ptr == arguments_.end()) {
             bundy_throw(NoSuchArgument, "unable to find argument with name " <<
@@ -171,6 +199,31 @@ public:
         value = boost::any_cast<T>(element_ptr->second);
     }
 
+    /// @brief Get argument by slot
+    ///
+    /// Gets the value of an argument whose name has been registered with
+    /// ServerHooks::registerArgument().
+    ///
+    /// @param slot Slot number of the argument.
+    /// @param value [out] Value to set.  The type of "value" is important:
+    ///        it must match the type of the value set.
+    ///
+    /// @throw NoSuchArgument The slot number is not valid or the argument
+    ///        is not present.
+    /// @throw boost::bad_any_cast The argument is present, but the data type
+    ///        of the value is not the same as the type of the variable
+    ///        provided to receive the value.
+    template <typename T>
+    void getArgument(int slot, T& value) const {
+        if ((slot < 0) || (slot >= argument_slots_.size()) ||
+            argument_slots_[slot].empty()) {
+            bundy_throw(NoSuchArgument, "unable to find argument in slot " <<
+                      slot);
+        }
+
+        value = boost::any_cast<T>(argument_slots_[slot]);
+    }
+
     /// @brief Get argument names
     ///
     /// Returns a vector holding the names of arguments in the argument
@@ -188,9 +241,7 @@ public:
     /// by this method.
     ///
     /// @param name Name of the element in the argument list to set.
-    void deleteArgument(const std::string& name) {
-        static_cast<void>(arguments_.erase(name));
-    }
+    void deleteArgument(const std::string& name);
 
     /// @brief Delete all arguments
     ///
@@ -198,9 +249,7 @@ public:
     ///
     /// N.B. If any elements are raw pointers, the pointed-to data is NOT
     /// deleted by this method.
-    void deleteAllArguments() {
-        arguments_.clear();
-    }
+    void deleteAllArguments();
 
     /// @brief Set skip flag
     ///
@@ -319,6 +368,35 @@ public:
     std::string getHookName() const;
 
 private:
+    /// @brief Return reference to argument slot
+    ///
+    /// Returns the slot of the given number, enlarging the array of slots if
+    /// the argument was registered after the handle had been created.
+    ///
+    /// @param slot Slot number of the argument.
+    ///
+    /// @return Reference to the value held in the slot.
+    ///
+    /// @throw NoSuchArgument The slot number is not valid.
+    boost::any& getArgumentSlot(int slot) {
+        if ((slot >= 0) && (slot < argument_slots_.size())) {
+            return (argument_slots_[slot]);
+        }
+        return (resizeArgumentSlots(slot));
+    }
+
+    /// @brief Enlarge the array of argument slots
+    ///
+    /// Called by getArgumentSlot() when the slot number is outside of the
+    /// array.
+    ///
+    /// @param slot Slot number of the argument.
+    ///
+    /// @return Reference to the value held in the slot.
+    ///
+    /// @throw NoSuchArgument The slot number is not valid.
+    boost::any& resizeArgumentSlots(int slot);
+
     /// @brief Check index
     ///
     /// Gets the current library index, throwing an exception if it is not set
@@ -365,6 +443,9 @@ private:
     /// Collection of arguments passed to the callouts
     ElementCollection arguments_;
 
+    /// Arguments passed to the callouts which have slots assigned
+    ArgumentSlots argument_slots_;
+
     /// Context collection - there is one entry per library context.
     ContextCollection context_collection_;
 
@@ -78,13 +78,13 @@ CalloutManager::registerCallout(const std::string& name, CalloutPtr callout) {
     // Iterate through the callout vector for the hook from start to end,
     // looking for the first entry where the library index is greater than
     // the present index.
-    for (CalloutVector::iterator i = hook_vector_[hook_index].begin();
-         i != hook_vector_[hook_index].end(); ++i) {
+    CalloutVector& callouts = getModifiableCallouts(hook_index);
+    for (CalloutVector::iterator i = callouts.begin(); i != callouts.end();
+         ++i) {
         if (i->first > current_library_) {
             // Found an element whose library index number is greater than the
             // current index, so insert the new element ahead of this one.
-            hook_vector_[hook_index].insert(i, make_pair(current_library_,
-                                                         callout));
+            callouts.insert(i, make_pair(current_library_, callout));
             return;
         }
     }
@@ -92,7 +92,23 @@ CalloutManager::registerCallout(const std::string& name, CalloutPtr callout) {
     // Reached the end of the vector, so there is no element in the (possibly
     // empty) set of callouts with a library index greater than the current
     // library index.  Inset the callout at the end of the list.
-    hook_vector_[hook_index].push_back(make_pair(current_library_, callout));
+    callouts.push_back(make_pair(current_library_, callout));
+}
+
+// Get the callout vector for a hook, ready to be modified.  If callCallouts()
+// holds a reference to the current vector, it is left to it and the hook gets
+// a copy instead.
+
+CalloutManager::CalloutVector&
+CalloutManager::getModifiableCallouts(int hook_index) {
+    CalloutVectorPtr& callouts = hook_vector_[hook_index];
+    if (!callouts) {
+        callouts.reset(new CalloutVector());
+    } else if (!callouts.unique()) {
+        callouts.reset(new CalloutVector(*callouts));
+    }
+
+    return (*callouts);
 }
 
 // Check if callouts are present for a given hook index.
@@ -106,7 +122,7 @@ CalloutManager::calloutsPresent(int hook_index) const {
     }
 
     // Valid, so are there any callouts associated with that hook?
-    return (!hook_vector_[hook_index].empty());
+    return (hook_vector_[hook_index] && !hook_vector_[hook_index]->empty());
 }
 
 // Call all the callouts for a given hook.
@@ -127,16 +143,18 @@ CalloutManager::callCallouts(int hook_index, CalloutHandle& callout_handle) {
         // determine to what hook it is attached.
         current_hook_ = hook_index;
 
-        // Duplicate the callout vector for this hook and work through that.
-        // This step is needed because we allow dynamic registration and
-        // deregistration of callouts.  If a callout attached to a hook modified
-        // the list of callouts on that hook, the underlying CalloutVector would
-        // change and potentially affect the iteration through that vector.
-        CalloutVector callouts(hook_vector_[hook_index]);
+        // Take a reference to the callout vector for this hook and work
+        // through that.  This step is needed because we allow dynamic
+        // registration and deregistration of callouts.  If a callout attached
+        // to a hook modified the list of callouts on that hook, it would do
+        // so on a copy of the vector (see getModifiableCallouts()), leaving
+        // the vector being iterated through unaffected.  Unlike copying the
+        // vector on each call, this costs nothing unless the callouts change.
+        CalloutVectorPtr callouts(hook_vector_[hook_index]);
 
         // Call all the callouts.
-        for (CalloutVector::const_iterator i = callouts.begin();
-             i != callouts.end(); ++i) {
+        for (CalloutVector::const_iterator i = callouts->begin();
+             i != callouts->end(); ++i) {
             // In case the callout tries to register or deregister a callout,
             // set the current library index to the index associated with the
             // library that registered the callout being called.
@@ -189,10 +207,16 @@ CalloutManager::deregisterCallout(const std::string& name, CalloutPtr callout) {
     /// we want to remove.
     CalloutEntry target(current_library_, callout);
 
+    // Nothing to do if no callouts have been registered on the hook.
+    if (!hook_vector_[hook_index]) {
+        return (false);
+    }
+    CalloutVector& callouts = getModifiableCallouts(hook_index);
+
     /// To decide if any entries were removed, we'll record the initial size
     /// of the callout vector for the hook, and compare it with the size after
     /// the removal.
-    size_t initial_size = hook_vector_[hook_index].size();
+    size_t initial_size = callouts.size();
 
     // The next bit is standard STL (see "Item 33" in "Effective STL" by
     // Scott Meyers).
@@ -203,14 +227,12 @@ CalloutManager::deregisterCallout(const std::string& name, CalloutPtr callout) {
     // is equal to the value of the passed callout.)  The erase() call
     // removes everything from that element to the end of the vector, i.e.
     // all the matching elements.
-    hook_vector_[hook_index].erase(remove_if(hook_vector_[hook_index].begin(),
-                                             hook_vector_[hook_index].end(),
-                                             bind1st(equal_to<CalloutEntry>(),
-                                                     target)),
-                                   hook_vector_[hook_index].end());
+    callouts.erase(remove_if(callouts.begin(), callouts.end(),
+                             bind1st(equal_to<CalloutEntry>(), target)),
+                   callouts.end());
 
     // Return an indication of whether anything was removed.
-    bool removed = initial_size != hook_vector_[hook_index].size();
+    bool removed = initial_size != callouts.size();
     if (removed) {
         LOG_DEBUG(hooks_logger, HOOKS_DBG_EXTENDED_CALLS,
                   HOOKS_CALLOUT_DEREGISTERED).arg(current_library_).arg(name);
@@ -232,20 +254,24 @@ CalloutManager::deregisterAllCallouts(const std::string& name) {
     /// pointer is NULL as we are not checking that).
     CalloutEntry target(current_library_, NULL);
 
+    // Nothing to do if no callouts have been registered on the hook.
+    if (!hook_vector_[hook_index]) {
+        return (false);
+    }
+    CalloutVector& callouts = getModifiableCallouts(hook_index);
+
     /// To decide if any entries were removed, we'll record the initial size
     /// of the callout vector for the hook, and compare it with the size after
     /// the removal.
-    size_t initial_size = hook_vector_[hook_index].size();
+    size_t initial_size = callouts.size();
 
     // Remove all callouts matching this library.
-    hook_vector_[hook_index].erase(remove_if(hook_vector_[hook_index].begin(),
-                                             hook_vector_[hook_index].end(),
-                                             bind1st(CalloutLibraryEqual(),
-                                                     target)),
-                                   hook_vector_[hook_index].end());
+    callouts.erase(remove_if(callouts.begin(), callouts.end(),
+                             bind1st(CalloutLibraryEqual(), target)),
+                   callouts.end());
 
     // Return an indication of whether anything was removed.
-    bool removed = initial_size != hook_vector_[hook_index].size();
+    bool removed = initial_size != callouts.size();
     if (removed) {
         LOG_DEBUG(hooks_logger, HOOKS_DBG_EXTENDED_CALLS,
                   HOOKS_ALL_CALLOUTS_DEREGISTERED).arg(current_library_)
@@ -123,6 +123,11 @@ private:
     /// associated with a given hook.
     typedef std::vector<CalloutEntry> CalloutVector;
 
+    /// Pointer to the vector of callouts associated with a given hook.  The
+    /// vector is shared with callCallouts() while the callouts are being
+    /// called, and is copied only if it is modified at that time.
+    typedef boost::shared_ptr<CalloutVector> CalloutVectorPtr;
+
 public:
 
     /// @brief Constructor
@@ -319,6 +324,18 @@ private:
     /// @throw NoSuchLibrary Library index is not valid.
     void checkLibraryIndex(int library_index) const;
 
+    /// @brief Get callouts for modification
+    ///
+    /// Returns the vector of callouts associated with a hook so that it can
+    /// be modified.  If the vector is being iterated through by callCallouts()
+    /// (a callout is registering or deregistering callouts), the hook is
+    /// given a copy of the vector so as not to disturb the iteration.
+    ///
+    /// @param hook_index Index of the hook.
+    ///
+    /// @return Reference to the vector of callouts for the hook.
+    CalloutVector& getModifiableCallouts(int hook_index);
+
     /// @brief Compare two callout entries for library equality
     ///
     /// This is used in callout removal code when all callouts on a hook for a
@@ -356,9 +373,10 @@ private:
     int current_library_;
 
     /// Vector of callout vectors.  There is one entry in this outer vector for
-    /// each hook. Each element is itself a vector, with one entry for each
-    /// callout registered for that hook.
-    std::vector<CalloutVector> hook_vector_;
+    /// each hook. Each element points to a vector, with one entry for each
+    /// callout registered for that hook, or is null if no callouts have ever
+    /// been registered for it.
+    std::vector<CalloutVectorPtr> hook_vector_;
 
     /// LibraryHandle object user by the callout to access the callout
     /// registration methods on this CalloutManager object.  The object is set
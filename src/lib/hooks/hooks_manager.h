@@ -171,6 +171,19 @@ public:
     ///         registered.
     static int registerHook(const std::string& name);
 
+    /// @brief Register Argument
+    ///
+    /// This is just a convenience shell around the
+    /// ServerHooks::registerArgument() method.  The slot number returned can
+    /// be passed to CalloutHandle::setArgument() and getArgument() in place of
+    /// the argument name, which saves looking up the name on every call.
+    ///
+    /// @param name Name of the argument
+    ///
+    /// @return Slot number of the argument.  The same number is returned if
+    ///         the argument has already been registered.
+    static int registerArgument(const std::string& name);
+
     /// @brief Return list of loaded libraries
     ///
     /// Returns the names of the loaded libraries.
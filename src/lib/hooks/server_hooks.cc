@@ -76,6 +76,10 @@ ServerHooks::initialize() {
     hooks_.clear();
     inverse_hooks_.clear();
 
+    // ... and the argument slots.
+    arguments_.clear();
+    argument_names_.clear();
+
     // Register the pre-defined hooks.
     int create = registerHook("context_create");
     int destroy = registerHook("context_destroy");
@@ -146,6 +150,52 @@ ServerHooks::getHookNames() const {
     return (names);
 }
 
+// Register an argument.  As with hooks, the slot assigned to the argument is
+// the current number of entries in the collection.  Registering a name again
+// returns the slot already assigned to it.
+
+int
+ServerHooks::registerArgument(const string& name) {
+
+    int index = argument_names_.size();
+    pair<ArgumentCollection::iterator, bool> result =
+        arguments_.insert(make_pair(name, index));
+
+    if (result.second) {
+        // New element was inserted, so add it to the inverse collection.
+        argument_names_.push_back(name);
+    }
+
+    return (result.first->second);
+}
+
+// Find the slot associated with an argument name.
+
+int
+ServerHooks::getArgumentIndex(const string& name) const {
+
+    int index = findArgumentIndex(name);
+    if (index < 0) {
+        bundy_throw(NoSuchArgument, "argument name " << name <<
+                  " is not registered");
+    }
+
+    return (index);
+}
+
+// Find the name associated with an argument slot.
+
+const std::string&
+ServerHooks::getArgumentName(int index) const {
+
+    if ((index < 0) || (index >= argument_names_.size())) {
+        bundy_throw(NoSuchArgument, "argument slot " << index <<
+                  " is not recognised");
+    }
+
+    return (argument_names_[index]);
+}
+
 // Return global ServerHooks object
 
 ServerHooks&
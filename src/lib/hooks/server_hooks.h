@@ -46,6 +46,15 @@ public:
 };
 
 
+/// @brief No such argument
+///
+/// Thrown if an attempt is made access an argument that does not exist.
+class NoSuchArgument : public Exception {
+public:
+    NoSuchArgument(const char* file, size_t line, const char* what) :
+        bundy::Exception(file, line, what) {}
+};
+
 /// @brief Server hook collection
 ///
 /// This class is used by the server-side code to register hooks - points in the
@@ -60,6 +69,15 @@ public:
 /// will speed up the time taken to locate the callouts, which may make a
 /// difference in a frequently-executed piece of code.)
 ///
+/// In the same way, the names of the arguments passed to the callouts may be
+/// registered, each being assigned a unique slot number.  The server code
+/// then passes the arguments to the CalloutHandle by slot, which stores them
+/// in a fixed array rather than in a map keyed by the name.  The callouts may
+/// still access the arguments by name: the name is translated to the slot
+/// number.  Unlike hooks, an argument name may be registered more than once
+/// (the same argument is usually passed to several hooks), in which case the
+/// same slot number is returned.
+///
 /// ServerHooks is a singleton object and is only accessible by the static
 /// method getServerHooks().
 
@@ -73,9 +91,9 @@ public:
     /// @brief Reset to Initial State
     ///
     /// Resets the collection of hooks to the initial state, with just the
-    /// context_create and context_destroy hooks set.  This used during
-    /// testing to reset the global ServerHooks object; it should never be
-    /// used in production.
+    /// context_create and context_destroy hooks set and no argument slots.
+    /// This used during testing to reset the global ServerHooks object; it
+    /// should never be used in production.
     ///
     /// @throws bundy::Unexpected if the registration of the pre-defined hooks
     ///         fails in some way.
@@ -134,6 +152,61 @@ public:
     /// @return Vector of strings holding hook names.
     std::vector<std::string> getHookNames() const;
 
+    /// @brief Register an argument
+    ///
+    /// Assigns a slot to the argument of the given name, returning the slot
+    /// number already assigned if the argument has been registered before.
+    ///
+    /// @param name Name of the argument
+    ///
+    /// @return Slot number of the argument, to be used with the slot-based
+    ///         CalloutHandle::setArgument() and getArgument() methods.  This
+    ///         will be greater than or equal to zero.
+    int registerArgument(const std::string& name);
+
+    /// @brief Get argument slot
+    ///
+    /// Returns the slot number assigned to an argument.
+    ///
+    /// @param name Name of the argument
+    ///
+    /// @return Slot number of the argument.
+    ///
+    /// @throw NoSuchArgument if no slot has been assigned to the argument.
+    int getArgumentIndex(const std::string& name) const;
+
+    /// @brief Find argument slot
+    ///
+    /// Returns the slot number assigned to an argument or a negative value if
+    /// no slot has been assigned to it.  This is used by the name-based
+    /// argument methods of the CalloutHandle.
+    ///
+    /// @param name Name of the argument
+    ///
+    /// @return Slot number of the argument or -1.
+    int findArgumentIndex(const std::string& name) const {
+        ArgumentCollection::const_iterator i = arguments_.find(name);
+        return (i == arguments_.end() ? -1 : i->second);
+    }
+
+    /// @brief Get argument name
+    ///
+    /// Returns the name of the argument assigned to a slot.
+    ///
+    /// @param index Slot number of the argument
+    ///
+    /// @return Name of the argument.
+    ///
+    /// @throw NoSuchArgument if the slot number is invalid.
+    const std::string& getArgumentName(int index) const;
+
+    /// @brief Return number of argument slots
+    ///
+    /// @return Number of argument slots assigned.
+    int getArgumentCount() const {
+        return (argument_names_.size());
+    }
+
     /// @brief Return ServerHooks object
     ///
     /// Returns the global ServerHooks object.
@@ -175,6 +248,11 @@ private:
     /// simpler than using a multi-indexed container.)
     HookCollection  hooks_;                 ///< Hook name/index collection
     InverseHookCollection inverse_hooks_;   ///< Hook index/name collection
+
+    /// Argument name/slot collection and the names indexed by slot.
+    typedef std::map<std::string, int> ArgumentCollection;
+    ArgumentCollection arguments_;          ///< Argument name/slot collection
+    std::vector<std::string> argument_names_; ///< Argument slot/name collection
 };
 
 } // namespace util
@@ -307,6 +307,67 @@ TEST_F(CalloutHandleTest, DeleteAllArguments) {
     EXPECT_THROW(handle.getArgument("four", value), NoSuchArgument);
 }
 
+// Test that the arguments registered with the ServerHooks are held in slots
+// and can be accessed by both the slot number and the name.
+
+TEST_F(CalloutHandleTest, ArgumentSlots) {
+    ServerHooks& hooks = ServerHooks::getServerHooks();
+    int one = hooks.registerArgument("slot_one");
+    int two = hooks.registerArgument("slot_two");
+
+    CalloutHandle handle(getCalloutManager());
+    int value = 0;
+
+    // Set by slot, get by slot or name.
+    handle.setArgument(one, 1);
+    handle.getArgument(one, value);
+    EXPECT_EQ(1, value);
+    handle.getArgument("slot_one", value);
+    EXPECT_EQ(1, value);
+
+    // Set by name, get by slot.
+    handle.setArgument("slot_two", 2);
+    handle.getArgument(two, value);
+    EXPECT_EQ(2, value);
+
+    // Arguments held in slots and in the map are both listed.
+    handle.setArgument("other", 3);
+    vector<string> expected;
+    expected.push_back("other");
+    expected.push_back("slot_one");
+    expected.push_back("slot_two");
+    EXPECT_TRUE(expected == handle.getArgumentNames());
+
+    // Wrong type.
+    string text;
+    EXPECT_THROW(handle.getArgument(one, text), boost::bad_any_cast);
+
+    // Deletion works on the slots.
+    handle.deleteArgument("slot_one");
+    EXPECT_THROW(handle.getArgument(one, value), NoSuchArgument);
+    EXPECT_THROW(handle.getArgument("slot_one", value), NoSuchArgument);
+    handle.getArgument(two, value);
+    EXPECT_EQ(2, value);
+
+    handle.deleteAllArguments();
+    EXPECT_THROW(handle.getArgument(two, value), NoSuchArgument);
+    EXPECT_THROW(handle.getArgument("other", value), NoSuchArgument);
+    EXPECT_TRUE(handle.getArgumentNames().empty());
+
+    // An argument registered after the handle was created can be used too.
+    int three = hooks.registerArgument("slot_three");
+    handle.setArgument(three, 3);
+    handle.getArgument("slot_three", value);
+    EXPECT_EQ(3, value);
+
+    // Invalid slots are rejected.
+    EXPECT_THROW(handle.setArgument(-1, 1), NoSuchArgument);
+    EXPECT_THROW(handle.setArgument(hooks.getArgumentCount(), 1),
+                 NoSuchArgument);
+    EXPECT_THROW(handle.getArgument(hooks.getArgumentCount(), value),
+                 NoSuchArgument);
+}
+
 // Test the "skip" flag.
 
 TEST_F(CalloutHandleTest, SkipFlag) {
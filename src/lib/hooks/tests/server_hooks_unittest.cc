@@ -175,4 +175,36 @@ TEST(ServerHooksTest, HookCount) {
     EXPECT_EQ(6, hooks.getCount());
 }
 
+// Check that arguments are assigned slots, and that registering the same
+// argument again returns the same slot.
+
+TEST(ServerHooksTest, RegisterArguments) {
+    ServerHooks& hooks = ServerHooks::getServerHooks();
+    hooks.reset();
+    EXPECT_EQ(0, hooks.getArgumentCount());
+
+    int alpha = hooks.registerArgument("alpha");
+    int beta = hooks.registerArgument("beta");
+    EXPECT_EQ(0, alpha);
+    EXPECT_EQ(1, beta);
+    EXPECT_EQ(alpha, hooks.registerArgument("alpha"));
+    EXPECT_EQ(2, hooks.getArgumentCount());
+
+    EXPECT_EQ(beta, hooks.getArgumentIndex("beta"));
+    EXPECT_EQ(beta, hooks.findArgumentIndex("beta"));
+    EXPECT_EQ(string("alpha"), hooks.getArgumentName(alpha));
+
+    // Check that the unknown arguments are reported.
+    EXPECT_THROW(static_cast<void>(hooks.getArgumentIndex("gamma")),
+                 NoSuchArgument);
+    EXPECT_EQ(-1, hooks.findArgumentIndex("gamma"));
+    EXPECT_THROW(static_cast<void>(hooks.getArgumentName(-1)), NoSuchArgument);
+    EXPECT_THROW(static_cast<void>(hooks.getArgumentName(2)), NoSuchArgument);
+
+    // Argument slots are independent of the hooks and are cleared on reset.
+    EXPECT_EQ(2, hooks.getCount());
+    hooks.reset();
+    EXPECT_EQ(0, hooks.getArgumentCount());
+}
+
 } // Anonymous namespace
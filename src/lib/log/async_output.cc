@@ -0,0 +1,339 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <log/async_output.h>
+#include <log/log_formatter.h>
+#include <log/log_messages.h>
+#include <log/logger_name.h>
+#include <log/message_dictionary.h>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <cstddef>
+#include <sched.h>
+
+using namespace std;
+using bundy::util::thread::Mutex;
+using bundy::util::thread::Thread;
+
+namespace {
+
+// Maximum number of messages passed to the writer at once.  It bounds the
+// time the writer holds the locks around the output.
+const size_t MAX_BATCH_SIZE = 256;
+
+} // Anonymous namespace
+
+namespace bundy {
+namespace log {
+
+const size_t AsyncOutput::DEFAULT_QUEUE_SIZE;
+
+AsyncOutput::AsyncOutput() :
+    cells_(), mask_(0), enqueue_pos_(0), dequeue_pos_(0), written_(0),
+    dropped_(0), reported_dropped_(0), users_(0), waiters_(0),
+    sleeping_(false), running_(false), stopping_(false), policy_(DROP)
+{
+}
+
+AsyncOutput::~AsyncOutput() {
+    stop();
+}
+
+void
+AsyncOutput::start(const Writer& writer, size_t queue_size,
+                   OverflowPolicy policy)
+{
+    if (running_ || thread_) {
+        bundy_throw(AsyncOutputError, "asynchronous log output is already "
+                    "running");
+    }
+    if (!writer) {
+        bundy_throw(AsyncOutputError, "no writer given for the asynchronous "
+                    "log output");
+    }
+    if (queue_size == 0) {
+        bundy_throw(AsyncOutputError, "queue size of the asynchronous log "
+                    "output must be greater than zero");
+    }
+
+    // Round the size up to a power of two, so the slot index is given by
+    // masking the position.  Each slot is initially ready for the position
+    // equal to its index.
+    size_t size = 1;
+    while (size < queue_size) {
+        size <<= 1;
+    }
+    cells_.clear();
+    cells_.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        cells_[i].sequence_ = i;
+    }
+    mask_ = size - 1;
+    enqueue_pos_ = 0;
+    dequeue_pos_ = 0;
+    written_ = 0;
+    dropped_ = 0;
+    reported_dropped_ = 0;
+    sleeping_ = false;
+    stopping_ = false;
+    policy_ = policy;
+    writer_ = writer;
+
+    thread_.reset(new Thread(boost::bind(&AsyncOutput::run, this)));
+
+    // Only accept messages once everything is set up.
+    __sync_synchronize();
+    running_ = true;
+}
+
+void
+AsyncOutput::stop() {
+    if (!thread_) {
+        return;
+    }
+
+    // Stop accepting messages, and wait for the threads which may have seen
+    // the output running to finish queueing theirs.
+    running_ = false;
+    __sync_synchronize();
+    while (users_ > 0) {
+        sched_yield();
+    }
+
+    // Let the background thread write what's left and exit.
+    {
+        Mutex::Locker lock(mutex_);
+        stopping_ = true;
+        ready_cond_.signal();
+    }
+    thread_->wait();
+    thread_.reset();
+    writer_.clear();
+}
+
+bool
+AsyncOutput::output(const string& logger, const Severity& severity,
+                    const string& text, const string& thread)
+{
+    __sync_fetch_and_add(&users_, 1);
+    bool accepted = false;
+    if (running_) {
+        accepted = true;
+        // The message is stamped now, not when it's written.
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        bool queued = push(logger, severity, text, thread, now);
+        if (!queued) {
+            if (policy_ == BLOCK) {
+                Mutex::Locker lock(mutex_);
+                ++waiters_;
+                __sync_synchronize();
+                while (!push(logger, severity, text, thread, now)) {
+                    written_cond_.wait(mutex_);
+                }
+                --waiters_;
+                queued = true;
+            } else {
+                __sync_fetch_and_add(&dropped_, 1);
+            }
+        }
+        if (queued) {
+            wakeUp();
+        }
+    }
+    __sync_fetch_and_sub(&users_, 1);
+
+    return (accepted);
+}
+
+void
+AsyncOutput::flush() {
+    if (!running_) {
+        return;
+    }
+
+    // Every position below the current write position has been claimed by
+    // a message which will eventually be written.
+    const size_t target = enqueue_pos_;
+
+    Mutex::Locker lock(mutex_);
+    ++waiters_;
+    __sync_synchronize();
+    while (static_cast<ptrdiff_t>(written_ - target) < 0) {
+        written_cond_.wait(mutex_);
+    }
+    --waiters_;
+}
+
+bool
+AsyncOutput::push(const string& logger, const Severity& severity,
+                  const string& text, const string& thread,
+                  const struct timeval& time)
+{
+    // Claim a slot by advancing the write position.  The slot is free if its
+    // sequence number equals the position; if it is lower, the slot still
+    // holds the message written a full round earlier, i.e. the queue is full.
+    size_t pos = enqueue_pos_;
+    for (;;) {
+        const Cell& cell = cells_[pos & mask_];
+        const size_t seq = cell.sequence_;
+        __sync_synchronize();
+        const ptrdiff_t diff = static_cast<ptrdiff_t>(seq - pos);
+        if (diff == 0) {
+            if (__sync_bool_compare_and_swap(&enqueue_pos_, pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return (false);
+        }
+        pos = enqueue_pos_;
+    }
+
+    // Fill the slot and publish it to the background thread.
+    Cell& cell = cells_[pos & mask_];
+    cell.message_.logger_ = logger;
+    cell.message_.severity_ = severity;
+    cell.message_.text_ = text;
+    cell.message_.thread_ = thread;
+    cell.message_.time_ = time;
+    __sync_synchronize();
+    cell.sequence_ = pos + 1;
+
+    return (true);
+}
+
+bool
+AsyncOutput::pop(MessageBatch& batch) {
+    Cell& cell = cells_[dequeue_pos_ & mask_];
+    const size_t seq = cell.sequence_;
+    __sync_synchronize();
+    if (seq != dequeue_pos_ + 1) {
+        return (false);
+    }
+
+    // Move the message out of the slot rather than copying it, then hand the
+    // slot back to the writers for the next round.
+    batch.push_back(Message());
+    Message& message = batch.back();
+    message.logger_.swap(cell.message_.logger_);
+    message.severity_ = cell.message_.severity_;
+    message.text_.swap(cell.message_.text_);
+    message.thread_.swap(cell.message_.thread_);
+    message.time_ = cell.message_.time_;
+    __sync_synchronize();
+    cell.sequence_ = dequeue_pos_ + mask_ + 1;
+    ++dequeue_pos_;
+
+    return (true);
+}
+
+bool
+AsyncOutput::ready() const {
+    const Cell& cell = cells_[dequeue_pos_ & mask_];
+    const size_t seq = cell.sequence_;
+    __sync_synchronize();
+    return (seq == dequeue_pos_ + 1);
+}
+
+void
+AsyncOutput::wakeUp() {
+    // The background thread sets the flag before checking for messages one
+    // last time, so either it sees the message or we see the flag.
+    __sync_synchronize();
+    if (sleeping_) {
+        Mutex::Locker lock(mutex_);
+        ready_cond_.signal();
+    }
+}
+
+void
+AsyncOutput::reportDropped(MessageBatch& batch) {
+    const uint64_t dropped = dropped_;
+    if (dropped == reported_dropped_) {
+        return;
+    }
+
+    batch.push_back(Message());
+    Message& message = batch.back();
+    message.logger_ = expandLoggerName("log");
+    message.severity_ = WARN;
+    gettimeofday(&message.time_, NULL);
+    message.text_ = string(LOG_ASYNC_MESSAGES_DROPPED) + " " +
+        MessageDictionary::globalDictionary().getText(
+            LOG_ASYNC_MESSAGES_DROPPED);
+    replacePlaceholder(&message.text_,
+                       boost::lexical_cast<string>(dropped - reported_dropped_),
+                       1);
+    reported_dropped_ = dropped;
+}
+
+void
+AsyncOutput::run() {
+    MessageBatch batch;
+    batch.reserve(MAX_BATCH_SIZE + 1);
+
+    for (;;) {
+        batch.clear();
+        while ((batch.size() < MAX_BATCH_SIZE) && pop(batch)) {
+            ;
+        }
+        const size_t count = batch.size();
+        reportDropped(batch);
+
+        if (!batch.empty()) {
+            try {
+                writer_(batch);
+            } catch (...) {
+                // There is nowhere to report the failure to: the messages
+                // are lost, but the output carries on.
+            }
+
+            // Let the threads waiting for room or for a flush check again.
+            written_ += count;
+            __sync_synchronize();
+            if (waiters_ > 0) {
+                Mutex::Locker lock(mutex_);
+                written_cond_.broadcast();
+            }
+            continue;
+        }
+
+        // Nothing to write, so wait for a message.  The flag is set before
+        // checking for messages one last time (see wakeUp()).
+        Mutex::Locker lock(mutex_);
+        sleeping_ = true;
+        __sync_synchronize();
+        if (ready()) {
+            sleeping_ = false;
+            continue;
+        }
+        if (stopping_) {
+            sleeping_ = false;
+            break;
+        }
+        ready_cond_.wait(mutex_);
+        sleeping_ = false;
+    }
+}
+
+AsyncOutput&
+AsyncOutput::getGlobal() {
+    static AsyncOutput output;
+    return (output);
+}
+
+} // namespace log
+} // namespace bundy
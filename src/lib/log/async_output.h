@@ -0,0 +1,269 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef ASYNC_OUTPUT_H
+#define ASYNC_OUTPUT_H
+
+#include <exceptions/exceptions.h>
+#include <log/logger_level.h>
+#include <util/threads/sync.h>
+#include <util/threads/thread.h>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <stdint.h>
+#include <sys/time.h>
+#include <string>
+#include <vector>
+
+namespace bundy {
+namespace log {
+
+/// \brief Asynchronous output error
+///
+/// Thrown if the asynchronous output is started with invalid parameters or
+/// when it is already running.
+class AsyncOutputError : public bundy::Exception {
+public:
+    AsyncOutputError(const char* file, size_t line, const char* what) :
+        bundy::Exception(file, line, what)
+    {}
+};
+
+/// \brief Asynchronous log output
+///
+/// Writing a log message involves the layout of the message by log4cplus,
+/// taking the interprocess lock that keeps the output of the BUNDY processes
+/// apart, and the I/O itself.  When messages are logged at a high rate, doing
+/// all of that on the thread that logs the message slows the thread down
+/// considerably.
+///
+/// When the asynchronous output is running, the logger only places the
+/// already formatted message in a bounded queue and returns.  A background
+/// thread takes the messages off the queue in batches and passes each batch
+/// to the writer, which does the rest of the work once per batch.
+///
+/// The queue is a ring buffer in which each slot carries a sequence number.
+/// Threads logging a message claim a slot by atomically advancing the write
+/// position; no lock is taken unless the background thread is idle and needs
+/// to be woken up, or the queue is full and the overflow policy is to block.
+///
+/// When the queue is full, the message is either dropped (the number of
+/// dropped messages is counted and reported in the output) or the logging
+/// thread waits until there is room for it, depending on the overflow policy.
+///
+/// Stopping the output (which also happens on destruction) writes all the
+/// messages still in the queue before the background thread exits.
+class AsyncOutput : public boost::noncopyable {
+public:
+    /// \brief Action taken when the queue is full
+    enum OverflowPolicy {
+        DROP,   ///< Drop the message and count it
+        BLOCK   ///< Wait until there is room in the queue
+    };
+
+    /// \brief Default number of messages the queue can hold
+    static const size_t DEFAULT_QUEUE_SIZE = 4096;
+
+    /// \brief Message waiting to be written
+    ///
+    /// The time and the thread are those of the call which logged the
+    /// message, so the output shows them rather than the time of the write
+    /// and the background thread.  The report of the dropped messages has
+    /// no thread.
+    struct Message {
+        std::string logger_;    ///< Full name of the logger
+        Severity severity_;     ///< Severity of the message
+        std::string text_;      ///< Formatted text of the message
+        std::string thread_;    ///< Name of the logging thread
+        struct timeval time_;   ///< Time the message was logged
+    };
+
+    /// \brief Batch of messages passed to the writer
+    typedef std::vector<Message> MessageBatch;
+
+    /// \brief Function writing a batch of messages
+    ///
+    /// It is called on the background thread only.
+    typedef boost::function<void (const MessageBatch&)> Writer;
+
+    /// \brief Constructor
+    ///
+    /// The output is created stopped.
+    AsyncOutput();
+
+    /// \brief Destructor
+    ///
+    /// Stops the output, writing the messages still queued.
+    ~AsyncOutput();
+
+    /// \brief Start the output
+    ///
+    /// Creates the queue and starts the background thread.
+    ///
+    /// \param writer Function writing the batches of messages.
+    /// \param queue_size Number of messages the queue can hold.  It is
+    ///        rounded up to a power of two.
+    /// \param policy Action taken when the queue is full.
+    ///
+    /// \throw AsyncOutputError the output is already running, the writer is
+    ///        empty or the queue size is zero.
+    void start(const Writer& writer, size_t queue_size = DEFAULT_QUEUE_SIZE,
+               OverflowPolicy policy = DROP);
+
+    /// \brief Stop the output
+    ///
+    /// Writes the messages still in the queue and stops the background
+    /// thread.  Messages logged after this call are not accepted.  It does
+    /// nothing if the output is not running.
+    void stop();
+
+    /// \brief Check if the output is running
+    bool isRunning() const {
+        return (running_);
+    }
+
+    /// \brief Queue a message
+    ///
+    /// \param logger Full name of the logger.
+    /// \param severity Severity of the message.
+    /// \param text Formatted text of the message.
+    /// \param thread Name of the calling thread, as the writer reports it.
+    ///
+    /// \return true if the message has been queued or dropped due to the
+    /// overflow policy, false if the output is not running (the caller should
+    /// then write the message itself).
+    bool output(const std::string& logger, const Severity& severity,
+                const std::string& text, const std::string& thread);
+
+    /// \brief Wait for the queued messages to be written
+    ///
+    /// Returns when all the messages queued before the call have been
+    /// passed to the writer.  It returns immediately if the output is not
+    /// running.
+    void flush();
+
+    /// \brief Return the number of messages dropped so far
+    uint64_t getDroppedCount() const {
+        return (dropped_);
+    }
+
+    /// \brief Return the number of messages the queue can hold
+    ///
+    /// \return Size of the queue or zero if the output has never been
+    ///         started.
+    size_t getQueueSize() const {
+        return (cells_.size());
+    }
+
+    /// \brief Return the global output
+    ///
+    /// Returns the object used by all the loggers of the process.  It is
+    /// started and stopped through the LoggerManager.
+    static AsyncOutput& getGlobal();
+
+private:
+    /// \brief Slot of the queue
+    struct Cell {
+        volatile size_t sequence_;  ///< Position the slot is ready for
+        Message message_;           ///< Message held in the slot
+    };
+
+    /// \brief Put a message in the queue
+    ///
+    /// \return false if the queue is full.
+    bool push(const std::string& logger, const Severity& severity,
+              const std::string& text, const std::string& thread,
+              const struct timeval& time);
+
+    /// \brief Take a message from the queue and append it to the batch
+    ///
+    /// Called on the background thread only.
+    ///
+    /// \return false if the queue is empty.
+    bool pop(MessageBatch& batch);
+
+    /// \brief Check if there is a message ready to be taken from the queue
+    bool ready() const;
+
+    /// \brief Wake the background thread up if it is waiting for messages
+    void wakeUp();
+
+    /// \brief Main function of the background thread
+    void run();
+
+    /// \brief Append the report of the dropped messages to the batch
+    void reportDropped(MessageBatch& batch);
+
+    /// Slots of the queue
+    std::vector<Cell> cells_;
+
+    /// Mask giving the slot index from a position
+    size_t mask_;
+
+    /// Position the next message is written to
+    volatile size_t enqueue_pos_;
+
+    /// Position the next message is read from
+    volatile size_t dequeue_pos_;
+
+    /// Number of messages passed to the writer
+    volatile size_t written_;
+
+    /// Number of messages dropped
+    volatile uint64_t dropped_;
+
+    /// Number of dropped messages already reported
+    uint64_t reported_dropped_;
+
+    /// Number of threads inside output()
+    volatile int users_;
+
+    /// Number of threads waiting for room in the queue or for a flush
+    volatile int waiters_;
+
+    /// Indicates if the background thread is waiting for messages
+    volatile bool sleeping_;
+
+    /// Indicates if messages are accepted
+    volatile bool running_;
+
+    /// Indicates if the background thread should exit
+    volatile bool stopping_;
+
+    /// Action taken when the queue is full
+    OverflowPolicy policy_;
+
+    /// Function writing the messages
+    Writer writer_;
+
+    /// Mutex protecting the waits below
+    bundy::util::thread::Mutex mutex_;
+
+    /// Condition the background thread waits on for messages
+    bundy::util::thread::CondVar ready_cond_;
+
+    /// Condition the logging threads wait on for room or a flush
+    bundy::util::thread::CondVar written_cond_;
+
+    /// Background thread
+    boost::scoped_ptr<bundy::util::thread::Thread> thread_;
+};
+
+} // namespace log
+} // namespace bundy
+
+#endif // ASYNC_OUTPUT_H
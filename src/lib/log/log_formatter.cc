@@ -16,6 +16,7 @@
 #include <log/log_formatter.h>
 
 #include <cassert>
+#include <cctype>
 
 #ifdef ENABLE_LOGGER_CHECKS
 #include <iostream>
@@ -73,5 +74,96 @@ checkExcessPlaceholders(string* message, unsigned int placeholder) {
     }
 }
 
+const size_t MessageArguments::INLINE_ARGS;
+
+MessageTemplate::MessageTemplate(const string& text) :
+    text_(text), mask_(0)
+{
+    // Find the "%" followed by digits.  Unlike replacePlaceholder(), which
+    // takes "%1" out of "%10" as well, the number extends over all the digits.
+    size_t pos = text_.find('%');
+    while (pos != string::npos) {
+        size_t end = pos + 1;
+        unsigned number = 0;
+        while (end < text_.size() && isdigit(text_[end]) &&
+               number < 100000) {
+            number = number * 10 + (text_[end] - '0');
+            ++end;
+        }
+        if (end > pos + 1 && number > 0) {
+            const Placeholder placeholder = { pos, end - pos, number };
+            placeholders_.push_back(placeholder);
+            if (number < 32) {
+                mask_ |= static_cast<uint32_t>(1) << number;
+            }
+        }
+        pos = text_.find('%', end);
+    }
+}
+
+bool
+MessageTemplate::hasLargePlaceholder(unsigned placeholder) const {
+    for (vector<Placeholder>::const_iterator i = placeholders_.begin();
+         i != placeholders_.end(); ++i) {
+        if (i->number_ == placeholder) {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+void
+MessageTemplate::reportMissingPlaceholder(unsigned) const {
+#ifdef ENABLE_LOGGER_CHECKS
+    // We're missing the placeholder, so throw an exception
+    bundy_throw(MismatchedPlaceholders,
+                "Missing logger placeholder in message: " << text_);
+#endif /* ENABLE_LOGGER_CHECKS */
+}
+
+void
+MessageTemplate::format(string& result, const MessageArguments& args) const {
+    size_t length = text_.size();
+    for (size_t i = 0; i < args.size(); ++i) {
+        length += args[i].size();
+    }
+    result.reserve(result.size() + length);
+
+    // Copy the text between the placeholders, and the arguments in place of
+    // them.  Placeholders with no argument are copied as they are.
+    size_t pos = 0;
+    for (vector<Placeholder>::const_iterator i = placeholders_.begin();
+         i != placeholders_.end(); ++i) {
+        result.append(text_, pos, i->offset_ - pos);
+        if (i->number_ <= args.size()) {
+            result.append(args[i->number_ - 1]);
+        } else {
+            result.append(text_, i->offset_, i->length_);
+        }
+        pos = i->offset_ + i->length_;
+    }
+    result.append(text_, pos, string::npos);
+
+    // Complain about the arguments with no placeholder (with the logger
+    // checks enabled, the Formatter has already thrown for them).
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (!hasPlaceholder(i + 1)) {
+            result.append(" @@Missing placeholder %" +
+                          lexical_cast<string>(i + 1) + " for '" + args[i] +
+                          "'@@");
+        }
+    }
+
+    if (hasPlaceholder(args.size() + 1)) {
+        // Excess placeholders were found; see checkExcessPlaceholders().
+#ifdef ENABLE_LOGGER_CHECKS
+        cerr << "Message " << result << endl;
+        assert("Excess logger placeholders still exist in message" == NULL);
+#else
+        result.append(" @@Excess logger placeholders still exist@@");
+#endif /* ENABLE_LOGGER_CHECKS */
+    }
+}
+
 }
 }
@@ -15,12 +15,17 @@
 #ifndef LOG_FORMATTER_H
 #define LOG_FORMATTER_H
 
+#include <algorithm>
 #include <cstddef>
 #include <string>
 #include <iostream>
+#include <vector>
+
+#include <stdint.h>
 
 #include <exceptions/exceptions.h>
 #include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
 #include <log/logger_level.h>
 
 namespace bundy {
@@ -70,6 +75,149 @@ void
 replacePlaceholder(std::string* message, const std::string& replacement,
                    const unsigned placeholder);
 
+///
+/// \brief Arguments of a log message
+///
+/// Holds the arguments passed to the Formatter until the message is output.
+/// The first few arguments are kept in the object itself (which is normally
+/// a temporary on the stack), so that passing them doesn't allocate memory
+/// beyond what their text needs.
+class MessageArguments {
+public:
+    /// \brief Number of arguments held without allocating memory
+    static const size_t INLINE_ARGS = 6;
+
+    /// \brief Constructor
+    MessageArguments() :
+        count_(0)
+    {}
+
+    /// \brief Return the number of arguments
+    size_t size() const {
+        return (count_);
+    }
+
+    /// \brief Return an argument
+    ///
+    /// \param index Index of the argument, from zero.  It is not checked.
+    const std::string& operator[](size_t index) const {
+        return (index < INLINE_ARGS ? inline_[index] :
+                extra_[index - INLINE_ARGS]);
+    }
+
+    /// \brief Append an argument
+    ///
+    /// \param text Text of the argument.  Its content is taken over rather
+    ///     than copied, the string is left empty.
+    void add(std::string& text) {
+        if (count_ < INLINE_ARGS) {
+            inline_[count_].swap(text);
+        } else {
+            extra_.push_back(std::string());
+            extra_.back().swap(text);
+        }
+        ++count_;
+    }
+
+    /// \brief Exchange the arguments with those of another object
+    void swap(MessageArguments& other) {
+        for (size_t i = 0; i < INLINE_ARGS; ++i) {
+            inline_[i].swap(other.inline_[i]);
+        }
+        extra_.swap(other.extra_);
+        std::swap(count_, other.count_);
+    }
+
+    /// \brief Remove all the arguments
+    void clear() {
+        for (size_t i = 0; i < count_ && i < INLINE_ARGS; ++i) {
+            inline_[i].clear();
+        }
+        extra_.clear();
+        count_ = 0;
+    }
+
+private:
+    std::string inline_[INLINE_ARGS];   ///< First arguments
+    std::vector<std::string> extra_;    ///< Arguments beyond INLINE_ARGS
+    size_t count_;                      ///< Number of arguments
+};
+
+///
+/// \brief Parsed message text
+///
+/// Holds the text of a message together with the positions of its %1, %2...
+/// placeholders, so that the arguments can be substituted in a single pass
+/// over the text once the message is actually output.  The message
+/// dictionary keeps one of these for each message, so the text of a message
+/// is only searched for placeholders once.
+class MessageTemplate {
+public:
+    /// \brief Constructor
+    ///
+    /// \param text The message text with placeholders.
+    explicit MessageTemplate(const std::string& text);
+
+    /// \brief Return the message text
+    const std::string& getText() const {
+        return (text_);
+    }
+
+    /// \brief Check if the text contains the given placeholder
+    ///
+    /// \param placeholder Number of the placeholder, from one.
+    bool hasPlaceholder(unsigned placeholder) const {
+        if (placeholder < 32) {
+            return ((mask_ & (static_cast<uint32_t>(1) << placeholder)) != 0);
+        }
+        return (hasLargePlaceholder(placeholder));
+    }
+
+    /// \brief Handle an argument with no placeholder
+    ///
+    /// Called by the Formatter when it is given an argument whose
+    /// placeholder does not appear in the text.  If the logger checks are
+    /// enabled, it throws MismatchedPlaceholders, otherwise it does nothing
+    /// (format() then complains about the argument in the output).
+    ///
+    /// \param placeholder Number of the missing placeholder.
+    void reportMissingPlaceholder(unsigned placeholder) const;
+
+    /// \brief Substitute the arguments
+    ///
+    /// Appends the text with the placeholders replaced by the arguments to
+    /// the result.  Arguments with no placeholder in the text and
+    /// placeholders left without an argument are reported at the end of the
+    /// output in the same way as replacePlaceholder() and
+    /// checkExcessPlaceholders() do.
+    ///
+    /// \param result String the formatted message is appended to.
+    /// \param args The arguments, the first replacing %1.
+    void format(std::string& result, const MessageArguments& args) const;
+
+private:
+    /// \brief Position of a placeholder in the text
+    struct Placeholder {
+        size_t offset_;     ///< Offset of the '%'
+        size_t length_;     ///< Length including the '%'
+        unsigned number_;   ///< Number of the placeholder
+    };
+
+    /// \brief Check for a placeholder not covered by the mask
+    bool hasLargePlaceholder(unsigned placeholder) const;
+
+    std::string text_;                      ///< The message text
+    std::vector<Placeholder> placeholders_; ///< Placeholders in text order
+    uint32_t mask_;                         ///< Placeholders 1 to 31 present
+};
+
+/// \brief Shared pointer to a parsed message
+///
+/// The message dictionary and the formatters share the parsed messages, so
+/// a message replaced in the dictionary stays valid for a formatter still
+/// using it.
+typedef boost::shared_ptr<const MessageTemplate> ConstMessageTemplatePtr;
+
 ///
 /// \brief The log message formatter
 ///
@@ -90,7 +238,10 @@ replacePlaceholder(std::string* message, const std::string& replacement,
 /// destroyed and, again, we can produce the output.
 ///
 /// Of course, if the logging is turned off, we don't bother with any replacing
-/// and just return.
+/// and just return.  Even when it is on, the arguments are only collected by
+/// the .arg calls; they are substituted into the text in a single pass when
+/// the message is output, using the placeholder positions the message
+/// dictionary found when the message was registered.
 ///
 /// User of logging code should not really care much about this class, only
 /// call the .arg method to generate the correct output.
@@ -117,11 +268,14 @@ private:
     /// \brief Message severity
     Severity severity_;
 
-    /// \brief The messages with %1, %2... placeholders
-    std::string* message_;
+    /// \brief The message with %1, %2... placeholders
+    ///
+    /// It is either shared with the message dictionary or created from the
+    /// text given to the constructor.
+    mutable ConstMessageTemplatePtr message_;
 
-    /// \brief Which will be the next placeholder to replace
-    unsigned nextPlaceholder_;
+    /// \brief The arguments given so far
+    mutable MessageArguments args_;
 
 
 public:
@@ -135,14 +289,33 @@ public:
     ///
     /// \param severity The severity of the message (DEBUG, ERROR etc.)
     /// \param message The message with placeholders. We take ownership of
-    ///     it and we will modify the string. Must not be NULL unless
-    ///     logger is also NULL, but it's not checked.
+    ///     it. Must not be NULL unless logger is also NULL, but it's not
+    ///     checked.
     /// \param logger The logger where the final output will go, or NULL
     ///     if no output is wanted.
     Formatter(const Severity& severity = NONE, std::string* message = NULL,
               Logger* logger = NULL) :
-        logger_(logger), severity_(severity), message_(message),
-        nextPlaceholder_(0)
+        logger_(logger), severity_(severity)
+    {
+        if (message) {
+            if (logger_) {
+                message_.reset(new MessageTemplate(*message));
+            }
+            delete message;
+        }
+    }
+
+    /// \brief Constructor of "active" formatter for a parsed message
+    ///
+    /// This is what the logger uses: the message is the one held by the
+    /// message dictionary, so nothing needs to be copied or parsed.
+    ///
+    /// \param severity The severity of the message (DEBUG, ERROR etc.)
+    /// \param message The message with placeholders.  Must not be NULL.
+    /// \param logger The logger where the final output will go.
+    Formatter(const Severity& severity, const ConstMessageTemplatePtr& message,
+              Logger* logger) :
+        logger_(logger), severity_(severity), message_(message)
     {
     }
 
@@ -152,9 +325,10 @@ public:
     /// that will have responsibility for outputting the formatted message - the
     /// object being copied relinquishes that responsibility.
     Formatter(const Formatter& other) :
-        logger_(other.logger_), severity_(other.severity_),
-        message_(other.message_), nextPlaceholder_(other.nextPlaceholder_)
+        logger_(other.logger_), severity_(other.severity_)
     {
+        message_.swap(other.message_);
+        args_.swap(other.args_);
         other.logger_ = NULL;
     }
 
@@ -164,12 +338,12 @@ public:
     ~ Formatter() {
         if (logger_) {
             try {
-                checkExcessPlaceholders(message_, ++nextPlaceholder_);
-                logger_->output(severity_, *message_);
+                std::string output;
+                message_->format(output, args_);
+                logger_->output(severity_, output);
             } catch (...) {
                 // Catch and ignore all exceptions here.
             }
-            delete message_;
         }
     }
 
@@ -181,8 +355,9 @@ public:
         if (&other != this) {
             logger_ = other.logger_;
             severity_ = other.severity_;
-            message_ = other.message_;
-            nextPlaceholder_ = other.nextPlaceholder_;
+            message_.reset();
+            message_.swap(other.message_);
+            args_.swap(other.args_);
             other.logger_ = NULL;
         }
 
@@ -198,8 +373,9 @@ public:
     /// \param value The argument to place into the placeholder.
     template<class Arg> Formatter& arg(const Arg& value) {
         if (logger_) {
+            std::string text;
             try {
-                return (arg(boost::lexical_cast<std::string>(value)));
+                text = boost::lexical_cast<std::string>(value);
             } catch (const boost::bad_lexical_cast& ex) {
                 // The formatting of the log message got wrong, we don't want
                 // to output it.
@@ -215,6 +391,7 @@ public:
                 bundy_throw(FormatFailure, "bad_lexical_cast in call to "
                           "Formatter::arg(): " << ex.what());
             }
+            return (addArg(text));
         } else {
             return (*this);
         }
@@ -225,26 +402,13 @@ public:
     /// \param arg The text to place into the placeholder.
     Formatter& arg(const std::string& arg) {
         if (logger_) {
-            // Note that this method does a replacement and returns the
-            // modified string. If there are multiple invocations of arg() (e.g.
-            // logger.info(msgid).arg(xxx).arg(yyy)...), each invocation
-            // operates on the string returned by the previous one. This
-            // sequential operation means that if we had a message like "%1 %2",
-            // and called .arg("%2").arg(42), we would get "42 42"; the first
-            // call replaces the %1" with "%2" and the second replaces all
-            // occurrences of "%2" with 42. (Conversely, the sequence
-            // .arg(42).arg("%1") would return "42 %1" - there are no recursive
-            // replacements).
-            try {
-                replacePlaceholder(message_, arg, ++nextPlaceholder_ );
-            }
-            catch (...) {
-                // Something went wrong here, the log message is broken, so
-                // we don't want to output it, nor we want to check all the
-                // placeholders were used (because they won't be).
-                deactivate();
-                throw;
-            }
+            // Note that the argument is only stored here; all of them are
+            // substituted at once when the message is output, and only into
+            // the placeholders of the original text.  So if we had a message
+            // like "%1 %2" and called .arg("%2").arg(42), we would get
+            // "%2 42" - there are no recursive replacements.
+            std::string text(arg);
+            return (addArg(text));
         }
         return (*this);
     }
@@ -259,10 +423,32 @@ public:
     /// the arguments for the message.
     void deactivate() {
         if (logger_) {
-            delete message_;
-            message_ = NULL;
+            message_.reset();
             logger_ = NULL;
+            args_.clear();
+        }
+    }
+
+private:
+    /// \brief Store the next argument
+    ///
+    /// \param text Text of the argument.  It is left empty.
+    Formatter& addArg(std::string& text) {
+        const unsigned placeholder = args_.size() + 1;
+        if (!message_->hasPlaceholder(placeholder)) {
+            try {
+                message_->reportMissingPlaceholder(placeholder);
+            }
+            catch (...) {
+                // Something went wrong here, the log message is broken, so
+                // we don't want to output it, nor we want to check all the
+                // placeholders were used (because they won't be).
+                deactivate();
+                throw;
+            }
         }
+        args_.add(text);
+        return (*this);
     }
 };
 
@@ -7,6 +7,7 @@
 namespace bundy {
 namespace log {
 
+extern const bundy::log::MessageID LOG_ASYNC_MESSAGES_DROPPED = "LOG_ASYNC_MESSAGES_DROPPED";
 extern const bundy::log::MessageID LOG_BAD_DESTINATION = "LOG_BAD_DESTINATION";
 extern const bundy::log::MessageID LOG_BAD_SEVERITY = "LOG_BAD_SEVERITY";
 extern const bundy::log::MessageID LOG_BAD_STREAM = "LOG_BAD_STREAM";
@@ -34,6 +35,7 @@ extern const bundy::log::MessageID LOG_WRITE_ERROR = "LOG_WRITE_ERROR";
 namespace {
 
 const char* values[] = {
+    "LOG_ASYNC_MESSAGES_DROPPED", "%1 log messages were dropped because the asynchronous output queue was full",
     "LOG_BAD_DESTINATION", "unrecognized log destination: %1",
     "LOG_BAD_SEVERITY", "unrecognized log severity: %1",
     "LOG_BAD_STREAM", "bad log console output stream: %1",
@@ -8,6 +8,7 @@
 namespace bundy {
 namespace log {
 
+extern const bundy::log::MessageID LOG_ASYNC_MESSAGES_DROPPED;
 extern const bundy::log::MessageID LOG_BAD_DESTINATION;
 extern const bundy::log::MessageID LOG_BAD_SEVERITY;
 extern const bundy::log::MessageID LOG_BAD_STREAM;
@@ -134,11 +134,24 @@ Logger::output(const Severity& severity, const std::string& message) {
     getLoggerPtr()->outputRaw(severity, message);
 }
 
+// Create an active formatter.  The text of known messages is used directly
+// from the dictionary; an unknown ID is output on its own.
+
+Logger::Formatter
+Logger::createFormatter(const Severity& severity, const MessageID& ident) {
+    const ConstMessageTemplatePtr message =
+        getLoggerPtr()->lookupMessage(ident);
+    if (message) {
+        return (Formatter(severity, message, this));
+    } else {
+        return (Formatter(severity, new string(string(ident) + " "), this));
+    }
+}
+
 Logger::Formatter
 Logger::debug(int dbglevel, const bundy::log::MessageID& ident) {
     if (isDebugEnabled(dbglevel)) {
-        return (Formatter(DEBUG, getLoggerPtr()->lookupMessage(ident),
-                          this));
+        return (createFormatter(DEBUG, ident));
     } else {
         return (Formatter());
     }
@@ -147,8 +160,7 @@ Logger::debug(int dbglevel, const bundy::log::MessageID& ident) {
 Logger::Formatter
 Logger::info(const bundy::log::MessageID& ident) {
     if (isInfoEnabled()) {
-        return (Formatter(INFO, getLoggerPtr()->lookupMessage(ident),
-                          this));
+        return (createFormatter(INFO, ident));
     } else {
         return (Formatter());
     }
@@ -157,8 +169,7 @@ Logger::info(const bundy::log::MessageID& ident) {
 Logger::Formatter
 Logger::warn(const bundy::log::MessageID& ident) {
     if (isWarnEnabled()) {
-        return (Formatter(WARN, getLoggerPtr()->lookupMessage(ident),
-                          this));
+        return (createFormatter(WARN, ident));
     } else {
         return (Formatter());
     }
@@ -167,8 +178,7 @@ Logger::warn(const bundy::log::MessageID& ident) {
 Logger::Formatter
 Logger::error(const bundy::log::MessageID& ident) {
     if (isErrorEnabled()) {
-        return (Formatter(ERROR, getLoggerPtr()->lookupMessage(ident),
-                          this));
+        return (createFormatter(ERROR, ident));
     } else {
         return (Formatter());
     }
@@ -177,8 +187,7 @@ Logger::error(const bundy::log::MessageID& ident) {
 Logger::Formatter
 Logger::fatal(const bundy::log::MessageID& ident) {
     if (isFatalEnabled()) {
-        return (Formatter(FATAL, getLoggerPtr()->lookupMessage(ident),
-                          this));
+        return (createFormatter(FATAL, ident));
     } else {
         return (Formatter());
     }
@@ -286,6 +286,12 @@ private:
     /// \param message Text of the message to be output.
     void output(const Severity& severity, const std::string& message);
 
+    /// \brief Create an active formatter
+    ///
+    /// \param severity Severity of the message.
+    /// \param ident Message identification.
+    Formatter createFormatter(const Severity& severity, const MessageID& ident);
+
     /// \brief Copy Constructor
     ///
     /// Disabled (marked private) as it makes no sense to copy the logger -
@@ -23,6 +23,14 @@
 
 #include <log4cplus/configurator.h>
 #include <log4cplus/loggingmacros.h>
+#include <log4cplus/version.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/spi/loggingevent.h>
+#if (LOG4CPLUS_VERSION >= LOG4CPLUS_MAKE_VERSION(1, 1, 0))
+#include <log4cplus/thread/threads.h>
+#else
+#include <log4cplus/helpers/threads.h>
+#endif
 
 #include <log/logger.h>
 #include <log/logger_impl.h>
@@ -42,6 +50,104 @@
 
 using namespace std;
 
+namespace {
+
+// Pass a message to log4cplus at the given severity.
+void
+writeMessage(log4cplus::Logger& logger, const bundy::log::Severity& severity,
+             const string& message)
+{
+    switch (severity) {
+        case bundy::log::DEBUG:
+            LOG4CPLUS_DEBUG(logger, message);
+            break;
+
+        case bundy::log::INFO:
+            LOG4CPLUS_INFO(logger, message);
+            break;
+
+        case bundy::log::WARN:
+            LOG4CPLUS_WARN(logger, message);
+            break;
+
+        case bundy::log::ERROR:
+            LOG4CPLUS_ERROR(logger, message);
+            break;
+
+        case bundy::log::FATAL:
+            LOG4CPLUS_FATAL(logger, message);
+            break;
+
+        case bundy::log::NONE:
+             break;
+
+        default:
+            LOG4CPLUS_ERROR(logger,
+                            "Unsupported severity in LoggerImpl::outputRaw(): "
+                            << severity);
+    }
+}
+
+// Pass a message queued by the asynchronous output to log4cplus.  The event
+// is built with the thread and the time of the logging call, as the
+// background thread writing it is neither.  The nested diagnostic context is
+// left empty, as it isn't used by BUNDY.
+void
+writeQueuedMessage(log4cplus::Logger& logger,
+                   const bundy::log::AsyncOutput::Message& message)
+{
+    log4cplus::LogLevel level;
+    switch (message.severity_) {
+        case bundy::log::DEBUG:
+            level = log4cplus::DEBUG_LOG_LEVEL;
+            break;
+
+        case bundy::log::INFO:
+            level = log4cplus::INFO_LOG_LEVEL;
+            break;
+
+        case bundy::log::WARN:
+            level = log4cplus::WARN_LOG_LEVEL;
+            break;
+
+        case bundy::log::ERROR:
+            level = log4cplus::ERROR_LOG_LEVEL;
+            break;
+
+        case bundy::log::FATAL:
+            level = log4cplus::FATAL_LOG_LEVEL;
+            break;
+
+        default:
+            writeMessage(logger, message.severity_, message.text_);
+            return;
+    }
+    if (message.thread_.empty()) {
+        // Not logged by any thread (the report of dropped messages).
+        writeMessage(logger, message.severity_, message.text_);
+        return;
+    }
+    if (!logger.isEnabledFor(level)) {
+        return;
+    }
+
+    const log4cplus::helpers::Time time(message.time_.tv_sec,
+                                        message.time_.tv_usec);
+#if (LOG4CPLUS_VERSION >= LOG4CPLUS_MAKE_VERSION(1, 1, 0))
+    const log4cplus::spi::InternalLoggingEvent
+        event(logger.getName(), level, log4cplus::tstring(),
+              log4cplus::MappedDiagnosticContextMap(), message.text_,
+              message.thread_, time, __FILE__, __LINE__);
+#else
+    const log4cplus::spi::InternalLoggingEvent
+        event(logger.getName(), level, log4cplus::tstring(), message.text_,
+              message.thread_, time, __FILE__, __LINE__);
+#endif
+    logger.callAppenders(event);
+}
+
+} // Anonymous namespace
+
 namespace bundy {
 namespace log {
 
@@ -102,10 +208,9 @@ LoggerImpl::getEffectiveDebugLevel() {
 
 
 // Output a general message
-string*
+ConstMessageTemplatePtr
 LoggerImpl::lookupMessage(const MessageID& ident) {
-    return (new string(string(ident) + " " +
-                       MessageDictionary::globalDictionary().getText(ident)));
+    return (MessageDictionary::globalDictionary().getTemplate(ident));
 }
 
 // Replace the interprocess synchronization object
@@ -124,6 +229,13 @@ LoggerImpl::setInterprocessSync(bundy::log::interprocess::InterprocessSync* sync
 
 void
 LoggerImpl::outputRaw(const Severity& severity, const string& message) {
+    // If the asynchronous output is running, it takes care of the rest.
+    if (AsyncOutput::getGlobal().output(
+            name_, severity, message,
+            log4cplus::thread::getCurrentThreadName())) {
+        return;
+    }
+
     // Use a mutex locker for mutual exclusion from other threads in
     // this process.
     bundy::util::thread::Mutex::Locker mutex_locker(LoggerManager::getMutex());
@@ -136,38 +248,43 @@ LoggerImpl::outputRaw(const Severity& severity, const string& message) {
         LOG4CPLUS_ERROR(logger_, "Unable to lock logger lockfile");
     }
 
-    switch (severity) {
-        case DEBUG:
-            LOG4CPLUS_DEBUG(logger_, message);
-            break;
-
-        case INFO:
-            LOG4CPLUS_INFO(logger_, message);
-            break;
+    writeMessage(logger_, severity, message);
 
-        case WARN:
-            LOG4CPLUS_WARN(logger_, message);
-            break;
+    if (!locker.unlock()) {
+        LOG4CPLUS_ERROR(logger_, "Unable to unlock logger lockfile");
+    }
+}
 
-        case ERROR:
-            LOG4CPLUS_ERROR(logger_, message);
-            break;
+void
+LoggerImpl::outputBatch(
+    const boost::shared_ptr<interprocess::InterprocessSync>& sync,
+    const AsyncOutput::MessageBatch& batch)
+{
+    if (batch.empty()) {
+        return;
+    }
 
-        case FATAL:
-            LOG4CPLUS_FATAL(logger_, message);
-            break;
+    // Same locking as in outputRaw(), but once for the whole batch.
+    bundy::util::thread::Mutex::Locker mutex_locker(LoggerManager::getMutex());
+    interprocess::InterprocessSyncLocker locker(*sync);
 
-        case NONE:
-             break;
+    log4cplus::Logger logger = log4cplus::Logger::getInstance(batch[0].logger_);
+    if (!locker.lock()) {
+        LOG4CPLUS_ERROR(logger, "Unable to lock logger lockfile");
+    }
 
-        default:
-            LOG4CPLUS_ERROR(logger_,
-                            "Unsupported severity in LoggerImpl::outputRaw(): "
-                            << severity);
+    for (AsyncOutput::MessageBatch::const_iterator i = batch.begin();
+         i != batch.end(); ++i) {
+        // Consecutive messages often come from the same logger, so only
+        // look the logger up when the name changes.
+        if (i->logger_ != logger.getName()) {
+            logger = log4cplus::Logger::getInstance(i->logger_);
+        }
+        writeQueuedMessage(logger, *i);
     }
 
     if (!locker.unlock()) {
-        LOG4CPLUS_ERROR(logger_, "Unable to unlock logger lockfile");
+        LOG4CPLUS_ERROR(logger, "Unable to unlock logger lockfile");
     }
 }
 
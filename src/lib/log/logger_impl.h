@@ -24,12 +24,15 @@
 #include <map>
 #include <utility>
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 
 
 // log4cplus logger header file
 #include <log4cplus/logger.h>
 
 // BIND-10 logger files
+#include <log/async_output.h>
+#include <log/log_formatter.h>
 #include <log/logger_level_impl.h>
 #include <log/message_types.h>
 #include <log/interprocess/interprocess_sync.h>
@@ -157,17 +160,32 @@ public:
     /// \brief Raw output
     ///
     /// Writes the message with time into the log. Used by the Formatter
-    /// to produce output.
+    /// to produce output.  If the asynchronous output is running, the
+    /// message is only queued and written later on its background thread.
     ///
     /// \param severity Severity of the message. (This controls the prefix
     ///        label output with the message text.)
     /// \param message Text of the message.
     void outputRaw(const Severity& severity, const std::string& message);
 
+    /// \brief Write a batch of messages
+    ///
+    /// This is the writer of the asynchronous output.  It writes the
+    /// messages queued by outputRaw() while holding the locks for the whole
+    /// batch rather than for each message.  The messages are output with the
+    /// time and the thread of the outputRaw() call that queued them.
+    ///
+    /// \param sync Synchronization object used for the output of the batch.
+    /// \param batch Messages to write.
+    static void outputBatch(
+        const boost::shared_ptr<interprocess::InterprocessSync>& sync,
+        const AsyncOutput::MessageBatch& batch);
+
     /// \brief Look up message text in dictionary
     ///
-    /// This gets you the unformatted text of message for given ID.
-    std::string* lookupMessage(const MessageID& id);
+    /// This gets you the unformatted text of message for given ID, prefixed
+    /// with the ID, or NULL if the ID is not in the dictionary.
+    ConstMessageTemplatePtr lookupMessage(const MessageID& id);
 
     /// \brief Replace the interprocess synchronization object
     ///
@@ -28,8 +28,13 @@
 #include <log/message_initializer.h>
 #include <log/message_reader.h>
 #include <log/message_types.h>
+#include <log/logger_impl.h>
+#include <log/interprocess/interprocess_sync_file.h>
 #include <log/interprocess/interprocess_sync_null.h>
 
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
 using namespace std;
 
 namespace {
@@ -203,5 +208,26 @@ LoggerManager::getMutex() {
     return (mutex);
 }
 
+void
+LoggerManager::startAsyncOutput(size_t queue_size,
+                                AsyncOutput::OverflowPolicy policy,
+                                interprocess::InterprocessSync* sync)
+{
+    boost::shared_ptr<interprocess::InterprocessSync> sync_ptr(sync);
+    if (!sync_ptr) {
+        sync_ptr.reset(new interprocess::InterprocessSyncFile("logger"));
+    }
+
+    AsyncOutput& output = AsyncOutput::getGlobal();
+    output.stop();
+    output.start(boost::bind(&LoggerImpl::outputBatch, sync_ptr, _1),
+                 queue_size, policy);
+}
+
+void
+LoggerManager::stopAsyncOutput() {
+    AsyncOutput::getGlobal().stop();
+}
+
 } // namespace log
 } // namespace bundy
@@ -17,7 +17,9 @@
 
 #include "exceptions/exceptions.h"
 #include <util/threads/sync.h>
+#include <log/async_output.h>
 #include <log/logger_specification.h>
+#include <log/interprocess/interprocess_sync.h>
 
 #include <boost/noncopyable.hpp>
 
@@ -140,6 +142,29 @@ public:
     /// calls.
     static bundy::util::thread::Mutex& getMutex();
 
+    /// \brief Start asynchronous output
+    ///
+    /// From now on, log messages are queued and written by a background
+    /// thread (see \c AsyncOutput).  If the asynchronous output is already
+    /// running, it is stopped first, which writes the messages queued so far.
+    ///
+    /// \param queue_size Number of messages the queue can hold.
+    /// \param policy Action taken when the queue is full.
+    /// \param sync Synchronization object used by the background thread.
+    ///        The logger manager takes ownership of it.  If NULL, the same
+    ///        file based synchronization as that of the loggers is used.
+    static void startAsyncOutput(
+        size_t queue_size = AsyncOutput::DEFAULT_QUEUE_SIZE,
+        AsyncOutput::OverflowPolicy policy = AsyncOutput::DROP,
+        interprocess::InterprocessSync* sync = NULL);
+
+    /// \brief Stop asynchronous output
+    ///
+    /// Writes the messages still queued and goes back to writing the
+    /// messages on the thread logging them.  It does nothing if the
+    /// asynchronous output is not running.
+    static void stopAsyncOutput();
+
 private:
     /// \brief Initialize Processing
     ///
@@ -13,6 +13,7 @@
 // PERFORMANCE OF THIS SOFTWARE.
 
 #include <cstddef>
+#include <log/log_formatter.h>
 #include <log/message_dictionary.h>
 #include <log/message_types.h>
 
@@ -36,6 +37,7 @@ MessageDictionary::add(const std::string& ident, const std::string& text) {
 
         // Message not already in the dictionary, so add it.
         dictionary_[ident] = text;
+        setTemplate(ident, text);
     }
 
     return (not_found);
@@ -51,6 +53,7 @@ MessageDictionary::replace(const std::string& ident, const std::string& text) {
 
         // Exists, so replace it.
         dictionary_[ident] = text;
+        setTemplate(ident, text);
     }
 
     return (found);
@@ -98,6 +101,28 @@ MessageDictionary::getText(const std::string& ident) const {
     }
 }
 
+// Return the parsed message or NULL.
+
+ConstMessageTemplatePtr
+MessageDictionary::getTemplate(const std::string& ident) const {
+    Templates::const_iterator i = templates_.find(ident);
+    if (i == templates_.end()) {
+        return (ConstMessageTemplatePtr());
+    }
+    else {
+        return (i->second);
+    }
+}
+
+// The parsed message includes the ID, as that is how it is output.
+
+void
+MessageDictionary::setTemplate(const std::string& ident,
+                               const std::string& text)
+{
+    templates_[ident].reset(new MessageTemplate(ident + " " + text));
+}
+
 // Return global dictionary
 
 MessageDictionary&
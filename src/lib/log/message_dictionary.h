@@ -21,8 +21,10 @@
 #include <vector>
 
 #include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <log/message_types.h>
+#include <log/log_formatter.h>
 
 namespace bundy {
 namespace log {
@@ -153,6 +155,33 @@ public:
     virtual const std::string& getText(const std::string& ident) const;
 
 
+    /// \brief Get Parsed Message
+    ///
+    /// Given an ID, retrieve the message text prefixed with the ID, in the
+    /// form the Formatter uses to output it.  The positions of the
+    /// placeholders in the text are found when the message is added or
+    /// replaced, rather than each time the message is logged.
+    ///
+    /// \param ident Message identification
+    ///
+    /// \return Pointer to the parsed message, or NULL if the ID is not
+    /// recognised.  It stays valid if the message is replaced.
+    ConstMessageTemplatePtr getTemplate(const MessageID& ident) const {
+        return (getTemplate(boost::lexical_cast<std::string>(ident)));
+    }
+
+
+    /// \brief Get Parsed Message
+    ///
+    /// Alternate signature.
+    ///
+    /// \param ident Message identification
+    ///
+    /// \return Pointer to the parsed message, or NULL if the ID is not
+    /// recognised.  It stays valid if the message is replaced.
+    ConstMessageTemplatePtr getTemplate(const std::string& ident) const;
+
+
     /// \brief Number of Items in Dictionary
     ///
     /// \return Number of items in the dictionary
@@ -181,7 +210,16 @@ public:
     static MessageDictionary& globalDictionary();
 
 private:
+    /// \brief Store the parsed form of a message
+    ///
+    /// A replaced message is only released when the last formatter using
+    /// it is done.
+    void setTemplate(const std::string& ident, const std::string& text);
+
+    typedef std::map<std::string, ConstMessageTemplatePtr> Templates;
+
     Dictionary       dictionary_;   ///< Holds the ID to text lookups
+    Templates        templates_;    ///< Holds the ID to parsed text lookups
 };
 
 } // namespace log
@@ -0,0 +1,262 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+#include <gtest/gtest.h>
+
+#include <log/async_output.h>
+#include <log/log_messages.h>
+#include <util/threads/sync.h>
+#include <util/threads/thread.h>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <string>
+#include <vector>
+
+#include <sys/time.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace bundy::log;
+using bundy::util::thread::CondVar;
+using bundy::util::thread::Mutex;
+using bundy::util::thread::Thread;
+
+namespace {
+
+class AsyncOutputTest : public ::testing::Test {
+public:
+    AsyncOutputTest() :
+        blocked_(false), entered_(0), batches_(0)
+    {}
+
+    ~AsyncOutputTest() {
+        unblock();
+        output_.stop();
+    }
+
+    // Writer collecting the messages.  It waits while the test holds the
+    // output blocked.
+    void write(const AsyncOutput::MessageBatch& batch) {
+        Mutex::Locker lock(mutex_);
+        ++entered_;
+        cond_.broadcast();
+        while (blocked_) {
+            cond_.wait(mutex_);
+        }
+        messages_.insert(messages_.end(), batch.begin(), batch.end());
+        ++batches_;
+    }
+
+    AsyncOutput::Writer writer() {
+        return (boost::bind(&AsyncOutputTest::write, this, _1));
+    }
+
+    void block() {
+        Mutex::Locker lock(mutex_);
+        blocked_ = true;
+    }
+
+    // Waits until the writer has been called the given number of times.
+    void waitEntered(size_t count) {
+        Mutex::Locker lock(mutex_);
+        while (entered_ < count) {
+            cond_.wait(mutex_);
+        }
+    }
+
+    void unblock() {
+        Mutex::Locker lock(mutex_);
+        blocked_ = false;
+        cond_.broadcast();
+    }
+
+    // Logs the given number of messages, numbered from zero.
+    void produce(const string& logger, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            output_.output(logger, INFO, boost::lexical_cast<string>(i),
+                           "thread");
+        }
+    }
+
+protected:
+    AsyncOutput output_;
+    Mutex mutex_;
+    CondVar cond_;
+    bool blocked_;
+    size_t entered_;
+    size_t batches_;
+    AsyncOutput::MessageBatch messages_;
+};
+
+// Check the output can only be started with valid parameters and only once.
+TEST_F(AsyncOutputTest, startStop) {
+    EXPECT_FALSE(output_.isRunning());
+    EXPECT_EQ(0, output_.getQueueSize());
+
+    EXPECT_THROW(output_.start(AsyncOutput::Writer()), AsyncOutputError);
+    EXPECT_THROW(output_.start(writer(), 0), AsyncOutputError);
+    EXPECT_FALSE(output_.isRunning());
+
+    // The size of the queue is rounded up to a power of two.
+    output_.start(writer(), 100);
+    EXPECT_TRUE(output_.isRunning());
+    EXPECT_EQ(128, output_.getQueueSize());
+    EXPECT_THROW(output_.start(writer()), AsyncOutputError);
+
+    output_.stop();
+    EXPECT_FALSE(output_.isRunning());
+    // Stopping twice is harmless.
+    output_.stop();
+
+    // And the output may be started again.
+    output_.start(writer());
+    EXPECT_TRUE(output_.isRunning());
+    EXPECT_EQ(AsyncOutput::DEFAULT_QUEUE_SIZE, output_.getQueueSize());
+}
+
+// Messages are not accepted when the output isn't running.
+TEST_F(AsyncOutputTest, notRunning) {
+    EXPECT_FALSE(output_.output("test", INFO, "message", "thread"));
+    output_.flush();
+    EXPECT_TRUE(messages_.empty());
+}
+
+// Check the messages are written in order and unchanged, with the thread
+// and the time of the logging call.
+TEST_F(AsyncOutputTest, output) {
+    output_.start(writer());
+    block();
+    struct timeval before;
+    gettimeofday(&before, NULL);
+    EXPECT_TRUE(output_.output("test", WARN, "first", "thread1"));
+    EXPECT_TRUE(output_.output("other", DEBUG, "second", "thread2"));
+    struct timeval after;
+    gettimeofday(&after, NULL);
+    // Written well after being logged.
+    usleep(100000);
+    unblock();
+    output_.flush();
+
+    ASSERT_EQ(2, messages_.size());
+    EXPECT_EQ("test", messages_[0].logger_);
+    EXPECT_EQ(WARN, messages_[0].severity_);
+    EXPECT_EQ("first", messages_[0].text_);
+    EXPECT_EQ("thread1", messages_[0].thread_);
+    EXPECT_EQ("other", messages_[1].logger_);
+    EXPECT_EQ(DEBUG, messages_[1].severity_);
+    EXPECT_EQ("second", messages_[1].text_);
+    EXPECT_EQ("thread2", messages_[1].thread_);
+    for (size_t i = 0; i < messages_.size(); ++i) {
+        EXPECT_FALSE(timercmp(&messages_[i].time_, &before, <)) << i;
+        EXPECT_FALSE(timercmp(&messages_[i].time_, &after, >)) << i;
+    }
+}
+
+// Check messages queued while the writer is busy are written in batches.
+TEST_F(AsyncOutputTest, batches) {
+    output_.start(writer(), 1024);
+    block();
+    produce("test", 1000);
+    unblock();
+    output_.flush();
+
+    ASSERT_EQ(1000, messages_.size());
+    for (size_t i = 0; i < messages_.size(); ++i) {
+        EXPECT_EQ(boost::lexical_cast<string>(i), messages_[i].text_);
+    }
+    EXPECT_LT(batches_, 1000);
+}
+
+// Check stopping the output writes the messages still queued.
+TEST_F(AsyncOutputTest, stopFlushes) {
+    output_.start(writer());
+    block();
+    produce("test", 100);
+    unblock();
+    output_.stop();
+    EXPECT_EQ(100, messages_.size());
+}
+
+// Check messages are dropped and reported when the queue is full and the
+// policy is to drop them.
+TEST_F(AsyncOutputTest, drop) {
+    output_.start(writer(), 16, AsyncOutput::DROP);
+    block();
+    // Wait until the background thread is held in the writer with the first
+    // message, so the queue is empty and nothing is taken off it.
+    output_.output("test", INFO, "first", "thread");
+    waitEntered(1);
+    EXPECT_TRUE(output_.output("test", INFO, "second", "thread"));
+    produce("test", 100);
+
+    // The queue holds 16 messages, so the rest is dropped.
+    EXPECT_EQ(85, output_.getDroppedCount());
+    unblock();
+    output_.flush();
+
+    // The messages which fit are written, followed by the report of how
+    // many were dropped.
+    ASSERT_EQ(1 + 16 + 1, messages_.size());
+    EXPECT_EQ("second", messages_[1].text_);
+    EXPECT_EQ(WARN, messages_.back().severity_);
+    EXPECT_EQ(0, messages_.back().text_.find(LOG_ASYNC_MESSAGES_DROPPED));
+    EXPECT_NE(string::npos, messages_.back().text_.find("85"));
+}
+
+// Check no message is lost when the policy is to block.
+TEST_F(AsyncOutputTest, block) {
+    output_.start(writer(), 4, AsyncOutput::BLOCK);
+    produce("test", 1000);
+    output_.flush();
+
+    ASSERT_EQ(1000, messages_.size());
+    for (size_t i = 0; i < messages_.size(); ++i) {
+        EXPECT_EQ(boost::lexical_cast<string>(i), messages_[i].text_);
+    }
+    EXPECT_EQ(0, output_.getDroppedCount());
+}
+
+// Check messages logged by several threads at once are all written, and those
+// of each thread in the order they were logged.
+TEST_F(AsyncOutputTest, threads) {
+    const size_t count = 2000;
+    output_.start(writer(), 64, AsyncOutput::BLOCK);
+
+    vector<boost::shared_ptr<Thread> > threads;
+    for (size_t i = 0; i < 4; ++i) {
+        threads.push_back(boost::shared_ptr<Thread>(new Thread(
+            boost::bind(&AsyncOutputTest::produce, this,
+                        boost::lexical_cast<string>(i), count))));
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->wait();
+    }
+    output_.flush();
+
+    ASSERT_EQ(threads.size() * count, messages_.size());
+    vector<size_t> next(threads.size(), 0);
+    for (size_t i = 0; i < messages_.size(); ++i) {
+        const size_t thread = boost::lexical_cast<size_t>(messages_[i].logger_);
+        ASSERT_LT(thread, threads.size());
+        EXPECT_EQ(boost::lexical_cast<string>(next[thread]),
+                  messages_[i].text_);
+        ++next[thread];
+    }
+}
+
+}
@@ -175,6 +175,63 @@ TEST_F(FormatterTest, multiPlaceholder) {
               "the first rule of tautology club", outputs[0].second);
 }
 
+// Test the arguments are only substituted into the original text
+TEST_F(FormatterTest, noSequentialReplace) {
+    Formatter(bundy::log::INFO, s("%1 %2"), this).arg("%2").arg(42);
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ("%2 42", outputs[0].second);
+}
+
+// Test more arguments than are held inline, and placeholders with several
+// digits
+TEST_F(FormatterTest, manyArgs) {
+    Formatter(bundy::log::INFO,
+              s("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10 %11 %1"), this).
+        arg(1).arg(2).arg(3).arg(4).arg(5).arg(6).arg(7).arg(8).arg(9).
+        arg(10).arg("eleven");
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ("1 2 3 4 5 6 7 8 9 10 eleven 1", outputs[0].second);
+}
+
+// Test the output of the formatter created from a parsed message, and that
+// the arguments survive copying of the formatter
+TEST_F(FormatterTest, parsedMessage) {
+    const bundy::log::ConstMessageTemplatePtr message(
+        new bundy::log::MessageTemplate("ID %2 and %1%"));
+    EXPECT_FALSE(message->hasPlaceholder(0));
+    EXPECT_TRUE(message->hasPlaceholder(1));
+    EXPECT_TRUE(message->hasPlaceholder(2));
+    EXPECT_FALSE(message->hasPlaceholder(3));
+    EXPECT_FALSE(message->hasPlaceholder(40));
+    {
+        Formatter formatter(bundy::log::WARN, message, this);
+        formatter.arg("first");
+        Formatter copy(formatter);
+        copy.arg(string("second"));
+    }
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ(bundy::log::WARN, outputs[0].first);
+    EXPECT_EQ("ID second and first%", outputs[0].second);
+    // The message can be used again.
+    Formatter(bundy::log::INFO, message, this).arg(1).arg(2);
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_EQ("ID 2 and 1%", outputs[1].second);
+}
+
+// The formatter keeps the parsed message alive even if its other owner (the
+// message dictionary, normally) releases it before the output
+TEST_F(FormatterTest, parsedMessageReleased) {
+    bundy::log::ConstMessageTemplatePtr message(
+        new bundy::log::MessageTemplate("ID %1"));
+    {
+        Formatter formatter(bundy::log::WARN, message, this);
+        message.reset();
+        formatter.arg("first");
+    }
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ("ID first", outputs[0].second);
+}
+
 // Test we can cope with replacement containing the placeholder
 TEST_F(FormatterTest, noRecurse) {
     // If we recurse, this will probably eat all the memory and crash
@@ -15,6 +15,7 @@
 #include <cstddef>
 #include <string>
 #include <gtest/gtest.h>
+#include <log/log_formatter.h>
 #include <log/message_dictionary.h>
 #include <log/message_initializer.h>
 #include <log/message_types.h>
@@ -177,6 +178,39 @@ TEST_F(MessageDictionaryTest, Lookups) {
     EXPECT_EQ(string(""), dictionary.getText("\n\n\n"));
 }
 
+// Check the parsed messages follow the text, and include the ID.
+
+TEST_F(MessageDictionaryTest, Templates) {
+    MessageDictionary dictionary;
+    EXPECT_TRUE(dictionary.getTemplate(alpha_id) == NULL);
+
+    EXPECT_TRUE(dictionary.add(alpha_id, "Alpha %1"));
+    ConstMessageTemplatePtr message = dictionary.getTemplate(alpha_id);
+    ASSERT_TRUE(message != NULL);
+    EXPECT_EQ(string("ALPHA Alpha %1"), message->getText());
+    EXPECT_TRUE(message->hasPlaceholder(1));
+    EXPECT_FALSE(message->hasPlaceholder(2));
+
+    // A failed addition doesn't change it...
+    EXPECT_FALSE(dictionary.add(alpha_id, "Other %1 %2"));
+    EXPECT_EQ(string("ALPHA Alpha %1"),
+              dictionary.getTemplate(alpha_id)->getText());
+
+    // ... but a replacement does.  The old message stays valid for whoever
+    // still holds it (e.g., a formatter being filled).
+    EXPECT_TRUE(dictionary.replace(alpha_id, "Other %1 %2"));
+    const ConstMessageTemplatePtr old_message = message;
+    message = dictionary.getTemplate("ALPHA");
+    ASSERT_TRUE(message != NULL);
+    EXPECT_EQ(string("ALPHA Other %1 %2"), message->getText());
+    EXPECT_TRUE(message->hasPlaceholder(2));
+    EXPECT_EQ(string("ALPHA Alpha %1"), old_message->getText());
+    EXPECT_FALSE(old_message->hasPlaceholder(2));
+
+    EXPECT_FALSE(dictionary.replace(beta_id, beta_text));
+    EXPECT_TRUE(dictionary.getTemplate(beta_id) == NULL);
+}
+
 // Check that the global dictionary is a singleton.
 
 TEST_F(MessageDictionaryTest, GlobalTest) {
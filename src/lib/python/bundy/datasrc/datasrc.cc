@@ -22,6 +22,7 @@
 #include <datasrc/database.h>
 #include <datasrc/sqlite3_accessor.h>
 #include <datasrc/zone_loader.h>
+#include <datasrc/zone_streamer.h>
 
 #include <log/message_initializer.h>
 
@@ -33,6 +34,7 @@
 #include "journal_reader_python.h"
 #include "configurableclientlist_python.h"
 #include "zone_loader_python.h"
+#include "zone_streamer_python.h"
 #include "zonetable_accessor_python.h"
 #include "zonetable_iterator_python.h"
 #include "zonewriter_python.h"
@@ -223,6 +225,37 @@ initModulePart_ZoneLoader(PyObject* mod) {
     return (true);
 }
 
+bool
+initModulePart_ZoneStreamer(PyObject* mod) {
+    if (PyType_Ready(&zone_streamer_type) < 0) {
+        return (false);
+    }
+    void* p = &zone_streamer_type;
+    if (PyModule_AddObject(mod, "ZoneStreamer",
+                           static_cast<PyObject*>(p)) < 0) {
+        return (false);
+    }
+    Py_INCREF(&zone_streamer_type);
+
+    try {
+        installClassVariable(zone_streamer_type, "DEFAULT_MAX_MESSAGE_SIZE",
+                             Py_BuildValue("I", static_cast<unsigned int>(
+                                 ZoneStreamer::DEFAULT_MAX_MESSAGE_SIZE)));
+    } catch (const std::exception& ex) {
+        const std::string ex_what =
+            "Unexpected failure in ZoneStreamer initialization: " +
+            std::string(ex.what());
+        PyErr_SetString(po_IscException, ex_what.c_str());
+        return (false);
+    } catch (...) {
+        PyErr_SetString(PyExc_SystemError,
+                        "Unexpected failure in ZoneStreamer initialization");
+        return (false);
+    }
+
+    return (true);
+}
+
 bool
 initModulePart_ZoneJournalReader(PyObject* mod) {
     if (PyType_Ready(&journal_reader_type) < 0) {
@@ -370,6 +403,11 @@ PyInit_datasrc(void) {
         return (NULL);
     }
 
+    if (!initModulePart_ZoneStreamer(mod)) {
+        Py_DECREF(mod);
+        return (NULL);
+    }
+
     if (!initModulePart_ConfigurableClientList(mod)) {
         Py_DECREF(mod);
         return (NULL);
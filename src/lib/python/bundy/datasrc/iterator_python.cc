@@ -237,6 +237,15 @@ createZoneIteratorObject(bundy::datasrc::ZoneIteratorPtr source,
     return (py_zi);
 }
 
+ZoneIteratorPtr
+PyZoneIterator_ToZoneIteratorPtr(PyObject* iterator_obj) {
+    if (iterator_obj == NULL) {
+        bundy_throw(PyCPPWrapperException,
+                    "argument NULL in ZoneIterator PyObject conversion");
+    }
+    return (static_cast<s_ZoneIterator*>(iterator_obj)->cppobj);
+}
+
 } // namespace python
 } // namespace datasrc
 } // namespace bundy
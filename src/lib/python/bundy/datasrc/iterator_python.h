@@ -35,6 +35,17 @@ extern PyTypeObject zoneiterator_type;
 PyObject* createZoneIteratorObject(bundy::datasrc::ZoneIteratorPtr source,
                                    PyObject* base_obj = NULL);
 
+/// \brief Returns the ZoneIterator pointer contained in the given Python
+///        object.
+///
+/// \note The given object MUST be of type ZoneIterator; this can be
+///       checked with the right call to ParseTuple("O!")
+///
+/// \param iterator_obj Python object holding the ZoneIterator
+/// \return shared pointer to the ZoneIterator object
+bundy::datasrc::ZoneIteratorPtr
+PyZoneIterator_ToZoneIteratorPtr(PyObject* iterator_obj);
+
 
 } // namespace python
 } // namespace datasrc
@@ -196,6 +196,15 @@ createZoneJournalReaderObject(ZoneJournalReaderPtr source,
     return (po);
 }
 
+ZoneJournalReaderPtr
+PyZoneJournalReader_ToZoneJournalReaderPtr(PyObject* reader_obj) {
+    if (reader_obj == NULL) {
+        bundy_throw(PyCPPWrapperException,
+                    "argument NULL in ZoneJournalReader PyObject conversion");
+    }
+    return (static_cast<s_ZoneJournalReader*>(reader_obj)->cppobj);
+}
+
 } // namespace python
 } // namespace datasrc
 } // namespace bundy
@@ -36,6 +36,17 @@ PyObject* createZoneJournalReaderObject(
     bundy::datasrc::ZoneJournalReaderPtr source,
     PyObject* base_obj = NULL);
 
+/// \brief Returns the ZoneJournalReader pointer contained in the given
+///        Python object.
+///
+/// \note The given object MUST be of type ZoneJournalReader; this can be
+///       checked with the right call to ParseTuple("O!")
+///
+/// \param reader_obj Python object holding the ZoneJournalReader
+/// \return shared pointer to the ZoneJournalReader object
+bundy::datasrc::ZoneJournalReaderPtr
+PyZoneJournalReader_ToZoneJournalReaderPtr(PyObject* reader_obj);
+
 
 } // namespace python
 } // namespace datasrc
@@ -25,7 +25,7 @@ RR_RDATA_INDEX = 7
 
 # Current major and minor versions of schema
 SCHEMA_MAJOR_VERSION = 2
-SCHEMA_MINOR_VERSION = 2
+SCHEMA_MINOR_VERSION = 3
 
 class Sqlite3DSError(Exception):
     """ Define exceptions."""
@@ -68,7 +68,9 @@ def create(cur):
                     ttl INTEGER NOT NULL,
                     rdtype TEXT NOT NULL COLLATE NOCASE,
                     sigtype TEXT COLLATE NOCASE,
-                    rdata TEXT NOT NULL)""")
+                    rdata TEXT NOT NULL,
+                    rdtype_code INTEGER,
+                    rdata_wire BLOB)""")
         cur.execute("CREATE INDEX records_byname ON records (name)")
         cur.execute("CREATE INDEX records_byrname ON records (rname)")
         cur.execute("""CREATE INDEX records_bytype_and_rname ON records
@@ -81,7 +83,9 @@ def create(cur):
                     owner TEXT NOT NULL COLLATE NOCASE,
                     ttl INTEGER NOT NULL,
                     rdtype TEXT NOT NULL COLLATE NOCASE,
-                    rdata TEXT NOT NULL)""")
+                    rdata TEXT NOT NULL,
+                    rdtype_code INTEGER,
+                    rdata_wire BLOB)""")
         cur.execute("CREATE INDEX nsec3_byhash ON nsec3 (hash)")
         cur.execute("CREATE INDEX nsec3_byhash_and_rdtype ON nsec3 (hash, rdtype)")
         cur.execute("""CREATE TABLE diffs (id INTEGER PRIMARY KEY,
@@ -0,0 +1,122 @@
+# Copyright (C) 2014  Internet Systems Consortium.
+#
+# Permission to use, copy, modify, and distribute this software for any
+# purpose with or without fee is hereby granted, provided that the above
+# copyright notice and this permission notice appear in all copies.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND INTERNET SYSTEMS CONSORTIUM
+# DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+# INTERNET SYSTEMS CONSORTIUM BE LIABLE FOR ANY SPECIAL, DIRECT,
+# INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+# FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+# NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+# WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+import bundy.log
+import bundy.datasrc
+from bundy.datasrc import ZoneStreamer
+from bundy.dns import *
+
+import os
+import struct
+import sys
+import unittest
+
+TESTDATA_PATH = os.environ['TESTDATA_PATH'] + os.sep
+DB_CONFIG = '{ "database_file": "' + TESTDATA_PATH + \
+    'example.com.sqlite3" }'
+
+class ZoneStreamerTest(unittest.TestCase):
+    def setUp(self):
+        self.zone_name = Name('example.com')
+        self.client = bundy.datasrc.DataSourceClient('sqlite3', DB_CONFIG)
+        self.iterator = self.client.get_iterator(self.zone_name, True)
+        self.soa = self.iterator.get_soa()
+        self.request = Message(Message.RENDER)
+        self.request.set_qid(0x1035)
+        self.request.set_opcode(Opcode.QUERY)
+        self.request.set_rcode(Rcode.NOERROR)
+        self.request.add_question(Question(self.zone_name, RRClass.IN,
+                                           RRType.AXFR))
+
+    def parse_messages(self, data):
+        '''Split the data into messages and return the list of them.'''
+        messages = []
+        while len(data) > 0:
+            length = struct.unpack('!H', data[:2])[0]
+            msg = Message(Message.PARSE)
+            msg.from_wire(data[2:2 + length], Message.PRESERVE_ORDER)
+            messages.append(msg)
+            data = data[2 + length:]
+        return messages
+
+    def get_all_data(self, streamer, size_limit):
+        result = b''
+        while True:
+            data = streamer.get_data(size_limit)
+            if len(data) == 0:
+                return result
+            result += data
+
+    def test_axfr(self):
+        # count the non SOA RRs of the zone (with a separate iterator)
+        rr_count = 0
+        for rrset in self.client.get_iterator(self.zone_name, True):
+            if rrset.get_type() != RRType.SOA:
+                rr_count += 1
+
+        streamer = ZoneStreamer(self.request, self.soa, self.iterator, None,
+                                512)
+        messages = self.parse_messages(self.get_all_data(streamer, 1024))
+        self.assertLess(1, len(messages))
+        self.assertEqual(len(messages), streamer.get_message_count())
+
+        answers = []
+        for msg in messages:
+            self.assertEqual(0x1035, msg.get_qid())
+            self.assertTrue(msg.get_header_flag(Message.HEADERFLAG_QR))
+            self.assertTrue(msg.get_header_flag(Message.HEADERFLAG_AA))
+            answers.extend(msg.get_section(Message.SECTION_ANSWER))
+        self.assertEqual(1, messages[0].get_rr_count(Message.SECTION_QUESTION))
+        self.assertEqual(RRType.SOA, answers[0].get_type())
+        self.assertEqual(RRType.SOA, answers[-1].get_type())
+        self.assertEqual(rr_count + 2, len(answers))
+
+    def test_single_soa(self):
+        streamer = ZoneStreamer(self.request, self.soa, None)
+        messages = self.parse_messages(self.get_all_data(streamer, 65535))
+        self.assertEqual(1, len(messages))
+        self.assertEqual(1, messages[0].get_rr_count(Message.SECTION_ANSWER))
+        self.assertEqual(b'', streamer.get_data(65535))
+
+    def test_sparse_signing(self):
+        # Without a TSIG context it has no effect.
+        streamer = ZoneStreamer(self.request, self.soa, None)
+        streamer.set_sparse_signing(True)
+        messages = self.parse_messages(self.get_all_data(streamer, 65535))
+        self.assertEqual(1, len(messages))
+        self.assertIsNone(messages[0].get_tsig_record())
+        self.assertRaises(TypeError, streamer.set_sparse_signing, 1)
+
+    def test_refcount(self):
+        orig_refcount = sys.getrefcount(self.iterator)
+        streamer = ZoneStreamer(self.request, self.soa, self.iterator)
+        self.assertEqual(orig_refcount + 1, sys.getrefcount(self.iterator))
+        streamer = None
+        self.assertEqual(orig_refcount, sys.getrefcount(self.iterator))
+
+    def test_bad_params(self):
+        self.assertRaises(TypeError, ZoneStreamer, self.request, self.soa,
+                          self.client)
+        self.assertRaises(TypeError, ZoneStreamer, self.request, self.soa,
+                          self.iterator, 'tsig')
+        self.assertRaises(TypeError, ZoneStreamer, self.request, self.soa)
+        self.assertRaises(bundy.dns.InvalidParameter, ZoneStreamer,
+                          self.request, self.soa, self.iterator, None,
+                          ZoneStreamer.DEFAULT_MAX_MESSAGE_SIZE + 1)
+
+if __name__ == "__main__":
+    bundy.log.init("bundy")
+    bundy.log.resetUnitTestRootLogger()
+    unittest.main()
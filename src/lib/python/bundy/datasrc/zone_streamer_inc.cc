@@ -0,0 +1,110 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+namespace {
+const char* const ZoneStreamer_doc = "\
+Builds the wire-format response messages of a zone transfer.\n\
+\n\
+This renders the whole sequence of DNS messages that answer an AXFR or\n\
+IXFR request: the leading SOA, the RRsets of the zone (for AXFR) or of\n\
+the diffs (for IXFR), and the trailing SOA. As many RRsets as possible\n\
+are packed into each message (with case-sensitive name compression, as\n\
+required by RFC5936), and each message is signed with the TSIG context,\n\
+if given (see set_sparse_signing() for signing only some of them).\n\
+\n\
+The messages are returned in the TCP format, i.e., each preceded by its\n\
+length as a 16-bit integer, a number of them at a time, so they can be\n\
+sent in a single write without handling the individual RRsets or\n\
+messages.\n\
+\n\
+ZoneStreamer(request, soa, source, tsig_ctx=None,\n\
+             max_message_size=DEFAULT_MAX_MESSAGE_SIZE)\n\
+\n\
+    If source is a ZoneIterator, the response is for AXFR (or AXFR-style\n\
+    IXFR); the SOA RRsets returned by the iterator are skipped, and soa\n\
+    is placed at the beginning and the end of the response instead.\n\
+    If source is a ZoneJournalReader, the response is for IXFR and all\n\
+    the RRsets from the reader are included. If source is None, the\n\
+    response consists of a single soa.\n\
+\n\
+    The query ID, opcode, question and the RD and CD flags of the\n\
+    response are taken from request.\n\
+\n\
+    Exceptions:\n\
+      InvalidParameter The request doesn't have a question or\n\
+                 max_message_size is larger than DEFAULT_MAX_MESSAGE_SIZE.\n\
+\n\
+    Parameters:\n\
+      request    (bundy.dns.Message) The transfer request.\n\
+      soa        (bundy.dns.RRset) The SOA RRset of the zone (version) to\n\
+                 transfer.\n\
+      source     (bundy.datasrc.ZoneIterator,\n\
+                 bundy.datasrc.ZoneJournalReader or None) The source of\n\
+                 the RRsets.\n\
+      tsig_ctx   (bundy.dns.TSIGContext or None) The TSIG context to sign\n\
+                 the messages with.\n\
+      max_message_size (int) The largest size of a message.\n\
+\n\
+";
+
+const char* const ZoneStreamer_getData_doc = "\
+get_data(size_limit) -> bytes\n\
+\n\
+Return the next messages of the response.\n\
+\n\
+This renders messages as long as their total length (including the\n\
+length fields) doesn't exceed size_limit (the message that would exceed\n\
+it is kept for the next call). At least one message is returned unless\n\
+the response is complete, so size_limit can be smaller than a single\n\
+message.\n\
+\n\
+Call this repeatedly until it returns an empty bytes object, which\n\
+means the response is complete.\n\
+\n\
+Exceptions:\n\
+  DataSourceError An RRset doesn't fit in a message by itself, or an\n\
+             error from the data source.\n\
+\n\
+Parameters:\n\
+  size_limit (int) The total length of the returned data this shouldn't\n\
+             exceed.\n\
+\n\
+Return Value(s): The messages in the TCP format (bytes).\n\
+";
+
+const char* const ZoneStreamer_setSparseSigning_doc = "\
+set_sparse_signing(sparse) -> None\n\
+\n\
+Sign only some of the messages with TSIG.\n\
+\n\
+If enabled, only the first and the last message are signed, and so is\n\
+every 100th message in between, as RFC2845 section 4.4 allows; the\n\
+others are sent without TSIG. The client must support verifying such\n\
+a sequence, so this is disabled by default and every message is\n\
+signed. It has no effect without a TSIG context.\n\
+\n\
+This should be called before the first get_data() call.\n\
+\n\
+Parameters:\n\
+  sparse     (bool) Whether to sign only some of the messages.\n\
+\n\
+";
+
+const char* const ZoneStreamer_getMessageCount_doc = "\
+get_message_count() -> int\n\
+\n\
+Return the number of messages rendered so far.\n\
+\n\
+";
+} // unnamed namespace
@@ -0,0 +1,276 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+// Enable this if you use s# variants with PyArg_ParseTuple(), see
+// http://docs.python.org/py3k/c-api/arg.html#strings-and-buffers
+//#define PY_SSIZE_T_CLEAN
+
+// Python.h needs to be placed at the head of the program file, see:
+// http://docs.python.org/py3k/extending/extending.html#a-simple-example
+#include <Python.h>
+
+#include <util/python/pycppwrapper_util.h>
+
+#include <datasrc/client.h>
+#include <datasrc/zone_streamer.h>
+#include <dns/python/message_python.h>
+#include <dns/python/rrset_python.h>
+#include <dns/python/tsig_python.h>
+#include <dns/python/pydnspp_common.h>
+#include <util/buffer.h>
+#include <exceptions/exceptions.h>
+
+#include <string>
+
+#include "datasrc.h"
+#include "iterator_python.h"
+#include "journal_reader_python.h"
+#include "zone_streamer_python.h"
+#include "zone_streamer_inc.cc"
+
+using namespace std;
+using namespace bundy::dns::python;
+using namespace bundy::datasrc;
+using namespace bundy::datasrc::python;
+using namespace bundy::util::python;
+using bundy::util::OutputBuffer;
+
+namespace {
+// The s_* Class simply covers one instantiation of the object
+class s_ZoneStreamer : public PyObject {
+public:
+    s_ZoneStreamer() : cppobj(NULL), buffer(NULL), source(NULL), tsig_ctx(NULL)
+        {};
+    ZoneStreamer* cppobj;
+    // reused for the data of each get_data() call
+    OutputBuffer* buffer;
+    // the streamer uses the iterator (or the reader) and the TSIG context
+    // of these objects, so add a ref to them at init
+    PyObject* source;
+    PyObject* tsig_ctx;
+};
+
+// General creation and destruction
+int
+ZoneStreamer_init(PyObject* po_self, PyObject* args, PyObject*) {
+    s_ZoneStreamer* self = static_cast<s_ZoneStreamer*>(po_self);
+    PyObject* po_request = NULL;
+    PyObject* po_soa = NULL;
+    PyObject* po_source = NULL;
+    PyObject* po_tsig_ctx = Py_None;
+    unsigned int max_message_size = ZoneStreamer::DEFAULT_MAX_MESSAGE_SIZE;
+    if (!PyArg_ParseTuple(args, "O!O!O|OI", &message_type, &po_request,
+                          &rrset_type, &po_soa, &po_source, &po_tsig_ctx,
+                          &max_message_size)) {
+        return (-1);
+    }
+    if (po_source != Py_None &&
+        !PyObject_TypeCheck(po_source, &zoneiterator_type) &&
+        !PyObject_TypeCheck(po_source, &journal_reader_type)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "ZoneStreamer source must be ZoneIterator, "
+                        "ZoneJournalReader or None");
+        return (-1);
+    }
+    if (po_tsig_ctx != Py_None && !PyTSIGContext_Check(po_tsig_ctx)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "ZoneStreamer tsig_ctx must be TSIGContext or None");
+        return (-1);
+    }
+    try {
+        // The associated objects must be alive during the lifetime
+        // of this instance, so incref them (through a container in case
+        // of exceptions in this method)
+        Py_INCREF(po_source);
+        PyObjectContainer source(po_source);
+        Py_INCREF(po_tsig_ctx);
+        PyObjectContainer tsig_ctx(po_tsig_ctx);
+
+        bundy::dns::TSIGContext* const cpp_tsig_ctx =
+            (po_tsig_ctx != Py_None) ?
+            PyTSIGContext_ToTSIGContext(po_tsig_ctx) : NULL;
+        if (PyObject_TypeCheck(po_source, &journal_reader_type)) {
+            self->cppobj = new ZoneStreamer(
+                PyMessage_ToMessage(po_request), PyRRset_ToRRsetPtr(po_soa),
+                PyZoneJournalReader_ToZoneJournalReaderPtr(po_source),
+                cpp_tsig_ctx, max_message_size);
+        } else {
+            self->cppobj = new ZoneStreamer(
+                PyMessage_ToMessage(po_request), PyRRset_ToRRsetPtr(po_soa),
+                (po_source != Py_None) ?
+                PyZoneIterator_ToZoneIteratorPtr(po_source) :
+                ZoneIteratorPtr(),
+                cpp_tsig_ctx, max_message_size);
+        }
+        self->buffer = new OutputBuffer(0);
+        self->source = source.release();
+        self->tsig_ctx = tsig_ctx.release();
+        return (0);
+    } catch (const bundy::InvalidParameter& ivp) {
+        PyErr_SetString(po_InvalidParameter, ivp.what());
+    } catch (const std::exception& stde) {
+        PyErr_SetString(getDataSourceException("Error"), stde.what());
+    } catch (...) {
+        PyErr_SetString(getDataSourceException("Error"),
+                        "Unexpected exception");
+    }
+    return (-1);
+}
+
+void
+ZoneStreamer_destroy(PyObject* po_self) {
+    s_ZoneStreamer* self = static_cast<s_ZoneStreamer*>(po_self);
+    // The streamer uses the source and the TSIG context, so delete it first.
+    delete self->cppobj;
+    self->cppobj = NULL;
+    delete self->buffer;
+    self->buffer = NULL;
+    if (self->source != NULL) {
+        Py_DECREF(self->source);
+    }
+    if (self->tsig_ctx != NULL) {
+        Py_DECREF(self->tsig_ctx);
+    }
+    Py_TYPE(self)->tp_free(self);
+}
+
+PyObject*
+ZoneStreamer_getData(PyObject* po_self, PyObject* args) {
+    s_ZoneStreamer* self = static_cast<s_ZoneStreamer*>(po_self);
+
+    unsigned int size_limit;
+    if (!PyArg_ParseTuple(args, "I", &size_limit)) {
+        return (NULL);
+    }
+    // Rendering and signing the messages doesn't touch any Python object,
+    // so other threads can run meanwhile.  No exception may leave the
+    // section without the GIL, so they are converted afterwards.
+    std::string error;
+    bool failed = false;
+    self->buffer->clear();
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        self->cppobj->fill(*self->buffer, size_limit);
+    } catch (const std::exception& exc) {
+        failed = true;
+        error = exc.what();
+    } catch (...) {
+        failed = true;
+        error = "Unexpected exception";
+    }
+    Py_END_ALLOW_THREADS
+
+    if (failed) {
+        PyErr_SetString(getDataSourceException("Error"), error.c_str());
+        return (NULL);
+    }
+    return (PyBytes_FromStringAndSize(
+                static_cast<const char*>(self->buffer->getData()),
+                self->buffer->getLength()));
+}
+
+PyObject*
+ZoneStreamer_setSparseSigning(PyObject* po_self, PyObject* args) {
+    s_ZoneStreamer* self = static_cast<s_ZoneStreamer*>(po_self);
+    PyObject* po_sparse;
+    if (!PyArg_ParseTuple(args, "O!", &PyBool_Type, &po_sparse)) {
+        return (NULL);
+    }
+    self->cppobj->setSparseSigning(po_sparse == Py_True);
+    Py_RETURN_NONE;
+}
+
+PyObject*
+ZoneStreamer_getMessageCount(PyObject* po_self, PyObject*) {
+    s_ZoneStreamer* self = static_cast<s_ZoneStreamer*>(po_self);
+    return (Py_BuildValue("I", static_cast<unsigned int>(
+                              self->cppobj->getMessageCount())));
+}
+
+// This list contains the actual set of functions we have in
+// python. Each entry has
+// 1. Python method name
+// 2. Our static function here
+// 3. Argument type
+// 4. Documentation
+PyMethodDef ZoneStreamer_methods[] = {
+    { "get_data", ZoneStreamer_getData, METH_VARARGS,
+      ZoneStreamer_getData_doc },
+    { "set_sparse_signing", ZoneStreamer_setSparseSigning, METH_VARARGS,
+      ZoneStreamer_setSparseSigning_doc },
+    { "get_message_count", ZoneStreamer_getMessageCount, METH_NOARGS,
+      ZoneStreamer_getMessageCount_doc },
+    { NULL, NULL, 0, NULL }
+};
+
+} // end of unnamed namespace
+
+namespace bundy {
+namespace datasrc {
+namespace python {
+
+PyTypeObject zone_streamer_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "datasrc.ZoneStreamer",
+    sizeof(s_ZoneStreamer),             // tp_basicsize
+    0,                                  // tp_itemsize
+    ZoneStreamer_destroy,               // tp_dealloc
+    NULL,                               // tp_print
+    NULL,                               // tp_getattr
+    NULL,                               // tp_setattr
+    NULL,                               // tp_reserved
+    NULL,                               // tp_repr
+    NULL,                               // tp_as_number
+    NULL,                               // tp_as_sequence
+    NULL,                               // tp_as_mapping
+    NULL,                               // tp_hash
+    NULL,                               // tp_call
+    NULL,                               // tp_str
+    NULL,                               // tp_getattro
+    NULL,                               // tp_setattro
+    NULL,                               // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,                 // tp_flags
+    ZoneStreamer_doc,
+    NULL,                               // tp_traverse
+    NULL,                               // tp_clear
+    NULL,                               // tp_richcompare
+    0,                                  // tp_weaklistoffset
+    NULL,                               // tp_iter
+    NULL,                               // tp_iternext
+    ZoneStreamer_methods,               // tp_methods
+    NULL,                               // tp_members
+    NULL,                               // tp_getset
+    NULL,                               // tp_base
+    NULL,                               // tp_dict
+    NULL,                               // tp_descr_get
+    NULL,                               // tp_descr_set
+    0,                                  // tp_dictoffset
+    ZoneStreamer_init,                  // tp_init
+    NULL,                               // tp_alloc
+    PyType_GenericNew,                  // tp_new
+    NULL,                               // tp_free
+    NULL,                               // tp_is_gc
+    NULL,                               // tp_bases
+    NULL,                               // tp_mro
+    NULL,                               // tp_cache
+    NULL,                               // tp_subclasses
+    NULL,                               // tp_weaklist
+    NULL,                               // tp_del
+    0,                                  // tp_version_tag
+    BUNDY_UTIL_PYTHON_PyVarObject_TAIL_INIT
+};
+
+} // namespace python
+} // namespace datasrc
+} // namespace bundy
@@ -552,6 +552,10 @@ class MappedSegmentInfo(SegmentInfo):
             'zone-' + str(rrclass) + '-' + str(genid) + '-' + datasrc_name + \
             '-mapped'
 
+        # Size of the address range to be reserved for the writer's segment
+        # (passed as "reserved-size"), or None if not configured.
+        self.__reserved_size = mgr_config.get('mapped_reserved_size')
+
         # Current versions (suffix of the mapped files) for readers and the
         # writer.  In this initial implementation we assume that all possible
         # readers are waiting for a new version (not using pre-existing one),
@@ -614,7 +618,12 @@ class MappedSegmentInfo(SegmentInfo):
 
         ver = self.__reader_ver if utype == self.READER else self.__writer_ver
         mapped_file = self.__mapped_file_base + '.' + str(ver)
-        return {'mapped-file': mapped_file}
+        param = {'mapped-file': mapped_file}
+        # Readers open the file read-only, so reservation only matters
+        # for the writer.
+        if utype == self.WRITER and self.__reserved_size is not None:
+            param['reserved-size'] = self.__reserved_size
+        return param
 
     def _start_validate(self):
         return self.__rvalidate_action, self.__wvalidate_action
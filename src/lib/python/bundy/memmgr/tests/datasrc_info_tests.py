@@ -72,6 +72,23 @@ class TestSegmentInfo(unittest.TestCase):
     def test_initial_params(self):
         self.__check_sgmt_reset_param(SegmentInfo.WRITER, 1)
         self.__check_sgmt_reset_param(SegmentInfo.READER, None)
+        # Without configuration no reservation is requested.
+        self.assertNotIn('reserved-size',
+                         self.__sgmt_info.get_reset_param(SegmentInfo.WRITER))
+
+    def test_reserved_size_param(self):
+        sgmt_info = SegmentInfo.create('mapped', 0, RRClass.IN, 'sqlite3',
+                                       {'mapped_file_dir':
+                                            self.__mapped_file_dir,
+                                        'mapped_reserved_size': 65536})
+        # Only the writer gets the reserved size; readers open the file
+        # read-only.
+        param = sgmt_info.get_reset_param(SegmentInfo.WRITER)
+        self.assertEqual(self.__mapped_file_base + '1', param['mapped-file'])
+        self.assertEqual(65536, param['reserved-size'])
+        sgmt_info._switch_versions() # make the reader file available
+        self.assertNotIn('reserved-size',
+                         sgmt_info.get_reset_param(SegmentInfo.READER))
 
         self.assertEqual(self.__sgmt_info.get_state(), SegmentInfo.INIT)
         self.assertEqual(self.__sgmt_info.get_generation_id(), 0)
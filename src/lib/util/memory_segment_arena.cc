@@ -0,0 +1,174 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <util/memory_segment_arena.h>
+#include <exceptions/exceptions.h>
+
+#include <new>
+
+namespace bundy {
+namespace util {
+
+namespace {
+// Alignment of the allocated memory.  It's the same as that of malloc()
+// on common systems, so any object can be stored.
+const size_t ALIGNMENT = 2 * sizeof(void*);
+
+size_t
+alignSize(size_t size) {
+    if (size == 0) {
+        // Give each allocation a distinct address.
+        size = 1;
+    }
+    return ((size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+}
+}
+
+// Definition of class static constant so it can be referenced by address
+// or reference.
+const size_t MemorySegmentArena::DEFAULT_CHUNK_SIZE;
+
+MemorySegmentArena::MemorySegmentArena(size_t chunk_size) :
+    chunk_size_(alignSize(chunk_size)), current_(NULL), current_end_(NULL),
+    size_(0), used_size_(0), allocated_size_(0)
+{
+    if (chunk_size == 0) {
+        bundy_throw(InvalidParameter, "Arena chunk size must not be 0");
+    }
+}
+
+MemorySegmentArena::~MemorySegmentArena() {
+    release();
+}
+
+char*
+MemorySegmentArena::allocateChunk(size_t size) {
+    char* const chunk = static_cast<char*>(malloc(size));
+    if (chunk == NULL) {
+        throw std::bad_alloc();
+    }
+    try {
+        chunks_.push_back(std::make_pair(chunk, size));
+    } catch (...) {
+        free(chunk);
+        throw;
+    }
+    size_ += size;
+    return (chunk);
+}
+
+void*
+MemorySegmentArena::allocate(size_t size) {
+    const size_t aligned_size = alignSize(size);
+    char* ptr;
+    if (aligned_size > chunk_size_ / 2) {
+        // Large ones get their own chunks, so they don't waste the rest
+        // of the current chunk.
+        ptr = allocateChunk(aligned_size);
+    } else {
+        if (aligned_size > static_cast<size_t>(current_end_ - current_)) {
+            char* const chunk = allocateChunk(chunk_size_);
+            // The rest of the previous chunk is lost.
+            used_size_ += current_end_ - current_;
+            current_ = chunk;
+            current_end_ = chunk + chunk_size_;
+        }
+        ptr = current_;
+        current_ += aligned_size;
+    }
+    used_size_ += aligned_size;
+    allocated_size_ += size;
+    return (ptr);
+}
+
+void
+MemorySegmentArena::deallocate(void* ptr, size_t size) {
+    if (ptr == NULL) {
+        // Return early if NULL is passed to be deallocated (without
+        // modifying allocated_size, or comparing against it).
+        return;
+    }
+
+    if (size > allocated_size_) {
+        bundy_throw(OutOfRange, "Invalid size to deallocate: " << size
+                    << "; currently allocated size: " << allocated_size_);
+    }
+
+    allocated_size_ -= size;
+    // The most recent allocation can simply be undone; this is a common
+    // pattern on failure of building an object.
+    const size_t aligned_size = alignSize(size);
+    if (static_cast<char*>(ptr) + aligned_size == current_) {
+        current_ -= aligned_size;
+        used_size_ -= aligned_size;
+    }
+}
+
+bool
+MemorySegmentArena::allMemoryDeallocated() const {
+    return (allocated_size_ == 0 && named_addrs_.empty());
+}
+
+void
+MemorySegmentArena::release() {
+    for (std::vector<std::pair<char*, size_t> >::const_iterator it =
+             chunks_.begin();
+         it != chunks_.end();
+         ++it) {
+        free(it->first);
+    }
+    chunks_.clear();
+    named_addrs_.clear();
+    current_ = current_end_ = NULL;
+    size_ = used_size_ = allocated_size_ = 0;
+}
+
+bool
+MemorySegmentArena::contains(const void* ptr) const {
+    const char* const cp = static_cast<const char*>(ptr);
+    for (std::vector<std::pair<char*, size_t> >::const_iterator it =
+             chunks_.begin();
+         it != chunks_.end();
+         ++it) {
+        if (cp >= it->first && cp < it->first + it->second) {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+MemorySegment::NamedAddressResult
+MemorySegmentArena::getNamedAddressImpl(const char* name) const {
+    std::map<std::string, void*>::const_iterator found =
+        named_addrs_.find(name);
+    if (found != named_addrs_.end()) {
+        return (NamedAddressResult(true, found->second));
+    }
+    return (NamedAddressResult(false, NULL));
+}
+
+bool
+MemorySegmentArena::setNamedAddressImpl(const char* name, void* addr) {
+    named_addrs_[name] = addr;
+    return (false);
+}
+
+bool
+MemorySegmentArena::clearNamedAddressImpl(const char* name) {
+    const size_t n_erased = named_addrs_.erase(name);
+    return (n_erased != 0);
+}
+
+} // namespace util
+} // namespace bundy
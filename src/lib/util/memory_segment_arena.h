@@ -0,0 +1,172 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef MEMORY_SEGMENT_ARENA_H
+#define MEMORY_SEGMENT_ARENA_H
+
+#include <util/memory_segment.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <string>
+#include <map>
+#include <vector>
+
+namespace bundy {
+namespace util {
+
+/// \brief Arena (bump allocator) based Memory Segment class
+///
+/// This implementation of \c MemorySegment takes memory from large chunks
+/// obtained with malloc(), handing out consecutive pieces of the current
+/// chunk.  This makes allocating many small objects (such as when loading
+/// a large zone) much cheaper than a malloc() call per object, and the
+/// objects don't fragment the heap.
+///
+/// The memory of deallocated objects is not reused (except for the most
+/// recently allocated one); it's only accounted as waste (see
+/// \c getWastedSize()).  All the memory is freed at once by \c release()
+/// or the destructor, so it's suitable for data that are built once and
+/// then discarded as a whole, like a version of zone data.
+class MemorySegmentArena : boost::noncopyable, public MemorySegment {
+public:
+    /// \brief The default size of the chunks, in bytes.
+    static const size_t DEFAULT_CHUNK_SIZE = 1024 * 1024;
+
+    /// \brief Constructor
+    ///
+    /// Creates an arena memory segment with no chunks; the first one is
+    /// allocated on the first call to \c allocate().
+    ///
+    /// \throw bundy::InvalidParameter chunk_size is 0.
+    ///
+    /// \param chunk_size The size of the chunks in bytes.  An allocation
+    /// larger than half of it gets a chunk of its own.
+    explicit MemorySegmentArena(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+    /// \brief Destructor
+    ///
+    /// Frees all the chunks, whether or not the memory allocated from them
+    /// has been deallocated.
+    virtual ~MemorySegmentArena();
+
+    /// \brief Allocate/acquire a segment of memory from the current chunk.
+    ///
+    /// Throws <code>std::bad_alloc</code> if a new chunk is needed and
+    /// can't be allocated.
+    ///
+    /// \param size The size of the memory requested in bytes.
+    /// \return Returns pointer to the memory allocated.
+    virtual void* allocate(size_t size);
+
+    /// \brief Free/release a segment of memory.
+    ///
+    /// The memory is only returned to the arena if it's the most recently
+    /// allocated one; otherwise it's counted as waste until the arena is
+    /// released.
+    ///
+    /// This method may throw <code>bundy::OutOfRange</code> if \c size is
+    /// larger than the total allocated size.
+    ///
+    /// \param ptr Pointer to the block of memory to free/release. This
+    /// should be equal to a value returned by <code>allocate()</code>.
+    /// \param size The size of the memory to be freed in bytes. This
+    /// should be equal to the number of bytes originally allocated.
+    virtual void deallocate(void* ptr, size_t size);
+
+    /// \brief Check if all allocated memory was deallocated.
+    ///
+    /// \return Returns <code>true</code> if all allocated memory was
+    /// deallocated, <code>false</code> otherwise.
+    virtual bool allMemoryDeallocated() const;
+
+    /// \brief Free all the chunks at once.
+    ///
+    /// Everything allocated from the arena becomes invalid, and the named
+    /// addresses are cleared.  The arena can be used again afterwards.
+    ///
+    /// \throw None
+    void release();
+
+    /// \brief Check if the given address belongs to one of the chunks.
+    ///
+    /// \throw None
+    bool contains(const void* ptr) const;
+
+    /// \brief Return the total size of the chunks in bytes.
+    ///
+    /// \throw None
+    size_t getSize() const { return (size_); }
+
+    /// \brief Return the number of bytes currently allocated (and not
+    /// deallocated) from the arena.
+    ///
+    /// \throw None
+    size_t getAllocatedSize() const { return (allocated_size_); }
+
+    /// \brief Return the number of bytes in the chunks that can't be used
+    /// any more until the arena is released.
+    ///
+    /// This includes the deallocated memory, the padding for alignment and
+    /// the unused ends of chunks that were too small for an allocation.
+    ///
+    /// \throw None
+    size_t getWastedSize() const { return (used_size_ - allocated_size_); }
+
+    /// \brief Arena segment version of getNamedAddress.
+    ///
+    /// There's a small chance this method could throw std::bad_alloc.
+    /// It should be considered a fatal error.
+    virtual NamedAddressResult getNamedAddressImpl(const char* name) const;
+
+    /// \brief Arena segment version of setNamedAddress.
+    ///
+    /// This version does not validate the given address to see whether it
+    /// belongs to this segment.  It always returns \c false, as the
+    /// segment never moves.
+    virtual bool setNamedAddressImpl(const char* name, void* addr);
+
+    /// \brief Arena segment version of clearNamedAddress.
+    ///
+    /// There's a small chance this method could throw std::bad_alloc.
+    /// It should be considered a fatal error.
+    virtual bool clearNamedAddressImpl(const char* name);
+
+private:
+    char* allocateChunk(size_t size);
+
+    const size_t chunk_size_;
+
+    // All chunks, as pairs of their beginning and size.
+    std::vector<std::pair<char*, size_t> > chunks_;
+
+    // The free part of the current chunk.
+    char* current_;
+    char* current_end_;
+
+    size_t size_;           // total size of the chunks
+    size_t used_size_;      // part of the chunks not available any more
+    size_t allocated_size_; // part of the used size actually allocated
+
+    std::map<std::string, void*> named_addrs_;
+};
+
+} // namespace util
+} // namespace bundy
+
+#endif // MEMORY_SEGMENT_ARENA_H
+
+// Local Variables:
+// mode: c++
+// End:
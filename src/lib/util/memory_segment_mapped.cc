@@ -29,6 +29,7 @@
 #include <new>
 
 #include <stdint.h>
+#include <sys/mman.h>
 
 // boost::interprocess namespace is big and can cause unexpected import
 // (e.g., it has "read_only"), so it's safer to be specific for shortcuts.
@@ -75,8 +76,10 @@ struct MemorySegmentMapped::Impl {
     // tricky because we want to remove any existing file but we also want
     // to detect possible conflict with other readers or writers using
     // file lock.
-    Impl(const std::string& filename, create_only_t, size_t initial_size) :
-        read_only_(false), filename_(filename)
+    Impl(const std::string& filename, create_only_t, size_t initial_size,
+         size_t reserved_size) :
+        read_only_(false), filename_(filename), reserved_base_(NULL),
+        reserved_size_(reserved_size), released_size_(0)
     {
         try {
             // First, try opening it in boost create_only mode; it fails if
@@ -109,36 +112,49 @@ struct MemorySegmentMapped::Impl {
         // confirm there's no other user and there won't either.
         lock_.reset(new boost::interprocess::file_lock(filename.c_str()));
         checkWriter();
+        reserveAddressSpace();
         reserveMemory();
     }
 
     // Constructor for open-or-write (and read-write) mode
-    Impl(const std::string& filename, open_or_create_t, size_t initial_size) :
+    Impl(const std::string& filename, open_or_create_t, size_t initial_size,
+         size_t reserved_size) :
         read_only_(false), filename_(filename),
         base_sgmt_(new BaseSegment(open_or_create, filename.c_str(),
                                    initial_size)),
+        reserved_base_(NULL), reserved_size_(reserved_size),
+        released_size_(0),
         lock_(new boost::interprocess::file_lock(filename.c_str()))
     {
         checkWriter();
+        reserveAddressSpace();
         reserveMemory();
     }
 
     // Constructor for existing segment, either read-only or read-write
-    Impl(const std::string& filename, bool read_only) :
+    Impl(const std::string& filename, bool read_only, size_t reserved_size) :
         read_only_(read_only), filename_(filename),
         base_sgmt_(read_only_ ?
                    new BaseSegment(open_read_only, filename.c_str()) :
                    new BaseSegment(open_only, filename.c_str())),
+        reserved_base_(NULL), reserved_size_(reserved_size),
+        released_size_(0),
         lock_(new boost::interprocess::file_lock(filename.c_str()))
     {
         if (read_only_) {
             checkReader();
         } else {
             checkWriter();
+            reserveAddressSpace();
         }
         reserveMemory();
     }
 
+    ~Impl() {
+        base_sgmt_.reset();
+        releaseAddressSpace();
+    }
+
     void reserveMemory(bool no_grow = false) {
         if (!read_only_) {
             // Reserve a named address for use during
@@ -170,8 +186,121 @@ struct MemorySegmentMapped::Impl {
         }
     }
 
-    // Internal helper to grow the underlying mapped segment.
-    void growSegment() {
+    // Reserve an address range of reserved_size_ bytes and move the segment
+    // to its beginning.  The rest of the range is kept inaccessible (and
+    // doesn't consume memory or swap), so the segment can later grow in
+    // place, without changing its base address.  If the range can't be
+    // reserved, the segment is used without it.
+    void reserveAddressSpace() {
+        reserved_size_ = roundToPages(reserved_size_);
+        const size_t size = base_sgmt_->get_size();
+        if (reserved_size_ <= size) {
+            return;
+        }
+        int flags = MAP_PRIVATE | MAP_ANON;
+#ifdef MAP_NORESERVE
+        flags |= MAP_NORESERVE;
+#endif
+        void* const addr = mmap(NULL, reserved_size_, PROT_NONE, flags, -1, 0);
+        if (addr == MAP_FAILED) {
+            return;
+        }
+        const void* const prev_addr = base_sgmt_->get_address();
+        base_sgmt_.reset();
+        reserved_base_ = static_cast<char*>(addr);
+        releaseAddressSpace(size);
+        try {
+            remapSegment(prev_addr);
+        } catch (...) {
+            // The destructor won't be called.
+            releaseAddressSpace();
+            throw;
+        }
+    }
+
+    // Round the size up to whole pages, which the mappings consist of.
+    static size_t roundToPages(size_t size) {
+        const size_t pagesize =
+            boost::interprocess::mapped_region::get_page_size();
+        return ((size + pagesize - 1) / pagesize * pagesize);
+    }
+
+    // Give the first size bytes of the reserved range to the segment.  If
+    // the segment doesn't fit in the range any more, the whole reservation
+    // is dropped.
+    void releaseAddressSpace(size_t size) {
+        size = roundToPages(size);
+        if (!reserved_base_ || size <= released_size_) {
+            return;
+        }
+        if (size > reserved_size_) {
+            releaseAddressSpace();
+            return;
+        }
+        munmap(reserved_base_ + released_size_, size - released_size_);
+        released_size_ = size;
+    }
+
+    // Drop the remaining part of the reserved range, if any.
+    void releaseAddressSpace() {
+        if (reserved_base_ && reserved_size_ > released_size_) {
+            munmap(reserved_base_ + released_size_,
+                   reserved_size_ - released_size_);
+        }
+        reserved_base_ = NULL;
+    }
+
+    // Take the range beyond the first size bytes back into the reservation
+    // after the segment has shrunk.  If it can't be done, the whole
+    // reservation is dropped.
+    void retainAddressSpace(size_t size) {
+        size = roundToPages(size);
+        if (!reserved_base_ || size >= released_size_) {
+            return;
+        }
+        int flags = MAP_PRIVATE | MAP_ANON;
+#ifdef MAP_NORESERVE
+        flags |= MAP_NORESERVE;
+#endif
+        void* const hint = reserved_base_ + size;
+        void* const addr = mmap(hint, released_size_ - size, PROT_NONE,
+                                flags, -1, 0);
+        if (addr == hint) {
+            released_size_ = size;
+            return;
+        }
+        if (addr != MAP_FAILED) {
+            munmap(addr, released_size_ - size);
+        }
+        releaseAddressSpace();
+    }
+
+    // Map the file after it was unmapped for resizing.  If an address range
+    // is reserved, the segment is mapped at its beginning; it can only fail
+    // if some other mapping took the released part of the range in the
+    // meantime, in which case the reservation is dropped and the file is
+    // mapped anywhere.  Mapping anywhere can throw.  It returns true if the
+    // segment is not known to be at the same base address.
+    bool remapSegment(const void* prev_addr) {
+        if (reserved_base_) {
+            try {
+                base_sgmt_.reset(new BaseSegment(open_only, filename_.c_str(),
+                                                 reserved_base_));
+                return (base_sgmt_->get_address() != prev_addr);
+            } catch (const boost::interprocess::interprocess_exception&) {
+                releaseAddressSpace();
+            }
+        }
+        // Even if it happens to be mapped at the same address, we report
+        // it as moved, as is expected for segments without a reservation.
+        base_sgmt_.reset(new BaseSegment(open_only, filename_.c_str()));
+        return (true);
+    }
+
+    // Internal helper to grow the underlying mapped segment.  It returns
+    // true if the base address of the segment has changed, i.e., if the
+    // addresses in the segment have been invalidated.
+    bool growSegment() {
         // We first need to unmap it before calling grow().  We also flush
         // the segment to the disk here, so we can incrementally synchronize
         // dirty pages as the segment grows.  In typical cases, if the segment
@@ -181,6 +310,7 @@ struct MemorySegmentMapped::Impl {
         // we can avoid a big pause (some operating system seems to sync
         // dirty pages before reading them).
         const size_t prev_size = base_sgmt_->get_size();
+        const void* const prev_addr = base_sgmt_->get_address();
         base_sgmt_->flush();
         base_sgmt_.reset();
 
@@ -202,6 +332,9 @@ struct MemorySegmentMapped::Impl {
 
         const bool grown = BaseSegment::grow(filename_.c_str(),
                                              new_size - prev_size);
+        if (grown) {
+            releaseAddressSpace(new_size);
+        }
 
         // Remap the file, whether or not grow() succeeded.  this should
         // normally succeed(*), but it's not 100% guaranteed.  We abort
@@ -209,14 +342,16 @@ struct MemorySegmentMapped::Impl {
         // (*) Although it's not formally documented, the implementation
         // of grow() seems to provide strong guarantee, i.e, if it fails
         // the underlying file can be used with the previous size.
+        bool relocated = true;
         try {
-            base_sgmt_.reset(new BaseSegment(open_only, filename_.c_str()));
+            relocated = remapSegment(prev_addr);
         } catch (...) {
             abort();
         }
         if (!grown) {
             throw std::bad_alloc();
         }
+        return (relocated);
     }
 
     // remember if the segment is opened read-only or not
@@ -228,6 +363,13 @@ struct MemorySegmentMapped::Impl {
     // actual Boost implementation of mapped segment.
     boost::scoped_ptr<BaseSegment> base_sgmt_;
 
+    // The reserved address range (reserved_base_ is NULL if there's none).
+    // The first released_size_ bytes of it are given to the segment, and
+    // the rest is mapped inaccessible.
+    char* reserved_base_;
+    size_t reserved_size_;
+    size_t released_size_;
+
 private:
     // helper methods and member to detect any reader-writer conflict at
     // the time of construction using an advisory file lock.  The lock will
@@ -257,7 +399,7 @@ MemorySegmentMapped::MemorySegmentMapped(const std::string& filename) :
     impl_(NULL)
 {
     try {
-        impl_ = new Impl(filename, true);
+        impl_ = new Impl(filename, true, 0);
     } catch (const boost::interprocess::interprocess_exception& ex) {
         bundy_throw(MemorySegmentOpenError,
                   "failed to open mapped memory segment for " << filename
@@ -266,19 +408,22 @@ MemorySegmentMapped::MemorySegmentMapped(const std::string& filename) :
 }
 
 MemorySegmentMapped::MemorySegmentMapped(const std::string& filename,
-                                         OpenMode mode, size_t initial_size) :
+                                         OpenMode mode, size_t initial_size,
+                                         size_t reserved_size) :
     impl_(NULL)
 {
     try {
         switch (mode) {
         case OPEN_FOR_WRITE:
-            impl_ = new Impl(filename, false);
+            impl_ = new Impl(filename, false, reserved_size);
             break;
         case OPEN_OR_CREATE:
-            impl_ = new Impl(filename, open_or_create, initial_size);
+            impl_ = new Impl(filename, open_or_create, initial_size,
+                             reserved_size);
             break;
         case CREATE_ONLY:
-            impl_ = new Impl(filename, create_only, initial_size);
+            impl_ = new Impl(filename, create_only, initial_size,
+                             reserved_size);
             break;
         default:
             bundy_throw(InvalidParameter,
@@ -315,10 +460,19 @@ MemorySegmentMapped::allocate(size_t size) {
     }
 
     // Grow the mapped segment doubling the size until we have sufficient
-    // free memory in the revised segment for the requested size.
+    // free memory in the revised segment for the requested size.  If it
+    // has grown in the reserved address range, the addresses are still
+    // valid, and we can simply allocate the memory.
+    bool relocated = false;
     do {
-        impl_->growSegment();
+        relocated = impl_->growSegment() || relocated;
     } while (impl_->base_sgmt_->get_free_memory() < size);
+    if (!relocated) {
+        void* ptr = impl_->base_sgmt_->allocate(size, std::nothrow);
+        if (ptr) {
+            return (ptr);
+        }
+    }
     bundy_throw(MemorySegmentGrown, "mapped memory segment grown, size: "
               << impl_->base_sgmt_->get_size() << ", free size: "
               << impl_->base_sgmt_->get_free_memory());
@@ -401,8 +555,7 @@ MemorySegmentMapped::setNamedAddressImpl(const char* name, void* addr) {
             return (grown);
         }
 
-        impl_->growSegment();
-        grown = true;
+        grown = impl_->growSegment() || grown;
     }
 }
 
@@ -437,6 +590,7 @@ MemorySegmentMapped::shrinkToFit() {
     }
 
     // First, unmap the underlying file.
+    const void* const prev_addr = impl_->base_sgmt_->get_address();
     impl_->base_sgmt_.reset();
 
     BaseSegment::shrink_to_fit(impl_->filename_.c_str());
@@ -449,12 +603,12 @@ MemorySegmentMapped::shrinkToFit() {
         // called after shrinkToFit() (and the destructor can still be called
         // safely), so we give the application an opportunity to handle the
         // case as gracefully as possible.
-        impl_->base_sgmt_.reset(
-            new BaseSegment(open_only, impl_->filename_.c_str()));
+        impl_->remapSegment(prev_addr);
     } catch (const boost::interprocess::interprocess_exception& ex) {
         bundy_throw(MemorySegmentError,
                   "remap after shrink failed; segment is now unusable");
     }
+    impl_->retainAddressSpace(impl_->base_sgmt_->get_size());
 
     // Flush possible dirty pages after shrinking the segment.  As documented
     // in growSegment(), we don't expect too much memory to be flushed here,
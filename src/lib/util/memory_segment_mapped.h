@@ -139,14 +139,27 @@ public:
     /// does not specify how large it should be, but the default
     /// \c INITIAL_SIZE should be sufficiently large in practice.
     ///
+    /// If \c reserved_size is larger than the size of the file, a range of
+    /// addresses of that size is reserved (without consuming memory), and
+    /// the file is mapped at its beginning.  The segment then grows within
+    /// the range without changing its base address, so \c allocate() and
+    /// \c setNamedAddress() don't report the growth to the caller (see
+    /// there), until the segment outgrows the range.  If the range can't be
+    /// reserved, the segment works as if \c reserved_size were 0.  As it
+    /// only consumes address space, it can be much larger than the expected
+    /// size of the segment on 64-bit systems.
+    ///
     /// \throw MemorySegmentOpenError see the description.
     ///
     /// \param filename The file name to be mapped to memory.
     /// \param mode Open mode (see the description).
     /// \param initial_size Specifies the size of the newly created file;
     /// ignored if \c mode is OPEN_FOR_WRITE.
+    /// \param reserved_size The size of the address range to reserve for
+    /// the segment, 0 if none.
     MemorySegmentMapped(const std::string& filename, OpenMode mode,
-                        size_t initial_size = INITIAL_SIZE);
+                        size_t initial_size = INITIAL_SIZE,
+                        size_t reserved_size = 0);
 
     /// \brief Destructor.
     ///
@@ -158,9 +171,11 @@ public:
 
     /// \brief Allocate/acquire a segment of memory.
     ///
-    /// This version can throw \c MemorySegmentGrown.  Furthermore, there is
-    /// a very small chance that the object loses its integrity and can't be
-    /// usable in the case where \c MemorySegmentGrown would be thrown.
+    /// This version can throw \c MemorySegmentGrown, unless the segment
+    /// could grow within the address range reserved on construction, in
+    /// which case the memory is allocated from the grown segment.
+    /// Furthermore, there is a very small chance that the object loses its
+    /// integrity and can't be usable in the case where the segment grows.
     /// In this case, throwing a different exception wouldn't help, because
     /// an application trying to provide exception safety might then call
     /// deallocate() or named address APIs on this object, which would simply
@@ -201,7 +216,8 @@ public:
     /// it internally allocates memory in the segment for the name and
     /// address to be stored, which can require segment extension, just like
     /// allocate().  So it's possible to return true unlike
-    /// \c MemorySegmentLocal version of the method.
+    /// \c MemorySegmentLocal version of the method (except if the segment
+    /// grows within its reserved address range).
     ///
     /// This method cannot be called if the segment object is created in the
     /// read-only mode; in that case MemorySegmentError will be thrown.
@@ -0,0 +1,140 @@
+// Copyright (C) 2014  Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <util/tests/memory_segment_common_unittest.h>
+
+#include <util/memory_segment_arena.h>
+#include <exceptions/exceptions.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include <stdint.h>
+
+using namespace bundy::util;
+
+namespace {
+
+const size_t CHUNK_SIZE = 4096;
+
+TEST(MemorySegmentArena, allocate) {
+    MemorySegmentArena segment(CHUNK_SIZE);
+
+    // By default, nothing is allocated, and there's no chunk.
+    EXPECT_TRUE(segment.allMemoryDeallocated());
+    EXPECT_EQ(0, segment.getSize());
+
+    // Allocations are consecutive in a chunk, and aligned.
+    void* ptr1 = segment.allocate(10);
+    void* ptr2 = segment.allocate(42);
+    EXPECT_FALSE(segment.allMemoryDeallocated());
+    EXPECT_EQ(CHUNK_SIZE, segment.getSize());
+    EXPECT_EQ(52, segment.getAllocatedSize());
+    EXPECT_LT(ptr1, ptr2);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr2) % sizeof(void*));
+    EXPECT_TRUE(segment.contains(ptr1));
+    EXPECT_TRUE(segment.contains(ptr2));
+    EXPECT_FALSE(segment.contains(&segment));
+
+    // The memory is usable.
+    std::memset(ptr1, 0, 10);
+    std::memset(ptr2, 0, 42);
+
+    // Deallocating something other than the last allocation only makes
+    // it wasted.
+    const size_t prev_wasted = segment.getWastedSize();
+    segment.deallocate(ptr1, 10);
+    EXPECT_EQ(prev_wasted + 10, segment.getWastedSize());
+    EXPECT_FALSE(segment.allMemoryDeallocated());
+
+    // The last one is returned to the arena, so it's reused.
+    segment.deallocate(ptr2, 42);
+    EXPECT_TRUE(segment.allMemoryDeallocated());
+    EXPECT_EQ(ptr2, segment.allocate(42));
+    segment.deallocate(ptr2, 42);
+
+    // Too large size for deallocation.
+    void* ptr3 = segment.allocate(100);
+    EXPECT_THROW(segment.deallocate(ptr3, 200), bundy::OutOfRange);
+    segment.deallocate(ptr3, 100);
+
+    // NULL deallocation is a no-op.
+    EXPECT_NO_THROW(segment.deallocate(NULL, 1024));
+    EXPECT_TRUE(segment.allMemoryDeallocated());
+}
+
+TEST(MemorySegmentArena, chunks) {
+    MemorySegmentArena segment(CHUNK_SIZE);
+
+    // Fill most of a chunk; the next allocation doesn't fit in the rest
+    // and a new chunk is allocated, wasting the rest.
+    void* ptr1 = segment.allocate(CHUNK_SIZE / 2);
+    void* ptr2 = segment.allocate(CHUNK_SIZE / 4);
+    EXPECT_EQ(CHUNK_SIZE, segment.getSize());
+    EXPECT_EQ(0, segment.getWastedSize());
+    void* ptr3 = segment.allocate(CHUNK_SIZE / 2);
+    EXPECT_EQ(CHUNK_SIZE * 2, segment.getSize());
+    EXPECT_EQ(CHUNK_SIZE / 4, segment.getWastedSize());
+
+    // A large allocation gets its own chunk, and the current chunk is
+    // still used after that.
+    void* ptr4 = segment.allocate(CHUNK_SIZE * 3);
+    EXPECT_EQ(CHUNK_SIZE * 5, segment.getSize());
+    EXPECT_TRUE(segment.contains(ptr4));
+    EXPECT_TRUE(segment.contains(static_cast<char*>(ptr4) +
+                                 CHUNK_SIZE * 3 - 1));
+    std::memset(ptr4, 0, CHUNK_SIZE * 3);
+    void* ptr5 = segment.allocate(CHUNK_SIZE / 4);
+    EXPECT_EQ(CHUNK_SIZE * 5, segment.getSize());
+    EXPECT_EQ(static_cast<char*>(ptr3) + CHUNK_SIZE / 2, ptr5);
+
+    segment.deallocate(ptr1, CHUNK_SIZE / 2);
+    segment.deallocate(ptr2, CHUNK_SIZE / 4);
+    segment.deallocate(ptr3, CHUNK_SIZE / 2);
+    segment.deallocate(ptr4, CHUNK_SIZE * 3);
+    segment.deallocate(ptr5, CHUNK_SIZE / 4);
+    EXPECT_TRUE(segment.allMemoryDeallocated());
+    EXPECT_EQ(CHUNK_SIZE * 5, segment.getSize());
+}
+
+TEST(MemorySegmentArena, release) {
+    MemorySegmentArena segment(CHUNK_SIZE);
+    void* ptr = segment.allocate(CHUNK_SIZE);
+    segment.allocate(10);
+    segment.setNamedAddress("test address", ptr);
+    EXPECT_FALSE(segment.allMemoryDeallocated());
+
+    // Everything is freed at once, including the named addresses.
+    segment.release();
+    EXPECT_TRUE(segment.allMemoryDeallocated());
+    EXPECT_EQ(0, segment.getSize());
+    EXPECT_EQ(0, segment.getWastedSize());
+    EXPECT_FALSE(segment.contains(ptr));
+    EXPECT_FALSE(segment.getNamedAddress("test address").first);
+
+    // It can be used again.
+    ptr = segment.allocate(10);
+    EXPECT_TRUE(segment.contains(ptr));
+}
+
+TEST(MemorySegmentArena, badChunkSize) {
+    EXPECT_THROW(MemorySegmentArena(0), bundy::InvalidParameter);
+}
+
+TEST(MemorySegmentArena, namedAddress) {
+    MemorySegmentArena segment;
+    bundy::util::test::checkSegmentNamedAddress(segment, true);
+}
+
+} // anonymous namespace
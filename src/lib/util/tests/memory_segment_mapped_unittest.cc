@@ -236,6 +236,83 @@ TEST_F(MemorySegmentMappedTest, allocate) {
     // will be removed at the end of the test)
 }
 
+TEST_F(MemorySegmentMappedTest, allocateInReservedSpace) {
+    // With a reserved address range, the segment grows in place, so
+    // allocate() doesn't have to throw MemorySegmentGrown.
+    const size_t reserved_size = 64 * 1024 * 1024;
+    segment_.reset();
+    segment_.reset(new MemorySegmentMapped(mapped_file, CREATE_ONLY,
+                                           DEFAULT_INITIAL_SIZE,
+                                           reserved_size));
+    void* ptr = segment_->allocate(sizeof(uint32_t));
+    *static_cast<uint32_t*>(ptr) = 42;
+    EXPECT_FALSE(segment_->setNamedAddress("test address", ptr));
+
+    const size_t prev_size = segment_->getSize();
+    void* large_ptr = NULL;
+    EXPECT_NO_THROW(large_ptr = segment_->allocate(prev_size * 10));
+    EXPECT_NE(static_cast<void*>(NULL), large_ptr);
+    EXPECT_EQ(prev_size * 16, segment_->getSize());
+
+    // The address allocated before is still valid.
+    EXPECT_EQ(ptr, segment_->getNamedAddress("test address").second);
+    EXPECT_EQ(42, *static_cast<uint32_t*>(ptr));
+
+    // Shrinking the segment doesn't move it either, and it can grow in
+    // place again.
+    segment_->deallocate(large_ptr, prev_size * 10);
+    segment_->shrinkToFit();
+    EXPECT_GT(prev_size * 16, segment_->getSize());
+    EXPECT_EQ(ptr, segment_->getNamedAddress("test address").second);
+    EXPECT_NO_THROW(large_ptr = segment_->allocate(prev_size * 10));
+    EXPECT_EQ(ptr, segment_->getNamedAddress("test address").second);
+    EXPECT_EQ(42, *static_cast<uint32_t*>(ptr));
+    segment_->deallocate(large_ptr, prev_size * 10);
+
+    // An existing file can be opened with a reserved range, too.
+    segment_.reset();
+    segment_.reset(new MemorySegmentMapped(mapped_file, OPEN_FOR_WRITE,
+                                           DEFAULT_INITIAL_SIZE,
+                                           reserved_size));
+    ptr = segment_->getNamedAddress("test address").second;
+    EXPECT_EQ(42, *static_cast<uint32_t*>(ptr));
+    EXPECT_NO_THROW(large_ptr =
+                    segment_->allocate(segment_->getSize() * 2));
+    EXPECT_EQ(ptr, segment_->getNamedAddress("test address").second);
+    segment_->deallocate(large_ptr, 0);
+    segment_->deallocate(ptr, sizeof(uint32_t));
+    EXPECT_TRUE(segment_->clearNamedAddress("test address"));
+    EXPECT_TRUE(segment_->allMemoryDeallocated());
+}
+
+TEST_F(MemorySegmentMappedTest, smallReservedSpace) {
+    // A reserved range that the file doesn't fit in is ignored.
+    segment_.reset();
+    segment_.reset(new MemorySegmentMapped(mapped_file, CREATE_ONLY,
+                                           DEFAULT_INITIAL_SIZE,
+                                           DEFAULT_INITIAL_SIZE));
+    const size_t prev_size = segment_->getSize();
+    EXPECT_THROW(segment_->allocate(prev_size + 1), MemorySegmentGrown);
+    EXPECT_EQ(prev_size * 2, segment_->getSize());
+
+    // Likewise, the segment can outgrow the range; it then works as usual.
+    segment_.reset();
+    segment_.reset(new MemorySegmentMapped(mapped_file, CREATE_ONLY,
+                                           DEFAULT_INITIAL_SIZE,
+                                           DEFAULT_INITIAL_SIZE * 2));
+    void* ptr = NULL;
+    EXPECT_NO_THROW(ptr = segment_->allocate(prev_size + 1));
+    segment_->deallocate(ptr, prev_size + 1);
+    while (true) {
+        try {
+            ptr = segment_->allocate(prev_size * 10);
+            break;
+        } catch (const MemorySegmentGrown&) {}
+    }
+    EXPECT_EQ(prev_size * 16, segment_->getSize());
+    segment_->deallocate(ptr, prev_size * 10);
+}
+
 TEST_F(MemorySegmentMappedTest, badAllocate) {
     // If the test is run as the root user, the following allocate()
     // call will result in a successful MemorySegmentGrown exception,
@@ -194,11 +194,10 @@ private:
 /// Note that \c mutex passed to the \c wait() method must be the same one
 /// used to construct the \c locker.
 ///
-/// Right now there is no equivalent to pthread_cond_broadcast() or
-/// pthread_cond_timedwait() in this class, because this class is meant
-/// for internal development of BUNDY and we don't need these at the
-/// moment.  If and when we need these interfaces they can be added at that
-/// point.
+/// Right now there is no equivalent to pthread_cond_timedwait() in this
+/// class, because this class is meant for internal development of BUNDY
+/// and we don't need it at the moment.  If and when we need this interface
+/// it can be added at that point.
 ///
 /// \note This class is defined as a friend class of \c Mutex and directly
 /// refers to and modifies private internals of the \c Mutex class.  It breaks
@@ -248,6 +247,15 @@ public:
     /// This method never throws; if some unexpected low level error happens
     /// it terminates the program.
     void signal();
+
+    /// \brief Unblock all threads waiting for the condition variable.
+    ///
+    /// This method works like \c pthread_cond_broadcast().  It wakes all
+    /// threads (if any) waiting on this object via the \c wait() call.
+    ///
+    /// This method never throws; if some unexpected low level error happens
+    /// it terminates the program.
+    void broadcast();
 private:
     class Impl;
     Impl* impl_;
@@ -130,6 +130,7 @@ CommandOptions::reset() {
     is_interface_ = false;
     preload_ = 0;
     aggressivity_ = 1;
+    threads_num_ = 1;
     local_port_ = 0;
     seeded_ = false;
     seed_ = 0;
@@ -212,7 +213,7 @@ CommandOptions::initialize(int argc, char** argv, bool print_cmd_line) {
     // In this section we collect argument values from command line
     // they will be tuned and validated elsewhere
     while((opt = getopt(argc, argv, "hv46r:t:R:b:n:p:d:D:l:P:a:L:"
-                        "s:iBc1T:X:O:E:S:I:x:w:e:f:F:")) != -1) {
+                        "s:iBc1T:X:O:E:S:I:x:w:e:f:F:g:")) != -1) {
         stream << " -" << static_cast<char>(opt);
         if (optarg) {
             stream << " " << optarg;
@@ -314,6 +315,12 @@ CommandOptions::initialize(int argc, char** argv, bool print_cmd_line) {
                                             " positive integer");
             break;
 
+        case 'g':
+            threads_num_ = positiveInteger("value of the number of threads:"
+                                           " -g<threads> must be a positive"
+                                           " integer");
+            break;
+
         case 'h':
             usage();
             return (true);
@@ -763,6 +770,20 @@ CommandOptions::validate() const {
     check((getTemplateFiles().size() < 2) && (getRequestedIpOffset() >= 0),
           "second/request -T<template-file> must be set to "
           "use -I<ip-offset>");
+    check((getThreadsNum() > 1) && !getTemplateFiles().empty(),
+          "-T<template-file> is not compatible with -g<threads>");
+    check((getThreadsNum() > 1) &&
+          ((getRenewRate() != 0) || (getReleaseRate() != 0)),
+          "-f<renew-rate> and -F<release-rate> are not compatible"
+          " with -g<threads>");
+    check((getThreadsNum() > 1) && (getDiags().find('T') != std::string::npos),
+          "-xT is not compatible with -g<threads>");
+    check((getThreadsNum() > 1) && (getRate() != 0) &&
+          (getRate() < getThreadsNum()),
+          "-r<rate> must not be lower than -g<threads>");
+    check((getThreadsNum() > 1) && (getClientsNum() > 1) &&
+          (getClientsNum() < static_cast<uint32_t>(getThreadsNum())),
+          "-R<range> must not be lower than -g<threads>");
 
 }
 
@@ -862,6 +883,9 @@ CommandOptions::printCommandLine() const {
         std::cout << "preload=" << preload_ <<  std::endl;
     }
     std::cout << "aggressivity=" << aggressivity_ << std::endl;
+    if (threads_num_ > 1) {
+        std::cout << "threads=" << threads_num_ << std::endl;
+    }
     if (getLocalPort() != 0) {
         std::cout << "local-port=" << local_port_ <<  std::endl;
     }
@@ -924,7 +948,7 @@ CommandOptions::usage() const {
         "         [-c] [-1] [-T<template-file>] [-X<xid-offset>]\n"
         "         [-O<random-offset] [-E<time-offset>] [-S<srvid-offset>]\n"
         "         [-I<ip-offset>] [-x<diagnostic-selector>] [-w<wrapped>]\n"
-        "         [server]\n"
+        "         [-g<threads>] [server]\n"
         "\n"
         "The [server] argument is the name/address of the DHCP server to\n"
         "contact.  For DHCPv4 operation, exchanges are initiated by\n"
@@ -967,6 +991,12 @@ CommandOptions::usage() const {
         "-E<time-offset>: Offset of the (DHCPv4) secs field / (DHCPv6)\n"
         "    elapsed-time option in the (second/request) template.\n"
         "    The value 0 disables it.\n"
+        "-g<threads>: Send packets in <threads> sender threads, and receive\n"
+        "    them in a separate thread.  Each sender thread uses its own\n"
+        "    socket, sends 1/<threads> of the requested rate and simulates\n"
+        "    its own subset of clients.  Packets are sent and received in\n"
+        "    batches.\n"
+        "    This is incompatible with -T, -f, -F and -xT.\n"
         "-h: Print this help.\n"
         "-i: Do only the initial part of an exchange: DO or SA, depending on\n"
         "    whether -6 is given.\n"
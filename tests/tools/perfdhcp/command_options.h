@@ -247,6 +247,12 @@ public:
     /// \return aggressivity value.
     int getAggressivity() const { return aggressivity_; }
 
+    /// \brief Returns number of sender and receiver thread pairs.
+    ///
+    /// \return number of thread pairs, 1 if packets are sent and
+    /// received in the main thread.
+    int getThreadsNum() const { return threads_num_; }
+
     /// \brief Returns local port number.
     ///
     /// \return local port number.
@@ -520,6 +526,8 @@ private:
     int preload_;
     /// Number of exchanges sent before next pause.
     int aggressivity_;
+    /// Number of sender and receiver thread pairs.
+    int threads_num_;
     /// Local port number (host endian)
     int local_port_;
     /// Randomization seed.
@@ -0,0 +1,215 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include "packet_batch.h"
+#include <exceptions/exceptions.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+
+namespace bundy {
+namespace perfdhcp {
+
+const size_t PacketBatch::MAX_DATAGRAM_SIZE;
+
+PacketBatch::PacketBatch(const size_t capacity)
+    : buffer_(), lengths_(), addrs_(), addr_lens_(), size_(0) {
+    if (capacity == 0) {
+        bundy_throw(BadValue, "capacity of the packet batch must be"
+                  " greater than 0");
+    }
+    buffer_.resize(capacity * MAX_DATAGRAM_SIZE);
+    lengths_.resize(capacity);
+    addrs_.resize(capacity);
+    addr_lens_.resize(capacity);
+}
+
+void
+PacketBatch::append(const void* data, const size_t length,
+                    const struct sockaddr* addr, const socklen_t addr_len) {
+    if (isFull()) {
+        bundy_throw(OutOfRange, "packet batch is full");
+    }
+    if (length > MAX_DATAGRAM_SIZE) {
+        bundy_throw(OutOfRange, "datagram of " << length << " bytes"
+                  " exceeds the maximum size of " << MAX_DATAGRAM_SIZE);
+    }
+    if (addr_len > sizeof(struct sockaddr_storage)) {
+        bundy_throw(OutOfRange, "invalid length of the datagram address");
+    }
+    memcpy(&buffer_[size_ * MAX_DATAGRAM_SIZE], data, length);
+    lengths_[size_] = length;
+    memcpy(&addrs_[size_], addr, addr_len);
+    addr_lens_[size_] = addr_len;
+    ++size_;
+}
+
+void
+PacketBatch::checkIndex(const size_t index) const {
+    if (index >= size_) {
+        bundy_throw(OutOfRange, "index " << index << " is out of range"
+                  " of the packet batch holding " << size_ << " datagrams");
+    }
+}
+
+const uint8_t*
+PacketBatch::getData(const size_t index) const {
+    checkIndex(index);
+    return (&buffer_[index * MAX_DATAGRAM_SIZE]);
+}
+
+size_t
+PacketBatch::getLength(const size_t index) const {
+    checkIndex(index);
+    return (lengths_[index]);
+}
+
+const struct sockaddr_storage&
+PacketBatch::getAddress(const size_t index) const {
+    checkIndex(index);
+    return (addrs_[index]);
+}
+
+size_t
+PacketBatch::send(const int sock) {
+    size_t sent = 0;
+#ifdef HAVE_SENDMMSG
+    std::vector<struct iovec> iovs(size_);
+    std::vector<struct mmsghdr> msgs(size_);
+    for (size_t i = 0; i < size_; ++i) {
+        iovs[i].iov_base = &buffer_[i * MAX_DATAGRAM_SIZE];
+        iovs[i].iov_len = lengths_[i];
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_name = &addrs_[i];
+        msgs[i].msg_hdr.msg_namelen = addr_lens_[i];
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    while (sent < size_) {
+        const int result = sendmmsg(sock, &msgs[sent], size_ - sent,
+                                    MSG_DONTWAIT);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+                       (errno == ENOBUFS)) {
+                break;
+            }
+            bundy_throw(Unexpected, "failed to send a batch of datagrams: "
+                      << strerror(errno));
+        }
+        sent += result;
+    }
+#else
+    while (sent < size_) {
+        const ssize_t result =
+            sendto(sock, &buffer_[sent * MAX_DATAGRAM_SIZE], lengths_[sent],
+                   MSG_DONTWAIT,
+                   reinterpret_cast<const struct sockaddr*>(&addrs_[sent]),
+                   addr_lens_[sent]);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+                       (errno == ENOBUFS)) {
+                break;
+            }
+            bundy_throw(Unexpected, "failed to send a datagram: "
+                      << strerror(errno));
+        }
+        ++sent;
+    }
+#endif
+    clear();
+    return (sent);
+}
+
+size_t
+PacketBatch::receive(const int sock, const uint32_t timeout) {
+    clear();
+
+    // Wait for the first datagram.
+    fd_set sockets;
+    FD_ZERO(&sockets);
+    FD_SET(sock, &sockets);
+    struct timeval select_timeout;
+    select_timeout.tv_sec = timeout / 1000000;
+    select_timeout.tv_usec = timeout % 1000000;
+    const int ready = select(sock + 1, &sockets, NULL, NULL, &select_timeout);
+    if (ready == 0) {
+        return (0);
+    } else if (ready < 0) {
+        if (errno == EINTR) {
+            return (0);
+        }
+        bundy_throw(Unexpected, "failed to wait for datagrams: "
+                  << strerror(errno));
+    }
+
+    const size_t capacity = getCapacity();
+#ifdef HAVE_RECVMMSG
+    std::vector<struct iovec> iovs(capacity);
+    std::vector<struct mmsghdr> msgs(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        iovs[i].iov_base = &buffer_[i * MAX_DATAGRAM_SIZE];
+        iovs[i].iov_len = MAX_DATAGRAM_SIZE;
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_name = &addrs_[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(addrs_[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int result = recvmmsg(sock, &msgs[0], capacity, MSG_DONTWAIT, NULL);
+    if (result < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+            return (0);
+        }
+        bundy_throw(Unexpected, "failed to receive a batch of datagrams: "
+                  << strerror(errno));
+    }
+    for (int i = 0; i < result; ++i) {
+        lengths_[i] = msgs[i].msg_len;
+        addr_lens_[i] = msgs[i].msg_hdr.msg_namelen;
+    }
+    size_ = result;
+#else
+    while (size_ < capacity) {
+        addr_lens_[size_] = sizeof(addrs_[size_]);
+        const ssize_t result =
+            recvfrom(sock, &buffer_[size_ * MAX_DATAGRAM_SIZE],
+                     MAX_DATAGRAM_SIZE, MSG_DONTWAIT,
+                     reinterpret_cast<struct sockaddr*>(&addrs_[size_]),
+                     &addr_lens_[size_]);
+        if (result < 0) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+                (errno == EINTR)) {
+                break;
+            }
+            bundy_throw(Unexpected, "failed to receive a datagram: "
+                      << strerror(errno));
+        }
+        lengths_[size_] = result;
+        ++size_;
+    }
+#endif
+    return (size_);
+}
+
+} // namespace perfdhcp
+} // namespace bundy
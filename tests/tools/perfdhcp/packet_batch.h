@@ -0,0 +1,156 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef PACKET_BATCH_H
+#define PACKET_BATCH_H
+
+#include <boost/noncopyable.hpp>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <vector>
+
+namespace bundy {
+namespace perfdhcp {
+
+/// \brief A batch of datagrams sent or received with a single system call.
+///
+/// In the multi-threaded mode, perfdhcp sends and receives packets at
+/// rates where the cost of a system call per packet limits the throughput.
+/// This class holds a number of datagrams along with their remote
+/// addresses in the preallocated buffers and sends or receives them
+/// together using \c sendmmsg and \c recvmmsg. On systems which don't
+/// provide these functions, the datagrams are sent and received one by one
+/// with \c sendto and \c recvfrom.
+///
+/// The object is not thread safe. Each thread is expected to use its own
+/// batch.
+class PacketBatch : public boost::noncopyable {
+public:
+
+    /// \brief Maximum size of the datagram held in the batch.
+    static const size_t MAX_DATAGRAM_SIZE = 4096;
+
+    /// \brief Constructor.
+    ///
+    /// \param capacity Maximum number of datagrams in the batch.
+    ///
+    /// \throw bundy::BadValue if capacity is 0.
+    PacketBatch(const size_t capacity);
+
+    /// \brief Returns the maximum number of datagrams in the batch.
+    size_t getCapacity() const {
+        return (lengths_.size());
+    }
+
+    /// \brief Returns the number of datagrams in the batch.
+    size_t getSize() const {
+        return (size_);
+    }
+
+    /// \brief Checks if the batch is full.
+    bool isFull() const {
+        return (size_ == getCapacity());
+    }
+
+    /// \brief Removes all datagrams from the batch.
+    void clear() {
+        size_ = 0;
+    }
+
+    /// \brief Appends the datagram to the batch.
+    ///
+    /// The data and the address are copied to the internal buffers.
+    ///
+    /// \param data Pointer to the datagram data.
+    /// \param length Length of the datagram.
+    /// \param addr Destination address.
+    /// \param addr_len Length of the destination address.
+    ///
+    /// \throw bundy::OutOfRange if the batch is full or the datagram or
+    /// the address is too large.
+    void append(const void* data, const size_t length,
+                const struct sockaddr* addr, const socklen_t addr_len);
+
+    /// \brief Returns the data of the datagram in the batch.
+    ///
+    /// \param index Index of the datagram.
+    ///
+    /// \throw bundy::OutOfRange if the index is out of range.
+    const uint8_t* getData(const size_t index) const;
+
+    /// \brief Returns the length of the datagram in the batch.
+    ///
+    /// \param index Index of the datagram.
+    ///
+    /// \throw bundy::OutOfRange if the index is out of range.
+    size_t getLength(const size_t index) const;
+
+    /// \brief Returns the remote address of the datagram in the batch.
+    ///
+    /// \param index Index of the datagram.
+    ///
+    /// \throw bundy::OutOfRange if the index is out of range.
+    const struct sockaddr_storage& getAddress(const size_t index) const;
+
+    /// \brief Sends all datagrams in the batch.
+    ///
+    /// The batch is cleared when the datagrams have been sent. Datagrams
+    /// which the socket can't accept without blocking are dropped.
+    ///
+    /// \param sock Socket descriptor.
+    ///
+    /// \throw bundy::Unexpected if sending fails for other reason than
+    /// a full send buffer.
+    /// \return Number of datagrams sent.
+    size_t send(const int sock);
+
+    /// \brief Receives datagrams into the batch.
+    ///
+    /// The method waits up to the specified timeout for the first
+    /// datagram and then reads all datagrams queued on the socket, up to
+    /// the batch capacity. The datagrams previously held in the batch are
+    /// removed.
+    ///
+    /// \param sock Socket descriptor.
+    /// \param timeout Timeout in microseconds.
+    ///
+    /// \throw bundy::Unexpected if waiting for or receiving data fails.
+    /// \return Number of datagrams received.
+    size_t receive(const int sock, const uint32_t timeout);
+
+private:
+
+    /// \brief Checks if the index points to a datagram in the batch.
+    ///
+    /// \throw bundy::OutOfRange if it doesn't.
+    void checkIndex(const size_t index) const;
+
+    /// \brief Buffer holding the datagrams, MAX_DATAGRAM_SIZE bytes each.
+    std::vector<uint8_t> buffer_;
+    /// \brief Lengths of the datagrams.
+    std::vector<size_t> lengths_;
+    /// \brief Remote addresses of the datagrams.
+    std::vector<struct sockaddr_storage> addrs_;
+    /// \brief Lengths of the remote addresses.
+    std::vector<socklen_t> addr_lens_;
+    /// \brief Number of datagrams in the batch.
+    size_t size_;
+};
+
+} // namespace perfdhcp
+} // namespace bundy
+
+#endif // PACKET_BATCH_H
@@ -372,6 +372,44 @@ public:
             sum_delay_squared_ += delta * delta;
         }
 
+        /// \brief Add counters of other exchange stats object.
+        ///
+        /// Method adds the packet counters and delays gathered by the
+        /// other object to this object. It is used to combine statistics
+        /// collected by multiple threads. The packets waiting for response
+        /// are not copied. The received and archived packets are copied
+        /// only if packets archive mode is enabled for this object.
+        ///
+        /// \param other object which counters are added.
+        void merge(const ExchangeStats& other) {
+            if (other.min_delay_ < min_delay_) {
+                min_delay_ = other.min_delay_;
+            }
+            if (other.max_delay_ > max_delay_) {
+                max_delay_ = other.max_delay_;
+            }
+            sum_delay_ += other.sum_delay_;
+            sum_delay_squared_ += other.sum_delay_squared_;
+            orphans_ += other.orphans_;
+            collected_ += other.collected_;
+            unordered_lookup_size_sum_ += other.unordered_lookup_size_sum_;
+            unordered_lookups_ += other.unordered_lookups_;
+            ordered_lookups_ += other.ordered_lookups_;
+            sent_packets_num_ += other.sent_packets_num_;
+            rcvd_packets_num_ += other.rcvd_packets_num_;
+            if (other.boot_time_ < boot_time_) {
+                boot_time_ = other.boot_time_;
+            }
+            if (archive_enabled_) {
+                rcvd_packets_.insert(rcvd_packets_.end(),
+                                     other.rcvd_packets_.begin(),
+                                     other.rcvd_packets_.end());
+                archived_packets_.insert(archived_packets_.end(),
+                                         other.archived_packets_.begin(),
+                                         other.archived_packets_.end());
+            }
+        }
+
         /// \brief Match received packet with the corresponding sent packet.
         ///
         /// Method finds packet with specified transaction id on the list
@@ -563,6 +601,14 @@ public:
         /// \return number of garbage collected packets.
         uint64_t getCollectedNum() const { return(collected_); }
 
+        /// \brief Return drop time.
+        ///
+        /// Method returns maximum time elapsed between sending and
+        /// receiving packet before packet is assumed dropped.
+        ///
+        /// \return drop time in seconds.
+        double getDropTime() const { return(drop_time_); }
+
         /// \brief Return average unordered lookup set size.
         ///
         /// Method returns average unordered lookup set size.
@@ -910,6 +956,36 @@ public:
             CustomCounterPtr(new CustomCounter(long_name));
     }
 
+    /// \brief Add statistics gathered by other Statistics Manager.
+    ///
+    /// Method adds counters of all exchanges and custom counters held
+    /// by the other object to this object. Exchanges and counters not
+    /// present in this object are created. The test start time is set
+    /// to the earlier of the two. In the multi-threaded mode each thread
+    /// collects statistics in its own object and the objects are merged
+    /// when the statistics are reported.
+    ///
+    /// \param other Statistics Manager which statistics are added.
+    void merge(const StatsMgr& other) {
+        if (other.boot_time_ < boot_time_) {
+            boot_time_ = other.boot_time_;
+        }
+        for (ExchangesMapIterator it = other.exchanges_.begin();
+             it != other.exchanges_.end(); ++it) {
+            if (!hasExchangeStats(it->first)) {
+                addExchangeStats(it->first, it->second->getDropTime());
+            }
+            getExchangeStats(it->first)->merge(*it->second);
+        }
+        for (CustomCountersMapIterator it = other.custom_counters_.begin();
+             it != other.custom_counters_.end(); ++it) {
+            if (custom_counters_.find(it->first) == custom_counters_.end()) {
+                addCustomCounter(it->first, it->second->getName());
+            }
+            incrementCounter(it->first, it->second->getValue());
+        }
+    }
+
     /// \brief Check if any packet drops occured.
     ///
     // \return true, if packet drops occured.
@@ -19,6 +19,7 @@
 #include <dhcp/iface_mgr.h>
 #include <dhcp/dhcp4.h>
 #include <dhcp/option6_ia.h>
+#include <util/threads/thread.h>
 #include <util/unittests/check_valgrind.h>
 #include "test_control.h"
 #include "command_options.h"
@@ -33,6 +34,7 @@
 #include <signal.h>
 #include <sys/wait.h>
 
+#include <boost/bind.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 using namespace std;
@@ -46,6 +48,62 @@ namespace perfdhcp {
 
 bool TestControl::interrupted_ = false;
 
+namespace {
+
+/// Maximum number of datagrams received or sent by the receiver
+/// threads with a single system call.
+const size_t THREAD_BATCH_SIZE = 64;
+
+/// Timeout for receiving packets in the receiver thread in microseconds.
+const uint32_t THREAD_RECEIVE_TIMEOUT = 10000;
+
+/// \brief Appends the packed packet to the batch of datagrams.
+///
+/// The destination address and port are taken from the packet.
+///
+/// \param batch batch of datagrams.
+/// \param pkt packet to be appended.
+template<typename T>
+void
+appendPacket(PacketBatch& batch, const boost::shared_ptr<T>& pkt) {
+    struct sockaddr_storage addr;
+    memset(&addr, 0, sizeof(addr));
+    socklen_t addr_len = 0;
+    const IOAddress& remote_addr = pkt->getRemoteAddr();
+    if (remote_addr.isV4()) {
+        struct sockaddr_in* addr4 = reinterpret_cast<sockaddr_in*>(&addr);
+        addr4->sin_family = AF_INET;
+        addr4->sin_port = htons(pkt->getRemotePort());
+        addr4->sin_addr.s_addr = htonl(static_cast<uint32_t>(remote_addr));
+        addr_len = sizeof(*addr4);
+    } else {
+        struct sockaddr_in6* addr6 = reinterpret_cast<sockaddr_in6*>(&addr);
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_port = htons(pkt->getRemotePort());
+        const std::vector<uint8_t> bytes = remote_addr.toBytes();
+        memcpy(&addr6->sin6_addr, &bytes[0], sizeof(addr6->sin6_addr));
+        if (remote_addr.isV6LinkLocal() || remote_addr.isV6Multicast()) {
+            addr6->sin6_scope_id = pkt->getIndex();
+        }
+        addr_len = sizeof(*addr6);
+    }
+    const util::OutputBuffer& buf = pkt->getBuffer();
+    batch.append(buf.getData(), buf.getLength(),
+                 reinterpret_cast<const struct sockaddr*>(&addr), addr_len);
+}
+
+}
+
+TestControl::ThreadShard::ThreadShard(const int socket) :
+    socket_(socket), max_requests_(0), stopped_(false) {
+}
+
+TestControl::ThreadShard::~ThreadShard() {
+    if (socket_ >= 0) {
+        close(socket_);
+    }
+}
+
 TestControl::TestControlSocket::TestControlSocket(const int socket) :
     SocketInfo(asiolink::IOAddress("127.0.0.1"), 0, socket),
     ifindex_(0), valid_(true) {
@@ -330,6 +388,35 @@ TestControl::checkExitConditions() const {
     return (false);
 }
 
+Pkt4Ptr
+TestControl::createDiscover4(const TestControlSocket& socket,
+                             const std::vector<uint8_t>& mac_address,
+                             const uint32_t transid) {
+    Pkt4Ptr pkt4(new Pkt4(DHCPDISCOVER, transid));
+    if (!pkt4) {
+        bundy_throw(Unexpected, "failed to create DISCOVER packet");
+    }
+
+    // Delete the default Message Type option set by Pkt4
+    pkt4->delOption(DHO_DHCP_MESSAGE_TYPE);
+
+    // Set options: DHCP_MESSAGE_TYPE and DHCP_PARAMETER_REQUEST_LIST
+    OptionBuffer buf_msg_type;
+    buf_msg_type.push_back(DHCPDISCOVER);
+    pkt4->addOption(Option::factory(Option::V4, DHO_DHCP_MESSAGE_TYPE,
+                                    buf_msg_type));
+    pkt4->addOption(Option::factory(Option::V4,
+                                    DHO_DHCP_PARAMETER_REQUEST_LIST));
+
+    // Set client's and server's ports as well as server's address,
+    // and local (relay) address.
+    setDefaults4(socket, pkt4);
+
+    // Set hardware address
+    pkt4->setHWAddr(HTYPE_ETHER, mac_address.size(), mac_address);
+    return (pkt4);
+}
+
 Pkt6Ptr
 TestControl::createMessageFromReply(const uint16_t msg_type,
                                     const dhcp::Pkt6Ptr& reply) {
@@ -370,6 +457,125 @@ TestControl::createMessageFromReply(const uint16_t msg_type,
     return (msg);
 }
 
+Pkt4Ptr
+TestControl::createRequest4(const TestControlSocket& socket,
+                            const dhcp::Pkt4Ptr& discover_pkt4,
+                            const dhcp::Pkt4Ptr& offer_pkt4,
+                            const uint32_t transid,
+                            const dhcp::OptionBuffer& serverid) {
+    Pkt4Ptr pkt4(new Pkt4(DHCPREQUEST, transid));
+
+    if (!serverid.empty()) {
+        pkt4->addOption(Option::factory(Option::V4, DHO_DHCP_SERVER_IDENTIFIER,
+                                        serverid));
+    } else {
+        OptionPtr opt_serverid =
+            offer_pkt4->getOption(DHO_DHCP_SERVER_IDENTIFIER);
+        if (!opt_serverid) {
+            bundy_throw(BadValue, "there is no SERVER_IDENTIFIER option "
+                      << "in OFFER message");
+        }
+        pkt4->addOption(opt_serverid);
+    }
+
+    /// Set client address.
+    asiolink::IOAddress yiaddr = offer_pkt4->getYiaddr();
+    if (!yiaddr.isV4()) {
+        bundy_throw(BadValue, "the YIADDR returned in OFFER packet is not "
+                  " IPv4 address");
+    }
+    OptionPtr opt_requested_address =
+        OptionPtr(new Option(Option::V4, DHO_DHCP_REQUESTED_ADDRESS,
+                             OptionBuffer()));
+    opt_requested_address->setUint32(static_cast<uint32_t>(yiaddr));
+    pkt4->addOption(opt_requested_address);
+    OptionPtr opt_parameter_list =
+        Option::factory(Option::V4, DHO_DHCP_PARAMETER_REQUEST_LIST);
+    pkt4->addOption(opt_parameter_list);
+    // Set client's and server's ports as well as server's address,
+    // and local (relay) address.
+    setDefaults4(socket, pkt4);
+
+    // Set hardware address
+    pkt4->setHWAddr(offer_pkt4->getHWAddr());
+    // Set elapsed time.
+    uint32_t elapsed_time = getElapsedTime<Pkt4Ptr>(discover_pkt4, offer_pkt4);
+    pkt4->setSecs(static_cast<uint16_t>(elapsed_time / 1000));
+    return (pkt4);
+}
+
+Pkt6Ptr
+TestControl::createRequest6(const TestControlSocket& socket,
+                            const Pkt6Ptr& advertise_pkt6,
+                            const uint32_t transid,
+                            const dhcp::OptionBuffer& serverid) {
+    Pkt6Ptr pkt6(new Pkt6(DHCPV6_REQUEST, transid));
+    // Set elapsed time.
+    OptionPtr opt_elapsed_time =
+        Option::factory(Option::V6, D6O_ELAPSED_TIME);
+    pkt6->addOption(opt_elapsed_time);
+    // Set client id.
+    OptionPtr opt_clientid = advertise_pkt6->getOption(D6O_CLIENTID);
+    if (!opt_clientid) {
+        bundy_throw(Unexpected, "client id not found in received packet");
+    }
+    pkt6->addOption(opt_clientid);
+
+    if (!serverid.empty()) {
+        pkt6->addOption(Option::factory(Option::V6, D6O_SERVERID, serverid));
+    } else {
+        OptionPtr opt_serverid = advertise_pkt6->getOption(D6O_SERVERID);
+        if (!opt_serverid) {
+            bundy_throw(Unexpected, "server id not found in received packet");
+        }
+        pkt6->addOption(opt_serverid);
+    }
+
+    // Copy IA_NA or IA_PD option from the Advertise message to the Request
+    // message being sent to the server. This will throw exception if the
+    // option to be copied is not found. Note that this function will copy
+    // one of IA_NA or IA_PD options, depending on the lease-type value
+    // specified in the command line.
+    copyIaOptions(advertise_pkt6, pkt6);
+
+    // Set default packet data.
+    setDefaults6(socket, pkt6);
+    return (pkt6);
+}
+
+Pkt6Ptr
+TestControl::createSolicit6(const TestControlSocket& socket,
+                            const std::vector<uint8_t>& duid,
+                            const uint32_t transid) {
+    Pkt6Ptr pkt6(new Pkt6(DHCPV6_SOLICIT, transid));
+    if (!pkt6) {
+        bundy_throw(Unexpected, "failed to create SOLICIT packet");
+    }
+    pkt6->addOption(Option::factory(Option::V6, D6O_ELAPSED_TIME));
+    if (CommandOptions::instance().isRapidCommit()) {
+        pkt6->addOption(Option::factory(Option::V6, D6O_RAPID_COMMIT));
+    }
+    pkt6->addOption(Option::factory(Option::V6, D6O_CLIENTID, duid));
+    pkt6->addOption(Option::factory(Option::V6, D6O_ORO));
+
+    // Depending on the lease-type option specified, we should request
+    // IPv6 address (with IA_NA) or IPv6 prefix (IA_PD) or both.
+
+    // IA_NA
+    if (CommandOptions::instance().getLeaseType()
+        .includes(CommandOptions::LeaseType::ADDRESS)) {
+        pkt6->addOption(Option::factory(Option::V6, D6O_IA_NA));
+    }
+    // IA_PD
+    if (CommandOptions::instance().getLeaseType()
+        .includes(CommandOptions::LeaseType::PREFIX)) {
+        pkt6->addOption(Option::factory(Option::V6, D6O_IA_PD));
+    }
+
+    setDefaults6(socket, pkt6);
+    return (pkt6);
+}
+
 OptionPtr
 TestControl::factoryElapsedTime6(Option::Universe, uint16_t,
                                  const OptionBuffer& buf) {
@@ -463,6 +669,12 @@ TestControl::factoryRequestList4(Option::Universe u,
 
 std::vector<uint8_t>
 TestControl::generateMacAddress(uint8_t& randomized) const {
+    return (generateMacAddress(randomized, *macaddr_gen_));
+}
+
+std::vector<uint8_t>
+TestControl::generateMacAddress(uint8_t& randomized,
+                                NumberGenerator& generator) const {
     CommandOptions& options = CommandOptions::instance();
     uint32_t clients_num = options.getClientsNum();
     if (clients_num < 2) {
@@ -473,7 +685,7 @@ TestControl::generateMacAddress(uint8_t& randomized) const {
     if (mac_addr.size() != HW_ETHER_LEN) {
         bundy_throw(BadValue, "invalid MAC address template specified");
     }
-    uint32_t r = macaddr_gen_->generate();
+    uint32_t r = generator.generate();
     randomized = 0;
     // Randomize MAC address octets.
     for (std::vector<uint8_t>::iterator it = mac_addr.end() - 1;
@@ -498,6 +710,12 @@ TestControl::generateMacAddress(uint8_t& randomized) const {
 
 std::vector<uint8_t>
 TestControl::generateDuid(uint8_t& randomized) const {
+    return (generateDuid(randomized, *macaddr_gen_));
+}
+
+std::vector<uint8_t>
+TestControl::generateDuid(uint8_t& randomized,
+                          NumberGenerator& generator) const {
     CommandOptions& options = CommandOptions::instance();
     uint32_t clients_num = options.getClientsNum();
     if ((clients_num == 0) || (clients_num == 1)) {
@@ -506,7 +724,7 @@ TestControl::generateDuid(uint8_t& randomized) const {
     // Get the base DUID. We are going to randomize part of it.
     std::vector<uint8_t> duid(options.getDuidTemplate());
     // @todo: add support for DUIDs of different sizes.
-    std::vector<uint8_t> mac_addr(generateMacAddress(randomized));
+    std::vector<uint8_t> mac_addr(generateMacAddress(randomized, generator));
     duid.resize(duid.size());
     std::copy(mac_addr.begin(), mac_addr.end(),
               duid.begin() + duid.size() - mac_addr.size());
@@ -626,6 +844,15 @@ TestControl::getTemplateBuffer(const size_t idx) const {
     bundy_throw(OutOfRange, "invalid buffer index");
 }
 
+TestControl::ThreadShard&
+TestControl::getThreadShard(const uint32_t transid) const {
+    size_t index = transid / transid_span_;
+    if (index >= thread_shards_.size()) {
+        index = thread_shards_.size() - 1;
+    }
+    return (*thread_shards_[index]);
+}
+
 int
 TestControl::getTransactionIdOffset(const int arg_idx) const {
     int xid_offset = CommandOptions::instance().getIpVersion() == 4 ?
@@ -662,51 +889,150 @@ TestControl::initPacketTemplates() {
     }
 }
 
-void
-TestControl::initializeStatsMgr() {
+TestControl::StatsMgr4Ptr
+TestControl::createStatsMgr4() const {
+    CommandOptions& options = CommandOptions::instance();
+    // Check if packet archive mode is required. If user
+    // requested diagnostics option -x t we have to enable
+    // it so as StatsMgr preserves all packets.
+    const bool archive_mode = testDiags('t') ? true : false;
+    StatsMgr4Ptr stats_mgr4(new StatsMgr4(archive_mode));
+    stats_mgr4->addExchangeStats(StatsMgr4::XCHG_DO,
+                                 options.getDropTime()[0]);
+    if (options.getExchangeMode() == CommandOptions::DORA_SARR) {
+        stats_mgr4->addExchangeStats(StatsMgr4::XCHG_RA,
+                                     options.getDropTime()[1]);
+    }
+    if (testDiags('i')) {
+        stats_mgr4->addCustomCounter("latesend", "Late sent packets");
+        stats_mgr4->addCustomCounter("shortwait", "Short waits for packets");
+        stats_mgr4->addCustomCounter("multircvd", "Multiple packets receives");
+        stats_mgr4->addCustomCounter("latercvd", "Late received packets");
+    }
+    return (stats_mgr4);
+}
+
+TestControl::StatsMgr6Ptr
+TestControl::createStatsMgr6() const {
     CommandOptions& options = CommandOptions::instance();
     // Check if packet archive mode is required. If user
     // requested diagnostics option -x t we have to enable
     // it so as StatsMgr preserves all packets.
     const bool archive_mode = testDiags('t') ? true : false;
+    StatsMgr6Ptr stats_mgr6(new StatsMgr6(archive_mode));
+    stats_mgr6->addExchangeStats(StatsMgr6::XCHG_SA,
+                                 options.getDropTime()[0]);
+    if (options.getExchangeMode() == CommandOptions::DORA_SARR) {
+        stats_mgr6->addExchangeStats(StatsMgr6::XCHG_RR,
+                                     options.getDropTime()[1]);
+    }
+    if (options.getRenewRate() != 0) {
+        stats_mgr6->addExchangeStats(StatsMgr6::XCHG_RN);
+    }
+    if (options.getReleaseRate() != 0) {
+        stats_mgr6->addExchangeStats(StatsMgr6::XCHG_RL);
+    }
+    if (testDiags('i')) {
+        stats_mgr6->addCustomCounter("latesend", "Late sent packets");
+        stats_mgr6->addCustomCounter("shortwait", "Short waits for packets");
+        stats_mgr6->addCustomCounter("multircvd", "Multiple packets receives");
+        stats_mgr6->addCustomCounter("latercvd", "Late received packets");
+    }
+    return (stats_mgr6);
+}
+
+void
+TestControl::initializeStatsMgr() {
+    CommandOptions& options = CommandOptions::instance();
     if (options.getIpVersion() == 4) {
         stats_mgr4_.reset();
-        stats_mgr4_ = StatsMgr4Ptr(new StatsMgr4(archive_mode));
-        stats_mgr4_->addExchangeStats(StatsMgr4::XCHG_DO,
-                                      options.getDropTime()[0]);
-        if (options.getExchangeMode() == CommandOptions::DORA_SARR) {
-            stats_mgr4_->addExchangeStats(StatsMgr4::XCHG_RA,
-                                          options.getDropTime()[1]);
-        }
-
+        stats_mgr4_ = createStatsMgr4();
     } else if (options.getIpVersion() == 6) {
         stats_mgr6_.reset();
-        stats_mgr6_ = StatsMgr6Ptr(new StatsMgr6(archive_mode));
-        stats_mgr6_->addExchangeStats(StatsMgr6::XCHG_SA,
-                                      options.getDropTime()[0]);
-        if (options.getExchangeMode() == CommandOptions::DORA_SARR) {
-            stats_mgr6_->addExchangeStats(StatsMgr6::XCHG_RR,
-                                          options.getDropTime()[1]);
-        }
-        if (options.getRenewRate() != 0) {
-            stats_mgr6_->addExchangeStats(StatsMgr6::XCHG_RN);
+        stats_mgr6_ = createStatsMgr6();
+    }
+}
+
+void
+TestControl::initializeThreadShards(const TestControlSocket& socket) {
+    CommandOptions& options = CommandOptions::instance();
+    const uint32_t threads_num = options.getThreadsNum();
+    const uint32_t transid_range =
+        (options.getIpVersion() == 4) ? 0xFFFFFFFF : 0x00FFFFFF;
+    const uint32_t clients_num = options.getClientsNum();
+    uint64_t num_requests = 0;
+    if (!options.getNumRequests().empty()) {
+        num_requests = options.getNumRequests()[0];
+    }
+    const uint32_t rate = options.getRate();
+
+    thread_shards_.clear();
+    transid_span_ = transid_range / threads_num;
+    const uint32_t clients_span = clients_num / threads_num;
+    uint32_t clients_offset = 0;
+    for (uint32_t i = 0; i < threads_num; ++i) {
+        const bool last = (i == threads_num - 1);
+        ThreadShardPtr shard(new ThreadShard(openSenderSocket(socket)));
+
+        // Split the rate and the number of requests, giving the
+        // remainder to the first threads.
+        shard->rate_control_.setAggressivity(options.getAggressivity());
+        shard->rate_control_.setRate(rate / threads_num +
+                                     (i < rate % threads_num ? 1 : 0));
+        if (num_requests > 0) {
+            shard->max_requests_ = num_requests / threads_num +
+                (i < num_requests % threads_num ? 1 : 0);
+        }
+
+        // Each thread uses a distinct range of transaction ids, so as
+        // the receiver thread can tell which thread sent the message.
+        shard->transid_gen_.reset(new SequentialGenerator(last ?
+            transid_range - i * transid_span_ : transid_span_,
+            i * transid_span_));
+
+        // Each thread simulates a distinct subset of the clients, the
+        // remainder being spread over the first threads. There are at
+        // least as many clients as threads (see CommandOptions), unless
+        // a single client is simulated.
+        if (clients_num < 2) {
+            shard->macaddr_gen_.reset(new SequentialGenerator(1));
+        } else {
+            const uint32_t clients =
+                clients_span + (i < clients_num % threads_num ? 1 : 0);
+            shard->macaddr_gen_.reset(new SequentialGenerator(clients,
+                                                              clients_offset));
+            clients_offset += clients;
         }
-        if (options.getReleaseRate() != 0) {
-            stats_mgr6_->addExchangeStats(StatsMgr6::XCHG_RL);
+
+        if (options.getIpVersion() == 4) {
+            shard->stats_mgr4_ = createStatsMgr4();
+        } else {
+            shard->stats_mgr6_ = createStatsMgr6();
         }
+        thread_shards_.push_back(shard);
     }
-    if (testDiags('i')) {
-        if (options.getIpVersion() == 4) {
-            stats_mgr4_->addCustomCounter("latesend", "Late sent packets");
-            stats_mgr4_->addCustomCounter("shortwait", "Short waits for packets");
-            stats_mgr4_->addCustomCounter("multircvd", "Multiple packets receives");
-            stats_mgr4_->addCustomCounter("latercvd", "Late received packets");
-        } else if (options.getIpVersion() == 6) {
-            stats_mgr6_->addCustomCounter("latesend", "Late sent packets");
-            stats_mgr6_->addCustomCounter("shortwait", "Short waits for packets");
-            stats_mgr6_->addCustomCounter("multircvd", "Multiple packets receives");
-            stats_mgr6_->addCustomCounter("latercvd", "Late received packets");
+}
+
+void
+TestControl::mergeThreadStats(const bool archive_mode) {
+    if (CommandOptions::instance().getIpVersion() == 4) {
+        StatsMgr4Ptr stats_mgr4(new StatsMgr4(archive_mode));
+        for (std::vector<ThreadShardPtr>::const_iterator shard =
+                 thread_shards_.begin();
+             shard != thread_shards_.end(); ++shard) {
+            util::thread::Mutex::Locker lock((*shard)->mutex_);
+            stats_mgr4->merge(*(*shard)->stats_mgr4_);
+        }
+        stats_mgr4_ = stats_mgr4;
+    } else {
+        StatsMgr6Ptr stats_mgr6(new StatsMgr6(archive_mode));
+        for (std::vector<ThreadShardPtr>::const_iterator shard =
+                 thread_shards_.begin();
+             shard != thread_shards_.end(); ++shard) {
+            util::thread::Mutex::Locker lock((*shard)->mutex_);
+            stats_mgr6->merge(*(*shard)->stats_mgr6_);
         }
+        stats_mgr6_ = stats_mgr6;
     }
 }
 
@@ -805,6 +1131,65 @@ TestControl::openSocket() const {
     return (sock);
 }
 
+int
+TestControl::openSenderSocket(const TestControlSocket& socket) const {
+    CommandOptions& options = CommandOptions::instance();
+    struct sockaddr_storage addr;
+    memset(&addr, 0, sizeof(addr));
+    socklen_t addr_len = 0;
+    if (socket.addr_.isV4()) {
+        struct sockaddr_in* addr4 = reinterpret_cast<sockaddr_in*>(&addr);
+        addr4->sin_family = AF_INET;
+        addr4->sin_addr.s_addr = htonl(static_cast<uint32_t>(socket.addr_));
+        addr_len = sizeof(*addr4);
+    } else {
+        struct sockaddr_in6* addr6 = reinterpret_cast<sockaddr_in6*>(&addr);
+        addr6->sin6_family = AF_INET6;
+        const std::vector<uint8_t> bytes = socket.addr_.toBytes();
+        memcpy(&addr6->sin6_addr, &bytes[0], sizeof(addr6->sin6_addr));
+        if (socket.addr_.isV6LinkLocal()) {
+            addr6->sin6_scope_id = socket.ifindex_;
+        }
+        addr_len = sizeof(*addr6);
+    }
+
+    int sock = ::socket(addr.ss_family, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        bundy_throw(Unexpected, "failed to open sender socket: "
+                  << strerror(errno));
+    }
+    if (bind(sock, reinterpret_cast<const struct sockaddr*>(&addr),
+             addr_len) < 0) {
+        const int bind_errno = errno;
+        close(sock);
+        bundy_throw(Unexpected, "failed to bind sender socket to "
+                  << socket.addr_ << ": " << strerror(bind_errno));
+    }
+
+    int ret = 0;
+    if ((options.getIpVersion() == 4) && options.isBroadcast()) {
+        int broadcast_enable = 1;
+        ret = setsockopt(sock, SOL_SOCKET, SO_BROADCAST,
+                         &broadcast_enable, sizeof(broadcast_enable));
+    } else if ((options.getIpVersion() == 6) &&
+               IOAddress(options.getServerName()).isV6Multicast()) {
+        int hops = 1;
+        ret = setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_HOPS,
+                         &hops, sizeof(hops));
+        if (ret >= 0) {
+            int idx = socket.ifindex_;
+            ret = setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_IF,
+                             &idx, sizeof(idx));
+        }
+    }
+    if (ret < 0) {
+        close(sock);
+        bundy_throw(InvalidOperation, "unable to set broadcast or multicast"
+                  " option on the sender socket");
+    }
+    return (sock);
+}
+
 void
 TestControl::sendPackets(const TestControlSocket& socket,
                          const uint64_t packets_num,
@@ -1147,6 +1532,108 @@ TestControl::processReceivedPacket6(const TestControlSocket& socket,
     }
 }
 
+void
+TestControl::processThreadPacket4(const TestControlSocket& socket,
+                                  const Pkt4Ptr& pkt4,
+                                  PacketBatch& requests) {
+    CommandOptions& options = CommandOptions::instance();
+    ThreadShard& shard = getThreadShard(pkt4->getTransid());
+    if (pkt4->getType() == DHCPOFFER) {
+        Pkt4Ptr discover_pkt4;
+        uint32_t transid = 0;
+        {
+            util::thread::Mutex::Locker lock(shard.mutex_);
+            discover_pkt4 =
+                shard.stats_mgr4_->passRcvdPacket(StatsMgr4::XCHG_DO, pkt4);
+            if (!discover_pkt4 ||
+                (options.getExchangeMode() != CommandOptions::DORA_SARR)) {
+                return;
+            }
+            transid = shard.transid_gen_->generate();
+        }
+
+        OptionBuffer serverid;
+        if (options.isUseFirst() || testDiags('s')) {
+            util::thread::Mutex::Locker lock(serverid_mutex_);
+            if (first_packet_serverid_.empty()) {
+                OptionPtr opt_serverid =
+                    pkt4->getOption(DHO_DHCP_SERVER_IDENTIFIER);
+                if (opt_serverid) {
+                    first_packet_serverid_ = opt_serverid->getData();
+                }
+            }
+            if (options.isUseFirst()) {
+                serverid = first_packet_serverid_;
+            }
+        }
+
+        Pkt4Ptr request_pkt4 = createRequest4(socket, discover_pkt4, pkt4,
+                                              transid, serverid);
+        request_pkt4->pack();
+        request_pkt4->updateTimestamp();
+        {
+            util::thread::Mutex::Locker lock(shard.mutex_);
+            shard.stats_mgr4_->passSentPacket(StatsMgr4::XCHG_RA,
+                                              request_pkt4);
+        }
+        appendPacket(requests, request_pkt4);
+
+    } else if (pkt4->getType() == DHCPACK) {
+        util::thread::Mutex::Locker lock(shard.mutex_);
+        shard.stats_mgr4_->passRcvdPacket(StatsMgr4::XCHG_RA, pkt4);
+    }
+}
+
+void
+TestControl::processThreadPacket6(const TestControlSocket& socket,
+                                  const Pkt6Ptr& pkt6,
+                                  PacketBatch& requests) {
+    CommandOptions& options = CommandOptions::instance();
+    ThreadShard& shard = getThreadShard(pkt6->getTransid());
+    if (pkt6->getType() == DHCPV6_ADVERTISE) {
+        uint32_t transid = 0;
+        {
+            util::thread::Mutex::Locker lock(shard.mutex_);
+            Pkt6Ptr solicit_pkt6 =
+                shard.stats_mgr6_->passRcvdPacket(StatsMgr6::XCHG_SA, pkt6);
+            if (!solicit_pkt6 ||
+                (options.getExchangeMode() != CommandOptions::DORA_SARR)) {
+                return;
+            }
+            transid = shard.transid_gen_->generate();
+        }
+
+        OptionBuffer serverid;
+        if (options.isUseFirst() || testDiags('s')) {
+            util::thread::Mutex::Locker lock(serverid_mutex_);
+            if (first_packet_serverid_.empty()) {
+                OptionPtr opt_serverid = pkt6->getOption(D6O_SERVERID);
+                if (opt_serverid) {
+                    first_packet_serverid_ = opt_serverid->getData();
+                }
+            }
+            if (options.isUseFirst()) {
+                serverid = first_packet_serverid_;
+            }
+        }
+
+        Pkt6Ptr request_pkt6 = createRequest6(socket, pkt6, transid,
+                                              serverid);
+        request_pkt6->pack();
+        request_pkt6->updateTimestamp();
+        {
+            util::thread::Mutex::Locker lock(shard.mutex_);
+            shard.stats_mgr6_->passSentPacket(StatsMgr6::XCHG_RR,
+                                              request_pkt6);
+        }
+        appendPacket(requests, request_pkt6);
+
+    } else if (pkt6->getType() == DHCPV6_REPLY) {
+        util::thread::Mutex::Locker lock(shard.mutex_);
+        shard.stats_mgr6_->passRcvdPacket(StatsMgr6::XCHG_RR, pkt6);
+    }
+}
+
 uint64_t
 TestControl::receivePackets(const TestControlSocket& socket) {
     bool receiving = true;
@@ -1286,6 +1773,10 @@ TestControl::reset() {
     setTransidGenerator(NumberGeneratorPtr());
     setMacAddrGenerator(NumberGeneratorPtr());
     first_packet_serverid_.clear();
+    thread_shards_.clear();
+    transid_span_ = 0;
+    receiver_stopped_ = false;
+    receiver_error_.clear();
     interrupted_ = false;
 }
 
@@ -1345,66 +1836,83 @@ TestControl::run() {
 
     // Initialize Statistics Manager. Release previous if any.
     initializeStatsMgr();
-    for (;;) {
-        // Calculate number of packets to be sent to stay
-        // catch up with rate.
-        uint64_t packets_due = basic_rate_control_.getOutboundMessageCount();
-        checkLateMessages(basic_rate_control_);
-        if ((packets_due == 0) && testDiags('i')) {
-            if (options.getIpVersion() == 4) {
-                stats_mgr4_->incrementCounter("shortwait");
-            } else if (options.getIpVersion() == 6) {
-                stats_mgr6_->incrementCounter("shortwait");
+    if (options.getThreadsNum() > 1) {
+        // The standard option definitions are initialized on first use,
+        // without any locking, so they must be initialized before the
+        // threads start building and parsing the packets.
+        LibDHCP::getOptionDefs(Option::V4);
+        LibDHCP::getOptionDefs(Option::V6);
+        runThreads(socket);
+    } else {
+        for (;;) {
+            // Calculate number of packets to be sent to stay
+            // catch up with rate.
+            uint64_t packets_due =
+                basic_rate_control_.getOutboundMessageCount();
+            checkLateMessages(basic_rate_control_);
+            if ((packets_due == 0) && testDiags('i')) {
+                if (options.getIpVersion() == 4) {
+                    stats_mgr4_->incrementCounter("shortwait");
+                } else if (options.getIpVersion() == 6) {
+                    stats_mgr6_->incrementCounter("shortwait");
+                }
             }
-        }
 
-        // @todo: set non-zero timeout for packets once we implement
-        // microseconds timeout in IfaceMgr.
-        receivePackets(socket);
+            // @todo: set non-zero timeout for packets once we implement
+            // microseconds timeout in IfaceMgr.
+            receivePackets(socket);
 
-        // If test period finished, maximum number of packet drops
-        // has been reached or test has been interrupted we have to
-        // finish the test.
-        if (checkExitConditions()) {
-            break;
-        }
+            // If test period finished, maximum number of packet drops
+            // has been reached or test has been interrupted we have to
+            // finish the test.
+            if (checkExitConditions()) {
+                break;
+            }
 
-        // Initiate new DHCP packet exchanges.
-        sendPackets(socket, packets_due);
+            // Initiate new DHCP packet exchanges.
+            sendPackets(socket, packets_due);
+
+            // If -f<renew-rate> option was specified we have to check how
+            // many Renew packets should be sent to catch up with a desired
+            // rate.
+            if ((options.getIpVersion() == 6) &&
+                (options.getRenewRate() != 0)) {
+                uint64_t renew_packets_due =
+                    renew_rate_control_.getOutboundMessageCount();
+                checkLateMessages(renew_rate_control_);
+                // Send Renew messages.
+                sendMultipleMessages6(socket, DHCPV6_RENEW,
+                                      renew_packets_due);
+            }
 
-        // If -f<renew-rate> option was specified we have to check how many
-        // Renew packets should be sent to catch up with a desired rate.
-        if ((options.getIpVersion() == 6) && (options.getRenewRate() != 0)) {
-            uint64_t renew_packets_due =
-                renew_rate_control_.getOutboundMessageCount();
-            checkLateMessages(renew_rate_control_);
-            // Send Renew messages.
-            sendMultipleMessages6(socket, DHCPV6_RENEW, renew_packets_due);
-        }
+            // If -F<release-rate> option was specified we have to check how
+            // many Release messages should be sent to catch up with a
+            // desired rate.
+            if ((options.getIpVersion() == 6) &&
+                (options.getReleaseRate() != 0)) {
+                uint64_t release_packets_due =
+                    release_rate_control_.getOutboundMessageCount();
+                checkLateMessages(release_rate_control_);
+                // Send Release messages.
+                sendMultipleMessages6(socket, DHCPV6_RELEASE,
+                                      release_packets_due);
+            }
 
-        // If -F<release-rate> option was specified we have to check how many
-        // Release messages should be sent to catch up with a desired rate.
-        if ((options.getIpVersion() == 6) && (options.getReleaseRate() != 0)) {
-            uint64_t release_packets_due =
-                release_rate_control_.getOutboundMessageCount();
-            checkLateMessages(release_rate_control_);
-            // Send Release messages.
-            sendMultipleMessages6(socket, DHCPV6_RELEASE, release_packets_due);
-        }
+            // Report delay means that user requested printing number
+            // of sent/received/dropped packets repeatedly.
+            if (options.getReportDelay() > 0) {
+                printIntermediateStats();
+            }
 
-        // Report delay means that user requested printing number
-        // of sent/received/dropped packets repeatedly.
-        if (options.getReportDelay() > 0) {
-            printIntermediateStats();
+            // If we are sending Renews to the server, the Reply packets are
+            // cached so as leases for which we send Renews can be idenitfied.
+            // The major issue with this approach is that most of the time we
+            // are caching more packets than we actually need. This function
+            // removes excessive Reply messages to reduce the memory and CPU
+            // utilization. Note that searches in the long list of Reply
+            // packets increases CPU utilization.
+            cleanCachedPackets();
         }
-
-        // If we are sending Renews to the server, the Reply packets are cached
-        // so as leases for which we send Renews can be idenitfied. The major
-        // issue with this approach is that most of the time we are caching
-        // more packets than we actually need. This function removes excessive
-        // Reply messages to reduce the memory and CPU utilization. Note that
-        // searches in the long list of Reply packets increases CPU utilization.
-        cleanCachedPackets();
     }
     printStats();
 
@@ -1447,6 +1955,236 @@ TestControl::run() {
     return (ret_code);
 }
 
+void
+TestControl::runReceiverThread(const TestControlSocket& socket) {
+    CommandOptions& options = CommandOptions::instance();
+    PacketBatch received(THREAD_BATCH_SIZE);
+    PacketBatch requests(THREAD_BATCH_SIZE);
+    try {
+        for (;;) {
+            {
+                util::thread::Mutex::Locker lock(receiver_mutex_);
+                if (receiver_stopped_) {
+                    break;
+                }
+            }
+            const size_t received_num =
+                received.receive(socket.sockfd_, THREAD_RECEIVE_TIMEOUT);
+            for (size_t i = 0; i < received_num; ++i) {
+                if (options.getIpVersion() == 4) {
+                    Pkt4Ptr pkt4;
+                    try {
+                        pkt4.reset(new Pkt4(received.getData(i),
+                                            received.getLength(i)));
+                        pkt4->updateTimestamp();
+                        pkt4->unpack();
+                    } catch (const Exception& e) {
+                        std::cerr << "Failed to receive DHCPv4 packet: "
+                                  << e.what() << std::endl;
+                        continue;
+                    }
+                    processThreadPacket4(socket, pkt4, requests);
+                } else {
+                    Pkt6Ptr pkt6(new Pkt6(received.getData(i),
+                                          received.getLength(i)));
+                    pkt6->updateTimestamp();
+                    if (!pkt6->unpack()) {
+                        continue;
+                    }
+                    processThreadPacket6(socket, pkt6, requests);
+                }
+                if (requests.isFull()) {
+                    requests.send(socket.sockfd_);
+                }
+            }
+            if (requests.getSize() > 0) {
+                requests.send(socket.sockfd_);
+            }
+        }
+    } catch (const std::exception& e) {
+        util::thread::Mutex::Locker lock(receiver_mutex_);
+        receiver_error_ = e.what();
+    }
+}
+
+void
+TestControl::runSenderThread(const TestControlSocket& socket,
+                             ThreadShard& shard) {
+    CommandOptions& options = CommandOptions::instance();
+    PacketBatch batch(std::max(options.getAggressivity(), 1));
+    uint64_t sent_num = 0;
+    try {
+        std::vector<uint32_t> transids;
+        std::vector<Pkt4Ptr> pkts4;
+        std::vector<Pkt6Ptr> pkts6;
+        for (;;) {
+            const uint64_t packets_due =
+                shard.rate_control_.getOutboundMessageCount();
+            transids.clear();
+            {
+                util::thread::Mutex::Locker lock(shard.mutex_);
+                if (shard.stopped_) {
+                    break;
+                }
+                if (testDiags('i')) {
+                    const bool late = shard.rate_control_.isLateSent();
+                    if (options.getIpVersion() == 4) {
+                        if (late) {
+                            shard.stats_mgr4_->incrementCounter("latesend");
+                        }
+                        if (packets_due == 0) {
+                            shard.stats_mgr4_->incrementCounter("shortwait");
+                        }
+                    } else {
+                        if (late) {
+                            shard.stats_mgr6_->incrementCounter("latesend");
+                        }
+                        if (packets_due == 0) {
+                            shard.stats_mgr6_->incrementCounter("shortwait");
+                        }
+                    }
+                }
+                uint64_t count = std::min(packets_due,
+                                          static_cast<uint64_t>
+                                          (batch.getCapacity()));
+                if (shard.max_requests_ > 0) {
+                    count = std::min(count, shard.max_requests_ - sent_num);
+                }
+                for (uint64_t i = 0; i < count; ++i) {
+                    transids.push_back(shard.transid_gen_->generate());
+                }
+            }
+
+            if (transids.empty()) {
+                // Wait until the next message is due, but not longer
+                // than a millisecond so as the stop request is noticed.
+                long wait_time = 1000;
+                if (packets_due == 0) {
+                    const long due_time =
+                        (shard.rate_control_.getDue() -
+                         microsec_clock::universal_time()).total_microseconds();
+                    wait_time = std::max(0L, std::min(wait_time, due_time));
+                }
+                if (wait_time > 0) {
+                    usleep(wait_time);
+                }
+                continue;
+            }
+
+            // Build the messages without holding the lock.
+            pkts4.clear();
+            pkts6.clear();
+            for (std::vector<uint32_t>::const_iterator transid =
+                     transids.begin(); transid != transids.end(); ++transid) {
+                uint8_t randomized = 0;
+                if (options.getIpVersion() == 4) {
+                    Pkt4Ptr pkt4 = createDiscover4(socket,
+                        generateMacAddress(randomized, *shard.macaddr_gen_),
+                        *transid);
+                    pkt4->pack();
+                    pkt4->updateTimestamp();
+                    appendPacket(batch, pkt4);
+                    pkts4.push_back(pkt4);
+                } else {
+                    Pkt6Ptr pkt6 = createSolicit6(socket,
+                        generateDuid(randomized, *shard.macaddr_gen_),
+                        *transid);
+                    pkt6->pack();
+                    pkt6->updateTimestamp();
+                    appendPacket(batch, pkt6);
+                    pkts6.push_back(pkt6);
+                }
+            }
+            {
+                util::thread::Mutex::Locker lock(shard.mutex_);
+                for (std::vector<Pkt4Ptr>::const_iterator pkt4 =
+                         pkts4.begin(); pkt4 != pkts4.end(); ++pkt4) {
+                    shard.stats_mgr4_->passSentPacket(StatsMgr4::XCHG_DO,
+                                                      *pkt4);
+                }
+                for (std::vector<Pkt6Ptr>::const_iterator pkt6 =
+                         pkts6.begin(); pkt6 != pkts6.end(); ++pkt6) {
+                    shard.stats_mgr6_->passSentPacket(StatsMgr6::XCHG_SA,
+                                                      *pkt6);
+                }
+            }
+            batch.send(shard.socket_);
+            sent_num += transids.size();
+            shard.rate_control_.updateSendTime();
+        }
+    } catch (const std::exception& e) {
+        util::thread::Mutex::Locker lock(shard.mutex_);
+        shard.error_ = e.what();
+    }
+}
+
+void
+TestControl::runThreads(const TestControlSocket& socket) {
+    CommandOptions& options = CommandOptions::instance();
+    initializeThreadShards(socket);
+    {
+        util::thread::Mutex::Locker lock(receiver_mutex_);
+        receiver_stopped_ = false;
+        receiver_error_.clear();
+    }
+
+    std::vector<boost::shared_ptr<util::thread::Thread> > threads;
+    threads.push_back(boost::shared_ptr<util::thread::Thread>(
+        new util::thread::Thread(
+            boost::bind(&TestControl::runReceiverThread, this,
+                        boost::cref(socket)))));
+    for (std::vector<ThreadShardPtr>::const_iterator shard =
+             thread_shards_.begin(); shard != thread_shards_.end(); ++shard) {
+        threads.push_back(boost::shared_ptr<util::thread::Thread>(
+            new util::thread::Thread(
+                boost::bind(&TestControl::runSenderThread, this,
+                            boost::cref(socket), boost::ref(**shard)))));
+    }
+
+    std::string error;
+    for (;;) {
+        usleep(THREAD_RECEIVE_TIMEOUT);
+        // The exit conditions and the intermediate reports are based on
+        // the statistics of all threads.
+        mergeThreadStats(false);
+        {
+            util::thread::Mutex::Locker lock(receiver_mutex_);
+            error = receiver_error_;
+        }
+        for (std::vector<ThreadShardPtr>::const_iterator shard =
+                 thread_shards_.begin();
+             error.empty() && (shard != thread_shards_.end()); ++shard) {
+            util::thread::Mutex::Locker lock((*shard)->mutex_);
+            error = (*shard)->error_;
+        }
+        if (!error.empty() || checkExitConditions()) {
+            break;
+        }
+        if (options.getReportDelay() > 0) {
+            printIntermediateStats();
+        }
+    }
+
+    for (std::vector<ThreadShardPtr>::const_iterator shard =
+             thread_shards_.begin(); shard != thread_shards_.end(); ++shard) {
+        util::thread::Mutex::Locker lock((*shard)->mutex_);
+        (*shard)->stopped_ = true;
+    }
+    {
+        util::thread::Mutex::Locker lock(receiver_mutex_);
+        receiver_stopped_ = true;
+    }
+    for (std::vector<boost::shared_ptr<util::thread::Thread> >::const_iterator
+             thread = threads.begin(); thread != threads.end(); ++thread) {
+        (*thread)->wait();
+    }
+    mergeThreadStats(testDiags('t'));
+
+    if (!error.empty()) {
+        bundy_throw(Unexpected, "perfdhcp thread failed: " << error);
+    }
+}
+
 void
 TestControl::runWrapped(bool do_stop /*= false */) const {
     CommandOptions& options = CommandOptions::instance();
@@ -1491,29 +2229,7 @@ TestControl::sendDiscover4(const TestControlSocket& socket,
     std::vector<uint8_t> mac_address = generateMacAddress(randomized);
     // Generate trasnaction id to be set for the new exchange.
     const uint32_t transid = generateTransid();
-    Pkt4Ptr pkt4(new Pkt4(DHCPDISCOVER, transid));
-    if (!pkt4) {
-        bundy_throw(Unexpected, "failed to create DISCOVER packet");
-    }
-
-    // Delete the default Message Type option set by Pkt4
-    pkt4->delOption(DHO_DHCP_MESSAGE_TYPE);
-
-    // Set options: DHCP_MESSAGE_TYPE and DHCP_PARAMETER_REQUEST_LIST
-    OptionBuffer buf_msg_type;
-    buf_msg_type.push_back(DHCPDISCOVER);
-    pkt4->addOption(Option::factory(Option::V4, DHO_DHCP_MESSAGE_TYPE,
-                                    buf_msg_type));
-    pkt4->addOption(Option::factory(Option::V4,
-                                    DHO_DHCP_PARAMETER_REQUEST_LIST));
-
-    // Set client's and server's ports as well as server's address,
-    // and local (relay) address.
-    setDefaults4(socket, pkt4);
-
-    // Set hardware address
-    pkt4->setHWAddr(HTYPE_ETHER, mac_address.size(), mac_address);
-
+    Pkt4Ptr pkt4 = createDiscover4(socket, mac_address, transid);
     pkt4->pack();
     IfaceMgr::instance().send(pkt4);
     if (!preload) {
@@ -1615,51 +2331,22 @@ void
 TestControl::sendRequest4(const TestControlSocket& socket,
                           const dhcp::Pkt4Ptr& discover_pkt4,
                           const dhcp::Pkt4Ptr& offer_pkt4) {
-    const uint32_t transid = generateTransid();
-    Pkt4Ptr pkt4(new Pkt4(DHCPREQUEST, transid));
-
     // Use first flags indicates that we want to use the server
     // id captured in first packet.
+    OptionBuffer serverid;
     if (CommandOptions::instance().isUseFirst() &&
         (first_packet_serverid_.size() > 0)) {
-        pkt4->addOption(Option::factory(Option::V4, DHO_DHCP_SERVER_IDENTIFIER,
-                                        first_packet_serverid_));
-    } else {
+        serverid = first_packet_serverid_;
+    } else if (stats_mgr4_->getRcvdPacketsNum(StatsMgr4::XCHG_DO) == 1) {
         OptionPtr opt_serverid =
             offer_pkt4->getOption(DHO_DHCP_SERVER_IDENTIFIER);
-        if (!opt_serverid) {
-            bundy_throw(BadValue, "there is no SERVER_IDENTIFIER option "
-                      << "in OFFER message");
-        }
-        if (stats_mgr4_->getRcvdPacketsNum(StatsMgr4::XCHG_DO) == 1) {
+        if (opt_serverid) {
             first_packet_serverid_ = opt_serverid->getData();
         }
-        pkt4->addOption(opt_serverid);
     }
-
-    /// Set client address.
-    asiolink::IOAddress yiaddr = offer_pkt4->getYiaddr();
-    if (!yiaddr.isV4()) {
-        bundy_throw(BadValue, "the YIADDR returned in OFFER packet is not "
-                  " IPv4 address");
-    }
-    OptionPtr opt_requested_address =
-        OptionPtr(new Option(Option::V4, DHO_DHCP_REQUESTED_ADDRESS,
-                             OptionBuffer()));
-    opt_requested_address->setUint32(static_cast<uint32_t>(yiaddr));
-    pkt4->addOption(opt_requested_address);
-    OptionPtr opt_parameter_list =
-        Option::factory(Option::V4, DHO_DHCP_PARAMETER_REQUEST_LIST);
-    pkt4->addOption(opt_parameter_list);
-    // Set client's and server's ports as well as server's address,
-    // and local (relay) address.
-    setDefaults4(socket, pkt4);
-
-    // Set hardware address
-    pkt4->setHWAddr(offer_pkt4->getHWAddr());
-    // Set elapsed time.
-    uint32_t elapsed_time = getElapsedTime<Pkt4Ptr>(discover_pkt4, offer_pkt4);
-    pkt4->setSecs(static_cast<uint16_t>(elapsed_time / 1000));
+    const uint32_t transid = generateTransid();
+    Pkt4Ptr pkt4 = createRequest4(socket, discover_pkt4, offer_pkt4,
+                                  transid, serverid);
     // Prepare on wire data to send.
     pkt4->pack();
     IfaceMgr::instance().send(pkt4);
@@ -1781,45 +2468,20 @@ TestControl::sendRequest4(const TestControlSocket& socket,
 void
 TestControl::sendRequest6(const TestControlSocket& socket,
                           const Pkt6Ptr& advertise_pkt6) {
-    const uint32_t transid = generateTransid();
-    Pkt6Ptr pkt6(new Pkt6(DHCPV6_REQUEST, transid));
-    // Set elapsed time.
-    OptionPtr opt_elapsed_time =
-        Option::factory(Option::V6, D6O_ELAPSED_TIME);
-    pkt6->addOption(opt_elapsed_time);
-    // Set client id.
-    OptionPtr opt_clientid = advertise_pkt6->getOption(D6O_CLIENTID);
-    if (!opt_clientid) {
-        bundy_throw(Unexpected, "client id not found in received packet");
-    }
-    pkt6->addOption(opt_clientid);
-
     // Use first flags indicates that we want to use the server
     // id captured in first packet.
+    OptionBuffer serverid;
     if (CommandOptions::instance().isUseFirst() &&
         (first_packet_serverid_.size() > 0)) {
-        pkt6->addOption(Option::factory(Option::V6, D6O_SERVERID,
-                                        first_packet_serverid_));
-    } else {
+        serverid = first_packet_serverid_;
+    } else if (stats_mgr6_->getRcvdPacketsNum(StatsMgr6::XCHG_SA) == 1) {
         OptionPtr opt_serverid = advertise_pkt6->getOption(D6O_SERVERID);
-        if (!opt_serverid) {
-            bundy_throw(Unexpected, "server id not found in received packet");
-        }
-        if (stats_mgr6_->getRcvdPacketsNum(StatsMgr6::XCHG_SA) == 1) {
+        if (opt_serverid) {
             first_packet_serverid_ = opt_serverid->getData();
         }
-        pkt6->addOption(opt_serverid);
     }
-
-    // Copy IA_NA or IA_PD option from the Advertise message to the Request
-    // message being sent to the server. This will throw exception if the
-    // option to be copied is not found. Note that this function will copy
-    // one of IA_NA or IA_PD options, depending on the lease-type value
-    // specified in the command line.
-    copyIaOptions(advertise_pkt6, pkt6);
-
-    // Set default packet data.
-    setDefaults6(socket, pkt6);
+    const uint32_t transid = generateTransid();
+    Pkt6Ptr pkt6 = createRequest6(socket, advertise_pkt6, transid, serverid);
     // Prepare on-wire data.
     pkt6->pack();
     IfaceMgr::instance().send(pkt6);
@@ -1955,32 +2617,7 @@ TestControl::sendSolicit6(const TestControlSocket& socket,
     std::vector<uint8_t> duid = generateDuid(randomized);
     // Generate trasnaction id to be set for the new exchange.
     const uint32_t transid = generateTransid();
-    Pkt6Ptr pkt6(new Pkt6(DHCPV6_SOLICIT, transid));
-    if (!pkt6) {
-        bundy_throw(Unexpected, "failed to create SOLICIT packet");
-    }
-    pkt6->addOption(Option::factory(Option::V6, D6O_ELAPSED_TIME));
-    if (CommandOptions::instance().isRapidCommit()) {
-        pkt6->addOption(Option::factory(Option::V6, D6O_RAPID_COMMIT));
-    }
-    pkt6->addOption(Option::factory(Option::V6, D6O_CLIENTID, duid));
-    pkt6->addOption(Option::factory(Option::V6, D6O_ORO));
-
-    // Depending on the lease-type option specified, we should request
-    // IPv6 address (with IA_NA) or IPv6 prefix (IA_PD) or both.
-
-    // IA_NA
-    if (CommandOptions::instance().getLeaseType()
-        .includes(CommandOptions::LeaseType::ADDRESS)) {
-        pkt6->addOption(Option::factory(Option::V6, D6O_IA_NA));
-    }
-    // IA_PD
-    if (CommandOptions::instance().getLeaseType()
-        .includes(CommandOptions::LeaseType::PREFIX)) {
-        pkt6->addOption(Option::factory(Option::V6, D6O_IA_PD));
-    }
-
-    setDefaults6(socket, pkt6);
+    Pkt6Ptr pkt6 = createSolicit6(socket, duid, transid);
     pkt6->pack();
     IfaceMgr::instance().send(pkt6);
     if (!preload) {
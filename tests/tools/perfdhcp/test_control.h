@@ -15,6 +15,7 @@
 #ifndef TEST_CONTROL_H
 #define TEST_CONTROL_H
 
+#include "packet_batch.h"
 #include "packet_storage.h"
 #include "rate_control.h"
 #include "stats_mgr.h"
@@ -23,6 +24,7 @@
 #include <dhcp/dhcp6.h>
 #include <dhcp/pkt4.h>
 #include <dhcp/pkt6.h>
+#include <util/threads/sync.h>
 
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
@@ -213,10 +215,15 @@ public:
         ///
         /// \param range maximum number generated. If 0 is given then
         /// range defaults to maximum uint32_t value.
-        SequentialGenerator(uint32_t range = 0xFFFFFFFF) :
+        /// \param offset value added to each generated number. It is
+        /// used to generate numbers from the distinct sub-ranges in the
+        /// multi-threaded mode.
+        SequentialGenerator(uint32_t range = 0xFFFFFFFF,
+                            uint32_t offset = 0) :
             NumberGenerator(),
             num_(0),
-            range_(range) {
+            range_(range),
+            offset_(offset) {
             if (range_ == 0) {
                 range_ = 0xFFFFFFFF;
             }
@@ -228,13 +235,70 @@ public:
         virtual uint32_t generate() {
             uint32_t num = num_;
             num_ = (num_ + 1) % range_;
-            return (num);
+            return (offset_ + num);
         }
     private:
-        uint32_t num_;   ///< Current number.
-        uint32_t range_; ///< Number of unique numbers generated.
+        uint32_t num_;    ///< Current number.
+        uint32_t range_;  ///< Number of unique numbers generated.
+        uint32_t offset_; ///< Value added to the generated numbers.
     };
 
+    /// \brief State of a sender thread.
+    ///
+    /// In the multi-threaded mode (-g<threads>) each sender thread
+    /// initiates exchanges for a distinct subset of the simulated clients,
+    /// using its own socket (bound to its own source port) and sending
+    /// its share of the requested rate. The transaction ids of the
+    /// messages it sends are taken from the distinct sub-range of the
+    /// transaction ids, so as the receiver thread can find the thread
+    /// state to which the received response belongs. The responses are
+    /// matched with sent messages in the Statistics Manager of that
+    /// thread state, so each thread state collects its own statistics.
+    /// They are merged when they are reported.
+    ///
+    /// The transaction id generator, the Statistics Manager, the
+    /// stop flag and the error string are protected by the mutex because
+    /// they are accessed by the sender thread, the receiver thread and
+    /// the main thread.
+    struct ThreadShard : public boost::noncopyable {
+        /// \brief Constructor.
+        ///
+        /// \param socket descriptor of the socket used to send the
+        /// DISCOVER or SOLICIT messages. It is closed when the object is
+        /// destroyed.
+        ThreadShard(const int socket);
+
+        /// \brief Destructor.
+        ///
+        /// Closes the socket.
+        ~ThreadShard();
+
+        /// Socket used to send messages.
+        int socket_;
+        /// Rate control for the Discover and Solicit messages.
+        RateControl rate_control_;
+        /// Maximum number of Discover or Solicit messages sent, 0 if
+        /// unlimited.
+        uint64_t max_requests_;
+        /// Transaction id generator.
+        NumberGeneratorPtr transid_gen_;
+        /// Numbers generator for MAC address.
+        NumberGeneratorPtr macaddr_gen_;
+        /// Statistics Manager 4.
+        StatsMgr4Ptr stats_mgr4_;
+        /// Statistics Manager 6.
+        StatsMgr6Ptr stats_mgr6_;
+        /// Indicates that the threads should exit.
+        bool stopped_;
+        /// Error which terminated one of the threads.
+        std::string error_;
+        /// Mutex protecting the state shared between threads.
+        util::thread::Mutex mutex_;
+    };
+
+    /// Pointer to the state of a sender thread.
+    typedef boost::shared_ptr<ThreadShard> ThreadShardPtr;
+
     /// \brief Length of the Ethernet HW address (MAC) in bytes.
     ///
     /// \todo Make this variable length as there are cases when HW
@@ -332,6 +396,92 @@ protected:
     dhcp::Pkt6Ptr createMessageFromReply(const uint16_t msg_type,
                                          const dhcp::Pkt6Ptr& reply);
 
+    /// \brief Create DHCPv4 DISCOVER message.
+    ///
+    /// Method creates DHCPv4 DISCOVER message with the options described
+    /// in \ref sendDiscover4.
+    ///
+    /// \param socket socket to be used to send the message.
+    /// \param mac_address MAC address of the client.
+    /// \param transid transaction id of the message.
+    ///
+    /// \throw bundy::Unexpected if failed to create new packet instance.
+    /// \return DISCOVER message.
+    dhcp::Pkt4Ptr createDiscover4(const TestControlSocket& socket,
+                                  const std::vector<uint8_t>& mac_address,
+                                  const uint32_t transid);
+
+    /// \brief Create DHCPv4 REQUEST message.
+    ///
+    /// Method creates DHCPv4 REQUEST message with the options described
+    /// in \ref sendRequest4.
+    ///
+    /// \param socket socket to be used to send the message.
+    /// \param discover_pkt4 DISCOVER packet sent.
+    /// \param offer_pkt4 OFFER packet received.
+    /// \param transid transaction id of the message.
+    /// \param serverid server identifier to be used. If empty, the server
+    /// identifier is copied from the OFFER.
+    ///
+    /// \throw bundy::BadValue if the OFFER lacks the server identifier or
+    /// holds invalid YIADDR.
+    /// \return REQUEST message.
+    dhcp::Pkt4Ptr createRequest4(const TestControlSocket& socket,
+                                 const dhcp::Pkt4Ptr& discover_pkt4,
+                                 const dhcp::Pkt4Ptr& offer_pkt4,
+                                 const uint32_t transid,
+                                 const dhcp::OptionBuffer& serverid);
+
+    /// \brief Create DHCPv6 REQUEST message.
+    ///
+    /// Method creates DHCPv6 REQUEST message with the options described
+    /// in \ref sendRequest6.
+    ///
+    /// \param socket socket to be used to send the message.
+    /// \param advertise_pkt6 ADVERTISE packet received.
+    /// \param transid transaction id of the message.
+    /// \param serverid server identifier to be used. If empty, the server
+    /// identifier is copied from the ADVERTISE.
+    ///
+    /// \throw bundy::Unexpected if the ADVERTISE lacks client or server
+    /// identifier.
+    /// \return REQUEST message.
+    dhcp::Pkt6Ptr createRequest6(const TestControlSocket& socket,
+                                 const dhcp::Pkt6Ptr& advertise_pkt6,
+                                 const uint32_t transid,
+                                 const dhcp::OptionBuffer& serverid);
+
+    /// \brief Create DHCPv6 SOLICIT message.
+    ///
+    /// Method creates DHCPv6 SOLICIT message with the options described
+    /// in \ref sendSolicit6.
+    ///
+    /// \param socket socket to be used to send the message.
+    /// \param duid DUID of the client.
+    /// \param transid transaction id of the message.
+    ///
+    /// \throw bundy::Unexpected if failed to create new packet instance.
+    /// \return SOLICIT message.
+    dhcp::Pkt6Ptr createSolicit6(const TestControlSocket& socket,
+                                 const std::vector<uint8_t>& duid,
+                                 const uint32_t transid);
+
+    /// \brief Create Statistics Manager for DHCPv4.
+    ///
+    /// Method creates Statistics Manager tracking the exchanges
+    /// selected from the command line.
+    ///
+    /// \return Statistics Manager 4.
+    StatsMgr4Ptr createStatsMgr4() const;
+
+    /// \brief Create Statistics Manager for DHCPv6.
+    ///
+    /// Method creates Statistics Manager tracking the exchanges
+    /// selected from the command line.
+    ///
+    /// \return Statistics Manager 6.
+    StatsMgr6Ptr createStatsMgr6() const;
+
     /// \brief Factory function to create DHCPv6 ELAPSED_TIME option.
     ///
     /// This factory function creates DHCPv6 ELAPSED_TIME option instance.
@@ -457,6 +607,16 @@ protected:
     /// \return vector representing DUID.
     std::vector<uint8_t> generateDuid(uint8_t& randomized) const;
 
+    /// \brief Generate DUID using specified generator.
+    ///
+    /// \param [out] randomized number of bytes randomized (initial value
+    /// is ignored).
+    /// \param generator numbers generator used to randomize the DUID.
+    /// \throw bundy::BadValue if \ref generateMacAddress throws.
+    /// \return vector representing DUID.
+    std::vector<uint8_t> generateDuid(uint8_t& randomized,
+                                      NumberGenerator& generator) const;
+
     /// \brief Generate MAC address.
     ///
     /// This method generates MAC address. The number of unique
@@ -473,6 +633,18 @@ protected:
     /// \return generated MAC address.
     std::vector<uint8_t> generateMacAddress(uint8_t& randomized) const;
 
+    /// \brief Generate MAC address using specified generator.
+    ///
+    /// \param [out] randomized number of bytes randomized (initial
+    /// value is ignored).
+    /// \param generator numbers generator used to randomize the MAC
+    /// address.
+    /// \throw bundy::BadValue if MAC address template (default or specified
+    /// from the command line) has invalid size (expected 6 octets).
+    /// \return generated MAC address.
+    std::vector<uint8_t> generateMacAddress(uint8_t& randomized,
+                                            NumberGenerator& generator) const;
+
     /// \brief generate transaction id.
     ///
     /// Generate transaction id value (32-bit for DHCPv4,
@@ -483,6 +655,13 @@ protected:
         return (transid_gen_->generate());
     }
 
+    /// \brief Returns the thread state owning the transaction id.
+    ///
+    /// \param transid transaction id of the received message.
+    /// \return thread state which sent the message with this
+    /// transaction id.
+    ThreadShard& getThreadShard(const uint32_t transid) const;
+
     /// \brief Returns a timeout for packet reception.
     ///
     /// The calculation is based on the value of the timestamp
@@ -519,6 +698,27 @@ protected:
     /// the one initialized already it is released.
     void initializeStatsMgr();
 
+    /// \brief Initializes the state of the sender threads.
+    ///
+    /// Method creates the state for the number of sender threads
+    /// specified with -g<threads>. The rate, the number of requests and
+    /// the ranges of simulated clients and transaction ids are divided
+    /// evenly between the threads, the remainders going to the first
+    /// threads. Each sender thread gets its own socket, bound to a
+    /// distinct ephemeral port.
+    ///
+    /// \param socket socket bound to the client port.
+    void initializeThreadShards(const TestControlSocket& socket);
+
+    /// \brief Merges the statistics collected by the threads.
+    ///
+    /// Method replaces the Statistics Manager with the one holding the
+    /// sum of the statistics collected by all threads.
+    ///
+    /// \param archive_mode if true, the archived packets are copied,
+    /// so as their timestamps can be printed.
+    void mergeThreadStats(const bool archive_mode);
+
     /// \brief Open socket to communicate with DHCP server.
     ///
     /// Method opens socket and binds it to local address. Function will
@@ -539,6 +739,21 @@ protected:
     /// \return socket descriptor.
     int openSocket() const;
 
+    /// \brief Open socket used by a sender thread.
+    ///
+    /// Method opens UDP socket bound to the same local address as the
+    /// specified socket and an ephemeral port. The responses from the
+    /// server are sent to the client port, so they are received on the
+    /// specified socket. The broadcast or multicast options are set on
+    /// the socket in the same way as in \ref openSocket.
+    ///
+    /// \param socket socket bound to the client port.
+    /// \throw bundy::Unexpected if the socket can't be opened or bound.
+    /// \throw bundy::InvalidOperation if the broadcast or multicast option
+    /// can't be set on the socket.
+    /// \return socket descriptor.
+    int openSenderSocket(const TestControlSocket& socket) const;
+
     /// \brief Print intermediate statistics.
     ///
     /// Print brief statistics regarding number of sent packets,
@@ -607,6 +822,34 @@ protected:
     /// \return number of received packets.
     uint64_t receivePackets(const TestControlSocket& socket);
 
+    /// \brief Process received DHCPv4 packet in the multi-threaded mode.
+    ///
+    /// Method matches the packet with the sent packet in the Statistics
+    /// Manager of the thread state owning its transaction id. For the
+    /// OFFER, when the 4-way exchange is performed, it creates the
+    /// REQUEST and appends it to the batch of packets to be sent.
+    ///
+    /// \param socket socket bound to the client port.
+    /// \param pkt4 received packet.
+    /// \param requests batch of the REQUEST packets to be sent.
+    void processThreadPacket4(const TestControlSocket& socket,
+                              const dhcp::Pkt4Ptr& pkt4,
+                              PacketBatch& requests);
+
+    /// \brief Process received DHCPv6 packet in the multi-threaded mode.
+    ///
+    /// Method matches the packet with the sent packet in the Statistics
+    /// Manager of the thread state owning its transaction id. For the
+    /// ADVERTISE, when the 4-way exchange is performed, it creates the
+    /// REQUEST and appends it to the batch of packets to be sent.
+    ///
+    /// \param socket socket bound to the client port.
+    /// \param pkt6 received packet.
+    /// \param requests batch of the REQUEST packets to be sent.
+    void processThreadPacket6(const TestControlSocket& socket,
+                              const dhcp::Pkt6Ptr& pkt6,
+                              PacketBatch& requests);
+
     /// \brief Register option factory functions for DHCPv4
     ///
     /// Method registers option factory functions for DHCPv4.
@@ -638,6 +881,51 @@ protected:
     /// called before new test is started.
     void reset();
 
+    /// \brief Run the receiver thread.
+    ///
+    /// The receiver thread reads the responses from the socket bound to
+    /// the client port in batches and processes them with
+    /// \ref processThreadPacket4 or \ref processThreadPacket6, which
+    /// pass them to the thread state owning their transaction ids. The
+    /// REQUEST messages are sent in batches through the same socket.
+    ///
+    /// The servers send the responses to the client (or relay) port
+    /// whatever the source port of the request was, so they can't be
+    /// spread over the sockets of the sender threads. This thread is the
+    /// only one reading the socket, so as the threads don't contend for
+    /// it. The thread exits when it's stopped with \ref runThreads.
+    ///
+    /// \param socket socket bound to the client port.
+    void runReceiverThread(const TestControlSocket& socket);
+
+    /// \brief Run the sender thread.
+    ///
+    /// The sender thread initiates the exchanges by sending batches of
+    /// DISCOVER or SOLICIT messages at the rate given by the rate control
+    /// of the thread state. The batch size is limited by the aggressivity.
+    /// The thread exits when the thread state is stopped.
+    ///
+    /// \param socket socket bound to the client port.
+    /// \param shard state of the thread.
+    void runSenderThread(const TestControlSocket& socket,
+                         ThreadShard& shard);
+
+    /// \brief Run the test in the multi-threaded mode.
+    ///
+    /// Method starts the sender threads and the receiver thread and
+    /// periodically merges their statistics to check the exit conditions
+    /// and print intermediate reports. When the test is finished, the
+    /// threads are stopped and the final statistics are merged.
+    ///
+    /// The threads build and parse the packets concurrently, so the caller
+    /// must make sure that the standard option definitions, which are
+    /// initialized on first use by \c LibDHCP::getOptionDefs, have been
+    /// initialized before this method is called.
+    ///
+    /// \param socket socket bound to the client port.
+    /// \throw bundy::Unexpected if one of the threads failed.
+    void runThreads(const TestControlSocket& socket);
+
     /// \brief Save the first DHCPv4 sent packet of the specified type.
     ///
     /// This method saves first packet of the specified being sent
@@ -1089,6 +1377,25 @@ protected:
     std::map<uint8_t, dhcp::Pkt4Ptr> template_packets_v4_;
     std::map<uint8_t, dhcp::Pkt6Ptr> template_packets_v6_;
 
+    /// State of the sender threads in the multi-threaded mode.
+    std::vector<ThreadShardPtr> thread_shards_;
+
+    /// Indicates that the receiver thread should exit.
+    bool receiver_stopped_;
+
+    /// Error which terminated the receiver thread.
+    std::string receiver_error_;
+
+    /// Mutex protecting the stop flag and the error of the receiver
+    /// thread.
+    util::thread::Mutex receiver_mutex_;
+
+    /// Number of transaction ids in the range of each thread state.
+    uint32_t transid_span_;
+
+    /// Mutex protecting the first server id in the multi-threaded mode.
+    util::thread::Mutex serverid_mutex_;
+
     static bool interrupted_;  ///< Is program interrupted.
 };
 
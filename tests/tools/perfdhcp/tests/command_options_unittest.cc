@@ -228,6 +228,7 @@ protected:
         EXPECT_FALSE(opt.isInterface());
         EXPECT_EQ(0, opt.getPreload());
         EXPECT_EQ(1, opt.getAggressivity());
+        EXPECT_EQ(1, opt.getThreadsNum());
         EXPECT_EQ(0, opt.getLocalPort());
         EXPECT_FALSE(opt.isSeeded());
         EXPECT_EQ(0, opt.getSeed());
@@ -707,6 +708,31 @@ TEST_F(CommandOptionsTest, Aggressivity) {
                  bundy::InvalidParameter);
 }
 
+TEST_F(CommandOptionsTest, Threads) {
+    CommandOptions& opt = CommandOptions::instance();
+    process("perfdhcp -g 4 -r 100 -R 1000 -l 192.168.0.1 all");
+    EXPECT_EQ(4, opt.getThreadsNum());
+
+    // Negative test cases
+    // Number of threads must be a positive integer
+    EXPECT_THROW(process("perfdhcp -l ethx -g 0 all"),
+                 bundy::InvalidParameter);
+    EXPECT_THROW(process("perfdhcp -l ethx -g all"),
+                 bundy::InvalidParameter);
+    // Each thread must get a non-zero share of the rate and clients.
+    EXPECT_THROW(process("perfdhcp -l ethx -g 4 -r 3 all"),
+                 bundy::InvalidParameter);
+    EXPECT_THROW(process("perfdhcp -l ethx -g 4 -R 3 all"),
+                 bundy::InvalidParameter);
+    // Templates, renews and releases are not supported with threads.
+    EXPECT_THROW(process("perfdhcp -l ethx -g 2 -T file.x all"),
+                 bundy::InvalidParameter);
+    EXPECT_THROW(process("perfdhcp -6 -l ethx -g 2 -r 10 -f 5 all"),
+                 bundy::InvalidParameter);
+    EXPECT_THROW(process("perfdhcp -l ethx -g 2 -xT all"),
+                 bundy::InvalidParameter);
+}
+
 TEST_F(CommandOptionsTest, MaxDrop) {
     CommandOptions& opt = CommandOptions::instance();
     EXPECT_NO_THROW(process("perfdhcp -D 25 -l ethx -r 10 all"));
@@ -0,0 +1,185 @@
+// Copyright (C) 2014 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <exceptions/exceptions.h>
+#include "../packet_batch.h"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace bundy;
+using namespace bundy::perfdhcp;
+
+namespace {
+
+/// \brief Test fixture class for PacketBatch.
+///
+/// It opens two UDP sockets bound to the loopback address and
+/// ephemeral ports, used to exchange the datagrams.
+class PacketBatchTest : public ::testing::Test {
+public:
+
+    /// \brief Constructor.
+    ///
+    /// Opens the sockets.
+    PacketBatchTest() : sender_(-1), receiver_(-1) {
+        sender_ = openSocket(sender_addr_);
+        receiver_ = openSocket(receiver_addr_);
+    }
+
+    /// \brief Destructor.
+    ///
+    /// Closes the sockets.
+    ~PacketBatchTest() {
+        if (sender_ >= 0) {
+            close(sender_);
+        }
+        if (receiver_ >= 0) {
+            close(receiver_);
+        }
+    }
+
+    /// \brief Opens UDP socket bound to the loopback address.
+    ///
+    /// \param [out] addr address the socket is bound to.
+    /// \return socket descriptor or -1 on failure.
+    int openSocket(struct sockaddr_in& addr) {
+        int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sock < 0) {
+            return (-1);
+        }
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addr_len = sizeof(addr);
+        if ((bind(sock, reinterpret_cast<struct sockaddr*>(&addr),
+                  addr_len) < 0) ||
+            (getsockname(sock, reinterpret_cast<struct sockaddr*>(&addr),
+                         &addr_len) < 0)) {
+            close(sock);
+            return (-1);
+        }
+        return (sock);
+    }
+
+    /// \brief Returns the address of the receiver socket.
+    const struct sockaddr* getReceiverAddr() const {
+        return (reinterpret_cast<const struct sockaddr*>(&receiver_addr_));
+    }
+
+    int sender_;                       ///< Sender socket.
+    int receiver_;                     ///< Receiver socket.
+    struct sockaddr_in sender_addr_;   ///< Sender socket address.
+    struct sockaddr_in receiver_addr_; ///< Receiver socket address.
+};
+
+// This test verifies that the batch is constructed with the specified
+// capacity and that zero capacity is rejected.
+TEST_F(PacketBatchTest, constructor) {
+    EXPECT_THROW(PacketBatch(0), bundy::BadValue);
+
+    PacketBatch batch(16);
+    EXPECT_EQ(16, batch.getCapacity());
+    EXPECT_EQ(0, batch.getSize());
+    EXPECT_FALSE(batch.isFull());
+}
+
+// This test verifies that the datagrams are appended to the batch
+// until it is full and that they can be accessed by index.
+TEST_F(PacketBatchTest, append) {
+    PacketBatch batch(2);
+    const uint8_t data1[] = { 1, 2, 3 };
+    const uint8_t data2[] = { 4, 5, 6, 7 };
+    ASSERT_NO_THROW(batch.append(data1, sizeof(data1), getReceiverAddr(),
+                                 sizeof(receiver_addr_)));
+    ASSERT_NO_THROW(batch.append(data2, sizeof(data2), getReceiverAddr(),
+                                 sizeof(receiver_addr_)));
+    EXPECT_TRUE(batch.isFull());
+    EXPECT_EQ(2, batch.getSize());
+
+    // No more datagrams may be appended.
+    EXPECT_THROW(batch.append(data1, sizeof(data1), getReceiverAddr(),
+                              sizeof(receiver_addr_)), bundy::OutOfRange);
+
+    EXPECT_EQ(sizeof(data1), batch.getLength(0));
+    EXPECT_EQ(0, memcmp(data1, batch.getData(0), sizeof(data1)));
+    EXPECT_EQ(sizeof(data2), batch.getLength(1));
+    EXPECT_EQ(0, memcmp(data2, batch.getData(1), sizeof(data2)));
+    EXPECT_EQ(AF_INET, batch.getAddress(1).ss_family);
+    EXPECT_THROW(batch.getData(2), bundy::OutOfRange);
+    EXPECT_THROW(batch.getLength(2), bundy::OutOfRange);
+    EXPECT_THROW(batch.getAddress(2), bundy::OutOfRange);
+
+    batch.clear();
+    EXPECT_EQ(0, batch.getSize());
+    EXPECT_THROW(batch.getData(0), bundy::OutOfRange);
+}
+
+// This test verifies that too large datagrams are rejected.
+TEST_F(PacketBatchTest, appendTooLarge) {
+    PacketBatch batch(1);
+    std::vector<uint8_t> data(PacketBatch::MAX_DATAGRAM_SIZE + 1);
+    EXPECT_THROW(batch.append(&data[0], data.size(), getReceiverAddr(),
+                              sizeof(receiver_addr_)), bundy::OutOfRange);
+    EXPECT_NO_THROW(batch.append(&data[0], data.size() - 1,
+                                 getReceiverAddr(), sizeof(receiver_addr_)));
+}
+
+// This test verifies that the batch of datagrams is sent and received.
+TEST_F(PacketBatchTest, sendReceive) {
+    ASSERT_GE(sender_, 0);
+    ASSERT_GE(receiver_, 0);
+
+    const size_t datagrams_num = 8;
+    PacketBatch batch(datagrams_num);
+    for (size_t i = 0; i < datagrams_num; ++i) {
+        std::vector<uint8_t> data(i + 1, static_cast<uint8_t>(i));
+        batch.append(&data[0], data.size(), getReceiverAddr(),
+                     sizeof(receiver_addr_));
+    }
+    EXPECT_EQ(datagrams_num, batch.send(sender_));
+    // The batch is cleared when the datagrams are sent.
+    EXPECT_EQ(0, batch.getSize());
+
+    // Receive the datagrams. They may arrive in more than one batch.
+    PacketBatch received(datagrams_num);
+    size_t received_num = 0;
+    for (int attempt = 0; (attempt < 10) && (received_num < datagrams_num);
+         ++attempt) {
+        const size_t num = received.receive(receiver_, 100000);
+        for (size_t i = 0; i < num; ++i) {
+            const size_t index = received_num + i;
+            ASSERT_EQ(index + 1, received.getLength(i));
+            EXPECT_EQ(index, received.getData(i)[0]);
+            const struct sockaddr_in* addr =
+                reinterpret_cast<const struct sockaddr_in*>
+                (&received.getAddress(i));
+            EXPECT_EQ(sender_addr_.sin_port, addr->sin_port);
+        }
+        received_num += num;
+    }
+    EXPECT_EQ(datagrams_num, received_num);
+
+    // There is nothing more to receive.
+    EXPECT_EQ(0, received.receive(receiver_, 1000));
+    EXPECT_EQ(0, received.getSize());
+}
+
+} // end of anonymous namespace
@@ -434,6 +434,51 @@ TEST_F(StatsMgrTest, CustomCounters) {
 
 }
 
+TEST_F(StatsMgrTest, Merge) {
+    // Simulate two threads, each collecting statistics in its own
+    // Statistics Manager.
+    boost::shared_ptr<StatsMgr6> stats_mgr1(new StatsMgr6());
+    stats_mgr1->addExchangeStats(StatsMgr6::XCHG_SA);
+    stats_mgr1->addCustomCounter("shortwait", "Short waits for packets");
+    passMultiplePackets6(stats_mgr1, StatsMgr6::XCHG_SA, DHCPV6_SOLICIT, 10);
+    passMultiplePackets6(stats_mgr1, StatsMgr6::XCHG_SA, DHCPV6_ADVERTISE,
+                         5, true);
+    stats_mgr1->incrementCounter("shortwait", 3);
+
+    boost::shared_ptr<StatsMgr6> stats_mgr2(new StatsMgr6());
+    stats_mgr2->addExchangeStats(StatsMgr6::XCHG_SA);
+    stats_mgr2->addExchangeStats(StatsMgr6::XCHG_RR);
+    stats_mgr2->addCustomCounter("shortwait", "Short waits for packets");
+    passMultiplePackets6(stats_mgr2, StatsMgr6::XCHG_SA, DHCPV6_SOLICIT, 7);
+    passMultiplePackets6(stats_mgr2, StatsMgr6::XCHG_SA, DHCPV6_ADVERTISE,
+                         7, true);
+    passMultiplePackets6(stats_mgr2, StatsMgr6::XCHG_RR, DHCPV6_REQUEST, 4);
+    stats_mgr2->incrementCounter("shortwait", 2);
+
+    // Merge both into an empty Statistics Manager.
+    StatsMgr6 merged;
+    merged.merge(*stats_mgr1);
+    merged.merge(*stats_mgr2);
+
+    // Exchanges missing in the merged object should have been created.
+    ASSERT_TRUE(merged.hasExchangeStats(StatsMgr6::XCHG_SA));
+    ASSERT_TRUE(merged.hasExchangeStats(StatsMgr6::XCHG_RR));
+    EXPECT_EQ(17, merged.getSentPacketsNum(StatsMgr6::XCHG_SA));
+    EXPECT_EQ(12, merged.getRcvdPacketsNum(StatsMgr6::XCHG_SA));
+    EXPECT_EQ(4, merged.getSentPacketsNum(StatsMgr6::XCHG_RR));
+    EXPECT_EQ(0, merged.getRcvdPacketsNum(StatsMgr6::XCHG_RR));
+    EXPECT_EQ(5, merged.getDroppedPacketsNum(StatsMgr6::XCHG_SA));
+    EXPECT_EQ(5, merged.getCounter("shortwait")->getValue());
+
+    // The delays are the extremes of both objects.
+    EXPECT_EQ(std::min(stats_mgr1->getMinDelay(StatsMgr6::XCHG_SA),
+                       stats_mgr2->getMinDelay(StatsMgr6::XCHG_SA)),
+              merged.getMinDelay(StatsMgr6::XCHG_SA));
+    EXPECT_EQ(std::max(stats_mgr1->getMaxDelay(StatsMgr6::XCHG_SA),
+                       stats_mgr2->getMaxDelay(StatsMgr6::XCHG_SA)),
+              merged.getMaxDelay(StatsMgr6::XCHG_SA));
+}
+
 TEST_F(StatsMgrTest, PrintStats) {
     std::cout << "This unit test is checking statistics printing "
               << "capabilities. It is expected that some counters "
@@ -24,9 +24,12 @@
 
 #include <cstddef>
 #include <stdint.h>
+#include <set>
 #include <string>
 #include <fstream>
 #include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 
 using namespace std;
 using namespace boost::posix_time;
@@ -109,9 +112,13 @@ public:
     using TestControl::generateDuid;
     using TestControl::generateMacAddress;
     using TestControl::getCurrentTimeout;
+    using TestControl::getSentPacketsNum;
     using TestControl::getTemplateBuffer;
+    using TestControl::getThreadShard;
     using TestControl::initPacketTemplates;
     using TestControl::initializeStatsMgr;
+    using TestControl::initializeThreadShards;
+    using TestControl::mergeThreadStats;
     using TestControl::openSocket;
     using TestControl::processReceivedPacket4;
     using TestControl::processReceivedPacket6;
@@ -132,6 +139,7 @@ public:
     using TestControl::macaddr_gen_;
     using TestControl::first_packet_serverid_;
     using TestControl::interrupted_;
+    using TestControl::thread_shards_;
 
     NakedTestControl() : TestControl() {
         uint32_t clients_num = CommandOptions::instance().getClientsNum() == 0 ?
@@ -1181,6 +1189,125 @@ TEST_F(TestControlTest, Packet6) {
     }
 }
 
+// This test verifies that the sequential generator produces the numbers
+// from the sub-range specified with the offset.
+TEST_F(TestControlTest, SequentialGeneratorOffset) {
+    TestControl::SequentialGenerator generator(3, 100);
+    EXPECT_EQ(100, generator.generate());
+    EXPECT_EQ(101, generator.generate());
+    EXPECT_EQ(102, generator.generate());
+    EXPECT_EQ(100, generator.generate());
+}
+
+// This test verifies that the rate, the number of requests and the
+// transaction ids are divided between the threads.
+TEST_F(TestControlTest, ThreadShards) {
+    // Use Interface Manager to get the local loopback interface.
+    // If the interface can't be found we don't want to fail test.
+    std::string loopback_iface(getLocalLoopback());
+    if (loopback_iface.empty()) {
+        std::cout << "Unable to find the loopback interface. Skip test."
+                  << std::endl;
+        return;
+    }
+
+    ASSERT_NO_THROW(processCmdLine("perfdhcp -l " + loopback_iface +
+                                   " -g 3 -r 10 -n 10 -R 30 -L 10547"
+                                   " 127.0.0.1"));
+    NakedTestControl tc;
+    int sock_handle = 0;
+    ASSERT_NO_THROW(sock_handle = tc.openSocket());
+    TestControl::TestControlSocket sock(sock_handle);
+    ASSERT_NO_THROW(tc.initializeStatsMgr());
+    ASSERT_NO_THROW(tc.initializeThreadShards(sock));
+    ASSERT_EQ(3, tc.thread_shards_.size());
+
+    // The remainder of the rate and the number of requests is given
+    // to the first thread. Each thread has its own socket.
+    EXPECT_EQ(4, tc.thread_shards_[0]->rate_control_.getRate());
+    EXPECT_EQ(3, tc.thread_shards_[1]->rate_control_.getRate());
+    EXPECT_EQ(3, tc.thread_shards_[2]->rate_control_.getRate());
+    EXPECT_EQ(4, tc.thread_shards_[0]->max_requests_);
+    EXPECT_EQ(3, tc.thread_shards_[1]->max_requests_);
+    EXPECT_EQ(3, tc.thread_shards_[2]->max_requests_);
+    // Each thread has its own socket, bound to its own source port.
+    std::set<uint16_t> ports;
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_GE(tc.thread_shards_[i]->socket_, 0);
+        EXPECT_NE(sock.sockfd_, tc.thread_shards_[i]->socket_);
+        struct sockaddr_storage addr;
+        socklen_t addr_len = sizeof(addr);
+        ASSERT_EQ(0, getsockname(tc.thread_shards_[i]->socket_,
+                                 reinterpret_cast<struct sockaddr*>(&addr),
+                                 &addr_len));
+        ASSERT_EQ(AF_INET, addr.ss_family);
+        ports.insert(ntohs(reinterpret_cast<const struct sockaddr_in*>(
+                               &addr)->sin_port));
+    }
+    EXPECT_EQ(3, ports.size());
+    EXPECT_EQ(0, ports.count(10547));
+
+    // The clients are split evenly.
+    for (int i = 0; i < 3; ++i) {
+        TestControl::ThreadShard& shard = *tc.thread_shards_[i];
+        for (int j = 0; j < 10; ++j) {
+            EXPECT_EQ(i * 10 + j, shard.macaddr_gen_->generate());
+        }
+        EXPECT_EQ(i * 10, shard.macaddr_gen_->generate());
+    }
+
+    // The transaction ids generated by each thread map back to it.
+    for (int i = 0; i < 3; ++i) {
+        TestControl::ThreadShard& shard = *tc.thread_shards_[i];
+        for (int j = 0; j < 10; ++j) {
+            const uint32_t transid = shard.transid_gen_->generate();
+            EXPECT_EQ(&shard, &tc.getThreadShard(transid));
+        }
+    }
+    EXPECT_EQ(tc.thread_shards_[2].get(), &tc.getThreadShard(0xFFFFFFFF));
+
+    // The statistics collected by the threads are merged.
+    for (int i = 0; i < 3; ++i) {
+        boost::shared_ptr<Pkt4> pkt4(new Pkt4(DHCPDISCOVER, i));
+        pkt4->updateTimestamp();
+        tc.thread_shards_[i]->stats_mgr4_->
+            passSentPacket(TestControl::StatsMgr4::XCHG_DO, pkt4);
+    }
+    ASSERT_NO_THROW(tc.mergeThreadStats(false));
+    EXPECT_EQ(3, tc.getSentPacketsNum(TestControl::StatsMgr4::XCHG_DO));
+}
+
+// This test verifies that all the clients are simulated when they can't
+// be split evenly between the threads.
+TEST_F(TestControlTest, ThreadShardsClients) {
+    std::string loopback_iface(getLocalLoopback());
+    if (loopback_iface.empty()) {
+        std::cout << "Unable to find the loopback interface. Skip test."
+                  << std::endl;
+        return;
+    }
+
+    ASSERT_NO_THROW(processCmdLine("perfdhcp -l " + loopback_iface +
+                                   " -g 3 -r 10 -R 5 -L 10547 127.0.0.1"));
+    NakedTestControl tc;
+    int sock_handle = 0;
+    ASSERT_NO_THROW(sock_handle = tc.openSocket());
+    TestControl::TestControlSocket sock(sock_handle);
+    ASSERT_NO_THROW(tc.initializeStatsMgr());
+    ASSERT_NO_THROW(tc.initializeThreadShards(sock));
+    ASSERT_EQ(3, tc.thread_shards_.size());
+
+    // The first two threads get one of the remaining clients each.
+    EXPECT_EQ(0, tc.thread_shards_[0]->macaddr_gen_->generate());
+    EXPECT_EQ(1, tc.thread_shards_[0]->macaddr_gen_->generate());
+    EXPECT_EQ(0, tc.thread_shards_[0]->macaddr_gen_->generate());
+    EXPECT_EQ(2, tc.thread_shards_[1]->macaddr_gen_->generate());
+    EXPECT_EQ(3, tc.thread_shards_[1]->macaddr_gen_->generate());
+    EXPECT_EQ(2, tc.thread_shards_[1]->macaddr_gen_->generate());
+    EXPECT_EQ(4, tc.thread_shards_[2]->macaddr_gen_->generate());
+    EXPECT_EQ(4, tc.thread_shards_[2]->macaddr_gen_->generate());
+}
+
 TEST_F(TestControlTest, Packet4Exchange) {
     // Get the local loopback interface to open socket on
     // it and test packets exchanges. We don't want to fail